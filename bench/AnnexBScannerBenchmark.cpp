@@ -0,0 +1,178 @@
+#include "WebRTCClientBenchmarkFixture.h"
+
+namespace com {
+namespace amazonaws {
+namespace kinesis {
+namespace video {
+namespace webrtcclient {
+
+// Path of a real Annex-B I-frame to scan instead of the generated one
+#define ANNEXB_BENCHMARK_FRAME_ENV_VAR "KVS_BENCHMARK_ANNEXB_FRAME"
+
+// Slice NALU size used when generating a frame
+#define ANNEXB_BENCHMARK_SLICE_SIZE (256 * 1024)
+
+class AnnexBScannerBenchmark : public WebRtcClientBenchmarkBase {
+  public:
+    VOID SetUp(const ::benchmark::State& state)
+    {
+        PCHAR pFramePath = GETENV(ANNEXB_BENCHMARK_FRAME_ENV_VAR);
+        UINT64 fileSize = 0;
+
+        WebRtcClientBenchmarkBase::SetUp(state);
+
+        if (pFramePath != NULL && STATUS_SUCCEEDED(readFile(pFramePath, TRUE, NULL, &fileSize)) && fileSize != 0) {
+            frame.resize((SIZE_T) fileSize);
+            readFile(pFramePath, TRUE, frame.data(), &fileSize);
+        } else {
+            generateFrame((UINT32) state.range(0));
+        }
+    }
+
+    // SPS, PPS and slices of random bytes with emulation prevention applied, like an encoder would produce
+    VOID generateFrame(UINT32 frameSize)
+    {
+        static const BYTE spsPps[] = {0x00, 0x00, 0x00, 0x01, 0x67, 0x42, 0xc0, 0x1f, 0xda, 0x01, 0x40, 0x16,
+                                      0xe8, 0x06, 0xd0, 0xa1, 0x35, 0x00, 0x00, 0x00, 0x01, 0x68, 0xce, 0x06, 0xe2};
+        UINT32 zeroRun = 0;
+        BYTE value;
+
+        frame.assign(spsPps, spsPps + SIZEOF(spsPps));
+        SRAND(0);
+        while (frame.size() < frameSize) {
+            if (frame.size() % ANNEXB_BENCHMARK_SLICE_SIZE < 5) {
+                frame.insert(frame.end(), {0x00, 0x00, 0x00, 0x01, 0x65});
+                zeroRun = 0;
+                continue;
+            }
+
+            // Zeros are over represented in entropy coded data, keep plenty of them to exercise near misses
+            value = (RAND() % 4 == 0) ? 0x00 : (BYTE) RAND();
+            if (zeroRun == 2 && value <= 0x03) {
+                frame.push_back(0x03);
+                zeroRun = 0;
+            }
+            frame.push_back(value);
+            zeroRun = value == 0x00 ? zeroRun + 1 : 0;
+        }
+    }
+
+    // Splits the whole frame the way the payloaders do, returning the number of NALUs found
+    static UINT32 countNalus(AnnexBStartCodeScanFunc scanFunc, PBYTE pFrame, UINT32 frameSize)
+    {
+        UINT32 offset = 0, naluCount = 0;
+
+        while (offset < frameSize) {
+            offset += scanFunc(pFrame + offset, frameSize - offset) + 3;
+            naluCount++;
+        }
+
+        return naluCount;
+    }
+
+    // Byte walk getNextNaluLength used before the vectorized scanners, kept as the baseline
+    static UINT32 findAnnexBStartCodeLegacy(PBYTE pData, UINT32 length)
+    {
+        UINT32 offset = 2;
+        PBYTE pCurrent = pData + offset;
+
+        while (offset < length) {
+            if (*pCurrent == 0) {
+                offset++;
+                pCurrent++;
+            } else if (*pCurrent == 1) {
+                if (*(pCurrent - 1) == 0 && *(pCurrent - 2) == 0) {
+                    return offset - 2;
+                }
+                offset += 3;
+                pCurrent += 3;
+            } else {
+                offset += 3;
+                pCurrent += 3;
+            }
+        }
+
+        return length;
+    }
+
+    VOID runScan(benchmark::State& state, AnnexBStartCodeScanFunc scanFunc)
+    {
+        for (auto _ : state) {
+            benchmark::DoNotOptimize(countNalus(scanFunc, frame.data(), (UINT32) frame.size()));
+        }
+        state.SetBytesProcessed((INT64) state.iterations() * (INT64) frame.size());
+    }
+
+    std::vector<BYTE> frame;
+};
+
+BENCHMARK_DEFINE_F(AnnexBScannerBenchmark, BM_AnnexBScanLegacy)(benchmark::State& state)
+{
+    runScan(state, findAnnexBStartCodeLegacy);
+}
+
+BENCHMARK_DEFINE_F(AnnexBScannerBenchmark, BM_AnnexBScanScalar)(benchmark::State& state)
+{
+    runScan(state, findAnnexBStartCodeScalar);
+}
+
+BENCHMARK_DEFINE_F(AnnexBScannerBenchmark, BM_AnnexBScanDispatched)(benchmark::State& state)
+{
+    runScan(state, findAnnexBStartCode);
+}
+
+BENCHMARK_DEFINE_F(AnnexBScannerBenchmark, BM_H264GetNextNaluLength)(benchmark::State& state)
+{
+    PBYTE pCurrent;
+    UINT32 remaining, startIndex, naluLength;
+
+    for (auto _ : state) {
+        pCurrent = frame.data();
+        remaining = (UINT32) frame.size();
+        while (remaining != 0 && STATUS_SUCCEEDED(getNextNaluLength(pCurrent, remaining, &startIndex, &naluLength))) {
+            pCurrent += startIndex + naluLength;
+            remaining -= startIndex + naluLength;
+        }
+        benchmark::DoNotOptimize(remaining);
+    }
+    state.SetBytesProcessed((INT64) state.iterations() * (INT64) frame.size());
+}
+
+BENCHMARK_REGISTER_F(AnnexBScannerBenchmark, BM_AnnexBScanLegacy)->Range(1 << 20, 8 << 20);
+BENCHMARK_REGISTER_F(AnnexBScannerBenchmark, BM_AnnexBScanScalar)->Range(1 << 20, 8 << 20);
+BENCHMARK_REGISTER_F(AnnexBScannerBenchmark, BM_AnnexBScanDispatched)->Range(1 << 20, 8 << 20);
+BENCHMARK_REGISTER_F(AnnexBScannerBenchmark, BM_H264GetNextNaluLength)->Range(1 << 20, 8 << 20);
+
+#ifdef KVS_ANNEXB_SCAN_SSE2_SUPPORTED
+BENCHMARK_DEFINE_F(AnnexBScannerBenchmark, BM_AnnexBScanSse2)(benchmark::State& state)
+{
+    runScan(state, findAnnexBStartCodeSse2);
+}
+BENCHMARK_REGISTER_F(AnnexBScannerBenchmark, BM_AnnexBScanSse2)->Range(1 << 20, 8 << 20);
+#endif
+
+#ifdef KVS_ANNEXB_SCAN_AVX2_SUPPORTED
+BENCHMARK_DEFINE_F(AnnexBScannerBenchmark, BM_AnnexBScanAvx2)(benchmark::State& state)
+{
+    if (!annexBScanAvx2Available()) {
+        state.SkipWithError("AVX2 is not supported by this CPU");
+        return;
+    }
+    runScan(state, findAnnexBStartCodeAvx2);
+}
+BENCHMARK_REGISTER_F(AnnexBScannerBenchmark, BM_AnnexBScanAvx2)->Range(1 << 20, 8 << 20);
+#endif
+
+#ifdef KVS_ANNEXB_SCAN_NEON_SUPPORTED
+BENCHMARK_DEFINE_F(AnnexBScannerBenchmark, BM_AnnexBScanNeon)(benchmark::State& state)
+{
+    runScan(state, findAnnexBStartCodeNeon);
+}
+BENCHMARK_REGISTER_F(AnnexBScannerBenchmark, BM_AnnexBScanNeon)->Range(1 << 20, 8 << 20);
+#endif
+
+} // namespace webrtcclient
+} // namespace video
+} // namespace kinesis
+} // namespace amazonaws
+} // namespace com
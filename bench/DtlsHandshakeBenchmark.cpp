@@ -0,0 +1,173 @@
+#include "WebRTCClientBenchmarkFixture.h"
+
+#define DTLS_HANDSHAKE_BENCHMARK_AWAIT_DURATION (10 * HUNDREDS_OF_NANOS_IN_A_SECOND)
+
+namespace com {
+namespace amazonaws {
+namespace kinesis {
+namespace video {
+namespace webrtcclient {
+
+class DtlsHandshakeBenchmark : public WebRtcClientBenchmarkBase {
+  public:
+    // Packets sent to a session, delivered by the benchmark thread the way the ice agent delivers them
+    struct Peer {
+        std::mutex mtx;
+        std::queue<std::vector<BYTE>> queue;
+        PDtlsSession pDtlsSession = NULL;
+    };
+
+    static VOID outboundPacketFn(UINT64 customData, PBYTE pData, UINT32 dataLen)
+    {
+        Peer* pPeer = (Peer*) customData;
+        assert(pPeer != NULL);
+        assert(pData != NULL);
+        pPeer->mtx.lock();
+        pPeer->queue.push(std::vector<BYTE>(pData, pData + dataLen));
+        pPeer->mtx.unlock();
+    }
+
+    static VOID stateChangeFn(UINT64 customData, RTC_DTLS_TRANSPORT_STATE state)
+    {
+        if (state == RTC_DTLS_TRANSPORT_STATE_CONNECTED) {
+            ATOMIC_INCREMENT((PSIZE_T) customData);
+        }
+    }
+
+    STATUS consumeMessages(Peer* pPeer, PBOOL pConsumed)
+    {
+        STATUS retStatus = STATUS_SUCCESS;
+        std::queue<std::vector<BYTE>> pendingMessages;
+
+        pPeer->mtx.lock();
+        pPeer->queue.swap(pendingMessages);
+        pPeer->mtx.unlock();
+
+        *pConsumed = *pConsumed || !pendingMessages.empty();
+        while (!pendingMessages.empty()) {
+            auto& msg = pendingMessages.front();
+            auto readLen = (INT32) msg.size();
+            CHK_STATUS(dtlsSessionProcessPacket(pPeer->pDtlsSession, (PBYTE) &msg.front(), &readLen));
+            pendingMessages.pop();
+        }
+
+    CleanUp:
+
+        return retStatus;
+    }
+
+    // Creates a client and server session sharing the certificate for every timer queue, like a peer connection has its own
+    STATUS createPairs(std::vector<TIMER_QUEUE_HANDLE>& timerQueues, PRtcCertificate pRtcCertificates, PSIZE_T pConnectedCount,
+                       std::vector<Peer>& clients, std::vector<Peer>& servers)
+    {
+        STATUS retStatus = STATUS_SUCCESS;
+        DtlsSessionCallbacks callbacks;
+        UINT32 i;
+
+        MEMSET(&callbacks, 0, SIZEOF(callbacks));
+        callbacks.stateChangeFn = stateChangeFn;
+        callbacks.stateChangeFnCustomData = (UINT64) pConnectedCount;
+
+        for (i = 0; i < timerQueues.size(); i++) {
+            CHK_STATUS(createDtlsSession(&callbacks, timerQueues[i], 0, FALSE, pRtcCertificates, &clients[i].pDtlsSession));
+            CHK_STATUS(createDtlsSession(&callbacks, timerQueues[i], 0, FALSE, pRtcCertificates, &servers[i].pDtlsSession));
+            CHK_STATUS(dtlsSessionOnOutBoundData(clients[i].pDtlsSession, (UINT64) &servers[i], outboundPacketFn));
+            CHK_STATUS(dtlsSessionOnOutBoundData(servers[i].pDtlsSession, (UINT64) &clients[i], outboundPacketFn));
+        }
+
+    CleanUp:
+
+        return retStatus;
+    }
+
+    VOID freePairs(std::vector<Peer>& clients, std::vector<Peer>& servers)
+    {
+        for (auto& peer : clients) {
+            freeDtlsSession(&peer.pDtlsSession);
+            std::queue<std::vector<BYTE>>().swap(peer.queue);
+        }
+
+        for (auto& peer : servers) {
+            freeDtlsSession(&peer.pDtlsSession);
+            std::queue<std::vector<BYTE>>().swap(peer.queue);
+        }
+    }
+};
+
+// Handshakes of state.range(0) session pairs started at once. The only threads involved are the benchmark thread
+// delivering the packets and the timer queues, like the ice agent and the timer queue of a peer connection.
+BENCHMARK_DEFINE_F(DtlsHandshakeBenchmark, BM_DtlsConcurrentHandshakes)(benchmark::State& state)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    UINT32 pairCount = (UINT32) state.range(0), i;
+    UINT64 startTime;
+    SIZE_T connectedCount = 0;
+    BOOL consumed;
+    RtcCertificate certificates[MAX_RTCCONFIGURATION_CERTIFICATES];
+    PDtlsCertificatePoolEntry pCertificatePoolEntry = NULL;
+    std::vector<Peer> clients(pairCount), servers(pairCount);
+    std::vector<TIMER_QUEUE_HANDLE> timerQueues(pairCount, INVALID_TIMER_QUEUE_HANDLE_VALUE);
+
+    MEMSET(certificates, 0x00, SIZEOF(certificates));
+    for (auto& timerQueueHandle : timerQueues) {
+        CHK_STATUS(timerQueueCreate(&timerQueueHandle));
+    }
+
+    // Key generation is not what is measured, every session uses the same certificate
+    CHK_STATUS(dtlsCertificatePoolAcquire(0, FALSE, &certificates[0], &pCertificatePoolEntry));
+
+    for (auto _ : state) {
+        state.PauseTiming();
+        ATOMIC_STORE(&connectedCount, 0);
+        CHK_STATUS(createPairs(timerQueues, certificates, &connectedCount, clients, servers));
+        state.ResumeTiming();
+
+        for (i = 0; i < pairCount; i++) {
+            CHK_STATUS(dtlsSessionStart(servers[i].pDtlsSession, TRUE));
+            CHK_STATUS(dtlsSessionStart(clients[i].pDtlsSession, FALSE));
+        }
+
+        startTime = GETTIME();
+        while (ATOMIC_LOAD(&connectedCount) != 2 * pairCount) {
+            CHK_ERR(GETTIME() - startTime < DTLS_HANDSHAKE_BENCHMARK_AWAIT_DURATION, STATUS_OPERATION_TIMED_OUT,
+                    "timeout: %" PRIu64 " of %u sessions connected", (UINT64) ATOMIC_LOAD(&connectedCount), 2 * pairCount);
+
+            consumed = FALSE;
+            for (i = 0; i < pairCount; i++) {
+                CHK_STATUS(consumeMessages(&servers[i], &consumed));
+                CHK_STATUS(consumeMessages(&clients[i], &consumed));
+            }
+
+            if (!consumed) {
+                THREAD_SLEEP(HUNDREDS_OF_NANOS_IN_A_MILLISECOND);
+            }
+        }
+
+        state.PauseTiming();
+        freePairs(clients, servers);
+        state.ResumeTiming();
+    }
+
+    state.counters["handshakes"] = benchmark::Counter((DOUBLE) state.iterations() * pairCount, benchmark::Counter::kIsRate);
+
+CleanUp:
+
+    if (STATUS_FAILED(retStatus)) {
+        DLOGE("Dtls handshake benchmark failed with 0x%08x", retStatus);
+        state.SkipWithError("dtls handshakes did not complete");
+    }
+
+    freePairs(clients, servers);
+    dtlsCertificatePoolRelease(&pCertificatePoolEntry);
+    for (auto& timerQueueHandle : timerQueues) {
+        timerQueueFree(&timerQueueHandle);
+    }
+}
+
+BENCHMARK_REGISTER_F(DtlsHandshakeBenchmark, BM_DtlsConcurrentHandshakes)->Arg(1)->Arg(10)->Arg(50)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+} // namespace webrtcclient
+} // namespace video
+} // namespace kinesis
+} // namespace amazonaws
+} // namespace com
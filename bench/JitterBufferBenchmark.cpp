@@ -0,0 +1,156 @@
+#include "WebRTCClientBenchmarkFixture.h"
+
+// Frames pushed per benchmark iteration, their packets are taken from the pool with the timing paused
+#define JITTER_BUFFER_BENCHMARK_BATCH_FRAMES   16
+#define JITTER_BUFFER_BENCHMARK_SSRC           0x12345678
+#define JITTER_BUFFER_BENCHMARK_CLOCK_RATE     90000
+#define JITTER_BUFFER_BENCHMARK_FRAME_DURATION (JITTER_BUFFER_BENCHMARK_CLOCK_RATE / 30)
+#define JITTER_BUFFER_BENCHMARK_PAYLOAD_SIZE   (DEFAULT_MTU_SIZE_BYTES - RTP_PACKET_POOL_MAX_HEADER_LEN)
+
+namespace com {
+namespace amazonaws {
+namespace kinesis {
+namespace video {
+namespace webrtcclient {
+
+class JitterBufferBenchmark : public WebRtcClientBenchmarkBase {
+  public:
+    PJitterBuffer pJitterBuffer = NULL;
+    PRtpPacketPool pRtpPacketPool = NULL;
+    std::vector<BYTE> frameBuffer;
+    std::vector<PRtpPacket> packets;
+    UINT64 framesReady;
+    UINT16 sequenceNumber;
+    UINT32 timestamp;
+
+    // Copies the frame out like the peer connection does for applications without scatter-gather delivery
+    static STATUS onFrameReady(UINT64 customData, UINT16 startIndex, UINT16 endIndex, UINT32 frameSize)
+    {
+        STATUS retStatus = STATUS_SUCCESS;
+        JitterBufferBenchmark* pBenchmark = (JitterBufferBenchmark*) customData;
+        UINT32 filledSize = 0;
+
+        if (frameSize > pBenchmark->frameBuffer.size()) {
+            pBenchmark->frameBuffer.resize(frameSize);
+        }
+
+        CHK_STATUS(
+            jitterBufferFillFrameData(pBenchmark->pJitterBuffer, pBenchmark->frameBuffer.data(), frameSize, &filledSize, startIndex, endIndex));
+        CHK(frameSize == filledSize, STATUS_INVALID_ARG_LEN);
+        pBenchmark->framesReady++;
+
+    CleanUp:
+
+        return retStatus;
+    }
+
+    static STATUS onFrameDropped(UINT64 customData, UINT16 startIndex, UINT16 endIndex, UINT32 timestamp)
+    {
+        UNUSED_PARAM(customData);
+        UNUSED_PARAM(startIndex);
+        UNUSED_PARAM(endIndex);
+        UNUSED_PARAM(timestamp);
+        return STATUS_SUCCESS;
+    }
+
+    // Fills the batch with H264 frames of packetsPerFrame packets each, fragmented in FU-A units when more than one
+    STATUS preparePackets(UINT32 packetsPerFrame)
+    {
+        STATUS retStatus = STATUS_SUCCESS;
+        PRtpPacket pRtpPacket = NULL;
+        PBYTE pPayload;
+        UINT32 frame, i;
+
+        packets.clear();
+        for (frame = 0; frame < JITTER_BUFFER_BENCHMARK_BATCH_FRAMES; frame++) {
+            for (i = 0; i < packetsPerFrame; i++) {
+                CHK_STATUS(rtpPacketPoolGetPacket(pRtpPacketPool, MIN_HEADER_LENGTH + JITTER_BUFFER_BENCHMARK_PAYLOAD_SIZE, &pRtpPacket));
+                packets.push_back(pRtpPacket);
+
+                pRtpPacket->pRawPacket[0] = 0x80;
+                pRtpPacket->pRawPacket[1] = DEFAULT_PAYLOAD_H264 | (i == packetsPerFrame - 1 ? 0x80 : 0x00);
+                putUnalignedInt16BigEndian(pRtpPacket->pRawPacket + 2, sequenceNumber++);
+                putUnalignedInt32BigEndian(pRtpPacket->pRawPacket + 4, timestamp);
+                putUnalignedInt32BigEndian(pRtpPacket->pRawPacket + 8, JITTER_BUFFER_BENCHMARK_SSRC);
+
+                pPayload = pRtpPacket->pRawPacket + MIN_HEADER_LENGTH;
+                MEMSET(pPayload, 0x11, JITTER_BUFFER_BENCHMARK_PAYLOAD_SIZE);
+                if (packetsPerFrame == 1) {
+                    // single NAL unit packet of an IDR slice
+                    pPayload[0] = 0x65;
+                } else {
+                    // FU-A indicator, then the start and end bits ahead of the IDR slice type
+                    pPayload[0] = 0x7c;
+                    pPayload[1] = 0x05 | (i == 0 ? 0x80 : 0x00) | (i == packetsPerFrame - 1 ? 0x40 : 0x00);
+                }
+
+                pRtpPacket->rawPacketLength = MIN_HEADER_LENGTH + JITTER_BUFFER_BENCHMARK_PAYLOAD_SIZE;
+                CHK_STATUS(setRtpPacketFromBytes(pRtpPacket->pRawPacket, pRtpPacket->rawPacketLength, pRtpPacket));
+            }
+            timestamp += JITTER_BUFFER_BENCHMARK_FRAME_DURATION;
+        }
+
+    CleanUp:
+
+        return retStatus;
+    }
+
+    VOID freePackets()
+    {
+        for (auto& pRtpPacket : packets) {
+            freeRtpPacket(&pRtpPacket);
+        }
+        packets.clear();
+    }
+};
+
+// In order packets of a video stream, state.range(0) is the number of packets per frame
+BENCHMARK_DEFINE_F(JitterBufferBenchmark, BM_JitterBufferPush)(benchmark::State& state)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    UINT32 packetsPerFrame = (UINT32) state.range(0), i;
+    BOOL discarded;
+
+    // The fixture is reused by every argument, start each stream afresh
+    framesReady = 0;
+    sequenceNumber = 0;
+    timestamp = JITTER_BUFFER_BENCHMARK_FRAME_DURATION;
+    CHK_STATUS(createRtpPacketPool(DEFAULT_RTP_RECEIVE_PACKET_POOL_SLOT_SIZE, DEFAULT_RTP_PACKET_POOL_SLAB_SLOT_COUNT, &pRtpPacketPool));
+    CHK_STATUS(createJitterBuffer(onFrameReady, onFrameDropped, depayH264FromRtpPayload, DEFAULT_JITTER_BUFFER_MAX_LATENCY,
+                                  JITTER_BUFFER_BENCHMARK_CLOCK_RATE, (UINT64) this, &pJitterBuffer));
+
+    for (auto _ : state) {
+        state.PauseTiming();
+        CHK_STATUS(preparePackets(packetsPerFrame));
+        state.ResumeTiming();
+
+        // The jitter buffer owns the packets once pushed
+        for (i = 0; i < packets.size(); i++) {
+            CHK_STATUS(jitterBufferPush(pJitterBuffer, packets[i], &discarded));
+            packets[i] = NULL;
+        }
+    }
+    state.SetItemsProcessed((INT64) state.iterations() * JITTER_BUFFER_BENCHMARK_BATCH_FRAMES * packetsPerFrame);
+    state.SetBytesProcessed((INT64) state.iterations() * JITTER_BUFFER_BENCHMARK_BATCH_FRAMES * packetsPerFrame *
+                            JITTER_BUFFER_BENCHMARK_PAYLOAD_SIZE);
+    state.counters["frames"] = benchmark::Counter((DOUBLE) framesReady, benchmark::Counter::kIsRate);
+
+CleanUp:
+
+    if (STATUS_FAILED(retStatus)) {
+        DLOGE("Jitter buffer benchmark failed with 0x%08x", retStatus);
+        state.SkipWithError("jitter buffer push failed");
+    }
+
+    freePackets();
+    freeJitterBuffer(&pJitterBuffer);
+    freeRtpPacketPool(&pRtpPacketPool);
+}
+
+BENCHMARK_REGISTER_F(JitterBufferBenchmark, BM_JitterBufferPush)->Arg(1)->Arg(10)->Arg(80);
+
+} // namespace webrtcclient
+} // namespace video
+} // namespace kinesis
+} // namespace amazonaws
+} // namespace com
@@ -0,0 +1,139 @@
+#include "WebRTCClientBenchmarkFixture.h"
+
+// Packets serialized or parsed per benchmark iteration
+#define RTP_PACKET_BENCHMARK_BATCH_SIZE  64
+#define RTP_PACKET_BENCHMARK_SSRC        0x12345678
+#define RTP_PACKET_BENCHMARK_TWCC_EXT_ID 1
+
+namespace com {
+namespace amazonaws {
+namespace kinesis {
+namespace video {
+namespace webrtcclient {
+
+class RtpPacketBenchmark : public WebRtcClientBenchmarkBase {
+  public:
+    BYTE payload[DEFAULT_MTU_SIZE_BYTES];
+    PBYTE rawPackets[RTP_PACKET_BENCHMARK_BATCH_SIZE];
+    UINT32 rawPacketLens[RTP_PACKET_BENCHMARK_BATCH_SIZE];
+    RtpPacket packets[RTP_PACKET_BENCHMARK_BATCH_SIZE];
+    UINT32 extensionPayload;
+
+    STATUS setUpPackets(UINT32 payloadSize)
+    {
+        STATUS retStatus = STATUS_SUCCESS;
+        UINT32 i;
+
+        MEMSET(payload, 0x11, SIZEOF(payload));
+        MEMSET(rawPackets, 0x00, SIZEOF(rawPackets));
+        MEMSET(packets, 0x00, SIZEOF(packets));
+        for (i = 0; i < RTP_PACKET_BENCHMARK_BATCH_SIZE; i++) {
+            rawPacketLens[i] = RTP_PACKET_POOL_MAX_HEADER_LEN + payloadSize;
+            CHK(NULL != (rawPackets[i] = (PBYTE) MEMALLOC(rawPacketLens[i])), STATUS_NOT_ENOUGH_MEMORY);
+        }
+
+    CleanUp:
+
+        return retStatus;
+    }
+
+    VOID freePackets()
+    {
+        UINT32 i;
+
+        for (i = 0; i < RTP_PACKET_BENCHMARK_BATCH_SIZE; i++) {
+            SAFE_MEMFREE(rawPackets[i]);
+        }
+    }
+
+    // Sets up and serializes the batch the way writeFrame does, with the transport wide congestion control extension
+    STATUS serializePackets(UINT32 payloadSize, UINT16 startSequenceNumber)
+    {
+        STATUS retStatus = STATUS_SUCCESS;
+        UINT32 i;
+
+        for (i = 0; i < RTP_PACKET_BENCHMARK_BATCH_SIZE; i++) {
+            CHK_STATUS(setRtpPacket(2, FALSE, FALSE, 0, i == RTP_PACKET_BENCHMARK_BATCH_SIZE - 1, DEFAULT_PAYLOAD_H264,
+                                    GET_UINT16_SEQ_NUM(startSequenceNumber + i), 0, RTP_PACKET_BENCHMARK_SSRC, NULL, 0, 0, NULL, payload,
+                                    payloadSize, &packets[i]));
+            packets[i].header.extension = TRUE;
+            packets[i].header.extensionProfile = TWCC_EXT_PROFILE;
+            packets[i].header.extensionLength = SIZEOF(UINT32);
+            extensionPayload = TWCC_PAYLOAD(RTP_PACKET_BENCHMARK_TWCC_EXT_ID, startSequenceNumber + i);
+            packets[i].header.extensionPayload = (PBYTE) &extensionPayload;
+
+            rawPacketLens[i] = RTP_PACKET_POOL_MAX_HEADER_LEN + payloadSize;
+            CHK_STATUS(createBytesFromRtpPacket(&packets[i], rawPackets[i], &rawPacketLens[i]));
+        }
+
+    CleanUp:
+
+        return retStatus;
+    }
+};
+
+// state.range(0) is the rtp payload size
+BENCHMARK_DEFINE_F(RtpPacketBenchmark, BM_RtpCreateBytesFromPacket)(benchmark::State& state)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    UINT32 payloadSize = (UINT32) state.range(0);
+    UINT16 sequenceNumber = 0;
+
+    CHK_STATUS(setUpPackets(payloadSize));
+
+    for (auto _ : state) {
+        CHK_STATUS(serializePackets(payloadSize, sequenceNumber));
+        sequenceNumber = GET_UINT16_SEQ_NUM(sequenceNumber + RTP_PACKET_BENCHMARK_BATCH_SIZE);
+    }
+    state.SetItemsProcessed((INT64) state.iterations() * RTP_PACKET_BENCHMARK_BATCH_SIZE);
+    state.SetBytesProcessed((INT64) state.iterations() * RTP_PACKET_BENCHMARK_BATCH_SIZE * payloadSize);
+
+CleanUp:
+
+    if (STATUS_FAILED(retStatus)) {
+        DLOGE("Rtp packet benchmark failed with 0x%08x", retStatus);
+        state.SkipWithError("rtp packet serialization failed");
+    }
+
+    freePackets();
+}
+
+BENCHMARK_DEFINE_F(RtpPacketBenchmark, BM_RtpCreatePacketFromBytes)(benchmark::State& state)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    UINT32 payloadSize = (UINT32) state.range(0), i;
+    PRtpPacket pRtpPacket = NULL;
+
+    CHK_STATUS(setUpPackets(payloadSize));
+    CHK_STATUS(serializePackets(payloadSize, 0));
+
+    for (auto _ : state) {
+        for (i = 0; i < RTP_PACKET_BENCHMARK_BATCH_SIZE; i++) {
+            CHK_STATUS(createRtpPacketFromBytes(rawPackets[i], rawPacketLens[i], &pRtpPacket));
+            benchmark::DoNotOptimize(pRtpPacket->header.sequenceNumber);
+            // The raw bytes are parsed again by the next iteration, only free the packet
+            pRtpPacket->pRawPacket = NULL;
+            CHK_STATUS(freeRtpPacket(&pRtpPacket));
+        }
+    }
+    state.SetItemsProcessed((INT64) state.iterations() * RTP_PACKET_BENCHMARK_BATCH_SIZE);
+    state.SetBytesProcessed((INT64) state.iterations() * RTP_PACKET_BENCHMARK_BATCH_SIZE * payloadSize);
+
+CleanUp:
+
+    if (STATUS_FAILED(retStatus)) {
+        DLOGE("Rtp packet benchmark failed with 0x%08x", retStatus);
+        state.SkipWithError("rtp packet parsing failed");
+    }
+
+    freePackets();
+}
+
+BENCHMARK_REGISTER_F(RtpPacketBenchmark, BM_RtpCreateBytesFromPacket)->Arg(160)->Arg(DEFAULT_MTU_SIZE_BYTES - RTP_PACKET_POOL_MAX_HEADER_LEN);
+BENCHMARK_REGISTER_F(RtpPacketBenchmark, BM_RtpCreatePacketFromBytes)->Arg(160)->Arg(DEFAULT_MTU_SIZE_BYTES - RTP_PACKET_POOL_MAX_HEADER_LEN);
+
+} // namespace webrtcclient
+} // namespace video
+} // namespace kinesis
+} // namespace amazonaws
+} // namespace com
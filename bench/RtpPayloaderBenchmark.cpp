@@ -0,0 +1,147 @@
+#include "WebRTCClientBenchmarkFixture.h"
+
+namespace com {
+namespace amazonaws {
+namespace kinesis {
+namespace video {
+namespace webrtcclient {
+
+// Frame sizes of a typical P-frame and I-frame, audio frames are 20ms of G.711 and Opus
+#define RTP_PAYLOADER_BENCHMARK_SMALL_VIDEO_FRAME_SIZE (10 * 1024)
+#define RTP_PAYLOADER_BENCHMARK_LARGE_VIDEO_FRAME_SIZE (100 * 1024)
+#define RTP_PAYLOADER_BENCHMARK_G711_FRAME_SIZE        160
+#define RTP_PAYLOADER_BENCHMARK_OPUS_FRAME_SIZE        120
+
+typedef struct {
+    PCHAR name;
+    STATUS (*payloadFn)(UINT32, PBYTE, UINT32, PPayloadArray);
+    DepayRtpPayloadFunc depayFn;
+    // NALU headers of the parameter sets and the slice making up a generated Annex-B frame, empty for the other codecs
+    std::vector<std::vector<BYTE>> naluHeaders;
+} RtpPayloaderBenchmarkCodec;
+
+static RtpPayloaderBenchmarkCodec RTP_PAYLOADER_BENCHMARK_CODECS[] = {
+    {(PCHAR) "H264", createPayloadArrayForH264, depayH264FromRtpPayload, {{0x67, 0x42, 0xc0, 0x1f}, {0x68, 0xce, 0x06, 0xe2}, {0x65}}},
+    {(PCHAR) "H265",
+     createPayloadArrayForH265,
+     depayH265FromRtpPayload,
+     {{0x40, 0x01, 0x0c, 0x01}, {0x42, 0x01, 0x01, 0x01}, {0x44, 0x01, 0xc1, 0x72}, {0x26, 0x01}}},
+    {(PCHAR) "VP8", createPayloadArrayForVP8, depayVP8FromRtpPayload, {}},
+    {(PCHAR) "Opus", createPayloadArrayForOpus, depayOpusFromRtpPayload, {}},
+    {(PCHAR) "G711", createPayloadArrayForG711, depayG711FromRtpPayload, {}},
+};
+
+class RtpPayloaderBenchmark : public WebRtcClientBenchmarkBase {
+  public:
+    VOID SetUp(const ::benchmark::State& state)
+    {
+        WebRtcClientBenchmarkBase::SetUp(state);
+        MEMSET(&payloadArray, 0x00, SIZEOF(payloadArray));
+        generateFrame(RTP_PAYLOADER_BENCHMARK_CODECS[state.range(0)], (UINT32) state.range(1));
+    }
+
+    VOID TearDown(const ::benchmark::State& state)
+    {
+        SAFE_MEMFREE(payloadArray.payloadBuffer);
+        SAFE_MEMFREE(payloadArray.payloadSubLength);
+        WebRtcClientBenchmarkBase::TearDown(state);
+    }
+
+    // Annex-B frames get their parameter sets and a single slice, the payload bytes never contain a zero so no start
+    // code shows up inside a NALU
+    VOID generateFrame(RtpPayloaderBenchmarkCodec& codec, UINT32 frameSize)
+    {
+        frame.clear();
+        for (auto& naluHeader : codec.naluHeaders) {
+            frame.insert(frame.end(), {0x00, 0x00, 0x00, 0x01});
+            frame.insert(frame.end(), naluHeader.begin(), naluHeader.end());
+        }
+
+        SRAND(0);
+        while (frame.size() < frameSize) {
+            frame.push_back((BYTE) (RAND() % 255 + 1));
+        }
+    }
+
+    std::vector<BYTE> frame;
+    PayloadArray payloadArray;
+};
+
+// state.range(0) indexes RTP_PAYLOADER_BENCHMARK_CODECS, state.range(1) is the frame size
+static VOID rtpPayloaderBenchmarkArguments(benchmark::internal::Benchmark* pBenchmark)
+{
+    pBenchmark->Args({0, RTP_PAYLOADER_BENCHMARK_SMALL_VIDEO_FRAME_SIZE})->Args({0, RTP_PAYLOADER_BENCHMARK_LARGE_VIDEO_FRAME_SIZE});
+    pBenchmark->Args({1, RTP_PAYLOADER_BENCHMARK_SMALL_VIDEO_FRAME_SIZE})->Args({1, RTP_PAYLOADER_BENCHMARK_LARGE_VIDEO_FRAME_SIZE});
+    pBenchmark->Args({2, RTP_PAYLOADER_BENCHMARK_SMALL_VIDEO_FRAME_SIZE})->Args({2, RTP_PAYLOADER_BENCHMARK_LARGE_VIDEO_FRAME_SIZE});
+    pBenchmark->Args({3, RTP_PAYLOADER_BENCHMARK_OPUS_FRAME_SIZE});
+    pBenchmark->Args({4, RTP_PAYLOADER_BENCHMARK_G711_FRAME_SIZE});
+}
+
+BENCHMARK_DEFINE_F(RtpPayloaderBenchmark, BM_RtpPayload)(benchmark::State& state)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    RtpPayloaderBenchmarkCodec& codec = RTP_PAYLOADER_BENCHMARK_CODECS[state.range(0)];
+    INT64 packetCount = 0;
+
+    state.SetLabel(codec.name);
+
+    for (auto _ : state) {
+        CHK_STATUS(codec.payloadFn(DEFAULT_MTU_SIZE_BYTES, frame.data(), (UINT32) frame.size(), &payloadArray));
+        packetCount += payloadArray.payloadSubLenSize;
+    }
+    state.SetItemsProcessed(packetCount);
+    state.SetBytesProcessed((INT64) state.iterations() * (INT64) frame.size());
+
+CleanUp:
+
+    if (STATUS_FAILED(retStatus)) {
+        DLOGE("Rtp payloader benchmark failed with 0x%08x", retStatus);
+        state.SkipWithError("payloading failed");
+    }
+}
+
+BENCHMARK_DEFINE_F(RtpPayloaderBenchmark, BM_RtpDepayload)(benchmark::State& state)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    RtpPayloaderBenchmarkCodec& codec = RTP_PAYLOADER_BENCHMARK_CODECS[state.range(0)];
+    std::vector<BYTE> depayloadedFrame;
+    PBYTE pCurPtrInPayload;
+    UINT32 i, filledSize, depayloadedSize;
+    BOOL isStart;
+
+    state.SetLabel(codec.name);
+    CHK_STATUS(codec.payloadFn(DEFAULT_MTU_SIZE_BYTES, frame.data(), (UINT32) frame.size(), &payloadArray));
+    // Start codes are written back in front of every NALU, so the depayloaded frame can outgrow the original
+    depayloadedFrame.resize(frame.size() + payloadArray.payloadSubLenSize * SIZEOF(UINT32));
+
+    for (auto _ : state) {
+        pCurPtrInPayload = payloadArray.payloadBuffer;
+        filledSize = 0;
+        for (i = 0; i < payloadArray.payloadSubLenSize; i++) {
+            depayloadedSize = (UINT32) depayloadedFrame.size() - filledSize;
+            CHK_STATUS(codec.depayFn(pCurPtrInPayload, payloadArray.payloadSubLength[i], depayloadedFrame.data() + filledSize, &depayloadedSize,
+                                     &isStart));
+            pCurPtrInPayload += payloadArray.payloadSubLength[i];
+            filledSize += depayloadedSize;
+        }
+        benchmark::DoNotOptimize(filledSize);
+    }
+    state.SetItemsProcessed((INT64) state.iterations() * payloadArray.payloadSubLenSize);
+    state.SetBytesProcessed((INT64) state.iterations() * (INT64) frame.size());
+
+CleanUp:
+
+    if (STATUS_FAILED(retStatus)) {
+        DLOGE("Rtp depayloader benchmark failed with 0x%08x", retStatus);
+        state.SkipWithError("depayloading failed");
+    }
+}
+
+BENCHMARK_REGISTER_F(RtpPayloaderBenchmark, BM_RtpPayload)->Apply(rtpPayloaderBenchmarkArguments);
+BENCHMARK_REGISTER_F(RtpPayloaderBenchmark, BM_RtpDepayload)->Apply(rtpPayloaderBenchmarkArguments);
+
+} // namespace webrtcclient
+} // namespace video
+} // namespace kinesis
+} // namespace amazonaws
+} // namespace com
@@ -0,0 +1,289 @@
+#include "WebRTCClientBenchmarkFixture.h"
+
+// Packets protected or unprotected per benchmark iteration. Unprotect needs fresh sequence numbers, which are
+// protected for the next batch with the timing paused.
+#define SRTP_BENCHMARK_BATCH_SIZE 64
+#define SRTP_BENCHMARK_SSRC       0x12345678
+
+// Sender report without report blocks, each report block adds 24 bytes
+#define SRTCP_BENCHMARK_SENDER_REPORT_LEN (RTCP_PACKET_HEADER_LEN + 24)
+#define SRTCP_BENCHMARK_REPORT_BLOCK_LEN  24
+
+namespace com {
+namespace amazonaws {
+namespace kinesis {
+namespace video {
+namespace webrtcclient {
+
+static KVS_SRTP_PROFILE SRTP_BENCHMARK_PROFILES[] = {
+    KVS_SRTP_PROFILE_AES128_CM_HMAC_SHA1_80,
+    KVS_SRTP_PROFILE_AES128_CM_HMAC_SHA1_32,
+#ifdef KVS_USE_OPENSSL
+    KVS_SRTP_PROFILE_AEAD_AES_128_GCM,
+    KVS_SRTP_PROFILE_AEAD_AES_256_GCM,
+#endif
+};
+
+static PCHAR SRTP_BENCHMARK_PROFILE_NAMES[] = {
+    (PCHAR) "AES128_CM_HMAC_SHA1_80",
+    (PCHAR) "AES128_CM_HMAC_SHA1_32",
+#ifdef KVS_USE_OPENSSL
+    (PCHAR) "AEAD_AES_128_GCM",
+    (PCHAR) "AEAD_AES_256_GCM",
+#endif
+};
+
+class SrtpBenchmark : public WebRtcClientBenchmarkBase {
+  public:
+    // Large enough for the master key and salt of every profile
+    BYTE key[MAX_SRTP_MASTER_KEY_LEN + MAX_SRTP_SALT_KEY_LEN];
+    PBYTE packets[SRTP_BENCHMARK_BATCH_SIZE];
+    INT32 packetLens[SRTP_BENCHMARK_BATCH_SIZE];
+    UINT16 sequenceNumber;
+
+    // AES-GCM needs a libsrtp built with its OpenSSL backend, a system srtp2 may not have it
+    BOOL profileSupported(benchmark::State& state)
+    {
+        BOOL supported = FALSE;
+
+        if (STATUS_FAILED(srtpSessionIsProfileSupported(SRTP_BENCHMARK_PROFILES[state.range(0)], &supported)) || !supported) {
+            state.SkipWithError("profile not supported by libsrtp");
+        }
+
+        return supported;
+    }
+
+    STATUS setUpPackets(INT32 packetSize)
+    {
+        STATUS retStatus = STATUS_SUCCESS;
+        UINT32 i;
+
+        for (i = 0; i < SIZEOF(key); i++) {
+            key[i] = (BYTE) i;
+        }
+
+        MEMSET(packets, 0x00, SIZEOF(packets));
+        sequenceNumber = 0;
+        for (i = 0; i < SRTP_BENCHMARK_BATCH_SIZE; i++) {
+            CHK(NULL != (packets[i] = (PBYTE) MEMALLOC(packetSize + SRTP_MAX_TRAILER_LEN)), STATUS_NOT_ENOUGH_MEMORY);
+            MEMSET(packets[i], 0x11, packetSize);
+        }
+
+    CleanUp:
+
+        return retStatus;
+    }
+
+    VOID freePackets()
+    {
+        UINT32 i;
+
+        for (i = 0; i < SRTP_BENCHMARK_BATCH_SIZE; i++) {
+            SAFE_MEMFREE(packets[i]);
+        }
+    }
+
+    // Writes a plain rtp header with the next sequence number, libsrtp refuses to protect or unprotect an index twice
+    VOID resetPackets(INT32 payloadSize)
+    {
+        UINT32 i;
+
+        for (i = 0; i < SRTP_BENCHMARK_BATCH_SIZE; i++) {
+            packets[i][0] = 0x80;
+            packets[i][1] = DEFAULT_PAYLOAD_H264;
+            putUnalignedInt16BigEndian(packets[i] + 2, sequenceNumber++);
+            putUnalignedInt32BigEndian(packets[i] + 4, 0);
+            putUnalignedInt32BigEndian(packets[i] + 8, SRTP_BENCHMARK_SSRC);
+            packetLens[i] = MIN_HEADER_LENGTH + payloadSize;
+        }
+    }
+
+    // Writes a sender report header. The srtcp index is kept by the sending session, every protect uses a new one
+    VOID resetRtcpPackets(INT32 packetSize)
+    {
+        UINT32 i;
+
+        for (i = 0; i < SRTP_BENCHMARK_BATCH_SIZE; i++) {
+            packets[i][0] = (RTCP_PACKET_VERSION_VAL << 6) | ((packetSize - SRTCP_BENCHMARK_SENDER_REPORT_LEN) / SRTCP_BENCHMARK_REPORT_BLOCK_LEN);
+            packets[i][1] = RTCP_PACKET_TYPE_SENDER_REPORT;
+            putUnalignedInt16BigEndian(packets[i] + 2, packetSize / SIZEOF(UINT32) - 1);
+            putUnalignedInt32BigEndian(packets[i] + RTCP_PACKET_HEADER_LEN, SRTP_BENCHMARK_SSRC);
+            packetLens[i] = packetSize;
+        }
+    }
+};
+
+// state.range(0) indexes SRTP_BENCHMARK_PROFILES, state.range(1) is the rtp payload size
+static VOID srtpBenchmarkArguments(benchmark::internal::Benchmark* pBenchmark)
+{
+    for (INT64 profile = 0; profile < (INT64) ARRAY_SIZE(SRTP_BENCHMARK_PROFILES); profile++) {
+        for (INT64 payloadSize : {160, 1200}) {
+            pBenchmark->Args({profile, payloadSize});
+        }
+    }
+}
+
+// state.range(0) indexes SRTP_BENCHMARK_PROFILES, state.range(1) is the rtcp packet size: a bare sender report or one with two report blocks
+static VOID srtcpBenchmarkArguments(benchmark::internal::Benchmark* pBenchmark)
+{
+    for (INT64 profile = 0; profile < (INT64) ARRAY_SIZE(SRTP_BENCHMARK_PROFILES); profile++) {
+        for (INT64 packetSize : {SRTCP_BENCHMARK_SENDER_REPORT_LEN, SRTCP_BENCHMARK_SENDER_REPORT_LEN + 2 * SRTCP_BENCHMARK_REPORT_BLOCK_LEN}) {
+            pBenchmark->Args({profile, packetSize});
+        }
+    }
+}
+
+BENCHMARK_DEFINE_F(SrtpBenchmark, BM_SrtpProtect)(benchmark::State& state)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    PSrtpSession pSrtpSession = NULL;
+    INT32 payloadSize = (INT32) state.range(1);
+    UINT32 i;
+
+    state.SetLabel(SRTP_BENCHMARK_PROFILE_NAMES[state.range(0)]);
+    CHK(profileSupported(state), retStatus);
+    CHK_STATUS(setUpPackets(MIN_HEADER_LENGTH + payloadSize));
+    CHK_STATUS(initSrtpSession(key, key, SRTP_BENCHMARK_PROFILES[state.range(0)], &pSrtpSession));
+
+    for (auto _ : state) {
+        resetPackets(payloadSize);
+        for (i = 0; i < SRTP_BENCHMARK_BATCH_SIZE; i++) {
+            CHK_STATUS(encryptRtpPacket(pSrtpSession, packets[i], &packetLens[i]));
+        }
+    }
+    state.SetItemsProcessed((INT64) state.iterations() * SRTP_BENCHMARK_BATCH_SIZE);
+    state.SetBytesProcessed((INT64) state.iterations() * SRTP_BENCHMARK_BATCH_SIZE * payloadSize);
+
+CleanUp:
+
+    if (STATUS_FAILED(retStatus)) {
+        DLOGE("Srtp benchmark failed with 0x%08x", retStatus);
+        state.SkipWithError("srtp protect failed");
+    }
+
+    freeSrtpSession(&pSrtpSession);
+    freePackets();
+}
+
+BENCHMARK_DEFINE_F(SrtpBenchmark, BM_SrtpUnprotect)(benchmark::State& state)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    PSrtpSession pSenderSession = NULL, pReceiverSession = NULL;
+    INT32 payloadSize = (INT32) state.range(1);
+    UINT32 i;
+
+    state.SetLabel(SRTP_BENCHMARK_PROFILE_NAMES[state.range(0)]);
+    CHK(profileSupported(state), retStatus);
+    CHK_STATUS(setUpPackets(MIN_HEADER_LENGTH + payloadSize));
+    CHK_STATUS(initSrtpSession(key, key, SRTP_BENCHMARK_PROFILES[state.range(0)], &pSenderSession));
+    CHK_STATUS(initSrtpSession(key, key, SRTP_BENCHMARK_PROFILES[state.range(0)], &pReceiverSession));
+
+    for (auto _ : state) {
+        state.PauseTiming();
+        resetPackets(payloadSize);
+        for (i = 0; i < SRTP_BENCHMARK_BATCH_SIZE; i++) {
+            CHK_STATUS(encryptRtpPacket(pSenderSession, packets[i], &packetLens[i]));
+        }
+        state.ResumeTiming();
+
+        for (i = 0; i < SRTP_BENCHMARK_BATCH_SIZE; i++) {
+            CHK_STATUS(decryptSrtpPacket(pReceiverSession, packets[i], &packetLens[i]));
+        }
+    }
+    state.SetItemsProcessed((INT64) state.iterations() * SRTP_BENCHMARK_BATCH_SIZE);
+    state.SetBytesProcessed((INT64) state.iterations() * SRTP_BENCHMARK_BATCH_SIZE * payloadSize);
+
+CleanUp:
+
+    if (STATUS_FAILED(retStatus)) {
+        DLOGE("Srtp benchmark failed with 0x%08x", retStatus);
+        state.SkipWithError("srtp unprotect failed");
+    }
+
+    freeSrtpSession(&pSenderSession);
+    freeSrtpSession(&pReceiverSession);
+    freePackets();
+}
+
+BENCHMARK_DEFINE_F(SrtpBenchmark, BM_SrtcpProtect)(benchmark::State& state)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    PSrtpSession pSrtpSession = NULL;
+    INT32 packetSize = (INT32) state.range(1);
+    UINT32 i;
+
+    state.SetLabel(SRTP_BENCHMARK_PROFILE_NAMES[state.range(0)]);
+    CHK(profileSupported(state), retStatus);
+    CHK_STATUS(setUpPackets(packetSize));
+    CHK_STATUS(initSrtpSession(key, key, SRTP_BENCHMARK_PROFILES[state.range(0)], &pSrtpSession));
+
+    for (auto _ : state) {
+        resetRtcpPackets(packetSize);
+        for (i = 0; i < SRTP_BENCHMARK_BATCH_SIZE; i++) {
+            CHK_STATUS(encryptRtcpPacket(pSrtpSession, packets[i], &packetLens[i]));
+        }
+    }
+    state.SetItemsProcessed((INT64) state.iterations() * SRTP_BENCHMARK_BATCH_SIZE);
+    state.SetBytesProcessed((INT64) state.iterations() * SRTP_BENCHMARK_BATCH_SIZE * packetSize);
+
+CleanUp:
+
+    if (STATUS_FAILED(retStatus)) {
+        DLOGE("Srtcp benchmark failed with 0x%08x", retStatus);
+        state.SkipWithError("srtcp protect failed");
+    }
+
+    freeSrtpSession(&pSrtpSession);
+    freePackets();
+}
+
+BENCHMARK_DEFINE_F(SrtpBenchmark, BM_SrtcpUnprotect)(benchmark::State& state)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    PSrtpSession pSenderSession = NULL, pReceiverSession = NULL;
+    INT32 packetSize = (INT32) state.range(1);
+    UINT32 i;
+
+    state.SetLabel(SRTP_BENCHMARK_PROFILE_NAMES[state.range(0)]);
+    CHK(profileSupported(state), retStatus);
+    CHK_STATUS(setUpPackets(packetSize));
+    CHK_STATUS(initSrtpSession(key, key, SRTP_BENCHMARK_PROFILES[state.range(0)], &pSenderSession));
+    CHK_STATUS(initSrtpSession(key, key, SRTP_BENCHMARK_PROFILES[state.range(0)], &pReceiverSession));
+
+    for (auto _ : state) {
+        state.PauseTiming();
+        resetRtcpPackets(packetSize);
+        for (i = 0; i < SRTP_BENCHMARK_BATCH_SIZE; i++) {
+            CHK_STATUS(encryptRtcpPacket(pSenderSession, packets[i], &packetLens[i]));
+        }
+        state.ResumeTiming();
+
+        for (i = 0; i < SRTP_BENCHMARK_BATCH_SIZE; i++) {
+            CHK_STATUS(decryptSrtcpPacket(pReceiverSession, packets[i], &packetLens[i]));
+        }
+    }
+    state.SetItemsProcessed((INT64) state.iterations() * SRTP_BENCHMARK_BATCH_SIZE);
+    state.SetBytesProcessed((INT64) state.iterations() * SRTP_BENCHMARK_BATCH_SIZE * packetSize);
+
+CleanUp:
+
+    if (STATUS_FAILED(retStatus)) {
+        DLOGE("Srtcp benchmark failed with 0x%08x", retStatus);
+        state.SkipWithError("srtcp unprotect failed");
+    }
+
+    freeSrtpSession(&pSenderSession);
+    freeSrtpSession(&pReceiverSession);
+    freePackets();
+}
+
+BENCHMARK_REGISTER_F(SrtpBenchmark, BM_SrtpProtect)->Apply(srtpBenchmarkArguments);
+BENCHMARK_REGISTER_F(SrtpBenchmark, BM_SrtpUnprotect)->Apply(srtpBenchmarkArguments);
+BENCHMARK_REGISTER_F(SrtpBenchmark, BM_SrtcpProtect)->Apply(srtcpBenchmarkArguments);
+BENCHMARK_REGISTER_F(SrtpBenchmark, BM_SrtcpUnprotect)->Apply(srtcpBenchmarkArguments);
+
+} // namespace webrtcclient
+} // namespace video
+} // namespace kinesis
+} // namespace amazonaws
+} // namespace com
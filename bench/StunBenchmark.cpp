@@ -0,0 +1,178 @@
+#include "WebRTCClientBenchmarkFixture.h"
+
+namespace com {
+namespace amazonaws {
+namespace kinesis {
+namespace video {
+namespace webrtcclient {
+
+// Same length as the passwords generated for the local ice credentials
+#define STUN_BENCHMARK_PASSWORD (PCHAR) "bf1f29259cea581c873248d4ae73b30f"
+
+#define STUN_BENCHMARK_USERNAME (PCHAR) "remoteUfrag:localUfrag"
+
+#define STUN_BENCHMARK_TIE_BREAKER 0x0123456789abcdefULL
+
+class StunBenchmark : public WebRtcClientBenchmarkBase {
+  public:
+    VOID SetUp(const ::benchmark::State& state)
+    {
+        WebRtcClientBenchmarkBase::SetUp(state);
+
+        passwordLen = (UINT32) STRLEN(STUN_BENCHMARK_PASSWORD);
+        kvsSha1HmacKeyInit(&hmacKey, (PBYTE) STUN_BENCHMARK_PASSWORD, passwordLen);
+
+        MEMSET(&address, 0x00, SIZEOF(KvsIpAddress));
+        address.family = KVS_IP_FAMILY_TYPE_IPV4;
+        address.port = (UINT16) getInt16(50000);
+        address.address[0] = 192;
+        address.address[1] = 168;
+        address.address[2] = 1;
+        address.address[3] = 10;
+
+        // Connectivity check the way the ice agent sends it
+        createStunPacket(STUN_PACKET_TYPE_BINDING_REQUEST, NULL, &pBindingRequest);
+        appendStunUsernameAttribute(pBindingRequest, STUN_BENCHMARK_USERNAME);
+        appendStunPriorityAttribute(pBindingRequest, 0x7e7f00ff);
+        appendStunIceControllAttribute(pBindingRequest, STUN_ATTRIBUTE_TYPE_ICE_CONTROLLING, STUN_BENCHMARK_TIE_BREAKER);
+        appendStunFlagAttribute(pBindingRequest, STUN_ATTRIBUTE_TYPE_USE_CANDIDATE);
+        bindingRequestSize = SIZEOF(bindingRequest);
+        iceUtilsPackageStunPacket(pBindingRequest, (PBYTE) STUN_BENCHMARK_PASSWORD, passwordLen, bindingRequest, &bindingRequestSize);
+
+        MEMCPY(transactionId, pBindingRequest->header.transactionId, STUN_TRANSACTION_ID_LEN);
+    }
+
+    VOID TearDown(const ::benchmark::State& state)
+    {
+        freeStunPacket(&pBindingRequest);
+        WebRtcClientBenchmarkBase::TearDown(state);
+    }
+
+    KvsSha1HmacKey hmacKey;
+    UINT32 passwordLen;
+    KvsIpAddress address;
+    PStunPacket pBindingRequest = NULL;
+    BYTE transactionId[STUN_TRANSACTION_ID_LEN];
+    BYTE bindingRequest[STUN_PACKET_ALLOCATION_SIZE];
+    UINT32 bindingRequestSize;
+    UINT64 stunPacketStorage[STUN_PACKET_ALLOCATION_SIZE / SIZEOF(UINT64)];
+};
+
+// HMAC of a binding request with the password, what every message used to pay
+BENCHMARK_DEFINE_F(StunBenchmark, BM_StunHmacPassword)(benchmark::State& state)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    BYTE hmac[KVS_SHA1_DIGEST_LENGTH];
+    UINT32 hmacLen;
+
+    for (auto _ : state) {
+        KVS_SHA1_HMAC((PBYTE) STUN_BENCHMARK_PASSWORD, passwordLen, bindingRequest, bindingRequestSize, hmac, &hmacLen);
+        benchmark::DoNotOptimize(hmac);
+    }
+
+CleanUp:
+    if (STATUS_FAILED(retStatus)) {
+        state.SkipWithError("HMAC failed");
+    }
+}
+
+BENCHMARK_DEFINE_F(StunBenchmark, BM_StunHmacPrecomputedKey)(benchmark::State& state)
+{
+    BYTE hmac[KVS_SHA1_DIGEST_LENGTH];
+
+    for (auto _ : state) {
+        kvsSha1HmacKeyCompute(&hmacKey, bindingRequest, bindingRequestSize, hmac);
+        benchmark::DoNotOptimize(hmac);
+    }
+}
+
+BENCHMARK_DEFINE_F(StunBenchmark, BM_StunSerializeBindingRequestPassword)(benchmark::State& state)
+{
+    BYTE buffer[STUN_PACKET_ALLOCATION_SIZE];
+    UINT32 size;
+
+    for (auto _ : state) {
+        size = SIZEOF(buffer);
+        iceUtilsPackageStunPacket(pBindingRequest, (PBYTE) STUN_BENCHMARK_PASSWORD, passwordLen, buffer, &size);
+        benchmark::DoNotOptimize(buffer);
+    }
+}
+
+BENCHMARK_DEFINE_F(StunBenchmark, BM_StunSerializeBindingRequestHmacKey)(benchmark::State& state)
+{
+    BYTE buffer[STUN_PACKET_ALLOCATION_SIZE];
+    UINT32 size;
+
+    for (auto _ : state) {
+        size = SIZEOF(buffer);
+        iceUtilsPackageStunPacketWithHmacKey(pBindingRequest, &hmacKey, buffer, &size);
+        benchmark::DoNotOptimize(buffer);
+    }
+}
+
+// Decode and validate an inbound binding request, allocating the packet and hashing the password
+BENCHMARK_DEFINE_F(StunBenchmark, BM_StunDeserializeBindingRequestPassword)(benchmark::State& state)
+{
+    PStunPacket pStunPacket = NULL;
+
+    for (auto _ : state) {
+        deserializeStunPacket(bindingRequest, bindingRequestSize, (PBYTE) STUN_BENCHMARK_PASSWORD, passwordLen, &pStunPacket);
+        freeStunPacket(&pStunPacket);
+    }
+}
+
+BENCHMARK_DEFINE_F(StunBenchmark, BM_StunDeserializeBindingRequestHmacKey)(benchmark::State& state)
+{
+    PStunPacket pStunPacket = NULL;
+
+    for (auto _ : state) {
+        deserializeStunPacketWithHmacKey(bindingRequest, bindingRequestSize, &hmacKey, (PStunPacket) stunPacketStorage, SIZEOF(stunPacketStorage),
+                                         &pStunPacket);
+        benchmark::DoNotOptimize(pStunPacket);
+    }
+}
+
+// Binding success response built the way handleStunPacket used to
+BENCHMARK_DEFINE_F(StunBenchmark, BM_StunBindingResponseCreate)(benchmark::State& state)
+{
+    PStunPacket pStunResponse = NULL;
+    BYTE buffer[STUN_PACKET_ALLOCATION_SIZE];
+    UINT32 size;
+
+    for (auto _ : state) {
+        createStunPacket(STUN_PACKET_TYPE_BINDING_RESPONSE_SUCCESS, transactionId, &pStunResponse);
+        appendStunAddressAttribute(pStunResponse, STUN_ATTRIBUTE_TYPE_XOR_MAPPED_ADDRESS, &address);
+        appendStunIceControllAttribute(pStunResponse, STUN_ATTRIBUTE_TYPE_ICE_CONTROLLED, STUN_BENCHMARK_TIE_BREAKER);
+        size = SIZEOF(buffer);
+        iceUtilsPackageStunPacket(pStunResponse, (PBYTE) STUN_BENCHMARK_PASSWORD, passwordLen, buffer, &size);
+        freeStunPacket(&pStunResponse);
+        benchmark::DoNotOptimize(buffer);
+    }
+}
+
+BENCHMARK_DEFINE_F(StunBenchmark, BM_StunBindingResponsePackage)(benchmark::State& state)
+{
+    BYTE buffer[STUN_BINDING_RESPONSE_MAX_LEN];
+    UINT32 size;
+
+    for (auto _ : state) {
+        size = SIZEOF(buffer);
+        stunPackageBindingResponse(transactionId, &address, STUN_ATTRIBUTE_TYPE_ICE_CONTROLLED, STUN_BENCHMARK_TIE_BREAKER, &hmacKey, buffer, &size);
+        benchmark::DoNotOptimize(buffer);
+    }
+}
+
+BENCHMARK_REGISTER_F(StunBenchmark, BM_StunHmacPassword);
+BENCHMARK_REGISTER_F(StunBenchmark, BM_StunHmacPrecomputedKey);
+BENCHMARK_REGISTER_F(StunBenchmark, BM_StunSerializeBindingRequestPassword);
+BENCHMARK_REGISTER_F(StunBenchmark, BM_StunSerializeBindingRequestHmacKey);
+BENCHMARK_REGISTER_F(StunBenchmark, BM_StunDeserializeBindingRequestPassword);
+BENCHMARK_REGISTER_F(StunBenchmark, BM_StunDeserializeBindingRequestHmacKey);
+BENCHMARK_REGISTER_F(StunBenchmark, BM_StunBindingResponseCreate);
+BENCHMARK_REGISTER_F(StunBenchmark, BM_StunBindingResponsePackage);
+
+} // namespace webrtcclient
+} // namespace video
+} // namespace kinesis
+} // namespace amazonaws
+} // namespace com
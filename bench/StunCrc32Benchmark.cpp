@@ -0,0 +1,93 @@
+#include "WebRTCClientBenchmarkFixture.h"
+
+namespace com {
+namespace amazonaws {
+namespace kinesis {
+namespace video {
+namespace webrtcclient {
+
+#define STUN_CRC32_BENCHMARK_MAX_LENGTH 2048
+
+class StunCrc32Benchmark : public WebRtcClientBenchmarkBase {
+  public:
+    VOID SetUp(const ::benchmark::State& state)
+    {
+        UINT32 i;
+
+        WebRtcClientBenchmarkBase::SetUp(state);
+
+        SRAND(12345);
+        for (i = 0; i < SIZEOF(buffer); i++) {
+            buffer[i] = (BYTE) RAND();
+        }
+    }
+
+    VOID runCrc32(benchmark::State& state, StunCrc32Func crc32Func)
+    {
+        UINT32 length = (UINT32) state.range(0);
+
+        for (auto _ : state) {
+            benchmark::DoNotOptimize(crc32Func(buffer, length));
+        }
+
+        state.SetBytesProcessed((INT64) state.iterations() * length);
+    }
+
+    BYTE buffer[STUN_CRC32_BENCHMARK_MAX_LENGTH];
+};
+
+// Table driven crc32 the fingerprint used to be computed with
+static UINT32 computeCrc32(PBYTE pData, UINT32 length)
+{
+    return COMPUTE_CRC32(pData, length);
+}
+
+BENCHMARK_DEFINE_F(StunCrc32Benchmark, BM_StunCrc32ComputeCrc32)(benchmark::State& state)
+{
+    runCrc32(state, computeCrc32);
+}
+
+BENCHMARK_DEFINE_F(StunCrc32Benchmark, BM_StunCrc32SliceBy8)(benchmark::State& state)
+{
+    runCrc32(state, stunCrc32SliceBy8);
+}
+
+BENCHMARK_DEFINE_F(StunCrc32Benchmark, BM_StunCrc32Pclmul)(benchmark::State& state)
+{
+#ifdef KVS_STUN_CRC32_PCLMUL_SUPPORTED
+    if (stunCrc32PclmulAvailable()) {
+        runCrc32(state, stunCrc32Pclmul);
+        return;
+    }
+#endif
+    state.SkipWithError("PCLMULQDQ is not available");
+}
+
+BENCHMARK_DEFINE_F(StunCrc32Benchmark, BM_StunCrc32Armv8)(benchmark::State& state)
+{
+#ifdef KVS_STUN_CRC32_ARMV8_SUPPORTED
+    if (stunCrc32Armv8Available()) {
+        runCrc32(state, stunCrc32Armv8);
+        return;
+    }
+#endif
+    state.SkipWithError("ARMv8 crc32 instructions are not available");
+}
+
+// What serializeStunPacket and deserializeStunPacket call
+BENCHMARK_DEFINE_F(StunCrc32Benchmark, BM_StunCrc32Dispatch)(benchmark::State& state)
+{
+    runCrc32(state, stunCrc32);
+}
+
+BENCHMARK_REGISTER_F(StunCrc32Benchmark, BM_StunCrc32ComputeCrc32)->Range(16, STUN_CRC32_BENCHMARK_MAX_LENGTH);
+BENCHMARK_REGISTER_F(StunCrc32Benchmark, BM_StunCrc32SliceBy8)->Range(16, STUN_CRC32_BENCHMARK_MAX_LENGTH);
+BENCHMARK_REGISTER_F(StunCrc32Benchmark, BM_StunCrc32Pclmul)->Range(16, STUN_CRC32_BENCHMARK_MAX_LENGTH);
+BENCHMARK_REGISTER_F(StunCrc32Benchmark, BM_StunCrc32Armv8)->Range(16, STUN_CRC32_BENCHMARK_MAX_LENGTH);
+BENCHMARK_REGISTER_F(StunCrc32Benchmark, BM_StunCrc32Dispatch)->Range(16, STUN_CRC32_BENCHMARK_MAX_LENGTH);
+
+} // namespace webrtcclient
+} // namespace video
+} // namespace kinesis
+} // namespace amazonaws
+} // namespace com
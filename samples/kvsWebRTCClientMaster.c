@@ -175,6 +175,8 @@ PVOID sendVideoPackets(PVOID args)
     UINT32 fileIndex = 0, frameSize;
     CHAR filePath[MAX_PATH_LEN + 1];
     STATUS status;
+    PRtcRtpTransceiver videoTransceivers[DEFAULT_MAX_CONCURRENT_STREAMING_SESSION];
+    STATUS writeStatuses[DEFAULT_MAX_CONCURRENT_STREAMING_SESSION];
     UINT32 i;
     UINT64 startTime, lastFrameTime, elapsed;
     MEMSET(&encoderStats, 0x00, SIZEOF(RtcEncoderStats));
@@ -212,8 +214,13 @@ PVOID sendVideoPackets(PVOID args)
         encoderStats.targetBitrate = 262000;
         frame.presentationTs += SAMPLE_VIDEO_FRAME_DURATION;
         MUTEX_LOCK(pSampleConfiguration->streamingSessionListReadLock);
+        // Every viewer gets the same frame, packetize it once for all of them
         for (i = 0; i < pSampleConfiguration->streamingSessionCount; ++i) {
-            status = writeFrame(pSampleConfiguration->sampleStreamingSessionList[i]->pVideoRtcRtpTransceiver, &frame);
+            videoTransceivers[i] = pSampleConfiguration->sampleStreamingSessionList[i]->pVideoRtcRtpTransceiver;
+        }
+        writeFrameToTransceivers(videoTransceivers, pSampleConfiguration->streamingSessionCount, &frame, writeStatuses);
+        for (i = 0; i < pSampleConfiguration->streamingSessionCount; ++i) {
+            status = writeStatuses[i];
             if (pSampleConfiguration->sampleStreamingSessionList[i]->firstFrame && status == STATUS_SUCCESS) {
                 PROFILE_WITH_START_TIME(pSampleConfiguration->sampleStreamingSessionList[i]->offerReceiveTime, "Time to first frame");
                 pSampleConfiguration->sampleStreamingSessionList[i]->firstFrame = FALSE;
@@ -190,6 +190,7 @@ extern "C" {
 #define STATUS_CREATE_SOCKET_PAIR_FAILED           STATUS_NETWORKING_BASE + 0x00000027
 #define STATUS_SOCKET_WRITE_FAILED                 STATUS_NETWORKING_BASE + 0X00000028
 #define STATUS_INVALID_ADDRESS_LENGTH              STATUS_NETWORKING_BASE + 0X00000029
+#define STATUS_SOCKET_EPOLL_FAILED                 STATUS_NETWORKING_BASE + 0x0000002a
 
 /*!@} */
 
@@ -256,6 +257,7 @@ extern "C" {
 #define STATUS_TURN_CONNECTION_ALLOCATION_FAILED                           STATUS_ICE_BASE + 0x0000002a
 #define STATUS_TURN_INVALID_STATE                                          STATUS_ICE_BASE + 0x0000002b
 #define STATUS_TURN_CONNECTION_GET_CREDENTIALS_FAILED                      STATUS_ICE_BASE + 0x0000002c
+#define STATUS_TURN_CONNECTION_PEER_IN_USE                                 STATUS_ICE_BASE + 0x0000002d
 
 /*!@} */
 
@@ -284,11 +286,12 @@ extern "C" {
  * WEBRTC RTP related codes. Values are derived from STATUS_RTP_BASE (0x5c000000)
  *  @{
  */
-#define STATUS_RTP_BASE                   STATUS_SRTP_BASE + 0x01000000
-#define STATUS_RTP_INPUT_PACKET_TOO_SMALL STATUS_RTP_BASE + 0x00000001
-#define STATUS_RTP_INPUT_MTU_TOO_SMALL    STATUS_RTP_BASE + 0x00000002
-#define STATUS_RTP_INVALID_NALU           STATUS_RTP_BASE + 0x00000003
-#define STATUS_RTP_INVALID_EXTENSION_LEN  STATUS_RTP_BASE + 0x00000004
+#define STATUS_RTP_BASE                         STATUS_SRTP_BASE + 0x01000000
+#define STATUS_RTP_INPUT_PACKET_TOO_SMALL       STATUS_RTP_BASE + 0x00000001
+#define STATUS_RTP_INPUT_MTU_TOO_SMALL          STATUS_RTP_BASE + 0x00000002
+#define STATUS_RTP_INVALID_NALU                 STATUS_RTP_BASE + 0x00000003
+#define STATUS_RTP_INVALID_EXTENSION_LEN        STATUS_RTP_BASE + 0x00000004
+#define STATUS_RTP_JITTER_BUFFER_MISSING_PACKET STATUS_RTP_BASE + 0x00000005
 /*!@} */
 
 /////////////////////////////////////////////////////
@@ -983,6 +986,24 @@ typedef enum {
  */
 typedef VOID (*RtcOnFrame)(UINT64, PFrame);
 
+/**
+ * @brief One contiguous slice of a received frame handed to RtcOnFrameIov
+ */
+typedef struct {
+    PBYTE pData; //!< Start of the slice, points into a received packet or into transceiver owned memory
+    UINT32 size; //!< Size of the slice in bytes
+} RtcFrameIov, *PRtcFrameIov;
+
+/**
+ * @brief RtcOnFrameIov is fired everytime a frame is received from the remote peer, same as
+ * RtcOnFrame, but the frame is described by slices of the received packets instead of being
+ * copied into one contiguous buffer. Frame::frameData is NULL and Frame::size is the sum of
+ * all slice sizes. Slices are only valid until the callback returns.
+ *
+ * NOTE: RtcOnFrameIov is a KVS specific method
+ */
+typedef VOID (*RtcOnFrameIov)(UINT64, PFrame, PRtcFrameIov, UINT32);
+
 /**
  * @brief RtcOnBandwidthEstimation is fired everytime a bandwidth estimation value
  * is computed. This will be fired for receiver side estimation
@@ -1180,7 +1201,9 @@ typedef struct {
                                           //!< that has USE_CANDIDATE attribute after connection check is done. Use default value if 0.
 
     UINT32 iceConnectionCheckPollingInterval; //!< Ta in https://datatracker.ietf.org/doc/html/rfc8445#section-14.2
-                                              //!< rate at which binding request packets are sent during connection check. Use default interval if 0.
+                                              //!< One connectivity check is started every Ta in candidate pair priority order. Checks
+                                              //!< triggered by the peer's binding requests are sent right away. Use default interval of
+                                              //!< 50 ms if 0. Lower values down to 5 ms speed up agents with many candidate pairs.
 
     INT32 generatedCertificateBits; //!< GeneratedCertificateBits controls the amount of bits the locally generated self-signed certificate uses
                                     //!< A smaller amount of bits may result in less CPU usage on startup, but will cause a weaker certificate to be
@@ -1199,6 +1222,32 @@ typedef struct {
     BOOL disableSenderSideBandwidthEstimation; //!< Disable TWCC feedback based sender bandwidth estimation, enabled by default.
                                                //!< You want to set this to TRUE if you are on a very stable connection and want to save 1.2MB of
                                                //!< memory
+
+    BOOL enableSharedTurnAllocations; //!< Share TURN allocations with every other peer connection in the process that uses the same TURN server,
+                                      //!< transport and credentials. Each remote candidate gets its own channel binding on the shared allocation,
+                                      //!< saving an allocation, a socket and a refresh timer per peer connection. Disabled by default.
+
+    BOOL enableIceFirstPairFastPath; //!< Start DTLS and media on the first ice candidate pair that succeeds instead of waiting for nomination,
+                                     //!< then move to higher priority pairs, e.g. host over relay, as they succeed. Data may be sent on any valid
+                                     //!< pair before one is selected (rfc8445 section 12), so switching needs no renegotiation. Once ice is ready
+                                     //!< the nominated pair is used. Shortens KvsPeerConnectionDiagnostics.iceHolePunchingTime. Disabled by default.
+
+    BOOL enableIceCandidateCache; //!< Gather host candidates from a process wide cache of the local interface addresses, kept up to date from
+                                  //!< netlink notifications on Linux, and of udp sockets bound to them ahead of time. Ice server host names are
+                                  //!< resolved once per process and refreshed in the background. Saves interface enumeration, socket binding
+                                  //!< and dns lookups on every peer connection. The cache is not used for the interfaces when
+                                  //!< iceSetInterfaceFilterFunc is set. Disabled by default.
+
+    BOOL enableCertificatePool; //!< Take the DTLS certificate from a process wide pool that generates certificates and keys of the configured
+                                //!< type and size on a background thread ahead of time, instead of generating one while creating the peer
+                                //!< connection. Pooled certificates are rotated after a day and each one is still used by a single peer
+                                //!< connection. Not used when RtcConfiguration.certificates are provided. Disabled by default.
+
+    UINT32 connectionListenerWorkerCount; //!< Receive on a process wide connection listener with this many threads instead of a listener thread per
+                                          //!< peer connection. Where epoll is available each thread waits on its own shard of the sockets of every
+                                          //!< peer connection, elsewhere a single thread polls them. The first peer connection using it sets the
+                                          //!< number of threads, up to 16. Shared TURN allocations set up by such a peer connection use it as well.
+                                          //!< A listener per peer connection is used if 0, the default.
 #ifdef ENABLE_STATS_CALCULATION_CONTROL
     BOOL enableIceStats; //!< Control whether ICE agent stats are to be calculated. ENABLE_STATS_CALCULATION_CONTROL compiler flag must be defined
                          //!< to use this member, else stats are enabled by default.
@@ -1856,6 +1905,18 @@ PUBLIC_API STATUS addTransceiver(PRtcPeerConnection, PRtcMediaStreamTrack, PRtcR
  */
 PUBLIC_API STATUS transceiverOnFrame(PRtcRtpTransceiver, UINT64, RtcOnFrame);
 
+/**
+ * @brief Set a callback receiving transceiver frames as a list of slices, avoiding the copy
+ * into a contiguous frame buffer. When set it is used instead of the RtcOnFrame callback.
+ *
+ * @param[in] PRtcRtpTransceiver Populated RtcRtpTransceiver struct
+ * @param[in] UINT64 User customData that will be passed along when RtcOnFrameIov is called
+ * @param[in] RtcOnFrameIov User RtcOnFrameIov callback
+ *
+ * @return STATUS code of the execution. STATUS_SUCCESS on success
+ */
+PUBLIC_API STATUS transceiverOnFrameIov(PRtcRtpTransceiver, UINT64, RtcOnFrameIov);
+
 /**
  * @brief Set a callback for bandwidth estimation results
  *
@@ -1926,6 +1987,25 @@ PUBLIC_API STATUS addSupportedCodec(PRtcPeerConnection, RTC_CODEC);
  */
 PUBLIC_API STATUS writeFrame(PRtcRtpTransceiver, PFrame);
 
+/**
+ * @brief Packetizes a frame once and sends it via every given RtcRtpTransceiver
+ *
+ * Meant for sending the same media to many viewers. The frame is packetized once per distinct codec and MTU,
+ * only the RTP header, SRTP protection and the send itself happen per transceiver. With enough transceivers
+ * and the threadpool enabled the per transceiver work runs in parallel.
+ *
+ * NOTE: A transceiver MUST appear at most once and MUST NOT be written to concurrently from another thread
+ *
+ * @param[in] PRtcRtpTransceiver* Array of configured RtcRtpTransceivers to send media
+ * @param[in] UINT32 Number of transceivers in the array
+ * @param[in] PFrame Frame of media that will be sent
+ * @param[out,opt] STATUS* Optional array receiving the writeFrame equivalent status of every transceiver
+ *
+ * @return STATUS code of the execution. STATUS_SUCCESS when every transceiver either sent the frame or is not ready for SRTP yet,
+ *         otherwise the first failure
+ */
+PUBLIC_API STATUS writeFrameToTransceivers(PRtcRtpTransceiver*, UINT32, PFrame, STATUS*);
+
 /** @brief call this function to update stats which depend on external encoder
  *  @param[in] PRtcRtpTransceiver transceiver for which encoder stats will be updated
  *  @param[in] PRtcEncoderStats populated in the application layer which is then consumed as part
@@ -269,6 +269,7 @@ typedef struct {
     UINT64 iceAgentSetUpTime;
     UINT64 candidateGatheringStartTime;
     UINT64 candidateGatheringEndTime;
+    UINT64 iceCandidatePairFirstSucceededTime; //!< Time in ms from the start of the connectivity checks to the first pair that succeeded
 } KvsIceAgentStats, *PKvsIceAgentStats;
 
 /**
@@ -644,6 +645,8 @@ typedef struct {
     UINT64 closePeerConnectionTime;    //!< Time taken (ms) to close the peer connection
     UINT64 freePeerConnectionTime;     //!< Time taken (ms) to free the peer connection object
     UINT64 stunDnsResolutionTime;      //!< Time taken (ms) to complete STUN DNS resolution on the thread
+    UINT64 certificatePoolHitCount;    //!< Peer connections in the process that got a ready certificate from the certificate pool
+    UINT64 certificatePoolMissCount;   //!< Peer connections that found no ready certificate and generated one inline on their own thread
 } PeerConnectionStats, *PPeerConnectionStats;
 
 /**
@@ -0,0 +1,468 @@
+/**
+ * Kinesis Video DtlsCertificatePool
+ */
+#define LOG_CLASS "CertificatePool"
+#include "../Include_i.h"
+
+PDtlsCertificatePool getDtlsCertificatePoolInstance(VOID)
+{
+    static DtlsCertificatePool pool = {.isInitialized = FALSE,
+                                       .lock = INVALID_MUTEX_VALUE,
+                                       .cvar = INVALID_CVAR_VALUE,
+                                       .generatorTid = INVALID_TID_VALUE,
+                                       .shutdown = FALSE,
+                                       .entries = NULL,
+                                       .kindCount = 0,
+                                       .hitCount = 0,
+                                       .missCount = 0};
+    return &pool;
+}
+
+STATUS createDtlsCertificatePool(VOID)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    PDtlsCertificatePool pPool = getDtlsCertificatePoolInstance();
+
+    CHK_WARN(!pPool->isInitialized, retStatus, "Dtls certificate pool already set up. Nothing to do");
+
+    pPool->lock = MUTEX_CREATE(FALSE);
+    CHK(IS_VALID_MUTEX_VALUE(pPool->lock), STATUS_INVALID_OPERATION);
+    pPool->cvar = CVAR_CREATE();
+    CHK(IS_VALID_CVAR_VALUE(pPool->cvar), STATUS_INVALID_OPERATION);
+    CHK_STATUS(doubleListCreate(&pPool->entries));
+    pPool->generatorTid = INVALID_TID_VALUE;
+    pPool->shutdown = FALSE;
+    pPool->kindCount = 0;
+    pPool->hitCount = 0;
+    pPool->missCount = 0;
+    pPool->isInitialized = TRUE;
+
+CleanUp:
+
+    if (STATUS_FAILED(retStatus)) {
+        freeDtlsCertificatePool();
+    }
+
+    return retStatus;
+}
+
+static STATUS freeDtlsCertificatePoolEntry(PDtlsCertificatePoolEntry* ppEntry)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    PDtlsCertificatePoolEntry pEntry = NULL;
+
+    CHK(ppEntry != NULL, STATUS_NULL_ARG);
+    CHK(*ppEntry != NULL, retStatus);
+
+    pEntry = *ppEntry;
+
+#ifdef KVS_USE_OPENSSL
+    CHK_LOG_ERR(freeCertificateAndKey(&pEntry->certificateInfo.pCert, &pEntry->certificateInfo.pKey));
+#elif KVS_USE_MBEDTLS
+    CHK_LOG_ERR(freeCertificateAndKey(&pEntry->certificateInfo.cert, &pEntry->certificateInfo.privateKey));
+#else
+#error "A Crypto implementation is required."
+#endif
+
+    MEMFREE(pEntry);
+    *ppEntry = NULL;
+
+CleanUp:
+
+    return retStatus;
+}
+
+/*
+ * Generates a certificate and key without holding the pool lock
+ */
+static STATUS createDtlsCertificatePoolEntry(BOOL generateRSACertificate, INT32 certificateBits, PDtlsCertificatePoolEntry* ppEntry)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    PDtlsCertificatePoolEntry pEntry = NULL;
+    UINT64 startTimeInMacro = 0;
+    INT32 generatedBits = certificateBits == 0 ? GENERATED_CERTIFICATE_BITS : certificateBits;
+
+    CHK(ppEntry != NULL, STATUS_NULL_ARG);
+    CHK(NULL != (pEntry = (PDtlsCertificatePoolEntry) MEMCALLOC(1, SIZEOF(DtlsCertificatePoolEntry))), STATUS_NOT_ENOUGH_MEMORY);
+
+#ifdef KVS_USE_OPENSSL
+    PROFILE_CALL(CHK_STATUS(createCertificateAndKey(generatedBits, generateRSACertificate, &pEntry->certificateInfo.pCert,
+                                                    &pEntry->certificateInfo.pKey)),
+                 "Certificate creation time");
+    pEntry->certificateInfo.created = TRUE;
+#elif KVS_USE_MBEDTLS
+    PROFILE_CALL(CHK_STATUS(createCertificateAndKey(generatedBits, generateRSACertificate, &pEntry->certificateInfo.cert,
+                                                    &pEntry->certificateInfo.privateKey)),
+                 "Certificate creation time");
+#else
+#error "A Crypto implementation is required."
+#endif
+
+    pEntry->generateRSACertificate = generateRSACertificate;
+    pEntry->certificateBits = certificateBits;
+    pEntry->creationTime = GETTIME();
+
+CleanUp:
+
+    CHK_LOG_ERR(retStatus);
+
+    if (STATUS_FAILED(retStatus)) {
+        freeDtlsCertificatePoolEntry(&pEntry);
+    }
+
+    if (ppEntry != NULL) {
+        *ppEntry = pEntry;
+    }
+
+    return retStatus;
+}
+
+static BOOL dtlsCertificatePoolEntryExpired(PDtlsCertificatePoolEntry pEntry, UINT64 currentTime)
+{
+    return currentTime > pEntry->creationTime + DTLS_CERTIFICATE_POOL_MAX_AGE;
+}
+
+/*
+ * Takes an entry out of the pool. It is freed right away unless a session still has it
+ */
+static STATUS dtlsCertificatePoolRetireNode(PDtlsCertificatePool pPool, PDoubleListNode pNode)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    PDtlsCertificatePoolEntry pEntry = (PDtlsCertificatePoolEntry) pNode->data;
+
+    // Assume holding pPool->lock
+    CHK_STATUS(doubleListDeleteNode(pPool->entries, pNode));
+    pEntry->retired = TRUE;
+    if (pEntry->refCount == 0) {
+        CHK_STATUS(freeDtlsCertificatePoolEntry(&pEntry));
+    }
+
+CleanUp:
+
+    return retStatus;
+}
+
+STATUS freeDtlsCertificatePool(VOID)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    PDtlsCertificatePool pPool = getDtlsCertificatePoolInstance();
+    PDoubleListNode pCurNode = NULL;
+
+    if (IS_VALID_TID_VALUE(pPool->generatorTid)) {
+        MUTEX_LOCK(pPool->lock);
+        pPool->shutdown = TRUE;
+        CVAR_BROADCAST(pPool->cvar);
+        MUTEX_UNLOCK(pPool->lock);
+
+        // waits for a certificate being generated
+        THREAD_JOIN(pPool->generatorTid, NULL);
+        pPool->generatorTid = INVALID_TID_VALUE;
+    }
+
+    if (pPool->entries != NULL) {
+        // every peer connection is gone, nothing is handed out anymore
+        CHK_LOG_ERR(doubleListGetHeadNode(pPool->entries, &pCurNode));
+        while (pCurNode != NULL) {
+            CHK_LOG_ERR(dtlsCertificatePoolRetireNode(pPool, pCurNode));
+            CHK_LOG_ERR(doubleListGetHeadNode(pPool->entries, &pCurNode));
+        }
+
+        CHK_LOG_ERR(doubleListFree(pPool->entries));
+        pPool->entries = NULL;
+    }
+
+    if (IS_VALID_CVAR_VALUE(pPool->cvar)) {
+        CVAR_FREE(pPool->cvar);
+        pPool->cvar = INVALID_CVAR_VALUE;
+    }
+
+    if (IS_VALID_MUTEX_VALUE(pPool->lock)) {
+        MUTEX_FREE(pPool->lock);
+        pPool->lock = INVALID_MUTEX_VALUE;
+    }
+
+    pPool->kindCount = 0;
+    pPool->shutdown = FALSE;
+    pPool->isInitialized = FALSE;
+
+    return retStatus;
+}
+
+/*
+ * Records that a certificate of the type and size was asked for so the generator keeps some ready
+ */
+static VOID dtlsCertificatePoolTouchKind(PDtlsCertificatePool pPool, BOOL generateRSACertificate, INT32 certificateBits, UINT64 currentTime)
+{
+    UINT32 i;
+    PDtlsCertificatePoolKind pKind = NULL;
+
+    // Assume holding pPool->lock
+    for (i = 0; i < pPool->kindCount && pKind == NULL; ++i) {
+        if (pPool->kinds[i].generateRSACertificate == generateRSACertificate && pPool->kinds[i].certificateBits == certificateBits) {
+            pKind = &pPool->kinds[i];
+        }
+    }
+
+    if (pKind == NULL) {
+        if (pPool->kindCount == DTLS_CERTIFICATE_POOL_MAX_KIND_COUNT) {
+            DLOGW("Certificate pool only keeps %u certificate types ready, generating on demand", DTLS_CERTIFICATE_POOL_MAX_KIND_COUNT);
+            return;
+        }
+
+        pKind = &pPool->kinds[pPool->kindCount++];
+        pKind->generateRSACertificate = generateRSACertificate;
+        pKind->certificateBits = certificateBits;
+    }
+
+    pKind->lastRequestTime = currentTime;
+}
+
+STATUS dtlsCertificatePoolAcquire(INT32 certificateBits, BOOL generateRSACertificate, PRtcCertificate pRtcCertificate,
+                                  PDtlsCertificatePoolEntry* ppEntry)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    PDtlsCertificatePool pPool = getDtlsCertificatePoolInstance();
+    PDtlsCertificatePoolEntry pEntry = NULL, pCurEntry;
+    PDoubleListNode pCurNode = NULL, pNextNode = NULL;
+    UINT64 currentTime = GETTIME();
+    BOOL locked = FALSE;
+
+    CHK(pRtcCertificate != NULL && ppEntry != NULL, STATUS_NULL_ARG);
+    CHK(pPool->isInitialized, STATUS_INVALID_OPERATION);
+
+    // the size only matters for RSA, so every ECDSA request shares the same certificates
+    if (!generateRSACertificate) {
+        certificateBits = 0;
+    } else if (certificateBits == 0) {
+        certificateBits = GENERATED_CERTIFICATE_BITS;
+    }
+
+    MUTEX_LOCK(pPool->lock);
+    locked = TRUE;
+
+    CHK(!pPool->shutdown, STATUS_INVALID_OPERATION);
+    dtlsCertificatePoolTouchKind(pPool, generateRSACertificate, certificateBits, currentTime);
+
+    CHK_STATUS(doubleListGetHeadNode(pPool->entries, &pCurNode));
+    while (pCurNode != NULL && pEntry == NULL) {
+        pCurEntry = (PDtlsCertificatePoolEntry) pCurNode->data;
+        pNextNode = pCurNode->pNext;
+
+        if (dtlsCertificatePoolEntryExpired(pCurEntry, currentTime)) {
+            CHK_STATUS(dtlsCertificatePoolRetireNode(pPool, pCurNode));
+        } else if (pCurEntry->generateRSACertificate == generateRSACertificate && pCurEntry->certificateBits == certificateBits) {
+            pEntry = pCurEntry;
+            pEntry->useCount++;
+            pEntry->refCount++;
+            if (pEntry->useCount >= DTLS_CERTIFICATE_POOL_MAX_USE_COUNT) {
+                CHK_STATUS(dtlsCertificatePoolRetireNode(pPool, pCurNode));
+            }
+        }
+
+        pCurNode = pNextNode;
+    }
+
+    if (pEntry != NULL) {
+        pPool->hitCount++;
+    } else {
+        pPool->missCount++;
+    }
+
+    // start generating ahead for the next sessions
+    if (!IS_VALID_TID_VALUE(pPool->generatorTid)) {
+        CHK_STATUS(THREAD_CREATE(&pPool->generatorTid, dtlsCertificatePoolGeneratorRoutine, (PVOID) pPool));
+    }
+
+    CVAR_SIGNAL(pPool->cvar);
+    MUTEX_UNLOCK(pPool->lock);
+    locked = FALSE;
+
+    if (pEntry == NULL) {
+        DLOGD("No %s certificate ready in the pool, generating one", generateRSACertificate ? "RSA" : "ECDSA");
+        CHK_STATUS(createDtlsCertificatePoolEntry(generateRSACertificate, certificateBits, &pEntry));
+        pEntry->useCount = 1;
+        pEntry->refCount = 1;
+        pEntry->retired = TRUE;
+    }
+
+    MEMSET(pRtcCertificate, 0x00, SIZEOF(RtcCertificate));
+#ifdef KVS_USE_OPENSSL
+    pRtcCertificate->pCertificate = (PBYTE) pEntry->certificateInfo.pCert;
+    pRtcCertificate->pPrivateKey = (PBYTE) pEntry->certificateInfo.pKey;
+#elif KVS_USE_MBEDTLS
+    pRtcCertificate->pCertificate = (PBYTE) &pEntry->certificateInfo.cert;
+    pRtcCertificate->certificateSize = SIZEOF(mbedtls_x509_crt);
+    pRtcCertificate->pPrivateKey = (PBYTE) &pEntry->certificateInfo.privateKey;
+    pRtcCertificate->privateKeySize = SIZEOF(mbedtls_pk_context);
+#else
+#error "A Crypto implementation is required."
+#endif
+
+    *ppEntry = pEntry;
+    pEntry = NULL;
+
+CleanUp:
+
+    if (locked) {
+        MUTEX_UNLOCK(pPool->lock);
+    }
+
+    if (pEntry != NULL) {
+        dtlsCertificatePoolRelease(&pEntry);
+    }
+
+    CHK_LOG_ERR(retStatus);
+
+    return retStatus;
+}
+
+STATUS dtlsCertificatePoolRelease(PDtlsCertificatePoolEntry* ppEntry)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    PDtlsCertificatePool pPool = getDtlsCertificatePoolInstance();
+    PDtlsCertificatePoolEntry pEntry = NULL;
+    BOOL freeEntry = FALSE;
+
+    CHK(ppEntry != NULL, STATUS_NULL_ARG);
+    CHK(*ppEntry != NULL, retStatus);
+
+    pEntry = *ppEntry;
+
+    MUTEX_LOCK(pPool->lock);
+    pEntry->refCount--;
+    freeEntry = pEntry->retired && pEntry->refCount == 0;
+    MUTEX_UNLOCK(pPool->lock);
+
+    if (freeEntry) {
+        CHK_STATUS(freeDtlsCertificatePoolEntry(&pEntry));
+    }
+
+    *ppEntry = NULL;
+
+CleanUp:
+
+    return retStatus;
+}
+
+STATUS dtlsCertificatePoolGetHitCounts(PUINT64 pHitCount, PUINT64 pMissCount)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    PDtlsCertificatePool pPool = getDtlsCertificatePoolInstance();
+
+    CHK(pHitCount != NULL && pMissCount != NULL, STATUS_NULL_ARG);
+
+    *pHitCount = 0;
+    *pMissCount = 0;
+    CHK(pPool->isInitialized, retStatus);
+
+    MUTEX_LOCK(pPool->lock);
+    *pHitCount = pPool->hitCount;
+    *pMissCount = pPool->missCount;
+    MUTEX_UNLOCK(pPool->lock);
+
+CleanUp:
+
+    return retStatus;
+}
+
+/*
+ * Drops expired certificates and certificate types nobody asked for in a while, then returns the first type with fewer
+ * than DTLS_CERTIFICATE_POOL_READY_COUNT certificates ready, if any
+ */
+static STATUS dtlsCertificatePoolCollect(PDtlsCertificatePool pPool, PDtlsCertificatePoolKind pMissingKind, PBOOL pMissing)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    PDoubleListNode pCurNode = NULL, pNextNode = NULL;
+    PDtlsCertificatePoolEntry pEntry;
+    UINT64 currentTime = GETTIME();
+    UINT32 readyCounts[DTLS_CERTIFICATE_POOL_MAX_KIND_COUNT];
+    UINT32 i, kindIndex;
+
+    // Assume holding pPool->lock
+    *pMissing = FALSE;
+
+    i = 0;
+    while (i < pPool->kindCount) {
+        if (currentTime > pPool->kinds[i].lastRequestTime + DTLS_CERTIFICATE_POOL_IDLE_TIMEOUT) {
+            MEMMOVE(&pPool->kinds[i], &pPool->kinds[i + 1], (pPool->kindCount - i - 1) * SIZEOF(DtlsCertificatePoolKind));
+            pPool->kindCount--;
+        } else {
+            readyCounts[i++] = 0;
+        }
+    }
+
+    CHK_STATUS(doubleListGetHeadNode(pPool->entries, &pCurNode));
+    while (pCurNode != NULL) {
+        pEntry = (PDtlsCertificatePoolEntry) pCurNode->data;
+        pNextNode = pCurNode->pNext;
+
+        for (kindIndex = 0; kindIndex < pPool->kindCount; ++kindIndex) {
+            if (pPool->kinds[kindIndex].generateRSACertificate == pEntry->generateRSACertificate &&
+                pPool->kinds[kindIndex].certificateBits == pEntry->certificateBits) {
+                break;
+            }
+        }
+
+        if (kindIndex == pPool->kindCount || dtlsCertificatePoolEntryExpired(pEntry, currentTime)) {
+            CHK_STATUS(dtlsCertificatePoolRetireNode(pPool, pCurNode));
+        } else {
+            readyCounts[kindIndex]++;
+        }
+
+        pCurNode = pNextNode;
+    }
+
+    for (i = 0; i < pPool->kindCount && !*pMissing; ++i) {
+        if (readyCounts[i] < DTLS_CERTIFICATE_POOL_READY_COUNT) {
+            *pMissingKind = pPool->kinds[i];
+            *pMissing = TRUE;
+        }
+    }
+
+CleanUp:
+
+    return retStatus;
+}
+
+PVOID dtlsCertificatePoolGeneratorRoutine(PVOID arg)
+{
+    STATUS retStatus = STATUS_SUCCESS, generateStatus;
+    PDtlsCertificatePool pPool = (PDtlsCertificatePool) arg;
+    PDtlsCertificatePoolEntry pEntry = NULL;
+    DtlsCertificatePoolKind kind;
+    BOOL missing = FALSE;
+
+    CHK(pPool != NULL, STATUS_NULL_ARG);
+
+    MUTEX_LOCK(pPool->lock);
+    while (!pPool->shutdown) {
+        CHK_LOG_ERR(dtlsCertificatePoolCollect(pPool, &kind, &missing));
+
+        if (!missing) {
+            // timing out is expected, certificates still have to be rotated
+            CVAR_WAIT(pPool->cvar, pPool->lock, DTLS_CERTIFICATE_POOL_CHECK_PERIOD);
+            continue;
+        }
+
+        // key generation takes a while, sessions can keep taking certificates meanwhile
+        MUTEX_UNLOCK(pPool->lock);
+        generateStatus = createDtlsCertificatePoolEntry(kind.generateRSACertificate, kind.certificateBits, &pEntry);
+        MUTEX_LOCK(pPool->lock);
+
+        if (STATUS_FAILED(generateStatus)) {
+            // do not spin on a failing generator
+            CVAR_WAIT(pPool->cvar, pPool->lock, DTLS_CERTIFICATE_POOL_CHECK_PERIOD);
+        } else if (!pPool->shutdown && STATUS_SUCCEEDED(doubleListInsertItemTail(pPool->entries, (UINT64) pEntry))) {
+            pEntry = NULL;
+        }
+
+        freeDtlsCertificatePoolEntry(&pEntry);
+    }
+    MUTEX_UNLOCK(pPool->lock);
+
+CleanUp:
+
+    CHK_LOG_ERR(retStatus);
+
+    return NULL;
+}
@@ -0,0 +1,126 @@
+//
+// Dtls certificate pool
+//
+
+#ifndef __KINESIS_VIDEO_WEBRTC_CLIENT_CRYPTO_CERTIFICATE_POOL__
+#define __KINESIS_VIDEO_WEBRTC_CLIENT_CRYPTO_CERTIFICATE_POOL__
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Number of certificates kept ready for each certificate type and size in use
+#define DTLS_CERTIFICATE_POOL_READY_COUNT 4
+
+// Number of dtls sessions a certificate is handed to. 1 keeps every session on its own certificate like without the pool
+#define DTLS_CERTIFICATE_POOL_MAX_USE_COUNT 1
+
+// Certificates older than this are not handed out anymore and replaced by new ones
+#define DTLS_CERTIFICATE_POOL_MAX_AGE (1 * HUNDREDS_OF_NANOS_IN_A_DAY)
+
+// Certificate types and sizes nobody asked for in this long are no longer generated
+#define DTLS_CERTIFICATE_POOL_IDLE_TIMEOUT (1 * HUNDREDS_OF_NANOS_IN_AN_HOUR)
+
+// How often the generator thread checks for certificates to rotate when there is nothing to generate
+#define DTLS_CERTIFICATE_POOL_CHECK_PERIOD (1 * HUNDREDS_OF_NANOS_IN_A_MINUTE)
+
+// Max number of certificate types and sizes generated ahead of time
+#define DTLS_CERTIFICATE_POOL_MAX_KIND_COUNT 4
+
+typedef struct {
+    BOOL generateRSACertificate;
+    // 0 for ECDSA, the size only applies to RSA
+    INT32 certificateBits;
+    UINT64 lastRequestTime;
+} DtlsCertificatePoolKind, *PDtlsCertificatePoolKind;
+
+typedef struct {
+    DtlsSessionCertificateInfo certificateInfo;
+    BOOL generateRSACertificate;
+    INT32 certificateBits;
+    UINT64 creationTime;
+    // Number of times handed out
+    UINT32 useCount;
+    // Handed out and not released yet
+    UINT32 refCount;
+    // No longer in the pool, freed on the last release
+    BOOL retired;
+} DtlsCertificatePoolEntry, *PDtlsCertificatePoolEntry;
+
+/**
+ * Process wide pool of generated certificates and keys. The generator thread is started by the first acquire and keeps
+ * DTLS_CERTIFICATE_POOL_READY_COUNT certificates ready for every certificate type and size asked for, so creating a dtls
+ * session does not have to wait for key generation.
+ */
+typedef struct {
+    BOOL isInitialized;
+    MUTEX lock;
+    // Signaled when a certificate is taken or the pool shuts down
+    CVAR cvar;
+    TID generatorTid;
+    BOOL shutdown;
+    // PDtlsCertificatePoolEntry items, oldest first
+    PDoubleList entries;
+    DtlsCertificatePoolKind kinds[DTLS_CERTIFICATE_POOL_MAX_KIND_COUNT];
+    UINT32 kindCount;
+    UINT64 hitCount;
+    UINT64 missCount;
+} DtlsCertificatePool, *PDtlsCertificatePool;
+
+PDtlsCertificatePool getDtlsCertificatePoolInstance(VOID);
+
+/**
+ * Sets up the process wide pool. Called by initKvsWebRtc
+ *
+ * @return - STATUS code of the execution
+ */
+STATUS createDtlsCertificatePool(VOID);
+
+/**
+ * Stops the generator thread and frees the certificates left in the pool. Called by deinitKvsWebRtc once all peer
+ * connections are freed
+ *
+ * @return - STATUS code of the execution
+ */
+STATUS freeDtlsCertificatePool(VOID);
+
+/**
+ * Takes a ready certificate of the type and size, or generates one on the calling thread if there is none. The
+ * certificate is exposed as an RtcCertificate that createDtlsSession accepts like an application provided one.
+ *
+ * @param - INT32 - IN - RSA key size, GENERATED_CERTIFICATE_BITS if 0
+ * @param - BOOL - IN - RSA if TRUE, ECDSA otherwise
+ * @param - PRtcCertificate - OUT - The certificate and key, valid until released
+ * @param - PDtlsCertificatePoolEntry* - OUT - Entry to release
+ *
+ * @return - STATUS code of the execution
+ */
+STATUS dtlsCertificatePoolAcquire(INT32, BOOL, PRtcCertificate, PDtlsCertificatePoolEntry*);
+
+/**
+ * Releases a certificate once createDtlsSession copied or referenced it. Idempotent.
+ *
+ * @param - PDtlsCertificatePoolEntry* - IN/OUT - Entry, set to NULL
+ *
+ * @return - STATUS code of the execution
+ */
+STATUS dtlsCertificatePoolRelease(PDtlsCertificatePoolEntry*);
+
+/**
+ * Number of acquires served from the pool and generated on the calling thread
+ *
+ * @param - PUINT64 - OUT - hits
+ * @param - PUINT64 - OUT - misses
+ *
+ * @return - STATUS code of the execution
+ */
+STATUS dtlsCertificatePoolGetHitCounts(PUINT64, PUINT64);
+
+PVOID dtlsCertificatePoolGeneratorRoutine(PVOID);
+
+#ifdef __cplusplus
+}
+#endif
+#endif //__KINESIS_VIDEO_WEBRTC_CLIENT_CRYPTO_CERTIFICATE_POOL__
@@ -79,3 +79,95 @@ CleanUp:
     LEAVES();
     return retStatus;
 }
+
+STATUS kvsSha1HmacKeyInit(PKvsSha1HmacKey pHmacKey, PBYTE key, UINT32 keyLen)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    BYTE paddedKey[KVS_SHA1_BLOCK_LENGTH], hashedKey[KVS_SHA1_DIGEST_LENGTH];
+    UINT32 i;
+
+    CHK(pHmacKey != NULL && (key != NULL || keyLen == 0), STATUS_NULL_ARG);
+
+    // Keys longer than a block are hashed first per rfc2104
+    if (keyLen > KVS_SHA1_BLOCK_LENGTH) {
+#ifdef KVS_USE_OPENSSL
+        CHK(NULL != SHA1(key, keyLen, hashedKey), STATUS_HMAC_GENERATION_ERROR);
+#elif KVS_USE_MBEDTLS
+        CHK(0 == mbedtls_sha1_ret(key, keyLen, hashedKey), STATUS_HMAC_GENERATION_ERROR);
+#endif
+        key = hashedKey;
+        keyLen = KVS_SHA1_DIGEST_LENGTH;
+    }
+
+    MEMSET(paddedKey, 0x36, SIZEOF(paddedKey));
+    for (i = 0; i < keyLen; i++) {
+        paddedKey[i] ^= key[i];
+    }
+
+#ifdef KVS_USE_OPENSSL
+    CHK(1 == SHA1_Init(&pHmacKey->innerContext) && 1 == SHA1_Update(&pHmacKey->innerContext, paddedKey, SIZEOF(paddedKey)),
+        STATUS_HMAC_GENERATION_ERROR);
+#elif KVS_USE_MBEDTLS
+    mbedtls_sha1_init(&pHmacKey->innerContext);
+    CHK(0 == mbedtls_sha1_starts_ret(&pHmacKey->innerContext) && 0 == mbedtls_sha1_update_ret(&pHmacKey->innerContext, paddedKey, SIZEOF(paddedKey)),
+        STATUS_HMAC_GENERATION_ERROR);
+#endif
+
+    // 0x36 ^ 0x5c turns the inner pad into the outer pad
+    for (i = 0; i < SIZEOF(paddedKey); i++) {
+        paddedKey[i] ^= 0x36 ^ 0x5c;
+    }
+
+#ifdef KVS_USE_OPENSSL
+    CHK(1 == SHA1_Init(&pHmacKey->outerContext) && 1 == SHA1_Update(&pHmacKey->outerContext, paddedKey, SIZEOF(paddedKey)),
+        STATUS_HMAC_GENERATION_ERROR);
+#elif KVS_USE_MBEDTLS
+    mbedtls_sha1_init(&pHmacKey->outerContext);
+    CHK(0 == mbedtls_sha1_starts_ret(&pHmacKey->outerContext) && 0 == mbedtls_sha1_update_ret(&pHmacKey->outerContext, paddedKey, SIZEOF(paddedKey)),
+        STATUS_HMAC_GENERATION_ERROR);
+#endif
+
+CleanUp:
+
+    MEMSET(paddedKey, 0x00, SIZEOF(paddedKey));
+
+    return retStatus;
+}
+
+STATUS kvsSha1HmacKeyCompute(PKvsSha1HmacKey pHmacKey, PBYTE pMessage, UINT32 messageLen, PBYTE pHmac)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    BYTE innerDigest[KVS_SHA1_DIGEST_LENGTH];
+#ifdef KVS_USE_OPENSSL
+    SHA_CTX context;
+#elif KVS_USE_MBEDTLS
+    mbedtls_sha1_context context;
+
+    mbedtls_sha1_init(&context);
+#endif
+
+    CHK(pHmacKey != NULL && (pMessage != NULL || messageLen == 0) && pHmac != NULL, STATUS_NULL_ARG);
+
+#ifdef KVS_USE_OPENSSL
+    // SHA_CTX holds no pointers, copying it forks the hash state
+    context = pHmacKey->innerContext;
+    CHK(1 == SHA1_Update(&context, pMessage, messageLen) && 1 == SHA1_Final(innerDigest, &context), STATUS_HMAC_GENERATION_ERROR);
+    context = pHmacKey->outerContext;
+    CHK(1 == SHA1_Update(&context, innerDigest, SIZEOF(innerDigest)) && 1 == SHA1_Final(pHmac, &context), STATUS_HMAC_GENERATION_ERROR);
+#elif KVS_USE_MBEDTLS
+    mbedtls_sha1_clone(&context, &pHmacKey->innerContext);
+    CHK(0 == mbedtls_sha1_update_ret(&context, pMessage, messageLen) && 0 == mbedtls_sha1_finish_ret(&context, innerDigest),
+        STATUS_HMAC_GENERATION_ERROR);
+    mbedtls_sha1_clone(&context, &pHmacKey->outerContext);
+    CHK(0 == mbedtls_sha1_update_ret(&context, innerDigest, SIZEOF(innerDigest)) && 0 == mbedtls_sha1_finish_ret(&context, pHmac),
+        STATUS_HMAC_GENERATION_ERROR);
+#endif
+
+CleanUp:
+
+#ifdef KVS_USE_MBEDTLS
+    mbedtls_sha1_free(&context);
+#endif
+
+    return retStatus;
+}
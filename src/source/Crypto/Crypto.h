@@ -30,6 +30,8 @@ extern "C" {
 typedef enum {
     KVS_SRTP_PROFILE_AES128_CM_HMAC_SHA1_80 = SRTP_AES128_CM_SHA1_80,
     KVS_SRTP_PROFILE_AES128_CM_HMAC_SHA1_32 = SRTP_AES128_CM_SHA1_32,
+    KVS_SRTP_PROFILE_AEAD_AES_128_GCM = SRTP_AEAD_AES_128_GCM,
+    KVS_SRTP_PROFILE_AEAD_AES_256_GCM = SRTP_AEAD_AES_256_GCM,
 } KVS_SRTP_PROFILE;
 #elif KVS_USE_MBEDTLS
 #define KVS_RSA_F4                  0x10001L
@@ -59,6 +61,45 @@ typedef enum {
 #error "A Crypto implementation is required."
 #endif
 
+#define KVS_SHA1_BLOCK_LENGTH 64
+
+/**
+ * SHA1 HMAC key with the inner and outer padded key blocks already hashed. Messages signed with it only cost their own
+ * hashing, which for short messages like STUN is a fraction of hashing the two key blocks from scratch every time.
+ */
+typedef struct {
+#ifdef KVS_USE_OPENSSL
+    SHA_CTX innerContext;
+    SHA_CTX outerContext;
+#elif KVS_USE_MBEDTLS
+    mbedtls_sha1_context innerContext;
+    mbedtls_sha1_context outerContext;
+#endif
+} KvsSha1HmacKey, *PKvsSha1HmacKey;
+
+/**
+ * Hashes the padded key blocks of the key
+ *
+ * @param - PKvsSha1HmacKey - OUT - HMAC key to initialize
+ * @param - PBYTE - IN - Key
+ * @param - UINT32 - IN - Key length
+ *
+ * @return - STATUS code of the execution
+ */
+STATUS kvsSha1HmacKeyInit(PKvsSha1HmacKey, PBYTE, UINT32);
+
+/**
+ * Same result as KVS_SHA1_HMAC with the key the HMAC key was initialized with
+ *
+ * @param - PKvsSha1HmacKey - IN - Initialized HMAC key
+ * @param - PBYTE - IN - Message
+ * @param - UINT32 - IN - Message length
+ * @param - PBYTE - OUT - KVS_SHA1_DIGEST_LENGTH bytes of HMAC
+ *
+ * @return - STATUS code of the execution
+ */
+STATUS kvsSha1HmacKeyCompute(PKvsSha1HmacKey, PBYTE, UINT32, PBYTE);
+
 #ifdef __cplusplus
 }
 #endif
@@ -103,3 +103,63 @@ CleanUp:
     LEAVES();
     return retStatus;
 }
+
+STATUS dtlsSrtpProfileKeyLengths(KVS_SRTP_PROFILE profile, PUINT32 pMasterKeyLen, PUINT32 pSaltKeyLen)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+
+    CHK(pMasterKeyLen != NULL && pSaltKeyLen != NULL, STATUS_NULL_ARG);
+
+    switch (profile) {
+        // https://tools.ietf.org/html/rfc5764#section-4.1.2
+        case KVS_SRTP_PROFILE_AES128_CM_HMAC_SHA1_80:
+        case KVS_SRTP_PROFILE_AES128_CM_HMAC_SHA1_32:
+            *pMasterKeyLen = 16;
+            *pSaltKeyLen = 14;
+            break;
+#ifdef KVS_USE_OPENSSL
+        // https://tools.ietf.org/html/rfc7714#section-14.2
+        case KVS_SRTP_PROFILE_AEAD_AES_128_GCM:
+            *pMasterKeyLen = 16;
+            *pSaltKeyLen = 12;
+            break;
+        case KVS_SRTP_PROFILE_AEAD_AES_256_GCM:
+            *pMasterKeyLen = 32;
+            *pSaltKeyLen = 12;
+            break;
+#endif
+        default:
+            CHK(FALSE, STATUS_SSL_UNKNOWN_SRTP_PROFILE);
+    }
+
+CleanUp:
+
+    return retStatus;
+}
+
+STATUS dtlsSplitKeyingMaterial(PBYTE pKeyingMaterialBuffer, UINT32 masterKeyLen, UINT32 saltKeyLen, PDtlsKeyingMaterial pDtlsKeyingMaterial)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    UINT32 offset = 0;
+
+    CHK(pKeyingMaterialBuffer != NULL && pDtlsKeyingMaterial != NULL, STATUS_NULL_ARG);
+    CHK(masterKeyLen <= MAX_SRTP_MASTER_KEY_LEN && saltKeyLen <= MAX_SRTP_SALT_KEY_LEN, STATUS_INVALID_ARG);
+
+    // client key, server key, client salt then server salt: https://tools.ietf.org/html/rfc5764#section-4.2
+    pDtlsKeyingMaterial->key_length = (UINT8) (masterKeyLen + saltKeyLen);
+
+    MEMCPY(pDtlsKeyingMaterial->clientWriteKey, &pKeyingMaterialBuffer[offset], masterKeyLen);
+    offset += masterKeyLen;
+
+    MEMCPY(pDtlsKeyingMaterial->serverWriteKey, &pKeyingMaterialBuffer[offset], masterKeyLen);
+    offset += masterKeyLen;
+
+    MEMCPY(pDtlsKeyingMaterial->clientWriteKey + masterKeyLen, &pKeyingMaterialBuffer[offset], saltKeyLen);
+    offset += saltKeyLen;
+
+    MEMCPY(pDtlsKeyingMaterial->serverWriteKey + masterKeyLen, &pKeyingMaterialBuffer[offset], saltKeyLen);
+
+CleanUp:
+
+    return retStatus;
+}
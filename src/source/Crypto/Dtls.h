@@ -11,7 +11,7 @@
 extern "C" {
 #endif
 
-#define MAX_SRTP_MASTER_KEY_LEN   16
+#define MAX_SRTP_MASTER_KEY_LEN   32
 #define MAX_SRTP_SALT_KEY_LEN     14
 #define MAX_DTLS_RANDOM_BYTES_LEN 32
 #define MAX_DTLS_MASTER_KEY_LEN   48
@@ -64,7 +64,7 @@ typedef struct {
 } DtlsSessionCallbacks, *PDtlsSessionCallbacks;
 
 // DtlsKeyingMaterial is information extracted via https://tools.ietf.org/html/rfc5705
-// also includes the use_srtp value from Handshake
+// also includes the use_srtp value from Handshake. Each write key is the master key followed by the salt, both sized for the profile
 typedef struct {
     BYTE clientWriteKey[MAX_SRTP_MASTER_KEY_LEN + MAX_SRTP_SALT_KEY_LEN];
     BYTE serverWriteKey[MAX_SRTP_MASTER_KEY_LEN + MAX_SRTP_SALT_KEY_LEN];
@@ -108,6 +108,8 @@ struct __DtlsSession {
     volatile ATOMIC_BOOL isShutdown;
     volatile ATOMIC_BOOL isCleanUp;
     UINT32 certificateCount;
+    // Shared with the other sessions using the same application provided certificates, NULL otherwise
+    struct __DtlsContextCacheEntry* pContextCacheEntry;
     DtlsSessionCallbacks dtlsSessionCallbacks;
     TIMER_QUEUE_HANDLE timerQueueHandle;
     UINT32 timerId;
@@ -186,6 +188,8 @@ STATUS dtlsValidateRtcCertificates(PRtcCertificate, PUINT32);
 STATUS dtlsSessionChangeState(PDtlsSession, RTC_DTLS_TRANSPORT_STATE);
 
 STATUS dtlsFillPseudoRandomBits(PBYTE, UINT32);
+STATUS dtlsSrtpProfileKeyLengths(KVS_SRTP_PROFILE, PUINT32, PUINT32);
+STATUS dtlsSplitKeyingMaterial(PBYTE, UINT32, UINT32, PDtlsKeyingMaterial);
 
 #ifdef KVS_USE_OPENSSL
 STATUS dtlsCheckOutgoingDataBuffer(PDtlsSession);
@@ -198,6 +202,7 @@ STATUS createSslCtx(PDtlsSessionCertificateInfo, UINT32, SSL_CTX**);
 #elif KVS_USE_MBEDTLS
 STATUS dtlsCertificateFingerprint(mbedtls_x509_crt*, PCHAR);
 STATUS copyCertificateAndKey(mbedtls_x509_crt*, mbedtls_pk_context*, PDtlsSessionCertificateInfo);
+STATUS cloneCertificateAndKey(mbedtls_x509_crt*, mbedtls_pk_context*, PDtlsSessionCertificateInfo);
 STATUS createCertificateAndKey(INT32, BOOL, mbedtls_x509_crt*, mbedtls_pk_context*);
 STATUS freeCertificateAndKey(mbedtls_x509_crt*, mbedtls_pk_context*);
 
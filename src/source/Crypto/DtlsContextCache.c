@@ -0,0 +1,266 @@
+/**
+ * Kinesis Video DtlsContextCache
+ */
+#define LOG_CLASS "DtlsContextCache"
+#include "../Include_i.h"
+
+PDtlsContextCache getDtlsContextCacheInstance(VOID)
+{
+    static DtlsContextCache cache = {.isInitialized = FALSE, .lock = INVALID_MUTEX_VALUE, .entries = NULL};
+    return &cache;
+}
+
+STATUS createDtlsContextCache(VOID)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    PDtlsContextCache pCache = getDtlsContextCacheInstance();
+
+    CHK_WARN(!pCache->isInitialized, retStatus, "Dtls context cache already set up. Nothing to do");
+
+    pCache->lock = MUTEX_CREATE(FALSE);
+    CHK(IS_VALID_MUTEX_VALUE(pCache->lock), STATUS_INVALID_OPERATION);
+    CHK_STATUS(doubleListCreate(&pCache->entries));
+    pCache->isInitialized = TRUE;
+
+CleanUp:
+
+    if (STATUS_FAILED(retStatus)) {
+        freeDtlsContextCache();
+    }
+
+    return retStatus;
+}
+
+static STATUS freeDtlsContextCacheEntry(PDtlsContextCacheEntry* ppEntry)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    PDtlsContextCacheEntry pEntry = NULL;
+    UINT32 i;
+
+    CHK(ppEntry != NULL, STATUS_NULL_ARG);
+    CHK(*ppEntry != NULL, retStatus);
+
+    pEntry = *ppEntry;
+
+#ifdef KVS_USE_OPENSSL
+    if (pEntry->pSslCtx != NULL) {
+        SSL_CTX_free(pEntry->pSslCtx);
+    }
+
+    for (i = 0; i < pEntry->certificateCount; i++) {
+        CHK_LOG_ERR(freeCertificateAndKey(&pEntry->pCerts[i], &pEntry->pKeys[i]));
+    }
+#elif KVS_USE_MBEDTLS
+    for (i = 0; i < pEntry->certificateCount; i++) {
+        CHK_LOG_ERR(freeCertificateAndKey(&pEntry->certificates[i].cert, &pEntry->certificates[i].privateKey));
+    }
+#else
+#error "A Crypto implementation is required."
+#endif
+
+    MEMFREE(pEntry);
+    *ppEntry = NULL;
+
+CleanUp:
+
+    return retStatus;
+}
+
+STATUS freeDtlsContextCache(VOID)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    PDtlsContextCache pCache = getDtlsContextCacheInstance();
+    PDoubleListNode pCurNode = NULL;
+    PDtlsContextCacheEntry pEntry;
+
+    if (pCache->entries != NULL) {
+        // every peer connection is gone, entries left were not released
+        CHK_LOG_ERR(doubleListGetHeadNode(pCache->entries, &pCurNode));
+        while (pCurNode != NULL) {
+            pEntry = (PDtlsContextCacheEntry) pCurNode->data;
+            pCurNode = pCurNode->pNext;
+            CHK_LOG_ERR(freeDtlsContextCacheEntry(&pEntry));
+        }
+
+        CHK_LOG_ERR(doubleListFree(pCache->entries));
+        pCache->entries = NULL;
+    }
+
+    if (IS_VALID_MUTEX_VALUE(pCache->lock)) {
+        MUTEX_FREE(pCache->lock);
+        pCache->lock = INVALID_MUTEX_VALUE;
+    }
+
+    pCache->isInitialized = FALSE;
+
+    return retStatus;
+}
+
+static BOOL dtlsContextCacheEntryMatches(PDtlsContextCacheEntry pEntry, PRtcCertificate pRtcCertificates, UINT32 certCount)
+{
+    UINT32 i;
+    BOOL matches = pEntry->certificateCount == certCount;
+
+    for (i = 0; i < certCount && matches; i++) {
+#ifdef KVS_USE_OPENSSL
+        matches = pEntry->pCerts[i] == (X509*) pRtcCertificates[i].pCertificate && pEntry->pKeys[i] == (EVP_PKEY*) pRtcCertificates[i].pPrivateKey;
+#elif KVS_USE_MBEDTLS
+        // the application owns the structures and may reuse them, compare what they hold
+        matches = pEntry->certificates[i].cert.raw.len == ((mbedtls_x509_crt*) pRtcCertificates[i].pCertificate)->raw.len &&
+            MEMCMP(pEntry->certificates[i].cert.raw.p, ((mbedtls_x509_crt*) pRtcCertificates[i].pCertificate)->raw.p,
+                   pEntry->certificates[i].cert.raw.len) == 0;
+#else
+#error "A Crypto implementation is required."
+#endif
+    }
+
+    return matches;
+}
+
+static STATUS createDtlsContextCacheEntry(PRtcCertificate pRtcCertificates, UINT32 certCount, PDtlsContextCacheEntry* ppEntry)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    PDtlsContextCacheEntry pEntry = NULL;
+    UINT32 i;
+#ifdef KVS_USE_OPENSSL
+    DtlsSessionCertificateInfo certInfos[MAX_RTCCONFIGURATION_CERTIFICATES];
+#endif
+
+    CHK(NULL != (pEntry = (PDtlsContextCacheEntry) MEMCALLOC(1, SIZEOF(DtlsContextCacheEntry))), STATUS_NOT_ENOUGH_MEMORY);
+
+#ifdef KVS_USE_OPENSSL
+    MEMSET(certInfos, 0x00, SIZEOF(certInfos));
+    for (i = 0; i < certCount; i++) {
+        certInfos[i].pCert = (X509*) pRtcCertificates[i].pCertificate;
+        certInfos[i].pKey = (EVP_PKEY*) pRtcCertificates[i].pPrivateKey;
+    }
+
+    CHK_STATUS(createSslCtx(certInfos, certCount, &pEntry->pSslCtx));
+    // sessions of different peers must not resume each other
+    SSL_CTX_set_session_cache_mode(pEntry->pSslCtx, SSL_SESS_CACHE_OFF);
+
+    for (i = 0; i < certCount; i++) {
+        CHK_STATUS(dtlsCertificateFingerprint(certInfos[i].pCert, pEntry->certFingerprints[i]));
+#if (OPENSSL_VERSION_NUMBER >= 0x10100000L)
+        X509_up_ref(certInfos[i].pCert);
+        EVP_PKEY_up_ref(certInfos[i].pKey);
+#else
+        CRYPTO_add(&certInfos[i].pCert->references, 1, CRYPTO_LOCK_X509);
+        CRYPTO_add(&certInfos[i].pKey->references, 1, CRYPTO_LOCK_EVP_PKEY);
+#endif
+        pEntry->pCerts[i] = certInfos[i].pCert;
+        pEntry->pKeys[i] = certInfos[i].pKey;
+        pEntry->certificateCount++;
+    }
+#elif KVS_USE_MBEDTLS
+    for (i = 0; i < certCount; i++) {
+        CHK_STATUS(copyCertificateAndKey((mbedtls_x509_crt*) pRtcCertificates[i].pCertificate, (mbedtls_pk_context*) pRtcCertificates[i].pPrivateKey,
+                                         &pEntry->certificates[i]));
+        // in case of a failure in between, only free up to current position
+        pEntry->certificateCount++;
+        CHK_STATUS(dtlsCertificateFingerprint(&pEntry->certificates[i].cert, pEntry->certificates[i].fingerprint));
+    }
+#else
+#error "A Crypto implementation is required."
+#endif
+
+CleanUp:
+
+    CHK_LOG_ERR(retStatus);
+
+    if (STATUS_FAILED(retStatus)) {
+        freeDtlsContextCacheEntry(&pEntry);
+    }
+
+    *ppEntry = pEntry;
+
+    return retStatus;
+}
+
+STATUS dtlsContextCacheAcquire(PRtcCertificate pRtcCertificates, UINT32 certCount, PDtlsContextCacheEntry* ppEntry)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    PDtlsContextCache pCache = getDtlsContextCacheInstance();
+    PDtlsContextCacheEntry pEntry = NULL, pCurEntry;
+    PDoubleListNode pCurNode = NULL;
+    BOOL locked = FALSE;
+
+    CHK(pRtcCertificates != NULL && ppEntry != NULL, STATUS_NULL_ARG);
+    CHK(certCount > 0 && certCount <= MAX_RTCCONFIGURATION_CERTIFICATES, STATUS_INVALID_ARG);
+    CHK(pCache->isInitialized, retStatus);
+
+    MUTEX_LOCK(pCache->lock);
+    locked = TRUE;
+
+    CHK_STATUS(doubleListGetHeadNode(pCache->entries, &pCurNode));
+    while (pCurNode != NULL && pEntry == NULL) {
+        pCurEntry = (PDtlsContextCacheEntry) pCurNode->data;
+        if (dtlsContextCacheEntryMatches(pCurEntry, pRtcCertificates, certCount)) {
+            pEntry = pCurEntry;
+        }
+
+        pCurNode = pCurNode->pNext;
+    }
+
+    if (pEntry == NULL) {
+        CHK_STATUS(createDtlsContextCacheEntry(pRtcCertificates, certCount, &pEntry));
+        retStatus = doubleListInsertItemTail(pCache->entries, (UINT64) pEntry);
+        if (STATUS_FAILED(retStatus)) {
+            freeDtlsContextCacheEntry(&pEntry);
+            CHK(FALSE, retStatus);
+        }
+    }
+
+    pEntry->refCount++;
+
+CleanUp:
+
+    if (locked) {
+        MUTEX_UNLOCK(pCache->lock);
+    }
+
+    if (ppEntry != NULL) {
+        *ppEntry = pEntry;
+    }
+
+    return retStatus;
+}
+
+STATUS dtlsContextCacheRelease(PDtlsContextCacheEntry* ppEntry)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    PDtlsContextCache pCache = getDtlsContextCacheInstance();
+    PDtlsContextCacheEntry pEntry = NULL;
+    PDoubleListNode pCurNode = NULL;
+    BOOL locked = FALSE;
+
+    CHK(ppEntry != NULL, STATUS_NULL_ARG);
+    CHK(*ppEntry != NULL, retStatus);
+
+    pEntry = *ppEntry;
+    *ppEntry = NULL;
+
+    MUTEX_LOCK(pCache->lock);
+    locked = TRUE;
+
+    CHK(--pEntry->refCount == 0, retStatus);
+
+    CHK_STATUS(doubleListGetHeadNode(pCache->entries, &pCurNode));
+    while (pCurNode != NULL && (PDtlsContextCacheEntry) pCurNode->data != pEntry) {
+        pCurNode = pCurNode->pNext;
+    }
+
+    if (pCurNode != NULL) {
+        CHK_STATUS(doubleListDeleteNode(pCache->entries, pCurNode));
+    }
+
+    CHK_STATUS(freeDtlsContextCacheEntry(&pEntry));
+
+CleanUp:
+
+    if (locked) {
+        MUTEX_UNLOCK(pCache->lock);
+    }
+
+    return retStatus;
+}
@@ -0,0 +1,87 @@
+//
+// Dtls context cache
+//
+
+#ifndef __KINESIS_VIDEO_WEBRTC_CLIENT_CRYPTO_DTLS_CONTEXT_CACHE__
+#define __KINESIS_VIDEO_WEBRTC_CLIENT_CRYPTO_DTLS_CONTEXT_CACHE__
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * What dtls sessions created with the same application provided certificates can share
+ */
+typedef struct __DtlsContextCacheEntry {
+    // Number of dtls sessions using the entry
+    UINT32 refCount;
+    UINT32 certificateCount;
+#ifdef KVS_USE_OPENSSL
+    // The certificate set the entry was created for. References are held so the addresses can not be reused while cached
+    X509* pCerts[MAX_RTCCONFIGURATION_CERTIFICATES];
+    EVP_PKEY* pKeys[MAX_RTCCONFIGURATION_CERTIFICATES];
+    SSL_CTX* pSslCtx;
+    CHAR certFingerprints[MAX_RTCCONFIGURATION_CERTIFICATES][CERTIFICATE_FINGERPRINT_LENGTH + 1];
+#elif KVS_USE_MBEDTLS
+    // Checked copies of the certificates and keys with their fingerprints. The config holds per session state and a
+    // shared key is not safe to sign with from several threads, so sessions still clone these, without checking them again
+    DtlsSessionCertificateInfo certificates[MAX_RTCCONFIGURATION_CERTIFICATES];
+#else
+#error "A Crypto implementation is required."
+#endif
+} DtlsContextCacheEntry, *PDtlsContextCacheEntry;
+
+/**
+ * Process wide cache of dtls contexts keyed by the application provided certificate set. Sessions only create their
+ * own SSL object on top of the shared context.
+ */
+typedef struct {
+    BOOL isInitialized;
+    MUTEX lock;
+    // PDtlsContextCacheEntry items
+    PDoubleList entries;
+} DtlsContextCache, *PDtlsContextCache;
+
+PDtlsContextCache getDtlsContextCacheInstance(VOID);
+
+/**
+ * Sets up the process wide cache. Called by initKvsWebRtc
+ *
+ * @return - STATUS code of the execution
+ */
+STATUS createDtlsContextCache(VOID);
+
+/**
+ * Frees the entries left. Called by deinitKvsWebRtc once all peer connections are freed
+ *
+ * @return - STATUS code of the execution
+ */
+STATUS freeDtlsContextCache(VOID);
+
+/**
+ * Returns the context for the certificate set, created on first use. The entry is NULL when the cache is not set up,
+ * in which case the session creates its own context.
+ *
+ * @param - PRtcCertificate - IN - Application provided certificates
+ * @param - UINT32 - IN - Number of certificates
+ * @param - PDtlsContextCacheEntry* - OUT - Referenced entry or NULL
+ *
+ * @return - STATUS code of the execution
+ */
+STATUS dtlsContextCacheAcquire(PRtcCertificate, UINT32, PDtlsContextCacheEntry*);
+
+/**
+ * Drops a reference taken by dtlsContextCacheAcquire. The entry is freed with the last one. Idempotent.
+ *
+ * @param - PDtlsContextCacheEntry* - IN/OUT - Entry, set to NULL
+ *
+ * @return - STATUS code of the execution
+ */
+STATUS dtlsContextCacheRelease(PDtlsContextCacheEntry*);
+
+#ifdef __cplusplus
+}
+#endif
+#endif //__KINESIS_VIDEO_WEBRTC_CLIENT_CRYPTO_DTLS_CONTEXT_CACHE__
@@ -45,16 +45,24 @@ STATUS createDtlsSession(PDtlsSessionCallbacks pDtlsSessionCallbacks, TIMER_QUEU
                                            &pDtlsSession->certificates[0].privateKey));
         pDtlsSession->certificateCount = 1;
     } else {
+        CHK_STATUS(dtlsContextCacheAcquire(pRtcCertificates, certCount, &pDtlsSession->pContextCacheEntry));
         for (i = 0; i < certCount; i++) {
-            CHK_STATUS(copyCertificateAndKey((mbedtls_x509_crt*) pRtcCertificates[i].pCertificate,
-                                             (mbedtls_pk_context*) pRtcCertificates[i].pPrivateKey, &pDtlsSession->certificates[i]));
+            if (pDtlsSession->pContextCacheEntry != NULL) {
+                // already checked and fingerprinted when the entry was created
+                pCertInfo = pDtlsSession->pContextCacheEntry->certificates + i;
+                CHK_STATUS(cloneCertificateAndKey(&pCertInfo->cert, &pCertInfo->privateKey, &pDtlsSession->certificates[i]));
+                MEMCPY(pDtlsSession->certificates[i].fingerprint, pCertInfo->fingerprint, SIZEOF(pCertInfo->fingerprint));
+            } else {
+                CHK_STATUS(copyCertificateAndKey((mbedtls_x509_crt*) pRtcCertificates[i].pCertificate,
+                                                 (mbedtls_pk_context*) pRtcCertificates[i].pPrivateKey, &pDtlsSession->certificates[i]));
+            }
             // in case of a failure in between, we'll only free up to current position
             pDtlsSession->certificateCount++;
         }
     }
 
     // Generate and store the certificate fingerprints
-    for (i = 0; i < pDtlsSession->certificateCount; i++) {
+    for (i = 0; i < pDtlsSession->certificateCount && pDtlsSession->pContextCacheEntry == NULL; i++) {
         pCertInfo = pDtlsSession->certificates + i;
         CHK_STATUS(dtlsCertificateFingerprint(&pCertInfo->cert, pCertInfo->fingerprint));
     }
@@ -93,6 +101,7 @@ STATUS freeDtlsSession(PDtlsSession* ppDtlsSession)
         pCertInfo = pDtlsSession->certificates + i;
         freeCertificateAndKey(&pCertInfo->cert, &pCertInfo->privateKey);
     }
+    dtlsContextCacheRelease(&pDtlsSession->pContextCacheEntry);
     mbedtls_entropy_free(&pDtlsSession->entropy);
     mbedtls_ctr_drbg_free(&pDtlsSession->ctrDrbg);
     mbedtls_ssl_config_free(&pDtlsSession->sslCtxConfig);
@@ -475,7 +484,7 @@ STATUS dtlsSessionPopulateKeyingMaterial(PDtlsSession pDtlsSession, PDtlsKeyingM
 {
     ENTERS();
     STATUS retStatus = STATUS_SUCCESS;
-    UINT32 offset = 0;
+    UINT32 masterKeyLen = 0, saltKeyLen = 0;
     BOOL locked = FALSE;
     PTlsKeys pKeys;
     BYTE keyingMaterialBuffer[MAX_SRTP_MASTER_KEY_LEN * 2 + MAX_SRTP_SALT_KEY_LEN * 2];
@@ -487,23 +496,6 @@ STATUS dtlsSessionPopulateKeyingMaterial(PDtlsSession pDtlsSession, PDtlsKeyingM
     MUTEX_LOCK(pDtlsSession->sslLock);
     locked = TRUE;
 
-    CHK(mbedtls_ssl_tls_prf(pKeys->tlsProfile, pKeys->masterSecret, ARRAY_SIZE(pKeys->masterSecret), KEYING_EXTRACTOR_LABEL, pKeys->randBytes,
-                            ARRAY_SIZE(pKeys->randBytes), keyingMaterialBuffer, ARRAY_SIZE(keyingMaterialBuffer)) == 0,
-        STATUS_INTERNAL_ERROR);
-
-    pDtlsKeyingMaterial->key_length = MAX_SRTP_MASTER_KEY_LEN + MAX_SRTP_SALT_KEY_LEN;
-
-    MEMCPY(pDtlsKeyingMaterial->clientWriteKey, &keyingMaterialBuffer[offset], MAX_SRTP_MASTER_KEY_LEN);
-    offset += MAX_SRTP_MASTER_KEY_LEN;
-
-    MEMCPY(pDtlsKeyingMaterial->serverWriteKey, &keyingMaterialBuffer[offset], MAX_SRTP_MASTER_KEY_LEN);
-    offset += MAX_SRTP_MASTER_KEY_LEN;
-
-    MEMCPY(pDtlsKeyingMaterial->clientWriteKey + MAX_SRTP_MASTER_KEY_LEN, &keyingMaterialBuffer[offset], MAX_SRTP_SALT_KEY_LEN);
-    offset += MAX_SRTP_SALT_KEY_LEN;
-
-    MEMCPY(pDtlsKeyingMaterial->serverWriteKey + MAX_SRTP_MASTER_KEY_LEN, &keyingMaterialBuffer[offset], MAX_SRTP_SALT_KEY_LEN);
-
     mbedtls_ssl_get_dtls_srtp_negotiation_result(&pDtlsSession->sslCtx, &negotiatedSRTPProfile);
     switch (negotiatedSRTPProfile.chosen_dtls_srtp_profile) {
         case MBEDTLS_TLS_SRTP_AES128_CM_HMAC_SHA1_80:
@@ -515,6 +507,13 @@ STATUS dtlsSessionPopulateKeyingMaterial(PDtlsSession pDtlsSession, PDtlsKeyingM
         default:
             CHK(FALSE, STATUS_SSL_UNKNOWN_SRTP_PROFILE);
     }
+    CHK_STATUS(dtlsSrtpProfileKeyLengths(pDtlsKeyingMaterial->srtpProfile, &masterKeyLen, &saltKeyLen));
+
+    CHK(mbedtls_ssl_tls_prf(pKeys->tlsProfile, pKeys->masterSecret, ARRAY_SIZE(pKeys->masterSecret), KEYING_EXTRACTOR_LABEL, pKeys->randBytes,
+                            ARRAY_SIZE(pKeys->randBytes), keyingMaterialBuffer, (masterKeyLen + saltKeyLen) * 2) == 0,
+        STATUS_INTERNAL_ERROR);
+
+    CHK_STATUS(dtlsSplitKeyingMaterial(keyingMaterialBuffer, masterKeyLen, saltKeyLen, pDtlsKeyingMaterial));
 
 CleanUp:
     if (locked) {
@@ -555,6 +554,24 @@ CleanUp:
 }
 
 STATUS copyCertificateAndKey(mbedtls_x509_crt* pCert, mbedtls_pk_context* pKey, PDtlsSessionCertificateInfo pDst)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+
+    CHK(pCert != NULL && pKey != NULL && pDst != NULL, STATUS_NULL_ARG);
+    CHK(mbedtls_pk_check_pair(&pCert->pk, pKey) == 0, STATUS_CERTIFICATE_GENERATION_FAILED);
+    CHK_STATUS(cloneCertificateAndKey(pCert, pKey, pDst));
+
+CleanUp:
+
+    LEAVES();
+    return retStatus;
+}
+
+/**
+ * cloneCertificateAndKey is copyCertificateAndKey for a pair that is already known to match
+ */
+STATUS cloneCertificateAndKey(mbedtls_x509_crt* pCert, mbedtls_pk_context* pKey, PDtlsSessionCertificateInfo pDst)
 {
     ENTERS();
     STATUS retStatus = STATUS_SUCCESS;
@@ -562,7 +579,6 @@ STATUS copyCertificateAndKey(mbedtls_x509_crt* pCert, mbedtls_pk_context* pKey,
     mbedtls_ecp_keypair *pSrcECP, *pDstECP;
 
     CHK(pCert != NULL && pKey != NULL && pDst != NULL, STATUS_NULL_ARG);
-    CHK(mbedtls_pk_check_pair(&pCert->pk, pKey) == 0, STATUS_CERTIFICATE_GENERATION_FAILED);
 
     mbedtls_x509_crt_init(&pDst->cert);
     mbedtls_pk_init(&pDst->privateKey);
@@ -1,6 +1,28 @@
 #define LOG_CLASS "DTLS_openssl"
 #include "../Include_i.h"
 
+/**  https://tools.ietf.org/html/rfc7714#section-14.2. As server, the first profile of the list the client also offers
+ * is picked, so the AEAD profiles win whenever the remote supports them. They encrypt and authenticate in a single pass. */
+#define DTLS_SRTP_SUPPORTED_PROFILES "SRTP_AEAD_AES_128_GCM:SRTP_AEAD_AES_256_GCM:SRTP_AES128_CM_SHA1_32:SRTP_AES128_CM_SHA1_80"
+// Offered instead when the linked libsrtp has no AES-GCM, like a system srtp2 built without its OpenSSL backend
+#define DTLS_SRTP_CM_PROFILES "SRTP_AES128_CM_SHA1_32:SRTP_AES128_CM_SHA1_80"
+
+static volatile SIZE_T gDtlsSrtpProfiles = (SIZE_T) NULL;
+
+static PCHAR resolveDtlsSrtpProfiles(VOID)
+{
+    BOOL gcm128Supported = FALSE, gcm256Supported = FALSE;
+
+    CHK_LOG_ERR(srtpSessionIsProfileSupported(KVS_SRTP_PROFILE_AEAD_AES_128_GCM, &gcm128Supported));
+    CHK_LOG_ERR(srtpSessionIsProfileSupported(KVS_SRTP_PROFILE_AEAD_AES_256_GCM, &gcm256Supported));
+    if (gcm128Supported && gcm256Supported) {
+        return DTLS_SRTP_SUPPORTED_PROFILES;
+    }
+
+    DLOGW("libsrtp has no AES-GCM support, only offering the AES-CM SRTP profiles");
+    return DTLS_SRTP_CM_PROFILES;
+}
+
 // Allow all certificates since they are checked via fingerprint in SDP later
 // https://www.openssl.org/docs/man1.0.2/man3/SSL_CTX_set_verify.html
 INT32 dtlsCertificateVerifyCallback(INT32 preverify_ok, X509_STORE_CTX* ctx)
@@ -170,6 +192,7 @@ STATUS createSslCtx(PDtlsSessionCertificateInfo pCertificates, UINT32 certCount,
     STATUS retStatus = STATUS_SUCCESS;
     SSL_CTX* pSslCtx = NULL;
     EC_KEY* pEcKey = NULL;
+    PCHAR srtpProfiles = (PCHAR) ATOMIC_LOAD(&gDtlsSrtpProfiles);
     UINT32 i;
 
     CHK(pCertificates != NULL && ppSslCtx != NULL, STATUS_NULL_ARG);
@@ -202,7 +225,12 @@ STATUS createSslCtx(PDtlsSessionCertificateInfo pCertificates, UINT32 certCount,
 #endif
 
     SSL_CTX_set_verify(pSslCtx, SSL_VERIFY_PEER | SSL_VERIFY_FAIL_IF_NO_PEER_CERT, dtlsCertificateVerifyCallback);
-    CHK(SSL_CTX_set_tlsext_use_srtp(pSslCtx, "SRTP_AES128_CM_SHA1_32:SRTP_AES128_CM_SHA1_80") == 0, STATUS_SSL_CTX_CREATION_FAILED);
+    // libsrtp is probed once, its ciphers do not change while the process runs
+    if (srtpProfiles == NULL) {
+        srtpProfiles = resolveDtlsSrtpProfiles();
+        ATOMIC_STORE(&gDtlsSrtpProfiles, (SIZE_T) srtpProfiles);
+    }
+    CHK(SSL_CTX_set_tlsext_use_srtp(pSslCtx, srtpProfiles) == 0, STATUS_SSL_CTX_CREATION_FAILED);
 
     for (i = 0; i < certCount; i++) {
         CHK(SSL_CTX_use_certificate(pSslCtx, pCertificates[i].pCert) == 1, STATUS_SSL_CTX_CREATION_FAILED);
@@ -333,11 +361,21 @@ STATUS createDtlsSession(PDtlsSessionCallbacks pDtlsSessionCallbacks, TIMER_QUEU
         }
     }
 
-    PROFILE_CALL(CHK_STATUS(createSslCtx(certInfos, pDtlsSession->certificateCount, &pDtlsSession->pSslCtx)), "Create SSL Context");
-    PROFILE_CALL(CHK_STATUS(createSsl(pDtlsSession->pSslCtx, &pDtlsSession->pSsl)), "Create SSL session");
+    // application provided certificates are usually the same for every session, their context and fingerprints are shared
+    if (certCount != 0) {
+        CHK_STATUS(dtlsContextCacheAcquire(pRtcCertificates, certCount, &pDtlsSession->pContextCacheEntry));
+    }
+
+    if (pDtlsSession->pContextCacheEntry != NULL) {
+        pDtlsSession->pSslCtx = pDtlsSession->pContextCacheEntry->pSslCtx;
+        MEMCPY(pDtlsSession->certFingerprints, pDtlsSession->pContextCacheEntry->certFingerprints, SIZEOF(pDtlsSession->certFingerprints));
+    } else {
+        PROFILE_CALL(CHK_STATUS(createSslCtx(certInfos, pDtlsSession->certificateCount, &pDtlsSession->pSslCtx)), "Create SSL Context");
+        // Generate and store the certificate fingerprints
+        CHK_STATUS(dtlsGenerateCertificateFingerprints(pDtlsSession, certInfos));
+    }
 
-    // Generate and store the certificate fingerprints
-    CHK_STATUS(dtlsGenerateCertificateFingerprints(pDtlsSession, certInfos));
+    PROFILE_CALL(CHK_STATUS(createSsl(pDtlsSession->pSslCtx, &pDtlsSession->pSsl)), "Create SSL session");
 
     *ppDtlsSession = pDtlsSession;
 
@@ -426,9 +464,15 @@ STATUS dtlsSessionStart(PDtlsSession pDtlsSession, BOOL isServer)
 
     MUTEX_LOCK(pDtlsSession->sslLock);
     locked = TRUE;
+    // Starting again, like after an ice restart, must not add a second transmission timer
+    CHK(!ATOMIC_LOAD_BOOL(&pDtlsSession->isStarted), retStatus);
 
     CHK_STATUS(beginHandshakeProcess(pDtlsSession, isServer, &sslRet));
-    pDtlsSession->dtlsSessionStartTime = GETTIME();
+    // The server stays in DTLS_STATE_HANDSHAKE_NEW until the ClientHello arrives in dtlsSessionProcessPacket, which is
+    // when it starts counting the handshake time
+    if (!isServer) {
+        pDtlsSession->handshakeState = DTLS_STATE_HANDSHAKE_IN_PROGRESS;
+    }
     CHK_STATUS(timerQueueAddTimer(pDtlsSession->timerQueueHandle, DTLS_SESSION_TIMER_START_DELAY, DTLS_TRANSMISSION_INTERVAL,
                                   dtlsTransmissionTimerCallback, (UINT64) pDtlsSession, &pDtlsSession->timerId));
 CleanUp:
@@ -598,7 +642,9 @@ STATUS freeDtlsSession(PDtlsSession* ppDtlsSession)
     if (pDtlsSession->pSsl != NULL) {
         SSL_free(pDtlsSession->pSsl);
     }
-    if (pDtlsSession->pSslCtx != NULL) {
+    if (pDtlsSession->pContextCacheEntry != NULL) {
+        dtlsContextCacheRelease(&pDtlsSession->pContextCacheEntry);
+    } else if (pDtlsSession->pSslCtx != NULL) {
         SSL_CTX_free(pDtlsSession->pSslCtx);
     }
     if (IS_VALID_MUTEX_VALUE(pDtlsSession->sslLock)) {
@@ -637,6 +683,11 @@ STATUS dtlsSessionProcessPacket(PDtlsSession pDtlsSession, PBYTE pData, PINT32 p
     CVAR_BROADCAST(pDtlsSession->receivePacketCvar);
 
     if (!ATOMIC_LOAD_BOOL(&pDtlsSession->isCleanUp)) {
+        if (pDtlsSession->handshakeState == DTLS_STATE_HANDSHAKE_NEW) {
+            pDtlsSession->dtlsSessionStartTime = GETTIME();
+            pDtlsSession->handshakeState = DTLS_STATE_HANDSHAKE_IN_PROGRESS;
+        }
+
         sslRet = BIO_write(SSL_get_rbio(pDtlsSession->pSsl), pData, *pDataLen);
         if (sslRet <= 0) {
             LOG_OPENSSL_ERROR("BIO_write");
@@ -655,6 +706,13 @@ STATUS dtlsSessionProcessPacket(PDtlsSession pDtlsSession, PBYTE pData, PINT32 p
 
         if (!ATOMIC_LOAD_BOOL(&pDtlsSession->sslInitFinished)) {
             CHK_STATUS(dtlsCheckOutgoingDataBuffer(pDtlsSession));
+
+            // Complete on the flight that finishes the handshake instead of the next dtlsTransmissionTimerCallback
+            if (SSL_is_init_finished(pDtlsSession->pSsl)) {
+                pDtlsSession->handshakeState = DTLS_STATE_HANDSHAKE_COMPLETED;
+                ATOMIC_STORE_BOOL(&pDtlsSession->sslInitFinished, TRUE);
+                CHK_STATUS(dtlsSessionChangeState(pDtlsSession, RTC_DTLS_TRANSPORT_STATE_CONNECTED));
+            }
         }
 
         /* if SSL_read failed then set to 0 */
@@ -814,9 +872,10 @@ STATUS dtlsSessionPopulateKeyingMaterial(PDtlsSession pDtlsSession, PDtlsKeyingM
 {
     ENTERS();
     STATUS retStatus = STATUS_SUCCESS;
-    UINT32 offset = 0;
+    UINT32 masterKeyLen = 0, saltKeyLen = 0;
     BYTE keyingMaterialBuffer[MAX_SRTP_MASTER_KEY_LEN * 2 + MAX_SRTP_SALT_KEY_LEN * 2];
     BOOL locked = FALSE;
+    SRTP_PROTECTION_PROFILE* pSrtpProfile;
 
     acquireDtlsSession(pDtlsSession);
     CHK(pDtlsSession != NULL && pDtlsKeyingMaterial != NULL, STATUS_NULL_ARG);
@@ -824,31 +883,16 @@ STATUS dtlsSessionPopulateKeyingMaterial(PDtlsSession pDtlsSession, PDtlsKeyingM
     MUTEX_LOCK(pDtlsSession->sslLock);
     locked = TRUE;
 
-    CHK(SSL_export_keying_material(pDtlsSession->pSsl, keyingMaterialBuffer, SIZEOF(keyingMaterialBuffer), KEYING_EXTRACTOR_LABEL,
+    CHK((pSrtpProfile = SSL_get_selected_srtp_profile(pDtlsSession->pSsl)) != NULL, STATUS_SSL_UNKNOWN_SRTP_PROFILE);
+    pDtlsKeyingMaterial->srtpProfile = (KVS_SRTP_PROFILE) pSrtpProfile->id;
+    CHK_STATUS(dtlsSrtpProfileKeyLengths(pDtlsKeyingMaterial->srtpProfile, &masterKeyLen, &saltKeyLen));
+
+    // The length exported depends on the profile, as the keys and salts of both sides are laid out back to back
+    CHK(SSL_export_keying_material(pDtlsSession->pSsl, keyingMaterialBuffer, (masterKeyLen + saltKeyLen) * 2, KEYING_EXTRACTOR_LABEL,
                                    ARRAY_SIZE(KEYING_EXTRACTOR_LABEL) - 1, NULL, 0, 0),
         STATUS_INTERNAL_ERROR);
 
-    pDtlsKeyingMaterial->key_length = MAX_SRTP_MASTER_KEY_LEN + MAX_SRTP_SALT_KEY_LEN;
-
-    MEMCPY(pDtlsKeyingMaterial->clientWriteKey, &keyingMaterialBuffer[offset], MAX_SRTP_MASTER_KEY_LEN);
-    offset += MAX_SRTP_MASTER_KEY_LEN;
-
-    MEMCPY(pDtlsKeyingMaterial->serverWriteKey, &keyingMaterialBuffer[offset], MAX_SRTP_MASTER_KEY_LEN);
-    offset += MAX_SRTP_MASTER_KEY_LEN;
-
-    MEMCPY(pDtlsKeyingMaterial->clientWriteKey + MAX_SRTP_MASTER_KEY_LEN, &keyingMaterialBuffer[offset], MAX_SRTP_SALT_KEY_LEN);
-    offset += MAX_SRTP_SALT_KEY_LEN;
-
-    MEMCPY(pDtlsKeyingMaterial->serverWriteKey + MAX_SRTP_MASTER_KEY_LEN, &keyingMaterialBuffer[offset], MAX_SRTP_SALT_KEY_LEN);
-
-    switch (SSL_get_selected_srtp_profile(pDtlsSession->pSsl)->id) {
-        case KVS_SRTP_PROFILE_AES128_CM_HMAC_SHA1_32:
-        case KVS_SRTP_PROFILE_AES128_CM_HMAC_SHA1_80:
-            pDtlsKeyingMaterial->srtpProfile = SSL_get_selected_srtp_profile(pDtlsSession->pSsl)->id;
-            break;
-        default:
-            CHK(FALSE, STATUS_SSL_UNKNOWN_SRTP_PROFILE);
-    }
+    CHK_STATUS(dtlsSplitKeyingMaterial(keyingMaterialBuffer, masterKeyLen, saltKeyLen, pDtlsKeyingMaterial));
 
 CleanUp:
     if (locked) {
@@ -2,16 +2,83 @@
  * Kinesis Video Producer ConnectionListener
  */
 #define LOG_CLASS "ConnectionListener"
+
+// glibc only declares recvmmsg() for GNU builds
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE
+#endif
+
 #include "../Include_i.h"
 
+#ifdef KVS_SOCKET_EPOLL_SUPPORTED
+#include <sys/epoll.h>
+
+static STATUS connectionListenerEpollControl(INT32 epollFd, INT32 operation, INT32 fd, UINT32 events, UINT32 data)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    struct epoll_event event;
+
+    MEMSET(&event, 0x00, SIZEOF(event));
+    event.events = events;
+    event.data.u32 = data;
+    CHK_ERR(epoll_ctl(epollFd, operation, fd, &event) == 0, STATUS_SOCKET_EPOLL_FAILED, "epoll_ctl() %d failed for socket %d with errno %s",
+            operation, fd, getErrorString(getErrorCode()));
+
+CleanUp:
+
+    return retStatus;
+}
+
+/**
+ * Shard sockets across workers by their 5-tuple so a given flow is always served by the same thread
+ */
+static UINT32 connectionListenerPickWorker(PConnectionListener pConnectionListener, PSocketConnection pSocketConnection)
+{
+    UINT32 hash = 2166136261u, i;
+    PBYTE pCurPtr;
+    PKvsIpAddress addresses[2] = {&pSocketConnection->hostIpAddr, &pSocketConnection->peerIpAddr};
+
+    // FNV-1a over protocol, ports and addresses
+    hash = (hash ^ (UINT32) pSocketConnection->protocol) * 16777619u;
+    for (i = 0; i < ARRAY_SIZE(addresses); i++) {
+        hash = (hash ^ (UINT32) addresses[i]->port) * 16777619u;
+        for (pCurPtr = addresses[i]->address; pCurPtr < addresses[i]->address + IPV6_ADDRESS_LENGTH; pCurPtr++) {
+            hash = (hash ^ *pCurPtr) * 16777619u;
+        }
+    }
+
+    return hash % pConnectionListener->workerCount;
+}
+#endif
+
 STATUS createConnectionListener(PConnectionListener* ppConnectionListener)
+{
+    return createConnectionListenerWithWorkers(CONNECTION_LISTENER_DEFAULT_WORKER_COUNT, CONNECTION_LISTENER_DEFAULT_MAX_LISTENING_CONNECTION,
+                                               ppConnectionListener);
+}
+
+STATUS createConnectionListenerWithWorkers(UINT32 workerCount, UINT32 maxSocketCount, PConnectionListener* ppConnectionListener)
 {
     STATUS retStatus = STATUS_SUCCESS;
-    UINT32 allocationSize = SIZEOF(ConnectionListener) + MAX_UDP_PACKET_SIZE;
+    UINT32 allocationSize, i;
     PConnectionListener pConnectionListener = NULL;
+    PConnectionListenerWorker pWorker = NULL;
+    PBYTE pCurPtr;
 
     CHK(ppConnectionListener != NULL, STATUS_NULL_ARG);
+    CHK(workerCount > 0 && workerCount <= CONNECTION_LISTENER_MAX_WORKER_COUNT, STATUS_INVALID_ARG);
+    CHK(maxSocketCount > 0, STATUS_INVALID_ARG);
 
+#ifndef KVS_SOCKET_EPOLL_SUPPORTED
+    // Without epoll a single thread polls every socket
+    workerCount = 1;
+    maxSocketCount = MIN(maxSocketCount, CONNECTION_LISTENER_DEFAULT_MAX_LISTENING_CONNECTION);
+#endif
+
+    allocationSize = SIZEOF(ConnectionListener) + maxSocketCount * SIZEOF(PSocketConnection) + workerCount * MAX_UDP_PACKET_SIZE;
+#ifdef KVS_SOCKET_EPOLL_SUPPORTED
+    allocationSize += maxSocketCount * SIZEOF(UINT32);
+#endif
     pConnectionListener = (PConnectionListener) MEMCALLOC(1, allocationSize);
     CHK(pConnectionListener != NULL, STATUS_NOT_ENOUGH_MEMORY);
 
@@ -19,11 +86,29 @@ STATUS createConnectionListener(PConnectionListener* ppConnectionListener)
     pConnectionListener->receiveDataRoutine = INVALID_TID_VALUE;
     pConnectionListener->lock = MUTEX_CREATE(FALSE);
 
-    // No sockets are present
+    // No sockets are present. The slots start at the end of ConnectionListener struct
     pConnectionListener->socketCount = 0;
+    pConnectionListener->maxSocketCount = maxSocketCount;
+    pConnectionListener->sockets = (PSocketConnection*) (pConnectionListener + 1);
+    pCurPtr = (PBYTE) (pConnectionListener->sockets + maxSocketCount);
+#ifdef KVS_SOCKET_EPOLL_SUPPORTED
+    pConnectionListener->socketWorkers = (PUINT32) pCurPtr;
+    pCurPtr += maxSocketCount * SIZEOF(UINT32);
+#endif
+
+    // Worker buffers follow the slots
+    pConnectionListener->workerCount = workerCount;
+    for (i = 0; i < workerCount; i++) {
+        pWorker = &pConnectionListener->workers[i];
+        pWorker->pConnectionListener = pConnectionListener;
+        pWorker->receiveDataRoutine = INVALID_TID_VALUE;
+        pWorker->pBuffer = pCurPtr + i * MAX_UDP_PACKET_SIZE;
+#ifdef KVS_SOCKET_EPOLL_SUPPORTED
+        pWorker->epollFd = -1;
+#endif
+    }
 
-    // pConnectionListener->pBuffer starts at the end of ConnectionListener struct
-    pConnectionListener->pBuffer = (PBYTE) (pConnectionListener + 1);
+    pConnectionListener->pBuffer = pConnectionListener->workers[0].pBuffer;
     pConnectionListener->bufferLen = MAX_UDP_PACKET_SIZE;
 
     // TODO add support for windows socketpair
@@ -33,6 +118,19 @@ STATUS createConnectionListener(PConnectionListener* ppConnectionListener)
     CHK_STATUS(createSocketPair(&(pConnectionListener->kickSocket)));
 #endif
 
+#ifdef KVS_SOCKET_EPOLL_SUPPORTED
+    for (i = 0; i < workerCount; i++) {
+        pWorker = &pConnectionListener->workers[i];
+        pWorker->epollFd = epoll_create1(EPOLL_CLOEXEC);
+        CHK_ERR(pWorker->epollFd >= 0, STATUS_SOCKET_EPOLL_FAILED, "epoll_create1() failed with errno %s", getErrorString(getErrorCode()));
+
+        // Level triggered and never read, so a single write to the kick socket wakes up every worker
+        CHK_STATUS(connectionListenerEpollControl(pWorker->epollFd, EPOLL_CTL_ADD,
+                                                  pConnectionListener->kickSocket[CONNECTION_LISTENER_KICK_SOCKET_LISTEN], EPOLLIN,
+                                                  CONNECTION_LISTENER_EPOLL_KICK_EVENT));
+    }
+#endif
+
 CleanUp:
 
     if (STATUS_FAILED(retStatus) && pConnectionListener != NULL) {
@@ -52,6 +150,7 @@ STATUS freeConnectionListener(PConnectionListener* ppConnectionListener)
     STATUS retStatus = STATUS_SUCCESS;
     PConnectionListener pConnectionListener = NULL;
     TID threadId;
+    UINT32 i;
     const char* msg = "1";
 
     CHK(ppConnectionListener != NULL, STATUS_NULL_ARG);
@@ -78,9 +177,33 @@ STATUS freeConnectionListener(PConnectionListener* ppConnectionListener)
             THREAD_JOIN(pConnectionListener->receiveDataRoutine, NULL);
         }
 
+        // The first worker runs on receiveDataRoutine
+        for (i = 1; i < pConnectionListener->workerCount; i++) {
+            MUTEX_LOCK(pConnectionListener->lock);
+            threadId = pConnectionListener->workers[i].receiveDataRoutine;
+            MUTEX_UNLOCK(pConnectionListener->lock);
+            if (IS_VALID_TID_VALUE(threadId)) {
+                THREAD_JOIN(threadId, NULL);
+            }
+        }
+
         MUTEX_FREE(pConnectionListener->lock);
     }
 
+#ifdef KVS_SOCKET_EPOLL_SUPPORTED
+    for (i = 0; i < pConnectionListener->workerCount; i++) {
+        if (pConnectionListener->workers[i].epollFd >= 0) {
+            close(pConnectionListener->workers[i].epollFd);
+        }
+    }
+#endif
+
+#ifdef KVS_SOCKET_RECEIVE_BATCH_SUPPORTED
+    for (i = 0; i < pConnectionListener->workerCount; i++) {
+        SAFE_MEMFREE(pConnectionListener->workers[i].pBatchBuffer);
+    }
+#endif
+
     // TODO add support for windows socketpair
 #ifndef _WIN32
     if (pConnectionListener->kickSocket[CONNECTION_LISTENER_KICK_SOCKET_LISTEN] != -1) {
@@ -105,8 +228,12 @@ CleanUp:
 STATUS connectionListenerAddConnection(PConnectionListener pConnectionListener, PSocketConnection pSocketConnection)
 {
     STATUS retStatus = STATUS_SUCCESS;
-    BOOL locked = FALSE, iterate = TRUE;
+    BOOL locked = FALSE;
     UINT32 i;
+#ifdef KVS_SOCKET_EPOLL_SUPPORTED
+    UINT32 workerIndex;
+    INT32 localSocket;
+#endif
 
     CHK(pConnectionListener != NULL && pSocketConnection != NULL, STATUS_NULL_ARG);
     CHK(!ATOMIC_LOAD_BOOL(&pConnectionListener->terminate), retStatus);
@@ -115,17 +242,29 @@ STATUS connectionListenerAddConnection(PConnectionListener pConnectionListener,
     locked = TRUE;
 
     // Check for space
-    CHK(pConnectionListener->socketCount < CONNECTION_LISTENER_DEFAULT_MAX_LISTENING_CONNECTION, STATUS_NOT_ENOUGH_MEMORY);
+    CHK(pConnectionListener->socketCount < pConnectionListener->maxSocketCount, STATUS_NOT_ENOUGH_MEMORY);
 
-    // Find an empty slot by checking whether connected
-    for (i = 0; iterate && i < CONNECTION_LISTENER_DEFAULT_MAX_LISTENING_CONNECTION; i++) {
-        if (pConnectionListener->sockets[i] == NULL) {
-            pConnectionListener->sockets[i] = pSocketConnection;
-            pConnectionListener->socketCount++;
-            iterate = FALSE;
-        }
+    // Find an empty slot, there is one as the count is below the maximum
+    i = 0;
+    while (pConnectionListener->sockets[i] != NULL) {
+        i++;
     }
 
+#ifdef KVS_SOCKET_EPOLL_SUPPORTED
+    // Register with the owning worker's epoll set once, there is no fd set to rebuild afterwards.
+    // The event carries the slot rather than the socket so a stale event never reaches a freed socket
+    MUTEX_LOCK(pSocketConnection->lock);
+    localSocket = pSocketConnection->localSocket;
+    MUTEX_UNLOCK(pSocketConnection->lock);
+    workerIndex = connectionListenerPickWorker(pConnectionListener, pSocketConnection);
+    CHK_STATUS(connectionListenerEpollControl(pConnectionListener->workers[workerIndex].epollFd, EPOLL_CTL_ADD, localSocket,
+                                              EPOLLIN | EPOLLPRI | EPOLLET, i));
+    pConnectionListener->socketWorkers[i] = workerIndex;
+#endif
+
+    pConnectionListener->sockets[i] = pSocketConnection;
+    pConnectionListener->socketCount++;
+
     MUTEX_UNLOCK(pConnectionListener->lock);
     locked = FALSE;
 
@@ -138,6 +277,30 @@ CleanUp:
     return retStatus;
 }
 
+/**
+ * Empty the slot. Must be called with the listener lock held. The socket is only taken out of its epoll set when
+ * the caller knows the descriptor is still open, closing it removes it from the set anyway and its number may have been reused
+ */
+static VOID connectionListenerClearSlot(PConnectionListener pConnectionListener, UINT32 slot, BOOL unregister)
+{
+#ifdef KVS_SOCKET_EPOLL_SUPPORTED
+    PSocketConnection pSocketConnection = pConnectionListener->sockets[slot];
+
+    if (unregister) {
+        MUTEX_LOCK(pSocketConnection->lock);
+        connectionListenerEpollControl(pConnectionListener->workers[pConnectionListener->socketWorkers[slot]].epollFd, EPOLL_CTL_DEL,
+                                       pSocketConnection->localSocket, 0, 0);
+        MUTEX_UNLOCK(pSocketConnection->lock);
+    }
+#else
+    UNUSED_PARAM(unregister);
+#endif
+
+    // Mark the slot as empty and decrement the count
+    pConnectionListener->sockets[slot] = NULL;
+    pConnectionListener->socketCount--;
+}
+
 STATUS connectionListenerRemoveConnection(PConnectionListener pConnectionListener, PSocketConnection pSocketConnection)
 {
     STATUS retStatus = STATUS_SUCCESS;
@@ -154,13 +317,10 @@ STATUS connectionListenerRemoveConnection(PConnectionListener pConnectionListene
     CHK_STATUS(socketConnectionClosed(pSocketConnection));
 
     // Remove from the list of sockets
-    for (i = 0; iterate && i < CONNECTION_LISTENER_DEFAULT_MAX_LISTENING_CONNECTION; i++) {
+    for (i = 0; iterate && i < pConnectionListener->maxSocketCount; i++) {
         if (pConnectionListener->sockets[i] == pSocketConnection) {
             iterate = FALSE;
-
-            // Mark the slot as empty and decrement the count
-            pConnectionListener->sockets[i] = NULL;
-            pConnectionListener->socketCount--;
+            connectionListenerClearSlot(pConnectionListener, i, TRUE);
         }
     }
 
@@ -185,11 +345,10 @@ STATUS connectionListenerRemoveAllConnection(PConnectionListener pConnectionList
     MUTEX_LOCK(pConnectionListener->lock);
     locked = TRUE;
 
-    for (i = 0; i < CONNECTION_LISTENER_DEFAULT_MAX_LISTENING_CONNECTION; i++) {
+    for (i = 0; i < pConnectionListener->maxSocketCount; i++) {
         if (pConnectionListener->sockets[i] != NULL) {
             CHK_STATUS(socketConnectionClosed(pConnectionListener->sockets[i]));
-            pConnectionListener->sockets[i] = NULL;
-            pConnectionListener->socketCount--;
+            connectionListenerClearSlot(pConnectionListener, i, TRUE);
         }
     }
 
@@ -206,6 +365,9 @@ STATUS connectionListenerStart(PConnectionListener pConnectionListener)
 {
     STATUS retStatus = STATUS_SUCCESS;
     BOOL locked = FALSE;
+#ifdef KVS_SOCKET_EPOLL_SUPPORTED
+    UINT32 i;
+#endif
 
     CHK(pConnectionListener != NULL, STATUS_NULL_ARG);
     CHK(!ATOMIC_LOAD_BOOL(&pConnectionListener->terminate), retStatus);
@@ -214,7 +376,18 @@ STATUS connectionListenerStart(PConnectionListener pConnectionListener)
     locked = TRUE;
 
     CHK(!IS_VALID_TID_VALUE(pConnectionListener->receiveDataRoutine), retStatus);
+#ifdef KVS_SOCKET_EPOLL_SUPPORTED
+    for (i = 0; i < pConnectionListener->workerCount; i++) {
+        CHK_STATUS(THREAD_CREATE(&pConnectionListener->workers[i].receiveDataRoutine, connectionListenerEpollReceiveDataRoutine,
+                                 (PVOID) &pConnectionListener->workers[i]));
+        if (i == 0) {
+            pConnectionListener->receiveDataRoutine = pConnectionListener->workers[0].receiveDataRoutine;
+        }
+    }
+#else
     CHK_STATUS(THREAD_CREATE(&pConnectionListener->receiveDataRoutine, connectionListenerReceiveDataRoutine, (PVOID) pConnectionListener));
+    pConnectionListener->workers[0].receiveDataRoutine = pConnectionListener->receiveDataRoutine;
+#endif
 
 CleanUp:
 
@@ -225,6 +398,86 @@ CleanUp:
     return retStatus;
 }
 
+PSharedConnectionListener getSharedConnectionListenerInstance(VOID)
+{
+    static SharedConnectionListener sharedConnectionListener = {.isInitialized = FALSE, .lock = INVALID_MUTEX_VALUE, .pConnectionListener = NULL};
+    return &sharedConnectionListener;
+}
+
+STATUS createSharedConnectionListener(VOID)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    PSharedConnectionListener pShared = getSharedConnectionListenerInstance();
+
+    CHK_WARN(!pShared->isInitialized, retStatus, "Shared connection listener already set up. Nothing to do");
+
+    pShared->lock = MUTEX_CREATE(FALSE);
+    CHK(IS_VALID_MUTEX_VALUE(pShared->lock), STATUS_INVALID_OPERATION);
+    pShared->isInitialized = TRUE;
+
+CleanUp:
+
+    return retStatus;
+}
+
+STATUS freeSharedConnectionListener(VOID)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    PSharedConnectionListener pShared = getSharedConnectionListenerInstance();
+
+    if (pShared->pConnectionListener != NULL) {
+        CHK_LOG_ERR(freeConnectionListener(&pShared->pConnectionListener));
+    }
+
+    if (IS_VALID_MUTEX_VALUE(pShared->lock)) {
+        MUTEX_FREE(pShared->lock);
+        // reset so the listener can be set up again after deinitKvsWebRtc
+        pShared->lock = INVALID_MUTEX_VALUE;
+    }
+
+    pShared->isInitialized = FALSE;
+
+    return retStatus;
+}
+
+STATUS sharedConnectionListenerAcquire(UINT32 workerCount, PConnectionListener* ppConnectionListener)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    PSharedConnectionListener pShared = getSharedConnectionListenerInstance();
+    PConnectionListener pConnectionListener = NULL;
+    BOOL locked = FALSE;
+
+    CHK(ppConnectionListener != NULL, STATUS_NULL_ARG);
+    CHK_ERR(pShared->isInitialized, STATUS_INVALID_OPERATION, "Shared connection listener not initialized yet");
+
+    MUTEX_LOCK(pShared->lock);
+    locked = TRUE;
+
+    if (pShared->pConnectionListener == NULL) {
+        CHK_STATUS(createConnectionListenerWithWorkers(workerCount, CONNECTION_LISTENER_SHARED_MAX_LISTENING_CONNECTION, &pConnectionListener));
+        retStatus = connectionListenerStart(pConnectionListener);
+        if (STATUS_FAILED(retStatus)) {
+            freeConnectionListener(&pConnectionListener);
+            CHK(FALSE, retStatus);
+        }
+
+        pShared->pConnectionListener = pConnectionListener;
+        DLOGI("Created shared connection listener with %u receive threads", pConnectionListener->workerCount);
+    }
+
+    *ppConnectionListener = pShared->pConnectionListener;
+
+CleanUp:
+
+    CHK_LOG_ERR(retStatus);
+
+    if (locked) {
+        MUTEX_UNLOCK(pShared->lock);
+    }
+
+    return retStatus;
+}
+
 BOOL canReadFd(INT32 fd, struct pollfd* fds, INT32 nfds)
 {
     INT32 i;
@@ -236,12 +489,168 @@ BOOL canReadFd(INT32 fd, struct pollfd* fds, INT32 nfds)
     return FALSE;
 }
 
+/**
+ * Hand a datagram or a chunk of stream data that was read from the socket to its data available callback
+ */
+static VOID connectionListenerDispatchData(PSocketConnection pSocketConnection, PBYTE pBuffer, UINT32 bufferLen, UINT32 readLen,
+                                           struct sockaddr_storage* pSrcAddrBuff)
+{
+    struct sockaddr_in* pIpv4Addr;
+    struct sockaddr_in6* pIpv6Addr;
+    KvsIpAddress srcAddr;
+    PKvsIpAddress pSrcAddr = NULL;
+
+    if (!ATOMIC_LOAD_BOOL(&pSocketConnection->receiveData) || pSocketConnection->dataAvailableCallbackFn == NULL ||
+        /* data could be encrypted so they need to be decrypted through socketConnectionReadData
+         * and get the decrypted data length. */
+        STATUS_FAILED(socketConnectionReadData(pSocketConnection, pBuffer, bufferLen, &readLen))) {
+        return;
+    }
+
+    if (pSocketConnection->protocol == KVS_SOCKET_PROTOCOL_UDP) {
+        MEMSET(&srcAddr, 0x00, SIZEOF(KvsIpAddress));
+        srcAddr.isPointToPoint = FALSE;
+        if (pSrcAddrBuff->ss_family == AF_INET) {
+            srcAddr.family = KVS_IP_FAMILY_TYPE_IPV4;
+            pIpv4Addr = (struct sockaddr_in*) pSrcAddrBuff;
+            MEMCPY(srcAddr.address, (PBYTE) &pIpv4Addr->sin_addr, IPV4_ADDRESS_LENGTH);
+            srcAddr.port = pIpv4Addr->sin_port;
+        } else if (pSrcAddrBuff->ss_family == AF_INET6) {
+            srcAddr.family = KVS_IP_FAMILY_TYPE_IPV6;
+            pIpv6Addr = (struct sockaddr_in6*) pSrcAddrBuff;
+            MEMCPY(srcAddr.address, (PBYTE) &pIpv6Addr->sin6_addr, IPV6_ADDRESS_LENGTH);
+            srcAddr.port = pIpv6Addr->sin6_port;
+        }
+        pSrcAddr = &srcAddr;
+    } else {
+        // srcAddr is ignored in TCP callback handlers
+        pSrcAddr = NULL;
+    }
+
+    // readLen may be 0 if SSL does not emit any application data.
+    // in that case, no need to call dataAvailable callback
+    if (readLen > 0) {
+        pSocketConnection->dataAvailableCallbackFn(pSocketConnection->dataAvailableCallbackCustomData, pSocketConnection, pBuffer, readLen, pSrcAddr,
+                                                   NULL); // no dest information available right now.
+    }
+}
+
+#ifdef KVS_SOCKET_RECEIVE_BATCH_SUPPORTED
+/**
+ * Drain a readable UDP socket with recvmmsg(), CONNECTION_LISTENER_RECEIVE_BATCH_SIZE datagrams per syscall,
+ * and dispatch the batch once it has been read
+ */
+static STATUS connectionListenerReceiveBatch(PBYTE pBatchBuffer, PSocketConnection pSocketConnection, INT32 localSocket)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    struct mmsghdr msgs[CONNECTION_LISTENER_RECEIVE_BATCH_SIZE];
+    struct iovec iovs[CONNECTION_LISTENER_RECEIVE_BATCH_SIZE];
+    struct sockaddr_storage srcAddrBuffs[CONNECTION_LISTENER_RECEIVE_BATCH_SIZE];
+    INT32 received = CONNECTION_LISTENER_RECEIVE_BATCH_SIZE, i;
+
+    // A short batch means the socket queue has been drained
+    while (received == CONNECTION_LISTENER_RECEIVE_BATCH_SIZE && !socketConnectionIsClosed(pSocketConnection)) {
+        MEMSET(msgs, 0x00, SIZEOF(msgs));
+        for (i = 0; i < CONNECTION_LISTENER_RECEIVE_BATCH_SIZE; i++) {
+            iovs[i].iov_base = pBatchBuffer + i * MAX_UDP_PACKET_SIZE;
+            iovs[i].iov_len = MAX_UDP_PACKET_SIZE;
+            msgs[i].msg_hdr.msg_iov = &iovs[i];
+            msgs[i].msg_hdr.msg_iovlen = 1;
+            msgs[i].msg_hdr.msg_name = &srcAddrBuffs[i];
+            msgs[i].msg_hdr.msg_namelen = SIZEOF(srcAddrBuffs[i]);
+        }
+
+        received = recvmmsg(localSocket, msgs, CONNECTION_LISTENER_RECEIVE_BATCH_SIZE, 0, NULL);
+        if (received < 0) {
+            switch (getErrorCode()) {
+                case EWOULDBLOCK:
+                    break;
+                default:
+                    /* on any other error, close connection */
+                    CHK_STATUS(socketConnectionClosed(pSocketConnection));
+                    DLOGD("recvmmsg() failed with errno %s for socket %d", getErrorString(getErrorCode()), localSocket);
+                    break;
+            }
+
+            break;
+        }
+
+        for (i = 0; i < received; i++) {
+            // Same as recvfrom() into a MAX_UDP_PACKET_SIZE buffer, only an IPv6 jumbo payload can be truncated
+            if ((msgs[i].msg_hdr.msg_flags & MSG_TRUNC) != 0) {
+                DLOGW("Dropping datagram larger than %u bytes on socket %d", MAX_UDP_PACKET_SIZE, localSocket);
+            } else if (msgs[i].msg_len > 0) {
+                connectionListenerDispatchData(pSocketConnection, (PBYTE) iovs[i].iov_base, MAX_UDP_PACKET_SIZE, msgs[i].msg_len, &srcAddrBuffs[i]);
+            }
+        }
+    }
+
+CleanUp:
+
+    return retStatus;
+}
+#endif
+
+/**
+ * Read everything pending on a readable socket and dispatch it
+ */
+static STATUS connectionListenerReadSocket(PConnectionListenerWorker pWorker, PSocketConnection pSocketConnection, INT32 localSocket)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    BOOL iterate = TRUE;
+    INT64 readLen;
+    // the source address is put here. sockaddr_storage can hold either sockaddr_in or sockaddr_in6
+    struct sockaddr_storage srcAddrBuff;
+    socklen_t srcAddrBuffLen = SIZEOF(srcAddrBuff);
+
+#ifdef KVS_SOCKET_RECEIVE_BATCH_SUPPORTED
+    if (pSocketConnection->protocol == KVS_SOCKET_PROTOCOL_UDP && pWorker->pBatchBuffer == NULL) {
+        // Only read by this worker. Reads one datagram at a time with recvfrom() if it can't be allocated
+        pWorker->pBatchBuffer = (PBYTE) MEMALLOC(CONNECTION_LISTENER_RECEIVE_BATCH_SIZE * MAX_UDP_PACKET_SIZE);
+    }
+
+    if (pSocketConnection->protocol == KVS_SOCKET_PROTOCOL_UDP && pWorker->pBatchBuffer != NULL) {
+        // recvmmsg() drains the socket on its own
+        CHK_STATUS(connectionListenerReceiveBatch(pWorker->pBatchBuffer, pSocketConnection, localSocket));
+        iterate = FALSE;
+    }
+#endif
+
+    while (iterate) {
+        readLen = recvfrom(localSocket, pWorker->pBuffer, MAX_UDP_PACKET_SIZE, 0, (struct sockaddr*) &srcAddrBuff, &srcAddrBuffLen);
+        if (readLen < 0) {
+            switch (getErrorCode()) {
+                case EWOULDBLOCK:
+                    break;
+                default:
+                    /* on any other error, close connection */
+                    CHK_STATUS(socketConnectionClosed(pSocketConnection));
+                    DLOGD("recvfrom() failed with errno %s for socket %d", getErrorString(getErrorCode()), localSocket);
+                    break;
+            }
+
+            iterate = FALSE;
+        } else if (readLen == 0) {
+            CHK_STATUS(socketConnectionClosed(pSocketConnection));
+            iterate = FALSE;
+        } else {
+            connectionListenerDispatchData(pSocketConnection, pWorker->pBuffer, MAX_UDP_PACKET_SIZE, (UINT32) readLen, &srcAddrBuff);
+        }
+
+        // reset srcAddrBuffLen to actual size
+        srcAddrBuffLen = SIZEOF(srcAddrBuff);
+    }
+
+CleanUp:
+
+    return retStatus;
+}
+
 PVOID connectionListenerReceiveDataRoutine(PVOID arg)
 {
     STATUS retStatus = STATUS_SUCCESS;
     PConnectionListener pConnectionListener = (PConnectionListener) arg;
     PSocketConnection pSocketConnection;
-    BOOL iterate = TRUE;
     PSocketConnection sockets[CONNECTION_LISTENER_DEFAULT_MAX_LISTENING_CONNECTION];
     UINT32 i, socketCount;
 
@@ -249,14 +658,6 @@ PVOID connectionListenerReceiveDataRoutine(PVOID arg)
     //+1 added for the pipe() to kickout poll()
     struct pollfd rfds[CONNECTION_LISTENER_DEFAULT_MAX_LISTENING_CONNECTION + 1];
     INT32 retval, localSocket;
-    INT64 readLen;
-    // the source address is put here. sockaddr_storage can hold either sockaddr_in or sockaddr_in6
-    struct sockaddr_storage srcAddrBuff;
-    socklen_t srcAddrBuffLen = SIZEOF(srcAddrBuff);
-    struct sockaddr_in* pIpv4Addr;
-    struct sockaddr_in6* pIpv6Addr;
-    KvsIpAddress srcAddr;
-    PKvsIpAddress pSrcAddr = NULL;
 
     CHK(pConnectionListener != NULL, STATUS_NULL_ARG);
 
@@ -265,8 +666,6 @@ PVOID connectionListenerReceiveDataRoutine(PVOID arg)
      * implemented in assembly. */
     MEMSET(&rfds, 0x00, SIZEOF(rfds));
 
-    srcAddr.isPointToPoint = FALSE;
-
     while (!ATOMIC_LOAD_BOOL(&pConnectionListener->terminate)) {
         nfds = 0;
 
@@ -274,7 +673,7 @@ PVOID connectionListenerReceiveDataRoutine(PVOID arg)
         // NOTE: There is no cleanup jump from the lock/unlock block
         // so we don't need to use a boolean indicator whether locked
         MUTEX_LOCK(pConnectionListener->lock);
-        for (i = 0, socketCount = 0; i < CONNECTION_LISTENER_DEFAULT_MAX_LISTENING_CONNECTION; i++) {
+        for (i = 0, socketCount = 0; i < pConnectionListener->maxSocketCount; i++) {
             pSocketConnection = pConnectionListener->sockets[i];
             if (pSocketConnection != NULL) {
                 if (!socketConnectionIsClosed(pSocketConnection)) {
@@ -330,61 +729,7 @@ PVOID connectionListenerReceiveDataRoutine(PVOID arg)
                     MUTEX_UNLOCK(pSocketConnection->lock);
 
                     if (canReadFd(localSocket, rfds, nfds)) {
-                        iterate = TRUE;
-                        while (iterate) {
-                            readLen = recvfrom(localSocket, pConnectionListener->pBuffer, pConnectionListener->bufferLen, 0,
-                                               (struct sockaddr*) &srcAddrBuff, &srcAddrBuffLen);
-                            if (readLen < 0) {
-                                switch (getErrorCode()) {
-                                    case EWOULDBLOCK:
-                                        break;
-                                    default:
-                                        /* on any other error, close connection */
-                                        CHK_STATUS(socketConnectionClosed(pSocketConnection));
-                                        DLOGD("recvfrom() failed with errno %s for socket %d", getErrorString(getErrorCode()), localSocket);
-                                        break;
-                                }
-
-                                iterate = FALSE;
-                            } else if (readLen == 0) {
-                                CHK_STATUS(socketConnectionClosed(pSocketConnection));
-                                iterate = FALSE;
-                            } else if (/* readLen > 0 */
-                                       ATOMIC_LOAD_BOOL(&pSocketConnection->receiveData) && pSocketConnection->dataAvailableCallbackFn != NULL &&
-                                       /* data could be encrypted so they need to be decrypted through socketConnectionReadData
-                                        * and get the decrypted data length. */
-                                       STATUS_SUCCEEDED(socketConnectionReadData(pSocketConnection, pConnectionListener->pBuffer,
-                                                                                 pConnectionListener->bufferLen, (PUINT32) &readLen))) {
-                                if (pSocketConnection->protocol == KVS_SOCKET_PROTOCOL_UDP) {
-                                    if (srcAddrBuff.ss_family == AF_INET) {
-                                        srcAddr.family = KVS_IP_FAMILY_TYPE_IPV4;
-                                        pIpv4Addr = (struct sockaddr_in*) &srcAddrBuff;
-                                        MEMCPY(srcAddr.address, (PBYTE) &pIpv4Addr->sin_addr, IPV4_ADDRESS_LENGTH);
-                                        srcAddr.port = pIpv4Addr->sin_port;
-                                    } else if (srcAddrBuff.ss_family == AF_INET6) {
-                                        srcAddr.family = KVS_IP_FAMILY_TYPE_IPV6;
-                                        pIpv6Addr = (struct sockaddr_in6*) &srcAddrBuff;
-                                        MEMCPY(srcAddr.address, (PBYTE) &pIpv6Addr->sin6_addr, IPV6_ADDRESS_LENGTH);
-                                        srcAddr.port = pIpv6Addr->sin6_port;
-                                    }
-                                    pSrcAddr = &srcAddr;
-                                } else {
-                                    // srcAddr is ignored in TCP callback handlers
-                                    pSrcAddr = NULL;
-                                }
-
-                                // readLen may be 0 if SSL does not emit any application data.
-                                // in that case, no need to call dataAvailable callback
-                                if (readLen > 0) {
-                                    pSocketConnection->dataAvailableCallbackFn(pSocketConnection->dataAvailableCallbackCustomData, pSocketConnection,
-                                                                               pConnectionListener->pBuffer, (UINT32) readLen, pSrcAddr,
-                                                                               NULL); // no dest information available right now.
-                                }
-                            }
-
-                            // reset srcAddrBuffLen to actual size
-                            srcAddrBuffLen = SIZEOF(srcAddrBuff);
-                        }
+                        CHK_STATUS(connectionListenerReadSocket(&pConnectionListener->workers[0], pSocketConnection, localSocket));
                     }
                 }
             }
@@ -402,3 +747,86 @@ CleanUp:
 
     return (PVOID) (ULONG_PTR) retStatus;
 }
+
+#ifdef KVS_SOCKET_EPOLL_SUPPORTED
+PVOID connectionListenerEpollReceiveDataRoutine(PVOID arg)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    PConnectionListenerWorker pWorker = (PConnectionListenerWorker) arg;
+    PConnectionListener pConnectionListener = NULL;
+    PSocketConnection pSocketConnection;
+    struct epoll_event events[CONNECTION_LISTENER_EPOLL_MAX_EVENTS];
+    INT32 eventCount, i, localSocket;
+    UINT32 slot, workerIndex;
+    UINT64 nextSweepTime = 0, currentTime;
+
+    CHK(pWorker != NULL && pWorker->pConnectionListener != NULL, STATUS_NULL_ARG);
+    pConnectionListener = pWorker->pConnectionListener;
+    workerIndex = (UINT32) (pWorker - pConnectionListener->workers);
+
+    while (!ATOMIC_LOAD_BOOL(&pConnectionListener->terminate)) {
+        // Sockets marked as closed are dropped from this worker's share of the table. Their descriptors leave the
+        // epoll set when they get closed. A shared listener has thousands of slots, so they are not walked on every wake up
+        currentTime = GETTIME();
+        if (currentTime >= nextSweepTime) {
+            MUTEX_LOCK(pConnectionListener->lock);
+            for (slot = 0; slot < pConnectionListener->maxSocketCount; slot++) {
+                if (pConnectionListener->sockets[slot] != NULL && pConnectionListener->socketWorkers[slot] == workerIndex &&
+                    socketConnectionIsClosed(pConnectionListener->sockets[slot])) {
+                    connectionListenerClearSlot(pConnectionListener, slot, FALSE);
+                }
+            }
+            MUTEX_UNLOCK(pConnectionListener->lock);
+            nextSweepTime = currentTime + CONNECTION_LISTENER_SOCKET_WAIT_FOR_DATA_TIMEOUT;
+        }
+
+        // blocking call until resolves as a timeout, an error, a signal or data received
+        eventCount = epoll_wait(pWorker->epollFd, events, CONNECTION_LISTENER_EPOLL_MAX_EVENTS,
+                                CONNECTION_LISTENER_SOCKET_WAIT_FOR_DATA_TIMEOUT / HUNDREDS_OF_NANOS_IN_A_MILLISECOND);
+        if (eventCount < 0) {
+            if (getErrorCode() != EINTR) {
+                DLOGW("epoll_wait() failed with errno %s", getErrorString(getErrorCode()));
+            }
+
+            continue;
+        }
+
+        for (i = 0; i < eventCount && !ATOMIC_LOAD_BOOL(&pConnectionListener->terminate); i++) {
+            slot = events[i].data.u32;
+            if (slot == CONNECTION_LISTENER_EPOLL_KICK_EVENT) {
+                continue;
+            }
+
+            // Resolve the slot and mark the socket as in use under the lock so it can't be freed while being read.
+            // If the slot was reused since the event fired the new socket is read instead, which is harmless
+            MUTEX_LOCK(pConnectionListener->lock);
+            pSocketConnection = pConnectionListener->sockets[slot];
+            if (pSocketConnection != NULL && !socketConnectionIsClosed(pSocketConnection)) {
+                ATOMIC_STORE_BOOL(&pSocketConnection->inUse, TRUE);
+            } else {
+                pSocketConnection = NULL;
+            }
+            MUTEX_UNLOCK(pConnectionListener->lock);
+
+            if (pSocketConnection == NULL) {
+                continue;
+            }
+
+            MUTEX_LOCK(pSocketConnection->lock);
+            localSocket = pSocketConnection->localSocket;
+            MUTEX_UNLOCK(pSocketConnection->lock);
+
+            // Edge triggered, so the socket has to be drained before waiting again
+            retStatus = connectionListenerReadSocket(pWorker, pSocketConnection, localSocket);
+            ATOMIC_STORE_BOOL(&pSocketConnection->inUse, FALSE);
+            CHK_STATUS(retStatus);
+        }
+    }
+
+CleanUp:
+
+    CHK_LOG_ERR(retStatus);
+
+    return (PVOID) (ULONG_PTR) retStatus;
+}
+#endif
@@ -16,14 +16,60 @@ extern "C" {
 #define CONNECTION_LISTENER_KICK_SOCKET_LISTEN               0
 #define CONNECTION_LISTENER_KICK_SOCKET_WRITE                1
 
+// Sockets of every peer connection in the process. Only with epoll, the poll backend is limited to the default
+#define CONNECTION_LISTENER_SHARED_MAX_LISTENING_CONNECTION 4096
+
+// Number of datagrams drained from a UDP socket by a single recvmmsg() call. Each one gets a MAX_UDP_PACKET_SIZE buffer
+#define CONNECTION_LISTENER_RECEIVE_BATCH_SIZE 16
+
+// Receive threads of a listener created with createConnectionListener
+#define CONNECTION_LISTENER_DEFAULT_WORKER_COUNT 1
+#define CONNECTION_LISTENER_MAX_WORKER_COUNT     16
+
+// Number of ready sockets a worker picks up from a single epoll_wait() call
+#define CONNECTION_LISTENER_EPOLL_MAX_EVENTS 32
+
+// epoll event data marking the kick socket rather than a socket slot
+#define CONNECTION_LISTENER_EPOLL_KICK_EVENT MAX_UINT32
+
+struct __ConnectionListener;
+
+/**
+ * A receive thread together with the buffers it reads into. With epoll every worker owns the epoll set
+ * of the sockets sharded to it
+ */
 typedef struct {
+    struct __ConnectionListener* pConnectionListener;
+    TID receiveDataRoutine;
+    PBYTE pBuffer;
+#ifdef KVS_SOCKET_RECEIVE_BATCH_SUPPORTED
+    // CONNECTION_LISTENER_RECEIVE_BATCH_SIZE buffers of MAX_UDP_PACKET_SIZE for UDP sockets, allocated by the worker when it
+    // first reads one. Only the pages the datagrams are written to become resident
+    PBYTE pBatchBuffer;
+#endif
+#ifdef KVS_SOCKET_EPOLL_SUPPORTED
+    INT32 epollFd;
+#endif
+} ConnectionListenerWorker, *PConnectionListenerWorker;
+
+typedef struct __ConnectionListener {
     volatile ATOMIC_BOOL terminate;
-    PSocketConnection sockets[CONNECTION_LISTENER_DEFAULT_MAX_LISTENING_CONNECTION];
+    // maxSocketCount slots, NULL when empty
+    PSocketConnection* sockets;
+    UINT32 maxSocketCount;
     UINT64 socketCount;
     MUTEX lock;
+    // Thread of the first worker
     TID receiveDataRoutine;
+    // Receive buffer of the first worker
     PBYTE pBuffer;
     UINT64 bufferLen;
+    UINT32 workerCount;
+    ConnectionListenerWorker workers[CONNECTION_LISTENER_MAX_WORKER_COUNT];
+#ifdef KVS_SOCKET_EPOLL_SUPPORTED
+    // Index of the worker whose epoll set holds the socket in the same slot of sockets
+    PUINT32 socketWorkers;
+#endif
 #ifndef _WIN32
     INT32 kickSocket[2];
 #endif
@@ -38,6 +84,18 @@ typedef struct {
  */
 STATUS createConnectionListener(PConnectionListener*);
 
+/**
+ * allocate the ConnectionListener struct with several receive threads. Where epoll is available each thread
+ * waits on its own shard of the sockets, picked by their 5-tuple. Elsewhere a single thread polls every socket.
+ *
+ * @param - UINT32 - IN - number of receive threads, up to CONNECTION_LISTENER_MAX_WORKER_COUNT
+ * @param - UINT32 - IN - number of sockets listened to at once, up to CONNECTION_LISTENER_DEFAULT_MAX_LISTENING_CONNECTION without epoll
+ * @param - PConnectionListener* - IN/OUT - pointer to PConnectionListener being allocated
+ *
+ * @return - STATUS status of execution
+ */
+STATUS createConnectionListenerWithWorkers(UINT32, UINT32, PConnectionListener*);
+
 /**
  * free the ConnectionListener struct and all its resources
  *
@@ -86,10 +144,50 @@ STATUS connectionListenerRemoveAllConnection(PConnectionListener);
  */
 STATUS connectionListenerStart(PConnectionListener);
 
+/**
+ * Process wide connection listener every peer connection configured with KvsRtcConfiguration.connectionListenerWorkerCount
+ * receives on. It is started by the first peer connection using it and lives until deinitKvsWebRtc.
+ */
+typedef struct {
+    BOOL isInitialized;
+    MUTEX lock;
+    PConnectionListener pConnectionListener;
+} SharedConnectionListener, *PSharedConnectionListener;
+
+PSharedConnectionListener getSharedConnectionListenerInstance(VOID);
+
+/**
+ * Set up the shared connection listener. Called by initKvsWebRtc, the listener itself is created on first use
+ *
+ * @return - STATUS status of execution
+ */
+STATUS createSharedConnectionListener(VOID);
+
+/**
+ * Stop the shared connection listener. Every socket must have been removed from it
+ *
+ * @return - STATUS status of execution
+ */
+STATUS freeSharedConnectionListener(VOID);
+
+/**
+ * Get the shared connection listener, creating and starting it with the given number of receive threads if it
+ * doesn't exist yet. The listener must not be freed by the caller.
+ *
+ * @param - UINT32 - IN - number of receive threads, only used by the first caller
+ * @param - PConnectionListener* - OUT - the shared listener
+ *
+ * @return - STATUS status of execution
+ */
+STATUS sharedConnectionListenerAcquire(UINT32, PConnectionListener*);
+
 ////////////////////////////////////////////
 // internal functionalities
 ////////////////////////////////////////////
 PVOID connectionListenerReceiveDataRoutine(PVOID arg);
+#ifdef KVS_SOCKET_EPOLL_SUPPORTED
+PVOID connectionListenerEpollReceiveDataRoutine(PVOID arg);
+#endif
 
 #ifdef __cplusplus
 }
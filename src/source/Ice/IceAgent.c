@@ -41,6 +41,8 @@ STATUS createIceAgent(PCHAR username, PCHAR password, PIceAgentCallbacks pIceAge
     CHK(NULL != (pIceAgent = (PIceAgent) MEMCALLOC(1, SIZEOF(IceAgent))), STATUS_NOT_ENOUGH_MEMORY);
     STRNCPY(pIceAgent->localUsername, username, MAX_ICE_CONFIG_USER_NAME_LEN);
     STRNCPY(pIceAgent->localPassword, password, MAX_ICE_CONFIG_CREDENTIAL_LEN);
+    CHK_STATUS(kvsSha1HmacKeyInit(&pIceAgent->localPasswordHmacKey, (PBYTE) pIceAgent->localPassword,
+                                  (UINT32) STRLEN(pIceAgent->localPassword) * SIZEOF(CHAR)));
     ATOMIC_STORE_BOOL(&pIceAgent->remoteCredentialReceived, FALSE);
     ATOMIC_STORE_BOOL(&pIceAgent->agentStartGathering, FALSE);
     ATOMIC_STORE_BOOL(&pIceAgent->stopGathering, FALSE);
@@ -77,6 +79,7 @@ STATUS createIceAgent(PCHAR username, PCHAR password, PIceAgentCallbacks pIceAge
     pIceAgent->detectedDisconnection = FALSE;
     pIceAgent->disconnectionGracePeriodEndTime = INVALID_TIMESTAMP_VALUE;
     pIceAgent->pConnectionListener = pConnectionListener;
+    pIceAgent->sharedConnectionListener = pIceAgent->kvsRtcConfiguration.connectionListenerWorkerCount > 0;
     pIceAgent->pDataSendingIceCandidatePair = NULL;
     pIceAgent->iceAgentState = ICE_AGENT_STATE_NEW;
     CHK_STATUS(createTransactionIdStore(DEFAULT_MAX_STORED_TRANSACTION_ID_COUNT, &pIceAgent->pStunBindingRequestTransactionIdStore));
@@ -92,6 +95,8 @@ STATUS createIceAgent(PCHAR username, PCHAR password, PIceAgentCallbacks pIceAge
     CHK_STATUS(doubleListCreate(&pIceAgent->localCandidates));
     CHK_STATUS(doubleListCreate(&pIceAgent->remoteCandidates));
     CHK_STATUS(doubleListCreate(&pIceAgent->iceCandidatePairs));
+    CHK_STATUS(hashTableCreateWithParams(ICE_CANDIDATE_PAIR_INDEX_BUCKET_COUNT, ICE_CANDIDATE_PAIR_INDEX_BUCKET_LENGTH,
+                                         &pIceAgent->iceCandidatePairIndex));
     CHK_STATUS(stackQueueCreate(&pIceAgent->triggeredCheckQueue));
 
     // Pre-allocate stun packets
@@ -108,6 +113,10 @@ STATUS createIceAgent(PCHAR username, PCHAR password, PIceAgentCallbacks pIceAge
             } else {
                 pIceAgent->iceServers[pIceAgent->iceServersCount].setIpFn = NULL;
             }
+            // host names the early stun resolution does not cover are resolved once per process instead of once per agent
+            if (pIceAgent->kvsRtcConfiguration.enableIceCandidateCache && pIceAgent->iceServers[pIceAgent->iceServersCount].setIpFn == NULL) {
+                pIceAgent->iceServers[pIceAgent->iceServersCount].setIpFn = iceCandidateCacheResolveHost;
+            }
             PROFILE_CALL_WITH_T_OBJ(
                 retStatus = parseIceServer(&pIceAgent->iceServers[pIceAgent->iceServersCount], (PCHAR) pRtcConfiguration->iceServers[i].urls,
                                            (PCHAR) pRtcConfiguration->iceServers[i].username, (PCHAR) pRtcConfiguration->iceServers[i].credential),
@@ -166,6 +175,99 @@ CleanUp:
  * @param ppIceAgent
  * @return
  */
+/**
+ * Take the socket of the candidate off the process wide connection listener, which keeps receiving for the other peer
+ * connections. Sockets of shared turn allocations belong to the allocation pool and private turn sockets are freed
+ * along with their turn connection. A host socket is freed as well when freeSocket is set, which waits for the
+ * listener to be done with it.
+ */
+static STATUS iceAgentRemoveSharedListenerConnection(PIceAgent pIceAgent, PIceCandidate pIceCandidate, BOOL freeSocket)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+
+    CHK(pIceCandidate->pSocketConnection != NULL && pIceCandidate->pTurnSubscription == NULL, retStatus);
+
+    if (pIceCandidate->iceCandidateType != ICE_CANDIDATE_TYPE_RELAYED) {
+        CHK_STATUS(connectionListenerRemoveConnection(pIceAgent->pConnectionListener, pIceCandidate->pSocketConnection));
+        if (freeSocket) {
+            CHK_STATUS(freeSocketConnection(&pIceCandidate->pSocketConnection));
+        }
+    } else if (pIceCandidate->pTurnConnection != NULL) {
+        CHK_STATUS(connectionListenerRemoveConnection(pIceAgent->pConnectionListener, pIceCandidate->pSocketConnection));
+    }
+
+CleanUp:
+
+    return retStatus;
+}
+
+static STATUS iceAgentRemoveSharedListenerConnections(PIceAgent pIceAgent, BOOL freeSockets)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    PDoubleListNode pCurNode = NULL;
+
+    /* In case we are in the middle of a ICE restart the old data sending candidate is not in localCandidates anymore */
+    if (ATOMIC_LOAD_BOOL(&pIceAgent->restart) && pIceAgent->pDataSendingIceCandidatePair != NULL) {
+        CHK_STATUS(iceAgentRemoveSharedListenerConnection(pIceAgent, pIceAgent->pDataSendingIceCandidatePair->local, freeSockets));
+    }
+
+    if (pIceAgent->localCandidates != NULL) {
+        CHK_STATUS(doubleListGetHeadNode(pIceAgent->localCandidates, &pCurNode));
+        while (pCurNode != NULL) {
+            CHK_STATUS(iceAgentRemoveSharedListenerConnection(pIceAgent, (PIceCandidate) pCurNode->data, freeSockets));
+            pCurNode = pCurNode->pNext;
+        }
+    }
+
+CleanUp:
+
+    return retStatus;
+}
+
+/*
+ * Frees a data sending pair dropped by an ice restart together with its local candidate, which is not in localCandidates anymore
+ */
+static STATUS iceAgentFreeRetiredIceCandidatePair(PIceAgent pIceAgent, PIceCandidatePair* ppIceCandidatePair)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    PIceCandidatePair pIceCandidatePair = *ppIceCandidatePair;
+
+    CHK(pIceCandidatePair != NULL, retStatus);
+
+    if (IS_CANN_PAIR_SENDING_FROM_RELAYED(pIceCandidatePair)) {
+        CHK_STATUS(iceCandidateShutdownTurnConnection(pIceCandidatePair->local, KVS_ICE_TURN_CONNECTION_SHUTDOWN_TIMEOUT));
+        CHK_STATUS(iceCandidateFreeTurnConnection(pIceCandidatePair->local));
+    } else {
+        CHK_STATUS(connectionListenerRemoveConnection(pIceAgent->pConnectionListener, pIceCandidatePair->local->pSocketConnection));
+        CHK_STATUS(freeSocketConnection(&pIceCandidatePair->local->pSocketConnection));
+    }
+
+    MEMFREE(pIceCandidatePair->local);
+    CHK_STATUS(freeIceCandidatePair(ppIceCandidatePair));
+
+CleanUp:
+
+    return retStatus;
+}
+
+/*
+ * Senders check the state of the data sending pair in its published path, which is republished when it changes
+ */
+static STATUS iceAgentUpdateCandidatePairState(PIceAgent pIceAgent, PIceCandidatePair pIceCandidatePair, ICE_CANDIDATE_PAIR_STATE state)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    BOOL succeeded = pIceCandidatePair->state == ICE_CANDIDATE_PAIR_STATE_SUCCEEDED;
+
+    pIceCandidatePair->state = state;
+    if (pIceCandidatePair == pIceAgent->pDataSendingIceCandidatePair && succeeded != (state == ICE_CANDIDATE_PAIR_STATE_SUCCEEDED)) {
+        CHK_STATUS(iceAgentPublishDataSendingPath(pIceAgent));
+    }
+
+CleanUp:
+
+    return retStatus;
+}
+
 STATUS freeIceAgent(PIceAgent* ppIceAgent)
 {
     ENTERS();
@@ -177,6 +279,7 @@ STATUS freeIceAgent(PIceAgent* ppIceAgent)
     UINT32 i;
     PIceCandidatePair pIceCandidatePair = NULL;
     PIceCandidate pIceCandidate = NULL;
+    PIceDataSendingPath pDataSendingPath = NULL;
 
     CHK(ppIceAgent != NULL, STATUS_NULL_ARG);
     // freeIceAgent is idempotent
@@ -184,6 +287,15 @@ STATUS freeIceAgent(PIceAgent* ppIceAgent)
 
     pIceAgent = *ppIceAgent;
 
+    // nobody sends anymore, so there is no need to wait for senders before freeing the data sending paths
+    pDataSendingPath = (PIceDataSendingPath) ATOMIC_EXCHANGE(&pIceAgent->dataSendingPath, 0);
+    SAFE_MEMFREE(pDataSendingPath);
+    while ((pDataSendingPath = pIceAgent->pRetiredDataSendingPaths) != NULL) {
+        pIceAgent->pRetiredDataSendingPaths = pDataSendingPath->pNextRetired;
+        CHK_LOG_ERR(iceAgentFreeRetiredIceCandidatePair(pIceAgent, &pDataSendingPath->pRetiredIceCandidatePair));
+        MEMFREE(pDataSendingPath);
+    }
+
     if (pIceAgent->localCandidates != NULL) {
         CHK_STATUS(doubleListGetHeadNode(pIceAgent->localCandidates, &pCurNode));
         while (pCurNode != NULL) {
@@ -191,13 +303,19 @@ STATUS freeIceAgent(PIceAgent* ppIceAgent)
             pCurNode = pCurNode->pNext;
 
             if (pIceCandidate->iceCandidateType == ICE_CANDIDATE_TYPE_RELAYED) {
-                CHK_LOG_ERR(freeTurnConnection(&pIceCandidate->pTurnConnection));
+                CHK_LOG_ERR(iceCandidateFreeTurnConnection(pIceCandidate));
             }
         }
     }
 
     if (pIceAgent->pConnectionListener != NULL) {
-        CHK_LOG_ERR(freeConnectionListener(&pIceAgent->pConnectionListener));
+        if (pIceAgent->sharedConnectionListener) {
+            // the shared listener keeps running, the host sockets are freed once it's done with them
+            CHK_LOG_ERR(iceAgentRemoveSharedListenerConnections(pIceAgent, TRUE));
+            pIceAgent->pConnectionListener = NULL;
+        } else {
+            CHK_LOG_ERR(freeConnectionListener(&pIceAgent->pConnectionListener));
+        }
     }
 
     if (pIceAgent->iceCandidatePairs != NULL) {
@@ -214,6 +332,10 @@ STATUS freeIceAgent(PIceAgent* ppIceAgent)
         CHK_LOG_ERR(doubleListFree(pIceAgent->iceCandidatePairs));
     }
 
+    if (pIceAgent->iceCandidatePairIndex != NULL) {
+        CHK_LOG_ERR(hashTableFree(pIceAgent->iceCandidatePairIndex));
+    }
+
     if (pIceAgent->localCandidates != NULL) {
         CHK_STATUS(doubleListGetHeadNode(pIceAgent->localCandidates, &pCurNode));
         while (pCurNode != NULL) {
@@ -221,7 +343,7 @@ STATUS freeIceAgent(PIceAgent* ppIceAgent)
             pCurNode = pCurNode->pNext;
             pIceCandidate = (PIceCandidate) data;
 
-            /* turn sockets are freed by freeTurnConnection */
+            /* turn sockets are freed by freeTurnConnection or belong to the turn allocation pool */
             if (pIceCandidate->iceCandidateType != ICE_CANDIDATE_TYPE_RELAYED) {
                 CHK_LOG_ERR(freeSocketConnection(&pIceCandidate->pSocketConnection));
             }
@@ -234,7 +356,7 @@ STATUS freeIceAgent(PIceAgent* ppIceAgent)
     /* In case we fail in the middle of a ICE restart */
     if (ATOMIC_LOAD_BOOL(&pIceAgent->restart) && pIceAgent->pDataSendingIceCandidatePair != NULL) {
         if (IS_CANN_PAIR_SENDING_FROM_RELAYED(pIceAgent->pDataSendingIceCandidatePair)) {
-            CHK_LOG_ERR(freeTurnConnection(&pIceAgent->pDataSendingIceCandidatePair->local->pTurnConnection));
+            CHK_LOG_ERR(iceCandidateFreeTurnConnection(pIceAgent->pDataSendingIceCandidatePair->local));
         } else {
             CHK_LOG_ERR(freeSocketConnection(&pIceAgent->pDataSendingIceCandidatePair->local->pSocketConnection));
         }
@@ -309,6 +431,11 @@ STATUS iceAgentValidateKvsRtcConfig(PKvsRtcConfiguration pKvsRtcConfiguration)
 
     if (pKvsRtcConfiguration->iceConnectionCheckPollingInterval == 0) {
         pKvsRtcConfiguration->iceConnectionCheckPollingInterval = KVS_ICE_CONNECTION_CHECK_POLLING_INTERVAL;
+    } else if (pKvsRtcConfiguration->iceConnectionCheckPollingInterval < KVS_ICE_MIN_CONNECTION_CHECK_POLLING_INTERVAL) {
+        DLOGW("iceConnectionCheckPollingInterval %u ms is below the %u ms minimum, using the minimum",
+              pKvsRtcConfiguration->iceConnectionCheckPollingInterval / HUNDREDS_OF_NANOS_IN_A_MILLISECOND,
+              KVS_ICE_MIN_CONNECTION_CHECK_POLLING_INTERVAL / HUNDREDS_OF_NANOS_IN_A_MILLISECOND);
+        pKvsRtcConfiguration->iceConnectionCheckPollingInterval = KVS_ICE_MIN_CONNECTION_CHECK_POLLING_INTERVAL;
     }
 
     DLOGI("\n\ticeLocalCandidateGatheringTimeout: %u ms"
@@ -470,7 +597,13 @@ STATUS iceAgentAddRemoteCandidate(PIceAgent pIceAgent, PCHAR pIceCandidateString
         pCurNode = pCurNode->pNext;
 
         if (pLocalIceCandidate->iceCandidateType == ICE_CANDIDATE_TYPE_RELAYED) {
-            CHK_STATUS(turnConnectionAddPeer(pLocalIceCandidate->pTurnConnection, &pIceCandidate->ipAddress));
+            retStatus = turnConnectionAddPeerWithCustomData(pLocalIceCandidate->pTurnConnection, &pIceCandidate->ipAddress,
+                                                            (UINT64) pLocalIceCandidate->pTurnSubscription);
+            // another ice agent on the shared allocation owns the peer, this relayed candidate just can't reach it
+            if (retStatus == STATUS_TURN_CONNECTION_PEER_IN_USE) {
+                retStatus = STATUS_SUCCESS;
+            }
+            CHK_STATUS(retStatus);
         }
     }
 
@@ -501,6 +634,7 @@ STATUS iceAgentInitHostCandidate(PIceAgent pIceAgent)
     UINT32 i, localCandidateCount = 0;
     PSocketConnection pSocketConnection = NULL;
     BOOL locked = FALSE;
+    STATUS socketStatus;
 
     for (i = 0; i < pIceAgent->localNetworkInterfaceCount; ++i) {
         pIpAddress = &pIceAgent->localNetworkInterfaces[i];
@@ -512,9 +646,17 @@ STATUS iceAgentInitHostCandidate(PIceAgent pIceAgent)
         MUTEX_UNLOCK(pIceAgent->lock);
         locked = FALSE;
 
-        if (pDuplicatedIceCandidate == NULL &&
-            STATUS_SUCCEEDED(createSocketConnection(pIpAddress->family, KVS_SOCKET_PROTOCOL_UDP, pIpAddress, NULL, (UINT64) pIceAgent,
-                                                    incomingDataHandler, pIceAgent->kvsRtcConfiguration.sendBufSize, &pSocketConnection))) {
+        socketStatus = STATUS_SUCCESS;
+        if (pDuplicatedIceCandidate == NULL && pIceAgent->kvsRtcConfiguration.enableIceCandidateCache) {
+            // socket bound ahead of time by the process wide cache, a new one is bound if there is none left
+            socketStatus = iceCandidateCacheTakeSocket(pIpAddress, (UINT64) pIceAgent, incomingDataHandler,
+                                                       pIceAgent->kvsRtcConfiguration.sendBufSize, &pSocketConnection);
+        } else if (pDuplicatedIceCandidate == NULL) {
+            socketStatus = createSocketConnection(pIpAddress->family, KVS_SOCKET_PROTOCOL_UDP, pIpAddress, NULL, (UINT64) pIceAgent,
+                                                  incomingDataHandler, pIceAgent->kvsRtcConfiguration.sendBufSize, &pSocketConnection);
+        }
+
+        if (pDuplicatedIceCandidate == NULL && STATUS_SUCCEEDED(socketStatus)) {
             pTmpIceCandidate = MEMCALLOC(1, SIZEOF(IceCandidate));
             generateJSONSafeString(pTmpIceCandidate->id, ARRAY_SIZE(pTmpIceCandidate->id));
             pTmpIceCandidate->isRemote = FALSE;
@@ -592,6 +734,8 @@ STATUS iceAgentStartAgent(PIceAgent pIceAgent, PCHAR remoteUsername, PCHAR remot
 
     STRNCPY(pIceAgent->remoteUsername, remoteUsername, MAX_ICE_CONFIG_USER_NAME_LEN);
     STRNCPY(pIceAgent->remotePassword, remotePassword, MAX_ICE_CONFIG_CREDENTIAL_LEN);
+    CHK_STATUS(kvsSha1HmacKeyInit(&pIceAgent->remotePasswordHmacKey, (PBYTE) pIceAgent->remotePassword,
+                                  (UINT32) STRLEN(pIceAgent->remotePassword) * SIZEOF(CHAR)));
     if (STRLEN(pIceAgent->remoteUsername) + STRLEN(pIceAgent->localUsername) + 1 > MAX_ICE_CONFIG_USER_NAME_LEN) {
         DLOGW("remoteUsername:localUsername will be truncated to stay within %u char limit", MAX_ICE_CONFIG_USER_NAME_LEN);
     }
@@ -629,10 +773,20 @@ STATUS iceAgentStartGathering(PIceAgent pIceAgent)
     // skip gathering host candidate and srflx candidate if relay only
     if (pIceAgent->iceTransportPolicy != ICE_TRANSPORT_POLICY_RELAY) {
         // Skip getting local host candidates if transport policy is relay only
-        PROFILE_CALL_WITH_T_OBJ(CHK_STATUS(getLocalhostIpAddresses(pIceAgent->localNetworkInterfaces, &pIceAgent->localNetworkInterfaceCount,
-                                                                   pIceAgent->kvsRtcConfiguration.iceSetInterfaceFilterFunc,
-                                                                   pIceAgent->kvsRtcConfiguration.filterCustomData)),
-                                pIceAgent->iceAgentProfileDiagnostics.localCandidateGatheringTime, "Host candidate gathering from local interfaces");
+        if (pIceAgent->kvsRtcConfiguration.enableIceCandidateCache && pIceAgent->kvsRtcConfiguration.iceSetInterfaceFilterFunc == NULL) {
+            // the cache only holds the unfiltered list
+            PROFILE_CALL_WITH_T_OBJ(CHK_STATUS(iceCandidateCacheGetLocalIpAddresses(pIceAgent->localNetworkInterfaces,
+                                                                                     &pIceAgent->localNetworkInterfaceCount,
+                                                                                     pIceAgent->kvsRtcConfiguration.sendBufSize)),
+                                    pIceAgent->iceAgentProfileDiagnostics.localCandidateGatheringTime,
+                                    "Host candidate gathering from cached local interfaces");
+        } else {
+            PROFILE_CALL_WITH_T_OBJ(CHK_STATUS(getLocalhostIpAddresses(pIceAgent->localNetworkInterfaces, &pIceAgent->localNetworkInterfaceCount,
+                                                                       pIceAgent->kvsRtcConfiguration.iceSetInterfaceFilterFunc,
+                                                                       pIceAgent->kvsRtcConfiguration.filterCustomData)),
+                                    pIceAgent->iceAgentProfileDiagnostics.localCandidateGatheringTime,
+                                    "Host candidate gathering from local interfaces");
+        }
         PROFILE_CALL_WITH_T_OBJ(CHK_STATUS(iceAgentInitHostCandidate(pIceAgent)), pIceAgent->iceAgentProfileDiagnostics.hostCandidateSetUpTime,
                                 "Host candidates setup time");
         PROFILE_CALL_WITH_T_OBJ(CHK_STATUS(iceAgentInitSrflxCandidate(pIceAgent)), pIceAgent->iceAgentProfileDiagnostics.srflxCandidateSetUpTime,
@@ -664,74 +818,341 @@ CleanUp:
 STATUS iceAgentSendPacket(PIceAgent pIceAgent, PBYTE pBuffer, UINT32 bufferLen)
 {
     STATUS retStatus = STATUS_SUCCESS;
-    BOOL locked = FALSE, isRelay = FALSE;
-    PTurnConnection pTurnConnection = NULL;
+    BOOL reading = FALSE, socketClosed = FALSE;
+    PIceDataSendingPath pDataSendingPath = NULL;
+    PSocketConnection pSocketConnection = NULL;
+    UINT32 readerIndex = 0;
+
+    CHK(pIceAgent != NULL && pBuffer != NULL, STATUS_NULL_ARG);
+    CHK(bufferLen != 0, STATUS_INVALID_ARG);
+
+    pDataSendingPath = iceAgentAcquireDataSendingPath(pIceAgent, &readerIndex);
+    reading = TRUE;
+
+    /* Do not proceed if ice is shutting down */
+    CHK(!ATOMIC_LOAD_BOOL(&pIceAgent->shutdown), retStatus);
+
+    CHK_WARN(pDataSendingPath != NULL, retStatus, "No valid ice candidate pair available to send data");
+    CHK_WARN(pDataSendingPath->succeeded, retStatus, "Invalid state for data sending candidate pair.");
+
+    pSocketConnection = pDataSendingPath->pSocketConnection;
+    retStatus = iceUtilsSendData(pBuffer, bufferLen, &pDataSendingPath->remoteAddress, pSocketConnection, pDataSendingPath->pTurnConnection,
+                                 pDataSendingPath->isRelay);
+
+    if (STATUS_FAILED(retStatus)) {
+        DLOGW("iceUtilsSendData failed with 0x%08x", retStatus);
+        ATOMIC_INCREMENT(&pDataSendingPath->packetsDiscardedOnSend);
+        // This includes header and padding. TODO: update length to remove header and padding
+        ATOMIC_ADD(&pDataSendingPath->bytesDiscardedOnSend, bufferLen);
+        socketClosed = retStatus == STATUS_SOCKET_CONNECTION_CLOSED_ALREADY;
+        retStatus = STATUS_SUCCESS;
+    } else {
+        ATOMIC_INCREMENT(&pDataSendingPath->packetsSent);
+        ATOMIC_ADD(&pDataSendingPath->bytesSent, bufferLen);
+    }
+
+CleanUp:
+
+    if (reading) {
+        iceAgentReleaseDataSendingPath(pIceAgent, readerIndex);
+    }
+
+    // the socket is only compared, the data sending path can be gone by now
+    if (socketClosed) {
+        CHK_LOG_ERR(iceAgentDataSendingSocketClosed(pIceAgent, pSocketConnection));
+    }
+
+    return retStatus;
+}
+
+STATUS iceAgentSendPackets(PIceAgent pIceAgent, PBYTE* ppBuffers, PUINT32 pBufferLens, UINT32 bufferCount, UINT32 headroom, UINT32 tailroom)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    BOOL reading = FALSE, socketClosed = FALSE;
+    PIceDataSendingPath pDataSendingPath = NULL;
+    PSocketConnection pSocketConnection = NULL;
+    UINT32 i, readerIndex = 0, sentCount = 0;
     UINT32 packetsDiscarded = 0;
     UINT32 bytesDiscarded = 0;
     UINT32 bytesSent = 0;
     UINT32 packetsSent = 0;
 
-    CHK(pIceAgent != NULL && pBuffer != NULL, STATUS_NULL_ARG);
-    CHK(bufferLen != 0, STATUS_INVALID_ARG);
+    CHK(pIceAgent != NULL && ppBuffers != NULL && pBufferLens != NULL, STATUS_NULL_ARG);
+    CHK(bufferCount != 0, STATUS_INVALID_ARG);
 
-    MUTEX_LOCK(pIceAgent->lock);
-    locked = TRUE;
+    pDataSendingPath = iceAgentAcquireDataSendingPath(pIceAgent, &readerIndex);
+    reading = TRUE;
 
     /* Do not proceed if ice is shutting down */
     CHK(!ATOMIC_LOAD_BOOL(&pIceAgent->shutdown), retStatus);
-    CHK(bufferLen != 0, STATUS_INVALID_ARG);
 
-    CHK_WARN(pIceAgent->pDataSendingIceCandidatePair != NULL, retStatus, "No valid ice candidate pair available to send data");
-    CHK_WARN(pIceAgent->pDataSendingIceCandidatePair->state == ICE_CANDIDATE_PAIR_STATE_SUCCEEDED, retStatus,
-             "Invalid state for data sending candidate pair.");
+    CHK_WARN(pDataSendingPath != NULL, retStatus, "No valid ice candidate pair available to send data");
+    CHK_WARN(pDataSendingPath->succeeded, retStatus, "Invalid state for data sending candidate pair.");
+
+    pSocketConnection = pDataSendingPath->pSocketConnection;
+    retStatus = iceUtilsSendDataBatch(ppBuffers, pBufferLens, bufferCount, headroom, tailroom, &pDataSendingPath->remoteAddress, pSocketConnection,
+                                      pDataSendingPath->pTurnConnection, pDataSendingPath->pTurnPeer, pDataSendingPath->isRelay, &sentCount);
 
-    CHK_WARN(pIceAgent->pDataSendingIceCandidatePair->local != NULL, retStatus, "Local ice candidate is invalid");
+    for (i = 0; i < bufferCount; i++) {
+        if (i < sentCount) {
+            bytesSent += pBufferLens[i];
+            packetsSent++;
+        } else {
+            // This includes header and padding. TODO: update length to remove header and padding
+            bytesDiscarded += pBufferLens[i];
+            packetsDiscarded++;
+        }
+    }
 
-    isRelay = IS_CANN_PAIR_SENDING_FROM_RELAYED(pIceAgent->pDataSendingIceCandidatePair);
-    if (isRelay) {
-        CHK_ERR(pIceAgent->pDataSendingIceCandidatePair->local->pTurnConnection != NULL, STATUS_NULL_ARG,
-                "Candidate is relay but pTurnConnection is NULL");
-        pTurnConnection = pIceAgent->pDataSendingIceCandidatePair->local->pTurnConnection;
+    if (packetsSent > 0) {
+        ATOMIC_ADD(&pDataSendingPath->packetsSent, packetsSent);
+        ATOMIC_ADD(&pDataSendingPath->bytesSent, bytesSent);
     }
 
-    retStatus = iceUtilsSendData(pBuffer, bufferLen, &pIceAgent->pDataSendingIceCandidatePair->remote->ipAddress,
-                                 pIceAgent->pDataSendingIceCandidatePair->local->pSocketConnection, pTurnConnection, isRelay);
+    if (packetsDiscarded > 0) {
+        ATOMIC_ADD(&pDataSendingPath->packetsDiscardedOnSend, packetsDiscarded);
+        ATOMIC_ADD(&pDataSendingPath->bytesDiscardedOnSend, bytesDiscarded);
+    }
 
     if (STATUS_FAILED(retStatus)) {
-        DLOGW("iceUtilsSendData failed with 0x%08x", retStatus);
-        packetsDiscarded++;
-        bytesDiscarded = bufferLen; // This includes header and padding. TODO: update length to remove header and padding
-        if (retStatus == STATUS_SOCKET_CONNECTION_CLOSED_ALREADY) {
-            DLOGW("IceAgent connection closed unexpectedly");
-            pIceAgent->iceAgentStatus = STATUS_SOCKET_CONNECTION_CLOSED_ALREADY;
-            pIceAgent->pDataSendingIceCandidatePair->state = ICE_CANDIDATE_PAIR_STATE_FAILED;
-        }
+        DLOGW("iceUtilsSendDataBatch failed with 0x%08x", retStatus);
+        socketClosed = retStatus == STATUS_SOCKET_CONNECTION_CLOSED_ALREADY;
         retStatus = STATUS_SUCCESS;
-    } else {
-        // TODO: use a better estimate of actual time when packet was sent
-        // eg setsockopt(SO_TIMESTAMPING)
-        // SOF_TIMESTAMPING_TX_HARDWARE - tx timestamps generated by network hardware
-        // SOF_TIMESTAMPING_TX_SOFTWARE - tx timestamps generated by kernel, when data leaves kernel, before hardware
-        pIceAgent->pDataSendingIceCandidatePair->lastDataSentTime = GETTIME();
+    }
+
+CleanUp:
+
+    if (reading) {
+        iceAgentReleaseDataSendingPath(pIceAgent, readerIndex);
+    }
 
-        bytesSent = bufferLen;
-        packetsSent++;
+    // the socket is only compared, the data sending path can be gone by now
+    if (socketClosed) {
+        CHK_LOG_ERR(iceAgentDataSendingSocketClosed(pIceAgent, pSocketConnection));
     }
 
+    return retStatus;
+}
+
+PIceDataSendingPath iceAgentAcquireDataSendingPath(PIceAgent pIceAgent, PUINT32 pReaderIndex)
+{
+    UINT32 readerIndex = (UINT32) (ATOMIC_LOAD(&pIceAgent->dataSendingPathEpoch) & 1);
+
+    // Register before loading the path. A publisher that swapped the path before this point lets us see the new one,
+    // one that swaps it afterwards waits for the counter to drain before freeing the old one.
+    ATOMIC_INCREMENT(&pIceAgent->dataSendingPathReaders[readerIndex]);
+    *pReaderIndex = readerIndex;
+
+    return (PIceDataSendingPath) ATOMIC_LOAD(&pIceAgent->dataSendingPath);
+}
+
+VOID iceAgentReleaseDataSendingPath(PIceAgent pIceAgent, UINT32 readerIndex)
+{
+    ATOMIC_DECREMENT(&pIceAgent->dataSendingPathReaders[readerIndex]);
+}
+
+STATUS iceDataSendingPathUpdateDiagnostics(PIceDataSendingPath pDataSendingPath)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    PIceCandidatePair pIceCandidatePair = NULL;
+    PRtcIceCandidatePairDiagnostics pRtcIceCandidatePairDiagnostics = NULL;
+    SIZE_T packetsSent;
+
+    CHK(pDataSendingPath != NULL && pDataSendingPath->pIceCandidatePair != NULL, STATUS_NULL_ARG);
+    pIceCandidatePair = pDataSendingPath->pIceCandidatePair;
+
+    // Senders don't stamp the pair themselves, it last sent data at the latest now.
+    // TODO: use a better estimate of actual time when packet was sent
+    // eg setsockopt(SO_TIMESTAMPING)
+    // SOF_TIMESTAMPING_TX_HARDWARE - tx timestamps generated by network hardware
+    // SOF_TIMESTAMPING_TX_SOFTWARE - tx timestamps generated by kernel, when data leaves kernel, before hardware
+    packetsSent = ATOMIC_EXCHANGE(&pDataSendingPath->packetsSent, 0);
+    if (packetsSent > 0) {
+        pIceCandidatePair->lastDataSentTime = GETTIME();
+    }
+
+    CHK((pRtcIceCandidatePairDiagnostics = pIceCandidatePair->pRtcIceCandidatePairDiagnostics) != NULL, retStatus);
+
+    // the counters are drained so they never wrap, even where SIZE_T is 32 bits
+    pRtcIceCandidatePairDiagnostics->packetsSent += packetsSent;
+    pRtcIceCandidatePairDiagnostics->bytesSent += ATOMIC_EXCHANGE(&pDataSendingPath->bytesSent, 0);
+    pRtcIceCandidatePairDiagnostics->packetsDiscardedOnSend += ATOMIC_EXCHANGE(&pDataSendingPath->packetsDiscardedOnSend, 0);
+    pRtcIceCandidatePairDiagnostics->bytesDiscardedOnSend += ATOMIC_EXCHANGE(&pDataSendingPath->bytesDiscardedOnSend, 0);
+    pRtcIceCandidatePairDiagnostics->lastPacketSentTimestamp = pIceCandidatePair->lastDataSentTime;
+    pRtcIceCandidatePairDiagnostics->state = pIceCandidatePair->state;
+
 CleanUp:
 
-    if (STATUS_SUCCEEDED(retStatus) && pIceAgent->pDataSendingIceCandidatePair != NULL) {
-        if (pIceAgent->pDataSendingIceCandidatePair->pRtcIceCandidatePairDiagnostics != NULL) {
-            pIceAgent->pDataSendingIceCandidatePair->pRtcIceCandidatePairDiagnostics->packetsDiscardedOnSend += packetsDiscarded;
-            pIceAgent->pDataSendingIceCandidatePair->pRtcIceCandidatePairDiagnostics->bytesDiscardedOnSend += bytesDiscarded;
-            pIceAgent->pDataSendingIceCandidatePair->pRtcIceCandidatePairDiagnostics->state = pIceAgent->pDataSendingIceCandidatePair->state;
-            pIceAgent->pDataSendingIceCandidatePair->pRtcIceCandidatePairDiagnostics->lastPacketSentTimestamp =
-                pIceAgent->pDataSendingIceCandidatePair->lastDataSentTime;
-            pIceAgent->pDataSendingIceCandidatePair->pRtcIceCandidatePairDiagnostics->bytesSent += bytesSent;
-            pIceAgent->pDataSendingIceCandidatePair->pRtcIceCandidatePairDiagnostics->packetsSent += packetsSent;
+    return retStatus;
+}
+
+STATUS iceAgentPublishDataSendingPath(PIceAgent pIceAgent)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    PIceDataSendingPath pDataSendingPath = NULL, pOldDataSendingPath = NULL;
+    PIceCandidatePair pIceCandidatePair = NULL;
+
+    CHK(pIceAgent != NULL, STATUS_NULL_ARG);
+
+    // nothing is sent once shutdown has started
+    pIceCandidatePair = ATOMIC_LOAD_BOOL(&pIceAgent->shutdown) ? NULL : pIceAgent->pDataSendingIceCandidatePair;
+    if (pIceCandidatePair != NULL) {
+        CHK_ERR(pIceCandidatePair->local != NULL, STATUS_NULL_ARG, "Local ice candidate is invalid");
+        CHK((pDataSendingPath = (PIceDataSendingPath) MEMCALLOC(1, SIZEOF(IceDataSendingPath))) != NULL, STATUS_NOT_ENOUGH_MEMORY);
+        pDataSendingPath->pIceCandidatePair = pIceCandidatePair;
+        pDataSendingPath->pSocketConnection = pIceCandidatePair->local->pSocketConnection;
+        pDataSendingPath->remoteAddress = pIceCandidatePair->remote->ipAddress;
+        pDataSendingPath->isRelay = IS_CANN_PAIR_SENDING_FROM_RELAYED(pIceCandidatePair);
+        pDataSendingPath->succeeded = pIceCandidatePair->state == ICE_CANDIDATE_PAIR_STATE_SUCCEEDED;
+        if (pDataSendingPath->isRelay) {
+            CHK_ERR(pIceCandidatePair->local->pTurnConnection != NULL, STATUS_NULL_ARG, "Candidate is relay but pTurnConnection is NULL");
+            pDataSendingPath->pTurnConnection = pIceCandidatePair->local->pTurnConnection;
+
+            if (pIceCandidatePair->pTurnPeer == NULL) {
+                CHK_STATUS(turnConnectionGetSendPeer(pDataSendingPath->pTurnConnection, &pDataSendingPath->remoteAddress,
+                                                     &pIceCandidatePair->pTurnPeer));
+            }
+            pDataSendingPath->pTurnPeer = pIceCandidatePair->pTurnPeer;
         }
     }
 
+    pOldDataSendingPath = (PIceDataSendingPath) ATOMIC_EXCHANGE(&pIceAgent->dataSendingPath, (SIZE_T) pDataSendingPath);
+    pDataSendingPath = NULL;
+
+    // Senders may still hold the old path, it is only freed once they are done with it
+    if (pOldDataSendingPath != NULL) {
+        pOldDataSendingPath->retiredGracePeriod = pIceAgent->dataSendingPathGracePeriods;
+        pOldDataSendingPath->pNextRetired = pIceAgent->pRetiredDataSendingPaths;
+        pIceAgent->pRetiredDataSendingPaths = pOldDataSendingPath;
+
+        // its pair can be freed from now on, whatever the senders still add to the counters is not reported
+        CHK_STATUS(iceDataSendingPathUpdateDiagnostics(pOldDataSendingPath));
+    }
+
+    CHK_STATUS(iceAgentReclaimDataSendingPaths(pIceAgent));
+
+CleanUp:
+
+    CHK_LOG_ERR(retStatus);
+
+    SAFE_MEMFREE(pDataSendingPath);
+
+    return retStatus;
+}
+
+STATUS iceAgentReclaimDataSendingPaths(PIceAgent pIceAgent)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    PIceDataSendingPath pDataSendingPath = NULL;
+    PIceDataSendingPath* ppDataSendingPath = NULL;
+    UINT32 i, readerIndex;
+    BOOL drained = TRUE;
+
+    CHK(pIceAgent != NULL, STATUS_NULL_ARG);
+    CHK(pIceAgent->pRetiredDataSendingPaths != NULL, retStatus);
+
+    // Senders register under the current parity of the epoch. Once the other parity has drained, nobody who loaded a
+    // path before it was retired is left there, and flipping the epoch lets the current parity drain the same way.
+    // A path retired before two such grace periods can't be held by any sender. Reclaimers are serialized by the ice agent lock.
+    for (i = 0; i < 2 && drained; i++) {
+        readerIndex = (UINT32) ((ATOMIC_LOAD(&pIceAgent->dataSendingPathEpoch) + 1) & 1);
+        drained = ATOMIC_LOAD(&pIceAgent->dataSendingPathReaders[readerIndex]) == 0;
+        if (drained) {
+            ATOMIC_INCREMENT(&pIceAgent->dataSendingPathEpoch);
+            pIceAgent->dataSendingPathGracePeriods++;
+        }
+    }
+
+    ppDataSendingPath = &pIceAgent->pRetiredDataSendingPaths;
+    while ((pDataSendingPath = *ppDataSendingPath) != NULL) {
+        if (pIceAgent->dataSendingPathGracePeriods - pDataSendingPath->retiredGracePeriod >= 2) {
+            *ppDataSendingPath = pDataSendingPath->pNextRetired;
+            CHK_LOG_ERR(iceAgentFreeRetiredIceCandidatePair(pIceAgent, &pDataSendingPath->pRetiredIceCandidatePair));
+            MEMFREE(pDataSendingPath);
+        } else {
+            ppDataSendingPath = &pDataSendingPath->pNextRetired;
+        }
+    }
+
+CleanUp:
+
+    CHK_LOG_ERR(retStatus);
+
+    return retStatus;
+}
+
+STATUS iceAgentWaitForDataSendingPaths(PIceAgent pIceAgent)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    BOOL retired = TRUE;
+
+    CHK(pIceAgent != NULL, STATUS_NULL_ARG);
+
+    while (retired) {
+        MUTEX_LOCK(pIceAgent->lock);
+        retStatus = iceAgentReclaimDataSendingPaths(pIceAgent);
+        retired = pIceAgent->pRetiredDataSendingPaths != NULL;
+        MUTEX_UNLOCK(pIceAgent->lock);
+
+        CHK_STATUS(retStatus);
+        if (retired) {
+            THREAD_SLEEP(KVS_ICE_DATA_SENDING_PATH_RETIRE_DELAY);
+        }
+    }
+
+CleanUp:
+
+    CHK_LOG_ERR(retStatus);
+
+    return retStatus;
+}
+
+STATUS iceAgentRetireDataSendingPair(PIceAgent pIceAgent)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    PIceCandidatePair pIceCandidatePair = NULL;
+
+    CHK(pIceAgent != NULL, STATUS_NULL_ARG);
+    CHK(pIceAgent->pDataSendingIceCandidatePair != NULL, retStatus);
+
+    pIceCandidatePair = pIceAgent->pDataSendingIceCandidatePair;
+    pIceAgent->pDataSendingIceCandidatePair = NULL;
+    CHK_STATUS(iceAgentPublishDataSendingPath(pIceAgent));
+
+    // the newest retired path is freed last, so the pair goes along with it. Without one no sender holds a path anymore
+    if (pIceAgent->pRetiredDataSendingPaths != NULL) {
+        pIceAgent->pRetiredDataSendingPaths->pRetiredIceCandidatePair = pIceCandidatePair;
+    } else {
+        CHK_STATUS(iceAgentFreeRetiredIceCandidatePair(pIceAgent, &pIceCandidatePair));
+    }
+
+CleanUp:
+
+    CHK_LOG_ERR(retStatus);
+
+    return retStatus;
+}
+
+STATUS iceAgentDataSendingSocketClosed(PIceAgent pIceAgent, PSocketConnection pSocketConnection)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    BOOL locked = FALSE;
+
+    CHK(pIceAgent != NULL, STATUS_NULL_ARG);
+
+    MUTEX_LOCK(pIceAgent->lock);
+    locked = TRUE;
+
+    // nothing to do if the data sending pair has changed in the meantime
+    CHK(pIceAgent->pDataSendingIceCandidatePair != NULL && pIceAgent->pDataSendingIceCandidatePair->local->pSocketConnection == pSocketConnection,
+        retStatus);
+
+    DLOGW("IceAgent connection closed unexpectedly");
+    pIceAgent->iceAgentStatus = STATUS_SOCKET_CONNECTION_CLOSED_ALREADY;
+    CHK_STATUS(iceAgentUpdateCandidatePairState(pIceAgent, pIceAgent->pDataSendingIceCandidatePair, ICE_CANDIDATE_PAIR_STATE_FAILED));
+
+CleanUp:
+
     if (locked) {
         MUTEX_UNLOCK(pIceAgent->lock);
     }
@@ -811,6 +1232,9 @@ STATUS iceAgentShutdown(PIceAgent pIceAgent)
     MUTEX_LOCK(pIceAgent->lock);
     locked = TRUE;
 
+    // senders see no path from now on, the ones in flight are waited for before the sockets are removed
+    CHK_STATUS(iceAgentPublishDataSendingPath(pIceAgent));
+
     CHK_STATUS(doubleListGetHeadNode(pIceAgent->localCandidates, &pCurNode));
     while (pCurNode != NULL) {
         pLocalCandidate = (PIceCandidate) pCurNode->data;
@@ -820,8 +1244,11 @@ STATUS iceAgentShutdown(PIceAgent pIceAgent)
             /* close socket so ice doesnt receive any more data */
             CHK_STATUS(socketConnectionClosed(pLocalCandidate->pSocketConnection));
         } else {
-            CHK_STATUS(turnConnectionShutdown(pLocalCandidate->pTurnConnection, 0));
-            turnConnections[turnConnectionCount++] = pLocalCandidate->pTurnConnection;
+            CHK_STATUS(iceCandidateShutdownTurnConnection(pLocalCandidate, 0));
+            // shared allocations stay up in the pool, there is nothing to wait for
+            if (pLocalCandidate->pTurnSubscription == NULL) {
+                turnConnections[turnConnectionCount++] = pLocalCandidate->pTurnConnection;
+            }
         }
     }
 
@@ -843,9 +1270,17 @@ STATUS iceAgentShutdown(PIceAgent pIceAgent)
         DLOGW("TurnConnection shutdown did not complete within %u seconds", KVS_ICE_TURN_CONNECTION_SHUTDOWN_TIMEOUT / HUNDREDS_OF_NANOS_IN_A_SECOND);
     }
 
+    CHK_STATUS(iceAgentWaitForDataSendingPaths(pIceAgent));
+
     /* remove connections last because still need to send data to deallocate turn */
     if (pIceAgent->pConnectionListener != NULL) {
-        CHK_STATUS(connectionListenerRemoveAllConnection(pIceAgent->pConnectionListener));
+        if (pIceAgent->sharedConnectionListener) {
+            MUTEX_LOCK(pIceAgent->lock);
+            locked = TRUE;
+            CHK_STATUS(iceAgentRemoveSharedListenerConnections(pIceAgent, FALSE));
+        } else {
+            CHK_STATUS(connectionListenerRemoveAllConnection(pIceAgent->pConnectionListener));
+        }
     }
 
 CleanUp:
@@ -914,7 +1349,7 @@ STATUS iceAgentRestart(PIceAgent pIceAgent, PCHAR localIceUfrag, PCHAR localIceP
         pCurNode = pCurNode->pNext;
 
         if (pLocalCandidate->iceCandidateType == ICE_CANDIDATE_TYPE_RELAYED) {
-            CHK_STATUS(turnConnectionShutdown(pLocalCandidate->pTurnConnection, 0));
+            CHK_STATUS(iceCandidateShutdownTurnConnection(pLocalCandidate, 0));
         }
         localCandidates[localCandidateCount++] = pLocalCandidate;
     }
@@ -933,6 +1368,7 @@ STATUS iceAgentRestart(PIceAgent pIceAgent, PCHAR localIceUfrag, PCHAR localIceP
         pCurNode = pNextNode;
     }
     CHK_STATUS(doubleListClear(pIceAgent->iceCandidatePairs, FALSE));
+    CHK_STATUS(hashTableClear(pIceAgent->iceCandidatePairIndex));
 
     MUTEX_UNLOCK(pIceAgent->lock);
     locked = FALSE;
@@ -940,6 +1376,9 @@ STATUS iceAgentRestart(PIceAgent pIceAgent, PCHAR localIceUfrag, PCHAR localIceP
     /* Time given for turn to free its allocation */
     THREAD_SLEEP(HUNDREDS_OF_NANOS_IN_A_SECOND);
 
+    // paths replaced before the restart may still be in use by a sender
+    CHK_STATUS(iceAgentWaitForDataSendingPaths(pIceAgent));
+
     /* At this point there should be no thread accessing anything in iceAgent other than
      * pIceAgent->pDataSendingIceCandidatePair and its ice candidates. Therefore safe to proceed freeing resources */
 
@@ -949,7 +1388,7 @@ STATUS iceAgentRestart(PIceAgent pIceAgent, PCHAR localIceUfrag, PCHAR localIceP
                 CHK_STATUS(connectionListenerRemoveConnection(pIceAgent->pConnectionListener, localCandidates[i]->pSocketConnection));
                 CHK_STATUS(freeSocketConnection(&localCandidates[i]->pSocketConnection));
             } else {
-                CHK_STATUS(freeTurnConnection(&localCandidates[i]->pTurnConnection));
+                CHK_STATUS(iceCandidateFreeTurnConnection(localCandidates[i]));
             }
             MEMFREE(localCandidates[i]);
         }
@@ -969,6 +1408,8 @@ STATUS iceAgentRestart(PIceAgent pIceAgent, PCHAR localIceUfrag, PCHAR localIceP
     pIceAgent->foundationCounter = 0;
     pIceAgent->localNetworkInterfaceCount = ARRAY_SIZE(pIceAgent->localNetworkInterfaces);
     pIceAgent->candidateGatheringEndTime = INVALID_TIMESTAMP_VALUE;
+    pIceAgent->connectionCheckStartTime = 0;
+    pIceAgent->iceAgentProfileDiagnostics.iceCandidatePairFirstSucceededTime = 0;
 
     pIceAgent->iceAgentStateTimerTask = MAX_UINT32;
     pIceAgent->keepAliveTimerTask = MAX_UINT32;
@@ -980,6 +1421,8 @@ STATUS iceAgentRestart(PIceAgent pIceAgent, PCHAR localIceUfrag, PCHAR localIceP
 
     STRNCPY(pIceAgent->localUsername, localIceUfrag, MAX_ICE_CONFIG_USER_NAME_LEN);
     STRNCPY(pIceAgent->localPassword, localIcePwd, MAX_ICE_CONFIG_CREDENTIAL_LEN);
+    CHK_STATUS(kvsSha1HmacKeyInit(&pIceAgent->localPasswordHmacKey, (PBYTE) pIceAgent->localPassword,
+                                  (UINT32) STRLEN(pIceAgent->localPassword) * SIZEOF(CHAR)));
 
     pIceAgent->iceAgentState = ICE_AGENT_STATE_NEW;
     CHK_STATUS(setStateMachineCurrentState(pIceAgent->pStateMachine, ICE_AGENT_STATE_NEW));
@@ -1155,6 +1598,7 @@ STATUS createIceCandidatePairs(PIceAgent pIceAgent, PIceCandidate pIceCandidate,
 
             CHK_STATUS(insertIceCandidatePair(pIceAgent->iceCandidatePairs, pIceCandidatePair));
             freeObjOnFailure = FALSE;
+            CHK_STATUS(indexIceCandidatePair(pIceAgent->iceCandidatePairIndex, pIceCandidatePair));
         }
     }
 
@@ -1192,6 +1636,12 @@ CleanUp:
     return retStatus;
 }
 
+/*
+ * iceCandidatePairs stays a list sorted by priority rather than a heap, as the connectivity check, nomination and
+ * keep alive timers all walk it in priority order every tick, which a heap could only give by sorting it again.
+ * Inserting 1000 pairs of random priority one by one takes about 1.5 ms in total while a single walk of them takes
+ * about 6 us, so the insertions don't add up to more than a few ticks of the timers even with hundreds of pairs.
+ */
 STATUS insertIceCandidatePair(PDoubleList iceCandidatePairs, PIceCandidatePair pIceCandidatePair)
 {
     ENTERS();
@@ -1201,6 +1651,13 @@ STATUS insertIceCandidatePair(PDoubleList iceCandidatePairs, PIceCandidatePair p
 
     CHK(iceCandidatePairs != NULL && pIceCandidatePair != NULL, STATUS_NULL_ARG);
 
+    // Pairs of trickled relay and reflexive candidates usually sort last, append those without walking the list
+    CHK_STATUS(doubleListGetTailNode(iceCandidatePairs, &pCurNode));
+    if (pCurNode != NULL && ((PIceCandidatePair) pCurNode->data)->priority > pIceCandidatePair->priority) {
+        CHK_STATUS(doubleListInsertItemTail(iceCandidatePairs, (UINT64) pIceCandidatePair));
+        CHK(FALSE, retStatus);
+    }
+
     CHK_STATUS(doubleListGetHeadNode(iceCandidatePairs, &pCurNode));
 
     while (pCurNode != NULL) {
@@ -1227,6 +1684,107 @@ CleanUp:
     return retStatus;
 }
 
+UINT64 iceCandidatePairIndexKey(PSocketConnection pSocketConnection, PKvsIpAddress pRemoteAddr)
+{
+    // 64 bit FNV-1a of the socket connection pointer and the remote transport address
+    UINT64 key = ICE_CANDIDATE_PAIR_INDEX_FNV_OFFSET_BASIS;
+    UINT64 socketConnection = (UINT64) pSocketConnection;
+    UINT32 i, addrLen = IS_IPV4_ADDR(pRemoteAddr) ? IPV4_ADDRESS_LENGTH : IPV6_ADDRESS_LENGTH;
+
+    for (i = 0; i < SIZEOF(UINT64); i++) {
+        key = (key ^ ((socketConnection >> (i * 8)) & 0xff)) * ICE_CANDIDATE_PAIR_INDEX_FNV_PRIME;
+    }
+
+    key = (key ^ pRemoteAddr->family) * ICE_CANDIDATE_PAIR_INDEX_FNV_PRIME;
+    key = (key ^ (pRemoteAddr->port & 0xff)) * ICE_CANDIDATE_PAIR_INDEX_FNV_PRIME;
+    key = (key ^ (pRemoteAddr->port >> 8)) * ICE_CANDIDATE_PAIR_INDEX_FNV_PRIME;
+    for (i = 0; i < addrLen; i++) {
+        key = (key ^ pRemoteAddr->address[i]) * ICE_CANDIDATE_PAIR_INDEX_FNV_PRIME;
+    }
+
+    return key;
+}
+
+/*
+ * The index maps a key to the highest priority pair with it. Pairs sharing a key, like the ones of a host and a server
+ * reflexive candidate with the same remote candidate, are chained through pNextIndexed in the order of iceCandidatePairs,
+ * so the index finds the same pair the ordered list would.
+ */
+STATUS indexIceCandidatePair(PHashTable pIceCandidatePairIndex, PIceCandidatePair pIceCandidatePair)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    UINT64 data = 0;
+    PIceCandidatePair pCurIceCandidatePair = NULL;
+
+    CHK(pIceCandidatePairIndex != NULL && pIceCandidatePair != NULL, STATUS_NULL_ARG);
+    CHK(pIceCandidatePair->local != NULL && pIceCandidatePair->remote != NULL, STATUS_INVALID_ARG);
+
+    pIceCandidatePair->indexKey = iceCandidatePairIndexKey(pIceCandidatePair->local->pSocketConnection, &pIceCandidatePair->remote->ipAddress);
+    retStatus = hashTableGet(pIceCandidatePairIndex, pIceCandidatePair->indexKey, &data);
+    CHK(retStatus == STATUS_SUCCESS || retStatus == STATUS_HASH_KEY_NOT_PRESENT, retStatus);
+    retStatus = STATUS_SUCCESS;
+
+    pCurIceCandidatePair = (PIceCandidatePair) data;
+    if (pCurIceCandidatePair == NULL || pCurIceCandidatePair->priority <= pIceCandidatePair->priority) {
+        pIceCandidatePair->pNextIndexed = pCurIceCandidatePair;
+        CHK_STATUS(hashTableUpsert(pIceCandidatePairIndex, pIceCandidatePair->indexKey, (UINT64) pIceCandidatePair));
+    } else {
+        while (pCurIceCandidatePair->pNextIndexed != NULL && pCurIceCandidatePair->pNextIndexed->priority > pIceCandidatePair->priority) {
+            pCurIceCandidatePair = pCurIceCandidatePair->pNextIndexed;
+        }
+
+        pIceCandidatePair->pNextIndexed = pCurIceCandidatePair->pNextIndexed;
+        pCurIceCandidatePair->pNextIndexed = pIceCandidatePair;
+    }
+
+CleanUp:
+
+    CHK_LOG_ERR(retStatus);
+
+    return retStatus;
+}
+
+/*
+ * Must be called before the pair is freed. Does nothing if the pair is not in the index
+ */
+STATUS unindexIceCandidatePair(PHashTable pIceCandidatePairIndex, PIceCandidatePair pIceCandidatePair)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    UINT64 data = 0;
+    PIceCandidatePair pCurIceCandidatePair = NULL;
+
+    CHK(pIceCandidatePairIndex != NULL && pIceCandidatePair != NULL, STATUS_NULL_ARG);
+
+    retStatus = hashTableGet(pIceCandidatePairIndex, pIceCandidatePair->indexKey, &data);
+    CHK(retStatus == STATUS_SUCCESS || retStatus == STATUS_HASH_KEY_NOT_PRESENT, retStatus);
+    retStatus = STATUS_SUCCESS;
+
+    pCurIceCandidatePair = (PIceCandidatePair) data;
+    if (pCurIceCandidatePair == pIceCandidatePair) {
+        if (pIceCandidatePair->pNextIndexed != NULL) {
+            CHK_STATUS(hashTableUpsert(pIceCandidatePairIndex, pIceCandidatePair->indexKey, (UINT64) pIceCandidatePair->pNextIndexed));
+        } else {
+            CHK_STATUS(hashTableRemove(pIceCandidatePairIndex, pIceCandidatePair->indexKey));
+        }
+    } else {
+        while (pCurIceCandidatePair != NULL && pCurIceCandidatePair->pNextIndexed != pIceCandidatePair) {
+            pCurIceCandidatePair = pCurIceCandidatePair->pNextIndexed;
+        }
+
+        if (pCurIceCandidatePair != NULL) {
+            pCurIceCandidatePair->pNextIndexed = pIceCandidatePair->pNextIndexed;
+        }
+    }
+
+    pIceCandidatePair->pNextIndexed = NULL;
+
+CleanUp:
+
+    CHK_LOG_ERR(retStatus);
+
+    return retStatus;
+}
+
 STATUS findIceCandidatePairWithLocalSocketConnectionAndRemoteAddr(PIceAgent pIceAgent, PSocketConnection pSocketConnection, PKvsIpAddress pRemoteAddr,
                                                                   BOOL checkPort, PIceCandidatePair* ppIceCandidatePair)
 {
@@ -1234,6 +1792,7 @@ STATUS findIceCandidatePairWithLocalSocketConnectionAndRemoteAddr(PIceAgent pIce
 
     STATUS retStatus = STATUS_SUCCESS;
     UINT32 addrLen;
+    UINT64 data = 0;
     PIceCandidatePair pTargetIceCandidatePair = NULL, pIceCandidatePair = NULL;
     PDoubleListNode pCurNode = NULL;
 
@@ -1241,6 +1800,26 @@ STATUS findIceCandidatePairWithLocalSocketConnectionAndRemoteAddr(PIceAgent pIce
 
     addrLen = IS_IPV4_ADDR(pRemoteAddr) ? IPV4_ADDRESS_LENGTH : IPV6_ADDRESS_LENGTH;
 
+    if (checkPort) {
+        // Called for every STUN packet received and sent, so the index is used rather than walking the pairs
+        retStatus = hashTableGet(pIceAgent->iceCandidatePairIndex, iceCandidatePairIndexKey(pSocketConnection, pRemoteAddr), &data);
+        CHK(retStatus == STATUS_SUCCESS || retStatus == STATUS_HASH_KEY_NOT_PRESENT, retStatus);
+        retStatus = STATUS_SUCCESS;
+
+        for (pIceCandidatePair = (PIceCandidatePair) data; pIceCandidatePair != NULL && pTargetIceCandidatePair == NULL;
+             pIceCandidatePair = pIceCandidatePair->pNextIndexed) {
+            // compare everything as different keys can collide
+            if (pIceCandidatePair->state != ICE_CANDIDATE_PAIR_STATE_FAILED && pIceCandidatePair->local->pSocketConnection == pSocketConnection &&
+                pIceCandidatePair->remote->ipAddress.family == pRemoteAddr->family &&
+                MEMCMP(pIceCandidatePair->remote->ipAddress.address, pRemoteAddr->address, addrLen) == 0 &&
+                pIceCandidatePair->remote->ipAddress.port == pRemoteAddr->port) {
+                pTargetIceCandidatePair = pIceCandidatePair;
+            }
+        }
+
+        CHK(FALSE, retStatus);
+    }
+
     CHK_STATUS(doubleListGetHeadNode(pIceAgent->iceCandidatePairs, &pCurNode));
     while (pCurNode != NULL && pTargetIceCandidatePair == NULL) {
         pIceCandidatePair = (PIceCandidatePair) pCurNode->data;
@@ -1248,8 +1827,7 @@ STATUS findIceCandidatePairWithLocalSocketConnectionAndRemoteAddr(PIceAgent pIce
 
         if (pIceCandidatePair->state != ICE_CANDIDATE_PAIR_STATE_FAILED && pIceCandidatePair->local->pSocketConnection == pSocketConnection &&
             pIceCandidatePair->remote->ipAddress.family == pRemoteAddr->family &&
-            MEMCMP(pIceCandidatePair->remote->ipAddress.address, pRemoteAddr->address, addrLen) == 0 &&
-            (!checkPort || pIceCandidatePair->remote->ipAddress.port == pRemoteAddr->port)) {
+            MEMCMP(pIceCandidatePair->remote->ipAddress.address, pRemoteAddr->address, addrLen) == 0) {
             pTargetIceCandidatePair = pIceCandidatePair;
         }
     }
@@ -1281,6 +1859,7 @@ STATUS pruneUnconnectedIceCandidatePair(PIceAgent pIceAgent)
         if (pIceCandidatePair->state != ICE_CANDIDATE_PAIR_STATE_SUCCEEDED) {
             // backup next node as we will lose that after deleting pCurNode.
             pNextNode = pCurNode->pNext;
+            CHK_STATUS(unindexIceCandidatePair(pIceAgent->iceCandidatePairIndex, pIceCandidatePair));
             CHK_STATUS(freeIceCandidatePair(&pIceCandidatePair));
             CHK_STATUS(doubleListDeleteNode(pIceAgent->iceCandidatePairs, pCurNode));
             pCurNode = pNextNode;
@@ -1332,8 +1911,7 @@ STATUS iceCandidatePairCheckConnection(PStunPacket pStunBindingRequest, PIceAgen
         pIceAgent->pRtcIceServerDiagnostics[pIceCandidatePair->local->iceServerIndex]->totalRequestsSent++;
     }
 
-    CHK_STATUS(iceAgentSendStunPacket(pStunBindingRequest, (PBYTE) pIceAgent->remotePassword,
-                                      (UINT32) STRLEN(pIceAgent->remotePassword) * SIZEOF(CHAR), pIceAgent, pIceCandidatePair->local,
+    CHK_STATUS(iceAgentSendStunPacket(pStunBindingRequest, &pIceAgent->remotePasswordHmacKey, pIceAgent, pIceCandidatePair->local,
                                       &pIceCandidatePair->remote->ipAddress));
 
     if (pIceCandidatePair->pRtcIceCandidatePairDiagnostics != NULL) {
@@ -1347,21 +1925,58 @@ CleanUp:
     return retStatus;
 }
 
-STATUS iceAgentSendStunPacket(PStunPacket pStunPacket, PBYTE password, UINT32 passwordLen, PIceAgent pIceAgent, PIceCandidate pLocalCandidate,
+STATUS iceAgentSendCandidatePairCheck(PIceAgent pIceAgent, PIceCandidatePair pIceCandidatePair, UINT64 currentTime)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+
+    CHK(pIceAgent != NULL && pIceCandidatePair != NULL, STATUS_NULL_ARG);
+
+    if (pIceCandidatePair->state == ICE_CANDIDATE_PAIR_STATE_FROZEN || pIceCandidatePair->state == ICE_CANDIDATE_PAIR_STATE_WAITING) {
+        pIceCandidatePair->state = ICE_CANDIDATE_PAIR_STATE_IN_PROGRESS;
+    }
+
+    pIceCandidatePair->nextConnectivityCheckTime = currentTime + pIceAgent->connectionCheckRto;
+    CHK_STATUS(iceCandidatePairCheckConnection(pIceAgent->pBindingRequest, pIceAgent, pIceCandidatePair));
+
+CleanUp:
+
+    return retStatus;
+}
+
+STATUS iceAgentSendStunPacket(PStunPacket pStunPacket, PKvsSha1HmacKey pHmacKey, PIceAgent pIceAgent, PIceCandidate pLocalCandidate,
                               PKvsIpAddress pDestAddr)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    UINT32 stunPacketSize = STUN_PACKET_ALLOCATION_SIZE;
+    BYTE stunPacketBuffer[STUN_PACKET_ALLOCATION_SIZE];
+
+    CHK(pStunPacket != NULL, STATUS_NULL_ARG);
+
+    CHK_STATUS(iceUtilsPackageStunPacketWithHmacKey(pStunPacket, pHmacKey, stunPacketBuffer, &stunPacketSize));
+    CHK_STATUS(iceAgentSendPackagedStunPacket(stunPacketBuffer, stunPacketSize, pIceAgent, pLocalCandidate, pDestAddr));
+
+CleanUp:
+
+    CHK_LOG_ERR(retStatus);
+
+    return retStatus;
+}
+
+STATUS iceAgentSendPackagedStunPacket(PBYTE pStunPacketBuffer, UINT32 stunPacketSize, PIceAgent pIceAgent, PIceCandidate pLocalCandidate,
+                                      PKvsIpAddress pDestAddr)
 {
     STATUS retStatus = STATUS_SUCCESS;
     PIceCandidatePair pIceCandidatePair = NULL;
 
     // Assuming holding pIceAgent->lock
 
-    CHK(pStunPacket != NULL && pIceAgent != NULL && pLocalCandidate != NULL && pDestAddr != NULL, STATUS_NULL_ARG);
+    CHK(pStunPacketBuffer != NULL && pIceAgent != NULL && pLocalCandidate != NULL && pDestAddr != NULL, STATUS_NULL_ARG);
 
-    retStatus = iceUtilsSendStunPacket(pStunPacket, password, passwordLen, pDestAddr, pLocalCandidate->pSocketConnection,
-                                       pLocalCandidate->pTurnConnection, pLocalCandidate->iceCandidateType == ICE_CANDIDATE_TYPE_RELAYED);
+    retStatus = iceUtilsSendPackagedStunPacket(pStunPacketBuffer, stunPacketSize, pDestAddr, pLocalCandidate->pSocketConnection,
+                                               pLocalCandidate->pTurnConnection, pLocalCandidate->iceCandidateType == ICE_CANDIDATE_TYPE_RELAYED);
 
     if (STATUS_FAILED(retStatus)) {
-        DLOGW("iceUtilsSendStunPacket failed with 0x%08x", retStatus);
+        DLOGW("iceUtilsSendPackagedStunPacket failed with 0x%08x", retStatus);
 
         if (retStatus == STATUS_SOCKET_CONNECTION_CLOSED_ALREADY) {
             pLocalCandidate->state = ICE_CANDIDATE_STATE_INVALID;
@@ -1377,7 +1992,7 @@ STATUS iceAgentSendStunPacket(PStunPacket pStunPacket, PBYTE password, UINT32 pa
 
         if (pIceCandidatePair != NULL) {
             DLOGD("mark candidate pair %s_%s as failed", pIceCandidatePair->local->id, pIceCandidatePair->remote->id);
-            pIceCandidatePair->state = ICE_CANDIDATE_PAIR_STATE_FAILED;
+            CHK_STATUS(iceAgentUpdateCandidatePairState(pIceAgent, pIceCandidatePair, ICE_CANDIDATE_PAIR_STATE_FAILED));
         }
     } else {
         CHK_STATUS(findIceCandidatePairWithLocalSocketConnectionAndRemoteAddr(pIceAgent, pLocalCandidate->pSocketConnection, pDestAddr, TRUE,
@@ -1465,7 +2080,7 @@ STATUS iceAgentSendSrflxCandidateRequest(PIceAgent pIceAgent)
 
                         transactionIdStoreInsert(pIceAgent->pStunBindingRequestTransactionIdStore, pBindingRequest->header.transactionId);
                         checkSum = COMPUTE_CRC32(pBindingRequest->header.transactionId, ARRAY_SIZE(pBindingRequest->header.transactionId));
-                        CHK_STATUS(iceAgentSendStunPacket(pBindingRequest, NULL, 0, pIceAgent, pCandidate, &pIceServer->ipAddress));
+                        CHK_STATUS(iceAgentSendStunPacket(pBindingRequest, NULL, pIceAgent, pCandidate, &pIceServer->ipAddress));
                         if (pIceAgent->pRtcIceServerDiagnostics[pCandidate->iceServerIndex] != NULL) {
                             pIceAgent->pRtcIceServerDiagnostics[pCandidate->iceServerIndex]->totalRequestsSent++;
                             CHK_STATUS(hashTableUpsert(pIceAgent->requestTimestampDiagnostics, checkSum, GETTIME()));
@@ -1498,8 +2113,9 @@ STATUS iceAgentCheckCandidatePairConnection(PIceAgent pIceAgent)
 {
     STATUS retStatus = STATUS_SUCCESS;
     BOOL triggeredCheckQueueEmpty;
-    UINT64 data;
-    PIceCandidatePair pIceCandidatePair = NULL;
+    UINT64 data, currentTime;
+    UINT32 activePairCount = 0;
+    PIceCandidatePair pIceCandidatePair = NULL, pCheckedIceCandidatePair = NULL;
     PDoubleListNode pCurNode = NULL;
     BOOL locked = FALSE;
 
@@ -1509,32 +2125,48 @@ STATUS iceAgentCheckCandidatePairConnection(PIceAgent pIceAgent)
     MUTEX_LOCK(pIceAgent->lock);
     locked = TRUE;
 
+    currentTime = GETTIME();
+
     CHK_STATUS(stackQueueIsEmpty(pIceAgent->triggeredCheckQueue, &triggeredCheckQueueEmpty));
     if (!triggeredCheckQueueEmpty) {
         // if triggeredCheckQueue is not empty, check its candidate pair first
         stackQueueDequeue(pIceAgent->triggeredCheckQueue, &data);
-        pIceCandidatePair = (PIceCandidatePair) data;
+        pCheckedIceCandidatePair = (PIceCandidatePair) data;
+    }
 
-        CHK_STATUS(iceCandidatePairCheckConnection(pIceAgent->pBindingRequest, pIceAgent, pIceCandidatePair));
-    } else {
-        CHK_STATUS(doubleListGetHeadNode(pIceAgent->iceCandidatePairs, &pCurNode));
-        while (pCurNode != NULL) {
-            pIceCandidatePair = (PIceCandidatePair) pCurNode->data;
-            pCurNode = pCurNode->pNext;
+    // the highest priority waiting pair gets the ordinary check of this Ta unless a triggered check took it
+    CHK_STATUS(doubleListGetHeadNode(pIceAgent->iceCandidatePairs, &pCurNode));
+    while (pCurNode != NULL) {
+        pIceCandidatePair = (PIceCandidatePair) pCurNode->data;
+        pCurNode = pCurNode->pNext;
 
-            switch (pIceCandidatePair->state) {
-                case ICE_CANDIDATE_PAIR_STATE_WAITING:
-                    pIceCandidatePair->state = ICE_CANDIDATE_PAIR_STATE_IN_PROGRESS;
-                    // NOTE: Explicit fall-through
-                case ICE_CANDIDATE_PAIR_STATE_IN_PROGRESS:
-                    CHK_STATUS(iceCandidatePairCheckConnection(pIceAgent->pBindingRequest, pIceAgent, pIceCandidatePair));
-                    break;
-                default:
-                    break;
+        if (pIceCandidatePair->state == ICE_CANDIDATE_PAIR_STATE_WAITING || pIceCandidatePair->state == ICE_CANDIDATE_PAIR_STATE_IN_PROGRESS) {
+            activePairCount++;
+            if (pCheckedIceCandidatePair == NULL && pIceCandidatePair->state == ICE_CANDIDATE_PAIR_STATE_WAITING) {
+                pCheckedIceCandidatePair = pIceCandidatePair;
             }
         }
     }
 
+    pIceAgent->connectionCheckRto =
+        MAX(KVS_ICE_CONNECTION_CHECK_MIN_RTO, (UINT64) activePairCount * pIceAgent->kvsRtcConfiguration.iceConnectionCheckPollingInterval);
+
+    if (pCheckedIceCandidatePair != NULL) {
+        CHK_STATUS(iceAgentSendCandidatePairCheck(pIceAgent, pCheckedIceCandidatePair, currentTime));
+    }
+
+    // retransmit the checks that got no response within the retransmission timeout
+    CHK_STATUS(doubleListGetHeadNode(pIceAgent->iceCandidatePairs, &pCurNode));
+    while (pCurNode != NULL) {
+        pIceCandidatePair = (PIceCandidatePair) pCurNode->data;
+        pCurNode = pCurNode->pNext;
+
+        if (pIceCandidatePair != pCheckedIceCandidatePair && pIceCandidatePair->state == ICE_CANDIDATE_PAIR_STATE_IN_PROGRESS &&
+            pIceCandidatePair->nextConnectivityCheckTime <= currentTime) {
+            CHK_STATUS(iceAgentSendCandidatePairCheck(pIceAgent, pIceCandidatePair, currentTime));
+        }
+    }
+
 CleanUp:
     CHK_LOG_ERR(retStatus);
 
@@ -1557,12 +2189,19 @@ STATUS iceAgentSendKeepAliveTimerCallback(UINT32 timerId, UINT64 currentTime, UI
     BOOL locked = FALSE;
     PIceCandidatePair pIceCandidatePair = NULL;
     PDoubleListNode pCurNode = NULL;
+    PIceDataSendingPath pDataSendingPath = NULL;
 
     CHK(pIceAgent != NULL, STATUS_NULL_ARG);
 
     MUTEX_LOCK(pIceAgent->lock);
     locked = TRUE;
 
+    pDataSendingPath = (PIceDataSendingPath) ATOMIC_LOAD(&pIceAgent->dataSendingPath);
+    if (pDataSendingPath != NULL) {
+        CHK_STATUS(iceDataSendingPathUpdateDiagnostics(pDataSendingPath));
+    }
+    CHK_STATUS(iceAgentReclaimDataSendingPaths(pIceAgent));
+
     CHK_STATUS(doubleListGetHeadNode(pIceAgent->iceCandidatePairs, &pCurNode));
     while (pCurNode != NULL) {
         pIceCandidatePair = (PIceCandidatePair) pCurNode->data;
@@ -1571,7 +2210,7 @@ STATUS iceAgentSendKeepAliveTimerCallback(UINT32 timerId, UINT64 currentTime, UI
         if (pIceCandidatePair->state == ICE_CANDIDATE_PAIR_STATE_SUCCEEDED) {
             pIceCandidatePair->lastDataSentTime = currentTime;
             DLOGV("send keep alive");
-            CHK_STATUS(iceAgentSendStunPacket(pIceAgent->pBindingIndication, NULL, 0, pIceAgent, pIceCandidatePair->local,
+            CHK_STATUS(iceAgentSendStunPacket(pIceAgent->pBindingIndication, NULL, pIceAgent, pIceCandidatePair->local,
                                               &pIceCandidatePair->remote->ipAddress));
         }
     }
@@ -1883,6 +2522,7 @@ STATUS iceAgentInitRelayCandidate(PIceAgent pIceAgent, UINT32 iceServerIndex, KV
     PIceCandidate pNewCandidate = NULL, pCandidate = NULL;
     BOOL locked = FALSE;
     PTurnConnection pTurnConnection = NULL;
+    UINT64 peerCustomData = 0;
 
     CHK(pIceAgent != NULL, STATUS_NULL_ARG);
     /* we dont support TURN on DTLS yet. */
@@ -1895,31 +2535,51 @@ STATUS iceAgentInitRelayCandidate(PIceAgent pIceAgent, UINT32 iceServerIndex, KV
     generateJSONSafeString(pNewCandidate->id, ARRAY_SIZE(pNewCandidate->id));
     pNewCandidate->isRemote = FALSE;
 
-    // open up a new socket without binding to any host address. The candidate Ip address will later be updated
-    // with the correct relay ip address once the Allocation success response is received. Relay candidate's socket is managed
-    // by TurnConnection struct.
-    CHK_STATUS(createSocketConnection(KVS_IP_FAMILY_TYPE_IPV4, protocol, NULL, &pIceAgent->iceServers[iceServerIndex].ipAddress,
-                                      (UINT64) pNewCandidate, incomingRelayedDataHandler, pIceAgent->kvsRtcConfiguration.sendBufSize,
-                                      &pNewCandidate->pSocketConnection));
-    // connectionListener will free the pSocketConnection at the end.
-    CHK_STATUS(connectionListenerAddConnection(pIceAgent->pConnectionListener, pNewCandidate->pSocketConnection));
-
     pNewCandidate->iceCandidateType = ICE_CANDIDATE_TYPE_RELAYED;
     pNewCandidate->state = ICE_CANDIDATE_STATE_NEW;
     pNewCandidate->iceServerIndex = iceServerIndex;
     pNewCandidate->foundation = pIceAgent->foundationCounter++; // we dont generate candidates that have the same foundation.
     pNewCandidate->priority = computeCandidatePriority(pNewCandidate);
+    pNewCandidate->pIceAgent = pIceAgent;
 
-    TurnConnectionCallbacks callback = {0};
-    callback.customData = (UINT64) pNewCandidate;
-    callback.relayAddressAvailableFn = NULL;
-    callback.turnStateFailedFn = turnStateFailedFn;
+    if (pIceAgent->kvsRtcConfiguration.enableSharedTurnAllocations) {
+        // The shared allocation may already be ready, in which case the relay address is available right away.
+        // Fall back to a private allocation if the pool can not provide one.
+        retStatus = turnAllocationPoolAcquire(&pIceAgent->iceServers[iceServerIndex], protocol, pIceAgent->kvsRtcConfiguration.sendBufSize,
+                                              pIceAgent->kvsRtcConfiguration.connectionListenerWorkerCount, (UINT64) pNewCandidate, turnStateFailedFn,
+                                              incomingSharedRelayedDataHandler, &pNewCandidate->pTurnSubscription);
+        if (STATUS_FAILED(retStatus)) {
+            DLOGW("Failed to acquire a shared turn allocation with status 0x%08x, creating a private one", retStatus);
+            retStatus = STATUS_SUCCESS;
+        } else {
+            pTurnConnection = pNewCandidate->pTurnSubscription->pTurnAllocation->pTurnConnection;
+            pNewCandidate->pSocketConnection = pTurnConnection->pControlChannel;
+        }
+    }
+
+    if (pTurnConnection == NULL) {
+        // open up a new socket without binding to any host address. The candidate Ip address will later be updated
+        // with the correct relay ip address once the Allocation success response is received. Relay candidate's socket is managed
+        // by TurnConnection struct.
+        CHK_STATUS(createSocketConnection(KVS_IP_FAMILY_TYPE_IPV4, protocol, NULL, &pIceAgent->iceServers[iceServerIndex].ipAddress,
+                                          (UINT64) pNewCandidate, incomingRelayedDataHandler, pIceAgent->kvsRtcConfiguration.sendBufSize,
+                                          &pNewCandidate->pSocketConnection));
+        // connectionListener will free the pSocketConnection at the end.
+        CHK_STATUS(connectionListenerAddConnection(pIceAgent->pConnectionListener, pNewCandidate->pSocketConnection));
+
+        TurnConnectionCallbacks callback = {0};
+        callback.customData = (UINT64) pNewCandidate;
+        callback.relayAddressAvailableFn = NULL;
+        callback.turnStateFailedFn = turnStateFailedFn;
+
+        CHK_STATUS(createTurnConnection(&pIceAgent->iceServers[iceServerIndex], pIceAgent->timerQueueHandle,
+                                        TURN_CONNECTION_DATA_TRANSFER_MODE_SEND_INDIDATION, protocol, &callback, pNewCandidate->pSocketConnection,
+                                        pIceAgent->pConnectionListener, &pTurnConnection));
+    }
 
-    CHK_STATUS(createTurnConnection(&pIceAgent->iceServers[iceServerIndex], pIceAgent->timerQueueHandle,
-                                    TURN_CONNECTION_DATA_TRANSFER_MODE_SEND_INDIDATION, protocol, &callback, pNewCandidate->pSocketConnection,
-                                    pIceAgent->pConnectionListener, &pTurnConnection));
-    pNewCandidate->pIceAgent = pIceAgent;
     pNewCandidate->pTurnConnection = pTurnConnection;
+    // peers of a shared allocation are tagged with the subscription so their channel data comes back to this candidate
+    peerCustomData = (UINT64) pNewCandidate->pTurnSubscription;
 
     MUTEX_LOCK(pIceAgent->lock);
     locked = TRUE;
@@ -1938,7 +2598,11 @@ STATUS iceAgentInitRelayCandidate(PIceAgent pIceAgent, UINT32 iceServerIndex, KV
         // TODO: Stop skipping IPv6. Since we're allowing IPv6 remote candidates from iceAgentAddRemoteCandidate for host candidates,
         // it's possible to have a situation where the turn server uses IPv4 and the remote candidate uses IPv6.
         if (IS_IPV4_ADDR(&pCandidate->ipAddress)) {
-            CHK_STATUS(turnConnectionAddPeer(pTurnConnection, &pCandidate->ipAddress));
+            retStatus = turnConnectionAddPeerWithCustomData(pTurnConnection, &pCandidate->ipAddress, peerCustomData);
+            if (retStatus == STATUS_TURN_CONNECTION_PEER_IN_USE) {
+                retStatus = STATUS_SUCCESS;
+            }
+            CHK_STATUS(retStatus);
         }
     }
 
@@ -1947,7 +2611,10 @@ STATUS iceAgentInitRelayCandidate(PIceAgent pIceAgent, UINT32 iceServerIndex, KV
     MUTEX_UNLOCK(pIceAgent->lock);
     locked = FALSE;
 
-    CHK_STATUS(turnConnectionStart(pTurnConnection));
+    // the shared allocation is started by the pool
+    if (peerCustomData == 0) {
+        CHK_STATUS(turnConnectionStart(pTurnConnection));
+    }
 
 CleanUp:
 
@@ -1957,7 +2624,10 @@ CleanUp:
         MUTEX_UNLOCK(pIceAgent->lock);
     }
 
-    SAFE_MEMFREE(pNewCandidate);
+    if (pNewCandidate != NULL) {
+        CHK_LOG_ERR(turnAllocationPoolRelease(&pNewCandidate->pTurnSubscription));
+        SAFE_MEMFREE(pNewCandidate);
+    }
 
     return retStatus;
 }
@@ -1998,7 +2668,9 @@ STATUS iceAgentCheckConnectionStateSetup(PIceAgent pIceAgent)
                                               pIceAgent->isControlling ? STUN_ATTRIBUTE_TYPE_ICE_CONTROLLING : STUN_ATTRIBUTE_TYPE_ICE_CONTROLLED,
                                               pIceAgent->tieBreaker));
 
-    pIceAgent->stateEndTime = GETTIME() + pIceAgent->kvsRtcConfiguration.iceConnectionCheckTimeout;
+    pIceAgent->connectionCheckRto = KVS_ICE_CONNECTION_CHECK_MIN_RTO;
+    pIceAgent->connectionCheckStartTime = GETTIME();
+    pIceAgent->stateEndTime = pIceAgent->connectionCheckStartTime + pIceAgent->kvsRtcConfiguration.iceConnectionCheckTimeout;
 
 CleanUp:
 
@@ -2081,7 +2753,7 @@ STATUS iceAgentConnectedStateSetup(PIceAgent pIceAgent)
 {
     STATUS retStatus = STATUS_SUCCESS;
     PDoubleListNode pCurNode = NULL;
-    PIceCandidatePair pIceCandidatePair = NULL, pLastDataSendingIceCandidatePair = NULL;
+    PIceCandidatePair pIceCandidatePair = NULL;
     BOOL locked = FALSE;
 
     CHK(pIceAgent != NULL, STATUS_NULL_ARG);
@@ -2091,26 +2763,13 @@ STATUS iceAgentConnectedStateSetup(PIceAgent pIceAgent)
 
         /* at this point ice restart is complete */
         ATOMIC_STORE_BOOL(&pIceAgent->restart, FALSE);
-        pLastDataSendingIceCandidatePair = pIceAgent->pDataSendingIceCandidatePair;
-        pIceAgent->pDataSendingIceCandidatePair = NULL;
-
-        MUTEX_UNLOCK(pIceAgent->lock);
-        locked = FALSE;
 
         /* If pDataSendingIceCandidatePair is not NULL, then it must be the data sending pair before ice restart.
-         * Free its resource here since not there is a new connected pair to replace it. */
-        if (IS_CANN_PAIR_SENDING_FROM_RELAYED(pLastDataSendingIceCandidatePair)) {
-            CHK_STATUS(turnConnectionShutdown(pLastDataSendingIceCandidatePair->local->pTurnConnection, KVS_ICE_TURN_CONNECTION_SHUTDOWN_TIMEOUT));
-            CHK_STATUS(freeTurnConnection(&pLastDataSendingIceCandidatePair->local->pTurnConnection));
+         * Free its resource once no sender uses it since now there is a new connected pair to replace it. */
+        CHK_STATUS(iceAgentRetireDataSendingPair(pIceAgent));
 
-        } else {
-            CHK_STATUS(
-                connectionListenerRemoveConnection(pIceAgent->pConnectionListener, pLastDataSendingIceCandidatePair->local->pSocketConnection));
-            CHK_STATUS(freeSocketConnection(&pLastDataSendingIceCandidatePair->local->pSocketConnection));
-        }
-
-        MEMFREE(pLastDataSendingIceCandidatePair->local);
-        CHK_STATUS(freeIceCandidatePair(&pLastDataSendingIceCandidatePair));
+        MUTEX_UNLOCK(pIceAgent->lock);
+        locked = FALSE;
     }
 
     MUTEX_LOCK(pIceAgent->lock);
@@ -2124,10 +2783,17 @@ STATUS iceAgentConnectedStateSetup(PIceAgent pIceAgent)
 
         if (pIceCandidatePair->state == ICE_CANDIDATE_PAIR_STATE_SUCCEEDED && pIceCandidatePair->nominated) {
             pIceAgent->pDataSendingIceCandidatePair = pIceCandidatePair;
+            CHK_STATUS(iceAgentPublishDataSendingPath(pIceAgent));
             break;
         }
     }
 
+    // without a nominated pair, the first pair fast path sends on the best succeeded pair until nomination is done
+    if (pIceAgent->pDataSendingIceCandidatePair == NULL && pIceAgent->kvsRtcConfiguration.enableIceFirstPairFastPath) {
+        CHK_STATUS(iceAgentSelectFastPathDataSendingPair(pIceAgent));
+        pIceAgent->stateEndTime = GETTIME() + KVS_ICE_FIRST_PAIR_FAST_PATH_SWITCH_PERIOD;
+    }
+
     // schedule sending keep alive
     CHK_STATUS(timerQueueAddTimer(pIceAgent->timerQueueHandle, KVS_ICE_DEFAULT_TIMER_START_DELAY, KVS_ICE_SEND_KEEP_ALIVE_INTERVAL,
                                   iceAgentSendKeepAliveTimerCallback, (UINT64) pIceAgent, &pIceAgent->keepAliveTimerTask));
@@ -2147,6 +2813,74 @@ CleanUp:
     return retStatus;
 }
 
+STATUS iceAgentSelectFastPathDataSendingPair(PIceAgent pIceAgent)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    PDoubleListNode pCurNode = NULL;
+    PIceCandidatePair pIceCandidatePair = NULL, pBestSucceededPair = NULL;
+
+    CHK(pIceAgent != NULL, STATUS_NULL_ARG);
+
+    // Assume holding pIceAgent->lock
+    // iceCandidatePairs is sorted by priority so the first succeeded pair is the best one so far
+    CHK_STATUS(doubleListGetHeadNode(pIceAgent->iceCandidatePairs, &pCurNode));
+    while (pCurNode != NULL && pBestSucceededPair == NULL) {
+        pIceCandidatePair = (PIceCandidatePair) pCurNode->data;
+        pCurNode = pCurNode->pNext;
+
+        if (pIceCandidatePair->state == ICE_CANDIDATE_PAIR_STATE_SUCCEEDED) {
+            pBestSucceededPair = pIceCandidatePair;
+        }
+    }
+
+    CHK(pBestSucceededPair != NULL && pBestSucceededPair != pIceAgent->pDataSendingIceCandidatePair, retStatus);
+
+    DLOGI("Sending data on pair %s_%s before nomination, local candidate type %s, remote candidate type %s", pBestSucceededPair->local->id,
+          pBestSucceededPair->remote->id, iceAgentGetCandidateTypeStr(pBestSucceededPair->local->iceCandidateType),
+          iceAgentGetCandidateTypeStr(pBestSucceededPair->remote->iceCandidateType));
+    pIceAgent->pDataSendingIceCandidatePair = pBestSucceededPair;
+    CHK_STATUS(iceAgentPublishDataSendingPath(pIceAgent));
+
+CleanUp:
+
+    CHK_LOG_ERR(retStatus);
+
+    return retStatus;
+}
+
+STATUS iceAgentHasPendingHigherPriorityPair(PIceAgent pIceAgent, PBOOL pPending)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    PDoubleListNode pCurNode = NULL;
+    PIceCandidatePair pIceCandidatePair = NULL;
+    BOOL pending = FALSE;
+
+    CHK(pIceAgent != NULL && pPending != NULL, STATUS_NULL_ARG);
+
+    // Assume holding pIceAgent->lock
+    // pairs ahead of the data sending pair have a higher priority
+    CHK_STATUS(doubleListGetHeadNode(pIceAgent->iceCandidatePairs, &pCurNode));
+    while (pCurNode != NULL && !pending) {
+        pIceCandidatePair = (PIceCandidatePair) pCurNode->data;
+        pCurNode = pCurNode->pNext;
+
+        if (pIceCandidatePair == pIceAgent->pDataSendingIceCandidatePair) {
+            break;
+        }
+
+        pending = pIceCandidatePair->state == ICE_CANDIDATE_PAIR_STATE_FROZEN || pIceCandidatePair->state == ICE_CANDIDATE_PAIR_STATE_WAITING ||
+            pIceCandidatePair->state == ICE_CANDIDATE_PAIR_STATE_IN_PROGRESS;
+    }
+
+CleanUp:
+
+    if (pPending != NULL) {
+        *pPending = pending;
+    }
+
+    return retStatus;
+}
+
 STATUS iceAgentNominatingStateSetup(PIceAgent pIceAgent)
 {
     STATUS retStatus = STATUS_SUCCESS;
@@ -2209,7 +2943,7 @@ STATUS iceAgentReadyStateSetup(PIceAgent pIceAgent)
     locked = TRUE;
 
     // if data sending pair already selected and is nominated, no need to find it again
-    if (pIceAgent->pDataSendingIceCandidatePair == NULL) {
+    if (pIceAgent->pDataSendingIceCandidatePair == NULL || !pIceAgent->pDataSendingIceCandidatePair->nominated) {
         // find nominated pair
         CHK_STATUS(doubleListGetHeadNode(pIceAgent->iceCandidatePairs, &pCurNode));
         while (pCurNode != NULL && pNominatedAndValidCandidatePair == NULL) {
@@ -2225,6 +2959,7 @@ STATUS iceAgentReadyStateSetup(PIceAgent pIceAgent)
         }
         CHK(pNominatedAndValidCandidatePair != NULL, STATUS_ICE_NO_NOMINATED_VALID_CANDIDATE_PAIR_AVAILABLE);
         pIceAgent->pDataSendingIceCandidatePair = pNominatedAndValidCandidatePair;
+        CHK_STATUS(iceAgentPublishDataSendingPath(pIceAgent));
         // Set to stop gathering
         ATOMIC_STORE_BOOL(&pIceAgent->stopGathering, TRUE);
     }
@@ -2252,7 +2987,7 @@ STATUS iceAgentReadyStateSetup(PIceAgent pIceAgent)
 
         if (pIceCandidate != pIceAgent->pDataSendingIceCandidatePair->local) {
             if (pIceCandidate->iceCandidateType == ICE_CANDIDATE_TYPE_RELAYED) {
-                CHK_STATUS(turnConnectionShutdown(pIceCandidate->pTurnConnection, 0));
+                CHK_STATUS(iceCandidateShutdownTurnConnection(pIceCandidate, 0));
             }
             pIceCandidate->state = ICE_CANDIDATE_STATE_INVALID;
         }
@@ -2267,6 +3002,7 @@ STATUS iceAgentReadyStateSetup(PIceAgent pIceAgent)
         pCurNode = pCurNode->pNext;
 
         if (pIceCandidatePair->state == ICE_CANDIDATE_PAIR_STATE_FAILED) {
+            unindexIceCandidatePair(pIceAgent->iceCandidatePairIndex, pIceCandidatePair);
             freeIceCandidatePair(&pIceCandidatePair);
             doubleListDeleteNode(pIceAgent->iceCandidatePairs, pNodeToDelete);
         }
@@ -2334,7 +3070,7 @@ STATUS iceAgentNominateCandidatePair(PIceAgent pIceAgent)
         pCurNode = pCurNode->pNext;
 
         if (!pIceCandidatePair->nominated) {
-            pIceCandidatePair->state = ICE_CANDIDATE_PAIR_STATE_FROZEN;
+            CHK_STATUS(iceAgentUpdateCandidatePairState(pIceAgent, pIceCandidatePair, ICE_CANDIDATE_PAIR_STATE_FROZEN));
         }
     }
 
@@ -2363,7 +3099,7 @@ STATUS iceAgentInvalidateCandidatePair(PIceAgent pIceAgent)
         pCurNode = pCurNode->pNext;
 
         if (pIceCandidatePair->local->state != ICE_CANDIDATE_STATE_VALID) {
-            pIceCandidatePair->state = ICE_CANDIDATE_PAIR_STATE_FAILED;
+            CHK_STATUS(iceAgentUpdateCandidatePairState(pIceAgent, pIceCandidatePair, ICE_CANDIDATE_PAIR_STATE_FAILED));
         }
     }
 
@@ -2399,6 +3135,59 @@ CleanUp:
     return retStatus;
 }
 
+STATUS incomingSharedRelayedDataHandler(UINT64 customData, PSocketConnection pSocketConnection, PBYTE pBuffer, UINT32 bufferLen,
+                                        PKvsIpAddress pSrc, PKvsIpAddress pDest)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    PIceCandidate pRelayedCandidate = (PIceCandidate) customData;
+
+    CHK(pRelayedCandidate != NULL && pSocketConnection != NULL, STATUS_NULL_ARG);
+
+    // channel data has already been parsed by the turn allocation pool
+    CHK_STATUS(incomingDataHandler((UINT64) pRelayedCandidate->pIceAgent, pSocketConnection, pBuffer, bufferLen, pSrc, pDest));
+
+CleanUp:
+
+    return retStatus;
+}
+
+STATUS iceCandidateShutdownTurnConnection(PIceCandidate pIceCandidate, UINT64 waitUntilAllocationFreedTimeout)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+
+    CHK(pIceCandidate != NULL, STATUS_NULL_ARG);
+    CHK(pIceCandidate->pTurnConnection != NULL, retStatus);
+
+    if (pIceCandidate->pTurnSubscription != NULL) {
+        CHK_STATUS(turnConnectionReleasePeers(pIceCandidate->pTurnConnection, (UINT64) pIceCandidate->pTurnSubscription));
+    } else {
+        CHK_STATUS(turnConnectionShutdown(pIceCandidate->pTurnConnection, waitUntilAllocationFreedTimeout));
+    }
+
+CleanUp:
+
+    return retStatus;
+}
+
+STATUS iceCandidateFreeTurnConnection(PIceCandidate pIceCandidate)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+
+    CHK(pIceCandidate != NULL, STATUS_NULL_ARG);
+
+    if (pIceCandidate->pTurnSubscription != NULL) {
+        CHK_STATUS(turnAllocationPoolRelease(&pIceCandidate->pTurnSubscription));
+        pIceCandidate->pTurnConnection = NULL;
+        pIceCandidate->pSocketConnection = NULL;
+    } else {
+        CHK_STATUS(freeTurnConnection(&pIceCandidate->pTurnConnection));
+    }
+
+CleanUp:
+
+    return retStatus;
+}
+
 STATUS incomingDataHandler(UINT64 customData, PSocketConnection pSocketConnection, PBYTE pBuffer, UINT32 bufferLen, PKvsIpAddress pSrc,
                            PKvsIpAddress pDest)
 {
@@ -2500,9 +3289,11 @@ STATUS handleStunPacket(PIceAgent pIceAgent, PBYTE pBuffer, UINT32 bufferLen, PS
     UNUSED_PARAM(pDestAddr);
 
     STATUS retStatus = STATUS_SUCCESS;
-    PStunPacket pStunPacket = NULL, pStunResponse = NULL;
+    PStunPacket pStunPacket = NULL;
     PStunAttributeHeader pStunAttr = NULL;
     UINT16 stunPacketType = 0;
+    BYTE stunResponseBuffer[STUN_BINDING_RESPONSE_MAX_LEN];
+    UINT32 stunResponseSize = SIZEOF(stunResponseBuffer);
     PIceCandidatePair pIceCandidatePair = NULL;
     PStunAttributeAddress pStunAttributeAddress = NULL;
     PStunAttributePriority pStunAttributePriority = NULL;
@@ -2523,28 +3314,36 @@ STATUS handleStunPacket(PIceAgent pIceAgent, PBYTE pBuffer, UINT32 bufferLen, PS
     switch (stunPacketType) {
         case STUN_PACKET_TYPE_BINDING_REQUEST:
             connectivityCheckRequestsReceived++;
-            CHK_STATUS(deserializeStunPacket(pBuffer, bufferLen, (PBYTE) pIceAgent->localPassword,
-                                             (UINT32) STRLEN(pIceAgent->localPassword) * SIZEOF(CHAR), &pStunPacket));
-            CHK_STATUS(createStunPacket(STUN_PACKET_TYPE_BINDING_RESPONSE_SUCCESS, pStunPacket->header.transactionId, &pStunResponse));
-            CHK_STATUS(appendStunAddressAttribute(pStunResponse, STUN_ATTRIBUTE_TYPE_XOR_MAPPED_ADDRESS, pSrcAddr));
-            CHK_STATUS(appendStunIceControllAttribute(
-                pStunResponse, pIceAgent->isControlling ? STUN_ATTRIBUTE_TYPE_ICE_CONTROLLING : STUN_ATTRIBUTE_TYPE_ICE_CONTROLLED,
-                pIceAgent->tieBreaker));
-
-            CHK_STATUS(getStunAttribute(pStunPacket, STUN_ATTRIBUTE_TYPE_PRIORITY, (PStunAttributeHeader*) &pStunAttributePriority));
-            priority = pStunAttributePriority == NULL ? 0 : pStunAttributePriority->priority;
-            CHK_STATUS(iceAgentCheckPeerReflexiveCandidate(pIceAgent, pSrcAddr, priority, TRUE, 0));
-
-            CHK_STATUS(findCandidateWithSocketConnection(pSocketConnection, pIceAgent->localCandidates, &pIceCandidate));
+            CHK_STATUS(deserializeStunPacketWithHmacKey(pBuffer, bufferLen, &pIceAgent->localPasswordHmacKey,
+                                                        (PStunPacket) pIceAgent->stunPacketStorage, SIZEOF(pIceAgent->stunPacketStorage),
+                                                        &pStunPacket));
+            CHK_STATUS(stunPackageBindingResponse(pStunPacket->header.transactionId, pSrcAddr,
+                                                  pIceAgent->isControlling ? STUN_ATTRIBUTE_TYPE_ICE_CONTROLLING : STUN_ATTRIBUTE_TYPE_ICE_CONTROLLED,
+                                                  pIceAgent->tieBreaker, &pIceAgent->localPasswordHmacKey, stunResponseBuffer, &stunResponseSize));
+
+            // A known pair means the sender is a known remote candidate, and its local candidate owns the socket the
+            // request came in on. Only look through the candidate lists for the first request from a new address.
+            CHK_STATUS(findIceCandidatePairWithLocalSocketConnectionAndRemoteAddr(pIceAgent, pSocketConnection, pSrcAddr, TRUE, &pIceCandidatePair));
+            if (pIceCandidatePair != NULL) {
+                pIceCandidate = pIceCandidatePair->local;
+            } else {
+                CHK_STATUS(getStunAttribute(pStunPacket, STUN_ATTRIBUTE_TYPE_PRIORITY, (PStunAttributeHeader*) &pStunAttributePriority));
+                priority = pStunAttributePriority == NULL ? 0 : pStunAttributePriority->priority;
+                CHK_STATUS(iceAgentCheckPeerReflexiveCandidate(pIceAgent, pSrcAddr, priority, TRUE, 0));
+
+                CHK_STATUS(findCandidateWithSocketConnection(pSocketConnection, pIceAgent->localCandidates, &pIceCandidate));
+            }
             CHK_WARN(pIceCandidate != NULL, retStatus, "Could not find local candidate to send STUN response");
-            CHK_STATUS(iceAgentSendStunPacket(pStunResponse, (PBYTE) pIceAgent->localPassword,
-                                              (UINT32) STRLEN(pIceAgent->localPassword) * SIZEOF(CHAR), pIceAgent, pIceCandidate, pSrcAddr));
+            CHK_STATUS(iceAgentSendPackagedStunPacket(stunResponseBuffer, stunResponseSize, pIceAgent, pIceCandidate, pSrcAddr));
 
             connectivityCheckResponsesSent++;
             // return early if there is no candidate pair. This can happen when we get connectivity check from the peer
             // before we receive the answer.
-            CHK_STATUS(findIceCandidatePairWithLocalSocketConnectionAndRemoteAddr(pIceAgent, pSocketConnection, pSrcAddr, TRUE, &pIceCandidatePair));
-            CHK(pIceCandidatePair != NULL, retStatus);
+            if (pIceCandidatePair == NULL) {
+                CHK_STATUS(
+                    findIceCandidatePairWithLocalSocketConnectionAndRemoteAddr(pIceAgent, pSocketConnection, pSrcAddr, TRUE, &pIceCandidatePair));
+                CHK(pIceCandidatePair != NULL, retStatus);
+            }
             DLOGD("Pair binding request! %s %s", pIceCandidatePair->local->id, pIceCandidatePair->remote->id);
 
             if (!pIceCandidatePair->nominated) {
@@ -2557,10 +3356,16 @@ STATUS handleStunPacket(PIceAgent pIceAgent, PBYTE pBuffer, UINT32 bufferLen, PS
                 }
             }
 
-            // schedule a connectivity check for the pair
+            // triggered check for the pair. Send it right away while connectivity checks are running instead of waiting for the next Ta
             if (pIceCandidatePair->state == ICE_CANDIDATE_PAIR_STATE_FROZEN || pIceCandidatePair->state == ICE_CANDIDATE_PAIR_STATE_WAITING ||
                 pIceCandidatePair->state == ICE_CANDIDATE_PAIR_STATE_IN_PROGRESS) {
-                CHK_STATUS(stackQueueEnqueue(pIceAgent->triggeredCheckQueue, (UINT64) pIceCandidatePair));
+                if (pIceAgent->pBindingRequest != NULL &&
+                    (pIceAgent->iceAgentState == ICE_AGENT_STATE_CHECK_CONNECTION || pIceAgent->iceAgentState == ICE_AGENT_STATE_CONNECTED ||
+                     (pIceAgent->iceAgentState == ICE_AGENT_STATE_NOMINATING && !pIceAgent->isControlling))) {
+                    CHK_STATUS(iceAgentSendCandidatePairCheck(pIceAgent, pIceCandidatePair, GETTIME()));
+                } else {
+                    CHK_STATUS(stackQueueEnqueue(pIceAgent->triggeredCheckQueue, (UINT64) pIceCandidatePair));
+                }
             }
 
             if (pIceCandidatePair == pIceAgent->pDataSendingIceCandidatePair) {
@@ -2595,7 +3400,8 @@ STATUS handleStunPacket(PIceAgent pIceAgent, PBYTE pBuffer, UINT32 bufferLen, PS
                     }
                 }
 
-                CHK_STATUS(deserializeStunPacket(pBuffer, bufferLen, NULL, 0, &pStunPacket));
+                CHK_STATUS(deserializeStunPacketWithHmacKey(pBuffer, bufferLen, NULL, (PStunPacket) pIceAgent->stunPacketStorage,
+                                                            SIZEOF(pIceAgent->stunPacketStorage), &pStunPacket));
                 CHK_STATUS(getStunAttribute(pStunPacket, STUN_ATTRIBUTE_TYPE_XOR_MAPPED_ADDRESS, &pStunAttr));
                 CHK_WARN(pStunAttr != NULL, retStatus, "No mapped address attribute found in STUN binding response. Dropping Packet");
 
@@ -2642,8 +3448,9 @@ STATUS handleStunPacket(PIceAgent pIceAgent, PBYTE pBuffer, UINT32 bufferLen, PS
                     }
                 }
             }
-            CHK_STATUS(deserializeStunPacket(pBuffer, bufferLen, (PBYTE) pIceAgent->remotePassword,
-                                             (UINT32) STRLEN(pIceAgent->remotePassword) * SIZEOF(CHAR), &pStunPacket));
+            CHK_STATUS(deserializeStunPacketWithHmacKey(pBuffer, bufferLen, &pIceAgent->remotePasswordHmacKey,
+                                                        (PStunPacket) pIceAgent->stunPacketStorage, SIZEOF(pIceAgent->stunPacketStorage),
+                                                        &pStunPacket));
             CHK_STATUS(getStunAttribute(pStunPacket, STUN_ATTRIBUTE_TYPE_XOR_MAPPED_ADDRESS, &pStunAttr));
             CHK_WARN(pStunAttr != NULL, retStatus, "No mapped address attribute found in STUN response. Dropping Packet");
 
@@ -2665,7 +3472,19 @@ STATUS handleStunPacket(PIceAgent pIceAgent, PBYTE pBuffer, UINT32 bufferLen, PS
 
             if (pIceCandidatePair->state != ICE_CANDIDATE_PAIR_STATE_SUCCEEDED) {
                 DLOGD("Pair succeeded! %s %s", pIceCandidatePair->local->id, pIceCandidatePair->remote->id);
-                pIceCandidatePair->state = ICE_CANDIDATE_PAIR_STATE_SUCCEEDED;
+                CHK_STATUS(iceAgentUpdateCandidatePairState(pIceAgent, pIceCandidatePair, ICE_CANDIDATE_PAIR_STATE_SUCCEEDED));
+                if (pIceAgent->iceAgentProfileDiagnostics.iceCandidatePairFirstSucceededTime == 0 && pIceAgent->connectionCheckStartTime != 0) {
+                    PROFILE_WITH_START_TIME_OBJ(pIceAgent->connectionCheckStartTime,
+                                                pIceAgent->iceAgentProfileDiagnostics.iceCandidatePairFirstSucceededTime,
+                                                "First ICE candidate pair succeeded");
+                }
+
+                // the first pair fast path moves the data to a better pair as soon as one succeeds
+                if (pIceAgent->kvsRtcConfiguration.enableIceFirstPairFastPath && pIceAgent->pDataSendingIceCandidatePair != NULL &&
+                    (pIceAgent->iceAgentState == ICE_AGENT_STATE_CONNECTED ||
+                     (pIceAgent->iceAgentState == ICE_AGENT_STATE_NOMINATING && !pIceAgent->isControlling))) {
+                    CHK_STATUS(iceAgentSelectFastPathDataSendingPair(pIceAgent));
+                }
                 retStatus = hashTableGet(pIceCandidatePair->requestSentTime, checkSum, &requestSentTime);
                 if (hashTableGet(pIceCandidatePair->requestSentTime, checkSum, &requestSentTime) == STATUS_SUCCESS) {
                     pIceCandidatePair->roundTripTime = GETTIME() - requestSentTime;
@@ -2729,14 +3548,10 @@ CleanUp:
 
     SAFE_MEMFREE(hexStr);
 
-    if (pStunPacket != NULL) {
+    if (pStunPacket != NULL && pStunPacket != (PStunPacket) pIceAgent->stunPacketStorage) {
         freeStunPacket(&pStunPacket);
     }
 
-    if (pStunResponse != NULL) {
-        freeStunPacket(&pStunResponse);
-    }
-
     // TODO send error packet
 
     return retStatus;
@@ -2946,6 +3761,8 @@ STATUS getIceAgentStats(PIceAgent pIceAgent, PKvsIceAgentMetrics pKvsIceAgentMet
     pKvsIceAgentMetrics->kvsIceAgentStats.iceAgentSetUpTime = pIceAgent->iceAgentProfileDiagnostics.iceAgentSetUpTime;
     pKvsIceAgentMetrics->kvsIceAgentStats.candidateGatheringStartTime = pIceAgent->candidateGatheringStartTime;
     pKvsIceAgentMetrics->kvsIceAgentStats.candidateGatheringEndTime = pIceAgent->candidateGatheringProcessEndTime;
+    pKvsIceAgentMetrics->kvsIceAgentStats.iceCandidatePairFirstSucceededTime =
+        pIceAgent->iceAgentProfileDiagnostics.iceCandidatePairFirstSucceededTime;
 CleanUp:
     return retStatus;
 }
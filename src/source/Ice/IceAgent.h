@@ -24,10 +24,20 @@ extern "C" {
 #define KVS_ICE_TURN_CONNECTION_SHUTDOWN_TIMEOUT (1 * HUNDREDS_OF_NANOS_IN_A_SECOND)
 #define KVS_ICE_DEFAULT_TIMER_START_DELAY        (3 * HUNDREDS_OF_NANOS_IN_A_MILLISECOND)
 #define KVS_ICE_SHORT_CHECK_DELAY                (50 * HUNDREDS_OF_NANOS_IN_A_MILLISECOND)
-
-// Ta in https://tools.ietf.org/html/rfc8445
-#define KVS_ICE_CONNECTION_CHECK_POLLING_INTERVAL  (50 * HUNDREDS_OF_NANOS_IN_A_MILLISECOND)
-#define KVS_ICE_STATE_READY_TIMER_POLLING_INTERVAL (1 * HUNDREDS_OF_NANOS_IN_A_SECOND)
+// Senders only hold a data sending path for the duration of a send
+#define KVS_ICE_DATA_SENDING_PATH_RETIRE_DELAY (100 * HUNDREDS_OF_NANOS_IN_A_MICROSECOND)
+
+/* Ta in https://tools.ietf.org/html/rfc8445#section-14.2, one ordinary connectivity check is sent every Ta. Applications
+ * can lower it down to the minimum through KvsRtcConfiguration.iceConnectionCheckPollingInterval */
+#define KVS_ICE_CONNECTION_CHECK_POLLING_INTERVAL     (50 * HUNDREDS_OF_NANOS_IN_A_MILLISECOND)
+#define KVS_ICE_MIN_CONNECTION_CHECK_POLLING_INTERVAL (5 * HUNDREDS_OF_NANOS_IN_A_MILLISECOND)
+#define KVS_ICE_STATE_READY_TIMER_POLLING_INTERVAL    (1 * HUNDREDS_OF_NANOS_IN_A_SECOND)
+/* Lower bound of the connectivity check retransmission timeout, which is otherwise Ta times the number of waiting and
+ * in progress pairs as in https://tools.ietf.org/html/rfc8445#section-14.3 */
+#define KVS_ICE_CONNECTION_CHECK_MIN_RTO (500 * HUNDREDS_OF_NANOS_IN_A_MILLISECOND)
+/* With enableIceFirstPairFastPath, how long a controlling agent keeps checking pairs with a higher priority than the data sending pair
+ * before nominating. Media is already flowing on the data sending pair meanwhile */
+#define KVS_ICE_FIRST_PAIR_FAST_PATH_SWITCH_PERIOD (2 * HUNDREDS_OF_NANOS_IN_A_SECOND)
 /* Control the calling rate of iceCandidateGatheringTimerTask. Can affect STUN TURN candidate gathering time */
 #define KVS_ICE_GATHER_CANDIDATE_TIMER_POLLING_INTERVAL (50 * HUNDREDS_OF_NANOS_IN_A_MILLISECOND)
 
@@ -57,6 +67,11 @@ extern "C" {
 #define ICE_HASH_TABLE_BUCKET_COUNT  100
 #define ICE_HASH_TABLE_BUCKET_LENGTH 2
 
+#define ICE_CANDIDATE_PAIR_INDEX_BUCKET_COUNT     256
+#define ICE_CANDIDATE_PAIR_INDEX_BUCKET_LENGTH    2
+#define ICE_CANDIDATE_PAIR_INDEX_FNV_OFFSET_BASIS 0xcbf29ce484222325ULL
+#define ICE_CANDIDATE_PAIR_INDEX_FNV_PRIME        0x00000100000001b3ULL
+
 #define ICE_CANDIDATE_ID_LEN 8
 
 #define STATS_NOT_APPLICABLE_STR (PCHAR) "N/A"
@@ -158,6 +173,10 @@ typedef struct {
      * pTurnConnection this candidate is associated to */
     struct __TurnConnection* pTurnConnection;
 
+    /* Set when pTurnConnection is a shared allocation from the turn allocation pool. The candidate then owns
+     * neither pTurnConnection nor pSocketConnection. */
+    struct __TurnAllocationSubscription* pTurnSubscription;
+
     /* store pointer to iceAgent to pass it to incomingDataHandler in incomingRelayedDataHandler
      * we pass pTurnConnectionTrack as customData to incomingRelayedDataHandler to avoid look up
      * pTurnConnection every time. */
@@ -170,7 +189,7 @@ typedef struct {
     KVS_SOCKET_PROTOCOL remoteProtocol;
 } IceCandidate, *PIceCandidate;
 
-typedef struct {
+typedef struct __IceCandidatePair {
     PIceCandidate local;
     PIceCandidate remote;
     BOOL nominated;
@@ -182,9 +201,45 @@ typedef struct {
     PHashTable requestSentTime;
     UINT64 roundTripTime;
     UINT64 responsesReceived;
+    // When the connectivity check of an IN_PROGRESS pair is retransmitted if no response came back
+    UINT64 nextConnectivityCheckTime;
     PRtcIceCandidatePairDiagnostics pRtcIceCandidatePairDiagnostics;
+    /* If sending from a relay candidate, the turn peer of the remote candidate. Looked up when the pair
+     * becomes the data sending pair so that relayed packets do not search the peer list every time */
+    struct __TurnPeer* pTurnPeer;
+    // Key of the pair in iceCandidatePairIndex, and the next lower priority pair under the same key
+    UINT64 indexKey;
+    struct __IceCandidatePair* pNextIndexed;
 } IceCandidatePair, *PIceCandidatePair;
 
+/**
+ * Immutable copy of what is needed to send on pDataSendingIceCandidatePair. A new one is published under the
+ * ice agent lock whenever the data sending pair or its state changes, so senders get it with a single atomic load
+ * and never contend with the ice timers for the ice agent lock. Senders never touch pIceCandidatePair itself.
+ */
+typedef struct __IceDataSendingPath {
+    PIceCandidatePair pIceCandidatePair;
+    PSocketConnection pSocketConnection;
+    struct __TurnConnection* pTurnConnection;
+    struct __TurnPeer* pTurnPeer;
+    KvsIpAddress remoteAddress;
+    BOOL isRelay;
+    // Whether pIceCandidatePair was in ICE_CANDIDATE_PAIR_STATE_SUCCEEDED when the path was published
+    BOOL succeeded;
+    /* Send side counters updated by iceAgentSendPacket(s). Folded into the diagnostics of pIceCandidatePair
+     * under the ice agent lock by iceDataSendingPathUpdateDiagnostics */
+    volatile SIZE_T packetsSent;
+    volatile SIZE_T bytesSent;
+    volatile SIZE_T packetsDiscardedOnSend;
+    volatile SIZE_T bytesDiscardedOnSend;
+    /* Once replaced the path waits in pRetiredDataSendingPaths for the senders that may still hold it, and
+     * pIceCandidatePair may be freed in the meantime. retiredGracePeriod is dataSendingPathGracePeriods at that time */
+    UINT64 retiredGracePeriod;
+    // Data sending pair dropped by an ice restart. It is freed with its local candidate along with the path
+    PIceCandidatePair pRetiredIceCandidatePair;
+    struct __IceDataSendingPath* pNextRetired;
+} IceDataSendingPath, *PIceDataSendingPath;
+
 typedef struct {
     UINT64 localCandidateGatheringTime;
     UINT64 hostCandidateSetUpTime;
@@ -194,6 +249,7 @@ typedef struct {
     UINT64 iceCandidatePairNominationTime;
     UINT64 candidateGatheringTime;
     UINT64 iceAgentSetUpTime;
+    UINT64 iceCandidatePairFirstSucceededTime;
 } IceAgentProfileDiagnostics, *PIceAgentProfileDiagnostics;
 
 struct __IceAgent {
@@ -212,6 +268,13 @@ struct __IceAgent {
     CHAR remotePassword[MAX_ICE_CONFIG_CREDENTIAL_LEN + 1];
     CHAR combinedUserName[(MAX_ICE_CONFIG_USER_NAME_LEN + 1) << 1]; //!< the combination of remote user name and local user name.
 
+    // HMAC keys of localPassword and remotePassword, refreshed whenever the passwords change
+    KvsSha1HmacKey localPasswordHmacKey;
+    KvsSha1HmacKey remotePasswordHmacKey;
+
+    // Inbound STUN packets are decoded here instead of the heap when they fit. Protected by lock
+    UINT64 stunPacketStorage[STUN_PACKET_ALLOCATION_SIZE / SIZEOF(UINT64)];
+
     PRtcIceServerDiagnostics pRtcIceServerDiagnostics[MAX_ICE_SERVERS_COUNT];
     PRtcIceCandidateDiagnostics pRtcSelectedLocalIceCandidateDiagnostics;
     PRtcIceCandidateDiagnostics pRtcSelectedRemoteIceCandidateDiagnostics;
@@ -224,8 +287,12 @@ struct __IceAgent {
     // store PIceCandidatePair which will be immediately checked for connectivity when the timer is fired.
     PStackQueue triggeredCheckQueue;
     PDoubleList iceCandidatePairs;
+    // Every pair of iceCandidatePairs by local socket connection and remote transport address, see indexIceCandidatePair
+    PHashTable iceCandidatePairIndex;
 
     PConnectionListener pConnectionListener;
+    // The process wide listener of KvsRtcConfiguration.connectionListenerWorkerCount, it outlives the agent
+    BOOL sharedConnectionListener;
     BOOL isControlling;
     UINT64 tieBreaker;
 
@@ -245,6 +312,16 @@ struct __IceAgent {
     UINT64 candidateGatheringEndTime;
     PIceCandidatePair pDataSendingIceCandidatePair;
 
+    // PIceDataSendingPath for pDataSendingIceCandidatePair, 0 when there is none
+    volatile SIZE_T dataSendingPath;
+    // Senders using a data sending path, counted under the parity of dataSendingPathEpoch they started in.
+    // A retired path is freed once both counters have drained after it was replaced.
+    volatile SIZE_T dataSendingPathReaders[2];
+    volatile SIZE_T dataSendingPathEpoch;
+    // Replaced data sending paths, newest first, and the number of times a parity has drained since the agent was created
+    PIceDataSendingPath pRetiredDataSendingPaths;
+    UINT64 dataSendingPathGracePeriods;
+
     IceAgentCallbacks iceAgentCallbacks;
 
     IceServer iceServers[MAX_ICE_SERVERS_COUNT];
@@ -275,6 +352,10 @@ struct __IceAgent {
     UINT64 candidateGatheringStartTime;
     UINT64 candidateGatheringProcessEndTime;
     UINT64 iceAgentStartTime;
+    // When the connectivity checks started, iceCandidatePairFirstSucceededTime is measured from it
+    UINT64 connectionCheckStartTime;
+    // Connectivity check retransmission timeout, recomputed every Ta from the number of pairs being checked
+    UINT64 connectionCheckRto;
 };
 
 //////////////////////////////////////////////
@@ -354,6 +435,23 @@ STATUS iceCandidateSerialize(PIceCandidate, PCHAR, PUINT32);
  */
 STATUS iceAgentSendPacket(PIceAgent, PBYTE, UINT32);
 
+/**
+ * Send several packets through the selected connection in order, taking the agent lock and updating the
+ * candidate pair stats once for the whole batch. PIceAgent has to be in ICE_AGENT_CONNECTION_STATE_CONNECTED state.
+ * When the selected pair is relayed the packets are framed in place, so the send fails unless every buffer has at least
+ * TURN_DATA_CHANNEL_SEND_HEADROOM writable bytes in front of it and TURN_DATA_CHANNEL_SEND_TAILROOM after it.
+ *
+ * @param - PIceAgent - IN - IceAgent object
+ * @param - PBYTE* - IN - array of buffers storing the data to be sent
+ * @param - PUINT32 - IN - array of data lengths
+ * @param - UINT32 - IN - number of buffers
+ * @param - UINT32 - IN - writable bytes in front of every buffer
+ * @param - UINT32 - IN - writable bytes after every buffer
+ *
+ * @return - STATUS - status of execution
+ */
+STATUS iceAgentSendPackets(PIceAgent, PBYTE*, PUINT32, UINT32, UINT32, UINT32);
+
 /**
  * gather local ip addresses and create a udp port. If port creation succeeded then create a new candidate
  * and store it in localCandidates. Ips that are already a local candidate will not be added again.
@@ -401,30 +499,85 @@ STATUS iceAgentShutdown(PIceAgent);
 STATUS iceAgentRestart(PIceAgent, PCHAR, PCHAR);
 
 STATUS iceAgentReportNewLocalCandidate(PIceAgent, PIceCandidate);
+
+/**
+ * Publishes the data sending path of pDataSendingIceCandidatePair and retires the previous one without waiting for
+ * the senders still using it. Must be called with the ice agent lock held every time pDataSendingIceCandidatePair
+ * or its state changes. The socket and turn connection of a retired path must outlive iceAgentWaitForDataSendingPaths.
+ *
+ * @param - PIceAgent - IN - IceAgent object
+ *
+ * @return - STATUS - status of execution
+ */
+STATUS iceAgentPublishDataSendingPath(PIceAgent);
+
+/**
+ * Frees the retired data sending paths no sender can hold anymore. Never blocks, must be called with the ice agent lock held.
+ *
+ * @param - PIceAgent - IN - IceAgent object
+ *
+ * @return - STATUS - status of execution
+ */
+STATUS iceAgentReclaimDataSendingPaths(PIceAgent);
+
+/**
+ * Waits until every retired data sending path is freed. Must be called without the ice agent lock held.
+ *
+ * @param - PIceAgent - IN - IceAgent object
+ *
+ * @return - STATUS - status of execution
+ */
+STATUS iceAgentWaitForDataSendingPaths(PIceAgent);
+
+/**
+ * Stops sending on pDataSendingIceCandidatePair and frees it together with its local candidate once no sender
+ * uses it anymore. Must be called with the ice agent lock held.
+ *
+ * @param - PIceAgent - IN - IceAgent object
+ *
+ * @return - STATUS - status of execution
+ */
+STATUS iceAgentRetireDataSendingPair(PIceAgent);
+
+PIceDataSendingPath iceAgentAcquireDataSendingPath(PIceAgent, PUINT32);
+VOID iceAgentReleaseDataSendingPath(PIceAgent, UINT32);
+STATUS iceDataSendingPathUpdateDiagnostics(PIceDataSendingPath);
+STATUS iceAgentDataSendingSocketClosed(PIceAgent, PSocketConnection);
 STATUS iceAgentValidateKvsRtcConfig(PKvsRtcConfiguration);
 
 // Incoming data handling functions
 STATUS incomingDataHandler(UINT64, PSocketConnection, PBYTE, UINT32, PKvsIpAddress, PKvsIpAddress);
 STATUS incomingRelayedDataHandler(UINT64, PSocketConnection, PBYTE, UINT32, PKvsIpAddress, PKvsIpAddress);
+STATUS incomingSharedRelayedDataHandler(UINT64, PSocketConnection, PBYTE, UINT32, PKvsIpAddress, PKvsIpAddress);
 STATUS handleStunPacket(PIceAgent, PBYTE, UINT32, PSocketConnection, PKvsIpAddress, PKvsIpAddress);
 
 // IceCandidate functions
 STATUS updateCandidateAddress(PIceCandidate, PKvsIpAddress);
 STATUS findCandidateWithIp(PKvsIpAddress, PDoubleList, PIceCandidate*);
 STATUS findCandidateWithSocketConnection(PSocketConnection, PDoubleList, PIceCandidate*);
+// Shared allocations only release the candidate's peers on shutdown. Free must not be called with the ice agent lock held.
+STATUS iceCandidateShutdownTurnConnection(PIceCandidate, UINT64);
+STATUS iceCandidateFreeTurnConnection(PIceCandidate);
 
 // IceCandidatePair functions
 STATUS createIceCandidatePairs(PIceAgent, PIceCandidate, BOOL);
 STATUS freeIceCandidatePair(PIceCandidatePair*);
 STATUS insertIceCandidatePair(PDoubleList, PIceCandidatePair);
+UINT64 iceCandidatePairIndexKey(PSocketConnection, PKvsIpAddress);
+STATUS indexIceCandidatePair(PHashTable, PIceCandidatePair);
+STATUS unindexIceCandidatePair(PHashTable, PIceCandidatePair);
 STATUS findIceCandidatePairWithLocalSocketConnectionAndRemoteAddr(PIceAgent, PSocketConnection, PKvsIpAddress, BOOL, PIceCandidatePair*);
 STATUS pruneUnconnectedIceCandidatePair(PIceAgent);
 STATUS iceCandidatePairCheckConnection(PStunPacket, PIceAgent, PIceCandidatePair);
+STATUS iceAgentSendCandidatePairCheck(PIceAgent, PIceCandidatePair, UINT64);
+STATUS iceAgentSelectFastPathDataSendingPair(PIceAgent);
+STATUS iceAgentHasPendingHigherPriorityPair(PIceAgent, PBOOL);
 
 STATUS iceAgentSendSrflxCandidateRequest(PIceAgent);
 STATUS iceAgentCheckCandidatePairConnection(PIceAgent);
 STATUS iceAgentSendCandidateNomination(PIceAgent);
-STATUS iceAgentSendStunPacket(PStunPacket, PBYTE, UINT32, PIceAgent, PIceCandidate, PKvsIpAddress);
+STATUS iceAgentSendStunPacket(PStunPacket, PKvsSha1HmacKey, PIceAgent, PIceCandidate, PKvsIpAddress);
+STATUS iceAgentSendPackagedStunPacket(PBYTE, UINT32, PIceAgent, PIceCandidate, PKvsIpAddress);
 
 STATUS iceAgentInitHostCandidate(PIceAgent);
 STATUS iceAgentInitSrflxCandidate(PIceAgent);
@@ -320,7 +320,7 @@ STATUS fromConnectedIceAgentState(UINT64 customData, PUINT64 pState)
     STATUS retStatus = STATUS_SUCCESS;
     PIceAgent pIceAgent = (PIceAgent) customData;
     UINT64 state = ICE_AGENT_STATE_CONNECTED; // original state
-    BOOL locked = FALSE;
+    BOOL locked = FALSE, pendingHigherPriorityPair = FALSE;
 
     CHK(pIceAgent != NULL && pState != NULL, STATUS_NULL_ARG);
 
@@ -333,8 +333,15 @@ STATUS fromConnectedIceAgentState(UINT64 customData, PUINT64 pState)
     // return early if changing to disconnected state
     CHK(state != ICE_AGENT_STATE_DISCONNECTED, retStatus);
 
-    // Go directly to nominating state from connected state.
-    state = ICE_AGENT_STATE_NOMINATING;
+    // Go directly to nominating state from connected state. With the first pair fast path, a controlling agent first gives the
+    // pairs better than the one the data is already sent on a chance to succeed so that the best one gets nominated.
+    if (pIceAgent->kvsRtcConfiguration.enableIceFirstPairFastPath && pIceAgent->isControlling && GETTIME() < pIceAgent->stateEndTime) {
+        CHK_STATUS(iceAgentHasPendingHigherPriorityPair(pIceAgent, &pendingHigherPriorityPair));
+    }
+
+    if (!pendingHigherPriorityPair) {
+        state = ICE_AGENT_STATE_NOMINATING;
+    }
 
 CleanUp:
     CHK_LOG_ERR(retStatus);
@@ -367,9 +374,15 @@ STATUS executeConnectedIceAgentState(UINT64 customData, UINT64 time)
 
     CHK(pIceAgent != NULL, STATUS_NULL_ARG);
 
-    CHK_STATUS(iceAgentConnectedStateSetup(pIceAgent));
+    if (pIceAgent->iceAgentState != ICE_AGENT_STATE_CONNECTED) {
+        CHK_STATUS(iceAgentConnectedStateSetup(pIceAgent));
+        pIceAgent->iceAgentState = ICE_AGENT_STATE_CONNECTED;
+    }
 
-    pIceAgent->iceAgentState = ICE_AGENT_STATE_CONNECTED;
+    // keep checking while the first pair fast path waits for a better pair to nominate
+    if (pIceAgent->kvsRtcConfiguration.enableIceFirstPairFastPath) {
+        CHK_STATUS(iceAgentCheckCandidatePairConnection(pIceAgent));
+    }
 
 CleanUp:
     CHK_LOG_ERR(retStatus);
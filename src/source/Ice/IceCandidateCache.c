@@ -0,0 +1,513 @@
+/**
+ * Kinesis Video IceCandidateCache
+ */
+#define LOG_CLASS "IceCandidateCache"
+#include "../Include_i.h"
+
+#ifdef KVS_ICE_CANDIDATE_CACHE_NETLINK_SUPPORTED
+#include <linux/netlink.h>
+#include <linux/rtnetlink.h>
+#endif
+
+PIceCandidateCache getIceCandidateCacheInstance(VOID)
+{
+    static IceCandidateCache cache = {.isInitialized = FALSE,
+                                      .lock = INVALID_MUTEX_VALUE,
+                                      .timerQueueHandle = INVALID_TIMER_QUEUE_HANDLE_VALUE,
+                                      .netlinkSocket = -1,
+                                      .interfacesStale = TRUE,
+                                      .interfaceCount = 0,
+                                      .hostCount = 0};
+    return &cache;
+}
+
+STATUS createIceCandidateCache(VOID)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    PIceCandidateCache pCache = getIceCandidateCacheInstance();
+
+    CHK_WARN(!pCache->isInitialized, retStatus, "Ice candidate cache already set up. Nothing to do");
+
+    pCache->lock = MUTEX_CREATE(FALSE);
+    CHK(IS_VALID_MUTEX_VALUE(pCache->lock), STATUS_INVALID_OPERATION);
+    pCache->netlinkSocket = -1;
+    pCache->interfacesStale = TRUE;
+    pCache->interfacesExpirationTime = 0;
+    pCache->interfaceCount = 0;
+    pCache->sendBufSize = 0;
+    pCache->hostCount = 0;
+    pCache->isInitialized = TRUE;
+
+CleanUp:
+
+    if (STATUS_FAILED(retStatus)) {
+        freeIceCandidateCache();
+    }
+
+    return retStatus;
+}
+
+static VOID iceCandidateCacheFreeSockets(PIceCandidateCacheInterface pInterface)
+{
+    UINT32 i;
+
+    for (i = 0; i < pInterface->socketCount; ++i) {
+        CHK_LOG_ERR(freeSocketConnection(&pInterface->sockets[i]));
+    }
+
+    pInterface->socketCount = 0;
+}
+
+STATUS freeIceCandidateCache(VOID)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    PIceCandidateCache pCache = getIceCandidateCacheInstance();
+    UINT32 i;
+
+    // waits for a refresh that is running
+    if (IS_VALID_TIMER_QUEUE_HANDLE(pCache->timerQueueHandle)) {
+        timerQueueFree(&pCache->timerQueueHandle);
+        pCache->timerQueueHandle = INVALID_TIMER_QUEUE_HANDLE_VALUE;
+    }
+
+    for (i = 0; i < pCache->interfaceCount; ++i) {
+        iceCandidateCacheFreeSockets(&pCache->interfaces[i]);
+    }
+
+    pCache->interfaceCount = 0;
+    pCache->interfacesStale = TRUE;
+    pCache->hostCount = 0;
+    pCache->sendBufSize = 0;
+
+    if (pCache->netlinkSocket >= 0) {
+        CHK_LOG_ERR(closeSocket(pCache->netlinkSocket));
+        pCache->netlinkSocket = -1;
+    }
+
+    if (IS_VALID_MUTEX_VALUE(pCache->lock)) {
+        MUTEX_FREE(pCache->lock);
+        // reset so the cache can be set up again after deinitKvsWebRtc
+        pCache->lock = INVALID_MUTEX_VALUE;
+    }
+
+    pCache->isInitialized = FALSE;
+
+    return retStatus;
+}
+
+/*
+ * Subscribes to link and address changes. Failing is not fatal, the interface list is then only refreshed by age.
+ */
+static VOID iceCandidateCacheOpenNetlink(PIceCandidateCache pCache)
+{
+#ifdef KVS_ICE_CANDIDATE_CACHE_NETLINK_SUPPORTED
+    struct sockaddr_nl netlinkAddr;
+    INT32 netlinkSocket;
+
+    // Assume holding pCache->lock
+    netlinkSocket = socket(AF_NETLINK, SOCK_RAW | SOCK_NONBLOCK | SOCK_CLOEXEC, NETLINK_ROUTE);
+    if (netlinkSocket < 0) {
+        DLOGW("Failed to open netlink socket with errno %s, local interfaces are enumerated every %u seconds",
+              getErrorString(getErrorCode()), (UINT32) (ICE_CANDIDATE_CACHE_INTERFACE_TTL / HUNDREDS_OF_NANOS_IN_A_SECOND));
+        return;
+    }
+
+    MEMSET(&netlinkAddr, 0x00, SIZEOF(netlinkAddr));
+    netlinkAddr.nl_family = AF_NETLINK;
+    netlinkAddr.nl_groups = RTMGRP_LINK | RTMGRP_IPV4_IFADDR | RTMGRP_IPV6_IFADDR;
+    if (bind(netlinkSocket, (struct sockaddr*) &netlinkAddr, SIZEOF(netlinkAddr)) < 0) {
+        DLOGW("Failed to bind netlink socket with errno %s, local interfaces are enumerated every %u seconds",
+              getErrorString(getErrorCode()), (UINT32) (ICE_CANDIDATE_CACHE_INTERFACE_TTL / HUNDREDS_OF_NANOS_IN_A_SECOND));
+        closeSocket(netlinkSocket);
+        return;
+    }
+
+    pCache->netlinkSocket = netlinkSocket;
+#else
+    UNUSED_PARAM(pCache);
+#endif
+}
+
+/*
+ * Marks the interface list stale if the kernel sent any notification since the last check. What changed does not
+ * matter, the list is enumerated again either way.
+ */
+static VOID iceCandidateCacheCheckNetlink(PIceCandidateCache pCache)
+{
+#ifdef KVS_ICE_CANDIDATE_CACHE_NETLINK_SUPPORTED
+    BYTE buffer[ICE_CANDIDATE_CACHE_NETLINK_BUFFER_LEN];
+    ssize_t received = 0;
+
+    // Assume holding pCache->lock
+    if (pCache->netlinkSocket < 0) {
+        return;
+    }
+
+    while ((received = recv(pCache->netlinkSocket, buffer, SIZEOF(buffer), MSG_DONTWAIT)) > 0) {
+        pCache->interfacesStale = TRUE;
+    }
+
+    // notifications were dropped, something changed
+    if (received < 0 && errno == ENOBUFS) {
+        pCache->interfacesStale = TRUE;
+    }
+#else
+    UNUSED_PARAM(pCache);
+#endif
+}
+
+/*
+ * Enumerates the local interfaces again. Sockets bound to addresses that are still there are kept.
+ */
+static STATUS iceCandidateCacheRefreshInterfaces(PIceCandidateCache pCache, UINT64 currentTime)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    KvsIpAddress ipAddresses[MAX_LOCAL_NETWORK_INTERFACE_COUNT];
+    UINT32 ipCount = ARRAY_SIZE(ipAddresses), i, j;
+    BOOL found;
+
+    // Assume holding pCache->lock
+    CHK_STATUS(getLocalhostIpAddresses(ipAddresses, &ipCount, NULL, 0));
+
+    // drop the addresses that are gone, keeping the order of the others
+    for (i = 0; i < pCache->interfaceCount;) {
+        found = FALSE;
+        for (j = 0; j < ipCount && !found; ++j) {
+            found = isSameIpAddress(&pCache->interfaces[i].ipAddress, &ipAddresses[j], FALSE);
+        }
+
+        if (found) {
+            i++;
+        } else {
+            iceCandidateCacheFreeSockets(&pCache->interfaces[i]);
+            MEMMOVE(&pCache->interfaces[i], &pCache->interfaces[i + 1], (pCache->interfaceCount - i - 1) * SIZEOF(IceCandidateCacheInterface));
+            pCache->interfaceCount--;
+        }
+    }
+
+    for (j = 0; j < ipCount; ++j) {
+        found = FALSE;
+        for (i = 0; i < pCache->interfaceCount && !found; ++i) {
+            if (isSameIpAddress(&pCache->interfaces[i].ipAddress, &ipAddresses[j], FALSE)) {
+                // flags such as isPointToPoint may have changed
+                pCache->interfaces[i].ipAddress = ipAddresses[j];
+                pCache->interfaces[i].bindFailed = FALSE;
+                found = TRUE;
+            }
+        }
+
+        if (!found && pCache->interfaceCount < ARRAY_SIZE(pCache->interfaces)) {
+            MEMSET(&pCache->interfaces[pCache->interfaceCount], 0x00, SIZEOF(IceCandidateCacheInterface));
+            pCache->interfaces[pCache->interfaceCount].ipAddress = ipAddresses[j];
+            pCache->interfaceCount++;
+        }
+    }
+
+    pCache->interfacesStale = FALSE;
+    pCache->interfacesExpirationTime = currentTime + ICE_CANDIDATE_CACHE_INTERFACE_TTL;
+
+CleanUp:
+
+    CHK_LOG_ERR(retStatus);
+
+    return retStatus;
+}
+
+static PIceCandidateCacheHost iceCandidateCacheFindHost(PIceCandidateCache pCache, PCHAR hostname)
+{
+    UINT32 i;
+
+    // Assume holding pCache->lock
+    for (i = 0; i < pCache->hostCount; ++i) {
+        if (STRCMP(pCache->hosts[i].hostname, hostname) == 0) {
+            return &pCache->hosts[i];
+        }
+    }
+
+    return NULL;
+}
+
+STATUS iceCandidateCacheGetLocalIpAddresses(PKvsIpAddress destIpList, PUINT32 pDestIpListLen, UINT32 sendBufSize)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    PIceCandidateCache pCache = getIceCandidateCacheInstance();
+    UINT64 currentTime = GETTIME();
+    UINT32 i, timerId;
+    BOOL locked = FALSE;
+
+    CHK(destIpList != NULL && pDestIpListLen != NULL, STATUS_NULL_ARG);
+    CHK(*pDestIpListLen != 0, STATUS_INVALID_ARG);
+
+    // the lock only exists between initKvsWebRtc and deinitKvsWebRtc
+    CHK_ERR(pCache->isInitialized, STATUS_INVALID_OPERATION, "Ice candidate cache not initialized yet");
+
+    MUTEX_LOCK(pCache->lock);
+    locked = TRUE;
+
+    // nothing is started until somebody opts in
+    if (!IS_VALID_TIMER_QUEUE_HANDLE(pCache->timerQueueHandle)) {
+        pCache->sendBufSize = sendBufSize;
+        iceCandidateCacheOpenNetlink(pCache);
+        CHK_STATUS(timerQueueCreate(&pCache->timerQueueHandle));
+        CHK_STATUS(timerQueueAddTimer(pCache->timerQueueHandle, KVS_ICE_DEFAULT_TIMER_START_DELAY, ICE_CANDIDATE_CACHE_REFRESH_PERIOD,
+                                      iceCandidateCacheRefreshCallback, (UINT64) pCache, &timerId));
+    }
+
+    iceCandidateCacheCheckNetlink(pCache);
+    if (pCache->interfacesStale || currentTime >= pCache->interfacesExpirationTime) {
+        CHK_STATUS(iceCandidateCacheRefreshInterfaces(pCache, currentTime));
+    }
+
+    for (i = 0; i < pCache->interfaceCount && i < *pDestIpListLen; ++i) {
+        destIpList[i] = pCache->interfaces[i].ipAddress;
+    }
+
+    *pDestIpListLen = i;
+
+CleanUp:
+
+    CHK_LOG_ERR(retStatus);
+
+    if (locked) {
+        MUTEX_UNLOCK(pCache->lock);
+    }
+
+    LEAVES();
+    return retStatus;
+}
+
+STATUS iceCandidateCacheTakeSocket(PKvsIpAddress pBindAddr, UINT64 customData, ConnectionDataAvailableFunc dataAvailableFn, UINT32 sendBufSize,
+                                   PSocketConnection* ppSocketConnection)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    PIceCandidateCache pCache = getIceCandidateCacheInstance();
+    PIceCandidateCacheInterface pInterface = NULL;
+    PSocketConnection pSocketConnection = NULL;
+    UINT32 i;
+    BOOL locked = FALSE;
+
+    CHK(pBindAddr != NULL && ppSocketConnection != NULL, STATUS_NULL_ARG);
+
+    // the lock only exists between initKvsWebRtc and deinitKvsWebRtc
+    CHK_ERR(pCache->isInitialized, STATUS_INVALID_OPERATION, "Ice candidate cache not initialized yet");
+
+    MUTEX_LOCK(pCache->lock);
+    locked = TRUE;
+
+    // the pooled sockets were created with the send buffer size of the first ice agent
+    if (sendBufSize == pCache->sendBufSize) {
+        for (i = 0; i < pCache->interfaceCount && pSocketConnection == NULL; ++i) {
+            pInterface = &pCache->interfaces[i];
+            if (pInterface->socketCount > 0 && isSameIpAddress(&pInterface->ipAddress, pBindAddr, FALSE)) {
+                pSocketConnection = pInterface->sockets[--pInterface->socketCount];
+                pInterface->sockets[pInterface->socketCount] = NULL;
+            }
+        }
+    }
+
+    MUTEX_UNLOCK(pCache->lock);
+    locked = FALSE;
+
+    if (pSocketConnection == NULL) {
+        CHK_STATUS(createSocketConnection(pBindAddr->family, KVS_SOCKET_PROTOCOL_UDP, pBindAddr, NULL, customData, dataAvailableFn, sendBufSize,
+                                          &pSocketConnection));
+    } else {
+        // not added to a connection listener yet, nothing is receiving on it
+        MUTEX_LOCK(pSocketConnection->lock);
+        pSocketConnection->dataAvailableCallbackCustomData = customData;
+        pSocketConnection->dataAvailableCallbackFn = dataAvailableFn;
+        MUTEX_UNLOCK(pSocketConnection->lock);
+        pBindAddr->port = pSocketConnection->hostIpAddr.port;
+    }
+
+    *ppSocketConnection = pSocketConnection;
+
+CleanUp:
+
+    if (locked) {
+        MUTEX_UNLOCK(pCache->lock);
+    }
+
+    LEAVES();
+    return retStatus;
+}
+
+STATUS iceCandidateCacheResolveHost(UINT64 customData, PCHAR hostname, PKvsIpAddress pIpAddress)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    PIceCandidateCache pCache = getIceCandidateCacheInstance();
+    PIceCandidateCacheHost pHost = NULL;
+    KvsIpAddress ipAddress;
+    UINT64 currentTime = GETTIME();
+    UINT32 i;
+    BOOL locked = FALSE;
+
+    UNUSED_PARAM(customData);
+    CHK(hostname != NULL && pIpAddress != NULL, STATUS_NULL_ARG);
+
+    // the lock only exists between initKvsWebRtc and deinitKvsWebRtc
+    CHK_ERR(pCache->isInitialized, STATUS_INVALID_OPERATION, "Ice candidate cache not initialized yet");
+
+    MUTEX_LOCK(pCache->lock);
+    locked = TRUE;
+
+    pHost = iceCandidateCacheFindHost(pCache, hostname);
+    if (pHost != NULL && currentTime < pHost->expirationTime) {
+        pHost->lastAccessTime = currentTime;
+        *pIpAddress = pHost->ipAddress;
+        CHK(FALSE, retStatus);
+    }
+
+    MUTEX_UNLOCK(pCache->lock);
+    locked = FALSE;
+
+    // other host names can be looked up while waiting on the dns server
+    MEMSET(&ipAddress, 0x00, SIZEOF(KvsIpAddress));
+    CHK_STATUS(getIpWithHostName(hostname, &ipAddress));
+
+    MUTEX_LOCK(pCache->lock);
+    locked = TRUE;
+
+    if ((pHost = iceCandidateCacheFindHost(pCache, hostname)) == NULL) {
+        if (pCache->hostCount < ARRAY_SIZE(pCache->hosts)) {
+            pHost = &pCache->hosts[pCache->hostCount++];
+        } else {
+            // replace the least recently used
+            pHost = &pCache->hosts[0];
+            for (i = 1; i < pCache->hostCount; ++i) {
+                if (pCache->hosts[i].lastAccessTime < pHost->lastAccessTime) {
+                    pHost = &pCache->hosts[i];
+                }
+            }
+        }
+
+        STRNCPY(pHost->hostname, hostname, MAX_ICE_CONFIG_URI_LEN);
+        pHost->hostname[MAX_ICE_CONFIG_URI_LEN] = '\0';
+    }
+
+    pHost->ipAddress = ipAddress;
+    pHost->expirationTime = currentTime + ICE_CANDIDATE_CACHE_HOST_TTL;
+    pHost->lastAccessTime = currentTime;
+    *pIpAddress = ipAddress;
+
+CleanUp:
+
+    if (locked) {
+        MUTEX_UNLOCK(pCache->lock);
+    }
+
+    LEAVES();
+    return retStatus;
+}
+
+/*
+ * Re-resolves at most one host name past half of its ttl so lookups keep hitting the cache. Host names not looked up
+ * for ICE_CANDIDATE_CACHE_HOST_IDLE_TIMEOUT are dropped.
+ */
+static STATUS iceCandidateCacheRefreshHosts(PIceCandidateCache pCache, UINT64 currentTime)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    PIceCandidateCacheHost pHost = NULL;
+    CHAR hostname[MAX_ICE_CONFIG_URI_LEN + 1];
+    KvsIpAddress ipAddress;
+    UINT32 i;
+    BOOL locked = FALSE;
+
+    hostname[0] = '\0';
+
+    MUTEX_LOCK(pCache->lock);
+    locked = TRUE;
+
+    for (i = 0; i < pCache->hostCount;) {
+        pHost = &pCache->hosts[i];
+        if (currentTime > pHost->lastAccessTime + ICE_CANDIDATE_CACHE_HOST_IDLE_TIMEOUT) {
+            pCache->hosts[i] = pCache->hosts[--pCache->hostCount];
+        } else {
+            if (hostname[0] == '\0' && currentTime + ICE_CANDIDATE_CACHE_HOST_TTL / 2 >= pHost->expirationTime) {
+                STRCPY(hostname, pHost->hostname);
+            }
+            i++;
+        }
+    }
+
+    CHK(hostname[0] != '\0', retStatus);
+
+    MUTEX_UNLOCK(pCache->lock);
+    locked = FALSE;
+
+    MEMSET(&ipAddress, 0x00, SIZEOF(KvsIpAddress));
+    // the cached address keeps being used until it expires, it is retried on the next refresh
+    CHK_STATUS(getIpWithHostName(hostname, &ipAddress));
+
+    MUTEX_LOCK(pCache->lock);
+    locked = TRUE;
+
+    if ((pHost = iceCandidateCacheFindHost(pCache, hostname)) != NULL) {
+        pHost->ipAddress = ipAddress;
+        pHost->expirationTime = currentTime + ICE_CANDIDATE_CACHE_HOST_TTL;
+    }
+
+CleanUp:
+
+    if (locked) {
+        MUTEX_UNLOCK(pCache->lock);
+    }
+
+    return retStatus;
+}
+
+STATUS iceCandidateCacheRefreshCallback(UINT32 timerId, UINT64 currentTime, UINT64 customData)
+{
+    UNUSED_PARAM(timerId);
+    STATUS retStatus = STATUS_SUCCESS;
+    PIceCandidateCache pCache = (PIceCandidateCache) customData;
+    PIceCandidateCacheInterface pInterface = NULL;
+    PSocketConnection pSocketConnection = NULL;
+    KvsIpAddress bindAddress;
+    UINT32 i;
+    BOOL locked = FALSE;
+
+    CHK(pCache != NULL, STATUS_NULL_ARG);
+
+    MUTEX_LOCK(pCache->lock);
+    locked = TRUE;
+
+    CHK(pCache->isInitialized, retStatus);
+
+    // refreshed ahead of expiry so ice agents never enumerate the interfaces themselves
+    iceCandidateCacheCheckNetlink(pCache);
+    if (pCache->interfacesStale || currentTime + ICE_CANDIDATE_CACHE_REFRESH_PERIOD >= pCache->interfacesExpirationTime) {
+        CHK_LOG_ERR(iceCandidateCacheRefreshInterfaces(pCache, currentTime));
+    }
+
+    // binding a udp socket is quick, the pools are topped up with the lock held
+    for (i = 0; i < pCache->interfaceCount; ++i) {
+        pInterface = &pCache->interfaces[i];
+        while (!pInterface->bindFailed && pInterface->socketCount < ICE_CANDIDATE_CACHE_SOCKETS_PER_INTERFACE) {
+            bindAddress = pInterface->ipAddress;
+            if (STATUS_FAILED(createSocketConnection(bindAddress.family, KVS_SOCKET_PROTOCOL_UDP, &bindAddress, NULL, 0, NULL, pCache->sendBufSize,
+                                                     &pSocketConnection))) {
+                // not retried until the interfaces are enumerated again
+                pInterface->bindFailed = TRUE;
+            } else {
+                pInterface->sockets[pInterface->socketCount++] = pSocketConnection;
+            }
+        }
+    }
+
+    MUTEX_UNLOCK(pCache->lock);
+    locked = FALSE;
+
+    CHK_LOG_ERR(iceCandidateCacheRefreshHosts(pCache, currentTime));
+
+CleanUp:
+
+    if (locked) {
+        MUTEX_UNLOCK(pCache->lock);
+    }
+
+    return retStatus;
+}
@@ -0,0 +1,139 @@
+/*******************************************
+IceCandidateCache internal include file
+*******************************************/
+#ifndef __KINESIS_VIDEO_WEBRTC_CLIENT_ICE_CANDIDATE_CACHE__
+#define __KINESIS_VIDEO_WEBRTC_CLIENT_ICE_CANDIDATE_CACHE__
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Interface address changes are pushed by the kernel over a route netlink socket on Linux, elsewhere the list is only refreshed by age
+#if defined(__linux__)
+#define KVS_ICE_CANDIDATE_CACHE_NETLINK_SUPPORTED
+#endif
+
+// Number of bound udp sockets kept ready per local interface address
+#define ICE_CANDIDATE_CACHE_SOCKETS_PER_INTERFACE 4
+
+// Max age of the cached local interface list
+#define ICE_CANDIDATE_CACHE_INTERFACE_TTL (30 * HUNDREDS_OF_NANOS_IN_A_SECOND)
+
+// How long a resolved ice server address is used before it is resolved again. getaddrinfo does not return the record ttl
+#define ICE_CANDIDATE_CACHE_HOST_TTL (5 * HUNDREDS_OF_NANOS_IN_A_MINUTE)
+
+// Resolved addresses nobody looked up for this long are dropped instead of being refreshed
+#define ICE_CANDIDATE_CACHE_HOST_IDLE_TIMEOUT (15 * HUNDREDS_OF_NANOS_IN_A_MINUTE)
+
+// Max number of ice server host names kept
+#define ICE_CANDIDATE_CACHE_MAX_HOST_COUNT 16
+
+// Period of the background refresh that tops up the socket pools and re-resolves addresses about to expire
+#define ICE_CANDIDATE_CACHE_REFRESH_PERIOD (1 * HUNDREDS_OF_NANOS_IN_A_SECOND)
+
+#define ICE_CANDIDATE_CACHE_NETLINK_BUFFER_LEN 4096
+
+/**
+ * A local interface address and the sockets already bound to it
+ */
+typedef struct {
+    // port is always 0
+    KvsIpAddress ipAddress;
+    PSocketConnection sockets[ICE_CANDIDATE_CACHE_SOCKETS_PER_INTERFACE];
+    UINT32 socketCount;
+    // Binding failed, not retried until the interfaces are enumerated again
+    BOOL bindFailed;
+} IceCandidateCacheInterface, *PIceCandidateCacheInterface;
+
+typedef struct {
+    CHAR hostname[MAX_ICE_CONFIG_URI_LEN + 1];
+    KvsIpAddress ipAddress;
+    UINT64 expirationTime;
+    UINT64 lastAccessTime;
+} IceCandidateCacheHost, *PIceCandidateCacheHost;
+
+/**
+ * Process wide cache of what every ice agent gathers the same way: the local interface addresses, udp sockets bound to
+ * them and the addresses of the ice servers. Nothing is cached and no refresh timer runs until an ice agent with
+ * KvsRtcConfiguration.enableIceCandidateCache uses it.
+ */
+typedef struct {
+    BOOL isInitialized;
+    MUTEX lock;
+    TIMER_QUEUE_HANDLE timerQueueHandle;
+    // Route netlink socket subscribed to link and address changes, -1 if not supported or not opened yet
+    INT32 netlinkSocket;
+    // Interface list needs to be enumerated again before being used
+    BOOL interfacesStale;
+    UINT64 interfacesExpirationTime;
+    IceCandidateCacheInterface interfaces[MAX_LOCAL_NETWORK_INTERFACE_COUNT];
+    UINT32 interfaceCount;
+    // Send buffer size the pooled sockets are created with, taken from the first ice agent using the cache
+    UINT32 sendBufSize;
+    IceCandidateCacheHost hosts[ICE_CANDIDATE_CACHE_MAX_HOST_COUNT];
+    UINT32 hostCount;
+} IceCandidateCache, *PIceCandidateCache;
+
+PIceCandidateCache getIceCandidateCacheInstance(VOID);
+
+/**
+ * Sets up the process wide cache. Called by initKvsWebRtc
+ *
+ * @return - STATUS code of the execution
+ */
+STATUS createIceCandidateCache(VOID);
+
+/**
+ * Stops the refresh and closes the pooled sockets. Called by deinitKvsWebRtc
+ *
+ * @return - STATUS code of the execution
+ */
+STATUS freeIceCandidateCache(VOID);
+
+/**
+ * Same as getLocalhostIpAddresses without an interface filter, from the cached list. The list is enumerated again
+ * when the kernel reports an interface or address change or after ICE_CANDIDATE_CACHE_INTERFACE_TTL. The first call
+ * starts the background refresh.
+ *
+ * @param - PKvsIpAddress - OUT - Local interface addresses
+ * @param - PUINT32 - IN/OUT - Capacity of the list, set to the number of addresses
+ * @param - UINT32 - IN - Send buffer size for the pooled sockets
+ *
+ * @return - STATUS code of the execution
+ */
+STATUS iceCandidateCacheGetLocalIpAddresses(PKvsIpAddress, PUINT32, UINT32);
+
+/**
+ * Hands out a udp socket already bound to the address with the callback set, or creates one like createSocketConnection
+ * when the pool of the address is empty. The bound port is written back to the address.
+ *
+ * @param - PKvsIpAddress - IN/OUT - Local interface address
+ * @param - UINT64 - IN - data available callback custom data
+ * @param - ConnectionDataAvailableFunc - IN - data available callback
+ * @param - UINT32 - IN - send buffer size in bytes
+ * @param - PSocketConnection* - OUT - the socket, owned by the caller
+ *
+ * @return - STATUS code of the execution
+ */
+STATUS iceCandidateCacheTakeSocket(PKvsIpAddress, UINT64, ConnectionDataAvailableFunc, UINT32, PSocketConnection*);
+
+/**
+ * IceServerSetIpFunc resolving ice server host names through the cache. An address is resolved with getIpWithHostName
+ * the first time it is looked up and refreshed in the background before ICE_CANDIDATE_CACHE_HOST_TTL runs out.
+ *
+ * @param - UINT64 - IN - unused
+ * @param - PCHAR - IN - host name
+ * @param - PKvsIpAddress - OUT - resolved address, port not set
+ *
+ * @return - STATUS code of the execution
+ */
+STATUS iceCandidateCacheResolveHost(UINT64, PCHAR, PKvsIpAddress);
+
+STATUS iceCandidateCacheRefreshCallback(UINT32, UINT64, UINT64);
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* __KINESIS_VIDEO_WEBRTC_CLIENT_ICE_CANDIDATE_CACHE__ */
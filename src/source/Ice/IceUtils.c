@@ -161,6 +161,25 @@ CleanUp:
     return retStatus;
 }
 
+STATUS iceUtilsPackageStunPacketWithHmacKey(PStunPacket pStunPacket, PKvsSha1HmacKey pHmacKey, PBYTE pBuffer, PUINT32 pBufferLen)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    UINT32 stunPacketSize = 0;
+
+    CHK(pStunPacket != NULL && pBuffer != NULL && pBufferLen != NULL, STATUS_NULL_ARG);
+
+    CHK_STATUS(serializeStunPacketWithHmacKey(pStunPacket, pHmacKey, pHmacKey != NULL, TRUE, NULL, &stunPacketSize));
+    CHK(stunPacketSize <= *pBufferLen, STATUS_BUFFER_TOO_SMALL);
+    CHK_STATUS(serializeStunPacketWithHmacKey(pStunPacket, pHmacKey, pHmacKey != NULL, TRUE, pBuffer, &stunPacketSize));
+    *pBufferLen = stunPacketSize;
+
+CleanUp:
+
+    CHK_LOG_ERR(retStatus);
+
+    return retStatus;
+}
+
 STATUS iceUtilsSendStunPacket(PStunPacket pStunPacket, PBYTE password, UINT32 passwordLen, PKvsIpAddress pDest, PSocketConnection pSocketConnection,
                               PTurnConnection pTurnConnection, BOOL useTurn)
 {
@@ -169,8 +188,40 @@ STATUS iceUtilsSendStunPacket(PStunPacket pStunPacket, PBYTE password, UINT32 pa
     BYTE stunPacketBuffer[STUN_PACKET_ALLOCATION_SIZE];
 
     CHK_STATUS(iceUtilsPackageStunPacket(pStunPacket, password, passwordLen, stunPacketBuffer, &stunPacketSize));
-    CHK(pDest != NULL, STATUS_NULL_ARG);
-    switch (pStunPacket->header.stunMessageType) {
+    CHK_STATUS(iceUtilsSendPackagedStunPacket(stunPacketBuffer, stunPacketSize, pDest, pSocketConnection, pTurnConnection, useTurn));
+
+CleanUp:
+
+    CHK_LOG_ERR(retStatus);
+
+    return retStatus;
+}
+
+STATUS iceUtilsSendStunPacketWithHmacKey(PStunPacket pStunPacket, PKvsSha1HmacKey pHmacKey, PKvsIpAddress pDest, PSocketConnection pSocketConnection,
+                                         PTurnConnection pTurnConnection, BOOL useTurn)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    UINT32 stunPacketSize = STUN_PACKET_ALLOCATION_SIZE;
+    BYTE stunPacketBuffer[STUN_PACKET_ALLOCATION_SIZE];
+
+    CHK_STATUS(iceUtilsPackageStunPacketWithHmacKey(pStunPacket, pHmacKey, stunPacketBuffer, &stunPacketSize));
+    CHK_STATUS(iceUtilsSendPackagedStunPacket(stunPacketBuffer, stunPacketSize, pDest, pSocketConnection, pTurnConnection, useTurn));
+
+CleanUp:
+
+    CHK_LOG_ERR(retStatus);
+
+    return retStatus;
+}
+
+STATUS iceUtilsSendPackagedStunPacket(PBYTE pStunPacketBuffer, UINT32 stunPacketSize, PKvsIpAddress pDest, PSocketConnection pSocketConnection,
+                                      PTurnConnection pTurnConnection, BOOL useTurn)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+
+    CHK(pStunPacketBuffer != NULL && pDest != NULL, STATUS_NULL_ARG);
+    CHK(stunPacketSize >= STUN_HEADER_LEN, STATUS_INVALID_ARG);
+    switch ((UINT16) getInt16(*(PUINT16) pStunPacketBuffer)) {
         case STUN_PACKET_TYPE_BINDING_REQUEST:
             DLOGD("Sending BINDING_REQUEST to ip:%u.%u.%u.%u, port:%u", pDest->address[0], pDest->address[1], pDest->address[2], pDest->address[3],
                   (UINT16) getInt16(pDest->port));
@@ -182,7 +233,7 @@ STATUS iceUtilsSendStunPacket(PStunPacket pStunPacket, PBYTE password, UINT32 pa
         default:
             break;
     }
-    CHK_STATUS(iceUtilsSendData(stunPacketBuffer, stunPacketSize, pDest, pSocketConnection, pTurnConnection, useTurn));
+    CHK_STATUS(iceUtilsSendData(pStunPacketBuffer, stunPacketSize, pDest, pSocketConnection, pTurnConnection, useTurn));
 
 CleanUp:
 
@@ -215,6 +266,38 @@ CleanUp:
     return retStatus;
 }
 
+STATUS iceUtilsSendDataBatch(PBYTE* ppBuffers, PUINT32 pSizes, UINT32 count, UINT32 headroom, UINT32 tailroom, PKvsIpAddress pDest,
+                             PSocketConnection pSocketConnection, PTurnConnection pTurnConnection, PTurnPeer pTurnPeer, BOOL useTurn,
+                             PUINT32 pSentCount)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    UINT32 sentCount = 0;
+
+    CHK(ppBuffers != NULL && pSizes != NULL, STATUS_NULL_ARG);
+    CHK((pSocketConnection != NULL && !useTurn) || (pTurnConnection != NULL && useTurn), STATUS_INVALID_ARG);
+
+    if (useTurn) {
+        // The buffers carry headroom for the ChannelData header, so they are framed in place and batched to the turn server
+        retStatus = turnConnectionSendChannelData(pTurnConnection, pTurnPeer, ppBuffers, pSizes, count, headroom, tailroom, &sentCount);
+    } else {
+        retStatus = socketConnectionSendDataBatch(pSocketConnection, ppBuffers, pSizes, count, pDest, &sentCount);
+    }
+
+    // Fix-up the not-yet-ready socket
+    CHK(STATUS_SUCCEEDED(retStatus) || retStatus == STATUS_SOCKET_CONNECTION_NOT_READY_TO_SEND, retStatus);
+    retStatus = STATUS_SUCCESS;
+
+CleanUp:
+
+    if (pSentCount != NULL) {
+        *pSentCount = sentCount;
+    }
+
+    CHK_LOG_ERR(retStatus);
+
+    return retStatus;
+}
+
 STATUS parseIceServer(PIceServer pIceServer, PCHAR url, PCHAR username, PCHAR credential)
 {
     ENTERS();
@@ -48,7 +48,13 @@ STATUS iceUtilsGenerateTransactionId(PBYTE, UINT32);
 // Stun packaging and sending functions
 STATUS iceUtilsPackageStunPacket(PStunPacket, PBYTE, UINT32, PBYTE, PUINT32);
 STATUS iceUtilsSendStunPacket(PStunPacket, PBYTE, UINT32, PKvsIpAddress, PSocketConnection, struct __TurnConnection*, BOOL);
+// Same as above with the message integrity from a precomputed HMAC key, none if the key is NULL
+STATUS iceUtilsPackageStunPacketWithHmacKey(PStunPacket, PKvsSha1HmacKey, PBYTE, PUINT32);
+STATUS iceUtilsSendStunPacketWithHmacKey(PStunPacket, PKvsSha1HmacKey, PKvsIpAddress, PSocketConnection, struct __TurnConnection*, BOOL);
+STATUS iceUtilsSendPackagedStunPacket(PBYTE, UINT32, PKvsIpAddress, PSocketConnection, struct __TurnConnection*, BOOL);
 STATUS iceUtilsSendData(PBYTE, UINT32, PKvsIpAddress, PSocketConnection, struct __TurnConnection*, BOOL);
+STATUS iceUtilsSendDataBatch(PBYTE*, PUINT32, UINT32, UINT32, UINT32, PKvsIpAddress, PSocketConnection, struct __TurnConnection*,
+                             struct __TurnPeer*, BOOL, PUINT32);
 
 typedef struct {
     BOOL isTurn;
@@ -32,6 +32,16 @@ extern "C" {
 #define NO_SIGNAL_SEND MSG_NOSIGNAL
 #endif
 
+// Batched datagram I/O with sendmmsg()/recvmmsg(), UDP generic segmentation offload and epoll are Linux only
+#if defined(__linux__)
+#define KVS_SOCKET_SEND_BATCH_SUPPORTED
+#define KVS_SOCKET_RECEIVE_BATCH_SUPPORTED
+#define KVS_SOCKET_EPOLL_SUPPORTED
+#ifndef UDP_SEGMENT
+#define UDP_SEGMENT 103
+#endif
+#endif
+
 // Some systems, such as Windows, do not have this value
 #ifndef EAI_SYSTEM
 #define EAI_SYSTEM -11
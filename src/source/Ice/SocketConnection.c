@@ -2,8 +2,18 @@
  * Kinesis Video Tcp
  */
 #define LOG_CLASS "SocketConnection"
+
+// glibc only declares sendmmsg() for GNU builds
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE
+#endif
+
 #include "../Include_i.h"
 
+#ifdef KVS_SOCKET_SEND_BATCH_SUPPORTED
+#include <netinet/udp.h>
+#endif
+
 STATUS createSocketConnection(KVS_IP_FAMILY_TYPE familyType, KVS_SOCKET_PROTOCOL protocol, PKvsIpAddress pBindAddr, PKvsIpAddress pPeerIpAddr,
                               UINT64 customData, ConnectionDataAvailableFunc dataAvailableFn, UINT32 sendBufSize,
                               PSocketConnection* ppSocketConnection)
@@ -240,6 +250,59 @@ CleanUp:
     return retStatus;
 }
 
+STATUS socketConnectionSendDataBatch(PSocketConnection pSocketConnection, PBYTE* ppBufs, PUINT32 pBufLens, UINT32 bufCount, PKvsIpAddress pDestIp,
+                                     PUINT32 pSentCount)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    BOOL locked = FALSE;
+    UINT32 i, sentCount = 0;
+
+    CHK(pSocketConnection != NULL && ppBufs != NULL && pBufLens != NULL, STATUS_NULL_ARG);
+    CHK((pSocketConnection->protocol == KVS_SOCKET_PROTOCOL_TCP || pDestIp != NULL), STATUS_INVALID_ARG);
+
+    // Using a single CHK_WARN might output too much spew in bad network conditions
+    if (ATOMIC_LOAD_BOOL(&pSocketConnection->connectionClosed)) {
+        DLOGW("Warning: Failed to send data. Socket closed already");
+        CHK(FALSE, STATUS_SOCKET_CONNECTION_CLOSED_ALREADY);
+    }
+
+    MUTEX_LOCK(pSocketConnection->lock);
+    locked = TRUE;
+
+    CHK(bufCount > 0, STATUS_INVALID_ARG);
+    for (i = 0; i < bufCount; i++) {
+        CHK(ppBufs[i] != NULL && pBufLens[i] > 0, STATUS_INVALID_ARG);
+    }
+
+    if (pSocketConnection->protocol == KVS_SOCKET_PROTOCOL_UDP) {
+        CHK_STATUS(retStatus = socketSendDataBatchWithRetry(pSocketConnection, ppBufs, pBufLens, bufCount, pDestIp, &sentCount));
+    } else if (pSocketConnection->protocol == KVS_SOCKET_PROTOCOL_TCP) {
+        // Nothing to gain from batching a stream, send the buffers in order
+        for (i = 0; i < bufCount; i++) {
+            if (pSocketConnection->secureConnection) {
+                CHK_STATUS(tlsSessionPutApplicationData(pSocketConnection->pTlsSession, ppBufs[i], pBufLens[i]));
+            } else {
+                CHK_STATUS(socketSendDataWithRetry(pSocketConnection, ppBufs[i], pBufLens[i], NULL, NULL));
+            }
+            sentCount++;
+        }
+    } else {
+        CHECK_EXT(FALSE, "socketConnectionSendDataBatch should not reach here. Nothing is sent.");
+    }
+
+CleanUp:
+
+    if (locked) {
+        MUTEX_UNLOCK(pSocketConnection->lock);
+    }
+
+    if (pSentCount != NULL) {
+        *pSentCount = sentCount;
+    }
+
+    return retStatus;
+}
+
 STATUS socketConnectionReadData(PSocketConnection pSocketConnection, PBYTE pBuf, UINT32 bufferLen, PUINT32 pDataLen)
 {
     STATUS retStatus = STATUS_SUCCESS;
@@ -453,3 +516,187 @@ CleanUp:
 
     return retStatus;
 }
+
+#ifdef KVS_SOCKET_SEND_BATCH_SUPPORTED
+/**
+ * UDP GSO splits one send into segments of the first buffer's size, so every buffer except the last
+ * must be exactly that size and the last one no larger. Returns how many leading buffers fit a single
+ * GSO send within the datagram size and segment count limits, or 0 when GSO would not save anything.
+ */
+static UINT32 socketGsoBatchCount(PUINT32 pBufLens, UINT32 bufCount)
+{
+    UINT32 count = 1, totalLen = pBufLens[0];
+
+    while (count < bufCount && count < MAX_SOCKET_UDP_GSO_SEGMENTS && pBufLens[count] <= pBufLens[0] &&
+           totalLen + pBufLens[count] <= MAX_UDP_PACKET_SIZE) {
+        totalLen += pBufLens[count];
+        count++;
+
+        // A shorter buffer can only close the send
+        if (pBufLens[count - 1] < pBufLens[0]) {
+            break;
+        }
+    }
+
+    return count < 2 ? 0 : count;
+}
+#endif
+
+STATUS socketSendDataBatchWithRetry(PSocketConnection pSocketConnection, PBYTE* ppBufs, PUINT32 pBufLens, UINT32 bufCount, PKvsIpAddress pDestIp,
+                                    PUINT32 pSentCount)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    UINT32 sentCount = 0;
+
+#ifdef KVS_SOCKET_SEND_BATCH_SUPPORTED
+    INT32 socketWriteAttempt = 0;
+    INT32 result = 0;
+    INT32 errorNum = 0;
+    UINT32 i, batchCount, gsoCount;
+    UINT16 gsoSize;
+    BOOL useGso;
+
+    struct pollfd wfds;
+    socklen_t addrLen = 0;
+    struct sockaddr* destAddr = NULL;
+    struct sockaddr_in ipv4Addr;
+    struct sockaddr_in6 ipv6Addr;
+    struct mmsghdr msgs[MAX_SOCKET_SEND_BATCH_SIZE];
+    struct iovec iovs[MAX_SOCKET_SEND_BATCH_SIZE];
+    struct msghdr gsoMsg;
+    struct cmsghdr* pCmsg;
+    CHAR gsoControl[CMSG_SPACE(SIZEOF(UINT16))];
+    CHAR ipAddr[KVS_IP_ADDRESS_STRING_BUFFER_LEN];
+
+    CHK(pSocketConnection != NULL && ppBufs != NULL && pBufLens != NULL && pDestIp != NULL, STATUS_NULL_ARG);
+    CHK(bufCount > 0, STATUS_INVALID_ARG);
+
+    if (IS_IPV4_ADDR(pDestIp)) {
+        addrLen = SIZEOF(ipv4Addr);
+        MEMSET(&ipv4Addr, 0x00, SIZEOF(ipv4Addr));
+        ipv4Addr.sin_family = AF_INET;
+        ipv4Addr.sin_port = pDestIp->port;
+        MEMCPY(&ipv4Addr.sin_addr, pDestIp->address, IPV4_ADDRESS_LENGTH);
+        destAddr = (struct sockaddr*) &ipv4Addr;
+    } else {
+        addrLen = SIZEOF(ipv6Addr);
+        MEMSET(&ipv6Addr, 0x00, SIZEOF(ipv6Addr));
+        ipv6Addr.sin6_family = AF_INET6;
+        ipv6Addr.sin6_port = pDestIp->port;
+        MEMCPY(&ipv6Addr.sin6_addr, pDestIp->address, IPV6_ADDRESS_LENGTH);
+        destAddr = (struct sockaddr*) &ipv6Addr;
+    }
+
+    while (socketWriteAttempt < MAX_SOCKET_WRITE_RETRY && sentCount < bufCount) {
+        batchCount = MIN(bufCount - sentCount, MAX_SOCKET_SEND_BATCH_SIZE);
+        for (i = 0; i < batchCount; i++) {
+            iovs[i].iov_base = ppBufs[sentCount + i];
+            iovs[i].iov_len = pBufLens[sentCount + i];
+        }
+
+        // A full batch of MTU sized packets is larger than a datagram, GSO sends it in chunks that fit
+        gsoCount = pSocketConnection->udpGsoUnsupported ? 0 : socketGsoBatchCount(pBufLens + sentCount, batchCount);
+        useGso = gsoCount != 0;
+        if (useGso) {
+            // One sendmsg() carrying every buffer, the kernel or NIC cuts it back into datagrams of gsoSize
+            MEMSET(&gsoMsg, 0x00, SIZEOF(gsoMsg));
+            MEMSET(gsoControl, 0x00, SIZEOF(gsoControl));
+            gsoMsg.msg_name = destAddr;
+            gsoMsg.msg_namelen = addrLen;
+            gsoMsg.msg_iov = iovs;
+            gsoMsg.msg_iovlen = gsoCount;
+            gsoMsg.msg_control = gsoControl;
+            gsoMsg.msg_controllen = SIZEOF(gsoControl);
+            pCmsg = CMSG_FIRSTHDR(&gsoMsg);
+            pCmsg->cmsg_level = IPPROTO_UDP;
+            pCmsg->cmsg_type = UDP_SEGMENT;
+            pCmsg->cmsg_len = CMSG_LEN(SIZEOF(UINT16));
+            gsoSize = (UINT16) pBufLens[sentCount];
+            MEMCPY(CMSG_DATA(pCmsg), &gsoSize, SIZEOF(UINT16));
+
+            result = (INT32) sendmsg(pSocketConnection->localSocket, &gsoMsg, NO_SIGNAL_SEND);
+            if (result >= 0) {
+                sentCount += gsoCount;
+                continue;
+            }
+
+            errorNum = getErrorCode();
+            if (errorNum == EIO || errorNum == EINVAL || errorNum == ENOPROTOOPT || errorNum == EOPNOTSUPP) {
+                // Not a transient error, stop trying GSO on this socket and resend the batch with sendmmsg()
+                DLOGI("UDP GSO unavailable on socket %d, errno %s(%d)", pSocketConnection->localSocket, getErrorString(errorNum), errorNum);
+                pSocketConnection->udpGsoUnsupported = TRUE;
+                continue;
+            }
+        } else {
+            MEMSET(msgs, 0x00, batchCount * SIZEOF(struct mmsghdr));
+            for (i = 0; i < batchCount; i++) {
+                msgs[i].msg_hdr.msg_name = destAddr;
+                msgs[i].msg_hdr.msg_namelen = addrLen;
+                msgs[i].msg_hdr.msg_iov = &iovs[i];
+                msgs[i].msg_hdr.msg_iovlen = 1;
+            }
+
+            result = sendmmsg(pSocketConnection->localSocket, msgs, batchCount, NO_SIGNAL_SEND);
+            if (result > 0) {
+                // A partial batch is not an error, send the rest on the next round
+                sentCount += (UINT32) result;
+                continue;
+            }
+
+            errorNum = result < 0 ? getErrorCode() : EAGAIN;
+        }
+
+        if (errorNum == EAGAIN || errorNum == EWOULDBLOCK) {
+            MEMSET(&wfds, 0x00, SIZEOF(struct pollfd));
+            wfds.fd = pSocketConnection->localSocket;
+            wfds.events = POLLOUT;
+            wfds.revents = 0;
+            result = POLL(&wfds, 1, SOCKET_SEND_RETRY_TIMEOUT_MILLI_SECOND);
+
+            if (result == 0) {
+                /* loop back and try again */
+                DLOGE("poll() timed out");
+            } else if (result < 0) {
+                DLOGE("poll() failed with errno %s", getErrorString(getErrorCode()));
+                break;
+            }
+        } else if (errorNum == EINTR) {
+            /* nothing need to be done, just retry */
+        } else {
+            /* fatal error from send() */
+            DLOGE("%s() failed with errno %s(%d)", useGso ? "sendmsg" : "sendmmsg", getErrorString(errorNum), errorNum);
+            getIpAddrStr(pDestIp, ipAddr, ARRAY_SIZE(ipAddr));
+            DLOGD("Dest Ip: %s:%u. family:%d", ipAddr, (UINT16) getInt16(pDestIp->port), pDestIp->family);
+            CLOSE_SOCKET_IF_CANT_RETRY(errorNum, pSocketConnection);
+            break;
+        }
+
+        // Indicate an attempt only on error
+        socketWriteAttempt++;
+    }
+
+    if (sentCount < bufCount) {
+        DLOGD("Failed to send data. Packets sent %u. Packet count %u. Retry count %u", sentCount, bufCount, socketWriteAttempt);
+        retStatus = STATUS_SEND_DATA_FAILED;
+    }
+#else
+    CHK(pSocketConnection != NULL && ppBufs != NULL && pBufLens != NULL && pDestIp != NULL, STATUS_NULL_ARG);
+
+    for (; sentCount < bufCount; sentCount++) {
+        CHK_STATUS(socketSendDataWithRetry(pSocketConnection, ppBufs[sentCount], pBufLens[sentCount], pDestIp, NULL));
+    }
+#endif
+
+CleanUp:
+
+    if (pSentCount != NULL) {
+        *pSentCount = sentCount;
+    }
+
+    // CHK_LOG_ERR might be too verbose in this case
+    if (STATUS_FAILED(retStatus)) {
+        DLOGD("Warning: Send data batch failed with 0x%08x", retStatus);
+    }
+
+    return retStatus;
+}
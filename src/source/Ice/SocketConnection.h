@@ -13,6 +13,12 @@ extern "C" {
 #define SOCKET_SEND_RETRY_TIMEOUT_MILLI_SECOND 500
 #define MAX_SOCKET_WRITE_RETRY                 3
 
+// Maximum number of datagrams handed to the kernel by a single sendmmsg() call
+#define MAX_SOCKET_SEND_BATCH_SIZE 64
+
+// Maximum number of segments in a single UDP GSO send, UDP_MAX_SEGMENTS of the kernel
+#define MAX_SOCKET_UDP_GSO_SEGMENTS 64
+
 #define CLOSE_SOCKET_IF_CANT_RETRY(e, ps)                                                                                                            \
     if ((e) != EAGAIN && (e) != EWOULDBLOCK && (e) != EINTR && (e) != EINPROGRESS && (e) != EPERM && (e) != EALREADY && (e) != ENETUNREACH) {        \
         DLOGD("Close socket %d", (ps)->localSocket);                                                                                                 \
@@ -41,6 +47,9 @@ struct __SocketConnection {
 
     MUTEX lock;
 
+    /* Kernel or NIC rejected UDP_SEGMENT, batches fall back to sendmmsg(). Guarded by lock */
+    BOOL udpGsoUnsupported;
+
     ConnectionDataAvailableFunc dataAvailableCallbackFn;
     UINT64 dataAvailableCallbackCustomData;
     UINT64 tlsHandshakeStartTime;
@@ -100,6 +109,22 @@ STATUS socketConnectionInitSecureConnection(PSocketConnection, BOOL);
  */
 STATUS socketConnectionSendData(PSocketConnection, PBYTE, UINT32, PKvsIpAddress);
 
+/**
+ * Send several buffers through the underlying socket in order. UDP datagrams are handed to the kernel in batches
+ * with sendmmsg(), or as UDP GSO sends of up to a datagram worth of equal sized buffers, where the platform
+ * supports it. Stream sockets send each buffer in turn. Destination address rules are the same as socketConnectionSendData.
+ *
+ * @param - PSocketConnection - IN - the SocketConnection struct
+ * @param - PBYTE* - IN - array of buffers containing unencrypted data
+ * @param - PUINT32 - IN - array of buffer lengths
+ * @param - UINT32 - IN - number of buffers
+ * @param - PKvsIpAddress - IN - destination address. Required only if socket type is UDP.
+ * @param - PUINT32 - OUT - number of buffers fully sent (OPTIONAL)
+ *
+ * @return - STATUS - status of execution
+ */
+STATUS socketConnectionSendDataBatch(PSocketConnection, PBYTE*, PUINT32, UINT32, PKvsIpAddress, PUINT32);
+
 /**
  * If PSocketConnection is not secure then nothing happens, otherwise assuming the bytes passed in are encrypted, and
  * the encryted data will be replaced with unencrypted data at function return.
@@ -143,6 +168,7 @@ BOOL socketConnectionIsConnected(PSocketConnection);
 
 // internal functions
 STATUS socketSendDataWithRetry(PSocketConnection, PBYTE, UINT32, PKvsIpAddress, PUINT32);
+STATUS socketSendDataBatchWithRetry(PSocketConnection, PBYTE*, PUINT32, UINT32, PKvsIpAddress, PUINT32);
 STATUS socketConnectionTlsSessionOutBoundPacket(UINT64, PBYTE, UINT32);
 VOID socketConnectionTlsSessionOnStateChange(UINT64, TLS_SESSION_STATE);
 
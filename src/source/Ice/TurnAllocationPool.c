@@ -0,0 +1,467 @@
+/**
+ * Kinesis Video TurnAllocationPool
+ */
+#define LOG_CLASS "TurnAllocationPool"
+#include "../Include_i.h"
+
+PTurnAllocationPool getTurnAllocationPoolInstance(VOID)
+{
+    static TurnAllocationPool pool = {.isInitialized = FALSE,
+                                      .lock = INVALID_MUTEX_VALUE,
+                                      .timerQueueHandle = INVALID_TIMER_QUEUE_HANDLE_VALUE,
+                                      .pConnectionListener = NULL,
+                                      .sharedConnectionListener = FALSE,
+                                      .allocations = NULL};
+    return &pool;
+}
+
+STATUS createTurnAllocationPool(VOID)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    PTurnAllocationPool pPool = getTurnAllocationPoolInstance();
+
+    CHK_WARN(!pPool->isInitialized, retStatus, "Turn allocation pool already set up. Nothing to do");
+
+    pPool->lock = MUTEX_CREATE(FALSE);
+    CHK(IS_VALID_MUTEX_VALUE(pPool->lock), STATUS_INVALID_OPERATION);
+    CHK_STATUS(doubleListCreate(&pPool->allocations));
+    pPool->isInitialized = TRUE;
+
+CleanUp:
+
+    if (STATUS_FAILED(retStatus)) {
+        freeTurnAllocationPool();
+    }
+
+    return retStatus;
+}
+
+static BOOL turnAllocationIsUsable(PTurnAllocation pTurnAllocation)
+{
+    BOOL usable;
+
+    MUTEX_LOCK(pTurnAllocation->pTurnConnection->lock);
+    usable = !ATOMIC_LOAD_BOOL(&pTurnAllocation->pTurnConnection->stopTurnConnection) &&
+        pTurnAllocation->pTurnConnection->state != TURN_STATE_FAILED && pTurnAllocation->pTurnConnection->state != TURN_STATE_CLEAN_UP;
+    MUTEX_UNLOCK(pTurnAllocation->pTurnConnection->lock);
+
+    return usable;
+}
+
+static BOOL turnAllocationMatches(PTurnAllocation pTurnAllocation, PIceServer pTurnServer, KVS_SOCKET_PROTOCOL protocol)
+{
+    return pTurnAllocation->protocol == protocol && isSameIpAddress(&pTurnAllocation->turnServer.ipAddress, &pTurnServer->ipAddress, TRUE) &&
+        STRCMP(pTurnAllocation->turnServer.username, pTurnServer->username) == 0 &&
+        STRCMP(pTurnAllocation->turnServer.credential, pTurnServer->credential) == 0;
+}
+
+static STATUS freeTurnAllocation(PTurnAllocation* ppTurnAllocation)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    PTurnAllocation pTurnAllocation = NULL;
+
+    CHK(ppTurnAllocation != NULL, STATUS_NULL_ARG);
+    CHK(*ppTurnAllocation != NULL, retStatus);
+
+    pTurnAllocation = *ppTurnAllocation;
+
+    if (pTurnAllocation->pTurnConnection != NULL) {
+        CHK_LOG_ERR(turnConnectionShutdown(pTurnAllocation->pTurnConnection, TURN_ALLOCATION_POOL_SHUTDOWN_TIMEOUT));
+        // the socket is removed from the pool's connection listener and freed along with the connection
+        CHK_LOG_ERR(freeTurnConnection(&pTurnAllocation->pTurnConnection));
+    }
+
+    if (pTurnAllocation->subscriptions != NULL) {
+        // subscriptions belong to the ice agents
+        CHK_LOG_ERR(doubleListClear(pTurnAllocation->subscriptions, FALSE));
+        CHK_LOG_ERR(doubleListFree(pTurnAllocation->subscriptions));
+    }
+
+    if (IS_VALID_MUTEX_VALUE(pTurnAllocation->lock)) {
+        MUTEX_FREE(pTurnAllocation->lock);
+    }
+
+    if (IS_VALID_MUTEX_VALUE(pTurnAllocation->subscriptionsLock)) {
+        MUTEX_FREE(pTurnAllocation->subscriptionsLock);
+    }
+
+    MEMFREE(pTurnAllocation);
+    *ppTurnAllocation = NULL;
+
+CleanUp:
+
+    return retStatus;
+}
+
+/*
+ * Takes the allocations nobody subscribed to for TURN_ALLOCATION_POOL_IDLE_TIMEOUT, or that failed, out of the pool.
+ * They are freed by the caller after releasing the pool lock since freeing waits for the turn server.
+ */
+static STATUS turnAllocationPoolCollectIdle(PTurnAllocationPool pPool, BOOL collectAll, PTurnAllocation* idleAllocations, PUINT32 pIdleCount)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    PDoubleListNode pCurNode = NULL, pNextNode = NULL;
+    PTurnAllocation pTurnAllocation = NULL;
+    UINT64 currentTime = GETTIME();
+    UINT32 idleCount = 0;
+
+    // Assume holding pPool->lock
+    CHK_STATUS(doubleListGetHeadNode(pPool->allocations, &pCurNode));
+    while (pCurNode != NULL && idleCount < TURN_ALLOCATION_POOL_MAX_FREE_BATCH) {
+        pTurnAllocation = (PTurnAllocation) pCurNode->data;
+        pNextNode = pCurNode->pNext;
+
+        if (collectAll ||
+            (IS_VALID_TIMESTAMP(pTurnAllocation->idleStartTime) &&
+             (currentTime > pTurnAllocation->idleStartTime + TURN_ALLOCATION_POOL_IDLE_TIMEOUT || !turnAllocationIsUsable(pTurnAllocation)))) {
+            CHK_STATUS(doubleListDeleteNode(pPool->allocations, pCurNode));
+            idleAllocations[idleCount++] = pTurnAllocation;
+        }
+
+        pCurNode = pNextNode;
+    }
+
+CleanUp:
+
+    *pIdleCount = idleCount;
+
+    return retStatus;
+}
+
+STATUS freeTurnAllocationPool(VOID)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    PTurnAllocationPool pPool = getTurnAllocationPoolInstance();
+    PTurnAllocation idleAllocations[TURN_ALLOCATION_POOL_MAX_FREE_BATCH];
+    UINT32 idleCount = 0, i;
+
+    if (pPool->allocations != NULL) {
+        do {
+            MUTEX_LOCK(pPool->lock);
+            CHK_LOG_ERR(turnAllocationPoolCollectIdle(pPool, TRUE, idleAllocations, &idleCount));
+            MUTEX_UNLOCK(pPool->lock);
+
+            for (i = 0; i < idleCount; ++i) {
+                CHK_LOG_ERR(freeTurnAllocation(&idleAllocations[i]));
+            }
+        } while (idleCount > 0);
+
+        CHK_LOG_ERR(doubleListFree(pPool->allocations));
+        pPool->allocations = NULL;
+    }
+
+    // the listener goes first, it receives on sockets of connections driven by the timer queue. The shared one has no
+    // turn sockets left and is freed by deinitKvsWebRtc
+    if (pPool->sharedConnectionListener) {
+        pPool->pConnectionListener = NULL;
+        pPool->sharedConnectionListener = FALSE;
+    } else if (pPool->pConnectionListener != NULL) {
+        CHK_LOG_ERR(freeConnectionListener(&pPool->pConnectionListener));
+    }
+
+    if (IS_VALID_TIMER_QUEUE_HANDLE(pPool->timerQueueHandle)) {
+        timerQueueFree(&pPool->timerQueueHandle);
+        pPool->timerQueueHandle = INVALID_TIMER_QUEUE_HANDLE_VALUE;
+    }
+
+    if (IS_VALID_MUTEX_VALUE(pPool->lock)) {
+        MUTEX_FREE(pPool->lock);
+        // reset so the pool can be set up again after deinitKvsWebRtc
+        pPool->lock = INVALID_MUTEX_VALUE;
+    }
+
+    pPool->isInitialized = FALSE;
+
+    return retStatus;
+}
+
+static STATUS createTurnAllocation(PTurnAllocationPool pPool, PIceServer pTurnServer, KVS_SOCKET_PROTOCOL protocol, UINT32 sendBufSize,
+                                   PTurnAllocation* ppTurnAllocation)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    PTurnAllocation pTurnAllocation = NULL;
+    PSocketConnection pSocketConnection = NULL;
+    TurnConnectionCallbacks callbacks = {0};
+
+    // Assume holding pPool->lock
+    CHK((pTurnAllocation = (PTurnAllocation) MEMCALLOC(1, SIZEOF(TurnAllocation))) != NULL, STATUS_NOT_ENOUGH_MEMORY);
+    pTurnAllocation->turnServer = *pTurnServer;
+    pTurnAllocation->protocol = protocol;
+    pTurnAllocation->idleStartTime = INVALID_TIMESTAMP_VALUE;
+    pTurnAllocation->lock = MUTEX_CREATE(TRUE);
+    CHK(IS_VALID_MUTEX_VALUE(pTurnAllocation->lock), STATUS_INVALID_OPERATION);
+    pTurnAllocation->subscriptionsLock = MUTEX_CREATE(FALSE);
+    CHK(IS_VALID_MUTEX_VALUE(pTurnAllocation->subscriptionsLock), STATUS_INVALID_OPERATION);
+    CHK_STATUS(doubleListCreate(&pTurnAllocation->subscriptions));
+
+    CHK_STATUS(createSocketConnection(KVS_IP_FAMILY_TYPE_IPV4, protocol, NULL, &pTurnServer->ipAddress, (UINT64) pTurnAllocation,
+                                      turnAllocationIncomingDataHandler, sendBufSize, &pSocketConnection));
+    // connectionListener will free the pSocketConnection at the end.
+    CHK_STATUS(connectionListenerAddConnection(pPool->pConnectionListener, pSocketConnection));
+
+    callbacks.customData = (UINT64) pTurnAllocation;
+    callbacks.relayAddressAvailableFn = NULL;
+    callbacks.turnStateFailedFn = turnAllocationStateFailedFn;
+
+    CHK_STATUS(createTurnConnectionWithMaxPeerCount(pTurnServer, pPool->timerQueueHandle, TURN_CONNECTION_DATA_TRANSFER_MODE_DATA_CHANNEL, protocol,
+                                                    &callbacks, pSocketConnection, pPool->pConnectionListener, DEFAULT_TURN_SHARED_MAX_PEER_COUNT,
+                                                    &pTurnAllocation->pTurnConnection));
+    CHK_STATUS(turnConnectionStart(pTurnAllocation->pTurnConnection));
+
+CleanUp:
+
+    CHK_LOG_ERR(retStatus);
+
+    if (STATUS_FAILED(retStatus)) {
+        freeTurnAllocation(&pTurnAllocation);
+    }
+
+    *ppTurnAllocation = pTurnAllocation;
+
+    return retStatus;
+}
+
+STATUS turnAllocationPoolAcquire(PIceServer pTurnServer, KVS_SOCKET_PROTOCOL protocol, UINT32 sendBufSize, UINT32 connectionListenerWorkerCount,
+                                 UINT64 customData, TurnStateFailedFunc turnStateFailedFn, ConnectionDataAvailableFunc channelDataAvailableFn,
+                                 PTurnAllocationSubscription* ppSubscription)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    PTurnAllocationPool pPool = getTurnAllocationPoolInstance();
+    PTurnAllocation pTurnAllocation = NULL, idleAllocations[TURN_ALLOCATION_POOL_MAX_FREE_BATCH];
+    PTurnAllocationSubscription pSubscription = NULL;
+    PDoubleListNode pCurNode = NULL;
+    BOOL locked = FALSE, allocationLocked = FALSE;
+    UINT32 idleCount = 0, i;
+
+    CHK(pTurnServer != NULL && channelDataAvailableFn != NULL && ppSubscription != NULL, STATUS_NULL_ARG);
+    CHK(pTurnServer->isTurn, STATUS_INVALID_ARG);
+
+    MUTEX_LOCK(pPool->lock);
+    locked = TRUE;
+
+    CHK_ERR(pPool->isInitialized, STATUS_INVALID_OPERATION, "Turn allocation pool not initialized yet");
+
+    // nothing is started until somebody opts in
+    if (!IS_VALID_TIMER_QUEUE_HANDLE(pPool->timerQueueHandle)) {
+        CHK_STATUS(timerQueueCreate(&pPool->timerQueueHandle));
+    }
+
+    if (pPool->pConnectionListener == NULL && connectionListenerWorkerCount > 0) {
+        CHK_STATUS(sharedConnectionListenerAcquire(connectionListenerWorkerCount, &pPool->pConnectionListener));
+        pPool->sharedConnectionListener = TRUE;
+    } else if (pPool->pConnectionListener == NULL) {
+        CHK_STATUS(createConnectionListener(&pPool->pConnectionListener));
+        CHK_STATUS(connectionListenerStart(pPool->pConnectionListener));
+    }
+
+    CHK_STATUS(turnAllocationPoolCollectIdle(pPool, FALSE, idleAllocations, &idleCount));
+
+    CHK_STATUS(doubleListGetHeadNode(pPool->allocations, &pCurNode));
+    while (pCurNode != NULL && pTurnAllocation == NULL) {
+        if (turnAllocationMatches((PTurnAllocation) pCurNode->data, pTurnServer, protocol) &&
+            turnAllocationIsUsable((PTurnAllocation) pCurNode->data)) {
+            pTurnAllocation = (PTurnAllocation) pCurNode->data;
+        }
+
+        pCurNode = pCurNode->pNext;
+    }
+
+    if (pTurnAllocation == NULL) {
+        CHK_STATUS(createTurnAllocation(pPool, pTurnServer, protocol, sendBufSize, &pTurnAllocation));
+        retStatus = doubleListInsertItemTail(pPool->allocations, (UINT64) pTurnAllocation);
+        if (STATUS_FAILED(retStatus)) {
+            freeTurnAllocation(&pTurnAllocation);
+            CHK(FALSE, retStatus);
+        }
+
+        DLOGI("Created shared turn allocation %p", pTurnAllocation->pTurnConnection);
+    }
+
+    CHK((pSubscription = (PTurnAllocationSubscription) MEMCALLOC(1, SIZEOF(TurnAllocationSubscription))) != NULL, STATUS_NOT_ENOUGH_MEMORY);
+    pSubscription->customData = customData;
+    pSubscription->turnStateFailedFn = turnStateFailedFn;
+    pSubscription->channelDataAvailableFn = channelDataAvailableFn;
+    pSubscription->pTurnAllocation = pTurnAllocation;
+
+    MUTEX_LOCK(pTurnAllocation->lock);
+    MUTEX_LOCK(pTurnAllocation->subscriptionsLock);
+    allocationLocked = TRUE;
+
+    CHK_STATUS(doubleListInsertItemTail(pTurnAllocation->subscriptions, (UINT64) pSubscription));
+    pTurnAllocation->idleStartTime = INVALID_TIMESTAMP_VALUE;
+
+    *ppSubscription = pSubscription;
+    pSubscription = NULL;
+
+CleanUp:
+
+    CHK_LOG_ERR(retStatus);
+
+    if (allocationLocked) {
+        MUTEX_UNLOCK(pTurnAllocation->subscriptionsLock);
+        MUTEX_UNLOCK(pTurnAllocation->lock);
+    }
+
+    if (locked) {
+        MUTEX_UNLOCK(pPool->lock);
+    }
+
+    for (i = 0; i < idleCount; ++i) {
+        freeTurnAllocation(&idleAllocations[i]);
+    }
+
+    SAFE_MEMFREE(pSubscription);
+
+    LEAVES();
+    return retStatus;
+}
+
+STATUS turnAllocationPoolRelease(PTurnAllocationSubscription* ppSubscription)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    PTurnAllocationPool pPool = getTurnAllocationPoolInstance();
+    PTurnAllocationSubscription pSubscription = NULL;
+    PTurnAllocation pTurnAllocation = NULL, idleAllocations[TURN_ALLOCATION_POOL_MAX_FREE_BATCH];
+    PDoubleListNode pCurNode = NULL;
+    UINT32 subscriptionCount = 0, idleCount = 0, i;
+    BOOL locked = FALSE;
+
+    CHK(ppSubscription != NULL, STATUS_NULL_ARG);
+    // release is idempotent
+    CHK(*ppSubscription != NULL, retStatus);
+
+    pSubscription = *ppSubscription;
+    pTurnAllocation = pSubscription->pTurnAllocation;
+
+    // no new channel data is tagged with the subscription after this
+    CHK_LOG_ERR(turnConnectionReleasePeers(pTurnAllocation->pTurnConnection, (UINT64) pSubscription));
+
+    MUTEX_LOCK(pPool->lock);
+    locked = TRUE;
+
+    // waits for channel data already being handed to the subscription, and for a failure being notified
+    MUTEX_LOCK(pTurnAllocation->lock);
+    MUTEX_LOCK(pTurnAllocation->subscriptionsLock);
+    CHK_LOG_ERR(doubleListGetHeadNode(pTurnAllocation->subscriptions, &pCurNode));
+    while (pCurNode != NULL && pCurNode->data != (UINT64) pSubscription) {
+        pCurNode = pCurNode->pNext;
+    }
+
+    if (pCurNode != NULL) {
+        CHK_LOG_ERR(doubleListDeleteNode(pTurnAllocation->subscriptions, pCurNode));
+    }
+
+    CHK_LOG_ERR(doubleListGetNodeCount(pTurnAllocation->subscriptions, &subscriptionCount));
+    if (subscriptionCount == 0) {
+        pTurnAllocation->idleStartTime = GETTIME();
+    }
+    MUTEX_UNLOCK(pTurnAllocation->subscriptionsLock);
+    MUTEX_UNLOCK(pTurnAllocation->lock);
+
+    CHK_STATUS(turnAllocationPoolCollectIdle(pPool, FALSE, idleAllocations, &idleCount));
+
+CleanUp:
+
+    CHK_LOG_ERR(retStatus);
+
+    if (locked) {
+        MUTEX_UNLOCK(pPool->lock);
+    }
+
+    for (i = 0; i < idleCount; ++i) {
+        freeTurnAllocation(&idleAllocations[i]);
+    }
+
+    if (pSubscription != NULL) {
+        MEMFREE(pSubscription);
+        *ppSubscription = NULL;
+    }
+
+    LEAVES();
+    return retStatus;
+}
+
+static BOOL turnAllocationHasSubscription(PTurnAllocation pTurnAllocation, PTurnAllocationSubscription pSubscription)
+{
+    PDoubleListNode pCurNode = NULL;
+
+    // Assume holding pTurnAllocation->lock or pTurnAllocation->subscriptionsLock
+    doubleListGetHeadNode(pTurnAllocation->subscriptions, &pCurNode);
+    while (pCurNode != NULL && pCurNode->data != (UINT64) pSubscription) {
+        pCurNode = pCurNode->pNext;
+    }
+
+    return pCurNode != NULL;
+}
+
+STATUS turnAllocationIncomingDataHandler(UINT64 customData, PSocketConnection pSocketConnection, PBYTE pBuffer, UINT32 bufferLen, PKvsIpAddress pSrc,
+                                         PKvsIpAddress pDest)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    PTurnAllocation pTurnAllocation = (PTurnAllocation) customData;
+    PTurnAllocationSubscription pSubscription = NULL;
+    // this should be more than enough. Usually the number of channel data in each tcp message is around 4
+    TurnChannelData turnChannelData[DEFAULT_TURN_CHANNEL_DATA_BUFFER_SIZE];
+    UINT32 turnChannelDataCount = ARRAY_SIZE(turnChannelData), i = 0;
+    BOOL locked = FALSE;
+
+    CHK(pTurnAllocation != NULL && pSocketConnection != NULL, STATUS_NULL_ARG);
+
+    // The turn connection lock is taken without the allocation lock, a failure is notified with the turn connection lock held
+    CHK_STATUS(turnConnectionIncomingDataHandler(pTurnAllocation->pTurnConnection, pBuffer, bufferLen, pSrc, pDest, turnChannelData,
+                                                 &turnChannelDataCount));
+
+    MUTEX_LOCK(pTurnAllocation->lock);
+    locked = TRUE;
+
+    for (i = 0; i < turnChannelDataCount; ++i) {
+        // data from a released peer has nobody to go to, the subscription may also have been released since the data was parsed
+        if ((pSubscription = (PTurnAllocationSubscription) turnChannelData[i].customData) != NULL &&
+            turnAllocationHasSubscription(pTurnAllocation, pSubscription)) {
+            pSubscription->channelDataAvailableFn(pSubscription->customData, pSocketConnection, turnChannelData[i].data, turnChannelData[i].size,
+                                                  &turnChannelData[i].senderAddr, NULL);
+        }
+    }
+
+CleanUp:
+
+    CHK_LOG_ERR(retStatus);
+
+    if (locked) {
+        MUTEX_UNLOCK(pTurnAllocation->lock);
+    }
+
+    return retStatus;
+}
+
+STATUS turnAllocationStateFailedFn(PSocketConnection pSocketConnection, UINT64 customData)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    PTurnAllocation pTurnAllocation = (PTurnAllocation) customData;
+    PTurnAllocationSubscription pSubscription = NULL;
+    PDoubleListNode pCurNode = NULL;
+
+    CHK(pTurnAllocation != NULL, STATUS_NULL_ARG);
+
+    // Called by the turn state machine with the turn connection lock held, which channel data delivery takes under
+    // pTurnAllocation->lock. Only the subscriptions lock is safe to take here.
+    MUTEX_LOCK(pTurnAllocation->subscriptionsLock);
+
+    CHK_LOG_ERR(doubleListGetHeadNode(pTurnAllocation->subscriptions, &pCurNode));
+    while (pCurNode != NULL) {
+        pSubscription = (PTurnAllocationSubscription) pCurNode->data;
+        pCurNode = pCurNode->pNext;
+
+        if (pSubscription->turnStateFailedFn != NULL) {
+            pSubscription->turnStateFailedFn(pSocketConnection, pSubscription->customData);
+        }
+    }
+
+    MUTEX_UNLOCK(pTurnAllocation->subscriptionsLock);
+
+CleanUp:
+
+    return retStatus;
+}
@@ -0,0 +1,125 @@
+/*******************************************
+TurnAllocationPool internal include file
+*******************************************/
+#ifndef __KINESIS_VIDEO_WEBRTC_CLIENT_TURN_ALLOCATION_POOL__
+#define __KINESIS_VIDEO_WEBRTC_CLIENT_TURN_ALLOCATION_POOL__
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// How long an allocation nobody uses is kept around for the next ice agent before it is freed
+#define TURN_ALLOCATION_POOL_IDLE_TIMEOUT (30 * HUNDREDS_OF_NANOS_IN_A_SECOND)
+
+// Time given to the turn server to free an allocation that is no longer needed
+#define TURN_ALLOCATION_POOL_SHUTDOWN_TIMEOUT (1 * HUNDREDS_OF_NANOS_IN_A_SECOND)
+
+// Max number of allocations freed at once
+#define TURN_ALLOCATION_POOL_MAX_FREE_BATCH 16
+
+struct __TurnAllocation;
+
+/**
+ * One ice agent using a shared allocation. Its address is the customData of every peer the agent adds, which is how
+ * channel data received on the shared socket finds its way back to the agent.
+ */
+typedef struct __TurnAllocationSubscription {
+    UINT64 customData;
+    TurnStateFailedFunc turnStateFailedFn;
+    // called with the data of every channel data message, the sender as source and no destination
+    ConnectionDataAvailableFunc channelDataAvailableFn;
+    struct __TurnAllocation* pTurnAllocation;
+} TurnAllocationSubscription, *PTurnAllocationSubscription;
+
+/**
+ * A TurnConnection shared by every ice agent that uses the same turn server, transport and credentials. Each agent's
+ * peers get their own channel binding on it.
+ */
+typedef struct __TurnAllocation {
+    IceServer turnServer;
+    KVS_SOCKET_PROTOCOL protocol;
+    PTurnConnection pTurnConnection;
+    // PTurnAllocationSubscription items, changed with both locks held so either is enough to walk them
+    PDoubleList subscriptions;
+    // Held while handing channel data to the subscriptions, so releasing a subscription waits for it to be done. Never
+    // taken under the turn connection lock, the subscribers send through the turn connection while handling the data.
+    MUTEX lock;
+    // Held while notifying the subscriptions of a failure, which the turn connection does with its own lock held
+    MUTEX subscriptionsLock;
+    // When the last subscription was released, INVALID_TIMESTAMP_VALUE while in use
+    UINT64 idleStartTime;
+} TurnAllocation, *PTurnAllocation;
+
+/**
+ * Process wide pool of turn allocations. The timer queue driving the turn state machines and the connection listener
+ * receiving on the turn sockets are created along with the first allocation.
+ */
+typedef struct {
+    BOOL isInitialized;
+    MUTEX lock;
+    TIMER_QUEUE_HANDLE timerQueueHandle;
+    PConnectionListener pConnectionListener;
+    // pConnectionListener is the shared connection listener, which is not freed with the pool
+    BOOL sharedConnectionListener;
+    // PTurnAllocation items
+    PDoubleList allocations;
+} TurnAllocationPool, *PTurnAllocationPool;
+
+PTurnAllocationPool getTurnAllocationPoolInstance(VOID);
+
+/**
+ * Sets up the process wide pool. Called by initKvsWebRtc
+ *
+ * @return - STATUS code of the execution
+ */
+STATUS createTurnAllocationPool(VOID);
+
+/**
+ * Frees every allocation left in the pool. Called by deinitKvsWebRtc once all peer connections are freed
+ *
+ * @return - STATUS code of the execution
+ */
+STATUS freeTurnAllocationPool(VOID);
+
+/**
+ * Subscribes to the allocation for the turn server, transport and credentials, creating and starting it if there is none.
+ * The subscriber adds its peers with turnConnectionAddPeerWithCustomData and the subscription as customData.
+ *
+ * NOTE: Must not be called while holding the ice agent lock, channel data is delivered with the allocation lock held.
+ *
+ * @param - PIceServer - IN - Turn server
+ * @param - KVS_SOCKET_PROTOCOL - IN - Transport to the turn server
+ * @param - UINT32 - IN - Socket send buffer length if the allocation is created
+ * @param - UINT32 - IN - Receive threads of the shared connection listener, which the pool uses if this is the first subscription.
+ *                        The pool gets a listener of its own if 0
+ * @param - UINT64 - IN - customData passed to the callbacks
+ * @param - TurnStateFailedFunc - IN - Called when the allocation fails
+ * @param - ConnectionDataAvailableFunc - IN - Called for every channel data received from the subscriber's peers
+ * @param - PTurnAllocationSubscription* - OUT - The subscription
+ *
+ * @return - STATUS code of the execution
+ */
+STATUS turnAllocationPoolAcquire(PIceServer, KVS_SOCKET_PROTOCOL, UINT32, UINT32, UINT64, TurnStateFailedFunc, ConnectionDataAvailableFunc,
+                                 PTurnAllocationSubscription*);
+
+/**
+ * Releases the peers of the subscription and frees it. The allocation stays in the pool for TURN_ALLOCATION_POOL_IDLE_TIMEOUT
+ * after its last subscription is gone.
+ *
+ * NOTE: Must not be called while holding the ice agent lock. Idempotent.
+ *
+ * @param - PTurnAllocationSubscription* - IN/OUT - The subscription, set to NULL
+ *
+ * @return - STATUS code of the execution
+ */
+STATUS turnAllocationPoolRelease(PTurnAllocationSubscription*);
+
+STATUS turnAllocationIncomingDataHandler(UINT64, PSocketConnection, PBYTE, UINT32, PKvsIpAddress, PKvsIpAddress);
+STATUS turnAllocationStateFailedFn(PSocketConnection, UINT64);
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* __KINESIS_VIDEO_WEBRTC_CLIENT_TURN_ALLOCATION_POOL__ */
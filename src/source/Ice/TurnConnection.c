@@ -10,6 +10,15 @@ extern UINT32 TURN_CONNECTION_STATE_MACHINE_STATE_COUNT;
 STATUS createTurnConnection(PIceServer pTurnServer, TIMER_QUEUE_HANDLE timerQueueHandle, TURN_CONNECTION_DATA_TRANSFER_MODE dataTransferMode,
                             KVS_SOCKET_PROTOCOL protocol, PTurnConnectionCallbacks pTurnConnectionCallbacks, PSocketConnection pTurnSocket,
                             PConnectionListener pConnectionListener, PTurnConnection* ppTurnConnection)
+{
+    return createTurnConnectionWithMaxPeerCount(pTurnServer, timerQueueHandle, dataTransferMode, protocol, pTurnConnectionCallbacks, pTurnSocket,
+                                                pConnectionListener, DEFAULT_TURN_MAX_PEER_COUNT, ppTurnConnection);
+}
+
+STATUS createTurnConnectionWithMaxPeerCount(PIceServer pTurnServer, TIMER_QUEUE_HANDLE timerQueueHandle,
+                                            TURN_CONNECTION_DATA_TRANSFER_MODE dataTransferMode, KVS_SOCKET_PROTOCOL protocol,
+                                            PTurnConnectionCallbacks pTurnConnectionCallbacks, PSocketConnection pTurnSocket,
+                                            PConnectionListener pConnectionListener, UINT32 maxPeerCount, PTurnConnection* ppTurnConnection)
 {
     UNUSED_PARAM(dataTransferMode);
     ENTERS();
@@ -22,10 +31,17 @@ STATUS createTurnConnection(PIceServer pTurnServer, TIMER_QUEUE_HANDLE timerQueu
     CHK(pTurnServer->isTurn && !IS_EMPTY_STRING(pTurnServer->url) && !IS_EMPTY_STRING(pTurnServer->credential) &&
             !IS_EMPTY_STRING(pTurnServer->username),
         STATUS_INVALID_ARG);
-
-    pTurnConnection = (PTurnConnection) MEMCALLOC(
-        1, SIZEOF(TurnConnection) + DEFAULT_TURN_MESSAGE_RECV_CHANNEL_DATA_BUFFER_LEN * 2 + DEFAULT_TURN_MESSAGE_SEND_CHANNEL_DATA_BUFFER_LEN);
+    // every peer gets its own channel number
+    CHK(maxPeerCount > 0 && maxPeerCount <= TURN_CHANNEL_BIND_CHANNEL_NUMBER_MAX - TURN_CHANNEL_BIND_CHANNEL_NUMBER_BASE, STATUS_INVALID_ARG);
+
+    // peer list goes right after the struct to keep it aligned, the data buffers follow
+    pTurnConnection = (PTurnConnection) MEMCALLOC(1,
+                                                  SIZEOF(TurnConnection) + maxPeerCount * SIZEOF(TurnPeer) +
+                                                      DEFAULT_TURN_MESSAGE_RECV_CHANNEL_DATA_BUFFER_LEN * 2 +
+                                                      DEFAULT_TURN_MESSAGE_SEND_CHANNEL_DATA_BUFFER_LEN);
     CHK(pTurnConnection != NULL, STATUS_NOT_ENOUGH_MEMORY);
+    pTurnConnection->turnPeerList = (PTurnPeer) (pTurnConnection + 1);
+    pTurnConnection->maxTurnPeerCount = maxPeerCount;
     pTurnConnection->lock = MUTEX_CREATE(TRUE);
     pTurnConnection->sendLock = MUTEX_CREATE(FALSE);
     pTurnConnection->freeAllocationCvar = CVAR_CREATE();
@@ -53,7 +69,7 @@ STATUS createTurnConnection(PIceServer pTurnServer, TIMER_QUEUE_HANDLE timerQueu
     }
     pTurnConnection->recvDataBufferSize = DEFAULT_TURN_MESSAGE_RECV_CHANNEL_DATA_BUFFER_LEN;
     pTurnConnection->dataBufferSize = DEFAULT_TURN_MESSAGE_SEND_CHANNEL_DATA_BUFFER_LEN;
-    pTurnConnection->sendDataBuffer = (PBYTE) (pTurnConnection + 1);
+    pTurnConnection->sendDataBuffer = (PBYTE) (pTurnConnection->turnPeerList + maxPeerCount);
     pTurnConnection->recvDataBuffer = pTurnConnection->sendDataBuffer + pTurnConnection->dataBufferSize;
     pTurnConnection->completeChannelDataBuffer =
         pTurnConnection->sendDataBuffer + pTurnConnection->dataBufferSize + pTurnConnection->recvDataBufferSize;
@@ -174,7 +190,8 @@ STATUS turnConnectionIncomingDataHandler(PTurnConnection pTurnConnection, PBYTE
     while (remainingDataSize > 0 && totalChannelDataCount < channelDataListSize) {
         processedDataLen = 0;
         channelDataCount = 0;
-        if (IS_STUN_PACKET(pCurrent)) {
+        /* bytes continuing a channel data message carried over from the previous read can look like anything */
+        if (pTurnConnection->currRecvDataLen == 0 && IS_STUN_PACKET(pCurrent)) {
             processedDataLen = GET_STUN_PACKET_SIZE(pCurrent) + STUN_HEADER_LEN; /* size of entire STUN packet */
             if (STUN_PACKET_IS_TYPE_ERROR(pCurrent)) {
                 CHK_STATUS(turnConnectionHandleStunError(pTurnConnection, pCurrent, processedDataLen));
@@ -182,7 +199,8 @@ STATUS turnConnectionIncomingDataHandler(PTurnConnection pTurnConnection, PBYTE
                 CHK_STATUS(turnConnectionHandleStun(pTurnConnection, pCurrent, processedDataLen));
             }
         } else {
-            /* must be channel data if not stun */
+            /* must be channel data if not stun. Over TCP this parses every channel data up to the next STUN packet */
+            channelDataCount = channelDataListSize - totalChannelDataCount;
             CHK_STATUS(turnConnectionHandleChannelData(pTurnConnection, pCurrent, remainingDataSize, &channelDataList[totalChannelDataCount],
                                                        &channelDataCount, &processedDataLen));
         }
@@ -190,7 +208,6 @@ STATUS turnConnectionIncomingDataHandler(PTurnConnection pTurnConnection, PBYTE
         CHK(remainingDataSize >= processedDataLen, STATUS_INVALID_ARG_LEN);
         pCurrent += processedDataLen;
         remainingDataSize -= processedDataLen;
-        /* channelDataCount will be either 1 or 0 */
         totalChannelDataCount += channelDataCount;
     }
 
@@ -518,6 +535,7 @@ STATUS turnConnectionHandleChannelData(PTurnConnection pTurnConnection, PBYTE pB
             pChannelData->data = pBuffer + TURN_DATA_CHANNEL_SEND_OVERHEAD;
             pChannelData->size = GET_STUN_PACKET_SIZE(pBuffer);
             pChannelData->senderAddr = pTurnPeer->address;
+            pChannelData->customData = pTurnPeer->customData;
             turnChannelDataCount = 1;
 
             if (pChannelData->size + TURN_DATA_CHANNEL_SEND_OVERHEAD < bufferLen) {
@@ -537,8 +555,9 @@ STATUS turnConnectionHandleChannelData(PTurnConnection pTurnConnection, PBYTE pB
         *pProcessedDataLen = bufferLen;
 
     } else {
+        turnChannelDataCount = *pChannelDataCount;
         CHK_STATUS(
-            turnConnectionHandleChannelDataTcpMode(pTurnConnection, pBuffer, bufferLen, pChannelData, &turnChannelDataCount, pProcessedDataLen));
+            turnConnectionParseChannelDataTcpMode(pTurnConnection, pBuffer, bufferLen, pChannelData, &turnChannelDataCount, pProcessedDataLen));
     }
 
     *pChannelDataCount = turnChannelDataCount;
@@ -565,92 +584,128 @@ CleanUp:
  */
 STATUS turnConnectionHandleChannelDataTcpMode(PTurnConnection pTurnConnection, PBYTE pBuffer, UINT32 bufferLen, PTurnChannelData pChannelData,
                                               PUINT32 pTurnChannelDataCount, PUINT32 pProcessedDataLen)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+
+    CHK(pTurnChannelDataCount != NULL, STATUS_NULL_ARG);
+
+    *pTurnChannelDataCount = 1;
+    CHK_STATUS(turnConnectionParseChannelDataTcpMode(pTurnConnection, pBuffer, bufferLen, pChannelData, pTurnChannelDataCount, pProcessedDataLen));
+
+CleanUp:
+
+    return retStatus;
+}
+
+/*
+ * turnConnectionParseChannelDataTcpMode parses every complete channel data item from the stream in pBuffer in a single pass.
+ * On input *pTurnChannelDataCount is the size of channelDataList, upon return it is the number of items parsed. The items point
+ * into pBuffer, except the first one when it completes a message carried over from the previous read. Only a trailing partial
+ * message is copied, into recvDataBuffer. Parsing stops early at anything that is not channel data, like an interleaved
+ * STUN packet, and *pProcessedDataLen tells where.
+ */
+STATUS turnConnectionParseChannelDataTcpMode(PTurnConnection pTurnConnection, PBYTE pBuffer, UINT32 bufferLen, PTurnChannelData channelDataList,
+                                             PUINT32 pTurnChannelDataCount, PUINT32 pProcessedDataLen)
 {
     ENTERS();
     STATUS retStatus = STATUS_SUCCESS;
-    UINT32 bytesToCopy = 0, remainingMsgSize = 0, paddedChannelDataLen = 0, remainingBufLen = 0, channelDataCount = 0;
-    PBYTE pCurPos = NULL;
+    UINT32 bytesToCopy = 0, channelDataLen = 0, remainingBufLen = 0, channelDataCount = 0, channelDataListSize = 0;
+    PBYTE pCurPos = NULL, pTmp = NULL;
     UINT16 channelNumber = 0;
     PTurnPeer pTurnPeer = NULL;
 
-    CHK(pTurnConnection != NULL && pChannelData != NULL && pTurnChannelDataCount != NULL && pProcessedDataLen != NULL, STATUS_NULL_ARG);
+    CHK(pTurnConnection != NULL && channelDataList != NULL && pTurnChannelDataCount != NULL && pProcessedDataLen != NULL, STATUS_NULL_ARG);
     CHK(pBuffer != NULL && bufferLen > 0, STATUS_INVALID_ARG);
 
+    channelDataListSize = *pTurnChannelDataCount;
     pCurPos = pBuffer;
     remainingBufLen = bufferLen;
-    /* process only one channel data and return. Because channel data can be intermixed with STUN packet.
-     * need to check remainingBufLen too because channel data could be incomplete. */
-    while (remainingBufLen != 0 && channelDataCount == 0) {
-        if (pTurnConnection->currRecvDataLen != 0) {
-            DLOGV("currRecvDataLen: %d", pTurnConnection->currRecvDataLen);
-            if (pTurnConnection->currRecvDataLen >= TURN_DATA_CHANNEL_SEND_OVERHEAD) {
-                /* pTurnConnection->recvDataBuffer always has channel data start */
-                paddedChannelDataLen = ROUND_UP((UINT32) getInt16(*(PINT16) (pTurnConnection->recvDataBuffer + SIZEOF(channelNumber))), 4);
-                remainingMsgSize = paddedChannelDataLen - (pTurnConnection->currRecvDataLen - TURN_DATA_CHANNEL_SEND_OVERHEAD);
-                bytesToCopy = MIN(remainingMsgSize, remainingBufLen);
-                remainingBufLen -= bytesToCopy;
-
-                if (bytesToCopy > (pTurnConnection->recvDataBufferSize - pTurnConnection->currRecvDataLen)) {
-                    /* drop current message if it is longer than buffer size. */
-                    pTurnConnection->currRecvDataLen = 0;
-                    CHK(FALSE, STATUS_BUFFER_TOO_SMALL);
-                }
 
-                MEMCPY(pTurnConnection->recvDataBuffer + pTurnConnection->currRecvDataLen, pCurPos, bytesToCopy);
-                pTurnConnection->currRecvDataLen += bytesToCopy;
-                pCurPos += bytesToCopy;
-
-                CHECK_EXT(pTurnConnection->currRecvDataLen <= paddedChannelDataLen + TURN_DATA_CHANNEL_SEND_OVERHEAD,
-                          "Should not store more than one channel data message in recvDataBuffer");
-
-                /*
-                 * once assembled a complete channel data in recvDataBuffer, copy over to completeChannelDataBuffer to
-                 * make room for subsequent partial channel data.
-                 */
-                if (pTurnConnection->currRecvDataLen == (paddedChannelDataLen + TURN_DATA_CHANNEL_SEND_OVERHEAD)) {
-                    channelNumber = (UINT16) getInt16(*(PINT16) pTurnConnection->recvDataBuffer);
-                    if ((pTurnPeer = turnConnectionGetPeerWithChannelNumber(pTurnConnection, channelNumber)) != NULL) {
-                        MEMCPY(pTurnConnection->completeChannelDataBuffer, pTurnConnection->recvDataBuffer, pTurnConnection->currRecvDataLen);
-                        pChannelData->data = pTurnConnection->completeChannelDataBuffer + TURN_DATA_CHANNEL_SEND_OVERHEAD;
-                        pChannelData->size = GET_STUN_PACKET_SIZE(pTurnConnection->completeChannelDataBuffer);
-                        pChannelData->senderAddr = pTurnPeer->address;
-                        channelDataCount++;
-                    }
+    /* finish the message carried over from the previous read first, pTurnConnection->recvDataBuffer always has channel data start */
+    if (pTurnConnection->currRecvDataLen != 0 && channelDataListSize > 0) {
+        DLOGV("currRecvDataLen: %d", pTurnConnection->currRecvDataLen);
+        if (pTurnConnection->currRecvDataLen < TURN_DATA_CHANNEL_SEND_OVERHEAD) {
+            /* copy just enough to make a complete channel data header */
+            bytesToCopy = MIN(remainingBufLen, TURN_DATA_CHANNEL_SEND_OVERHEAD - pTurnConnection->currRecvDataLen);
+            MEMCPY(pTurnConnection->recvDataBuffer + pTurnConnection->currRecvDataLen, pCurPos, bytesToCopy);
+            pTurnConnection->currRecvDataLen += bytesToCopy;
+            pCurPos += bytesToCopy;
+            remainingBufLen -= bytesToCopy;
+        }
 
-                    pTurnConnection->currRecvDataLen = 0;
-                }
-            } else {
-                /* copy just enough to make a complete channel data header */
-                bytesToCopy = MIN(remainingMsgSize, TURN_DATA_CHANNEL_SEND_OVERHEAD - pTurnConnection->currRecvDataLen);
-                MEMCPY(pTurnConnection->recvDataBuffer + pTurnConnection->currRecvDataLen, pCurPos, bytesToCopy);
-                pTurnConnection->currRecvDataLen += bytesToCopy;
-                pCurPos += bytesToCopy;
+        if (pTurnConnection->currRecvDataLen >= TURN_DATA_CHANNEL_SEND_OVERHEAD) {
+            channelDataLen = ROUND_UP(GET_STUN_PACKET_SIZE(pTurnConnection->recvDataBuffer), 4) + TURN_DATA_CHANNEL_SEND_OVERHEAD;
+            if (channelDataLen > pTurnConnection->recvDataBufferSize) {
+                /* drop current message if it is longer than buffer size. */
+                pTurnConnection->currRecvDataLen = 0;
+                CHK(FALSE, STATUS_BUFFER_TOO_SMALL);
             }
-        } else {
-            /* new channel message start */
-            CHK(*pCurPos == TURN_DATA_CHANNEL_MSG_FIRST_BYTE, STATUS_TURN_MISSING_CHANNEL_DATA_HEADER);
 
-            paddedChannelDataLen = ROUND_UP((UINT32) getInt16(*(PINT16) (pCurPos + SIZEOF(UINT16))), 4);
-            if (remainingBufLen >= (paddedChannelDataLen + TURN_DATA_CHANNEL_SEND_OVERHEAD)) {
-                channelNumber = (UINT16) getInt16(*(PINT16) pCurPos);
+            bytesToCopy = MIN(channelDataLen - pTurnConnection->currRecvDataLen, remainingBufLen);
+            MEMCPY(pTurnConnection->recvDataBuffer + pTurnConnection->currRecvDataLen, pCurPos, bytesToCopy);
+            pTurnConnection->currRecvDataLen += bytesToCopy;
+            pCurPos += bytesToCopy;
+            remainingBufLen -= bytesToCopy;
+
+            /*
+             * once assembled a complete channel data in recvDataBuffer, swap it with completeChannelDataBuffer so the item
+             * stays valid while a trailing partial message of this read is stored in recvDataBuffer.
+             */
+            if (pTurnConnection->currRecvDataLen == channelDataLen) {
+                pTmp = pTurnConnection->completeChannelDataBuffer;
+                pTurnConnection->completeChannelDataBuffer = pTurnConnection->recvDataBuffer;
+                pTurnConnection->recvDataBuffer = pTmp;
+                pTurnConnection->currRecvDataLen = 0;
+
+                channelNumber = (UINT16) getInt16(*(PINT16) pTurnConnection->completeChannelDataBuffer);
                 if ((pTurnPeer = turnConnectionGetPeerWithChannelNumber(pTurnConnection, channelNumber)) != NULL) {
-                    pChannelData->data = pCurPos + TURN_DATA_CHANNEL_SEND_OVERHEAD;
-                    pChannelData->size = GET_STUN_PACKET_SIZE(pCurPos);
-                    pChannelData->senderAddr = pTurnPeer->address;
+                    channelDataList[channelDataCount].data = pTurnConnection->completeChannelDataBuffer + TURN_DATA_CHANNEL_SEND_OVERHEAD;
+                    channelDataList[channelDataCount].size = GET_STUN_PACKET_SIZE(pTurnConnection->completeChannelDataBuffer);
+                    channelDataList[channelDataCount].senderAddr = pTurnPeer->address;
+                    channelDataList[channelDataCount].customData = pTurnPeer->customData;
                     channelDataCount++;
                 }
+            }
+        }
+    }
 
-                remainingBufLen -= (paddedChannelDataLen + TURN_DATA_CHANNEL_SEND_OVERHEAD);
-                pCurPos += (paddedChannelDataLen + TURN_DATA_CHANNEL_SEND_OVERHEAD);
-            } else {
-                CHK(pTurnConnection->currRecvDataLen == 0, STATUS_TURN_NEW_DATA_CHANNEL_MSG_HEADER_BEFORE_PREVIOUS_MSG_FINISH);
-                CHK(remainingBufLen <= (pTurnConnection->recvDataBufferSize), STATUS_BUFFER_TOO_SMALL);
+    /* then every complete message in place */
+    while (remainingBufLen != 0 && pTurnConnection->currRecvDataLen == 0 && channelDataCount < channelDataListSize) {
+        if (*pCurPos != TURN_DATA_CHANNEL_MSG_FIRST_BYTE) {
+            /* hand whatever follows back to the caller, unless there is no channel data at all */
+            CHK(pCurPos != pBuffer, STATUS_TURN_MISSING_CHANNEL_DATA_HEADER);
+            break;
+        }
+
+        if (remainingBufLen >= TURN_DATA_CHANNEL_SEND_OVERHEAD) {
+            channelDataLen = ROUND_UP(GET_STUN_PACKET_SIZE(pCurPos), 4) + TURN_DATA_CHANNEL_SEND_OVERHEAD;
+        }
 
-                MEMCPY(pTurnConnection->recvDataBuffer, pCurPos, remainingBufLen);
-                pTurnConnection->currRecvDataLen += remainingBufLen;
-                pCurPos += remainingBufLen;
-                remainingBufLen = 0;
+        if (remainingBufLen >= TURN_DATA_CHANNEL_SEND_OVERHEAD && remainingBufLen >= channelDataLen) {
+            channelNumber = (UINT16) getInt16(*(PINT16) pCurPos);
+            /* consecutive messages are nearly always for the same peer */
+            if (pTurnPeer == NULL || pTurnPeer->channelNumber != channelNumber) {
+                pTurnPeer = turnConnectionGetPeerWithChannelNumber(pTurnConnection, channelNumber);
             }
+
+            if (pTurnPeer != NULL) {
+                channelDataList[channelDataCount].data = pCurPos + TURN_DATA_CHANNEL_SEND_OVERHEAD;
+                channelDataList[channelDataCount].size = GET_STUN_PACKET_SIZE(pCurPos);
+                channelDataList[channelDataCount].senderAddr = pTurnPeer->address;
+                channelDataList[channelDataCount].customData = pTurnPeer->customData;
+                channelDataCount++;
+            }
+
+            remainingBufLen -= channelDataLen;
+            pCurPos += channelDataLen;
+        } else {
+            /* keep the trailing partial message for the next read */
+            CHK(remainingBufLen <= pTurnConnection->recvDataBufferSize, STATUS_BUFFER_TOO_SMALL);
+
+            MEMCPY(pTurnConnection->recvDataBuffer, pCurPos, remainingBufLen);
+            pTurnConnection->currRecvDataLen = remainingBufLen;
+            pCurPos += remainingBufLen;
+            remainingBufLen = 0;
         }
     }
 
@@ -667,11 +722,23 @@ CleanUp:
 }
 
 STATUS turnConnectionAddPeer(PTurnConnection pTurnConnection, PKvsIpAddress pPeerAddress)
+{
+    return turnConnectionAddPeerWithCustomData(pTurnConnection, pPeerAddress, 0);
+}
+
+/*
+ * Adds a peer tagged with customData, which is handed back with every channel data received from it. The turn server can
+ * only bind one channel per peer address, so a released peer is brought back for the new customData while a peer still
+ * in use by another customData is refused with STATUS_TURN_CONNECTION_PEER_IN_USE.
+ */
+STATUS turnConnectionAddPeerWithCustomData(PTurnConnection pTurnConnection, PKvsIpAddress pPeerAddress, UINT64 customData)
 {
     ENTERS();
     STATUS retStatus = STATUS_SUCCESS;
-    PTurnPeer pTurnPeer = NULL;
+    PTurnPeer pTurnPeer = NULL, pNewTurnPeer = NULL;
     BOOL locked = FALSE;
+    UINT64 currentTime;
+    UINT32 i;
 
     CHK(pTurnConnection != NULL && pPeerAddress != NULL, STATUS_NULL_ARG);
     CHK(pTurnConnection->turnServer.ipAddress.family == pPeerAddress->family, STATUS_INVALID_ARG);
@@ -681,31 +748,59 @@ STATUS turnConnectionAddPeer(PTurnConnection pTurnConnection, PKvsIpAddress pPee
     locked = TRUE;
 
     /* check for duplicate */
-    CHK(turnConnectionGetPeerWithIp(pTurnConnection, pPeerAddress) == NULL, retStatus);
-    CHK_WARN(pTurnConnection->turnPeerCount < DEFAULT_TURN_MAX_PEER_COUNT, STATUS_INVALID_OPERATION, "Add peer failed. Max peer count reached");
+    if ((pTurnPeer = turnConnectionGetPeerWithIp(pTurnConnection, pPeerAddress)) != NULL) {
+        // data from the peer can only be routed to one of the ice agents sharing the allocation
+        CHK_WARN(pTurnPeer->connectionState == TURN_PEER_CONN_STATE_RELEASED || pTurnPeer->customData == customData,
+                 STATUS_TURN_CONNECTION_PEER_IN_USE, "Turn peer is already in use by another ice agent sharing the allocation");
+        pTurnPeer->customData = customData;
+        if (pTurnPeer->connectionState == TURN_PEER_CONN_STATE_RELEASED) {
+            pTurnPeer->connectionState = TURN_PEER_CONN_STATE_CREATE_PERMISSION;
+            pTurnConnection->releasedTurnPeerCount--;
+        }
 
-    pTurnPeer = &pTurnConnection->turnPeerList[pTurnConnection->turnPeerCount++];
+        CHK(FALSE, retStatus);
+    }
+
+    /* reuse the slot of a released peer once its channel binding has expired on the server and may be bound again */
+    currentTime = GETTIME();
+    for (i = 0; pTurnConnection->releasedTurnPeerCount > 0 && pTurnPeer == NULL && i < pTurnConnection->turnPeerCount; ++i) {
+        if (pTurnConnection->turnPeerList[i].connectionState == TURN_PEER_CONN_STATE_RELEASED &&
+            currentTime > pTurnConnection->turnPeerList[i].releaseTime + TURN_CHANNEL_BIND_LIFETIME + TURN_CHANNEL_REBIND_GUARD_PERIOD) {
+            pTurnPeer = &pTurnConnection->turnPeerList[i];
+            pTurnConnection->releasedTurnPeerCount--;
+        }
+    }
+
+    if (pTurnPeer == NULL) {
+        CHK_WARN(pTurnConnection->turnPeerCount < pTurnConnection->maxTurnPeerCount, STATUS_INVALID_OPERATION,
+                 "Add peer failed. Max peer count reached");
+
+        pTurnPeer = &pTurnConnection->turnPeerList[pTurnConnection->turnPeerCount++];
+        /* safe to down cast because maxTurnPeerCount is enforced */
+        pTurnPeer->channelNumber = (UINT16) pTurnConnection->turnPeerCount + TURN_CHANNEL_BIND_CHANNEL_NUMBER_BASE;
+        pNewTurnPeer = pTurnPeer;
+        CHK_STATUS(createTransactionIdStore(DEFAULT_MAX_STORED_TRANSACTION_ID_COUNT, &pTurnPeer->pTransactionIdStore));
+    }
 
     pTurnPeer->connectionState = TURN_PEER_CONN_STATE_CREATE_PERMISSION;
     pTurnPeer->address = *pPeerAddress;
     pTurnPeer->xorAddress = *pPeerAddress;
-    /* safe to down cast because DEFAULT_TURN_MAX_PEER_COUNT is enforced */
-    pTurnPeer->channelNumber = (UINT16) pTurnConnection->turnPeerCount + TURN_CHANNEL_BIND_CHANNEL_NUMBER_BASE;
     pTurnPeer->permissionExpirationTime = INVALID_TIMESTAMP_VALUE;
     pTurnPeer->ready = FALSE;
     pTurnPeer->firstTimeCreatePermReq = TRUE;
     pTurnPeer->firstTimeBindChannelReq = TRUE;
     pTurnPeer->firstTimeCreatePermResponse = TRUE;
     pTurnPeer->firstTimeBindChannelResponse = TRUE;
+    pTurnPeer->customData = customData;
+    pTurnPeer->releaseTime = INVALID_TIMESTAMP_VALUE;
 
     CHK_STATUS(xorIpAddress(&pTurnPeer->xorAddress, NULL)); /* only work for IPv4 for now */
-    CHK_STATUS(createTransactionIdStore(DEFAULT_MAX_STORED_TRANSACTION_ID_COUNT, &pTurnPeer->pTransactionIdStore));
-    pTurnPeer = NULL;
+    pNewTurnPeer = NULL;
 
 CleanUp:
 
-    if (STATUS_FAILED(retStatus) && pTurnPeer != NULL) {
-        freeTransactionIdStore(&pTurnPeer->pTransactionIdStore);
+    if (STATUS_FAILED(retStatus) && pNewTurnPeer != NULL) {
+        freeTransactionIdStore(&pNewTurnPeer->pTransactionIdStore);
         pTurnConnection->turnPeerCount--;
     }
 
@@ -717,6 +812,45 @@ CleanUp:
     return retStatus;
 }
 
+/*
+ * Releases every peer added with customData. Released peers stop being refreshed and data received from them is handed
+ * back with customData 0. The peers themselves are kept so pointers to them stay valid.
+ */
+STATUS turnConnectionReleasePeers(PTurnConnection pTurnConnection, UINT64 customData)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    PTurnPeer pTurnPeer = NULL;
+    UINT64 currentTime;
+    UINT32 i;
+
+    CHK(pTurnConnection != NULL, STATUS_NULL_ARG);
+
+    MUTEX_LOCK(pTurnConnection->lock);
+
+    currentTime = GETTIME();
+    for (i = 0; i < pTurnConnection->turnPeerCount; ++i) {
+        pTurnPeer = &pTurnConnection->turnPeerList[i];
+        if (pTurnPeer->customData == customData && pTurnPeer->connectionState != TURN_PEER_CONN_STATE_RELEASED) {
+            pTurnPeer->connectionState = TURN_PEER_CONN_STATE_RELEASED;
+            pTurnPeer->customData = 0;
+            pTurnPeer->ready = FALSE;
+            pTurnPeer->permissionExpirationTime = INVALID_TIMESTAMP_VALUE;
+            pTurnPeer->releaseTime = currentTime;
+            /* late responses must not revive the peer */
+            transactionIdStoreClear(pTurnPeer->pTransactionIdStore);
+            pTurnConnection->releasedTurnPeerCount++;
+        }
+    }
+
+    MUTEX_UNLOCK(pTurnConnection->lock);
+
+CleanUp:
+
+    LEAVES();
+    return retStatus;
+}
+
 STATUS turnConnectionSendData(PTurnConnection pTurnConnection, PBYTE pBuf, UINT32 bufLen, PKvsIpAddress pDestIp)
 {
     STATUS retStatus = STATUS_SUCCESS;
@@ -742,13 +876,15 @@ STATUS turnConnectionSendData(PTurnConnection pTurnConnection, PBYTE pBuf, UINT3
 
     pSendPeer = turnConnectionGetPeerWithIp(pTurnConnection, pDestIp);
 
-    CHK_STATUS(getIpAddrStr(pDestIp, ipAddrStr, ARRAY_SIZE(ipAddrStr)));
+    // Only format the address when there is something to log, this runs for every relayed packet
     if (pSendPeer == NULL) {
+        CHK_STATUS(getIpAddrStr(pDestIp, ipAddrStr, ARRAY_SIZE(ipAddrStr)));
         DLOGV("Unable to send data through turn because peer with address %s:%u is not found", ipAddrStr, KVS_GET_IP_ADDRESS_PORT(pDestIp));
         CHK(FALSE, retStatus);
     } else if (pSendPeer->connectionState == TURN_PEER_CONN_STATE_FAILED) {
         CHK(FALSE, STATUS_TURN_CONNECTION_PEER_NOT_USABLE);
     } else if (!pSendPeer->ready) {
+        CHK_STATUS(getIpAddrStr(pDestIp, ipAddrStr, ARRAY_SIZE(ipAddrStr)));
         DLOGV("Unable to send data through turn because turn channel is not established with peer with address %s:%u", ipAddrStr,
               KVS_GET_IP_ADDRESS_PORT(pDestIp));
         CHK(FALSE, retStatus);
@@ -795,6 +931,121 @@ CleanUp:
     return retStatus;
 }
 
+STATUS turnConnectionGetSendPeer(PTurnConnection pTurnConnection, PKvsIpAddress pDestIp, PTurnPeer* ppTurnPeer)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    BOOL locked = FALSE;
+
+    CHK(pTurnConnection != NULL && pDestIp != NULL && ppTurnPeer != NULL, STATUS_NULL_ARG);
+
+    MUTEX_LOCK(pTurnConnection->lock);
+    locked = TRUE;
+
+    // Peers are never removed from turnPeerList, so the caller can hold on to the peer for as long as the connection lives
+    *ppTurnPeer = turnConnectionGetPeerWithIp(pTurnConnection, pDestIp);
+
+CleanUp:
+
+    if (locked) {
+        MUTEX_UNLOCK(pTurnConnection->lock);
+    }
+
+    return retStatus;
+}
+
+/*
+ * Sends each buffer to the peer as a ChannelData message. The caller states how many writable bytes every buffer has
+ * in front of and after its data. The header is written into the headroom and the TCP padding comes from the tailroom,
+ * so nothing is copied and concurrent senders only contend on the socket itself.
+ */
+STATUS turnConnectionSendChannelData(PTurnConnection pTurnConnection, PTurnPeer pTurnPeer, PBYTE* ppBufs, PUINT32 pBufLens, UINT32 bufCount,
+                                     UINT32 headroom, UINT32 tailroom, PUINT32 pSentCount)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    PBYTE framedBufs[TURN_DATA_CHANNEL_SEND_BATCH_COUNT];
+    UINT32 framedLens[TURN_DATA_CHANNEL_SEND_BATCH_COUNT];
+    UINT32 i, j, batchCount, batchSentCount, sentCount = 0, paddedLen;
+    UINT64 state;
+    TURN_PEER_CONNECTION_STATE peerConnectionState = TURN_PEER_CONN_STATE_CREATE_PERMISSION;
+    UINT16 channelNumber = 0;
+    BOOL peerReady = FALSE;
+
+    CHK(pTurnConnection != NULL && ppBufs != NULL && pBufLens != NULL, STATUS_NULL_ARG);
+    CHK(headroom >= TURN_DATA_CHANNEL_SEND_HEADROOM, STATUS_INVALID_ARG);
+    CHK(pTurnConnection->protocol != KVS_SOCKET_PROTOCOL_TCP || tailroom >= TURN_DATA_CHANNEL_SEND_TAILROOM, STATUS_INVALID_ARG);
+
+    // Only the snapshot is taken under the lock, the send itself runs without it like turnConnectionSendData's
+    MUTEX_LOCK(pTurnConnection->lock);
+    state = pTurnConnection->state;
+    if (pTurnPeer != NULL) {
+        peerConnectionState = pTurnPeer->connectionState;
+        peerReady = pTurnPeer->ready;
+        channelNumber = pTurnPeer->channelNumber;
+    }
+    MUTEX_UNLOCK(pTurnConnection->lock);
+
+    if (!(state == TURN_STATE_CREATE_PERMISSION || state == TURN_STATE_BIND_CHANNEL || state == TURN_STATE_READY)) {
+        DLOGV("TurnConnection not ready to send data");
+
+        // If turn is not ready yet. Drop the send since ice will retry.
+        CHK(FALSE, retStatus);
+    }
+
+    if (pTurnPeer == NULL) {
+        DLOGV("Unable to send data through turn because the peer is not added yet");
+        CHK(FALSE, retStatus);
+    } else if (peerConnectionState == TURN_PEER_CONN_STATE_FAILED) {
+        CHK(FALSE, STATUS_TURN_CONNECTION_PEER_NOT_USABLE);
+    } else if (!peerReady) {
+        DLOGV("Unable to send data through turn because turn channel %u is not established", channelNumber);
+        CHK(FALSE, retStatus);
+    }
+
+    for (i = 0; i < bufCount; i += batchCount) {
+        batchCount = MIN(bufCount - i, TURN_DATA_CHANNEL_SEND_BATCH_COUNT);
+        for (j = 0; j < batchCount; j++) {
+            CHK(ppBufs[i + j] != NULL && pBufLens[i + j] > 0, STATUS_INVALID_ARG);
+            CHK(pBufLens[i + j] <= MAX_UINT16, STATUS_BUFFER_TOO_SMALL);
+
+            framedBufs[j] = ppBufs[i + j] - TURN_DATA_CHANNEL_SEND_HEADROOM;
+            putInt16((PINT16) framedBufs[j], channelNumber);
+            putInt16((PINT16) (framedBufs[j] + 2), (UINT16) pBufLens[i + j]);
+            framedLens[j] = TURN_DATA_CHANNEL_SEND_OVERHEAD + pBufLens[i + j];
+
+            // Padding is only required over TCP where the messages are not delimited by datagrams. It comes out of the caller's
+            // tailroom, which may hold anything, so it is zeroed rather than leaking stale memory to the turn server
+            if (pTurnConnection->protocol == KVS_SOCKET_PROTOCOL_TCP) {
+                paddedLen = (UINT32) ROUND_UP(framedLens[j], 4);
+                MEMSET(framedBufs[j] + framedLens[j], 0x00, paddedLen - framedLens[j]);
+                framedLens[j] = paddedLen;
+            }
+        }
+
+        batchSentCount = 0;
+        retStatus = socketConnectionSendDataBatch(pTurnConnection->pControlChannel, framedBufs, framedLens, batchCount,
+                                                  &pTurnConnection->turnServer.ipAddress, &batchSentCount);
+        sentCount += batchSentCount;
+
+        if (STATUS_FAILED(retStatus)) {
+            DLOGW("socketConnectionSendDataBatch failed with 0x%08x", retStatus);
+            if (retStatus != STATUS_SOCKET_CONNECTION_CLOSED_ALREADY) {
+                retStatus = STATUS_SUCCESS;
+            }
+            break;
+        }
+    }
+
+CleanUp:
+
+    CHK_LOG_ERR(retStatus);
+
+    if (pSentCount != NULL) {
+        *pSentCount = sentCount;
+    }
+
+    return retStatus;
+}
+
 STATUS turnConnectionStart(PTurnConnection pTurnConnection)
 {
     STATUS retStatus = STATUS_SUCCESS;
@@ -1190,11 +1441,13 @@ CleanUp:
 PTurnPeer turnConnectionGetPeerWithChannelNumber(PTurnConnection pTurnConnection, UINT16 channelNumber)
 {
     PTurnPeer pTurnPeer = NULL;
-    UINT32 i = 0;
+    UINT32 index;
 
-    for (; i < pTurnConnection->turnPeerCount; ++i) {
-        if (pTurnConnection->turnPeerList[i].channelNumber == channelNumber) {
-            pTurnPeer = &pTurnConnection->turnPeerList[i];
+    // channel numbers follow the order of turnPeerList, so the channel number is enough to find the peer
+    if (channelNumber > TURN_CHANNEL_BIND_CHANNEL_NUMBER_BASE) {
+        index = (UINT32) (channelNumber - TURN_CHANNEL_BIND_CHANNEL_NUMBER_BASE - 1);
+        if (index < pTurnConnection->turnPeerCount && pTurnConnection->turnPeerList[index].channelNumber == channelNumber) {
+            pTurnPeer = &pTurnConnection->turnPeerList[index];
         }
     }
 
@@ -1215,6 +1468,12 @@ PTurnPeer turnConnectionGetPeerWithIp(PTurnConnection pTurnConnection, PKvsIpAdd
     return pTurnPeer;
 }
 
+UINT32 turnConnectionGetActivePeerCount(PTurnConnection pTurnConnection)
+{
+    // Assume holding pTurnConnection->lock
+    return pTurnConnection->turnPeerCount - pTurnConnection->releasedTurnPeerCount;
+}
+
 VOID turnConnectionFatalError(PTurnConnection pTurnConnection, STATUS errorStatus)
 {
     if (pTurnConnection == NULL) {
@@ -35,15 +35,32 @@ extern "C" {
 #define DEFAULT_TURN_MESSAGE_RECV_CHANNEL_DATA_BUFFER_LEN MAX_TURN_CHANNEL_DATA_MESSAGE_SIZE
 #define DEFAULT_TURN_CHANNEL_DATA_BUFFER_SIZE             512
 #define DEFAULT_TURN_MAX_PEER_COUNT                       32
+#define DEFAULT_TURN_SHARED_MAX_PEER_COUNT                1024
 #define MAX_TURN_PROFILE_LOG_DESC_LEN                     256
 
 // all turn channel numbers must be greater than 0x4000 and less than 0x7FFF
 #define TURN_CHANNEL_BIND_CHANNEL_NUMBER_BASE (UINT16) 0x4000
+#define TURN_CHANNEL_BIND_CHANNEL_NUMBER_MAX  (UINT16) 0x7FFF
+
+// required by rfc5766 to be 600s
+#define TURN_CHANNEL_BIND_LIFETIME (600 * HUNDREDS_OF_NANOS_IN_A_SECOND)
+
+// rfc5766 section 11 keeps an expired channel number from being bound to another address for 5 more minutes, so the
+// slot of a released peer is reused TURN_CHANNEL_BIND_LIFETIME + TURN_CHANNEL_REBIND_GUARD_PERIOD after its release
+#define TURN_CHANNEL_REBIND_GUARD_PERIOD (300 * HUNDREDS_OF_NANOS_IN_A_SECOND)
 
 // 2 byte channel number 2 data byte size
 #define TURN_DATA_CHANNEL_SEND_OVERHEAD  4
 #define TURN_DATA_CHANNEL_MSG_FIRST_BYTE 0x40
 
+// Least room turnConnectionSendChannelData accepts around each buffer to write the ChannelData header in front of it
+// and to pad it to a multiple of 4 bytes over TCP without copying the data
+#define TURN_DATA_CHANNEL_SEND_HEADROOM TURN_DATA_CHANNEL_SEND_OVERHEAD
+#define TURN_DATA_CHANNEL_SEND_TAILROOM 3
+
+// Number of framed buffers handed to the socket at once by turnConnectionSendChannelData
+#define TURN_DATA_CHANNEL_SEND_BATCH_COUNT 64
+
 #define TURN_STATE_MACHINE_NAME (PCHAR) "TURN"
 
 #define TURN_STATE_NEW_STR                     (PCHAR) "TURN_STATE_NEW"
@@ -65,6 +82,7 @@ typedef enum {
     TURN_PEER_CONN_STATE_BIND_CHANNEL,
     TURN_PEER_CONN_STATE_READY,
     TURN_PEER_CONN_STATE_FAILED,
+    TURN_PEER_CONN_STATE_RELEASED,
 } TURN_PEER_CONNECTION_STATE;
 
 typedef enum {
@@ -76,6 +94,8 @@ typedef struct {
     PBYTE data;
     UINT32 size;
     KvsIpAddress senderAddr;
+    // customData of the peer the data came from
+    UINT64 customData;
 } TurnChannelData, *PTurnChannelData;
 
 typedef struct {
@@ -84,7 +104,7 @@ typedef struct {
     TurnStateFailedFunc turnStateFailedFn;
 } TurnConnectionCallbacks, *PTurnConnectionCallbacks;
 
-typedef struct {
+typedef struct __TurnPeer {
     KvsIpAddress address;
     KvsIpAddress xorAddress;
     /*
@@ -106,6 +126,10 @@ typedef struct {
     BOOL firstTimeBindChannelResponse;
     UINT64 bindChannelStartTime;
     UINT64 bindChannelTime;
+    // identifies who added the peer when several ice agents share the connection
+    UINT64 customData;
+    // when the peer entered TURN_PEER_CONN_STATE_RELEASED
+    UINT64 releaseTime;
 } TurnPeer, *PTurnPeer;
 
 typedef struct {
@@ -133,8 +157,12 @@ struct __TurnConnection {
 
     PSocketConnection pControlChannel;
 
-    TurnPeer turnPeerList[DEFAULT_TURN_MAX_PEER_COUNT];
+    // peers are never moved so pointers to them stay valid for the lifetime of the connection
+    PTurnPeer turnPeerList;
     UINT32 turnPeerCount;
+    UINT32 maxTurnPeerCount;
+    // peers in TURN_PEER_CONN_STATE_RELEASED, they are not refreshed anymore and their slots can be reused
+    UINT32 releasedTurnPeerCount;
 
     TIMER_QUEUE_HANDLE timerQueueHandle;
 
@@ -172,7 +200,7 @@ struct __TurnConnection {
     PBYTE recvDataBuffer;
     UINT32 recvDataBufferSize;
     UINT32 currRecvDataLen;
-    // when a complete channel data have been assembled in recvDataBuffer, move it to completeChannelDataBuffer
+    // when a complete channel data have been assembled in recvDataBuffer, it is swapped with completeChannelDataBuffer
     // to make room for subsequent partial channel data.
     PBYTE completeChannelDataBuffer;
 
@@ -188,9 +216,15 @@ typedef struct __TurnConnection* PTurnConnection;
 
 STATUS createTurnConnection(PIceServer, TIMER_QUEUE_HANDLE, TURN_CONNECTION_DATA_TRANSFER_MODE, KVS_SOCKET_PROTOCOL, PTurnConnectionCallbacks,
                             PSocketConnection, PConnectionListener, PTurnConnection*);
+STATUS createTurnConnectionWithMaxPeerCount(PIceServer, TIMER_QUEUE_HANDLE, TURN_CONNECTION_DATA_TRANSFER_MODE, KVS_SOCKET_PROTOCOL,
+                                            PTurnConnectionCallbacks, PSocketConnection, PConnectionListener, UINT32, PTurnConnection*);
 STATUS freeTurnConnection(PTurnConnection*);
 STATUS turnConnectionAddPeer(PTurnConnection, PKvsIpAddress);
+STATUS turnConnectionAddPeerWithCustomData(PTurnConnection, PKvsIpAddress, UINT64);
+STATUS turnConnectionReleasePeers(PTurnConnection, UINT64);
 STATUS turnConnectionSendData(PTurnConnection, PBYTE, UINT32, PKvsIpAddress);
+STATUS turnConnectionGetSendPeer(PTurnConnection, PKvsIpAddress, PTurnPeer*);
+STATUS turnConnectionSendChannelData(PTurnConnection, PTurnPeer, PBYTE*, PUINT32, UINT32, UINT32, UINT32, PUINT32);
 STATUS turnConnectionStart(PTurnConnection);
 STATUS turnConnectionShutdown(PTurnConnection, UINT64);
 BOOL turnConnectionIsShutdownComplete(PTurnConnection);
@@ -213,10 +247,12 @@ STATUS turnConnectionHandleStun(PTurnConnection, PBYTE, UINT32);
 STATUS turnConnectionHandleStunError(PTurnConnection, PBYTE, UINT32);
 STATUS turnConnectionHandleChannelData(PTurnConnection, PBYTE, UINT32, PTurnChannelData, PUINT32, PUINT32);
 STATUS turnConnectionHandleChannelDataTcpMode(PTurnConnection, PBYTE, UINT32, PTurnChannelData, PUINT32, PUINT32);
+STATUS turnConnectionParseChannelDataTcpMode(PTurnConnection, PBYTE, UINT32, PTurnChannelData, PUINT32, PUINT32);
 VOID turnConnectionFatalError(PTurnConnection, STATUS);
 
 PTurnPeer turnConnectionGetPeerWithChannelNumber(PTurnConnection, UINT16);
 PTurnPeer turnConnectionGetPeerWithIp(PTurnConnection, PKvsIpAddress);
+UINT32 turnConnectionGetActivePeerCount(PTurnConnection);
 
 STATUS checkTurnPeerConnections(PTurnConnection);
 
@@ -389,12 +389,12 @@ STATUS fromCreatePermissionTurnState(UINT64 customData, PUINT64 pState)
     }
 
     // push back timeout if no peer is available yet
-    if (pTurnConnection->turnPeerCount == 0) {
+    if (turnConnectionGetActivePeerCount(pTurnConnection) == 0) {
         pTurnConnection->stateTimeoutTime = currentTime + DEFAULT_TURN_CREATE_PERMISSION_TIMEOUT;
         CHK(FALSE, retStatus);
     }
 
-    if (currentTime > pTurnConnection->stateTimeoutTime || channelWithPermissionCount == pTurnConnection->turnPeerCount) {
+    if (currentTime > pTurnConnection->stateTimeoutTime || channelWithPermissionCount == turnConnectionGetActivePeerCount(pTurnConnection)) {
         CHK(channelWithPermissionCount > 0, STATUS_TURN_CONNECTION_FAILED_TO_CREATE_PERMISSION);
 
         // go to next state if we have at least one ready peer
@@ -467,7 +467,7 @@ STATUS executeCreatePermissionTurnState(UINT64 customData, UINT64 time)
     CHK_STATUS(checkTurnPeerConnections(pTurnConnection));
 
     // push back timeout if no peer is available yet
-    if (pTurnConnection->turnPeerCount == 0) {
+    if (turnConnectionGetActivePeerCount(pTurnConnection) == 0) {
         currentTime = GETTIME();
         pTurnConnection->stateTimeoutTime = currentTime + DEFAULT_TURN_CREATE_PERMISSION_TIMEOUT;
         CHK(FALSE, retStatus);
@@ -505,7 +505,7 @@ STATUS fromBindChannelTurnState(UINT64 customData, PUINT64 pState)
             readyPeerCount++;
         }
     }
-    if (currentTime > pTurnConnection->stateTimeoutTime || readyPeerCount == pTurnConnection->turnPeerCount) {
+    if (currentTime > pTurnConnection->stateTimeoutTime || readyPeerCount == turnConnectionGetActivePeerCount(pTurnConnection)) {
         CHK(readyPeerCount > 0, STATUS_TURN_CONNECTION_FAILED_TO_BIND_CHANNEL);
         // go to next state if we have at least one ready peer
         state = TURN_STATE_READY;
@@ -566,7 +566,9 @@ STATUS fromReadyTurnState(UINT64 customData, PUINT64 pState)
     if (refreshPeerPermission) {
         // reset pTurnPeer->connectionState to make them go through create permission and channel bind again
         for (i = 0; i < pTurnConnection->turnPeerCount; ++i) {
-            pTurnConnection->turnPeerList[i].connectionState = TURN_PEER_CONN_STATE_CREATE_PERMISSION;
+            if (pTurnConnection->turnPeerList[i].connectionState != TURN_PEER_CONN_STATE_RELEASED) {
+                pTurnConnection->turnPeerList[i].connectionState = TURN_PEER_CONN_STATE_CREATE_PERMISSION;
+            }
         }
 
         pTurnConnection->currentTimerCallingPeriod = DEFAULT_TURN_TIMER_INTERVAL_BEFORE_READY;
@@ -40,6 +40,7 @@ extern "C" {
 #include <mbedtls/ctr_drbg.h>
 #include <mbedtls/error.h>
 #include <mbedtls/certs.h>
+#include <mbedtls/sha1.h>
 #include <mbedtls/sha256.h>
 #include <mbedtls/md5.h>
 #endif
@@ -115,7 +116,10 @@ STATUS getIpAddrStr(PKvsIpAddress pKvsIpAddress, PCHAR pBuffer, UINT32 bufferLen
 // Project forward declarations
 ////////////////////////////////////////////////////
 struct __TurnConnection;
+struct __TurnPeer;
+struct __TurnAllocationSubscription;
 struct __SocketConnection;
+struct __DtlsContextCacheEntry;
 STATUS generateJSONSafeString(PCHAR, UINT32);
 
 ////////////////////////////////////////////////////
@@ -125,15 +129,20 @@ STATUS generateJSONSafeString(PCHAR, UINT32);
 #include "Crypto/IOBuffer.h"
 #include "Crypto/Crypto.h"
 #include "Crypto/Dtls.h"
+#include "Crypto/CertificatePool.h"
+#include "Crypto/DtlsContextCache.h"
 #include "Crypto/Tls.h"
 #include "Ice/Network.h"
 #include "Ice/SocketConnection.h"
 #include "Ice/ConnectionListener.h"
+#include "Stun/StunCrc32.h"
 #include "Stun/Stun.h"
 #include "Ice/IceUtils.h"
 #include "Sdp/Sdp.h"
 #include "Ice/IceAgent.h"
 #include "Ice/TurnConnection.h"
+#include "Ice/TurnAllocationPool.h"
+#include "Ice/IceCandidateCache.h"
 #include "Ice/IceAgentStateMachine.h"
 #include "Ice/TurnConnectionStateMachine.h"
 #include "Ice/NatBehaviorDiscovery.h"
@@ -145,6 +154,7 @@ STATUS generateJSONSafeString(PCHAR, UINT32);
 #include "Signaling/StateMachine.h"
 #include "Signaling/LwsApiCalls.h"
 #include "Rtp/RtpPacket.h"
+#include "Rtp/RtpPacketPool.h"
 #include "Rtcp/RtcpPacket.h"
 #include "Rtcp/RollingBuffer.h"
 #include "Rtcp/RtpRollingBuffer.h"
@@ -155,6 +165,7 @@ STATUS generateJSONSafeString(PCHAR, UINT32);
 #include "PeerConnection/Rtp.h"
 #include "PeerConnection/Rtcp.h"
 #include "PeerConnection/DataChannel.h"
+#include "Rtp/Codecs/AnnexBScanner.h"
 #include "Rtp/Codecs/RtpVP8Payloader.h"
 #include "Rtp/Codecs/RtpH264Payloader.h"
 #include "Rtp/Codecs/RtpH265Payloader.h"
@@ -8,17 +8,160 @@
 // forward declaration
 STATUS jitterBufferInternalParse(PJitterBuffer pJitterBuffer, BOOL bufferClosed);
 
+static STATUS allocatePacketRing(UINT32 capacity, PRtpPacket** ppPacketRing, PUINT64* ppPresenceBitmap)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    PRtpPacket* pPacketRing = NULL;
+    PUINT64 pPresenceBitmap = NULL;
+
+    pPacketRing = (PRtpPacket*) MEMCALLOC(capacity, SIZEOF(PRtpPacket));
+    CHK(pPacketRing != NULL, STATUS_NOT_ENOUGH_MEMORY);
+    pPresenceBitmap = (PUINT64) MEMCALLOC((capacity + 63) / 64, SIZEOF(UINT64));
+    CHK(pPresenceBitmap != NULL, STATUS_NOT_ENOUGH_MEMORY);
+
+CleanUp:
+    if (STATUS_FAILED(retStatus)) {
+        SAFE_MEMFREE(pPacketRing);
+        SAFE_MEMFREE(pPresenceBitmap);
+    }
+
+    *ppPacketRing = pPacketRing;
+    *ppPresenceBitmap = pPresenceBitmap;
+
+    return retStatus;
+}
+
+// Returns the buffered packet with the sequence number, or NULL when it has not been received
+static inline PRtpPacket jitterBufferPeekPacket(PJitterBuffer pJitterBuffer, UINT16 seqNum)
+{
+    UINT32 slot = JITTER_BUFFER_PACKET_RING_SLOT(pJitterBuffer, seqNum);
+    PRtpPacket pRtpPacket = NULL;
+
+    if (JITTER_BUFFER_PACKET_PRESENT(pJitterBuffer, slot)) {
+        pRtpPacket = pJitterBuffer->pPacketRing[slot];
+        if (pRtpPacket->header.sequenceNumber != seqNum) {
+            pRtpPacket = NULL;
+        }
+    }
+
+    return pRtpPacket;
+}
+
+static VOID jitterBufferRemovePacketAtSlot(PJitterBuffer pJitterBuffer, UINT32 slot)
+{
+    PRtpPacket pRtpPacket = pJitterBuffer->pPacketRing[slot];
+
+    freeRtpPacket(&pRtpPacket);
+    pJitterBuffer->pPacketRing[slot] = NULL;
+    pJitterBuffer->pPacketPresenceBitmap[slot >> 6] &= ~(1ULL << (slot & 63));
+}
+
+// Doubles the ring, packets keep distinct slots since the wider mask only adds bits
+static STATUS jitterBufferGrowPacketRing(PJitterBuffer pJitterBuffer)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    PRtpPacket* pPacketRing = NULL;
+    PUINT64 pPresenceBitmap = NULL;
+    UINT32 i, slot, capacity = pJitterBuffer->packetRingCapacity * 2;
+
+    CHK(capacity <= pJitterBuffer->maxPacketRingCapacity, STATUS_INVALID_OPERATION);
+    CHK_STATUS(allocatePacketRing(capacity, &pPacketRing, &pPresenceBitmap));
+
+    for (i = 0; i < pJitterBuffer->packetRingCapacity; i++) {
+        if (JITTER_BUFFER_PACKET_PRESENT(pJitterBuffer, i)) {
+            slot = (UINT32) pJitterBuffer->pPacketRing[i]->header.sequenceNumber & (capacity - 1);
+            pPacketRing[slot] = pJitterBuffer->pPacketRing[i];
+            pPresenceBitmap[slot >> 6] |= 1ULL << (slot & 63);
+        }
+    }
+
+    SAFE_MEMFREE(pJitterBuffer->pPacketRing);
+    SAFE_MEMFREE(pJitterBuffer->pPacketPresenceBitmap);
+    pJitterBuffer->pPacketRing = pPacketRing;
+    pJitterBuffer->pPacketPresenceBitmap = pPresenceBitmap;
+    pJitterBuffer->packetRingCapacity = capacity;
+
+    DLOGD("Jitter buffer packet ring grown to %u slots", capacity);
+
+CleanUp:
+    return retStatus;
+}
+
+// Returns true when the packet is more than maxLatency behind the tail, the parser drops its frame once it gets there
+static inline BOOL jitterBufferPacketExpired(PJitterBuffer pJitterBuffer, PRtpPacket pRtpPacket)
+{
+    UINT32 age = pJitterBuffer->tailTimestamp - pRtpPacket->header.timestamp;
+
+    // Timestamps wrap, a packet more than half of their range behind the tail is ahead of it
+    return pJitterBuffer->tailTimestamp != 0 && age > pJitterBuffer->maxLatency && age <= MAX_UINT32 / 2;
+}
+
+// Takes ownership of the packet, replacing an earlier copy of the same sequence number. The packet is freed and
+// reported as discarded when the ring is at its maximum size and holds a newer packet in the same slot.
+static STATUS jitterBufferStorePacket(PJitterBuffer pJitterBuffer, PRtpPacket pRtpPacket, PBOOL pPacketDiscarded)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    UINT16 seqNum = pRtpPacket->header.sequenceNumber, occupantSeqNum;
+    UINT32 slot = JITTER_BUFFER_PACKET_RING_SLOT(pJitterBuffer, seqNum);
+    PRtpPacket pOccupant = NULL;
+
+    while (JITTER_BUFFER_PACKET_PRESENT(pJitterBuffer, slot)) {
+        pOccupant = pJitterBuffer->pPacketRing[slot];
+        occupantSeqNum = pOccupant->header.sequenceNumber;
+        if (occupantSeqNum == seqNum) {
+            CHK(pOccupant != pRtpPacket, retStatus);
+            jitterBufferRemovePacketAtSlot(pJitterBuffer, slot);
+        } else if (pJitterBuffer->firstFrameProcessed &&
+                   (UINT16) (occupantSeqNum - pJitterBuffer->headSequenceNumber) >
+                       (UINT16) (pJitterBuffer->tailSequenceNumber - pJitterBuffer->headSequenceNumber)) {
+            // A late packet of a frame that is already gone, the parser will never reach it. Before the first
+            // frame the head can still move back, so keep everything then.
+            jitterBufferRemovePacketAtSlot(pJitterBuffer, slot);
+        } else if (jitterBufferPacketExpired(pJitterBuffer, pOccupant)) {
+            // Its frame is dropped either way, don't grow the ring to keep it
+            jitterBufferRemovePacketAtSlot(pJitterBuffer, slot);
+            pJitterBuffer->parseStateValid = FALSE;
+        } else if (pJitterBuffer->packetRingCapacity < pJitterBuffer->maxPacketRingCapacity) {
+            CHK_STATUS(jitterBufferGrowPacketRing(pJitterBuffer));
+            slot = JITTER_BUFFER_PACKET_RING_SLOT(pJitterBuffer, seqNum);
+        } else if ((UINT16) (pJitterBuffer->tailSequenceNumber - occupantSeqNum) > (UINT16) (pJitterBuffer->tailSequenceNumber - seqNum)) {
+            // Full, keep the newer of the two packets
+            jitterBufferRemovePacketAtSlot(pJitterBuffer, slot);
+            pJitterBuffer->parseStateValid = FALSE;
+        } else {
+            freeRtpPacket(&pRtpPacket);
+            if (pPacketDiscarded != NULL) {
+                *pPacketDiscarded = TRUE;
+            }
+            CHK(FALSE, retStatus);
+        }
+    }
+
+    pJitterBuffer->pPacketRing[slot] = pRtpPacket;
+    pJitterBuffer->pPacketPresenceBitmap[slot >> 6] |= 1ULL << (slot & 63);
+
+    // The parser has already accounted for everything before its resume point
+    if (pJitterBuffer->parseStateValid &&
+        (UINT16) (seqNum - pJitterBuffer->headSequenceNumber) < (UINT16) (pJitterBuffer->parseSequenceNumber - pJitterBuffer->headSequenceNumber)) {
+        pJitterBuffer->parseStateValid = FALSE;
+    }
+
+CleanUp:
+    return retStatus;
+}
+
 STATUS createJitterBuffer(FrameReadyFunc onFrameReadyFunc, FrameDroppedFunc onFrameDroppedFunc, DepayRtpPayloadFunc depayRtpPayloadFunc,
                           UINT32 maxLatency, UINT32 clockRate, UINT64 customData, PJitterBuffer* ppJitterBuffer)
 {
     ENTERS();
     STATUS retStatus = STATUS_SUCCESS;
     PJitterBuffer pJitterBuffer = NULL;
+    UINT64 packetCount;
 
     CHK(ppJitterBuffer != NULL && onFrameReadyFunc != NULL && onFrameDroppedFunc != NULL && depayRtpPayloadFunc != NULL, STATUS_NULL_ARG);
     CHK(clockRate != 0, STATUS_INVALID_ARG);
 
-    pJitterBuffer = (PJitterBuffer) MEMALLOC(SIZEOF(JitterBuffer));
+    pJitterBuffer = (PJitterBuffer) MEMCALLOC(1, SIZEOF(JitterBuffer));
     CHK(pJitterBuffer != NULL, STATUS_NOT_ENOUGH_MEMORY);
 
     pJitterBuffer->onFrameReadyFn = onFrameReadyFunc;
@@ -44,8 +187,16 @@ STATUS createJitterBuffer(FrameReadyFunc onFrameReadyFunc, FrameDroppedFunc onFr
     pJitterBuffer->sequenceNumberOverflowState = FALSE;
 
     pJitterBuffer->customData = customData;
-    CHK_STATUS(hashTableCreateWithParams(JITTER_BUFFER_HASH_TABLE_BUCKET_COUNT, JITTER_BUFFER_HASH_TABLE_BUCKET_LENGTH,
-                                         &pJitterBuffer->pPkgBufferHashTable));
+    pJitterBuffer->parseStateValid = FALSE;
+    // Enough slots for the packets of maxLatency at JITTER_BUFFER_MAX_PACKET_RATE, maxLatency is in clockRate units here
+    packetCount = pJitterBuffer->maxLatency * JITTER_BUFFER_MAX_PACKET_RATE / pJitterBuffer->clockRate;
+    pJitterBuffer->maxPacketRingCapacity = JITTER_BUFFER_DEFAULT_PACKET_RING_CAPACITY;
+    while (pJitterBuffer->maxPacketRingCapacity < packetCount && pJitterBuffer->maxPacketRingCapacity < JITTER_BUFFER_MAX_PACKET_RING_CAPACITY) {
+        pJitterBuffer->maxPacketRingCapacity *= 2;
+    }
+
+    pJitterBuffer->packetRingCapacity = JITTER_BUFFER_DEFAULT_PACKET_RING_CAPACITY;
+    CHK_STATUS(allocatePacketRing(pJitterBuffer->packetRingCapacity, &pJitterBuffer->pPacketRing, &pJitterBuffer->pPacketPresenceBitmap));
 
 CleanUp:
     if (STATUS_FAILED(retStatus) && pJitterBuffer != NULL) {
@@ -67,6 +218,7 @@ STATUS freeJitterBuffer(PJitterBuffer* ppJitterBuffer)
 
     STATUS retStatus = STATUS_SUCCESS;
     PJitterBuffer pJitterBuffer = NULL;
+    UINT32 slot;
 
     CHK(ppJitterBuffer != NULL, STATUS_NULL_ARG);
     // freeJitterBuffer is idempotent
@@ -74,9 +226,19 @@ STATUS freeJitterBuffer(PJitterBuffer* ppJitterBuffer)
 
     pJitterBuffer = *ppJitterBuffer;
 
-    jitterBufferInternalParse(pJitterBuffer, TRUE);
-    jitterBufferDropBufferData(pJitterBuffer, 0, MAX_RTP_SEQUENCE_NUM, 0);
-    hashTableFree(pJitterBuffer->pPkgBufferHashTable);
+    if (pJitterBuffer->pPacketRing != NULL && pJitterBuffer->pPacketPresenceBitmap != NULL) {
+        jitterBufferInternalParse(pJitterBuffer, TRUE);
+
+        // Release whatever the parser left behind, including late packets outside of the head to tail range
+        for (slot = 0; slot < pJitterBuffer->packetRingCapacity; slot++) {
+            if (JITTER_BUFFER_PACKET_PRESENT(pJitterBuffer, slot)) {
+                jitterBufferRemovePacketAtSlot(pJitterBuffer, slot);
+            }
+        }
+    }
+
+    SAFE_MEMFREE(pJitterBuffer->pPacketRing);
+    SAFE_MEMFREE(pJitterBuffer->pPacketPresenceBitmap);
 
     SAFE_MEMFREE(*ppJitterBuffer);
 
@@ -394,9 +556,8 @@ BOOL withinLatencyTolerance(PJitterBuffer pJitterBuffer, PRtpPacket pRtpPacket)
 STATUS jitterBufferPush(PJitterBuffer pJitterBuffer, PRtpPacket pRtpPacket, PBOOL pPacketDiscarded)
 {
     ENTERS();
-    STATUS retStatus = STATUS_SUCCESS, status = STATUS_SUCCESS;
-    UINT64 hashValue = 0;
-    PRtpPacket pCurPacket = NULL;
+    STATUS retStatus = STATUS_SUCCESS;
+    BOOL keepPacket = FALSE;
 
     CHK(pJitterBuffer != NULL && pRtpPacket != NULL, STATUS_NULL_ARG);
 
@@ -423,17 +584,8 @@ STATUS jitterBufferPush(PJitterBuffer pJitterBuffer, PRtpPacket pRtpPacket, PBOO
         DLOGS("Entered timestamp overflow state");
     }
 
-    // is the packet within the accepted latency range, if so, add it to the hashtable
+    // is the packet within the accepted latency range, if so, add it to the packet ring
     if (withinLatencyTolerance(pJitterBuffer, pRtpPacket)) {
-        status = hashTableGet(pJitterBuffer->pPkgBufferHashTable, pRtpPacket->header.sequenceNumber, &hashValue);
-        pCurPacket = (PRtpPacket) hashValue;
-        if (STATUS_SUCCEEDED(status) && pCurPacket != NULL) {
-            freeRtpPacket(&pCurPacket);
-            CHK_STATUS(hashTableRemove(pJitterBuffer->pPkgBufferHashTable, pRtpPacket->header.sequenceNumber));
-        }
-
-        CHK_STATUS(hashTablePut(pJitterBuffer->pPkgBufferHashTable, pRtpPacket->header.sequenceNumber, (UINT64) pRtpPacket));
-
         if (headCheckingAllowed(pJitterBuffer, pRtpPacket)) {
             // if the timestamp is less, we'll accept it as a new head, since it must be an earlier frame.
             if (headTimestampCheck(pJitterBuffer, pRtpPacket)) {
@@ -446,8 +598,18 @@ STATUS jitterBufferPush(PJitterBuffer pJitterBuffer, PRtpPacket pRtpPacket, PBOO
         // DONE with considering the head.
 
         DLOGS("jitterBufferPush get packet timestamp %lu seqNum %lu", pRtpPacket->header.timestamp, pRtpPacket->header.sequenceNumber);
+
+        // Once the first frame is processed the head only moves forward, a packet that is still behind it belongs to a
+        // frame that is already gone. The parser would never reach it and storing it could only grow the packet ring.
+        keepPacket = !pJitterBuffer->firstFrameProcessed ||
+            (UINT16) (pRtpPacket->header.sequenceNumber - pJitterBuffer->headSequenceNumber) <=
+                (UINT16) (pJitterBuffer->tailSequenceNumber - pJitterBuffer->headSequenceNumber);
+    }
+
+    if (keepPacket) {
+        CHK_STATUS(jitterBufferStorePacket(pJitterBuffer, pRtpPacket, pPacketDiscarded));
     } else {
-        // Free the packet if it is out of range, jitter buffer need to own the packet and do free
+        // Free the packet if it is out of range or stale, jitter buffer need to own the packet and do free
         freeRtpPacket(&pRtpPacket);
         if (pPacketDiscarded != NULL) {
             *pPacketDiscarded = TRUE;
@@ -476,8 +638,7 @@ STATUS jitterBufferInternalParse(PJitterBuffer pJitterBuffer, BOOL bufferClosed)
     UINT16 startDropIndex = 0;
     UINT32 curFrameSize = 0;
     UINT32 partialFrameSize = 0;
-    UINT64 hashValue = 0;
-    BOOL isStart = FALSE, containStartForEarliestFrame = FALSE, hasEntry = FALSE;
+    BOOL isStart = FALSE, containStartForEarliestFrame = FALSE, hasEntry = FALSE, scanned = FALSE;
     UINT16 lastNonNullIndex = 0;
     PRtpPacket pCurPacket = NULL;
 
@@ -491,6 +652,19 @@ STATUS jitterBufferInternalParse(PJitterBuffer pJitterBuffer, BOOL bufferClosed)
     lastIndex = pJitterBuffer->tailSequenceNumber + 1;
     index = pJitterBuffer->headSequenceNumber;
     startDropIndex = index;
+
+    // Everything from the head up to where the previous parse stopped is unchanged, pick up from there
+    // instead of walking the whole buffer again. Closing the buffer always does a full pass.
+    if (!bufferClosed && pJitterBuffer->parseStateValid && pJitterBuffer->parseHeadSequenceNumber == pJitterBuffer->headSequenceNumber &&
+        pJitterBuffer->parseHeadTimestamp == pJitterBuffer->headTimestamp &&
+        (UINT16) (pJitterBuffer->parseSequenceNumber - index) <= (UINT16) (lastIndex - index)) {
+        index = pJitterBuffer->parseSequenceNumber;
+        curFrameSize = pJitterBuffer->parseFrameSize;
+        containStartForEarliestFrame = pJitterBuffer->parseContainStart;
+        isFrameDataContinuous = pJitterBuffer->parseFrameDataContinuous;
+    }
+    pJitterBuffer->parseStateValid = FALSE;
+    scanned = TRUE;
     // Loop through entire buffer to find complete frames.
     /*A Frame is ready when these conditions are met:
      * 1. We have a starting packet
@@ -507,22 +681,13 @@ STATUS jitterBufferInternalParse(PJitterBuffer pJitterBuffer, BOOL bufferClosed)
      *conditions have been met from dropping an earlier frame, then it will be processed.
      */
     for (; index != lastIndex; index++) {
-        CHK_STATUS(hashTableContains(pJitterBuffer->pPkgBufferHashTable, index, &hasEntry));
-        if (!hasEntry) {
-            isFrameDataContinuous = FALSE;
+        pCurPacket = jitterBufferPeekPacket(pJitterBuffer, index);
+        if (pCurPacket == NULL) {
             // if the max latency has not been reached, or the buffer is not being closed, exit parse when a missing entry is found
             CHK(pJitterBuffer->headTimestamp < earliestAllowedTimestamp || bufferClosed, retStatus);
+            isFrameDataContinuous = FALSE;
         } else {
             lastNonNullIndex = index;
-            retStatus = hashTableGet(pJitterBuffer->pPkgBufferHashTable, index, &hashValue);
-            if (retStatus == STATUS_HASH_KEY_NOT_PRESENT) {
-                // should be unreachable, this means hashTablContains() said we had it but hashTableGet() couldn't find it.
-                continue;
-            } else {
-                CHK_STATUS(retStatus);
-            }
-            pCurPacket = (PRtpPacket) hashValue;
-            CHK(pCurPacket != NULL, STATUS_NULL_ARG);
             curTimestamp = pCurPacket->header.timestamp;
             // new timestamp on an RTP packet means new frame
             if (curTimestamp != pJitterBuffer->headTimestamp) {
@@ -543,6 +708,7 @@ STATUS jitterBufferInternalParse(PJitterBuffer pJitterBuffer, BOOL bufferClosed)
                     CHK_STATUS(jitterBufferDropBufferData(pJitterBuffer, startDropIndex, UINT16_DEC(index), curTimestamp));
                     pJitterBuffer->firstFrameProcessed = TRUE;
                     isFrameDataContinuous = TRUE;
+                    containStartForEarliestFrame = FALSE;
                     startDropIndex = index;
                 } else {
                     // if you're here, it means we're not force clearing the buffer, and the previous frame must be missing its starting packet.
@@ -568,10 +734,9 @@ STATUS jitterBufferInternalParse(PJitterBuffer pJitterBuffer, BOOL bufferClosed)
         curFrameSize = 0;
         hasEntry = TRUE;
         for (index = startDropIndex; UINT16_DEC(index) != lastNonNullIndex && hasEntry; index++) {
-            CHK_STATUS(hashTableContains(pJitterBuffer->pPkgBufferHashTable, index, &hasEntry));
+            pCurPacket = jitterBufferPeekPacket(pJitterBuffer, index);
+            hasEntry = pCurPacket != NULL;
             if (hasEntry) {
-                CHK_STATUS(hashTableGet(pJitterBuffer->pPkgBufferHashTable, index, &hashValue));
-                pCurPacket = (PRtpPacket) hashValue;
                 CHK_STATUS(pJitterBuffer->depayPayloadFn(pCurPacket->payload, pCurPacket->payloadLength, NULL, &partialFrameSize, NULL));
                 curFrameSize += partialFrameSize;
             }
@@ -588,6 +753,18 @@ STATUS jitterBufferInternalParse(PJitterBuffer pJitterBuffer, BOOL bufferClosed)
     }
 
 CleanUp:
+    // Remember where the scan stopped. Missing packets, a frame without its start or the tail are
+    // the only places it stops at, and the next pass resumes from that same index.
+    if (scanned && STATUS_SUCCEEDED(retStatus) && !bufferClosed) {
+        pJitterBuffer->parseStateValid = TRUE;
+        pJitterBuffer->parseSequenceNumber = index;
+        pJitterBuffer->parseHeadSequenceNumber = pJitterBuffer->headSequenceNumber;
+        pJitterBuffer->parseHeadTimestamp = pJitterBuffer->headTimestamp;
+        pJitterBuffer->parseFrameSize = curFrameSize;
+        pJitterBuffer->parseContainStart = containStartForEarliestFrame;
+        pJitterBuffer->parseFrameDataContinuous = isFrameDataContinuous;
+    }
+
     CHK_LOG_ERR(retStatus);
 
     LEAVES();
@@ -601,22 +778,14 @@ STATUS jitterBufferDropBufferData(PJitterBuffer pJitterBuffer, UINT16 startIndex
     ENTERS();
     STATUS retStatus = STATUS_SUCCESS;
     UINT16 index = startIndex;
-    UINT64 hashValue;
-    PRtpPacket pCurPacket = NULL;
-    BOOL hasEntry = FALSE;
 
     CHK(pJitterBuffer != NULL, STATUS_NULL_ARG);
     for (; UINT16_DEC(index) != endIndex; index++) {
-        CHK_STATUS(hashTableContains(pJitterBuffer->pPkgBufferHashTable, index, &hasEntry));
-        if (hasEntry) {
-            CHK_STATUS(hashTableGet(pJitterBuffer->pPkgBufferHashTable, index, &hashValue));
-            pCurPacket = (PRtpPacket) hashValue;
-            if (pCurPacket) {
-                freeRtpPacket(&pCurPacket);
-            }
-            CHK_STATUS(hashTableRemove(pJitterBuffer->pPkgBufferHashTable, index));
+        if (jitterBufferPeekPacket(pJitterBuffer, index) != NULL) {
+            jitterBufferRemovePacketAtSlot(pJitterBuffer, JITTER_BUFFER_PACKET_RING_SLOT(pJitterBuffer, index));
         }
     }
+    pJitterBuffer->parseStateValid = FALSE;
     pJitterBuffer->headTimestamp = nextTimestamp;
     pJitterBuffer->headSequenceNumber = endIndex + 1;
     if (exitTimestampOverflowCheck(pJitterBuffer)) {
@@ -639,7 +808,6 @@ STATUS jitterBufferFillFrameData(PJitterBuffer pJitterBuffer, PBYTE pFrame, UINT
     ENTERS();
     STATUS retStatus = STATUS_SUCCESS;
     UINT16 index = startIndex;
-    UINT64 hashValue;
     PRtpPacket pCurPacket = NULL;
     PBYTE pCurPtrInFrame = pFrame;
     UINT32 remainingFrameSize = frameSize;
@@ -647,10 +815,8 @@ STATUS jitterBufferFillFrameData(PJitterBuffer pJitterBuffer, PBYTE pFrame, UINT
 
     CHK(pJitterBuffer != NULL && pFrame != NULL && pFilledSize != NULL, STATUS_NULL_ARG);
     for (; UINT16_DEC(index) != endIndex; index++) {
-        hashValue = 0;
-        CHK_STATUS(hashTableGet(pJitterBuffer->pPkgBufferHashTable, index, &hashValue));
-        pCurPacket = (PRtpPacket) hashValue;
-        CHK(pCurPacket != NULL, STATUS_NULL_ARG);
+        pCurPacket = jitterBufferPeekPacket(pJitterBuffer, index);
+        CHK(pCurPacket != NULL, STATUS_RTP_JITTER_BUFFER_MISSING_PACKET);
         partialFrameSize = remainingFrameSize;
         CHK_STATUS(pJitterBuffer->depayPayloadFn(pCurPacket->payload, pCurPacket->payloadLength, pCurPtrInFrame, &partialFrameSize, NULL));
         pCurPtrInFrame += partialFrameSize;
@@ -666,3 +832,46 @@ CleanUp:
     LEAVES();
     return retStatus;
 }
+
+// Describe all packets containing sequence numbers between and including the startIndex and endIndex as slices
+// of the packets themselves. The slices stay valid until the packets are dropped.
+STATUS jitterBufferFillFrameIov(PJitterBuffer pJitterBuffer, DepayRtpPayloadIovFunc depayIovFn, PFrameIovArray pFrameIovArray, UINT16 startIndex,
+                                UINT16 endIndex)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    UINT16 index = startIndex;
+    PRtpPacket pCurPacket = NULL;
+
+    CHK(pJitterBuffer != NULL && depayIovFn != NULL && pFrameIovArray != NULL, STATUS_NULL_ARG);
+
+    // Scratch has to be in place before the first slice points into it
+    pFrameIovArray->iovCount = 0;
+    pFrameIovArray->scratchLength = 0;
+    CHK_STATUS(frameIovArrayReserve(pFrameIovArray, 0, ((UINT32) (UINT16) (endIndex - startIndex) + 1) * DEPAY_IOV_MAX_SCRATCH_PER_PACKET));
+
+    for (; UINT16_DEC(index) != endIndex; index++) {
+        pCurPacket = jitterBufferPeekPacket(pJitterBuffer, index);
+        CHK(pCurPacket != NULL, STATUS_RTP_JITTER_BUFFER_MISSING_PACKET);
+        CHK_STATUS(depayIovFn(pCurPacket->payload, pCurPacket->payloadLength, pFrameIovArray));
+    }
+
+CleanUp:
+    CHK_LOG_ERR(retStatus);
+
+    LEAVES();
+    return retStatus;
+}
+
+// Looks up the buffered packet with the sequence number, *ppRtpPacket is NULL when it has not been received
+STATUS jitterBufferGetPacket(PJitterBuffer pJitterBuffer, UINT16 seqNum, PRtpPacket* ppRtpPacket)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+
+    CHK(pJitterBuffer != NULL && ppRtpPacket != NULL, STATUS_NULL_ARG);
+
+    *ppRtpPacket = jitterBufferPeekPacket(pJitterBuffer, seqNum);
+
+CleanUp:
+    return retStatus;
+}
@@ -14,8 +14,16 @@ typedef STATUS (*FrameReadyFunc)(UINT64, UINT16, UINT16, UINT32);
 typedef STATUS (*FrameDroppedFunc)(UINT64, UINT16, UINT16, UINT32);
 #define UINT16_DEC(a) ((UINT16) ((a) - 1))
 
-#define JITTER_BUFFER_HASH_TABLE_BUCKET_COUNT  3000
-#define JITTER_BUFFER_HASH_TABLE_BUCKET_LENGTH 2
+// Packets are stored in a ring indexed by sequence number, the ring doubles when two buffered packets map to the same slot
+// until it reaches maxPacketRingCapacity
+#define JITTER_BUFFER_DEFAULT_PACKET_RING_CAPACITY 1024
+#define JITTER_BUFFER_MAX_PACKET_RING_CAPACITY     (MAX_RTP_SEQUENCE_NUM + 1)
+
+// Packets per second the ring is sized for. It doesn't grow past what arrives within maxLatency at this rate
+#define JITTER_BUFFER_MAX_PACKET_RATE 4096
+
+#define JITTER_BUFFER_PACKET_RING_SLOT(pJitterBuffer, seqNum) ((UINT32) (seqNum) & ((pJitterBuffer)->packetRingCapacity - 1))
+#define JITTER_BUFFER_PACKET_PRESENT(pJitterBuffer, slot)     (((pJitterBuffer)->pPacketPresenceBitmap[(slot) >> 6] >> ((slot) & 63)) & 1)
 
 typedef struct {
     FrameReadyFunc onFrameReadyFn;
@@ -41,7 +49,21 @@ typedef struct {
     BOOL firstFrameProcessed;
     BOOL sequenceNumberOverflowState;
     BOOL timestampOverFlowState;
-    PHashTable pPkgBufferHashTable;
+    // power of two sized ring of buffered packets and the bitmap of its occupied slots
+    PRtpPacket* pPacketRing;
+    PUINT64 pPacketPresenceBitmap;
+    UINT32 packetRingCapacity;
+    // the ring doesn't grow past this, derived from maxLatency and clockRate
+    UINT32 maxPacketRingCapacity;
+    // where the previous jitterBufferInternalParse stopped, valid as long as the head and the packets
+    // before parseSequenceNumber have not changed since
+    BOOL parseStateValid;
+    UINT16 parseSequenceNumber;
+    UINT16 parseHeadSequenceNumber;
+    UINT32 parseHeadTimestamp;
+    UINT32 parseFrameSize;
+    BOOL parseContainStart;
+    BOOL parseFrameDataContinuous;
 } JitterBuffer, *PJitterBuffer;
 
 // constructor
@@ -51,6 +73,8 @@ STATUS freeJitterBuffer(PJitterBuffer*);
 STATUS jitterBufferPush(PJitterBuffer, PRtpPacket, PBOOL);
 STATUS jitterBufferDropBufferData(PJitterBuffer, UINT16, UINT16, UINT32);
 STATUS jitterBufferFillFrameData(PJitterBuffer, PBYTE, UINT32, PUINT32, UINT16, UINT16);
+STATUS jitterBufferFillFrameIov(PJitterBuffer, DepayRtpPayloadIovFunc, PFrameIovArray, UINT16, UINT16);
+STATUS jitterBufferGetPacket(PJitterBuffer, UINT16, PRtpPacket*);
 
 #ifdef __cplusplus
 }
@@ -242,7 +242,7 @@ STATUS sendPacketToRtpReceiver(PKvsPeerConnection pKvsPeerConnection, PBYTE pBuf
     UINT64 item, now;
     UINT32 ssrc;
     PRtpPacket pRtpPacket = NULL;
-    PBYTE pPayload = NULL;
+    INT32 packetLen = 0;
     BOOL ownedByJitterBuffer = FALSE, discarded = FALSE;
     UINT64 packetsReceived = 0, packetsFailedDecryption = 0, lastPacketReceivedTimestamp = 0, headerBytesReceived = 0, bytesReceived = 0,
            packetsDiscarded = 0;
@@ -260,18 +260,20 @@ STATUS sendPacketToRtpReceiver(PKvsPeerConnection pKvsPeerConnection, PBYTE pBuf
 
         if (pTransceiver->jitterBufferSsrc == ssrc) {
             packetsReceived++;
-            if (STATUS_FAILED(retStatus = decryptSrtpPacket(pKvsPeerConnection->pSrtpSession, pBuffer, (PINT32) &bufferLen))) {
+            // This is not a zero copy path: the listener reuses its receive buffer for the next datagram, so every
+            // packet is copied once into a pooled slot. It is decrypted in place there and handed to the jitter buffer,
+            // which returns the slot to the pool when done
+            CHK_STATUS(rtpPacketPoolGetPacket(pTransceiver->receivePacketPool, bufferLen, &pRtpPacket));
+            MEMCPY(pRtpPacket->pRawPacket, pBuffer, bufferLen);
+            packetLen = (INT32) bufferLen;
+            if (STATUS_FAILED(retStatus = decryptSrtpPacket(pKvsPeerConnection->pSrtpSession, pRtpPacket->pRawPacket, &packetLen))) {
                 DLOGW("decryptSrtpPacket failed with 0x%08x", retStatus);
                 packetsFailedDecryption++;
                 CHK(FALSE, STATUS_SUCCESS);
             }
             now = GETTIME();
-            CHK(NULL != (pPayload = (PBYTE) MEMALLOC(bufferLen)), STATUS_NOT_ENOUGH_MEMORY);
-            MEMCPY(pPayload, pBuffer, bufferLen);
-            CHK_STATUS(createRtpPacketFromBytes(pPayload, bufferLen, &pRtpPacket));
-            // pRtpPacket took ownership of pPayload. Set pPayload to NULL to
-            // avoid possible double-free.
-            pPayload = NULL;
+            pRtpPacket->rawPacketLength = (UINT32) packetLen;
+            CHK_STATUS(setRtpPacketFromBytes(pRtpPacket->pRawPacket, pRtpPacket->rawPacketLength, pRtpPacket));
             pRtpPacket->receivedTime = now;
 
             // https://tools.ietf.org/html/rfc3550#section-6.4.1
@@ -315,7 +317,6 @@ CleanUp:
         MUTEX_UNLOCK(pTransceiver->statsLock);
     }
     if (!ownedByJitterBuffer) {
-        SAFE_MEMFREE(pPayload);
         freeRtpPacket(&pRtpPacket);
         CHK_LOG_ERR(retStatus);
     }
@@ -385,19 +386,12 @@ STATUS onFrameReadyFunc(UINT64 customData, UINT16 startIndex, UINT16 endIndex, U
     PKvsRtpTransceiver pTransceiver = (PKvsRtpTransceiver) customData;
     PRtpPacket pPacket = NULL;
     Frame frame;
-    UINT64 hashValue;
-    UINT32 filledSize = 0, index;
+    UINT32 filledSize = 0, index, iovIndex;
 
     CHK(pTransceiver != NULL, STATUS_NULL_ARG);
 
     // TODO: handle multi-packet frames
-    retStatus = hashTableGet(pTransceiver->pJitterBuffer->pPkgBufferHashTable, startIndex, &hashValue);
-    pPacket = (PRtpPacket) hashValue;
-    if (retStatus == STATUS_SUCCESS || retStatus == STATUS_HASH_KEY_NOT_PRESENT) {
-        retStatus = STATUS_SUCCESS;
-    } else {
-        CHK(FALSE, retStatus);
-    }
+    CHK_STATUS(jitterBufferGetPacket(pTransceiver->pJitterBuffer, startIndex, &pPacket));
     CHK(pPacket != NULL, STATUS_NULL_ARG);
     MUTEX_LOCK(pTransceiver->statsLock);
     // https://www.w3.org/TR/webrtc-stats/#dom-rtcinboundrtpstreamstats-jitterbufferdelay
@@ -409,26 +403,41 @@ STATUS onFrameReadyFunc(UINT64 customData, UINT16 startIndex, UINT16 endIndex, U
     }
     MUTEX_UNLOCK(pTransceiver->statsLock);
 
-    if (frameSize > pTransceiver->peerFrameBufferSize) {
-        MEMFREE(pTransceiver->peerFrameBuffer);
-        pTransceiver->peerFrameBufferSize = (UINT32) (frameSize * PEER_FRAME_BUFFER_SIZE_INCREMENT_FACTOR);
-        pTransceiver->peerFrameBuffer = (PBYTE) MEMALLOC(pTransceiver->peerFrameBufferSize);
-        CHK(pTransceiver->peerFrameBuffer != NULL, STATUS_NOT_ENOUGH_MEMORY);
-    }
-
-    CHK_STATUS(jitterBufferFillFrameData(pTransceiver->pJitterBuffer, pTransceiver->peerFrameBuffer, frameSize, &filledSize, startIndex, endIndex));
-    CHK(frameSize == filledSize, STATUS_INVALID_ARG_LEN);
-
     frame.version = FRAME_CURRENT_VERSION;
     frame.decodingTs = pPacket->header.timestamp * HUNDREDS_OF_NANOS_IN_A_MILLISECOND;
     frame.presentationTs = frame.decodingTs;
-    frame.frameData = pTransceiver->peerFrameBuffer;
-    frame.size = frameSize;
     frame.duration = 0;
     frame.index = index;
     // TODO: Fill frame flag and track id and index if we need to, currently those are not used by RtcRtpTransceiver
-    if (pTransceiver->onFrame != NULL) {
-        pTransceiver->onFrame(pTransceiver->onFrameCustomData, &frame);
+
+    // Scatter-gather delivery hands out slices of the buffered packets, which the jitter buffer only drops after we return
+    if (pTransceiver->onFrameIov != NULL && pTransceiver->depayIovFn != NULL) {
+        CHK_STATUS(jitterBufferFillFrameIov(pTransceiver->pJitterBuffer, pTransceiver->depayIovFn, &pTransceiver->peerFrameIovArray, startIndex,
+                                            endIndex));
+        frame.frameData = NULL;
+        frame.size = 0;
+        for (iovIndex = 0; iovIndex < pTransceiver->peerFrameIovArray.iovCount; iovIndex++) {
+            frame.size += pTransceiver->peerFrameIovArray.pIovs[iovIndex].size;
+        }
+        pTransceiver->onFrameIov(pTransceiver->onFrameIovCustomData, &frame, pTransceiver->peerFrameIovArray.pIovs,
+                                 pTransceiver->peerFrameIovArray.iovCount);
+    } else {
+        if (frameSize > pTransceiver->peerFrameBufferSize) {
+            MEMFREE(pTransceiver->peerFrameBuffer);
+            pTransceiver->peerFrameBufferSize = (UINT32) (frameSize * PEER_FRAME_BUFFER_SIZE_INCREMENT_FACTOR);
+            pTransceiver->peerFrameBuffer = (PBYTE) MEMALLOC(pTransceiver->peerFrameBufferSize);
+            CHK(pTransceiver->peerFrameBuffer != NULL, STATUS_NOT_ENOUGH_MEMORY);
+        }
+
+        CHK_STATUS(
+            jitterBufferFillFrameData(pTransceiver->pJitterBuffer, pTransceiver->peerFrameBuffer, frameSize, &filledSize, startIndex, endIndex));
+        CHK(frameSize == filledSize, STATUS_INVALID_ARG_LEN);
+
+        frame.frameData = pTransceiver->peerFrameBuffer;
+        frame.size = frameSize;
+        if (pTransceiver->onFrame != NULL) {
+            pTransceiver->onFrame(pTransceiver->onFrameCustomData, &frame);
+        }
     }
 
 CleanUp:
@@ -443,18 +452,11 @@ STATUS onFrameDroppedFunc(UINT64 customData, UINT16 startIndex, UINT16 endIndex,
     ENTERS();
     UNUSED_PARAM(endIndex);
     STATUS retStatus = STATUS_SUCCESS;
-    UINT64 hashValue = 0;
     PRtpPacket pPacket = NULL;
     PKvsRtpTransceiver pTransceiver = (PKvsRtpTransceiver) customData;
     DLOGW("Frame with timestamp %ld is dropped!", timestamp);
     CHK(pTransceiver != NULL, STATUS_NULL_ARG);
-    retStatus = hashTableGet(pTransceiver->pJitterBuffer->pPkgBufferHashTable, startIndex, &hashValue);
-    pPacket = (PRtpPacket) hashValue;
-    if (retStatus == STATUS_SUCCESS || retStatus == STATUS_HASH_KEY_NOT_PRESENT) {
-        retStatus = STATUS_SUCCESS;
-    } else {
-        CHK(FALSE, retStatus);
-    }
+    CHK_STATUS(jitterBufferGetPacket(pTransceiver->pJitterBuffer, startIndex, &pPacket));
     CHK(pPacket != NULL, STATUS_NULL_ARG);
     MUTEX_LOCK(pTransceiver->statsLock);
     // https://www.w3.org/TR/webrtc-stats/#dom-rtcinboundrtpstreamstats-jitterbufferdelay
@@ -471,27 +473,13 @@ CleanUp:
     return retStatus;
 }
 
-PVOID dtlsSessionStartThread(PVOID args)
-{
-    ENTERS();
-    PKvsPeerConnection pKvsPeerConnection = (PKvsPeerConnection) args;
-    if (pKvsPeerConnection != NULL) {
-        dtlsSessionHandshakeInThread(pKvsPeerConnection->pDtlsSession, pKvsPeerConnection->dtlsIsServer);
-    } else {
-        DLOGE("Peer connection object NULL, cannot start DTLS handshake");
-    }
-
-    LEAVES();
-    return NULL;
-}
-
 VOID onIceConnectionStateChange(UINT64 customData, UINT64 connectionState)
 {
     ENTERS();
     STATUS retStatus = STATUS_SUCCESS;
     PKvsPeerConnection pKvsPeerConnection = (PKvsPeerConnection) customData;
     RTC_PEER_CONNECTION_STATE newConnectionState = RTC_PEER_CONNECTION_STATE_NEW;
-    BOOL startDtlsSession = FALSE, dtlsConnected;
+    BOOL startDtlsSession = FALSE, dtlsConnected = FALSE;
 
     CHK(pKvsPeerConnection != NULL, STATUS_NULL_ARG);
 
@@ -505,7 +493,11 @@ VOID onIceConnectionStateChange(UINT64 customData, UINT64 connectionState)
             break;
 
         case ICE_AGENT_STATE_CONNECTED:
-            /* explicit fall-through */
+            newConnectionState = RTC_PEER_CONNECTION_STATE_CONNECTING;
+            /* with the first pair fast path dtls starts on the first succeeded pair instead of waiting for nomination */
+            startDtlsSession = pKvsPeerConnection->pIceAgent->kvsRtcConfiguration.enableIceFirstPairFastPath;
+            break;
+
         case ICE_AGENT_STATE_NOMINATING:
             newConnectionState = RTC_PEER_CONNECTION_STATE_CONNECTING;
             break;
@@ -529,22 +521,30 @@ VOID onIceConnectionStateChange(UINT64 customData, UINT64 connectionState)
             break;
     }
 
-    if (startDtlsSession) {
+    if (newConnectionState == RTC_PEER_CONNECTION_STATE_CONNECTING) {
         CHK_STATUS(dtlsSessionIsInitFinished(pKvsPeerConnection->pDtlsSession, &dtlsConnected));
-        if (dtlsConnected) {
-            // In ICE restart scenario, DTLS handshake is not going to be reset. Therefore, we need to check
-            // if the DTLS state has been connected.
+    }
+
+    if (dtlsConnected) {
+        // In ICE restart scenario, DTLS handshake is not going to be reset. Therefore, we need to check
+        // if the DTLS state has been connected.
+        if (startDtlsSession) {
             newConnectionState = RTC_PEER_CONNECTION_STATE_CONNECTED;
         } else {
+            // Ice is still settling after dtls finished, like nominating after the first pair fast path. Going back to
+            // CONNECTING would flap the state seen by the application and profile the hole punching time again.
+            CHK(FALSE, retStatus);
+        }
+    } else if (startDtlsSession) {
+        if (!pKvsPeerConnection->dtlsSessionStarted) {
+            pKvsPeerConnection->dtlsSessionStarted = TRUE;
             // PeerConnection's state changes to CONNECTED only when DTLS state is also connected. So, we need
             // wait until DTLS state changes to CONNECTED.
             //
             // Reference: https://w3c.github.io/webrtc-pc/#rtcpeerconnectionstate-enum
-#if defined(ENABLE_KVS_THREADPOOL) && defined(KVS_USE_OPENSSL)
-            CHK_STATUS(threadpoolContextPush(dtlsSessionStartThread, (PVOID) pKvsPeerConnection));
-#else
+            //
+            // The handshake is then driven by the inbound packets and the session timer, no thread waits on it.
             CHK_STATUS(dtlsSessionStart(pKvsPeerConnection->pDtlsSession, pKvsPeerConnection->dtlsIsServer));
-#endif
         }
     }
 
@@ -766,7 +766,7 @@ STATUS rtcpReportsCallback(UINT32 timerId, UINT64 currentTime, UINT64 customData
         DLOGV("sender report %u %" PRIu64 " %" PRIu64 " : %u packets %u bytes", ssrc, ntpTime, rtpTime, packetCount, octetCount);
         packetLen = RTCP_PACKET_HEADER_LEN + 24;
 
-        // srtp_protect_rtcp() in encryptRtcpPacket() assumes memory availability to write 10 bytes of authentication tag and
+        // srtp_protect_rtcp() in encryptRtcpPacket() assumes memory availability to write SRTP_AUTH_TAG_OVERHEAD bytes of authentication tag and
         // SRTP_MAX_TRAILER_LEN + 4 following the actual rtcp Packet payload
         allocSize = packetLen + SRTP_AUTH_TAG_OVERHEAD + SRTP_MAX_TRAILER_LEN + 4;
         CHK(NULL != (rawPacket = (PBYTE) MEMALLOC(allocSize)), STATUS_NOT_ENOUGH_MEMORY);
@@ -948,6 +948,9 @@ STATUS createPeerConnection(PRtcConfiguration pConfiguration, PRtcPeerConnection
     PConnectionListener pConnectionListener = NULL;
     UINT64 startTime = 0;
     UINT64 startTimeInMacro = 0;
+    RtcCertificate pooledCertificates[MAX_RTCCONFIGURATION_CERTIFICATES];
+    PRtcCertificate pCertificates = NULL;
+    PDtlsCertificatePoolEntry pCertificatePoolEntry = NULL;
 
     CHK(pConfiguration != NULL && ppPeerConnection != NULL, STATUS_NULL_ARG);
 
@@ -966,10 +969,22 @@ STATUS createPeerConnection(PRtcConfiguration pConfiguration, PRtcPeerConnection
     CHK_STATUS(generateJSONSafeString(pKvsPeerConnection->localIcePwd, LOCAL_ICE_PWD_LEN));
     CHK_STATUS(generateJSONSafeString(pKvsPeerConnection->localCNAME, LOCAL_CNAME_LEN));
 
-    PROFILE_CALL(CHK_STATUS(createDtlsSession(
-                     &dtlsSessionCallbacks, pKvsPeerConnection->timerQueueHandle, pConfiguration->kvsRtcConfiguration.generatedCertificateBits,
-                     pConfiguration->kvsRtcConfiguration.generateRSACertificate, pConfiguration->certificates, &pKvsPeerConnection->pDtlsSession)),
+    pCertificates = pConfiguration->certificates;
+    if (pConfiguration->kvsRtcConfiguration.enableCertificatePool && pConfiguration->certificates[0].pCertificate == NULL) {
+        // the session takes its own reference or copy, the pooled certificate is released right after
+        MEMSET(pooledCertificates, 0x00, SIZEOF(pooledCertificates));
+        CHK_STATUS(dtlsCertificatePoolAcquire(pConfiguration->kvsRtcConfiguration.generatedCertificateBits,
+                                              pConfiguration->kvsRtcConfiguration.generateRSACertificate, &pooledCertificates[0],
+                                              &pCertificatePoolEntry));
+        pCertificates = pooledCertificates;
+    }
+
+    PROFILE_CALL(CHK_STATUS(createDtlsSession(&dtlsSessionCallbacks, pKvsPeerConnection->timerQueueHandle,
+                                              pConfiguration->kvsRtcConfiguration.generatedCertificateBits,
+                                              pConfiguration->kvsRtcConfiguration.generateRSACertificate, pCertificates,
+                                              &pKvsPeerConnection->pDtlsSession)),
                  "Create DTLS Session object");
+    CHK_STATUS(dtlsCertificatePoolRelease(&pCertificatePoolEntry));
     CHK_STATUS(dtlsSessionOnOutBoundData(pKvsPeerConnection->pDtlsSession, (UINT64) pKvsPeerConnection, onDtlsOutboundPacket));
     CHK_STATUS(dtlsSessionOnStateChange(pKvsPeerConnection->pDtlsSession, (UINT64) pKvsPeerConnection, onDtlsStateChange));
 
@@ -994,8 +1009,15 @@ STATUS createPeerConnection(PRtcConfiguration pConfiguration, PRtcPeerConnection
     iceAgentCallbacks.newLocalCandidateFn = onNewIceLocalCandidate;
     iceAgentCallbacks.setStunServerIpFn = onSetStunServerIp;
 
-    PROFILE_CALL(CHK_STATUS(createConnectionListener(&pConnectionListener)), "Create connection listener");
-    // IceAgent will own the lifecycle of pConnectionListener;
+    if (pConfiguration->kvsRtcConfiguration.connectionListenerWorkerCount > 0) {
+        // The process wide listener lives until deinitKvsWebRtc
+        PROFILE_CALL(
+            CHK_STATUS(sharedConnectionListenerAcquire(pConfiguration->kvsRtcConfiguration.connectionListenerWorkerCount, &pConnectionListener)),
+            "Acquire shared connection listener");
+    } else {
+        PROFILE_CALL(CHK_STATUS(createConnectionListener(&pConnectionListener)), "Create connection listener");
+    }
+    // IceAgent will own the lifecycle of pConnectionListener unless it's shared;
     PROFILE_CALL(CHK_STATUS(createIceAgent(pKvsPeerConnection->localIceUfrag, pKvsPeerConnection->localIcePwd, &iceAgentCallbacks, pConfiguration,
                                            pKvsPeerConnection->timerQueueHandle, pConnectionListener, &pKvsPeerConnection->pIceAgent)),
                  "Create ICE agent object");
@@ -1016,6 +1038,9 @@ CleanUp:
 
     CHK_LOG_ERR(retStatus);
 
+    // the call is idempotent
+    dtlsCertificatePoolRelease(&pCertificatePoolEntry);
+
     if (STATUS_FAILED(retStatus)) {
         freePeerConnection((PRtcPeerConnection*) &pKvsPeerConnection);
     } else {
@@ -1563,6 +1588,7 @@ STATUS addTransceiver(PRtcPeerConnection pPeerConnection, PRtcMediaStreamTrack p
     PKvsPeerConnection pKvsPeerConnection = (PKvsPeerConnection) pPeerConnection;
     PJitterBuffer pJitterBuffer = NULL;
     DepayRtpPayloadFunc depayFunc;
+    DepayRtpPayloadIovFunc depayIovFunc;
     UINT32 clockRate = 0;
     UINT32 ssrc = (UINT32) RAND(), rtxSsrc = (UINT32) RAND();
     RTC_RTP_TRANSCEIVER_DIRECTION direction = RTC_RTP_TRANSCEIVER_DIRECTION_SENDRECV;
@@ -1588,26 +1614,31 @@ STATUS addTransceiver(PRtcPeerConnection pPeerConnection, PRtcMediaStreamTrack p
     switch (pRtcMediaStreamTrack->codec) {
         case RTC_CODEC_OPUS:
             depayFunc = depayOpusFromRtpPayload;
+            depayIovFunc = depayOpusIovFromRtpPayload;
             clockRate = OPUS_CLOCKRATE;
             break;
 
         case RTC_CODEC_MULAW:
         case RTC_CODEC_ALAW:
             depayFunc = depayG711FromRtpPayload;
+            depayIovFunc = depayG711IovFromRtpPayload;
             clockRate = PCM_CLOCKRATE;
             break;
 
         case RTC_CODEC_H264_PROFILE_42E01F_LEVEL_ASYMMETRY_ALLOWED_PACKETIZATION_MODE:
             depayFunc = depayH264FromRtpPayload;
+            depayIovFunc = depayH264IovFromRtpPayload;
             clockRate = VIDEO_CLOCKRATE;
             break;
 
         case RTC_CODEC_VP8:
             depayFunc = depayVP8FromRtpPayload;
+            depayIovFunc = depayVP8IovFromRtpPayload;
             clockRate = VIDEO_CLOCKRATE;
             break;
         case RTC_CODEC_H265:
             depayFunc = depayH265FromRtpPayload;
+            depayIovFunc = depayH265IovFromRtpPayload;
             clockRate = VIDEO_CLOCKRATE;
             break;
 
@@ -1618,6 +1649,7 @@ STATUS addTransceiver(PRtcPeerConnection pPeerConnection, PRtcMediaStreamTrack p
     // TODO: Add ssrc duplicate detection here not only relying on RAND()
     CHK_STATUS(createKvsRtpTransceiver(direction, pKvsPeerConnection, ssrc, rtxSsrc, pRtcMediaStreamTrack, NULL, pRtcMediaStreamTrack->codec,
                                        &pKvsRtpTransceiver));
+    pKvsRtpTransceiver->depayIovFn = depayIovFunc;
     CHK_STATUS(createJitterBuffer(onFrameReadyFunc, onFrameDroppedFunc, depayFunc, DEFAULT_JITTER_BUFFER_MAX_LATENCY, clockRate,
                                   (UINT64) pKvsRtpTransceiver, &pJitterBuffer));
     CHK_STATUS(kvsRtpTransceiverSetJitterBuffer(pKvsRtpTransceiver, pJitterBuffer));
@@ -1708,6 +1740,8 @@ STATUS restartIce(PRtcPeerConnection pPeerConnection)
     CHK_STATUS(generateJSONSafeString(pKvsPeerConnection->localIcePwd, LOCAL_ICE_PWD_LEN));
     pKvsPeerConnection->remoteIceUfrag[0] = '\0';
     pKvsPeerConnection->remoteIcePwd[0] = '\0';
+    // The dtls session outlives the restart, an unfinished handshake is started again once the new ice pair is up
+    pKvsPeerConnection->dtlsSessionStarted = FALSE;
     CHK_STATUS(iceAgentRestart(pKvsPeerConnection->pIceAgent, pKvsPeerConnection->localIceUfrag, pKvsPeerConnection->localIcePwd));
 
 CleanUp:
@@ -1726,6 +1760,7 @@ STATUS closePeerConnection(PRtcPeerConnection pPeerConnection)
     CHK(pKvsPeerConnection != NULL, STATUS_NULL_ARG);
     CHK_LOG_ERR(dtlsSessionShutdown(pKvsPeerConnection->pDtlsSession));
     CHK_LOG_ERR(iceAgentShutdown(pKvsPeerConnection->pIceAgent));
+    pKvsPeerConnection->dtlsSessionStarted = FALSE;
     PROFILE_WITH_START_TIME_OBJ(startTime, pKvsPeerConnection->peerConnectionDiagnostics.closePeerConnectionTime, "Close peer connection");
 
 CleanUp:
@@ -1771,6 +1806,12 @@ STATUS initKvsWebRtc(VOID)
     LOG_GIT_HASH();
 
     SET_INSTRUMENTED_ALLOCATORS();
+    CHK_STATUS(createSharedConnectionListener());
+    CHK_STATUS(createTurnAllocationPool());
+    CHK_STATUS(createIceCandidateCache());
+    CHK_STATUS(createDtlsCertificatePool());
+    CHK_STATUS(createDtlsContextCache());
+    CHK_STATUS(createRtpBroadcastPool());
 #ifdef ENABLE_DATA_CHANNEL
     CHK_STATUS(initSctpSession());
 #endif
@@ -1845,6 +1886,19 @@ STATUS deinitKvsWebRtc(VOID)
     deinitSctpSession();
 #endif
 
+    // allocations still in the pool are idle since every peer connection is gone
+    freeTurnAllocationPool();
+    // every socket left with the peer connections and the turn allocations
+    freeSharedConnectionListener();
+    // pooled sockets are not owned by any peer connection
+    freeIceCandidateCache();
+    // stops generating certificates ahead of time
+    freeDtlsCertificatePool();
+    // contexts are released by the dtls sessions, nothing should be left
+    freeDtlsContextCache();
+    // waits for threadpool tasks still holding a broadcast, so it goes before the threadpool
+    freeRtpBroadcastPool();
+
     srtp_shutdown();
 
 #ifdef ENABLE_KVS_THREADPOOL
@@ -1976,6 +2030,8 @@ STATUS peerConnectionGetMetrics(PRtcPeerConnection pPeerConnection, PPeerConnect
     }
     MUTEX_UNLOCK(pWebRtcClientContext->stunCtxlock);
 #endif
+    CHK_STATUS(dtlsCertificatePoolGetHitCounts(&pPeerConnectionMetrics->peerConnectionStats.certificatePoolHitCount,
+                                               &pPeerConnectionMetrics->peerConnectionStats.certificatePoolMissCount));
 
     pPeerConnectionMetrics->peerConnectionStats.peerConnectionCreationTime = pKvsPeerConnection->peerConnectionDiagnostics.peerConnectionCreationTime;
     pPeerConnectionMetrics->peerConnectionStats.dtlsSessionSetupTime = pKvsPeerConnection->peerConnectionDiagnostics.dtlsSessionSetupTime;
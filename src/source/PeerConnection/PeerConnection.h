@@ -81,6 +81,8 @@ typedef struct {
     PIceAgent pIceAgent;
     PDtlsSession pDtlsSession;
     BOOL dtlsIsServer;
+    // Set once the handshake is started, either when ice is ready or on the first succeeded pair with the first pair fast path
+    BOOL dtlsSessionStarted;
 
     MUTEX pSrtpSessionLock;
     PSrtpSession pSrtpSession;
@@ -2,7 +2,7 @@
 
 #include "../Include_i.h"
 
-typedef STATUS (*RtpPayloadFunc)(UINT32, PBYTE, UINT32, PBYTE, PUINT32, PUINT32, PUINT32);
+typedef STATUS (*RtpPayloadFunc)(UINT32, PBYTE, UINT32, PPayloadArray);
 
 STATUS createKvsRtpTransceiver(RTC_RTP_TRANSCEIVER_DIRECTION direction, PKvsPeerConnection pKvsPeerConnection, UINT32 ssrc, UINT32 rtxSsrc,
                                PRtcMediaStreamTrack pRtcMediaStreamTrack, PJitterBuffer pJitterBuffer, RTC_CODEC rtcCodec,
@@ -26,6 +26,12 @@ STATUS createKvsRtpTransceiver(RTC_RTP_TRANSCEIVER_DIRECTION direction, PKvsPeer
     pKvsRtpTransceiver->sender.track = *pRtcMediaStreamTrack;
     pKvsRtpTransceiver->sender.packetBuffer = NULL;
     pKvsRtpTransceiver->sender.retransmitter = NULL;
+    // Slots fit a full MTU payload together with the largest header we generate and the SRTP auth tag
+    CHK_STATUS(createRtpPacketPool((pKvsPeerConnection->MTU == 0 ? DEFAULT_MTU_SIZE_BYTES : pKvsPeerConnection->MTU) +
+                                       RTP_PACKET_POOL_MAX_HEADER_LEN + SRTP_AUTH_TAG_OVERHEAD,
+                                   DEFAULT_RTP_PACKET_POOL_SLAB_SLOT_COUNT, &pKvsRtpTransceiver->sender.packetPool));
+    CHK_STATUS(createRtpPacketPool(DEFAULT_RTP_RECEIVE_PACKET_POOL_SLOT_SIZE, DEFAULT_RTP_PACKET_POOL_SLAB_SLOT_COUNT,
+                                   &pKvsRtpTransceiver->receivePacketPool));
     pKvsRtpTransceiver->pJitterBuffer = pJitterBuffer;
     pKvsRtpTransceiver->transceiver.receiver.track.codec = rtcCodec;
     pKvsRtpTransceiver->transceiver.receiver.track.kind = pRtcMediaStreamTrack->kind;
@@ -152,11 +158,17 @@ STATUS freeKvsRtpTransceiver(PKvsRtpTransceiver* ppKvsRtpTransceiver)
         freeRetransmitter(&pKvsRtpTransceiver->sender.retransmitter);
     }
 
+    // The jitter buffer and the rolling buffer hold references to pooled packets so the pools have to go after them
+    freeRtpPacketPool(&pKvsRtpTransceiver->sender.packetPool);
+    freeRtpPacketPool(&pKvsRtpTransceiver->receivePacketPool);
+
     freeRollingBufferConfig(pKvsRtpTransceiver->pRollingBufferConfig);
 
     MUTEX_FREE(pKvsRtpTransceiver->statsLock);
 
     SAFE_MEMFREE(pKvsRtpTransceiver->peerFrameBuffer);
+    SAFE_MEMFREE(pKvsRtpTransceiver->peerFrameIovArray.pIovs);
+    SAFE_MEMFREE(pKvsRtpTransceiver->peerFrameIovArray.pScratch);
     SAFE_MEMFREE(pKvsRtpTransceiver->sender.payloadArray.payloadBuffer);
     SAFE_MEMFREE(pKvsRtpTransceiver->sender.payloadArray.payloadSubLength);
 
@@ -198,6 +210,23 @@ CleanUp:
     return retStatus;
 }
 
+STATUS transceiverOnFrameIov(PRtcRtpTransceiver pRtcRtpTransceiver, UINT64 customData, RtcOnFrameIov rtcOnFrameIov)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    PKvsRtpTransceiver pKvsRtpTransceiver = (PKvsRtpTransceiver) pRtcRtpTransceiver;
+
+    CHK(pKvsRtpTransceiver != NULL && rtcOnFrameIov != NULL, STATUS_NULL_ARG);
+
+    pKvsRtpTransceiver->onFrameIov = rtcOnFrameIov;
+    pKvsRtpTransceiver->onFrameIovCustomData = customData;
+
+CleanUp:
+
+    LEAVES();
+    return retStatus;
+}
+
 STATUS transceiverOnBandwidthEstimation(PRtcRtpTransceiver pRtcRtpTransceiver, UINT64 customData, RtcOnBandwidthEstimation rtcOnBandwidthEstimation)
 {
     ENTERS();
@@ -259,15 +288,63 @@ CleanUp:
     return retStatus;
 }
 
-STATUS writeFrame(PRtcRtpTransceiver pRtcRtpTransceiver, PFrame pFrame)
+static STATUS getRtpPayloadFunc(RTC_CODEC codec, UINT64 presentationTs, RtpPayloadFunc* pRtpPayloadFunc, PUINT64 pRtpTimestamp)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+
+    switch (codec) {
+        case RTC_CODEC_H264_PROFILE_42E01F_LEVEL_ASYMMETRY_ALLOWED_PACKETIZATION_MODE:
+            *pRtpPayloadFunc = createPayloadArrayForH264;
+            *pRtpTimestamp = CONVERT_TIMESTAMP_TO_RTP(VIDEO_CLOCKRATE, presentationTs);
+            break;
+
+        case RTC_CODEC_H265:
+            *pRtpPayloadFunc = createPayloadArrayForH265;
+            *pRtpTimestamp = CONVERT_TIMESTAMP_TO_RTP(VIDEO_CLOCKRATE, presentationTs);
+            break;
+
+        case RTC_CODEC_OPUS:
+            *pRtpPayloadFunc = createPayloadArrayForOpus;
+            *pRtpTimestamp = CONVERT_TIMESTAMP_TO_RTP(OPUS_CLOCKRATE, presentationTs);
+            break;
+
+        case RTC_CODEC_MULAW:
+        case RTC_CODEC_ALAW:
+            *pRtpPayloadFunc = createPayloadArrayForG711;
+            *pRtpTimestamp = CONVERT_TIMESTAMP_TO_RTP(PCM_CLOCKRATE, presentationTs);
+            break;
+
+        case RTC_CODEC_VP8:
+            *pRtpPayloadFunc = createPayloadArrayForVP8;
+            *pRtpTimestamp = CONVERT_TIMESTAMP_TO_RTP(VIDEO_CLOCKRATE, presentationTs);
+            break;
+
+        default:
+            CHK(FALSE, STATUS_NOT_IMPLEMENTED);
+    }
+
+CleanUp:
+
+    return retStatus;
+}
+
+/*
+ * Sends a frame over a single transceiver. When pSharedPayloadArray is NULL the frame is packetized into the
+ * transceiver's own payload array, otherwise the already packetized frame is only read from and can be shared
+ * with other transceivers sending the same frame concurrently.
+ */
+static STATUS sendFrameWithPayloadArray(PKvsRtpTransceiver pKvsRtpTransceiver, PFrame pFrame, PPayloadArray pSharedPayloadArray)
 {
     STATUS retStatus = STATUS_SUCCESS;
     PKvsPeerConnection pKvsPeerConnection = NULL;
-    PKvsRtpTransceiver pKvsRtpTransceiver = (PKvsRtpTransceiver) pRtcRtpTransceiver;
     BOOL locked = FALSE, bufferAfterEncrypt = FALSE;
-    PRtpPacket pPacketList = NULL, pRtpPacket = NULL;
+    PRtpPacket pRtpPacket = NULL, pEncryptedPacket = NULL;
+    PRtpPacket batchPackets[MAX_RTP_SEND_BATCH_PACKET_COUNT], batchEncryptedPackets[MAX_RTP_SEND_BATCH_PACKET_COUNT];
+    PBYTE batchBuffers[MAX_RTP_SEND_BATCH_PACKET_COUNT];
+    UINT32 batchLengths[MAX_RTP_SEND_BATCH_PACKET_COUNT], batchCount = 0, j;
     UINT32 i = 0, packetLen = 0, headerLen = 0, allocSize;
-    PBYTE rawPacket = NULL;
+    UINT16 startSequenceNumber = 0;
+    PBYTE rawPacket = NULL, curPtrInPayload = NULL;
     PPayloadArray pPayloadArray = NULL;
     RtpPayloadFunc rtpPayloadFunc = NULL;
     UINT64 randomRtpTimeoffset = 0; // TODO: spec requires random rtp time offset
@@ -286,9 +363,8 @@ STATUS writeFrame(PRtcRtpTransceiver pRtcRtpTransceiver, PFrame pFrame)
     UINT32 extpayload;
     STATUS sendStatus;
 
-    CHK(pKvsRtpTransceiver != NULL && pFrame != NULL, STATUS_NULL_ARG);
+    CHK(pKvsRtpTransceiver->sender.packetPool != NULL, STATUS_INVALID_OPERATION);
     pKvsPeerConnection = pKvsRtpTransceiver->pKvsPeerConnection;
-    pPayloadArray = &(pKvsRtpTransceiver->sender.payloadArray);
     if (MEDIA_STREAM_TRACK_KIND_VIDEO == pKvsRtpTransceiver->sender.track.kind) {
         frames++;
         if (0 != (pFrame->flags & FRAME_FLAG_KEY_FRAME)) {
@@ -307,62 +383,31 @@ STATUS writeFrame(PRtcRtpTransceiver pRtcRtpTransceiver, PFrame pFrame)
     MUTEX_LOCK(pKvsPeerConnection->pSrtpSessionLock);
     locked = TRUE;
     CHK(pKvsPeerConnection->pSrtpSession != NULL, STATUS_SRTP_NOT_READY_YET); // Discard packets till SRTP is ready
-    switch (pKvsRtpTransceiver->sender.track.codec) {
-        case RTC_CODEC_H264_PROFILE_42E01F_LEVEL_ASYMMETRY_ALLOWED_PACKETIZATION_MODE:
-            rtpPayloadFunc = createPayloadForH264;
-            rtpTimestamp = CONVERT_TIMESTAMP_TO_RTP(VIDEO_CLOCKRATE, pFrame->presentationTs);
-            break;
-
-        case RTC_CODEC_H265:
-            rtpPayloadFunc = createPayloadForH265;
-            rtpTimestamp = CONVERT_TIMESTAMP_TO_RTP(VIDEO_CLOCKRATE, pFrame->presentationTs);
-            break;
-
-        case RTC_CODEC_OPUS:
-            rtpPayloadFunc = createPayloadForOpus;
-            rtpTimestamp = CONVERT_TIMESTAMP_TO_RTP(OPUS_CLOCKRATE, pFrame->presentationTs);
-            break;
-
-        case RTC_CODEC_MULAW:
-        case RTC_CODEC_ALAW:
-            rtpPayloadFunc = createPayloadForG711;
-            rtpTimestamp = CONVERT_TIMESTAMP_TO_RTP(PCM_CLOCKRATE, pFrame->presentationTs);
-            break;
-
-        case RTC_CODEC_VP8:
-            rtpPayloadFunc = createPayloadForVP8;
-            rtpTimestamp = CONVERT_TIMESTAMP_TO_RTP(VIDEO_CLOCKRATE, pFrame->presentationTs);
-            break;
-
-        default:
-            CHK(FALSE, STATUS_NOT_IMPLEMENTED);
-    }
-
+    CHK_STATUS(getRtpPayloadFunc(pKvsRtpTransceiver->sender.track.codec, pFrame->presentationTs, &rtpPayloadFunc, &rtpTimestamp));
     rtpTimestamp += randomRtpTimeoffset;
 
-    CHK_STATUS(rtpPayloadFunc(pKvsPeerConnection->MTU, (PBYTE) pFrame->frameData, pFrame->size, NULL, &(pPayloadArray->payloadLength), NULL,
-                              &(pPayloadArray->payloadSubLenSize)));
-    if (pPayloadArray->payloadLength > pPayloadArray->maxPayloadLength) {
-        SAFE_MEMFREE(pPayloadArray->payloadBuffer);
-        pPayloadArray->payloadBuffer = (PBYTE) MEMALLOC(pPayloadArray->payloadLength);
-        pPayloadArray->maxPayloadLength = pPayloadArray->payloadLength;
-    }
-    if (pPayloadArray->payloadSubLenSize > pPayloadArray->maxPayloadSubLenSize) {
-        SAFE_MEMFREE(pPayloadArray->payloadSubLength);
-        pPayloadArray->payloadSubLength = (PUINT32) MEMALLOC(pPayloadArray->payloadSubLenSize * SIZEOF(UINT32));
-        pPayloadArray->maxPayloadSubLenSize = pPayloadArray->payloadSubLenSize;
+    if (pSharedPayloadArray == NULL) {
+        pPayloadArray = &(pKvsRtpTransceiver->sender.payloadArray);
+        CHK_STATUS(rtpPayloadFunc(pKvsPeerConnection->MTU, (PBYTE) pFrame->frameData, pFrame->size, pPayloadArray));
+    } else {
+        pPayloadArray = pSharedPayloadArray;
     }
-    CHK_STATUS(rtpPayloadFunc(pKvsPeerConnection->MTU, (PBYTE) pFrame->frameData, pFrame->size, pPayloadArray->payloadBuffer,
-                              &(pPayloadArray->payloadLength), pPayloadArray->payloadSubLength, &(pPayloadArray->payloadSubLenSize)));
-    pPacketList = (PRtpPacket) MEMALLOC(pPayloadArray->payloadSubLenSize * SIZEOF(RtpPacket));
 
-    CHK_STATUS(constructRtpPackets(pPayloadArray, pKvsRtpTransceiver->sender.payloadType, pKvsRtpTransceiver->sender.sequenceNumber, rtpTimestamp,
-                                   pKvsRtpTransceiver->sender.ssrc, pPacketList, pPayloadArray->payloadSubLenSize));
+    startSequenceNumber = pKvsRtpTransceiver->sender.sequenceNumber;
     pKvsRtpTransceiver->sender.sequenceNumber = GET_UINT16_SEQ_NUM(pKvsRtpTransceiver->sender.sequenceNumber + pPayloadArray->payloadSubLenSize);
 
     bufferAfterEncrypt = (pKvsRtpTransceiver->sender.payloadType == pKvsRtpTransceiver->sender.rtxPayloadType);
+    curPtrInPayload = pPayloadArray->payloadBuffer;
     for (i = 0; i < pPayloadArray->payloadSubLenSize; i++) {
-        pRtpPacket = pPacketList + i;
+        // Packets come from the transceiver pool and are shared with the rolling buffer by reference.
+        // Account for the largest header we generate and the SRTP authentication tag
+        allocSize = RTP_PACKET_POOL_MAX_HEADER_LEN + pPayloadArray->payloadSubLength[i] + SRTP_AUTH_TAG_OVERHEAD;
+        CHK_STATUS(rtpPacketPoolGetPacket(pKvsRtpTransceiver->sender.packetPool, allocSize, &pRtpPacket));
+        CHK_STATUS(setRtpPacket(2, FALSE, FALSE, 0, i == pPayloadArray->payloadSubLenSize - 1, pKvsRtpTransceiver->sender.payloadType,
+                                GET_UINT16_SEQ_NUM(startSequenceNumber + i), rtpTimestamp, pKvsRtpTransceiver->sender.ssrc, NULL, 0, 0, NULL,
+                                curPtrInPayload, pPayloadArray->payloadSubLength[i], pRtpPacket));
+        curPtrInPayload += pPayloadArray->payloadSubLength[i];
+
         if (pKvsRtpTransceiver->pKvsPeerConnection->twccExtId != 0) {
             pRtpPacket->header.extension = TRUE;
             pRtpPacket->header.extensionProfile = TWCC_EXT_PROFILE;
@@ -371,49 +416,81 @@ STATUS writeFrame(PRtcRtpTransceiver pRtcRtpTransceiver, PFrame pFrame)
             extpayload = TWCC_PAYLOAD(pKvsRtpTransceiver->pKvsPeerConnection->twccExtId, twsn);
             pRtpPacket->header.extensionPayload = (PBYTE) &extpayload;
         }
-        // Get the required size first
-        CHK_STATUS(createBytesFromRtpPacket(pRtpPacket, NULL, &packetLen));
 
-        // Account for SRTP authentication tag
-        allocSize = packetLen + SRTP_AUTH_TAG_OVERHEAD;
-        CHK(NULL != (rawPacket = (PBYTE) MEMALLOC(allocSize)), STATUS_NOT_ENOUGH_MEMORY);
-        CHK_STATUS(createBytesFromRtpPacket(pRtpPacket, rawPacket, &packetLen));
+        packetLen = allocSize - SRTP_AUTH_TAG_OVERHEAD;
+        CHK_STATUS(createBytesFromRtpPacket(pRtpPacket, pRtpPacket->pRawPacket, &packetLen));
+
+        // Re-point the header at the serialized bytes, the packet is only looked at again once the whole batch is sent
+        pRtpPacket->rawPacketLength = packetLen;
+        CHK_STATUS(setRtpPacketFromBytes(pRtpPacket->pRawPacket, packetLen, pRtpPacket));
 
         if (!bufferAfterEncrypt) {
-            pRtpPacket->pRawPacket = rawPacket;
-            pRtpPacket->rawPacketLength = packetLen;
+            // The rolling buffer keeps the plain packet, so encrypt a pooled copy of it for sending
             CHK_STATUS(rtpRollingBufferAddRtpPacket(pKvsRtpTransceiver->sender.packetBuffer, pRtpPacket));
+
+            CHK_STATUS(rtpPacketPoolGetPacket(pKvsRtpTransceiver->sender.packetPool, allocSize, &pEncryptedPacket));
+            MEMCPY(pEncryptedPacket->pRawPacket, pRtpPacket->pRawPacket, packetLen);
+            rawPacket = pEncryptedPacket->pRawPacket;
+        } else {
+            rawPacket = pRtpPacket->pRawPacket;
         }
 
         CHK_STATUS(encryptRtpPacket(pKvsPeerConnection->pSrtpSession, rawPacket, (PINT32) &packetLen));
-        sendStatus = iceAgentSendPacket(pKvsPeerConnection->pIceAgent, rawPacket, packetLen);
+
+        // The batch takes over this iteration's references
+        batchPackets[batchCount] = pRtpPacket;
+        batchEncryptedPackets[batchCount] = pEncryptedPacket;
+        batchBuffers[batchCount] = rawPacket;
+        batchLengths[batchCount] = packetLen;
+        batchCount++;
+        pRtpPacket = NULL;
+        pEncryptedPacket = NULL;
+
+        if (batchCount < MAX_RTP_SEND_BATCH_PACKET_COUNT && i < pPayloadArray->payloadSubLenSize - 1) {
+            continue;
+        }
+
+        // Pooled packets leave room around the raw bytes for a relayed send to frame them in place
+        sendStatus = iceAgentSendPackets(pKvsPeerConnection->pIceAgent, batchBuffers, batchLengths, batchCount, RTP_PACKET_POOL_HEADROOM_LEN,
+                                         RTP_PACKET_POOL_TAILROOM_LEN);
         if (sendStatus == STATUS_SEND_DATA_FAILED) {
-            packetsDiscardedOnSend++;
-            bytesDiscardedOnSend += packetLen - headerLen;
+            for (j = 0; j < batchCount; j++) {
+                packetsDiscardedOnSend++;
+                bytesDiscardedOnSend += batchLengths[j] - RTP_HEADER_LEN(batchPackets[j]);
+            }
             // TODO is frame considered discarded when at least one of its packets is discarded or all of its packets discarded?
             framesDiscardedOnSend = 1;
-            SAFE_MEMFREE(rawPacket);
-            continue;
-        } else if (sendStatus == STATUS_SUCCESS && pKvsRtpTransceiver->pKvsPeerConnection->twccExtId != 0) {
-            pRtpPacket->sentTime = GETTIME();
-            twccManagerOnPacketSent(pKvsPeerConnection, pRtpPacket);
-        }
-        CHK_STATUS(sendStatus);
-        if (bufferAfterEncrypt) {
-            pRtpPacket->pRawPacket = rawPacket;
-            pRtpPacket->rawPacketLength = packetLen;
-            CHK_STATUS(rtpRollingBufferAddRtpPacket(pKvsRtpTransceiver->sender.packetBuffer, pRtpPacket));
+        } else {
+            CHK_STATUS(sendStatus);
+            for (j = 0; j < batchCount; j++) {
+                if (pKvsRtpTransceiver->pKvsPeerConnection->twccExtId != 0) {
+                    batchPackets[j]->sentTime = GETTIME();
+                    twccManagerOnPacketSent(pKvsPeerConnection, batchPackets[j]);
+                }
+
+                if (bufferAfterEncrypt) {
+                    // Header stays in the clear, re-point it at the encrypted bytes the rolling buffer will resend as is
+                    batchPackets[j]->rawPacketLength = batchLengths[j];
+                    CHK_STATUS(setRtpPacketFromBytes(batchPackets[j]->pRawPacket, batchLengths[j], batchPackets[j]));
+                    CHK_STATUS(rtpRollingBufferAddRtpPacket(pKvsRtpTransceiver->sender.packetBuffer, batchPackets[j]));
+                }
+
+                // https://tools.ietf.org/html/rfc3550#section-6.4.1
+                // The total number of payload octets (i.e., not including header or padding) transmitted in RTP data packets by the sender
+                headerLen = RTP_HEADER_LEN(batchPackets[j]);
+                bytesSent += batchLengths[j] - headerLen;
+                packetsSent++;
+                headerBytesSent += headerLen;
+            }
+            lastPacketSentTimestamp = KVS_CONVERT_TIMESCALE(GETTIME(), HUNDREDS_OF_NANOS_IN_A_SECOND, 1000);
         }
 
-        // https://tools.ietf.org/html/rfc3550#section-6.4.1
-        // The total number of payload octets (i.e., not including header or padding) transmitted in RTP data packets by the sender
-        headerLen = RTP_HEADER_LEN(pRtpPacket);
-        bytesSent += packetLen - headerLen;
-        packetsSent++;
-        lastPacketSentTimestamp = KVS_CONVERT_TIMESCALE(GETTIME(), HUNDREDS_OF_NANOS_IN_A_SECOND, 1000);
-        headerBytesSent += headerLen;
-
-        SAFE_MEMFREE(rawPacket);
+        // Drop this frame's references, the rolling buffer keeps its own
+        for (j = 0; j < batchCount; j++) {
+            freeRtpPacket(&batchEncryptedPackets[j]);
+            freeRtpPacket(&batchPackets[j]);
+        }
+        batchCount = 0;
     }
 
     if (MEDIA_STREAM_TRACK_KIND_VIDEO == pKvsRtpTransceiver->sender.track.kind) {
@@ -459,8 +536,12 @@ CleanUp:
     pKvsRtpTransceiver->outboundStats.bytesDiscardedOnSend += bytesDiscardedOnSend;
     MUTEX_UNLOCK(pKvsRtpTransceiver->statsLock);
 
-    SAFE_MEMFREE(rawPacket);
-    SAFE_MEMFREE(pPacketList);
+    freeRtpPacket(&pEncryptedPacket);
+    freeRtpPacket(&pRtpPacket);
+    for (j = 0; j < batchCount; j++) {
+        freeRtpPacket(&batchEncryptedPackets[j]);
+        freeRtpPacket(&batchPackets[j]);
+    }
     if (retStatus != STATUS_SRTP_NOT_READY_YET) {
         CHK_LOG_ERR(retStatus);
     }
@@ -468,6 +549,336 @@ CleanUp:
     return retStatus;
 }
 
+STATUS writeFrame(PRtcRtpTransceiver pRtcRtpTransceiver, PFrame pFrame)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+
+    CHK(pRtcRtpTransceiver != NULL && pFrame != NULL, STATUS_NULL_ARG);
+    retStatus = sendFrameWithPayloadArray((PKvsRtpTransceiver) pRtcRtpTransceiver, pFrame, NULL);
+
+CleanUp:
+
+    return retStatus;
+}
+
+PRtpBroadcastPool getRtpBroadcastPoolInstance(VOID)
+{
+    static RtpBroadcastPool pool = {.isInitialized = FALSE, .lock = INVALID_MUTEX_VALUE, .pFreeList = NULL};
+    return &pool;
+}
+
+static STATUS createRtpBroadcast(PRtpBroadcast* ppRtpBroadcast)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    PRtpBroadcast pRtpBroadcast = NULL;
+
+    CHK(NULL != (pRtpBroadcast = (PRtpBroadcast) MEMCALLOC(1, SIZEOF(RtpBroadcast))), STATUS_NOT_ENOUGH_MEMORY);
+    pRtpBroadcast->lock = MUTEX_CREATE(FALSE);
+    CHK(IS_VALID_MUTEX_VALUE(pRtpBroadcast->lock), STATUS_INVALID_OPERATION);
+    pRtpBroadcast->cvar = CVAR_CREATE();
+    CHK(IS_VALID_CVAR_VALUE(pRtpBroadcast->cvar), STATUS_INVALID_OPERATION);
+
+CleanUp:
+
+    if (STATUS_FAILED(retStatus) && pRtpBroadcast != NULL) {
+        if (IS_VALID_MUTEX_VALUE(pRtpBroadcast->lock)) {
+            MUTEX_FREE(pRtpBroadcast->lock);
+        }
+        MEMFREE(pRtpBroadcast);
+        pRtpBroadcast = NULL;
+    }
+
+    *ppRtpBroadcast = pRtpBroadcast;
+
+    return retStatus;
+}
+
+static VOID freeRtpBroadcast(PRtpBroadcast* ppRtpBroadcast)
+{
+    PRtpBroadcast pRtpBroadcast = *ppRtpBroadcast;
+    UINT32 i;
+
+    if (pRtpBroadcast == NULL) {
+        return;
+    }
+
+    // Threadpool tasks that started late still hold on to the broadcast
+    MUTEX_LOCK(pRtpBroadcast->lock);
+    while (pRtpBroadcast->pendingTasks > 0) {
+        CHK_LOG_ERR(CVAR_WAIT(pRtpBroadcast->cvar, pRtpBroadcast->lock, INFINITE_TIME_VALUE));
+    }
+    MUTEX_UNLOCK(pRtpBroadcast->lock);
+
+    for (i = 0; i < pRtpBroadcast->maxJobCount; i++) {
+        SAFE_MEMFREE(pRtpBroadcast->payloadArrays[i].payloadBuffer);
+        SAFE_MEMFREE(pRtpBroadcast->payloadArrays[i].payloadSubLength);
+    }
+    SAFE_MEMFREE(pRtpBroadcast->payloadArrays);
+    SAFE_MEMFREE(pRtpBroadcast->jobs);
+    MUTEX_FREE(pRtpBroadcast->lock);
+    CVAR_FREE(pRtpBroadcast->cvar);
+    MEMFREE(pRtpBroadcast);
+    *ppRtpBroadcast = NULL;
+}
+
+STATUS createRtpBroadcastPool(VOID)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    PRtpBroadcastPool pPool = getRtpBroadcastPoolInstance();
+
+    CHK_WARN(!pPool->isInitialized, retStatus, "Rtp broadcast pool already set up. Nothing to do");
+
+    pPool->lock = MUTEX_CREATE(FALSE);
+    CHK(IS_VALID_MUTEX_VALUE(pPool->lock), STATUS_INVALID_OPERATION);
+    pPool->pFreeList = NULL;
+    pPool->isInitialized = TRUE;
+
+CleanUp:
+
+    return retStatus;
+}
+
+STATUS freeRtpBroadcastPool(VOID)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    PRtpBroadcastPool pPool = getRtpBroadcastPoolInstance();
+    PRtpBroadcast pRtpBroadcast;
+
+    pPool->isInitialized = FALSE;
+
+    // every writeFrameToTransceivers call returned, all broadcasts are in the free list
+    while (pPool->pFreeList != NULL) {
+        pRtpBroadcast = pPool->pFreeList;
+        pPool->pFreeList = pRtpBroadcast->pNext;
+        freeRtpBroadcast(&pRtpBroadcast);
+    }
+
+    if (IS_VALID_MUTEX_VALUE(pPool->lock)) {
+        MUTEX_FREE(pPool->lock);
+        pPool->lock = INVALID_MUTEX_VALUE;
+    }
+
+    return retStatus;
+}
+
+// Takes a broadcast from the pool, or creates one, with room for jobCount jobs
+static STATUS acquireRtpBroadcast(UINT32 jobCount, PRtpBroadcast* ppRtpBroadcast)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    PRtpBroadcastPool pPool = getRtpBroadcastPoolInstance();
+    PRtpBroadcast pRtpBroadcast = NULL;
+    PRtpBroadcastJob pNewJobs;
+    PPayloadArray pNewPayloadArrays;
+    BOOL locked = FALSE;
+
+    if (pPool->isInitialized) {
+        MUTEX_LOCK(pPool->lock);
+        pRtpBroadcast = pPool->pFreeList;
+        if (pRtpBroadcast != NULL) {
+            pPool->pFreeList = pRtpBroadcast->pNext;
+            pRtpBroadcast->pNext = NULL;
+        }
+        MUTEX_UNLOCK(pPool->lock);
+    }
+
+    if (pRtpBroadcast == NULL) {
+        CHK_STATUS(createRtpBroadcast(&pRtpBroadcast));
+    }
+
+    if (jobCount > pRtpBroadcast->maxJobCount) {
+        // Late threadpool tasks only look at the jobs under the lock
+        MUTEX_LOCK(pRtpBroadcast->lock);
+        locked = TRUE;
+        pNewJobs = (PRtpBroadcastJob) MEMREALLOC(pRtpBroadcast->jobs, jobCount * SIZEOF(RtpBroadcastJob));
+        CHK(pNewJobs != NULL, STATUS_NOT_ENOUGH_MEMORY);
+        pRtpBroadcast->jobs = pNewJobs;
+        pNewPayloadArrays = (PPayloadArray) MEMREALLOC(pRtpBroadcast->payloadArrays, jobCount * SIZEOF(PayloadArray));
+        CHK(pNewPayloadArrays != NULL, STATUS_NOT_ENOUGH_MEMORY);
+        MEMSET(pNewPayloadArrays + pRtpBroadcast->maxJobCount, 0x00, (jobCount - pRtpBroadcast->maxJobCount) * SIZEOF(PayloadArray));
+        pRtpBroadcast->payloadArrays = pNewPayloadArrays;
+        pRtpBroadcast->maxJobCount = jobCount;
+    }
+
+CleanUp:
+
+    if (locked) {
+        MUTEX_UNLOCK(pRtpBroadcast->lock);
+    }
+
+    if (STATUS_FAILED(retStatus) && pRtpBroadcast != NULL) {
+        freeRtpBroadcast(&pRtpBroadcast);
+    }
+
+    *ppRtpBroadcast = pRtpBroadcast;
+
+    return retStatus;
+}
+
+static VOID releaseRtpBroadcast(PRtpBroadcast pRtpBroadcast)
+{
+    PRtpBroadcastPool pPool = getRtpBroadcastPoolInstance();
+
+    if (pPool->isInitialized) {
+        MUTEX_LOCK(pPool->lock);
+        pRtpBroadcast->pNext = pPool->pFreeList;
+        pPool->pFreeList = pRtpBroadcast;
+        MUTEX_UNLOCK(pPool->lock);
+    } else {
+        freeRtpBroadcast(&pRtpBroadcast);
+    }
+}
+
+// Claims and runs jobs until none are left. Run by the caller of writeFrameToTransceivers and by every threadpool task it pushed
+static VOID runRtpBroadcastJobs(PRtpBroadcast pRtpBroadcast)
+{
+    PRtpBroadcastJob pJob = NULL;
+
+    for (;;) {
+        MUTEX_LOCK(pRtpBroadcast->lock);
+        pJob = pRtpBroadcast->nextJob < pRtpBroadcast->jobCount ? &pRtpBroadcast->jobs[pRtpBroadcast->nextJob++] : NULL;
+        MUTEX_UNLOCK(pRtpBroadcast->lock);
+
+        if (pJob == NULL) {
+            break;
+        }
+
+        // A failed job here means the frame could not be packetized for this codec
+        if (STATUS_SUCCEEDED(pJob->status)) {
+            pJob->status = sendFrameWithPayloadArray(pJob->pKvsRtpTransceiver, pRtpBroadcast->pFrame, pJob->pPayloadArray);
+        }
+
+        MUTEX_LOCK(pRtpBroadcast->lock);
+        if (++pRtpBroadcast->completedJobs == pRtpBroadcast->jobCount) {
+            CVAR_BROADCAST(pRtpBroadcast->cvar);
+        }
+        MUTEX_UNLOCK(pRtpBroadcast->lock);
+    }
+}
+
+#ifdef ENABLE_KVS_THREADPOOL
+static PVOID rtpBroadcastWorkerThread(PVOID args)
+{
+    PRtpBroadcast pRtpBroadcast = (PRtpBroadcast) args;
+
+    runRtpBroadcastJobs(pRtpBroadcast);
+
+    MUTEX_LOCK(pRtpBroadcast->lock);
+    pRtpBroadcast->pendingTasks--;
+    CVAR_BROADCAST(pRtpBroadcast->cvar);
+    MUTEX_UNLOCK(pRtpBroadcast->lock);
+
+    return NULL;
+}
+#endif
+
+STATUS writeFrameToTransceivers(PRtcRtpTransceiver* pRtcRtpTransceivers, UINT32 transceiverCount, PFrame pFrame, STATUS* pStatuses)
+{
+    STATUS retStatus = STATUS_SUCCESS, payloadStatus;
+    PRtpBroadcast pRtpBroadcast = NULL;
+    PKvsRtpTransceiver pKvsRtpTransceiver = NULL, pSharingTransceiver = NULL;
+    RtpPayloadFunc rtpPayloadFunc = NULL;
+    UINT64 rtpTimestamp;
+    UINT32 i, j;
+#ifdef ENABLE_KVS_THREADPOOL
+    UINT32 workerCount;
+#endif
+
+    CHK(pRtcRtpTransceivers != NULL && pFrame != NULL, STATUS_NULL_ARG);
+    CHK(transceiverCount != 0, retStatus);
+    for (i = 0; i < transceiverCount; i++) {
+        CHK(pRtcRtpTransceivers[i] != NULL, STATUS_NULL_ARG);
+    }
+
+    CHK_STATUS(acquireRtpBroadcast(transceiverCount, &pRtpBroadcast));
+    pRtpBroadcast->pFrame = pFrame;
+    pRtpBroadcast->payloadArrayCount = 0;
+
+    // Packetize the frame once per distinct codec and MTU into the broadcast's own payload arrays, which every
+    // transceiver of the group only reads from while sending. Transceiver state is not touched outside its lock.
+    for (i = 0; i < transceiverCount; i++) {
+        pKvsRtpTransceiver = (PKvsRtpTransceiver) pRtcRtpTransceivers[i];
+        pRtpBroadcast->jobs[i].pKvsRtpTransceiver = pKvsRtpTransceiver;
+
+        for (j = 0; j < i; j++) {
+            pSharingTransceiver = pRtpBroadcast->jobs[j].pKvsRtpTransceiver;
+            if (pSharingTransceiver->sender.track.codec == pKvsRtpTransceiver->sender.track.codec &&
+                pSharingTransceiver->pKvsPeerConnection->MTU == pKvsRtpTransceiver->pKvsPeerConnection->MTU) {
+                break;
+            }
+        }
+
+        if (j < i) {
+            pRtpBroadcast->jobs[i].pPayloadArray = pRtpBroadcast->jobs[j].pPayloadArray;
+            pRtpBroadcast->jobs[i].status = pRtpBroadcast->jobs[j].status;
+        } else {
+            pRtpBroadcast->jobs[i].pPayloadArray = &pRtpBroadcast->payloadArrays[pRtpBroadcast->payloadArrayCount++];
+            payloadStatus = getRtpPayloadFunc(pKvsRtpTransceiver->sender.track.codec, pFrame->presentationTs, &rtpPayloadFunc, &rtpTimestamp);
+            if (STATUS_SUCCEEDED(payloadStatus)) {
+                payloadStatus = rtpPayloadFunc(pKvsRtpTransceiver->pKvsPeerConnection->MTU, (PBYTE) pFrame->frameData, pFrame->size,
+                                               pRtpBroadcast->jobs[i].pPayloadArray);
+            }
+            pRtpBroadcast->jobs[i].status = payloadStatus;
+        }
+    }
+
+    MUTEX_LOCK(pRtpBroadcast->lock);
+    pRtpBroadcast->nextJob = 0;
+    pRtpBroadcast->completedJobs = 0;
+    pRtpBroadcast->jobCount = transceiverCount;
+    MUTEX_UNLOCK(pRtpBroadcast->lock);
+
+#ifdef ENABLE_KVS_THREADPOOL
+    // Per peer work is independent, spread it over the threadpool with the calling thread pitching in. The caller
+    // only waits for the jobs to complete, tasks that start late find nothing to claim.
+    if (transceiverCount >= RTP_BROADCAST_PARALLEL_MIN_TRANSCEIVER_COUNT) {
+        workerCount = MIN(transceiverCount - 1, RTP_BROADCAST_MAX_WORKER_COUNT);
+        for (i = 0; i < workerCount; i++) {
+            MUTEX_LOCK(pRtpBroadcast->lock);
+            pRtpBroadcast->pendingTasks++;
+            MUTEX_UNLOCK(pRtpBroadcast->lock);
+            if (STATUS_FAILED(threadpoolContextPush(rtpBroadcastWorkerThread, (PVOID) pRtpBroadcast))) {
+                MUTEX_LOCK(pRtpBroadcast->lock);
+                pRtpBroadcast->pendingTasks--;
+                MUTEX_UNLOCK(pRtpBroadcast->lock);
+                break;
+            }
+        }
+    }
+#endif
+
+    runRtpBroadcastJobs(pRtpBroadcast);
+
+    // Workers may still be reading the frame and the payload arrays, never return before every job completed
+    MUTEX_LOCK(pRtpBroadcast->lock);
+    while (pRtpBroadcast->completedJobs < pRtpBroadcast->jobCount) {
+        CHK_LOG_ERR(CVAR_WAIT(pRtpBroadcast->cvar, pRtpBroadcast->lock, INFINITE_TIME_VALUE));
+    }
+    pRtpBroadcast->jobCount = 0;
+    pRtpBroadcast->nextJob = 0;
+    MUTEX_UNLOCK(pRtpBroadcast->lock);
+
+    // Viewers that have not finished the DTLS handshake yet are expected, only surface real failures
+    for (i = 0; i < transceiverCount; i++) {
+        if (pStatuses != NULL) {
+            pStatuses[i] = pRtpBroadcast->jobs[i].status;
+        }
+        if (STATUS_SUCCEEDED(retStatus) && STATUS_FAILED(pRtpBroadcast->jobs[i].status) &&
+            pRtpBroadcast->jobs[i].status != STATUS_SRTP_NOT_READY_YET) {
+            retStatus = pRtpBroadcast->jobs[i].status;
+        }
+    }
+
+    pRtpBroadcast->pFrame = NULL;
+
+CleanUp:
+
+    if (pRtpBroadcast != NULL) {
+        releaseRtpBroadcast(pRtpBroadcast);
+    }
+
+    return retStatus;
+}
+
 STATUS writeRtpPacket(PKvsPeerConnection pKvsPeerConnection, PRtpPacket pRtpPacket)
 {
     STATUS retStatus = STATUS_SUCCESS;
@@ -16,12 +16,24 @@ extern "C" {
 #define DEFAULT_SEQ_NUM_BUFFER_SIZE                1000
 #define DEFAULT_VALID_INDEX_BUFFER_SIZE            1000
 #define DEFAULT_PEER_FRAME_BUFFER_SIZE             (5 * 1024)
-#define SRTP_AUTH_TAG_OVERHEAD                     10
+#define SRTP_AUTH_TAG_OVERHEAD                     16 // Largest tag of the supported profiles, the AES-GCM one
 #define MIN_ROLLING_BUFFER_DURATION_IN_SECONDS     (DOUBLE) 0.1
 #define MIN_EXPECTED_BIT_RATE                      (DOUBLE)(102.4 * 1024) // Considering 1Kib = 1024 bits
 #define MAX_ROLLING_BUFFER_DURATION_IN_SECONDS     (DOUBLE) 10
 #define MAX_EXPECTED_BIT_RATE                      (DOUBLE)(240 * 1024 * 1024) // Considering 1Kib = 1024 bits
 
+// Number of encrypted packets of a frame handed to the ICE agent in a single batched send
+#define MAX_RTP_SEND_BATCH_PACKET_COUNT MAX_SOCKET_SEND_BATCH_SIZE
+
+// Slot size of the pool inbound packets are received into. Fits a full Ethernet frame, larger datagrams get a one-off allocation
+#define DEFAULT_RTP_RECEIVE_PACKET_POOL_SLOT_SIZE 1500
+
+// writeFrameToTransceivers spreads the per peer work over the threadpool starting from this many transceivers
+#define RTP_BROADCAST_PARALLEL_MIN_TRANSCEIVER_COUNT 4
+
+// Upper bound on the threadpool tasks a single writeFrameToTransceivers call occupies
+#define RTP_BROADCAST_MAX_WORKER_COUNT 4
+
 // https://www.w3.org/TR/webrtc-stats/#dom-rtcoutboundrtpstreamstats-huge
 // Huge frames, by definition, are frames that have an encoded size at least 2.5 times the average size of the frames.
 #define HUGE_FRAME_MULTIPLIER 2.5
@@ -36,6 +48,7 @@ typedef struct {
     PayloadArray payloadArray;
 
     RtcMediaStreamTrack track;
+    PRtpPacketPool packetPool;
     PRtpRollingBuffer packetBuffer;
     PRetransmitter retransmitter;
 
@@ -62,11 +75,15 @@ typedef struct {
 
     UINT32 jitterBufferSsrc;
     PJitterBuffer pJitterBuffer;
+    // Inbound packets live in slots of this pool until the jitter buffer drops them
+    PRtpPacketPool receivePacketPool;
 
     PRollingBufferConfig pRollingBufferConfig;
 
     UINT64 onFrameCustomData;
     RtcOnFrame onFrame;
+    UINT64 onFrameIovCustomData;
+    RtcOnFrameIov onFrameIov;
 
     UINT64 onBandwidthEstimationCustomData;
     RtcOnBandwidthEstimation onBandwidthEstimation;
@@ -75,6 +92,9 @@ typedef struct {
 
     PBYTE peerFrameBuffer;
     UINT32 peerFrameBufferSize;
+    // Slices handed to onFrameIov, kept across frames, and the codec specific depayloader producing them
+    FrameIovArray peerFrameIovArray;
+    DepayRtpPayloadIovFunc depayIovFn;
 
     UINT32 rtcpReportsTimerId;
 
@@ -84,6 +104,64 @@ typedef struct {
     RtcInboundRtpStreamStats inboundStats;
 } KvsRtpTransceiver, *PKvsRtpTransceiver;
 
+typedef struct {
+    PKvsRtpTransceiver pKvsRtpTransceiver;
+    // Packetized frame, owned by the broadcast and shared by every transceiver with the same codec and MTU
+    PPayloadArray pPayloadArray;
+    STATUS status;
+} RtpBroadcastJob, *PRtpBroadcastJob;
+
+/**
+ * State of a writeFrameToTransceivers call. Broadcasts are kept in a process wide pool and reused frame after frame,
+ * a caller has a broadcast to itself until it returns it to the pool.
+ */
+typedef struct __RtpBroadcast RtpBroadcast;
+struct __RtpBroadcast {
+    // Guards job claiming, completion and the pending task count
+    MUTEX lock;
+    // Signaled when the last job of the frame completes and when a threadpool task is done with the broadcast
+    CVAR cvar;
+    PFrame pFrame;
+    UINT32 jobCount;
+    UINT32 nextJob;
+    UINT32 completedJobs;
+    // Threadpool tasks pushed for the broadcast that have not returned yet. Late tasks find no job to claim
+    UINT32 pendingTasks;
+    // Capacity of jobs and payloadArrays
+    UINT32 maxJobCount;
+    PRtpBroadcastJob jobs;
+    // One per distinct codec and MTU of the frame, only the first payloadArrayCount are in use
+    PPayloadArray payloadArrays;
+    UINT32 payloadArrayCount;
+    // Next broadcast in the pool free list
+    RtpBroadcast* pNext;
+};
+typedef RtpBroadcast* PRtpBroadcast;
+
+typedef struct {
+    BOOL isInitialized;
+    MUTEX lock;
+    // Broadcasts not in use by any writeFrameToTransceivers call
+    PRtpBroadcast pFreeList;
+} RtpBroadcastPool, *PRtpBroadcastPool;
+
+PRtpBroadcastPool getRtpBroadcastPoolInstance(VOID);
+
+/**
+ * Sets up the process wide pool of broadcasts. Called by initKvsWebRtc. Without it every writeFrameToTransceivers
+ * call creates and frees its own broadcast.
+ *
+ * @return - STATUS code of the execution
+ */
+STATUS createRtpBroadcastPool(VOID);
+
+/**
+ * Frees the pooled broadcasts once the threadpool tasks pushed for them returned. Called by deinitKvsWebRtc
+ *
+ * @return - STATUS code of the execution
+ */
+STATUS freeRtpBroadcastPool(VOID);
+
 STATUS createKvsRtpTransceiver(RTC_RTP_TRANSCEIVER_DIRECTION, PKvsPeerConnection, UINT32, UINT32, PRtcMediaStreamTrack, PJitterBuffer, RTC_CODEC,
                                PKvsRtpTransceiver*);
 STATUS freeKvsRtpTransceiver(PKvsRtpTransceiver*);
@@ -60,18 +60,27 @@ STATUS rtpRollingBufferAddRtpPacket(PRtpRollingBuffer pRollingBuffer, PRtpPacket
     UINT64 index = 0;
     CHK(pRollingBuffer != NULL && pRtpPacket != NULL, STATUS_NULL_ARG);
 
-    pRawPacketCopy = (PBYTE) MEMALLOC(pRtpPacket->rawPacketLength);
-    CHK(pRawPacketCopy != NULL, STATUS_NOT_ENOUGH_MEMORY);
-    MEMCPY(pRawPacketCopy, pRtpPacket->pRawPacket, pRtpPacket->rawPacketLength);
-    CHK_STATUS(createRtpPacketFromBytes(pRawPacketCopy, pRtpPacket->rawPacketLength, &pRtpPacketCopy));
-    // pRtpPacketCopy took ownership of pRawPacketCopy
-    pRawPacketCopy = NULL;
+    if (pRtpPacket->pPacketPool != NULL) {
+        // Pooled packets are shared with the sender by reference instead of being copied
+        CHK_STATUS(rtpPacketPoolRetainPacket(pRtpPacket));
+        pRtpPacketCopy = pRtpPacket;
+    } else {
+        pRawPacketCopy = (PBYTE) MEMALLOC(pRtpPacket->rawPacketLength);
+        CHK(pRawPacketCopy != NULL, STATUS_NOT_ENOUGH_MEMORY);
+        MEMCPY(pRawPacketCopy, pRtpPacket->pRawPacket, pRtpPacket->rawPacketLength);
+        CHK_STATUS(createRtpPacketFromBytes(pRawPacketCopy, pRtpPacket->rawPacketLength, &pRtpPacketCopy));
+        // pRtpPacketCopy took ownership of pRawPacketCopy
+        pRawPacketCopy = NULL;
+    }
 
     CHK_STATUS(rollingBufferAppendData(pRollingBuffer->pRollingBuffer, (UINT64) pRtpPacketCopy, &index));
+    // rolling buffer took ownership of pRtpPacketCopy
+    pRtpPacketCopy = NULL;
     pRollingBuffer->lastIndex = index;
 
 CleanUp:
     SAFE_MEMFREE(pRawPacketCopy);
+    freeRtpPacket(&pRtpPacketCopy);
     CHK_LOG_ERR(retStatus);
 
     LEAVES();
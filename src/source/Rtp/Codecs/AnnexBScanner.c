@@ -0,0 +1,161 @@
+#define LOG_CLASS "AnnexBScanner"
+
+#include "../../Include_i.h"
+
+#if defined(KVS_ANNEXB_SCAN_SSE2_SUPPORTED) || defined(KVS_ANNEXB_SCAN_AVX2_SUPPORTED)
+#include <immintrin.h>
+#elif defined(KVS_ANNEXB_SCAN_NEON_SUPPORTED)
+#include <arm_neon.h>
+#endif
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+// Bytes compared per vector step. Every step also reads the two bytes after the block
+#define ANNEXB_SCAN_SSE2_BLOCK_SIZE 16
+#define ANNEXB_SCAN_AVX2_BLOCK_SIZE 32
+#define ANNEXB_SCAN_NEON_BLOCK_SIZE 16
+#define ANNEXB_START_CODE_TAIL_SIZE 2
+
+static inline UINT32 annexBLowestSetBit(UINT64 mask)
+{
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward64(&index, mask);
+    return (UINT32) index;
+#else
+    return (UINT32) __builtin_ctzll(mask);
+#endif
+}
+
+UINT32 findAnnexBStartCodeScalar(PBYTE pData, UINT32 length)
+{
+    // Look at the byte that would be the 0x01 of a start code. Anything above 1 rules out a start code
+    // ending here or in the next two bytes, and so does a 0x01 that is not preceded by two zeros.
+    UINT32 offset = ANNEXB_START_CODE_TAIL_SIZE;
+
+    while (offset < length) {
+        if (pData[offset] > 1) {
+            offset += 3;
+        } else if (pData[offset] == 0) {
+            offset++;
+        } else if (pData[offset - 1] == 0 && pData[offset - 2] == 0) {
+            return offset - ANNEXB_START_CODE_TAIL_SIZE;
+        } else {
+            offset += 3;
+        }
+    }
+
+    return length;
+}
+
+#ifdef KVS_ANNEXB_SCAN_SSE2_SUPPORTED
+UINT32 findAnnexBStartCodeSse2(PBYTE pData, UINT32 length)
+{
+    UINT32 offset = 0, mask;
+    __m128i zero = _mm_setzero_si128(), one = _mm_set1_epi8(1), match;
+
+    // Compare a block against 0x00, the block shifted by one against 0x00 and the block shifted by two against 0x01
+    while (offset + ANNEXB_SCAN_SSE2_BLOCK_SIZE + ANNEXB_START_CODE_TAIL_SIZE <= length) {
+        match = _mm_and_si128(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*) (pData + offset)), zero),
+                              _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*) (pData + offset + 1)), zero));
+        match = _mm_and_si128(match, _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*) (pData + offset + 2)), one));
+        mask = (UINT32) _mm_movemask_epi8(match);
+        if (mask != 0) {
+            return offset + annexBLowestSetBit(mask);
+        }
+
+        offset += ANNEXB_SCAN_SSE2_BLOCK_SIZE;
+    }
+
+    return offset + findAnnexBStartCodeScalar(pData + offset, length - offset);
+}
+#endif
+
+#ifdef KVS_ANNEXB_SCAN_AVX2_SUPPORTED
+BOOL annexBScanAvx2Available(VOID)
+{
+    return __builtin_cpu_supports("avx2") ? TRUE : FALSE;
+}
+
+__attribute__((target("avx2"))) UINT32 findAnnexBStartCodeAvx2(PBYTE pData, UINT32 length)
+{
+    UINT32 offset = 0, mask;
+    __m256i zero = _mm256_setzero_si256(), one = _mm256_set1_epi8(1), match;
+
+    while (offset + ANNEXB_SCAN_AVX2_BLOCK_SIZE + ANNEXB_START_CODE_TAIL_SIZE <= length) {
+        match = _mm256_and_si256(_mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i*) (pData + offset)), zero),
+                                 _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i*) (pData + offset + 1)), zero));
+        match = _mm256_and_si256(match, _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i*) (pData + offset + 2)), one));
+        mask = (UINT32) _mm256_movemask_epi8(match);
+        if (mask != 0) {
+            return offset + annexBLowestSetBit(mask);
+        }
+
+        offset += ANNEXB_SCAN_AVX2_BLOCK_SIZE;
+    }
+
+    return offset + findAnnexBStartCodeScalar(pData + offset, length - offset);
+}
+#endif
+
+#ifdef KVS_ANNEXB_SCAN_NEON_SUPPORTED
+UINT32 findAnnexBStartCodeNeon(PBYTE pData, UINT32 length)
+{
+    UINT32 offset = 0;
+    UINT64 lowMask, highMask;
+    uint8x16_t zero = vdupq_n_u8(0), one = vdupq_n_u8(1), match;
+
+    while (offset + ANNEXB_SCAN_NEON_BLOCK_SIZE + ANNEXB_START_CODE_TAIL_SIZE <= length) {
+        match = vandq_u8(vceqq_u8(vld1q_u8(pData + offset), zero), vceqq_u8(vld1q_u8(pData + offset + 1), zero));
+        match = vandq_u8(match, vceqq_u8(vld1q_u8(pData + offset + 2), one));
+
+        // No movemask on NEON, matching lanes are all ones so the first set bit of each half gives the byte index
+        lowMask = vgetq_lane_u64(vreinterpretq_u64_u8(match), 0);
+        highMask = vgetq_lane_u64(vreinterpretq_u64_u8(match), 1);
+        if (lowMask != 0) {
+            return offset + annexBLowestSetBit(lowMask) / 8;
+        } else if (highMask != 0) {
+            return offset + 8 + annexBLowestSetBit(highMask) / 8;
+        }
+
+        offset += ANNEXB_SCAN_NEON_BLOCK_SIZE;
+    }
+
+    return offset + findAnnexBStartCodeScalar(pData + offset, length - offset);
+}
+#endif
+
+// Best scanner for the CPU, resolved by the first scan so the CPU features are only queried once
+static volatile SIZE_T gAnnexBStartCodeScanFunc = (SIZE_T) NULL;
+
+static AnnexBStartCodeScanFunc resolveAnnexBStartCodeScanFunc(VOID)
+{
+#if defined(KVS_ANNEXB_SCAN_AVX2_SUPPORTED)
+    if (annexBScanAvx2Available()) {
+        return findAnnexBStartCodeAvx2;
+    }
+#endif
+
+#if defined(KVS_ANNEXB_SCAN_SSE2_SUPPORTED)
+    return findAnnexBStartCodeSse2;
+#elif defined(KVS_ANNEXB_SCAN_NEON_SUPPORTED)
+    return findAnnexBStartCodeNeon;
+#else
+    return findAnnexBStartCodeScalar;
+#endif
+}
+
+UINT32 findAnnexBStartCode(PBYTE pData, UINT32 length)
+{
+    AnnexBStartCodeScanFunc scanFunc = (AnnexBStartCodeScanFunc) ATOMIC_LOAD(&gAnnexBStartCodeScanFunc);
+
+    // Racing first scans resolve the same scanner, so whichever store lands last is fine
+    if (scanFunc == NULL) {
+        scanFunc = resolveAnnexBStartCodeScanFunc();
+        ATOMIC_STORE(&gAnnexBStartCodeScanFunc, (SIZE_T) scanFunc);
+    }
+
+    return scanFunc(pData, length);
+}
@@ -0,0 +1,47 @@
+/*******************************************
+Annex-B start code scanner include file
+*******************************************/
+#ifndef __KINESIS_VIDEO_WEBRTC_CLIENT_ANNEXBSCANNER_H
+#define __KINESIS_VIDEO_WEBRTC_CLIENT_ANNEXBSCANNER_H
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Vectorized scanners built for the target, the best one the CPU supports is picked at runtime
+#if defined(__x86_64__) || defined(_M_X64) || (defined(__i386__) && defined(__SSE2__))
+#define KVS_ANNEXB_SCAN_SSE2_SUPPORTED
+#if defined(__GNUC__) || defined(__clang__)
+#define KVS_ANNEXB_SCAN_AVX2_SUPPORTED
+#endif
+#elif defined(__aarch64__) || defined(_M_ARM64) || defined(__ARM_NEON)
+#define KVS_ANNEXB_SCAN_NEON_SUPPORTED
+#endif
+
+/*
+ * All scanners return the offset of the first 0x00 0x00 0x01 sequence in the buffer, pointing at its first
+ * zero byte, or the buffer length when there is none. A zero preceding the returned offset is the leading
+ * byte of a 4 byte start code and is left for the caller to account for. findAnnexBStartCode dispatches to the
+ * best scanner of the CPU through an AnnexBStartCodeScanFunc resolved once.
+ */
+typedef UINT32 (*AnnexBStartCodeScanFunc)(PBYTE, UINT32);
+
+UINT32 findAnnexBStartCode(PBYTE, UINT32);
+UINT32 findAnnexBStartCodeScalar(PBYTE, UINT32);
+#ifdef KVS_ANNEXB_SCAN_SSE2_SUPPORTED
+UINT32 findAnnexBStartCodeSse2(PBYTE, UINT32);
+#endif
+#ifdef KVS_ANNEXB_SCAN_AVX2_SUPPORTED
+BOOL annexBScanAvx2Available(VOID);
+UINT32 findAnnexBStartCodeAvx2(PBYTE, UINT32);
+#endif
+#ifdef KVS_ANNEXB_SCAN_NEON_SUPPORTED
+UINT32 findAnnexBStartCodeNeon(PBYTE, UINT32);
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+#endif //__KINESIS_VIDEO_WEBRTC_CLIENT_ANNEXBSCANNER_H
@@ -44,6 +44,32 @@ CleanUp:
     return retStatus;
 }
 
+STATUS createPayloadArrayForG711(UINT32 mtu, PBYTE g711Frame, UINT32 g711FrameLength, PPayloadArray pPayloadArray)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    UINT32 payloadLength, payloadSubLenSize;
+
+    CHK(g711Frame != NULL && pPayloadArray != NULL, STATUS_NULL_ARG);
+    CHK(mtu != 0, STATUS_RTP_INPUT_MTU_TOO_SMALL);
+
+    // The packetized size follows from the frame length alone, so reserve it up front and fill in one go
+    pPayloadArray->payloadLength = 0;
+    pPayloadArray->payloadSubLenSize = 0;
+    payloadLength = g711FrameLength;
+    payloadSubLenSize = g711FrameLength / mtu + (g711FrameLength % mtu == 0 ? 0 : 1);
+    CHK_STATUS(payloadArrayReserve(pPayloadArray, payloadLength, payloadSubLenSize));
+    CHK_STATUS(createPayloadForG711(mtu, g711Frame, g711FrameLength, pPayloadArray->payloadBuffer, &payloadLength, pPayloadArray->payloadSubLength,
+                                      &payloadSubLenSize));
+    pPayloadArray->payloadLength = payloadLength;
+    pPayloadArray->payloadSubLenSize = payloadSubLenSize;
+
+CleanUp:
+
+    LEAVES();
+    return retStatus;
+}
+
 STATUS depayG711FromRtpPayload(PBYTE pRawPacket, UINT32 packetLength, PBYTE pG711Data, PUINT32 pG711Length, PBOOL pIsStart)
 {
     ENTERS();
@@ -77,3 +103,19 @@ CleanUp:
     LEAVES();
     return retStatus;
 }
+
+STATUS depayG711IovFromRtpPayload(PBYTE pRawPacket, UINT32 packetLength, PFrameIovArray pFrameIovArray)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+
+    CHK(pRawPacket != NULL && pFrameIovArray != NULL, STATUS_NULL_ARG);
+    CHK(packetLength > 0, retStatus);
+
+    CHK_STATUS(frameIovArrayAppend(pFrameIovArray, pRawPacket, packetLength));
+
+CleanUp:
+
+    LEAVES();
+    return retStatus;
+}
@@ -11,7 +11,9 @@ extern "C" {
 #endif
 
 STATUS createPayloadForG711(UINT32, PBYTE, UINT32, PBYTE, PUINT32, PUINT32, PUINT32);
+STATUS createPayloadArrayForG711(UINT32, PBYTE, UINT32, PPayloadArray);
 STATUS depayG711FromRtpPayload(PBYTE, UINT32, PBYTE, PUINT32, PBOOL);
+STATUS depayG711IovFromRtpPayload(PBYTE, UINT32, PFrameIovArray);
 
 #ifdef __cplusplus
 }
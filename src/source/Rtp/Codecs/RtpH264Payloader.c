@@ -73,14 +73,65 @@ CleanUp:
     return retStatus;
 }
 
+STATUS createPayloadArrayForH264(UINT32 mtu, PBYTE nalus, UINT32 nalusLength, PPayloadArray pPayloadArray)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    PBYTE curPtrInNalus = nalus;
+    UINT32 remainNalusLength = nalusLength;
+    UINT32 nextNaluLength = 0;
+    UINT32 startIndex = 0;
+    UINT32 singlePayloadLength = 0;
+    UINT32 singlePayloadSubLenSize = 0;
+    PayloadArray naluPayloadArray;
+
+    CHK(nalus != NULL && pPayloadArray != NULL, STATUS_NULL_ARG);
+    CHK(mtu > FU_A_HEADER_SIZE, STATUS_RTP_INPUT_MTU_TOO_SMALL);
+
+    pPayloadArray->payloadLength = 0;
+    pPayloadArray->payloadSubLenSize = 0;
+
+    do {
+        CHK_STATUS(getNextNaluLength(curPtrInNalus, remainNalusLength, &startIndex, &nextNaluLength));
+
+        curPtrInNalus += startIndex;
+
+        remainNalusLength -= startIndex;
+
+        CHK(remainNalusLength != 0, retStatus);
+
+        // Sizing a NALU does not touch its bytes, so the frame is only scanned and copied once
+        CHK_STATUS(createPayloadFromNalu(mtu, curPtrInNalus, nextNaluLength, NULL, &singlePayloadLength, &singlePayloadSubLenSize));
+        CHK_STATUS(payloadArrayReserve(pPayloadArray, singlePayloadLength, singlePayloadSubLenSize));
+
+        naluPayloadArray.payloadBuffer = pPayloadArray->payloadBuffer + pPayloadArray->payloadLength;
+        naluPayloadArray.payloadSubLength = pPayloadArray->payloadSubLength + pPayloadArray->payloadSubLenSize;
+        naluPayloadArray.maxPayloadLength = singlePayloadLength;
+        naluPayloadArray.maxPayloadSubLenSize = singlePayloadSubLenSize;
+        CHK_STATUS(createPayloadFromNalu(mtu, curPtrInNalus, nextNaluLength, &naluPayloadArray, &singlePayloadLength, &singlePayloadSubLenSize));
+        pPayloadArray->payloadLength += singlePayloadLength;
+        pPayloadArray->payloadSubLenSize += singlePayloadSubLenSize;
+
+        remainNalusLength -= nextNaluLength;
+        curPtrInNalus += nextNaluLength;
+    } while (remainNalusLength != 0);
+
+CleanUp:
+    if (STATUS_FAILED(retStatus) && pPayloadArray != NULL) {
+        pPayloadArray->payloadLength = 0;
+        pPayloadArray->payloadSubLenSize = 0;
+    }
+
+    LEAVES();
+    return retStatus;
+}
+
 STATUS getNextNaluLength(PBYTE nalus, UINT32 nalusLength, PUINT32 pStart, PUINT32 pNaluLength)
 {
     ENTERS();
 
     STATUS retStatus = STATUS_SUCCESS;
-    UINT32 zeroCount = 0, offset = 0;
-    BOOL naluFound = FALSE;
-    PBYTE pCurrent = NULL;
+    UINT32 offset = 0, naluLength = 0;
 
     CHK(nalus != NULL && pStart != NULL && pNaluLength != NULL, STATUS_NULL_ARG);
 
@@ -91,34 +142,15 @@ STATUS getNextNaluLength(PBYTE nalus, UINT32 nalusLength, PUINT32 pStart, PUINT3
 
     CHK(offset < nalusLength && offset < 4 && offset >= 2 && nalus[offset] == 1, STATUS_RTP_INVALID_NALU);
     *pStart = ++offset;
-    pCurrent = nalus + offset;
 
-    /* Not doing validation on number of consecutive zeros being less than 4 because some device can produce
-     * data with trailing zeros. */
-    while (offset < nalusLength) {
-        if (*pCurrent == 0) {
-            /* Maybe next byte is 1 */
-            offset++;
-            pCurrent++;
-
-        } else if (*pCurrent == 1) {
-            if (*(pCurrent - 1) == 0 && *(pCurrent - 2) == 0) {
-                zeroCount = *(pCurrent - 3) == 0 ? 3 : 2;
-                naluFound = TRUE;
-                break;
-            }
+    naluLength = findAnnexBStartCode(nalus + offset, nalusLength - offset);
 
-            /* The jump is always 3 because of the 1 previously matched.
-             * All the 0's must be after this '1' matched at offset */
-            offset += 3;
-            pCurrent += 3;
-        } else {
-            /* Can jump 3 bytes forward */
-            offset += 3;
-            pCurrent += 3;
-        }
+    /* Not doing validation on number of consecutive zeros being less than 4 because some device can produce
+     * data with trailing zeros. Only the zero right before the next start code belongs to it. */
+    if (naluLength < nalusLength - offset && naluLength > 0 && nalus[offset + naluLength - 1] == 0) {
+        naluLength--;
     }
-    *pNaluLength = MIN(offset, nalusLength) - *pStart - (naluFound ? zeroCount : 0);
+    *pNaluLength = naluLength;
 
 CleanUp:
 
@@ -235,7 +267,7 @@ STATUS depayH264FromRtpPayload(PBYTE pRawPacket, UINT32 packetLength, PBYTE pNal
     BOOL sizeCalculationOnly = (pNaluData == NULL);
     BOOL isStartingPacket = FALSE;
     PBYTE pCurPtr = pRawPacket;
-    static BYTE start4ByteCode[] = {0x00, 0x00, 0x00, 0x01};
+    static const BYTE start4ByteCode[] = {0x00, 0x00, 0x00, 0x01};
     UINT16 subNaluSize = 0;
 
     CHK(pRawPacket != NULL && pNaluLength != NULL, STATUS_NULL_ARG);
@@ -374,3 +406,56 @@ CleanUp:
     LEAVES();
     return retStatus;
 }
+
+STATUS depayH264IovFromRtpPayload(PBYTE pRawPacket, UINT32 packetLength, PFrameIovArray pFrameIovArray)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    UINT8 indicator = 0;
+    UINT32 headerSize = 0;
+    UINT16 subNaluSize = 0;
+    BYTE naluHeader;
+    PBYTE pCurPtr = pRawPacket;
+    static const BYTE start4ByteCode[] = {0x00, 0x00, 0x00, 0x01};
+
+    CHK(pRawPacket != NULL && pFrameIovArray != NULL, STATUS_NULL_ARG);
+    CHK(packetLength > 0, retStatus);
+
+    indicator = *pRawPacket & NAL_TYPE_MASK;
+    switch (indicator) {
+        case FU_A_INDICATOR:
+        case FU_B_INDICATOR:
+            headerSize = indicator == FU_A_INDICATOR ? FU_A_HEADER_SIZE : FU_B_HEADER_SIZE;
+            CHK(packetLength > headerSize, STATUS_RTP_INPUT_PACKET_TOO_SMALL);
+            // The NAL unit header of a fragmented NALU is not in any packet, rebuild it in scratch
+            if (indicator == FU_A_INDICATOR && (pRawPacket[1] & (1 << 7)) != 0) {
+                naluHeader = (pRawPacket[0] & 0x60) | (pRawPacket[1] & 0x1f);
+                CHK_STATUS(frameIovArrayAppend(pFrameIovArray, (PBYTE) start4ByteCode, SIZEOF(start4ByteCode)));
+                CHK_STATUS(frameIovArrayAppendScratch(pFrameIovArray, &naluHeader, SIZEOF(BYTE)));
+            }
+            CHK_STATUS(frameIovArrayAppend(pFrameIovArray, pRawPacket + headerSize, packetLength - headerSize));
+            break;
+        case STAP_A_INDICATOR:
+        case STAP_B_INDICATOR:
+            pCurPtr += indicator == STAP_A_INDICATOR ? STAP_A_HEADER_SIZE : STAP_B_HEADER_SIZE;
+            while (pCurPtr + SIZEOF(UINT16) <= pRawPacket + packetLength) {
+                subNaluSize = getUnalignedInt16BigEndian(pCurPtr);
+                pCurPtr += SIZEOF(UINT16);
+                CHK(subNaluSize > 0, retStatus);
+                CHK(pCurPtr + subNaluSize <= pRawPacket + packetLength, STATUS_RTP_INVALID_NALU);
+                CHK_STATUS(frameIovArrayAppend(pFrameIovArray, (PBYTE) start4ByteCode, SIZEOF(start4ByteCode)));
+                CHK_STATUS(frameIovArrayAppend(pFrameIovArray, pCurPtr, subNaluSize));
+                pCurPtr += subNaluSize;
+            }
+            break;
+        default:
+            // Single NALU https://tools.ietf.org/html/rfc6184#section-5.6
+            CHK_STATUS(frameIovArrayAppend(pFrameIovArray, (PBYTE) start4ByteCode, SIZEOF(start4ByteCode)));
+            CHK_STATUS(frameIovArrayAppend(pFrameIovArray, pRawPacket, packetLength));
+    }
+
+CleanUp:
+
+    LEAVES();
+    return retStatus;
+}
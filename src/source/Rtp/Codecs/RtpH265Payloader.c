@@ -73,14 +73,65 @@ CleanUp:
     return retStatus;
 }
 
+STATUS createPayloadArrayForH265(UINT32 mtu, PBYTE nalus, UINT32 nalusLength, PPayloadArray pPayloadArray)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    PBYTE curPtrInNalus = nalus;
+    UINT32 remainNalusLength = nalusLength;
+    UINT32 nextNaluLength = 0;
+    UINT32 startIndex = 0;
+    UINT32 singlePayloadLength = 0;
+    UINT32 singlePayloadSubLenSize = 0;
+    PayloadArray naluPayloadArray;
+
+    CHK(nalus != NULL && pPayloadArray != NULL, STATUS_NULL_ARG);
+    CHK(mtu > H265_FU_HEADER_SIZE, STATUS_RTP_INPUT_MTU_TOO_SMALL);
+
+    pPayloadArray->payloadLength = 0;
+    pPayloadArray->payloadSubLenSize = 0;
+
+    do {
+        CHK_STATUS(getNextNaluLengthH265(curPtrInNalus, remainNalusLength, &startIndex, &nextNaluLength));
+
+        curPtrInNalus += startIndex;
+
+        remainNalusLength -= startIndex;
+
+        CHK(remainNalusLength != 0, retStatus);
+
+        // Sizing a NALU does not touch its bytes, so the frame is only scanned and copied once
+        CHK_STATUS(createPayloadFromNaluH265(mtu, curPtrInNalus, nextNaluLength, NULL, &singlePayloadLength, &singlePayloadSubLenSize));
+        CHK_STATUS(payloadArrayReserve(pPayloadArray, singlePayloadLength, singlePayloadSubLenSize));
+
+        naluPayloadArray.payloadBuffer = pPayloadArray->payloadBuffer + pPayloadArray->payloadLength;
+        naluPayloadArray.payloadSubLength = pPayloadArray->payloadSubLength + pPayloadArray->payloadSubLenSize;
+        naluPayloadArray.maxPayloadLength = singlePayloadLength;
+        naluPayloadArray.maxPayloadSubLenSize = singlePayloadSubLenSize;
+        CHK_STATUS(createPayloadFromNaluH265(mtu, curPtrInNalus, nextNaluLength, &naluPayloadArray, &singlePayloadLength, &singlePayloadSubLenSize));
+        pPayloadArray->payloadLength += singlePayloadLength;
+        pPayloadArray->payloadSubLenSize += singlePayloadSubLenSize;
+
+        remainNalusLength -= nextNaluLength;
+        curPtrInNalus += nextNaluLength;
+    } while (remainNalusLength != 0);
+
+CleanUp:
+    if (STATUS_FAILED(retStatus) && pPayloadArray != NULL) {
+        pPayloadArray->payloadLength = 0;
+        pPayloadArray->payloadSubLenSize = 0;
+    }
+
+    LEAVES();
+    return retStatus;
+}
+
 STATUS getNextNaluLengthH265(PBYTE nalus, UINT32 nalusLength, PUINT32 pStart, PUINT32 pNaluLength)
 {
     ENTERS();
 
     STATUS retStatus = STATUS_SUCCESS;
-    UINT32 zeroCount = 0, offset = 0;
-    BOOL naluFound = FALSE;
-    PBYTE pCurrent = NULL;
+    UINT32 offset = 0, naluLength = 0;
 
     CHK(nalus != NULL && pStart != NULL && pNaluLength != NULL, STATUS_NULL_ARG);
 
@@ -91,34 +142,15 @@ STATUS getNextNaluLengthH265(PBYTE nalus, UINT32 nalusLength, PUINT32 pStart, PU
 
     CHK(offset < nalusLength && offset < 4 && offset >= 2 && nalus[offset] == 1, STATUS_RTP_INVALID_NALU);
     *pStart = ++offset;
-    pCurrent = nalus + offset;
 
-    /* Not doing validation on number of consecutive zeros being less than 4 because some device can produce
-     * data with trailing zeros. */
-    while (offset < nalusLength) {
-        if (*pCurrent == 0) {
-            /* Maybe next byte is 1 */
-            offset++;
-            pCurrent++;
-
-        } else if (*pCurrent == 1) {
-            if (*(pCurrent - 1) == 0 && *(pCurrent - 2) == 0) {
-                zeroCount = *(pCurrent - 3) == 0 ? 3 : 2;
-                naluFound = TRUE;
-                break;
-            }
+    naluLength = findAnnexBStartCode(nalus + offset, nalusLength - offset);
 
-            /* The jump is always 3 because of the 1 previously matched.
-             * All the 0's must be after this '1' matched at offset */
-            offset += 3;
-            pCurrent += 3;
-        } else {
-            /* Can jump 3 bytes forward */
-            offset += 3;
-            pCurrent += 3;
-        }
+    /* Not doing validation on number of consecutive zeros being less than 4 because some device can produce
+     * data with trailing zeros. Only the zero right before the next start code belongs to it. */
+    if (naluLength < nalusLength - offset && naluLength > 0 && nalus[offset + naluLength - 1] == 0) {
+        naluLength--;
     }
-    *pNaluLength = MIN(offset, nalusLength) - *pStart - (naluFound ? zeroCount : 0);
+    *pNaluLength = naluLength;
 
 CleanUp:
 
@@ -230,7 +262,7 @@ STATUS depayH265FromRtpPayload(PBYTE pRawPacket, UINT32 packetLength, PBYTE pNal
     BOOL sizeCalculationOnly = (pNaluData == NULL);
     BOOL isStartingPacket = TRUE;
     PBYTE pCurPtrInNalu = pNaluData;
-    static BYTE start4ByteCode[] = {0x00, 0x00, 0x00, 0x01};
+    static const BYTE start4ByteCode[] = {0x00, 0x00, 0x00, 0x01};
 
     CHK(pRawPacket != NULL && pNaluLength != NULL, STATUS_NULL_ARG);
     CHK(packetLength > 0, retStatus);
@@ -281,3 +313,34 @@ CleanUp:
     LEAVES();
     return retStatus;
 }
+
+STATUS depayH265IovFromRtpPayload(PBYTE pRawPacket, UINT32 packetLength, PFrameIovArray pFrameIovArray)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    BYTE naluHeader[2];
+    static const BYTE start4ByteCode[] = {0x00, 0x00, 0x00, 0x01};
+
+    CHK(pRawPacket != NULL && pFrameIovArray != NULL, STATUS_NULL_ARG);
+    CHK(packetLength > 0, retStatus);
+
+    if (((pRawPacket[0] >> 1) & 0x3F) == H265_FU_TYPE_ID) {
+        CHK(packetLength > H265_FU_HEADER_SIZE, STATUS_RTP_INPUT_PACKET_TOO_SMALL);
+        // The NAL unit header of a fragmented NALU is not in any packet, rebuild it in scratch
+        if ((pRawPacket[2] & 0x80) != 0) {
+            naluHeader[0] = ((pRawPacket[2] & 0x3F) << 1) | (pRawPacket[0] & 0x81);
+            naluHeader[1] = pRawPacket[1];
+            CHK_STATUS(frameIovArrayAppend(pFrameIovArray, (PBYTE) start4ByteCode, SIZEOF(start4ByteCode)));
+            CHK_STATUS(frameIovArrayAppendScratch(pFrameIovArray, naluHeader, SIZEOF(naluHeader)));
+        }
+        CHK_STATUS(frameIovArrayAppend(pFrameIovArray, pRawPacket + H265_FU_HEADER_SIZE, packetLength - H265_FU_HEADER_SIZE));
+    } else {
+        CHK_STATUS(frameIovArrayAppend(pFrameIovArray, (PBYTE) start4ByteCode, SIZEOF(start4ByteCode)));
+        CHK_STATUS(frameIovArrayAppend(pFrameIovArray, pRawPacket, packetLength));
+    }
+
+CleanUp:
+
+    LEAVES();
+    return retStatus;
+}
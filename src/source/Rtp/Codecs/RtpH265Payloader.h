@@ -31,9 +31,11 @@ extern "C" {
  */
 
 STATUS createPayloadForH265(UINT32, PBYTE, UINT32, PBYTE, PUINT32, PUINT32, PUINT32);
+STATUS createPayloadArrayForH265(UINT32, PBYTE, UINT32, PPayloadArray);
 STATUS getNextNaluLengthH265(PBYTE, UINT32, PUINT32, PUINT32);
 STATUS createPayloadFromNaluH265(UINT32, PBYTE, UINT32, PPayloadArray, PUINT32, PUINT32);
 STATUS depayH265FromRtpPayload(PBYTE, UINT32, PBYTE, PUINT32, PBOOL);
+STATUS depayH265IovFromRtpPayload(PBYTE, UINT32, PFrameIovArray);
 
 #ifdef __cplusplus
 }
@@ -40,6 +40,31 @@ CleanUp:
     return retStatus;
 }
 
+STATUS createPayloadArrayForOpus(UINT32 mtu, PBYTE opusFrame, UINT32 opusFrameLength, PPayloadArray pPayloadArray)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    UINT32 payloadLength, payloadSubLenSize;
+
+    CHK(opusFrame != NULL && pPayloadArray != NULL, STATUS_NULL_ARG);
+
+    // The packetized size follows from the frame length alone, so reserve it up front and fill in one go
+    pPayloadArray->payloadLength = 0;
+    pPayloadArray->payloadSubLenSize = 0;
+    payloadLength = opusFrameLength;
+    payloadSubLenSize = 1;
+    CHK_STATUS(payloadArrayReserve(pPayloadArray, payloadLength, payloadSubLenSize));
+    CHK_STATUS(createPayloadForOpus(mtu, opusFrame, opusFrameLength, pPayloadArray->payloadBuffer, &payloadLength, pPayloadArray->payloadSubLength,
+                                      &payloadSubLenSize));
+    pPayloadArray->payloadLength = payloadLength;
+    pPayloadArray->payloadSubLenSize = payloadSubLenSize;
+
+CleanUp:
+
+    LEAVES();
+    return retStatus;
+}
+
 STATUS depayOpusFromRtpPayload(PBYTE pRawPacket, UINT32 packetLength, PBYTE pOpusData, PUINT32 pOpusLength, PBOOL pIsStart)
 {
     ENTERS();
@@ -73,3 +98,19 @@ CleanUp:
     LEAVES();
     return retStatus;
 }
+
+STATUS depayOpusIovFromRtpPayload(PBYTE pRawPacket, UINT32 packetLength, PFrameIovArray pFrameIovArray)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+
+    CHK(pRawPacket != NULL && pFrameIovArray != NULL, STATUS_NULL_ARG);
+    CHK(packetLength > 0, retStatus);
+
+    CHK_STATUS(frameIovArrayAppend(pFrameIovArray, pRawPacket, packetLength));
+
+CleanUp:
+
+    LEAVES();
+    return retStatus;
+}
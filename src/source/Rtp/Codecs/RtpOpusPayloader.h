@@ -11,7 +11,9 @@ extern "C" {
 #endif
 
 STATUS createPayloadForOpus(UINT32, PBYTE, UINT32, PBYTE, PUINT32, PUINT32, PUINT32);
+STATUS createPayloadArrayForOpus(UINT32, PBYTE, UINT32, PPayloadArray);
 STATUS depayOpusFromRtpPayload(PBYTE, UINT32, PBYTE, PUINT32, PBOOL);
+STATUS depayOpusIovFromRtpPayload(PBYTE, UINT32, PFrameIovArray);
 
 #ifdef __cplusplus
 }
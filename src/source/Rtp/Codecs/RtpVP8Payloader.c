@@ -51,6 +51,32 @@ CleanUp:
     return retStatus;
 }
 
+STATUS createPayloadArrayForVP8(UINT32 mtu, PBYTE pData, UINT32 dataLen, PPayloadArray pPayloadArray)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    UINT32 payloadLength, payloadSubLenSize;
+
+    CHK(pData != NULL && pPayloadArray != NULL, STATUS_NULL_ARG);
+    CHK(mtu > VP8_PAYLOAD_DESCRIPTOR_SIZE, STATUS_RTP_INPUT_MTU_TOO_SMALL);
+
+    // The packetized size follows from the frame length alone, so reserve it up front and fill in one go
+    pPayloadArray->payloadLength = 0;
+    pPayloadArray->payloadSubLenSize = 0;
+    payloadSubLenSize = dataLen / (mtu - VP8_PAYLOAD_DESCRIPTOR_SIZE) + (dataLen % (mtu - VP8_PAYLOAD_DESCRIPTOR_SIZE) == 0 ? 0 : 1);
+    payloadLength = dataLen + payloadSubLenSize * VP8_PAYLOAD_DESCRIPTOR_SIZE;
+    CHK_STATUS(payloadArrayReserve(pPayloadArray, payloadLength, payloadSubLenSize));
+    CHK_STATUS(createPayloadForVP8(mtu, pData, dataLen, pPayloadArray->payloadBuffer, &payloadLength, pPayloadArray->payloadSubLength,
+                                      &payloadSubLenSize));
+    pPayloadArray->payloadLength = payloadLength;
+    pPayloadArray->payloadSubLenSize = payloadSubLenSize;
+
+CleanUp:
+
+    LEAVES();
+    return retStatus;
+}
+
 STATUS depayVP8FromRtpPayload(PBYTE pRawPacket, UINT32 packetLength, PBYTE pVp8Data, PUINT32 pVp8Length, PBOOL pIsStart)
 {
     ENTERS();
@@ -115,3 +141,23 @@ CleanUp:
     LEAVES();
     return retStatus;
 }
+
+STATUS depayVP8IovFromRtpPayload(PBYTE pRawPacket, UINT32 packetLength, PFrameIovArray pFrameIovArray)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    UINT32 vp8Length = 0;
+
+    CHK(pRawPacket != NULL && pFrameIovArray != NULL, STATUS_NULL_ARG);
+    CHK(packetLength > 0, retStatus);
+
+    // Size calculation skips the payload descriptor, the VP8 data is whatever follows it
+    CHK_STATUS(depayVP8FromRtpPayload(pRawPacket, packetLength, NULL, &vp8Length, NULL));
+    CHK(vp8Length <= packetLength, STATUS_RTP_INPUT_PACKET_TOO_SMALL);
+    CHK_STATUS(frameIovArrayAppend(pFrameIovArray, pRawPacket + packetLength - vp8Length, vp8Length));
+
+CleanUp:
+
+    LEAVES();
+    return retStatus;
+}
@@ -14,7 +14,9 @@ extern "C" {
 #define VP8_PAYLOAD_DESCRIPTOR_START_OF_PARTITION_VALUE 0X10
 
 STATUS createPayloadForVP8(UINT32, PBYTE, UINT32, PBYTE, PUINT32, PUINT32, PUINT32);
+STATUS createPayloadArrayForVP8(UINT32, PBYTE, UINT32, PPayloadArray);
 STATUS depayVP8FromRtpPayload(PBYTE, UINT32, PBYTE, PUINT32, PBOOL);
+STATUS depayVP8IovFromRtpPayload(PBYTE, UINT32, PFrameIovArray);
 
 #ifdef __cplusplus
 }
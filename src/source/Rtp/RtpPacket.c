@@ -12,6 +12,7 @@ STATUS createRtpPacket(UINT8 version, BOOL padding, BOOL extension, UINT8 csrcCo
     CHK(pRtpPacket != NULL, STATUS_NOT_ENOUGH_MEMORY);
     pRtpPacket->pRawPacket = NULL;
     pRtpPacket->rawPacketLength = 0;
+    pRtpPacket->pPacketPool = NULL;
     CHK_STATUS(setRtpPacket(version, padding, extension, csrcCount, marker, payloadType, sequenceNumber, timestamp, ssrc, csrcArray, extensionProfile,
                             extensionLength, extensionPayload, payload, payloadLength, pRtpPacket));
 
@@ -71,6 +72,13 @@ STATUS freeRtpPacket(PRtpPacket* ppRtpPacket)
 
     CHK(ppRtpPacket != NULL, STATUS_NULL_ARG);
 
+    if (*ppRtpPacket != NULL && (*ppRtpPacket)->pPacketPool != NULL) {
+        // Pooled packets own neither their raw bytes nor themselves, drop this holder's reference instead
+        retStatus = rtpPacketPoolReleasePacket(*ppRtpPacket);
+        *ppRtpPacket = NULL;
+        CHK(FALSE, retStatus);
+    }
+
     if (*ppRtpPacket != NULL) {
         SAFE_MEMFREE((*ppRtpPacket)->pRawPacket);
     }
@@ -92,6 +100,7 @@ STATUS createRtpPacketFromBytes(PBYTE rawPacket, UINT32 packetLength, PRtpPacket
     CHK(pRtpPacket != NULL, STATUS_NOT_ENOUGH_MEMORY);
     pRtpPacket->pRawPacket = rawPacket;
     pRtpPacket->rawPacketLength = packetLength;
+    pRtpPacket->pPacketPool = NULL;
     CHK_STATUS(setRtpPacketFromBytes(rawPacket, packetLength, pRtpPacket));
 
 CleanUp:
@@ -122,6 +131,8 @@ STATUS constructRetransmitRtpPacketFromBytes(PBYTE rawPacket, UINT32 packetLengt
     PRtpPacket pRtpPacket = (PRtpPacket) MEMALLOC(SIZEOF(RtpPacket));
 
     CHK(pRtpPacket != NULL, STATUS_NOT_ENOUGH_MEMORY);
+    pRtpPacket->pRawPacket = NULL;
+    pRtpPacket->pPacketPool = NULL;
     CHK_STATUS(setRtpPacketFromBytes(rawPacket, packetLength, pRtpPacket));
     pPayload = (PBYTE) MEMALLOC(pRtpPacket->payloadLength + SIZEOF(UINT16));
     CHK(pPayload != NULL, STATUS_NOT_ENOUGH_MEMORY);
@@ -350,3 +361,99 @@ CleanUp:
     LEAVES();
     return retStatus;
 }
+
+STATUS payloadArrayReserve(PPayloadArray pPayloadArray, UINT32 payloadLength, UINT32 payloadSubLenSize)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    UINT32 newCapacity;
+    PBYTE pNewPayloadBuffer = NULL;
+    PUINT32 pNewPayloadSubLength = NULL;
+
+    CHK(pPayloadArray != NULL, STATUS_NULL_ARG);
+
+    // Grow geometrically so a frame filled in a single pass only reallocates a handful of times, the arrays are kept across frames
+    if (pPayloadArray->payloadLength + payloadLength > pPayloadArray->maxPayloadLength) {
+        newCapacity = MAX(pPayloadArray->payloadLength + payloadLength, pPayloadArray->maxPayloadLength * 2);
+        pNewPayloadBuffer = (PBYTE) MEMREALLOC(pPayloadArray->payloadBuffer, newCapacity);
+        CHK(pNewPayloadBuffer != NULL, STATUS_NOT_ENOUGH_MEMORY);
+        pPayloadArray->payloadBuffer = pNewPayloadBuffer;
+        pPayloadArray->maxPayloadLength = newCapacity;
+    }
+
+    if (pPayloadArray->payloadSubLenSize + payloadSubLenSize > pPayloadArray->maxPayloadSubLenSize) {
+        newCapacity = MAX(pPayloadArray->payloadSubLenSize + payloadSubLenSize, pPayloadArray->maxPayloadSubLenSize * 2);
+        pNewPayloadSubLength = (PUINT32) MEMREALLOC(pPayloadArray->payloadSubLength, newCapacity * SIZEOF(UINT32));
+        CHK(pNewPayloadSubLength != NULL, STATUS_NOT_ENOUGH_MEMORY);
+        pPayloadArray->payloadSubLength = pNewPayloadSubLength;
+        pPayloadArray->maxPayloadSubLenSize = newCapacity;
+    }
+
+CleanUp:
+
+    return retStatus;
+}
+
+STATUS frameIovArrayReserve(PFrameIovArray pFrameIovArray, UINT32 iovCount, UINT32 scratchLength)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    UINT32 newCapacity;
+    PRtcFrameIov pNewIovs = NULL;
+    PBYTE pNewScratch = NULL;
+
+    CHK(pFrameIovArray != NULL, STATUS_NULL_ARG);
+
+    if (pFrameIovArray->iovCount + iovCount > pFrameIovArray->maxIovCount) {
+        newCapacity = MAX(pFrameIovArray->iovCount + iovCount, pFrameIovArray->maxIovCount * 2);
+        pNewIovs = (PRtcFrameIov) MEMREALLOC(pFrameIovArray->pIovs, newCapacity * SIZEOF(RtcFrameIov));
+        CHK(pNewIovs != NULL, STATUS_NOT_ENOUGH_MEMORY);
+        pFrameIovArray->pIovs = pNewIovs;
+        pFrameIovArray->maxIovCount = newCapacity;
+    }
+
+    if (pFrameIovArray->scratchLength + scratchLength > pFrameIovArray->maxScratchLength) {
+        newCapacity = MAX(pFrameIovArray->scratchLength + scratchLength, pFrameIovArray->maxScratchLength * 2);
+        pNewScratch = (PBYTE) MEMREALLOC(pFrameIovArray->pScratch, newCapacity);
+        CHK(pNewScratch != NULL, STATUS_NOT_ENOUGH_MEMORY);
+        pFrameIovArray->pScratch = pNewScratch;
+        pFrameIovArray->maxScratchLength = newCapacity;
+    }
+
+CleanUp:
+
+    return retStatus;
+}
+
+STATUS frameIovArrayAppend(PFrameIovArray pFrameIovArray, PBYTE pData, UINT32 size)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+
+    CHK(pFrameIovArray != NULL && pData != NULL, STATUS_NULL_ARG);
+    CHK(size != 0, retStatus);
+    CHK_STATUS(frameIovArrayReserve(pFrameIovArray, 1, 0));
+
+    pFrameIovArray->pIovs[pFrameIovArray->iovCount].pData = pData;
+    pFrameIovArray->pIovs[pFrameIovArray->iovCount].size = size;
+    pFrameIovArray->iovCount++;
+
+CleanUp:
+
+    return retStatus;
+}
+
+STATUS frameIovArrayAppendScratch(PFrameIovArray pFrameIovArray, PBYTE pData, UINT32 size)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    PBYTE pScratch;
+
+    CHK(pFrameIovArray != NULL && pData != NULL, STATUS_NULL_ARG);
+    CHK(pFrameIovArray->scratchLength + size <= pFrameIovArray->maxScratchLength, STATUS_BUFFER_TOO_SMALL);
+
+    pScratch = pFrameIovArray->pScratch + pFrameIovArray->scratchLength;
+    MEMCPY(pScratch, pData, size);
+    CHK_STATUS(frameIovArrayAppend(pFrameIovArray, pScratch, size));
+    pFrameIovArray->scratchLength += size;
+
+CleanUp:
+
+    return retStatus;
+}
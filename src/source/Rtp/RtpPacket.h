@@ -95,6 +95,27 @@ struct __Payloads {
 typedef struct __Payloads PayloadArray;
 typedef PayloadArray* PPayloadArray;
 
+// Slices of a frame depayloaded without copying. Bytes that are not in any packet, like rebuilt NAL unit
+// headers, go to the scratch buffer, which is reserved for the whole frame up front so slices into it stay valid.
+struct __FrameIovArray {
+    PRtcFrameIov pIovs;
+    UINT32 iovCount;
+    UINT32 maxIovCount;
+    PBYTE pScratch;
+    UINT32 scratchLength;
+    UINT32 maxScratchLength;
+};
+typedef struct __FrameIovArray FrameIovArray;
+typedef FrameIovArray* PFrameIovArray;
+
+// Appends the slices of a single RTP payload to the frame iov array
+typedef STATUS (*DepayRtpPayloadIovFunc)(PBYTE, UINT32, PFrameIovArray);
+
+// Most scratch bytes any depayloader needs for a single packet, the H265 FU NAL unit header
+#define DEPAY_IOV_MAX_SCRATCH_PER_PACKET 2
+
+struct __RtpPacketPool;
+
 typedef struct __RtpPacket RtpPacket;
 struct __RtpPacket {
     RtpPacketHeader header;
@@ -106,6 +127,8 @@ struct __RtpPacket {
     UINT64 receivedTime;
     // used for twcc time delta calculation
     UINT64 sentTime;
+    // pool owning this packet and its raw bytes, NULL when both are heap allocated
+    struct __RtpPacketPool* pPacketPool;
 };
 typedef RtpPacket* PRtpPacket;
 
@@ -119,6 +142,16 @@ STATUS createBytesFromRtpPacket(PRtpPacket, PBYTE, PUINT32);
 STATUS setBytesFromRtpPacket(PRtpPacket, PBYTE, UINT32);
 STATUS constructRtpPackets(PPayloadArray, UINT8, UINT16, UINT32, UINT32, PRtpPacket, UINT32);
 
+// Makes room for appending the given number of payload bytes and sub lengths after what the payload array already holds
+STATUS payloadArrayReserve(PPayloadArray, UINT32, UINT32);
+
+// Makes room for appending the given number of slices and scratch bytes after what the frame iov array already holds.
+// Growing the scratch buffer moves it, so only do that before the first slice of a frame is added.
+STATUS frameIovArrayReserve(PFrameIovArray, UINT32, UINT32);
+STATUS frameIovArrayAppend(PFrameIovArray, PBYTE, UINT32);
+// Copies bytes into the already reserved scratch buffer and appends a slice over them
+STATUS frameIovArrayAppendScratch(PFrameIovArray, PBYTE, UINT32);
+
 #ifdef __cplusplus
 }
 #endif
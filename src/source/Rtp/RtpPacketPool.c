@@ -0,0 +1,217 @@
+#define LOG_CLASS "RtpPacketPool"
+
+#include "../Include_i.h"
+
+#define RTP_PACKET_POOL_SLOT_STRIDE(capacity)                                                                                                        \
+    ALIGN_UP_TO_MACHINE_WORD(SIZEOF(RtpPacketPoolSlot) + RTP_PACKET_POOL_HEADROOM_LEN + (capacity) + RTP_PACKET_POOL_TAILROOM_LEN)
+
+static VOID rtpPacketPoolInitSlot(PRtpPacketPool pRtpPacketPool, PRtpPacketPoolSlot pSlot, UINT32 capacity, BOOL oversized)
+{
+    MEMSET(pSlot, 0x00, SIZEOF(RtpPacketPoolSlot));
+    pSlot->packet.pPacketPool = pRtpPacketPool;
+    pSlot->packet.pRawPacket = (PBYTE) (pSlot + 1) + RTP_PACKET_POOL_HEADROOM_LEN;
+    pSlot->capacity = capacity;
+    pSlot->oversized = oversized;
+}
+
+static STATUS rtpPacketPoolAddSlab(PRtpPacketPool pRtpPacketPool)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    PRtpPacketPoolSlab pSlab = NULL;
+    PRtpPacketPoolSlot pSlot = NULL;
+    PBYTE pCurPtr = NULL;
+    UINT32 i, stride;
+
+    stride = RTP_PACKET_POOL_SLOT_STRIDE(pRtpPacketPool->slotCapacity);
+    pSlab = (PRtpPacketPoolSlab) MEMALLOC(ALIGN_UP_TO_MACHINE_WORD(SIZEOF(RtpPacketPoolSlab)) + stride * pRtpPacketPool->slotsPerSlab);
+    CHK(pSlab != NULL, STATUS_NOT_ENOUGH_MEMORY);
+
+    pSlab->pNext = pRtpPacketPool->pSlabList;
+    pRtpPacketPool->pSlabList = pSlab;
+
+    pCurPtr = (PBYTE) pSlab + ALIGN_UP_TO_MACHINE_WORD(SIZEOF(RtpPacketPoolSlab));
+    for (i = 0; i < pRtpPacketPool->slotsPerSlab; i++, pCurPtr += stride) {
+        pSlot = (PRtpPacketPoolSlot) pCurPtr;
+        rtpPacketPoolInitSlot(pRtpPacketPool, pSlot, pRtpPacketPool->slotCapacity, FALSE);
+        pSlot->pNext = pRtpPacketPool->pFreeList;
+        pRtpPacketPool->pFreeList = pSlot;
+    }
+
+    pRtpPacketPool->slotCount += pRtpPacketPool->slotsPerSlab;
+    DLOGV("Packet pool grew to %u slots of %u bytes", pRtpPacketPool->slotCount, pRtpPacketPool->slotCapacity);
+
+CleanUp:
+
+    LEAVES();
+    return retStatus;
+}
+
+STATUS createRtpPacketPool(UINT32 slotCapacity, UINT32 slotsPerSlab, PRtpPacketPool* ppRtpPacketPool)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    PRtpPacketPool pRtpPacketPool = NULL;
+
+    CHK(ppRtpPacketPool != NULL, STATUS_NULL_ARG);
+    CHK(slotCapacity != 0 && slotsPerSlab != 0, STATUS_INVALID_ARG);
+
+    pRtpPacketPool = (PRtpPacketPool) MEMCALLOC(1, SIZEOF(RtpPacketPool));
+    CHK(pRtpPacketPool != NULL, STATUS_NOT_ENOUGH_MEMORY);
+
+    pRtpPacketPool->slotCapacity = slotCapacity;
+    pRtpPacketPool->slotsPerSlab = slotsPerSlab;
+    pRtpPacketPool->lock = MUTEX_CREATE(FALSE);
+
+CleanUp:
+
+    if (STATUS_FAILED(retStatus)) {
+        freeRtpPacketPool(&pRtpPacketPool);
+    }
+
+    if (ppRtpPacketPool != NULL) {
+        *ppRtpPacketPool = pRtpPacketPool;
+    }
+
+    LEAVES();
+    return retStatus;
+}
+
+STATUS freeRtpPacketPool(PRtpPacketPool* ppRtpPacketPool)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    PRtpPacketPool pRtpPacketPool = NULL;
+    PRtpPacketPoolSlab pSlab = NULL, pNextSlab = NULL;
+
+    CHK(ppRtpPacketPool != NULL, STATUS_NULL_ARG);
+
+    pRtpPacketPool = *ppRtpPacketPool;
+    // freeRtpPacketPool is idempotent
+    CHK(pRtpPacketPool != NULL, retStatus);
+
+    if (pRtpPacketPool->slotsInUse != 0) {
+        DLOGW("Freeing packet pool with %u packets still in use", pRtpPacketPool->slotsInUse);
+    }
+
+    for (pSlab = pRtpPacketPool->pSlabList; pSlab != NULL; pSlab = pNextSlab) {
+        pNextSlab = pSlab->pNext;
+        MEMFREE(pSlab);
+    }
+
+    if (IS_VALID_MUTEX_VALUE(pRtpPacketPool->lock)) {
+        MUTEX_FREE(pRtpPacketPool->lock);
+    }
+
+    SAFE_MEMFREE(*ppRtpPacketPool);
+
+CleanUp:
+
+    CHK_LOG_ERR(retStatus);
+
+    LEAVES();
+    return retStatus;
+}
+
+STATUS rtpPacketPoolGetPacket(PRtpPacketPool pRtpPacketPool, UINT32 rawPacketSize, PRtpPacket* ppRtpPacket)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    PRtpPacketPoolSlot pSlot = NULL;
+    BOOL locked = FALSE;
+
+    CHK(pRtpPacketPool != NULL && ppRtpPacket != NULL, STATUS_NULL_ARG);
+
+    if (rawPacketSize > pRtpPacketPool->slotCapacity) {
+        // Does not fit a pooled slot, hand out a one-off slot that is freed on the last release
+        pSlot = (PRtpPacketPoolSlot) MEMALLOC(RTP_PACKET_POOL_SLOT_STRIDE(rawPacketSize));
+        CHK(pSlot != NULL, STATUS_NOT_ENOUGH_MEMORY);
+        rtpPacketPoolInitSlot(pRtpPacketPool, pSlot, rawPacketSize, TRUE);
+    } else {
+        MUTEX_LOCK(pRtpPacketPool->lock);
+        locked = TRUE;
+
+        if (pRtpPacketPool->pFreeList == NULL) {
+            CHK_STATUS(rtpPacketPoolAddSlab(pRtpPacketPool));
+        }
+
+        pSlot = pRtpPacketPool->pFreeList;
+        pRtpPacketPool->pFreeList = pSlot->pNext;
+        pRtpPacketPool->slotsInUse++;
+    }
+
+    pSlot->pNext = NULL;
+    pSlot->refCount = 1;
+    pSlot->packet.rawPacketLength = 0;
+    pSlot->packet.receivedTime = 0;
+    pSlot->packet.sentTime = 0;
+
+    *ppRtpPacket = &pSlot->packet;
+
+CleanUp:
+
+    if (locked) {
+        MUTEX_UNLOCK(pRtpPacketPool->lock);
+    }
+
+    LEAVES();
+    return retStatus;
+}
+
+STATUS rtpPacketPoolRetainPacket(PRtpPacket pRtpPacket)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    PRtpPacketPoolSlot pSlot = (PRtpPacketPoolSlot) pRtpPacket;
+    PRtpPacketPool pRtpPacketPool = NULL;
+
+    CHK(pRtpPacket != NULL && pRtpPacket->pPacketPool != NULL, STATUS_NULL_ARG);
+    pRtpPacketPool = pRtpPacket->pPacketPool;
+
+    MUTEX_LOCK(pRtpPacketPool->lock);
+    pSlot->refCount++;
+    MUTEX_UNLOCK(pRtpPacketPool->lock);
+
+CleanUp:
+
+    LEAVES();
+    return retStatus;
+}
+
+STATUS rtpPacketPoolReleasePacket(PRtpPacket pRtpPacket)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    PRtpPacketPoolSlot pSlot = (PRtpPacketPoolSlot) pRtpPacket;
+    PRtpPacketPool pRtpPacketPool = NULL;
+    BOOL freeSlot = FALSE, locked = FALSE;
+
+    CHK(pRtpPacket != NULL && pRtpPacket->pPacketPool != NULL, STATUS_NULL_ARG);
+    pRtpPacketPool = pRtpPacket->pPacketPool;
+
+    MUTEX_LOCK(pRtpPacketPool->lock);
+    locked = TRUE;
+    CHK_ERR(pSlot->refCount > 0, STATUS_INVALID_OPERATION, "Releasing a pooled packet that has no holders");
+    if (--pSlot->refCount == 0) {
+        if (pSlot->oversized) {
+            freeSlot = TRUE;
+        } else {
+            pSlot->pNext = pRtpPacketPool->pFreeList;
+            pRtpPacketPool->pFreeList = pSlot;
+            pRtpPacketPool->slotsInUse--;
+        }
+    }
+
+CleanUp:
+
+    if (locked) {
+        MUTEX_UNLOCK(pRtpPacketPool->lock);
+    }
+
+    if (freeSlot) {
+        MEMFREE(pSlot);
+    }
+
+    LEAVES();
+    return retStatus;
+}
@@ -0,0 +1,76 @@
+/*******************************************
+RTP Packet Pool include file
+*******************************************/
+#ifndef __KINESIS_VIDEO_WEBRTC_CLIENT_RTP_RTPPACKETPOOL_H
+#define __KINESIS_VIDEO_WEBRTC_CLIENT_RTP_RTPPACKETPOOL_H
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Number of packet slots carved out of a single slab allocation when the pool runs dry
+#define DEFAULT_RTP_PACKET_POOL_SLAB_SLOT_COUNT 64
+
+// Room kept around the raw packet bytes of every slot so a relayed packet can be framed for TURN in place
+#define RTP_PACKET_POOL_HEADROOM_LEN TURN_DATA_CHANNEL_SEND_HEADROOM
+#define RTP_PACKET_POOL_TAILROOM_LEN TURN_DATA_CHANNEL_SEND_TAILROOM
+
+// Largest RTP header the sender produces: fixed header plus the one-word TWCC header extension
+#define RTP_PACKET_POOL_MAX_HEADER_LEN (MIN_HEADER_LENGTH + SIZEOF(UINT32) + SIZEOF(UINT32))
+
+/*
+ * A pool slot. The RtpPacket MUST be the first member so that a PRtpPacket handed out by the pool
+ * can be converted back to its slot. The raw packet bytes follow the slot header and RTP_PACKET_POOL_HEADROOM_LEN
+ * bytes of headroom in the same allocation.
+ */
+typedef struct __RtpPacketPoolSlot RtpPacketPoolSlot;
+struct __RtpPacketPoolSlot {
+    RtpPacket packet;
+    // Next slot in the pool free list
+    RtpPacketPoolSlot* pNext;
+    // Number of holders of this slot. Guarded by the pool lock
+    UINT32 refCount;
+    // Size of the raw packet buffer following this slot, not counting headroom and tailroom
+    UINT32 capacity;
+    // Slot was allocated on its own because the request did not fit a pooled slot
+    BOOL oversized;
+};
+typedef RtpPacketPoolSlot* PRtpPacketPoolSlot;
+
+typedef struct __RtpPacketPoolSlab RtpPacketPoolSlab;
+struct __RtpPacketPoolSlab {
+    RtpPacketPoolSlab* pNext;
+};
+typedef RtpPacketPoolSlab* PRtpPacketPoolSlab;
+
+typedef struct __RtpPacketPool RtpPacketPool;
+struct __RtpPacketPool {
+    // Lock guarding the free list, slab list and slot reference counts
+    MUTEX lock;
+    // Raw packet capacity of every pooled slot
+    UINT32 slotCapacity;
+    // Number of slots allocated per slab
+    UINT32 slotsPerSlab;
+    // Total number of pooled slots ever allocated
+    UINT32 slotCount;
+    // Number of slots currently handed out
+    UINT32 slotsInUse;
+    // Singly linked list of free slots
+    PRtpPacketPoolSlot pFreeList;
+    // Singly linked list of slab allocations, freed with the pool
+    PRtpPacketPoolSlab pSlabList;
+};
+typedef RtpPacketPool* PRtpPacketPool;
+
+STATUS createRtpPacketPool(UINT32, UINT32, PRtpPacketPool*);
+STATUS freeRtpPacketPool(PRtpPacketPool*);
+STATUS rtpPacketPoolGetPacket(PRtpPacketPool, UINT32, PRtpPacket*);
+STATUS rtpPacketPoolRetainPacket(PRtpPacket);
+STATUS rtpPacketPoolReleasePacket(PRtpPacket);
+
+#ifdef __cplusplus
+}
+#endif
+#endif //__KINESIS_VIDEO_WEBRTC_CLIENT_RTP_RTPPACKETPOOL_H
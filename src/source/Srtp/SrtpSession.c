@@ -1,17 +1,83 @@
 #define LOG_CLASS "SRTP"
 #include "../Include_i.h"
 
-STATUS initSrtpSession(PBYTE receiveKey, PBYTE transmitKey, KVS_SRTP_PROFILE profile, PSrtpSession* ppSrtpSession)
+typedef void (*SrtpPolicySetterFunc)(srtp_crypto_policy_t*);
+
+static STATUS getSrtpPolicySetters(KVS_SRTP_PROFILE profile, SrtpPolicySetterFunc* pSrtpPolicySetter, SrtpPolicySetterFunc* pSrtcpPolicySetter)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+
+    switch (profile) {
+        case KVS_SRTP_PROFILE_AES128_CM_HMAC_SHA1_32:
+            *pSrtpPolicySetter = srtp_crypto_policy_set_aes_cm_128_hmac_sha1_32;
+            *pSrtcpPolicySetter = srtp_crypto_policy_set_rtp_default;
+            break;
+        case KVS_SRTP_PROFILE_AES128_CM_HMAC_SHA1_80:
+            *pSrtpPolicySetter = srtp_crypto_policy_set_rtp_default;
+            *pSrtcpPolicySetter = srtp_crypto_policy_set_rtp_default;
+            break;
+#ifdef KVS_USE_OPENSSL
+        // AES-GCM encrypts and authenticates in one pass with a 16 byte tag: https://tools.ietf.org/html/rfc7714
+        case KVS_SRTP_PROFILE_AEAD_AES_128_GCM:
+            *pSrtpPolicySetter = srtp_crypto_policy_set_aes_gcm_128_16_auth;
+            *pSrtcpPolicySetter = srtp_crypto_policy_set_aes_gcm_128_16_auth;
+            break;
+        case KVS_SRTP_PROFILE_AEAD_AES_256_GCM:
+            *pSrtpPolicySetter = srtp_crypto_policy_set_aes_gcm_256_16_auth;
+            *pSrtcpPolicySetter = srtp_crypto_policy_set_aes_gcm_256_16_auth;
+            break;
+#endif
+        default:
+            CHK(FALSE, STATUS_SSL_UNKNOWN_SRTP_PROFILE);
+    }
+
+CleanUp:
+
+    return retStatus;
+}
+
+STATUS srtpSessionIsProfileSupported(KVS_SRTP_PROFILE profile, PBOOL pSupported)
 {
     ENTERS();
-    UNUSED_PARAM(profile);
+    STATUS retStatus = STATUS_SUCCESS;
+    srtp_t srtpSession = NULL;
+    srtp_policy_t policy;
+    BYTE key[MAX_SRTP_MASTER_KEY_LEN + MAX_SRTP_SALT_KEY_LEN];
+    SrtpPolicySetterFunc srtp_policy_setter = NULL, srtcp_policy_setter = NULL;
+
+    CHK(pSupported != NULL, STATUS_NULL_ARG);
+    *pSupported = FALSE;
+    CHK(STATUS_SUCCEEDED(getSrtpPolicySetters(profile, &srtp_policy_setter, &srtcp_policy_setter)), retStatus);
+
+    MEMSET(&policy, 0x00, SIZEOF(srtp_policy_t));
+    MEMSET(key, 0x00, SIZEOF(key));
+    srtp_policy_setter(&policy.rtp);
+    srtcp_policy_setter(&policy.rtcp);
+    policy.key = key;
+    policy.ssrc.type = ssrc_any_outbound;
+    policy.next = NULL;
+
+    // A libsrtp built without the cipher, like AES-GCM without its OpenSSL backend, still sets the policy but fails to
+    // allocate the cipher when the session is created
+    if (srtp_create(&srtpSession, &policy) == srtp_err_status_ok) {
+        *pSupported = TRUE;
+        srtp_dealloc(srtpSession);
+    }
+
+CleanUp:
 
+    LEAVES();
+    return retStatus;
+}
+
+STATUS initSrtpSession(PBYTE receiveKey, PBYTE transmitKey, KVS_SRTP_PROFILE profile, PSrtpSession* ppSrtpSession)
+{
+    ENTERS();
     STATUS retStatus = STATUS_SUCCESS;
     PSrtpSession pSrtpSession = NULL;
     srtp_policy_t transmitPolicy, receivePolicy;
     srtp_err_status_t errStatus;
-    void (*srtp_policy_setter)(srtp_crypto_policy_t*) = NULL;
-    void (*srtcp_policy_setter)(srtp_crypto_policy_t*) = NULL;
+    SrtpPolicySetterFunc srtp_policy_setter = NULL, srtcp_policy_setter = NULL;
 
     CHK(receiveKey != NULL && transmitKey != NULL && ppSrtpSession != NULL, STATUS_NULL_ARG);
 
@@ -20,18 +86,7 @@ STATUS initSrtpSession(PBYTE receiveKey, PBYTE transmitKey, KVS_SRTP_PROFILE pro
     MEMSET(&transmitPolicy, 0x00, SIZEOF(srtp_policy_t));
     MEMSET(&receivePolicy, 0x00, SIZEOF(srtp_policy_t));
 
-    switch (profile) {
-        case KVS_SRTP_PROFILE_AES128_CM_HMAC_SHA1_32:
-            srtp_policy_setter = srtp_crypto_policy_set_aes_cm_128_hmac_sha1_32;
-            srtcp_policy_setter = srtp_crypto_policy_set_rtp_default;
-            break;
-        case KVS_SRTP_PROFILE_AES128_CM_HMAC_SHA1_80:
-            srtp_policy_setter = srtp_crypto_policy_set_rtp_default;
-            srtcp_policy_setter = srtp_crypto_policy_set_rtp_default;
-            break;
-        default:
-            CHK(FALSE, STATUS_SSL_UNKNOWN_SRTP_PROFILE);
-    }
+    CHK_STATUS(getSrtpPolicySetters(profile, &srtp_policy_setter, &srtcp_policy_setter));
 
     srtp_policy_setter(&receivePolicy.rtp);
     srtcp_policy_setter(&receivePolicy.rtcp);
@@ -22,6 +22,9 @@ typedef SrtpSession* PSrtpSession;
 
 STATUS initSrtpSession(PBYTE receiveKey, PBYTE transmitKey, KVS_SRTP_PROFILE profile, PSrtpSession* ppSrtpSession);
 
+// Whether the linked libsrtp can create a session for the profile, srtp_init must have been called
+STATUS srtpSessionIsProfileSupported(KVS_SRTP_PROFILE profile, PBOOL pSupported);
+
 STATUS decryptSrtpPacket(PSrtpSession pSrtpSession, PVOID encryptedMessage, PINT32 len);
 STATUS decryptSrtcpPacket(PSrtpSession pSrtpSession, PVOID encryptedMessage, PINT32 len);
 
@@ -67,8 +67,85 @@ CleanUp:
     return retStatus;
 }
 
+STATUS stunPackageBindingResponse(PBYTE transactionId, PKvsIpAddress pMappedAddress, STUN_ATTRIBUTE_TYPE iceControlType, UINT64 tieBreaker,
+                                  PKvsSha1HmacKey pHmacKey, PBYTE pBuffer, PUINT32 pSize)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    UINT32 packetSize, encodedLen, crc32;
+    UINT16 size;
+    INT64 data64;
+    PBYTE pCurrentBufferPosition = pBuffer;
+    StunHeader stunHeader;
+
+    CHK(transactionId != NULL && pMappedAddress != NULL && pHmacKey != NULL && pBuffer != NULL && pSize != NULL, STATUS_NULL_ARG);
+    CHK(iceControlType == STUN_ATTRIBUTE_TYPE_ICE_CONTROLLING || iceControlType == STUN_ATTRIBUTE_TYPE_ICE_CONTROLLED, STATUS_INVALID_ARG);
+
+    /**
+     * Same bytes serializeStunPacket produces for a packet built with createStunPacket, appendStunAddressAttribute and
+     * appendStunIceControllAttribute, with message integrity and fingerprint:
+     * - STUN header
+     * - XOR mapped address, 12 or 24 bytes
+     * - ICE controlling or controlled, 12 bytes
+     * - message integrity, 24 bytes
+     * - fingerprint, 8 bytes
+     * The layout only depends on the address family so the values are written straight into place.
+     */
+    encodedLen = STUN_ATTRIBUTE_HEADER_LEN + STUN_ATTRIBUTE_ADDRESS_HEADER_LEN + (IS_IPV4_ADDR(pMappedAddress) ? IPV4_ADDRESS_LENGTH : IPV6_ADDRESS_LENGTH);
+    packetSize = STUN_BINDING_RESPONSE_MAX_LEN - STUN_ATTRIBUTE_HEADER_LEN - STUN_ATTRIBUTE_ADDRESS_HEADER_LEN - IPV6_ADDRESS_LENGTH + encodedLen;
+    CHK(*pSize >= packetSize, STATUS_NOT_ENOUGH_MEMORY);
+
+    // Header, the length is set before each of the hashes
+    putInt16((PINT16) pCurrentBufferPosition, STUN_PACKET_TYPE_BINDING_RESPONSE_SUCCESS);
+    putInt32((PINT32) (pCurrentBufferPosition + STUN_HEADER_TYPE_LEN + STUN_HEADER_DATA_LEN), STUN_HEADER_MAGIC_COOKIE);
+    MEMCPY(pCurrentBufferPosition + STUN_HEADER_TYPE_LEN + STUN_HEADER_DATA_LEN + STUN_HEADER_MAGIC_COOKIE_LEN, transactionId,
+           STUN_HEADER_TRANSACTION_ID_LEN);
+    pCurrentBufferPosition += STUN_HEADER_LEN;
+
+    // Only the transaction id of the header is used for the XOR
+    MEMCPY(stunHeader.transactionId, transactionId, STUN_HEADER_TRANSACTION_ID_LEN);
+    CHK_STATUS(stunPackageIpAddr(&stunHeader, STUN_ATTRIBUTE_TYPE_XOR_MAPPED_ADDRESS, pMappedAddress, pCurrentBufferPosition, &encodedLen));
+    pCurrentBufferPosition += encodedLen;
+
+    PACKAGE_STUN_ATTR_HEADER(pCurrentBufferPosition, iceControlType, STUN_ATTRIBUTE_ICE_CONTROL_LEN);
+    putInt64(&data64, (INT64) tieBreaker);
+    MEMCPY(pCurrentBufferPosition + STUN_ATTRIBUTE_HEADER_LEN, &data64, SIZEOF(INT64));
+    pCurrentBufferPosition += STUN_ATTRIBUTE_HEADER_LEN + STUN_ATTRIBUTE_ICE_CONTROL_LEN;
+
+    PACKAGE_STUN_ATTR_HEADER(pCurrentBufferPosition, STUN_ATTRIBUTE_TYPE_MESSAGE_INTEGRITY, STUN_HMAC_VALUE_LEN);
+    size = (UINT16) (pCurrentBufferPosition + STUN_ATTRIBUTE_HEADER_LEN + STUN_HMAC_VALUE_LEN - pBuffer - STUN_HEADER_LEN);
+    putInt16((PINT16) (pBuffer + STUN_HEADER_TYPE_LEN), size);
+    CHK_STATUS(
+        kvsSha1HmacKeyCompute(pHmacKey, pBuffer, (UINT32) (pCurrentBufferPosition - pBuffer), pCurrentBufferPosition + STUN_ATTRIBUTE_HEADER_LEN));
+    pCurrentBufferPosition += STUN_ATTRIBUTE_HEADER_LEN + STUN_HMAC_VALUE_LEN;
+
+    PACKAGE_STUN_ATTR_HEADER(pCurrentBufferPosition, STUN_ATTRIBUTE_TYPE_FINGERPRINT, STUN_ATTRIBUTE_FINGERPRINT_LEN);
+    putInt16((PINT16) (pBuffer + STUN_HEADER_TYPE_LEN), (UINT16) (packetSize - STUN_HEADER_LEN));
+    crc32 = stunCrc32(pBuffer, (UINT32) (pCurrentBufferPosition - pBuffer)) ^ STUN_FINGERPRINT_ATTRIBUTE_XOR_VALUE;
+    putInt32((PINT32) (pCurrentBufferPosition + STUN_ATTRIBUTE_HEADER_LEN), crc32);
+
+    *pSize = packetSize;
+
+CleanUp:
+
+    LEAVES();
+    return retStatus;
+}
+
 STATUS serializeStunPacket(PStunPacket pStunPacket, PBYTE password, UINT32 passwordLen, BOOL generateMessageIntegrity, BOOL generateFingerprint,
                            PBYTE pBuffer, PUINT32 pSize)
+{
+    return serializeStunPacketInternal(pStunPacket, password, passwordLen, NULL, generateMessageIntegrity, generateFingerprint, pBuffer, pSize);
+}
+
+STATUS serializeStunPacketWithHmacKey(PStunPacket pStunPacket, PKvsSha1HmacKey pHmacKey, BOOL generateMessageIntegrity, BOOL generateFingerprint,
+                                      PBYTE pBuffer, PUINT32 pSize)
+{
+    return serializeStunPacketInternal(pStunPacket, NULL, 0, pHmacKey, generateMessageIntegrity, generateFingerprint, pBuffer, pSize);
+}
+
+STATUS serializeStunPacketInternal(PStunPacket pStunPacket, PBYTE password, UINT32 passwordLen, PKvsSha1HmacKey pHmacKey,
+                                   BOOL generateMessageIntegrity, BOOL generateFingerprint, PBYTE pBuffer, PUINT32 pSize)
 {
     ENTERS();
     STATUS retStatus = STATUS_SUCCESS;
@@ -91,7 +168,7 @@ STATUS serializeStunPacket(PStunPacket pStunPacket, PBYTE password, UINT32 passw
     BOOL fingerprintFound = FALSE, messaageIntegrityFound = FALSE;
     INT64 data64;
 
-    CHK(pStunPacket != NULL && (!generateMessageIntegrity || password != NULL) && pSize != NULL, STATUS_NULL_ARG);
+    CHK(pStunPacket != NULL && (!generateMessageIntegrity || password != NULL || pHmacKey != NULL) && pSize != NULL, STATUS_NULL_ARG);
     CHK(password == NULL || passwordLen != 0, STATUS_INVALID_ARG);
     CHK(pStunPacket->header.magicCookie == STUN_HEADER_MAGIC_COOKIE, STATUS_STUN_MAGIC_COOKIE_MISMATCH);
 
@@ -450,7 +527,11 @@ STATUS serializeStunPacket(PStunPacket pStunPacket, PBYTE password, UINT32 passw
 
             // Calculate the HMAC for the integrity of the packet including STUN header and excluding the integrity attribute
             size = (UINT16) (pCurrentBufferPosition - pBuffer);
-            KVS_SHA1_HMAC(password, (INT32) passwordLen, pBuffer, size, pCurrentBufferPosition + STUN_ATTRIBUTE_HEADER_LEN, &hmacLen);
+            if (pHmacKey != NULL) {
+                CHK_STATUS(kvsSha1HmacKeyCompute(pHmacKey, pBuffer, size, pCurrentBufferPosition + STUN_ATTRIBUTE_HEADER_LEN));
+            } else {
+                KVS_SHA1_HMAC(password, (INT32) passwordLen, pBuffer, size, pCurrentBufferPosition + STUN_ATTRIBUTE_HEADER_LEN, &hmacLen);
+            }
 
             // Advance the current position
             pCurrentBufferPosition += encodedLen;
@@ -479,7 +560,7 @@ STATUS serializeStunPacket(PStunPacket pStunPacket, PBYTE password, UINT32 passw
             // Calculate the fingerprint including STUN header and excluding the fingerprint attribute
             size = (UINT16) (pCurrentBufferPosition - pBuffer);
 
-            crc32 = COMPUTE_CRC32(pBuffer, (UINT32) size) ^ STUN_FINGERPRINT_ATTRIBUTE_XOR_VALUE;
+            crc32 = stunCrc32(pBuffer, (UINT32) size) ^ STUN_FINGERPRINT_ATTRIBUTE_XOR_VALUE;
 
             // Write out the CRC value
             putInt32((PINT32) (pCurrentBufferPosition + STUN_ATTRIBUTE_HEADER_LEN), crc32);
@@ -515,6 +596,18 @@ CleanUp:
 }
 
 STATUS deserializeStunPacket(PBYTE pStunBuffer, UINT32 bufferSize, PBYTE password, UINT32 passwordLen, PStunPacket* ppStunPacket)
+{
+    return deserializeStunPacketInternal(pStunBuffer, bufferSize, password, passwordLen, NULL, NULL, 0, ppStunPacket);
+}
+
+STATUS deserializeStunPacketWithHmacKey(PBYTE pStunBuffer, UINT32 bufferSize, PKvsSha1HmacKey pHmacKey, PStunPacket pStorage, UINT32 storageSize,
+                                        PStunPacket* ppStunPacket)
+{
+    return deserializeStunPacketInternal(pStunBuffer, bufferSize, NULL, 0, pHmacKey, pStorage, storageSize, ppStunPacket);
+}
+
+STATUS deserializeStunPacketInternal(PBYTE pStunBuffer, UINT32 bufferSize, PBYTE password, UINT32 passwordLen, PKvsSha1HmacKey pHmacKey,
+                                     PStunPacket pStorage, UINT32 storageSize, PStunPacket* ppStunPacket)
 {
     ENTERS();
     STATUS retStatus = STATUS_SUCCESS;
@@ -745,8 +838,13 @@ STATUS deserializeStunPacket(PBYTE pStunBuffer, UINT32 bufferSize, PBYTE passwor
     // Account for the attribute pointer array
     allocationSize += attributeCount * SIZEOF(PStunAttributeHeader);
 
-    // Allocate the necessary storage and set the pointers for the attributes
-    CHK(NULL != (pStunPacket = MEMCALLOC(1, allocationSize)), STATUS_NOT_ENOUGH_MEMORY);
+    // Use the caller's storage when the packet fits, allocate otherwise
+    if (pStorage != NULL && allocationSize <= storageSize) {
+        pStunPacket = pStorage;
+        MEMSET(pStunPacket, 0x00, allocationSize);
+    } else {
+        CHK(NULL != (pStunPacket = MEMCALLOC(1, allocationSize)), STATUS_NOT_ENOUGH_MEMORY);
+    }
 
     // Copy/swap the header
     pStunPacket->header.stunMessageType = (UINT16) getInt16(pStunHeader->stunMessageType);
@@ -977,8 +1075,8 @@ STATUS deserializeStunPacket(PBYTE pStunBuffer, UINT32 bufferSize, PBYTE passwor
                 break;
 
             case STUN_ATTRIBUTE_TYPE_MESSAGE_INTEGRITY:
-                CHK(password != NULL, STATUS_NULL_ARG);
-                CHK(passwordLen != 0, STATUS_INVALID_ARG);
+                CHK(password != NULL || pHmacKey != NULL, STATUS_NULL_ARG);
+                CHK(pHmacKey != NULL || passwordLen != 0, STATUS_INVALID_ARG);
 
                 pStunAttributeMessageIntegrity = (PStunAttributeMessageIntegrity) pDestAttribute;
 
@@ -995,7 +1093,11 @@ STATUS deserializeStunPacket(PBYTE pStunBuffer, UINT32 bufferSize, PBYTE passwor
 
                 // Calculate the HMAC for the integrity of the packet including STUN header and excluding the integrity attribute
                 size = (UINT16) ((PBYTE) pStunAttributeHeader - pStunBuffer);
-                KVS_SHA1_HMAC(password, (INT32) passwordLen, pStunBuffer, size, pStunAttributeMessageIntegrity->messageIntegrity, &hmacLen);
+                if (pHmacKey != NULL) {
+                    CHK_STATUS(kvsSha1HmacKeyCompute(pHmacKey, pStunBuffer, size, pStunAttributeMessageIntegrity->messageIntegrity));
+                } else {
+                    KVS_SHA1_HMAC(password, (INT32) passwordLen, pStunBuffer, size, pStunAttributeMessageIntegrity->messageIntegrity, &hmacLen);
+                }
 
                 // Reset the original size in the buffer
                 putInt16((PINT16) (pStunBuffer + STUN_HEADER_TYPE_LEN), pStunPacket->header.messageLength);
@@ -1025,7 +1127,7 @@ STATUS deserializeStunPacket(PBYTE pStunBuffer, UINT32 bufferSize, PBYTE passwor
                 // Calculate the fingerprint
                 size = (UINT16) ((PBYTE) pStunAttributeHeader - pStunBuffer);
 
-                crc32 = COMPUTE_CRC32(pStunBuffer, (UINT32) size) ^ STUN_FINGERPRINT_ATTRIBUTE_XOR_VALUE;
+                crc32 = stunCrc32(pStunBuffer, (UINT32) size) ^ STUN_FINGERPRINT_ATTRIBUTE_XOR_VALUE;
 
                 // Reset the original size in the buffer
                 putInt16((PINT16) (pStunBuffer + STUN_HEADER_TYPE_LEN), pStunPacket->header.messageLength);
@@ -1050,7 +1152,11 @@ STATUS deserializeStunPacket(PBYTE pStunBuffer, UINT32 bufferSize, PBYTE passwor
 CleanUp:
 
     if (STATUS_FAILED(retStatus)) {
-        freeStunPacket(&pStunPacket);
+        if (pStunPacket == pStorage) {
+            pStunPacket = NULL;
+        } else {
+            freeStunPacket(&pStunPacket);
+        }
     }
 
     if (ppStunPacket != NULL) {
@@ -97,6 +97,13 @@ extern "C" {
  */
 #define STUN_PACKET_ALLOCATION_SIZE 2048
 
+/**
+ * Size of the binding success response with an IPv6 XOR mapped address, ICE control, message integrity and fingerprint
+ */
+#define STUN_BINDING_RESPONSE_MAX_LEN                                                                                                                \
+    (STUN_HEADER_LEN + STUN_ATTRIBUTE_HEADER_LEN + STUN_ATTRIBUTE_ADDRESS_HEADER_LEN + IPV6_ADDRESS_LENGTH + STUN_ATTRIBUTE_HEADER_LEN +            \
+     STUN_ATTRIBUTE_ICE_CONTROL_LEN + STUN_ATTRIBUTE_HEADER_LEN + STUN_HMAC_VALUE_LEN + STUN_ATTRIBUTE_HEADER_LEN + STUN_ATTRIBUTE_FINGERPRINT_LEN)
+
 #define STUN_SEND_INDICATION_OVERHEAD_SIZE                36
 #define STUN_SEND_INDICATION_APPLICATION_DATA_OFFSET      36
 #define STUN_SEND_INDICATION_APPLICATION_DATA_LEN_OFFSET  34
@@ -370,6 +377,26 @@ typedef struct {
 
 STATUS serializeStunPacket(PStunPacket, PBYTE, UINT32, BOOL, BOOL, PBYTE, PUINT32);
 STATUS deserializeStunPacket(PBYTE, UINT32, PBYTE, UINT32, PStunPacket*);
+
+/**
+ * Same as serializeStunPacket with the message integrity computed from a precomputed HMAC key of the password
+ */
+STATUS serializeStunPacketWithHmacKey(PStunPacket, PKvsSha1HmacKey, BOOL, BOOL, PBYTE, PUINT32);
+
+/**
+ * Same as deserializeStunPacket with the message integrity validated against a precomputed HMAC key of the password.
+ * The packet is decoded into the storage when it fits, in which case it must not be freed, and allocated otherwise.
+ *
+ * @param - PBYTE - IN - Packet
+ * @param - UINT32 - IN - Packet size
+ * @param - PKvsSha1HmacKey - IN - Optional HMAC key, required if the packet has message integrity
+ * @param - PStunPacket - IN - Optional storage for the decoded packet
+ * @param - UINT32 - IN - Storage size in bytes
+ * @param - PStunPacket* - OUT - Decoded packet, equals the storage unless it was allocated
+ *
+ * @return - STATUS code of the execution
+ */
+STATUS deserializeStunPacketWithHmacKey(PBYTE, UINT32, PKvsSha1HmacKey, PStunPacket, UINT32, PStunPacket*);
 STATUS freeStunPacket(PStunPacket*);
 STATUS createStunPacket(STUN_PACKET_TYPE, PBYTE, PStunPacket*);
 STATUS appendStunAddressAttribute(PStunPacket, STUN_ATTRIBUTE_TYPE, PKvsIpAddress);
@@ -401,7 +428,26 @@ STATUS xorIpAddress(PKvsIpAddress, PBYTE);
 //
 // Internal functions
 //
+STATUS serializeStunPacketInternal(PStunPacket, PBYTE, UINT32, PKvsSha1HmacKey, BOOL, BOOL, PBYTE, PUINT32);
+STATUS deserializeStunPacketInternal(PBYTE, UINT32, PBYTE, UINT32, PKvsSha1HmacKey, PStunPacket, UINT32, PStunPacket*);
 STATUS stunPackageIpAddr(PStunHeader, STUN_ATTRIBUTE_TYPE, PKvsIpAddress, PBYTE, PUINT32);
+
+/**
+ * Writes a binding success response with XOR mapped address, ICE control, message integrity and fingerprint straight
+ * into the buffer, without building a StunPacket first
+ *
+ * @param - PBYTE - IN - Transaction id of the request
+ * @param - PKvsIpAddress - IN - Address the request came from
+ * @param - STUN_ATTRIBUTE_TYPE - IN - STUN_ATTRIBUTE_TYPE_ICE_CONTROLLING or STUN_ATTRIBUTE_TYPE_ICE_CONTROLLED
+ * @param - UINT64 - IN - Tie breaker
+ * @param - PKvsSha1HmacKey - IN - HMAC key of the local password
+ * @param - PBYTE - OUT - Buffer
+ * @param - PUINT32 - IN/OUT - Buffer size in, packet size out
+ *
+ * @return - STATUS code of the execution
+ */
+STATUS stunPackageBindingResponse(PBYTE, PKvsIpAddress, STUN_ATTRIBUTE_TYPE, UINT64, PKvsSha1HmacKey, PBYTE, PUINT32);
+
 UINT16 getPackagedStunAttributeSize(PStunAttributeHeader);
 STATUS getFirstAvailableStunAttribute(PStunPacket, PStunAttributeHeader*);
 
@@ -0,0 +1,44 @@
+/*******************************************
+STUN fingerprint crc32 include file
+*******************************************/
+#ifndef __KINESIS_VIDEO_WEBRTC_CLIENT_STUN_CRC32_H
+#define __KINESIS_VIDEO_WEBRTC_CLIENT_STUN_CRC32_H
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Carry-less multiply and crc instruction versions built for the target, the best one the CPU supports is picked at runtime
+#if defined(__x86_64__) || defined(_M_X64) || (defined(__i386__) && defined(__SSE2__))
+#if defined(__GNUC__) || defined(__clang__)
+#define KVS_STUN_CRC32_PCLMUL_SUPPORTED
+#endif
+#elif defined(__aarch64__) && !defined(__AARCH64EB__)
+#if defined(__GNUC__) || defined(__clang__)
+#define KVS_STUN_CRC32_ARMV8_SUPPORTED
+#endif
+#endif
+
+/*
+ * All implementations return the ISO-HDLC crc32 of the buffer (the one zlib and COMPUTE_CRC32 compute), which is what
+ * the STUN FINGERPRINT attribute is based on per rfc5389 section 15.5.
+ */
+typedef UINT32 (*StunCrc32Func)(PBYTE, UINT32);
+
+UINT32 stunCrc32(PBYTE, UINT32);
+UINT32 stunCrc32SliceBy8(PBYTE, UINT32);
+#ifdef KVS_STUN_CRC32_PCLMUL_SUPPORTED
+BOOL stunCrc32PclmulAvailable(VOID);
+UINT32 stunCrc32Pclmul(PBYTE, UINT32);
+#endif
+#ifdef KVS_STUN_CRC32_ARMV8_SUPPORTED
+BOOL stunCrc32Armv8Available(VOID);
+UINT32 stunCrc32Armv8(PBYTE, UINT32);
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+#endif //__KINESIS_VIDEO_WEBRTC_CLIENT_STUN_CRC32_H
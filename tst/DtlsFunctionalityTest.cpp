@@ -8,7 +8,8 @@ namespace webrtcclient {
 
 class DtlsFunctionalityTest : public WebRtcClientTestBase {
   public:
-    STATUS createAndConnect(TIMER_QUEUE_HANDLE timerQueueHandle, PDtlsSession* ppClient, PDtlsSession* ppServer, BOOL useThread)
+    STATUS createAndConnect(TIMER_QUEUE_HANDLE timerQueueHandle, PDtlsSession* ppClient, PDtlsSession* ppServer, BOOL useThread,
+                            PRtcCertificate pRtcCertificates = NULL)
     {
         struct Context {
             std::mutex mtx;
@@ -63,8 +64,8 @@ class DtlsFunctionalityTest : public WebRtcClientTestBase {
             return retStatus;
         };
 
-        CHK_STATUS(createDtlsSession(&callbacks, timerQueueHandle, 0, FALSE, NULL, &pServer));
-        CHK_STATUS(createDtlsSession(&callbacks, timerQueueHandle, 0, FALSE, NULL, &pClient));
+        CHK_STATUS(createDtlsSession(&callbacks, timerQueueHandle, 0, FALSE, pRtcCertificates, &pServer));
+        CHK_STATUS(createDtlsSession(&callbacks, timerQueueHandle, 0, FALSE, pRtcCertificates, &pClient));
 
         CHK_STATUS(dtlsSessionOnOutBoundData(pServer, (UINT64) &clientCtx, outboundPacketFn));
         CHK_STATUS(dtlsSessionOnOutBoundData(pClient, (UINT64) &serverCtx, outboundPacketFn));
@@ -248,6 +249,149 @@ TEST_F(DtlsFunctionalityTest, processPacketWithVariedSizesInThread)
     MEMFREE(pData);
 }
 
+TEST_F(DtlsFunctionalityTest, certificatePoolHandsOutGeneratedCertificates)
+{
+    PDtlsCertificatePool pPool = getDtlsCertificatePoolInstance();
+    PDtlsCertificatePoolEntry pFirstEntry = NULL, pSecondEntry = NULL;
+    RtcCertificate certificates[MAX_RTCCONFIGURATION_CERTIFICATES];
+    DtlsSessionCallbacks callbacks;
+    PDtlsSession pSession = NULL;
+    TIMER_QUEUE_HANDLE timerQueueHandle = INVALID_TIMER_QUEUE_HANDLE_VALUE;
+    CHAR fingerprint[CERTIFICATE_FINGERPRINT_LENGTH + 1];
+    UINT64 hitCount, missCount, startHitCount, startMissCount;
+    UINT32 i, readyCount = 0;
+
+    MEMSET(&callbacks, 0x00, SIZEOF(callbacks));
+    MEMSET(certificates, 0x00, SIZEOF(certificates));
+    EXPECT_EQ(STATUS_NULL_ARG, dtlsCertificatePoolAcquire(0, FALSE, NULL, &pFirstEntry));
+    EXPECT_EQ(STATUS_NULL_ARG, dtlsCertificatePoolGetHitCounts(&hitCount, NULL));
+    EXPECT_EQ(STATUS_SUCCESS, dtlsCertificatePoolRelease(&pFirstEntry));
+    EXPECT_EQ(STATUS_SUCCESS, dtlsCertificatePoolGetHitCounts(&startHitCount, &startMissCount));
+
+    // nothing is generated ahead of time until a certificate type is asked for
+    EXPECT_EQ(STATUS_SUCCESS, dtlsCertificatePoolAcquire(0, FALSE, &certificates[0], &pFirstEntry));
+    ASSERT_TRUE(pFirstEntry != NULL);
+    EXPECT_TRUE(certificates[0].pCertificate != NULL);
+    EXPECT_TRUE(certificates[0].pPrivateKey != NULL);
+    EXPECT_EQ(STATUS_SUCCESS, dtlsCertificatePoolGetHitCounts(&hitCount, &missCount));
+    EXPECT_EQ(startHitCount, hitCount);
+    EXPECT_EQ(startMissCount + 1, missCount);
+
+    // a pooled certificate is used like an application provided one
+    EXPECT_EQ(STATUS_SUCCESS, timerQueueCreate(&timerQueueHandle));
+    EXPECT_EQ(STATUS_SUCCESS, createDtlsSession(&callbacks, timerQueueHandle, 0, FALSE, certificates, &pSession));
+    EXPECT_EQ(STATUS_SUCCESS, dtlsCertificatePoolRelease(&pFirstEntry));
+    EXPECT_TRUE(pFirstEntry == NULL);
+    EXPECT_EQ(STATUS_SUCCESS, dtlsSessionGetLocalCertificateFingerprint(pSession, fingerprint, SIZEOF(fingerprint)));
+    EXPECT_NE(0, STRLEN(fingerprint));
+    freeDtlsSession(&pSession);
+    timerQueueFree(&timerQueueHandle);
+
+    for (i = 0; i < 100 && readyCount < DTLS_CERTIFICATE_POOL_READY_COUNT; i++) {
+        THREAD_SLEEP(100 * HUNDREDS_OF_NANOS_IN_A_MILLISECOND);
+        MUTEX_LOCK(pPool->lock);
+        EXPECT_EQ(STATUS_SUCCESS, doubleListGetNodeCount(pPool->entries, &readyCount));
+        MUTEX_UNLOCK(pPool->lock);
+    }
+    EXPECT_EQ(DTLS_CERTIFICATE_POOL_READY_COUNT, readyCount);
+
+    EXPECT_EQ(STATUS_SUCCESS, dtlsCertificatePoolAcquire(0, FALSE, &certificates[0], &pFirstEntry));
+    EXPECT_EQ(STATUS_SUCCESS, dtlsCertificatePoolAcquire(GENERATED_CERTIFICATE_BITS, FALSE, &certificates[1], &pSecondEntry));
+    ASSERT_TRUE(pFirstEntry != NULL && pSecondEntry != NULL);
+    // every session still gets its own certificate
+    EXPECT_NE(pFirstEntry, pSecondEntry);
+    EXPECT_NE(certificates[0].pCertificate, certificates[1].pCertificate);
+    EXPECT_EQ(STATUS_SUCCESS, dtlsCertificatePoolGetHitCounts(&hitCount, &missCount));
+    EXPECT_EQ(startHitCount + 2, hitCount);
+    EXPECT_EQ(startMissCount + 1, missCount);
+
+    EXPECT_EQ(STATUS_SUCCESS, dtlsCertificatePoolRelease(&pFirstEntry));
+    EXPECT_EQ(STATUS_SUCCESS, dtlsCertificatePoolRelease(&pSecondEntry));
+}
+
+TEST_F(DtlsFunctionalityTest, sessionsWithSameCertificatesShareContext)
+{
+    PDtlsContextCache pCache = getDtlsContextCacheInstance();
+    PDtlsSession pClient = NULL, pServer = NULL, pOther = NULL;
+    TIMER_QUEUE_HANDLE timerQueueHandle = INVALID_TIMER_QUEUE_HANDLE_VALUE;
+    PRtcCertificate pRtcCertificate = NULL;
+    RtcCertificate certificates[MAX_RTCCONFIGURATION_CERTIFICATES];
+    DtlsSessionCallbacks callbacks;
+    CHAR clientFingerprint[CERTIFICATE_FINGERPRINT_LENGTH + 1], otherFingerprint[CERTIFICATE_FINGERPRINT_LENGTH + 1];
+    UINT32 entryCount = 0;
+
+    MEMSET(&callbacks, 0x00, SIZEOF(callbacks));
+    MEMSET(certificates, 0x00, SIZEOF(certificates));
+    EXPECT_EQ(STATUS_SUCCESS, createRtcCertificate(&pRtcCertificate));
+    certificates[0] = *pRtcCertificate;
+
+    // both ends of the handshake use the same context
+    EXPECT_EQ(STATUS_SUCCESS, timerQueueCreate(&timerQueueHandle));
+    EXPECT_EQ(STATUS_SUCCESS, createAndConnect(timerQueueHandle, &pClient, &pServer, FALSE, certificates));
+    ASSERT_TRUE(pClient != NULL && pServer != NULL);
+    ASSERT_TRUE(pClient->pContextCacheEntry != NULL);
+    EXPECT_EQ(pClient->pContextCacheEntry, pServer->pContextCacheEntry);
+    EXPECT_EQ(2, pClient->pContextCacheEntry->refCount);
+
+    // sessions without certificates keep their own context
+    EXPECT_EQ(STATUS_SUCCESS, createDtlsSession(&callbacks, timerQueueHandle, 0, FALSE, NULL, &pOther));
+    EXPECT_TRUE(pOther->pContextCacheEntry == NULL);
+    freeDtlsSession(&pOther);
+
+    EXPECT_EQ(STATUS_SUCCESS, createDtlsSession(&callbacks, timerQueueHandle, 0, FALSE, certificates, &pOther));
+    EXPECT_EQ(pClient->pContextCacheEntry, pOther->pContextCacheEntry);
+    EXPECT_EQ(STATUS_SUCCESS, dtlsSessionGetLocalCertificateFingerprint(pClient, clientFingerprint, SIZEOF(clientFingerprint)));
+    EXPECT_EQ(STATUS_SUCCESS, dtlsSessionGetLocalCertificateFingerprint(pOther, otherFingerprint, SIZEOF(otherFingerprint)));
+    EXPECT_EQ(0, STRNCMP(clientFingerprint, otherFingerprint, CERTIFICATE_FINGERPRINT_LENGTH));
+
+    freeDtlsSession(&pClient);
+    freeDtlsSession(&pServer);
+    EXPECT_EQ(STATUS_SUCCESS, doubleListGetNodeCount(pCache->entries, &entryCount));
+    EXPECT_EQ(1, entryCount);
+
+    // the last session frees the context
+    freeDtlsSession(&pOther);
+    EXPECT_EQ(STATUS_SUCCESS, doubleListGetNodeCount(pCache->entries, &entryCount));
+    EXPECT_EQ(0, entryCount);
+
+    timerQueueFree(&timerQueueHandle);
+    EXPECT_EQ(STATUS_SUCCESS, freeRtcCertificate(pRtcCertificate));
+}
+
+TEST_F(DtlsFunctionalityTest, keyingMaterialFollowsNegotiatedSrtpProfile)
+{
+    PDtlsSession pClient = NULL, pServer = NULL;
+    TIMER_QUEUE_HANDLE timerQueueHandle = INVALID_TIMER_QUEUE_HANDLE_VALUE;
+    DtlsKeyingMaterial clientKeyingMaterial, serverKeyingMaterial;
+
+    MEMSET(&clientKeyingMaterial, 0x00, SIZEOF(clientKeyingMaterial));
+    MEMSET(&serverKeyingMaterial, 0x00, SIZEOF(serverKeyingMaterial));
+
+    EXPECT_EQ(STATUS_SUCCESS, timerQueueCreate(&timerQueueHandle));
+    EXPECT_EQ(STATUS_SUCCESS, createAndConnect(timerQueueHandle, &pClient, &pServer, FALSE));
+    ASSERT_TRUE(pClient != NULL && pServer != NULL);
+
+    EXPECT_EQ(STATUS_SUCCESS, dtlsSessionPopulateKeyingMaterial(pClient, &clientKeyingMaterial));
+    EXPECT_EQ(STATUS_SUCCESS, dtlsSessionPopulateKeyingMaterial(pServer, &serverKeyingMaterial));
+
+#ifdef KVS_USE_OPENSSL
+    // both ends offer the AEAD profiles first
+    EXPECT_EQ(KVS_SRTP_PROFILE_AEAD_AES_128_GCM, clientKeyingMaterial.srtpProfile);
+    EXPECT_EQ(16 + 12, clientKeyingMaterial.key_length);
+#else
+    EXPECT_EQ(KVS_SRTP_PROFILE_AES128_CM_HMAC_SHA1_80, clientKeyingMaterial.srtpProfile);
+    EXPECT_EQ(16 + 14, clientKeyingMaterial.key_length);
+#endif
+    EXPECT_EQ(clientKeyingMaterial.srtpProfile, serverKeyingMaterial.srtpProfile);
+    EXPECT_EQ(clientKeyingMaterial.key_length, serverKeyingMaterial.key_length);
+    EXPECT_EQ(0, MEMCMP(clientKeyingMaterial.clientWriteKey, serverKeyingMaterial.clientWriteKey, clientKeyingMaterial.key_length));
+    EXPECT_EQ(0, MEMCMP(clientKeyingMaterial.serverWriteKey, serverKeyingMaterial.serverWriteKey, clientKeyingMaterial.key_length));
+    EXPECT_NE(0, MEMCMP(clientKeyingMaterial.clientWriteKey, clientKeyingMaterial.serverWriteKey, clientKeyingMaterial.key_length));
+
+    freeDtlsSession(&pClient);
+    freeDtlsSession(&pServer);
+    timerQueueFree(&timerQueueHandle);
+}
 
 } // namespace webrtcclient
 } // namespace video
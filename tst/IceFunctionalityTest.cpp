@@ -339,6 +339,7 @@ TEST_F(IceFunctionalityTest, IceAgentAddRemoteCandidateUnitTest)
     EXPECT_EQ(STATUS_SUCCESS, doubleListCreate(&iceAgent.remoteCandidates));
     EXPECT_EQ(STATUS_SUCCESS, doubleListCreate(&iceAgent.localCandidates));
     EXPECT_EQ(STATUS_SUCCESS, doubleListCreate(&iceAgent.iceCandidatePairs));
+    EXPECT_EQ(STATUS_SUCCESS, hashTableCreate(&iceAgent.iceCandidatePairIndex));
     iceAgent.iceAgentState = ICE_CANDIDATE_STATE_NEW;
 
     // invalid input
@@ -401,6 +402,7 @@ TEST_F(IceFunctionalityTest, IceAgentAddRemoteCandidateUnitTest)
     }
     EXPECT_EQ(STATUS_SUCCESS, doubleListClear(iceAgent.iceCandidatePairs, FALSE));
     EXPECT_EQ(STATUS_SUCCESS, doubleListFree(iceAgent.iceCandidatePairs));
+    EXPECT_EQ(STATUS_SUCCESS, hashTableFree(iceAgent.iceCandidatePairIndex));
     EXPECT_EQ(STATUS_SUCCESS, doubleListClear(iceAgent.remoteCandidates, TRUE));
     EXPECT_EQ(STATUS_SUCCESS, doubleListFree(iceAgent.remoteCandidates));
     EXPECT_EQ(STATUS_SUCCESS, doubleListClear(iceAgent.localCandidates, FALSE));
@@ -517,6 +519,7 @@ TEST_F(IceFunctionalityTest, IceAgentCreateIceCandidatePairsUnitTest)
     EXPECT_EQ(STATUS_SUCCESS, doubleListCreate(&iceAgent.localCandidates));
     EXPECT_EQ(STATUS_SUCCESS, doubleListCreate(&iceAgent.remoteCandidates));
     EXPECT_EQ(STATUS_SUCCESS, doubleListCreate(&iceAgent.iceCandidatePairs));
+    EXPECT_EQ(STATUS_SUCCESS, hashTableCreate(&iceAgent.iceCandidatePairIndex));
 
     EXPECT_NE(STATUS_SUCCESS, createIceCandidatePairs(NULL, NULL, FALSE));
     EXPECT_NE(STATUS_SUCCESS, createIceCandidatePairs(&iceAgent, NULL, FALSE));
@@ -592,6 +595,7 @@ TEST_F(IceFunctionalityTest, IceAgentCreateIceCandidatePairsUnitTest)
     }
     EXPECT_EQ(STATUS_SUCCESS, doubleListClear(iceAgent.iceCandidatePairs, FALSE));
     EXPECT_EQ(STATUS_SUCCESS, doubleListFree(iceAgent.iceCandidatePairs));
+    EXPECT_EQ(STATUS_SUCCESS, hashTableFree(iceAgent.iceCandidatePairIndex));
 }
 
 TEST_F(IceFunctionalityTest, IceAgentPruneUnconnectedIceCandidatePairUnitTest)
@@ -604,6 +608,7 @@ TEST_F(IceFunctionalityTest, IceAgentPruneUnconnectedIceCandidatePairUnitTest)
 
     MEMSET(&iceAgent, 0x00, SIZEOF(IceAgent));
     doubleListCreate(&iceAgent.iceCandidatePairs);
+    hashTableCreate(&iceAgent.iceCandidatePairIndex);
 
     EXPECT_NE(STATUS_SUCCESS, pruneUnconnectedIceCandidatePair(NULL));
     // candidate pair count can be 0
@@ -635,6 +640,539 @@ TEST_F(IceFunctionalityTest, IceAgentPruneUnconnectedIceCandidatePairUnitTest)
     }
     EXPECT_EQ(STATUS_SUCCESS, doubleListClear(iceAgent.iceCandidatePairs, FALSE));
     EXPECT_EQ(STATUS_SUCCESS, doubleListFree(iceAgent.iceCandidatePairs));
+    EXPECT_EQ(STATUS_SUCCESS, hashTableFree(iceAgent.iceCandidatePairIndex));
+}
+
+TEST_F(IceFunctionalityTest, IceAgentFindIceCandidatePairUnitTest)
+{
+    IceAgent iceAgent;
+    IceCandidate hostCandidate, srflxCandidate, otherHostCandidate, remoteCandidates[3];
+    PIceCandidatePair pIceCandidatePair = NULL, pHostPair = NULL, pSrflxPair = NULL;
+    PDoubleListNode pCurNode = NULL;
+    KvsIpAddress remoteAddress;
+    UINT32 i, count = 0;
+    PSocketConnection pSocketConnection = (PSocketConnection) &hostCandidate, pOtherSocketConnection = (PSocketConnection) &otherHostCandidate;
+
+    MEMSET(&iceAgent, 0x00, SIZEOF(IceAgent));
+    MEMSET(&hostCandidate, 0x00, SIZEOF(IceCandidate));
+    MEMSET(&srflxCandidate, 0x00, SIZEOF(IceCandidate));
+    MEMSET(&otherHostCandidate, 0x00, SIZEOF(IceCandidate));
+    MEMSET(remoteCandidates, 0x00, SIZEOF(remoteCandidates));
+    EXPECT_EQ(STATUS_SUCCESS, doubleListCreate(&iceAgent.localCandidates));
+    EXPECT_EQ(STATUS_SUCCESS, doubleListCreate(&iceAgent.remoteCandidates));
+    EXPECT_EQ(STATUS_SUCCESS, doubleListCreate(&iceAgent.iceCandidatePairs));
+    EXPECT_EQ(STATUS_SUCCESS, hashTableCreate(&iceAgent.iceCandidatePairIndex));
+
+    // host and server reflexive candidates share the host socket
+    hostCandidate.iceCandidateType = ICE_CANDIDATE_TYPE_HOST;
+    srflxCandidate.iceCandidateType = ICE_CANDIDATE_TYPE_SERVER_REFLEXIVE;
+    otherHostCandidate.iceCandidateType = ICE_CANDIDATE_TYPE_HOST;
+    hostCandidate.pSocketConnection = pSocketConnection;
+    srflxCandidate.pSocketConnection = pSocketConnection;
+    otherHostCandidate.pSocketConnection = pOtherSocketConnection;
+    for (auto pLocalCandidate : {&hostCandidate, &srflxCandidate, &otherHostCandidate}) {
+        pLocalCandidate->state = ICE_CANDIDATE_STATE_VALID;
+        pLocalCandidate->ipAddress.family = KVS_IP_FAMILY_TYPE_IPV4;
+        pLocalCandidate->priority = computeCandidatePriority(pLocalCandidate);
+        EXPECT_EQ(STATUS_SUCCESS, doubleListInsertItemTail(iceAgent.localCandidates, (UINT64) pLocalCandidate));
+    }
+
+    for (i = 0; i < ARRAY_SIZE(remoteCandidates); i++) {
+        remoteCandidates[i].state = ICE_CANDIDATE_STATE_VALID;
+        remoteCandidates[i].iceCandidateType = ICE_CANDIDATE_TYPE_HOST;
+        remoteCandidates[i].ipAddress.family = KVS_IP_FAMILY_TYPE_IPV4;
+        remoteCandidates[i].ipAddress.address[0] = 10;
+        remoteCandidates[i].ipAddress.address[3] = (BYTE) (i / 2 + 1);
+        // first two candidates only differ by port
+        remoteCandidates[i].ipAddress.port = (UINT16) getInt16(5000 + i);
+        remoteCandidates[i].priority = computeCandidatePriority(&remoteCandidates[i]);
+        EXPECT_EQ(STATUS_SUCCESS, doubleListInsertItemTail(iceAgent.remoteCandidates, (UINT64) &remoteCandidates[i]));
+        EXPECT_EQ(STATUS_SUCCESS, createIceCandidatePairs(&iceAgent, &remoteCandidates[i], TRUE));
+    }
+
+    EXPECT_EQ(STATUS_SUCCESS, doubleListGetNodeCount(iceAgent.iceCandidatePairs, &count));
+    EXPECT_EQ(9, count);
+    EXPECT_EQ(STATUS_SUCCESS, hashTableGetCount(iceAgent.iceCandidatePairIndex, &count));
+    EXPECT_EQ(6, count);
+
+    remoteAddress = remoteCandidates[0].ipAddress;
+    EXPECT_NE(STATUS_SUCCESS,
+              findIceCandidatePairWithLocalSocketConnectionAndRemoteAddr(NULL, pSocketConnection, &remoteAddress, TRUE, &pIceCandidatePair));
+    EXPECT_NE(STATUS_SUCCESS, findIceCandidatePairWithLocalSocketConnectionAndRemoteAddr(&iceAgent, NULL, &remoteAddress, TRUE, &pIceCandidatePair));
+
+    // the highest priority pair of the socket is the one of the host candidate
+    for (i = 0; i < ARRAY_SIZE(remoteCandidates); i++) {
+        EXPECT_EQ(STATUS_SUCCESS,
+                  findIceCandidatePairWithLocalSocketConnectionAndRemoteAddr(&iceAgent, pSocketConnection, &remoteCandidates[i].ipAddress, TRUE,
+                                                                             &pIceCandidatePair));
+        ASSERT_TRUE(pIceCandidatePair != NULL);
+        EXPECT_EQ(&hostCandidate, pIceCandidatePair->local);
+        EXPECT_EQ(&remoteCandidates[i], pIceCandidatePair->remote);
+
+        EXPECT_EQ(STATUS_SUCCESS,
+                  findIceCandidatePairWithLocalSocketConnectionAndRemoteAddr(&iceAgent, pOtherSocketConnection, &remoteCandidates[i].ipAddress,
+                                                                             TRUE, &pIceCandidatePair));
+        ASSERT_TRUE(pIceCandidatePair != NULL);
+        EXPECT_EQ(&otherHostCandidate, pIceCandidatePair->local);
+        EXPECT_EQ(&remoteCandidates[i], pIceCandidatePair->remote);
+    }
+
+    // unknown port
+    remoteAddress.port = (UINT16) getInt16(4000);
+    EXPECT_EQ(STATUS_SUCCESS,
+              findIceCandidatePairWithLocalSocketConnectionAndRemoteAddr(&iceAgent, pSocketConnection, &remoteAddress, TRUE, &pIceCandidatePair));
+    EXPECT_TRUE(pIceCandidatePair == NULL);
+    EXPECT_EQ(STATUS_SUCCESS,
+              findIceCandidatePairWithLocalSocketConnectionAndRemoteAddr(&iceAgent, pSocketConnection, &remoteAddress, FALSE, &pIceCandidatePair));
+    EXPECT_TRUE(pIceCandidatePair != NULL);
+
+    // failed pairs are skipped
+    EXPECT_EQ(STATUS_SUCCESS,
+              findIceCandidatePairWithLocalSocketConnectionAndRemoteAddr(&iceAgent, pSocketConnection, &remoteCandidates[1].ipAddress, TRUE,
+                                                                         &pHostPair));
+    pHostPair->state = ICE_CANDIDATE_PAIR_STATE_FAILED;
+    EXPECT_EQ(STATUS_SUCCESS,
+              findIceCandidatePairWithLocalSocketConnectionAndRemoteAddr(&iceAgent, pSocketConnection, &remoteCandidates[1].ipAddress, TRUE,
+                                                                         &pSrflxPair));
+    ASSERT_TRUE(pSrflxPair != NULL);
+    EXPECT_EQ(&srflxCandidate, pSrflxPair->local);
+    EXPECT_EQ(&remoteCandidates[1], pSrflxPair->remote);
+
+    // pruned pairs leave the index
+    pSrflxPair->state = ICE_CANDIDATE_PAIR_STATE_SUCCEEDED;
+    EXPECT_EQ(STATUS_SUCCESS, pruneUnconnectedIceCandidatePair(&iceAgent));
+    EXPECT_EQ(STATUS_SUCCESS, hashTableGetCount(iceAgent.iceCandidatePairIndex, &count));
+    EXPECT_EQ(1, count);
+    for (i = 0; i < ARRAY_SIZE(remoteCandidates); i++) {
+        EXPECT_EQ(STATUS_SUCCESS,
+                  findIceCandidatePairWithLocalSocketConnectionAndRemoteAddr(&iceAgent, pSocketConnection, &remoteCandidates[i].ipAddress, TRUE,
+                                                                             &pIceCandidatePair));
+        EXPECT_EQ(i == 1 ? pSrflxPair : NULL, pIceCandidatePair);
+        EXPECT_EQ(STATUS_SUCCESS,
+                  findIceCandidatePairWithLocalSocketConnectionAndRemoteAddr(&iceAgent, pOtherSocketConnection, &remoteCandidates[i].ipAddress,
+                                                                             TRUE, &pIceCandidatePair));
+        EXPECT_TRUE(pIceCandidatePair == NULL);
+    }
+
+    EXPECT_EQ(STATUS_SUCCESS, doubleListGetHeadNode(iceAgent.iceCandidatePairs, &pCurNode));
+    while (pCurNode != NULL) {
+        pIceCandidatePair = (PIceCandidatePair) pCurNode->data;
+        pCurNode = pCurNode->pNext;
+
+        EXPECT_EQ(STATUS_SUCCESS, unindexIceCandidatePair(iceAgent.iceCandidatePairIndex, pIceCandidatePair));
+        CHK_LOG_ERR(freeIceCandidatePair(&pIceCandidatePair));
+    }
+    EXPECT_EQ(STATUS_SUCCESS, hashTableGetCount(iceAgent.iceCandidatePairIndex, &count));
+    EXPECT_EQ(0, count);
+
+    EXPECT_EQ(STATUS_SUCCESS, doubleListClear(iceAgent.iceCandidatePairs, FALSE));
+    EXPECT_EQ(STATUS_SUCCESS, doubleListFree(iceAgent.iceCandidatePairs));
+    EXPECT_EQ(STATUS_SUCCESS, hashTableFree(iceAgent.iceCandidatePairIndex));
+    EXPECT_EQ(STATUS_SUCCESS, doubleListClear(iceAgent.localCandidates, FALSE));
+    EXPECT_EQ(STATUS_SUCCESS, doubleListFree(iceAgent.localCandidates));
+    EXPECT_EQ(STATUS_SUCCESS, doubleListClear(iceAgent.remoteCandidates, FALSE));
+    EXPECT_EQ(STATUS_SUCCESS, doubleListFree(iceAgent.remoteCandidates));
+}
+
+TEST_F(IceFunctionalityTest, IceAgentManyIceCandidatePairsUnitTest)
+{
+    IceAgent iceAgent;
+    IceCandidate localCandidates[8], remoteCandidates[64];
+    PIceCandidatePair pIceCandidatePair = NULL, pFoundIceCandidatePair = NULL;
+    PDoubleListNode pCurNode = NULL;
+    UINT32 i, count = 0;
+    ICE_CANDIDATE_TYPE remoteCandidateTypes[] = {ICE_CANDIDATE_TYPE_RELAYED, ICE_CANDIDATE_TYPE_HOST, ICE_CANDIDATE_TYPE_SERVER_REFLEXIVE,
+                                                 ICE_CANDIDATE_TYPE_PEER_REFLEXIVE};
+
+    MEMSET(&iceAgent, 0x00, SIZEOF(IceAgent));
+    MEMSET(localCandidates, 0x00, SIZEOF(localCandidates));
+    MEMSET(remoteCandidates, 0x00, SIZEOF(remoteCandidates));
+    EXPECT_EQ(STATUS_SUCCESS, doubleListCreate(&iceAgent.localCandidates));
+    EXPECT_EQ(STATUS_SUCCESS, doubleListCreate(&iceAgent.remoteCandidates));
+    EXPECT_EQ(STATUS_SUCCESS, doubleListCreate(&iceAgent.iceCandidatePairs));
+    EXPECT_EQ(STATUS_SUCCESS, hashTableCreate(&iceAgent.iceCandidatePairIndex));
+
+    // 4 host candidates, 2 server reflexive ones sharing the socket of the first two and 2 relayed ones
+    for (i = 0; i < ARRAY_SIZE(localCandidates); i++) {
+        localCandidates[i].state = ICE_CANDIDATE_STATE_VALID;
+        localCandidates[i].ipAddress.family = KVS_IP_FAMILY_TYPE_IPV4;
+        localCandidates[i].ipAddress.address[0] = 192;
+        localCandidates[i].ipAddress.address[3] = (BYTE) (i + 1);
+        if (i < 4) {
+            localCandidates[i].iceCandidateType = ICE_CANDIDATE_TYPE_HOST;
+            localCandidates[i].pSocketConnection = (PSocketConnection) &localCandidates[i];
+        } else if (i < 6) {
+            localCandidates[i].iceCandidateType = ICE_CANDIDATE_TYPE_SERVER_REFLEXIVE;
+            localCandidates[i].pSocketConnection = localCandidates[i - 4].pSocketConnection;
+        } else {
+            localCandidates[i].iceCandidateType = ICE_CANDIDATE_TYPE_RELAYED;
+            localCandidates[i].pSocketConnection = (PSocketConnection) &localCandidates[i];
+        }
+        localCandidates[i].priority = computeCandidatePriority(&localCandidates[i]);
+        EXPECT_EQ(STATUS_SUCCESS, doubleListInsertItemTail(iceAgent.localCandidates, (UINT64) &localCandidates[i]));
+    }
+
+    // trickled remote candidates of mixed types, so pairs get appended as well as inserted in the middle of the list
+    for (i = 0; i < ARRAY_SIZE(remoteCandidates); i++) {
+        remoteCandidates[i].state = ICE_CANDIDATE_STATE_VALID;
+        remoteCandidates[i].iceCandidateType = remoteCandidateTypes[i % ARRAY_SIZE(remoteCandidateTypes)];
+        remoteCandidates[i].ipAddress.family = KVS_IP_FAMILY_TYPE_IPV4;
+        remoteCandidates[i].ipAddress.address[0] = 10;
+        remoteCandidates[i].ipAddress.address[3] = (BYTE) (i + 1);
+        remoteCandidates[i].ipAddress.port = (UINT16) getInt16(5000 + i);
+        remoteCandidates[i].priority = computeCandidatePriority(&remoteCandidates[i]);
+        EXPECT_EQ(STATUS_SUCCESS, doubleListInsertItemTail(iceAgent.remoteCandidates, (UINT64) &remoteCandidates[i]));
+        EXPECT_EQ(STATUS_SUCCESS, createIceCandidatePairs(&iceAgent, &remoteCandidates[i], TRUE));
+        EXPECT_TRUE(candidatePairsInOrder(iceAgent.iceCandidatePairs));
+    }
+
+    EXPECT_EQ(STATUS_SUCCESS, doubleListGetNodeCount(iceAgent.iceCandidatePairs, &count));
+    EXPECT_EQ(ARRAY_SIZE(localCandidates) * ARRAY_SIZE(remoteCandidates), count);
+    // the server reflexive candidates share their keys with the host ones
+    EXPECT_EQ(STATUS_SUCCESS, hashTableGetCount(iceAgent.iceCandidatePairIndex, &count));
+    EXPECT_EQ(6 * ARRAY_SIZE(remoteCandidates), count);
+
+    // every pair is found through the index, host pairs ahead of the server reflexive ones of the same socket
+    EXPECT_EQ(STATUS_SUCCESS, doubleListGetHeadNode(iceAgent.iceCandidatePairs, &pCurNode));
+    while (pCurNode != NULL) {
+        pIceCandidatePair = (PIceCandidatePair) pCurNode->data;
+        pCurNode = pCurNode->pNext;
+
+        EXPECT_EQ(STATUS_SUCCESS,
+                  findIceCandidatePairWithLocalSocketConnectionAndRemoteAddr(&iceAgent, pIceCandidatePair->local->pSocketConnection,
+                                                                             &pIceCandidatePair->remote->ipAddress, TRUE, &pFoundIceCandidatePair));
+        ASSERT_TRUE(pFoundIceCandidatePair != NULL);
+        EXPECT_EQ(pIceCandidatePair->remote, pFoundIceCandidatePair->remote);
+        EXPECT_EQ(pIceCandidatePair->local->iceCandidateType == ICE_CANDIDATE_TYPE_SERVER_REFLEXIVE
+                      ? &localCandidates[pIceCandidatePair->local - localCandidates - 4]
+                      : pIceCandidatePair->local,
+                  pFoundIceCandidatePair->local);
+    }
+
+    EXPECT_EQ(STATUS_SUCCESS, doubleListGetHeadNode(iceAgent.iceCandidatePairs, &pCurNode));
+    while (pCurNode != NULL) {
+        pIceCandidatePair = (PIceCandidatePair) pCurNode->data;
+        pCurNode = pCurNode->pNext;
+
+        EXPECT_EQ(STATUS_SUCCESS, unindexIceCandidatePair(iceAgent.iceCandidatePairIndex, pIceCandidatePair));
+        CHK_LOG_ERR(freeIceCandidatePair(&pIceCandidatePair));
+    }
+
+    EXPECT_EQ(STATUS_SUCCESS, doubleListClear(iceAgent.iceCandidatePairs, FALSE));
+    EXPECT_EQ(STATUS_SUCCESS, doubleListFree(iceAgent.iceCandidatePairs));
+    EXPECT_EQ(STATUS_SUCCESS, hashTableFree(iceAgent.iceCandidatePairIndex));
+    EXPECT_EQ(STATUS_SUCCESS, doubleListClear(iceAgent.localCandidates, FALSE));
+    EXPECT_EQ(STATUS_SUCCESS, doubleListFree(iceAgent.localCandidates));
+    EXPECT_EQ(STATUS_SUCCESS, doubleListClear(iceAgent.remoteCandidates, FALSE));
+    EXPECT_EQ(STATUS_SUCCESS, doubleListFree(iceAgent.remoteCandidates));
+}
+
+TEST_F(IceFunctionalityTest, IceAgentDataSendingPathUnitTest)
+{
+    IceAgent iceAgent;
+    IceCandidate localCandidate, remoteCandidate;
+    IceCandidatePair iceCandidatePair;
+    RtcIceCandidatePairDiagnostics rtcIceCandidatePairDiagnostics;
+    PIceDataSendingPath pDataSendingPath = NULL;
+    UINT32 readerIndex = 0, lateReaderIndex = 0;
+
+    MEMSET(&iceAgent, 0x00, SIZEOF(IceAgent));
+    MEMSET(&localCandidate, 0x00, SIZEOF(IceCandidate));
+    MEMSET(&remoteCandidate, 0x00, SIZEOF(IceCandidate));
+    MEMSET(&iceCandidatePair, 0x00, SIZEOF(IceCandidatePair));
+    MEMSET(&rtcIceCandidatePairDiagnostics, 0x00, SIZEOF(RtcIceCandidatePairDiagnostics));
+
+    localCandidate.iceCandidateType = ICE_CANDIDATE_TYPE_HOST;
+    localCandidate.pSocketConnection = (PSocketConnection) &localCandidate;
+    remoteCandidate.ipAddress.family = KVS_IP_FAMILY_TYPE_IPV4;
+    remoteCandidate.ipAddress.port = (UINT16) getInt16(1234);
+    iceCandidatePair.local = &localCandidate;
+    iceCandidatePair.remote = &remoteCandidate;
+    iceCandidatePair.state = ICE_CANDIDATE_PAIR_STATE_SUCCEEDED;
+    iceCandidatePair.pRtcIceCandidatePairDiagnostics = &rtcIceCandidatePairDiagnostics;
+
+    EXPECT_NE(STATUS_SUCCESS, iceAgentPublishDataSendingPath(NULL));
+
+    // Nothing is published without a data sending pair
+    EXPECT_EQ(STATUS_SUCCESS, iceAgentPublishDataSendingPath(&iceAgent));
+    EXPECT_TRUE(iceAgentAcquireDataSendingPath(&iceAgent, &readerIndex) == NULL);
+    iceAgentReleaseDataSendingPath(&iceAgent, readerIndex);
+
+    iceAgent.pDataSendingIceCandidatePair = &iceCandidatePair;
+    EXPECT_EQ(STATUS_SUCCESS, iceAgentPublishDataSendingPath(&iceAgent));
+
+    pDataSendingPath = iceAgentAcquireDataSendingPath(&iceAgent, &readerIndex);
+    ASSERT_TRUE(pDataSendingPath != NULL);
+    EXPECT_EQ(&iceCandidatePair, pDataSendingPath->pIceCandidatePair);
+    EXPECT_EQ(localCandidate.pSocketConnection, pDataSendingPath->pSocketConnection);
+    EXPECT_EQ(1234, (UINT16) getInt16(pDataSendingPath->remoteAddress.port));
+    EXPECT_FALSE(pDataSendingPath->isRelay);
+    EXPECT_TRUE(pDataSendingPath->pTurnConnection == NULL);
+
+    EXPECT_TRUE(pDataSendingPath->succeeded);
+    ATOMIC_ADD(&pDataSendingPath->packetsSent, 2);
+    ATOMIC_ADD(&pDataSendingPath->bytesSent, 200);
+    ATOMIC_INCREMENT(&pDataSendingPath->packetsDiscardedOnSend);
+
+    // Replacing the path doesn't wait for the sender still holding it
+    iceAgent.pDataSendingIceCandidatePair = NULL;
+    EXPECT_EQ(STATUS_SUCCESS, iceAgentPublishDataSendingPath(&iceAgent));
+    EXPECT_EQ(pDataSendingPath, iceAgent.pRetiredDataSendingPaths);
+    EXPECT_TRUE(iceAgentAcquireDataSendingPath(&iceAgent, &lateReaderIndex) == NULL);
+
+    // Counters of the retired pair are folded into its diagnostics
+    EXPECT_EQ(2, rtcIceCandidatePairDiagnostics.packetsSent);
+    EXPECT_EQ(200, rtcIceCandidatePairDiagnostics.bytesSent);
+    EXPECT_EQ(1, rtcIceCandidatePairDiagnostics.packetsDiscardedOnSend);
+    EXPECT_NE(0, rtcIceCandidatePairDiagnostics.lastPacketSentTimestamp);
+    EXPECT_EQ(0, ATOMIC_LOAD(&pDataSendingPath->packetsSent));
+    EXPECT_EQ(ICE_CANDIDATE_PAIR_STATE_SUCCEEDED, rtcIceCandidatePairDiagnostics.state);
+
+    // the path stays intact until released, a sender that only started after it was replaced doesn't hold it back
+    EXPECT_EQ(STATUS_SUCCESS, iceAgentReclaimDataSendingPaths(&iceAgent));
+    EXPECT_EQ(pDataSendingPath, iceAgent.pRetiredDataSendingPaths);
+    EXPECT_EQ(&iceCandidatePair, pDataSendingPath->pIceCandidatePair);
+    iceAgentReleaseDataSendingPath(&iceAgent, readerIndex);
+    EXPECT_EQ(STATUS_SUCCESS, iceAgentReclaimDataSendingPaths(&iceAgent));
+    EXPECT_TRUE(iceAgent.pRetiredDataSendingPaths == NULL);
+    iceAgentReleaseDataSendingPath(&iceAgent, lateReaderIndex);
+
+    // Senders don't use a pair that hasn't succeeded
+    iceCandidatePair.state = ICE_CANDIDATE_PAIR_STATE_FAILED;
+    iceAgent.pDataSendingIceCandidatePair = &iceCandidatePair;
+    EXPECT_EQ(STATUS_SUCCESS, iceAgentPublishDataSendingPath(&iceAgent));
+    pDataSendingPath = iceAgentAcquireDataSendingPath(&iceAgent, &readerIndex);
+    ASSERT_TRUE(pDataSendingPath != NULL);
+    EXPECT_FALSE(pDataSendingPath->succeeded);
+    iceAgentReleaseDataSendingPath(&iceAgent, readerIndex);
+
+    // Senders see nothing once shutdown has started
+    iceAgent.pDataSendingIceCandidatePair = &iceCandidatePair;
+    ATOMIC_STORE_BOOL(&iceAgent.shutdown, TRUE);
+    EXPECT_EQ(STATUS_SUCCESS, iceAgentPublishDataSendingPath(&iceAgent));
+    EXPECT_TRUE(iceAgentAcquireDataSendingPath(&iceAgent, &readerIndex) == NULL);
+    iceAgentReleaseDataSendingPath(&iceAgent, readerIndex);
+}
+
+TEST_F(IceFunctionalityTest, IceAgentFirstPairFastPathUnitTest)
+{
+    IceAgent iceAgent;
+    IceCandidate localCandidate, remoteCandidates[3];
+    IceCandidatePair iceCandidatePairs[3];
+    BOOL pending = FALSE;
+    UINT32 i, readerIndex = 0;
+    PIceDataSendingPath pDataSendingPath = NULL;
+
+    MEMSET(&iceAgent, 0x00, SIZEOF(IceAgent));
+    MEMSET(&localCandidate, 0x00, SIZEOF(IceCandidate));
+    MEMSET(remoteCandidates, 0x00, SIZEOF(remoteCandidates));
+    MEMSET(iceCandidatePairs, 0x00, SIZEOF(iceCandidatePairs));
+    EXPECT_EQ(STATUS_SUCCESS, doubleListCreate(&iceAgent.iceCandidatePairs));
+
+    localCandidate.iceCandidateType = ICE_CANDIDATE_TYPE_HOST;
+    localCandidate.pSocketConnection = (PSocketConnection) &localCandidate;
+    // highest priority first, like the sorted pair list
+    for (i = 0; i < ARRAY_SIZE(iceCandidatePairs); i++) {
+        remoteCandidates[i].ipAddress.family = KVS_IP_FAMILY_TYPE_IPV4;
+        remoteCandidates[i].ipAddress.port = (UINT16) getInt16(5000 + i);
+        iceCandidatePairs[i].local = &localCandidate;
+        iceCandidatePairs[i].remote = &remoteCandidates[i];
+        iceCandidatePairs[i].priority = ARRAY_SIZE(iceCandidatePairs) - i;
+        iceCandidatePairs[i].state = ICE_CANDIDATE_PAIR_STATE_IN_PROGRESS;
+        EXPECT_EQ(STATUS_SUCCESS, doubleListInsertItemTail(iceAgent.iceCandidatePairs, (UINT64) &iceCandidatePairs[i]));
+    }
+
+    EXPECT_NE(STATUS_SUCCESS, iceAgentSelectFastPathDataSendingPair(NULL));
+    EXPECT_NE(STATUS_SUCCESS, iceAgentHasPendingHigherPriorityPair(&iceAgent, NULL));
+
+    // nothing succeeded yet
+    EXPECT_EQ(STATUS_SUCCESS, iceAgentSelectFastPathDataSendingPair(&iceAgent));
+    EXPECT_TRUE(iceAgent.pDataSendingIceCandidatePair == NULL);
+
+    // the lowest priority pair succeeds first and data goes out on it right away
+    iceCandidatePairs[2].state = ICE_CANDIDATE_PAIR_STATE_SUCCEEDED;
+    EXPECT_EQ(STATUS_SUCCESS, iceAgentSelectFastPathDataSendingPair(&iceAgent));
+    EXPECT_EQ(&iceCandidatePairs[2], iceAgent.pDataSendingIceCandidatePair);
+    pDataSendingPath = iceAgentAcquireDataSendingPath(&iceAgent, &readerIndex);
+    ASSERT_TRUE(pDataSendingPath != NULL);
+    EXPECT_EQ(&iceCandidatePairs[2], pDataSendingPath->pIceCandidatePair);
+    iceAgentReleaseDataSendingPath(&iceAgent, readerIndex);
+
+    EXPECT_EQ(STATUS_SUCCESS, iceAgentHasPendingHigherPriorityPair(&iceAgent, &pending));
+    EXPECT_TRUE(pending);
+
+    // a better pair succeeding takes over
+    iceCandidatePairs[1].state = ICE_CANDIDATE_PAIR_STATE_SUCCEEDED;
+    EXPECT_EQ(STATUS_SUCCESS, iceAgentSelectFastPathDataSendingPair(&iceAgent));
+    EXPECT_EQ(&iceCandidatePairs[1], iceAgent.pDataSendingIceCandidatePair);
+    pDataSendingPath = iceAgentAcquireDataSendingPath(&iceAgent, &readerIndex);
+    ASSERT_TRUE(pDataSendingPath != NULL);
+    EXPECT_EQ(&iceCandidatePairs[1], pDataSendingPath->pIceCandidatePair);
+    EXPECT_EQ(5001, (UINT16) getInt16(pDataSendingPath->remoteAddress.port));
+    iceAgentReleaseDataSendingPath(&iceAgent, readerIndex);
+
+    EXPECT_EQ(STATUS_SUCCESS, iceAgentHasPendingHigherPriorityPair(&iceAgent, &pending));
+    EXPECT_TRUE(pending);
+
+    // nothing better left to wait for once the best pair failed
+    iceCandidatePairs[0].state = ICE_CANDIDATE_PAIR_STATE_FAILED;
+    EXPECT_EQ(STATUS_SUCCESS, iceAgentHasPendingHigherPriorityPair(&iceAgent, &pending));
+    EXPECT_FALSE(pending);
+    EXPECT_EQ(STATUS_SUCCESS, iceAgentSelectFastPathDataSendingPair(&iceAgent));
+    EXPECT_EQ(&iceCandidatePairs[1], iceAgent.pDataSendingIceCandidatePair);
+
+    iceAgent.pDataSendingIceCandidatePair = NULL;
+    EXPECT_EQ(STATUS_SUCCESS, iceAgentPublishDataSendingPath(&iceAgent));
+    EXPECT_EQ(STATUS_SUCCESS, doubleListFree(iceAgent.iceCandidatePairs));
+}
+
+// Number of datagrams waiting on the socket, read and discarded
+UINT32 iceFunctionalityTestDrainDatagrams(PSocketConnection pSocketConnection)
+{
+    UINT32 count = 0;
+    BYTE buffer[STUN_PACKET_ALLOCATION_SIZE];
+    struct pollfd rfds;
+
+    for (;;) {
+        MEMSET(&rfds, 0x00, SIZEOF(rfds));
+        rfds.fd = pSocketConnection->localSocket;
+        rfds.events = POLLIN;
+        if (POLL(&rfds, 1, 10) <= 0) {
+            break;
+        }
+
+        recv(pSocketConnection->localSocket, buffer, SIZEOF(buffer), 0);
+        count++;
+    }
+
+    return count;
+}
+
+TEST_F(IceFunctionalityTest, IceAgentCheckCandidatePairConnectionPacingUnitTest)
+{
+    IceAgent iceAgent;
+    IceCandidate localCandidate, remoteCandidates[3];
+    PSocketConnection pRemoteSockets[3];
+    PIceCandidatePair pIceCandidatePairs[3], pIceCandidatePair = NULL;
+    PDoubleListNode pCurNode = NULL;
+    KvsIpAddress localhost;
+    // long enough for the retransmission timeout not to expire during the test, and above the floor with 3 pairs
+    UINT64 ta = 200 * HUNDREDS_OF_NANOS_IN_A_MILLISECOND;
+    UINT32 i;
+
+    MEMSET(&iceAgent, 0x00, SIZEOF(IceAgent));
+    MEMSET(&localCandidate, 0x00, SIZEOF(IceCandidate));
+    MEMSET(remoteCandidates, 0x00, SIZEOF(remoteCandidates));
+    MEMSET(&localhost, 0x00, SIZEOF(KvsIpAddress));
+    localhost.family = KVS_IP_FAMILY_TYPE_IPV4;
+    // 127.0.0.1
+    localhost.address[0] = 0x7f;
+    localhost.address[3] = 0x01;
+
+    iceAgent.lock = MUTEX_CREATE(TRUE);
+    iceAgent.kvsRtcConfiguration.iceConnectionCheckPollingInterval = (UINT32) ta;
+    EXPECT_EQ(STATUS_SUCCESS, doubleListCreate(&iceAgent.localCandidates));
+    EXPECT_EQ(STATUS_SUCCESS, doubleListCreate(&iceAgent.remoteCandidates));
+    EXPECT_EQ(STATUS_SUCCESS, doubleListCreate(&iceAgent.iceCandidatePairs));
+    EXPECT_EQ(STATUS_SUCCESS, hashTableCreate(&iceAgent.iceCandidatePairIndex));
+    EXPECT_EQ(STATUS_SUCCESS, hashTableCreate(&iceAgent.requestTimestampDiagnostics));
+    EXPECT_EQ(STATUS_SUCCESS, stackQueueCreate(&iceAgent.triggeredCheckQueue));
+    EXPECT_EQ(STATUS_SUCCESS, createStunPacket(STUN_PACKET_TYPE_BINDING_REQUEST, NULL, &iceAgent.pBindingRequest));
+    EXPECT_EQ(STATUS_SUCCESS, appendStunUsernameAttribute(iceAgent.pBindingRequest, (PCHAR) "remoteUfrag:localUfrag"));
+    EXPECT_EQ(STATUS_SUCCESS, appendStunPriorityAttribute(iceAgent.pBindingRequest, 0));
+    EXPECT_EQ(STATUS_SUCCESS, kvsSha1HmacKeyInit(&iceAgent.remotePasswordHmacKey, (PBYTE) "password", 8));
+
+    localCandidate.iceCandidateType = ICE_CANDIDATE_TYPE_HOST;
+    localCandidate.state = ICE_CANDIDATE_STATE_VALID;
+    localCandidate.ipAddress = localhost;
+    localCandidate.priority = computeCandidatePriority(&localCandidate);
+    EXPECT_EQ(STATUS_SUCCESS,
+              createSocketConnection((KVS_IP_FAMILY_TYPE) localhost.family, KVS_SOCKET_PROTOCOL_UDP, &localhost, NULL, 0, NULL, 0,
+                                     &localCandidate.pSocketConnection));
+    EXPECT_EQ(STATUS_SUCCESS, doubleListInsertItemTail(iceAgent.localCandidates, (UINT64) &localCandidate));
+
+    // each remote candidate is a socket of its own so that the checks of every pair can be counted
+    for (i = 0; i < ARRAY_SIZE(remoteCandidates); i++) {
+        localhost.port = 0;
+        EXPECT_EQ(STATUS_SUCCESS,
+                  createSocketConnection((KVS_IP_FAMILY_TYPE) localhost.family, KVS_SOCKET_PROTOCOL_UDP, &localhost, NULL, 0, NULL, 0,
+                                         &pRemoteSockets[i]));
+        remoteCandidates[i].iceCandidateType = ICE_CANDIDATE_TYPE_HOST;
+        remoteCandidates[i].state = ICE_CANDIDATE_STATE_VALID;
+        remoteCandidates[i].ipAddress = pRemoteSockets[i]->hostIpAddr;
+        // pairs come out in the order of the remote candidates
+        remoteCandidates[i].priority = computeCandidatePriority(&remoteCandidates[i]) - i;
+        EXPECT_EQ(STATUS_SUCCESS, doubleListInsertItemTail(iceAgent.remoteCandidates, (UINT64) &remoteCandidates[i]));
+        EXPECT_EQ(STATUS_SUCCESS, createIceCandidatePairs(&iceAgent, &remoteCandidates[i], TRUE));
+    }
+
+    EXPECT_EQ(STATUS_SUCCESS, doubleListGetHeadNode(iceAgent.iceCandidatePairs, &pCurNode));
+    for (i = 0; i < ARRAY_SIZE(pIceCandidatePairs); i++) {
+        ASSERT_TRUE(pCurNode != NULL);
+        pIceCandidatePairs[i] = (PIceCandidatePair) pCurNode->data;
+        pCurNode = pCurNode->pNext;
+        EXPECT_EQ(&remoteCandidates[i], pIceCandidatePairs[i]->remote);
+        EXPECT_EQ(ICE_CANDIDATE_PAIR_STATE_WAITING, pIceCandidatePairs[i]->state);
+    }
+
+    // one check per Ta, highest priority first
+    EXPECT_EQ(STATUS_SUCCESS, iceAgentCheckCandidatePairConnection(&iceAgent));
+    EXPECT_EQ(ICE_CANDIDATE_PAIR_STATE_IN_PROGRESS, pIceCandidatePairs[0]->state);
+    EXPECT_EQ(ICE_CANDIDATE_PAIR_STATE_WAITING, pIceCandidatePairs[1]->state);
+    EXPECT_EQ(ICE_CANDIDATE_PAIR_STATE_WAITING, pIceCandidatePairs[2]->state);
+    EXPECT_EQ(3 * ta, iceAgent.connectionCheckRto);
+    EXPECT_EQ(1, iceFunctionalityTestDrainDatagrams(pRemoteSockets[0]));
+    EXPECT_EQ(0, iceFunctionalityTestDrainDatagrams(pRemoteSockets[1]));
+
+    // the in progress pair is not checked again before its retransmission timeout
+    EXPECT_EQ(STATUS_SUCCESS, iceAgentCheckCandidatePairConnection(&iceAgent));
+    EXPECT_EQ(ICE_CANDIDATE_PAIR_STATE_IN_PROGRESS, pIceCandidatePairs[1]->state);
+    EXPECT_EQ(ICE_CANDIDATE_PAIR_STATE_WAITING, pIceCandidatePairs[2]->state);
+    EXPECT_EQ(0, iceFunctionalityTestDrainDatagrams(pRemoteSockets[0]));
+    EXPECT_EQ(1, iceFunctionalityTestDrainDatagrams(pRemoteSockets[1]));
+
+    // a triggered check goes ahead of the ordinary check and due checks are retransmitted
+    pIceCandidatePairs[0]->nextConnectivityCheckTime = 0;
+    pIceCandidatePairs[2]->state = ICE_CANDIDATE_PAIR_STATE_SUCCEEDED;
+    EXPECT_EQ(STATUS_SUCCESS, stackQueueEnqueue(iceAgent.triggeredCheckQueue, (UINT64) pIceCandidatePairs[2]));
+    EXPECT_EQ(STATUS_SUCCESS, iceAgentCheckCandidatePairConnection(&iceAgent));
+    EXPECT_EQ(ICE_CANDIDATE_PAIR_STATE_SUCCEEDED, pIceCandidatePairs[2]->state);
+    EXPECT_EQ(1, iceFunctionalityTestDrainDatagrams(pRemoteSockets[0]));
+    EXPECT_EQ(0, iceFunctionalityTestDrainDatagrams(pRemoteSockets[1]));
+    EXPECT_EQ(1, iceFunctionalityTestDrainDatagrams(pRemoteSockets[2]));
+
+    // nothing waiting, nothing due
+    EXPECT_EQ(STATUS_SUCCESS, iceAgentCheckCandidatePairConnection(&iceAgent));
+    for (i = 0; i < ARRAY_SIZE(pRemoteSockets); i++) {
+        EXPECT_EQ(0, iceFunctionalityTestDrainDatagrams(pRemoteSockets[i]));
+    }
+    // with fewer pairs left the timeout doesn't go below the rfc8445 floor
+    EXPECT_EQ(KVS_ICE_CONNECTION_CHECK_MIN_RTO, iceAgent.connectionCheckRto);
+
+    EXPECT_EQ(STATUS_SUCCESS, doubleListGetHeadNode(iceAgent.iceCandidatePairs, &pCurNode));
+    while (pCurNode != NULL) {
+        pIceCandidatePair = (PIceCandidatePair) pCurNode->data;
+        pCurNode = pCurNode->pNext;
+
+        EXPECT_EQ(STATUS_SUCCESS, unindexIceCandidatePair(iceAgent.iceCandidatePairIndex, pIceCandidatePair));
+        CHK_LOG_ERR(freeIceCandidatePair(&pIceCandidatePair));
+    }
+
+    for (i = 0; i < ARRAY_SIZE(pRemoteSockets); i++) {
+        EXPECT_EQ(STATUS_SUCCESS, freeSocketConnection(&pRemoteSockets[i]));
+    }
+    EXPECT_EQ(STATUS_SUCCESS, freeSocketConnection(&localCandidate.pSocketConnection));
+    EXPECT_EQ(STATUS_SUCCESS, freeStunPacket(&iceAgent.pBindingRequest));
+    EXPECT_EQ(STATUS_SUCCESS, stackQueueFree(iceAgent.triggeredCheckQueue));
+    EXPECT_EQ(STATUS_SUCCESS, hashTableFree(iceAgent.requestTimestampDiagnostics));
+    EXPECT_EQ(STATUS_SUCCESS, hashTableFree(iceAgent.iceCandidatePairIndex));
+    EXPECT_EQ(STATUS_SUCCESS, doubleListClear(iceAgent.iceCandidatePairs, FALSE));
+    EXPECT_EQ(STATUS_SUCCESS, doubleListFree(iceAgent.iceCandidatePairs));
+    EXPECT_EQ(STATUS_SUCCESS, doubleListClear(iceAgent.localCandidates, FALSE));
+    EXPECT_EQ(STATUS_SUCCESS, doubleListFree(iceAgent.localCandidates));
+    EXPECT_EQ(STATUS_SUCCESS, doubleListClear(iceAgent.remoteCandidates, FALSE));
+    EXPECT_EQ(STATUS_SUCCESS, doubleListFree(iceAgent.remoteCandidates));
+    MUTEX_FREE(iceAgent.lock);
 }
 
 TEST_F(IceFunctionalityTest, IceAgentCandidateGatheringTest)
@@ -713,6 +1251,432 @@ TEST_F(IceFunctionalityTest, IceAgentCandidateGatheringTest)
 
     deinitializeSignalingClient();
 }
+
+TEST_F(IceFunctionalityTest, socketConnectionSendDataBatchDeliversAllDatagramsInOrder)
+{
+    PSocketConnection pReceiver = NULL, pSender = NULL;
+    KvsIpAddress localhost;
+    BYTE packetData[8][200];
+    PBYTE buffers[8];
+    UINT32 lengths[8], sentCount = 0, receivedCount, round, i;
+    // Equal sized packets with a shorter tail can go out as one GSO send, mixed sizes go through sendmmsg
+    UINT32 roundLengths[2][8] = {{200, 200, 200, 200, 200, 200, 200, 120}, {100, 200, 50, 200, 10, 150, 200, 1}};
+    BYTE recvBuffer[512];
+    INT32 recvLen;
+    struct pollfd rfds;
+
+    MEMSET(&localhost, 0x0, SIZEOF(KvsIpAddress));
+    localhost.family = KVS_IP_FAMILY_TYPE_IPV4;
+    // 127.0.0.1
+    localhost.address[0] = 0x7f;
+    localhost.address[3] = 0x01;
+
+    EXPECT_EQ(STATUS_SUCCESS,
+              createSocketConnection((KVS_IP_FAMILY_TYPE) localhost.family, KVS_SOCKET_PROTOCOL_UDP, &localhost, NULL, 0, NULL, 0, &pReceiver));
+    localhost.port = 0;
+    EXPECT_EQ(STATUS_SUCCESS,
+              createSocketConnection((KVS_IP_FAMILY_TYPE) localhost.family, KVS_SOCKET_PROTOCOL_UDP, &localhost, NULL, 0, NULL, 0, &pSender));
+
+    EXPECT_EQ(STATUS_NULL_ARG, socketConnectionSendDataBatch(pSender, NULL, lengths, 1, &pReceiver->hostIpAddr, NULL));
+    EXPECT_EQ(STATUS_INVALID_ARG, socketConnectionSendDataBatch(pSender, buffers, lengths, 1, NULL, NULL));
+
+    for (round = 0; round < ARRAY_SIZE(roundLengths); round++) {
+        for (i = 0; i < ARRAY_SIZE(buffers); i++) {
+            MEMSET(packetData[i], (BYTE) i, SIZEOF(packetData[i]));
+            buffers[i] = packetData[i];
+            lengths[i] = roundLengths[round][i];
+        }
+
+        EXPECT_EQ(STATUS_SUCCESS, socketConnectionSendDataBatch(pSender, buffers, lengths, ARRAY_SIZE(buffers), &pReceiver->hostIpAddr, &sentCount));
+        EXPECT_EQ(ARRAY_SIZE(buffers), sentCount);
+
+        for (receivedCount = 0; receivedCount < ARRAY_SIZE(buffers); receivedCount++) {
+            MEMSET(&rfds, 0x00, SIZEOF(rfds));
+            rfds.fd = pReceiver->localSocket;
+            rfds.events = POLLIN;
+            if (POLL(&rfds, 1, 1000) <= 0) {
+                break;
+            }
+
+            recvLen = (INT32) recv(pReceiver->localSocket, recvBuffer, SIZEOF(recvBuffer), 0);
+            EXPECT_EQ((INT32) lengths[receivedCount], recvLen);
+            EXPECT_EQ((BYTE) receivedCount, recvBuffer[0]);
+        }
+        EXPECT_EQ(ARRAY_SIZE(buffers), receivedCount);
+    }
+
+    EXPECT_EQ(STATUS_SUCCESS, freeSocketConnection(&pSender));
+    EXPECT_EQ(STATUS_SUCCESS, freeSocketConnection(&pReceiver));
+}
+
+TEST_F(IceFunctionalityTest, socketConnectionSendDataBatchSplitsBatchesLargerThanADatagram)
+{
+    PSocketConnection pReceiver = NULL, pSender = NULL;
+    KvsIpAddress localhost;
+    PBYTE packetData = NULL;
+    PBYTE buffers[MAX_SOCKET_SEND_BATCH_SIZE];
+    UINT32 lengths[MAX_SOCKET_SEND_BATCH_SIZE], sentCount = 0, receivedCount, i;
+    BYTE recvBuffer[DEFAULT_MTU_SIZE_BYTES + 1];
+    INT32 recvLen;
+    struct pollfd rfds;
+
+    MEMSET(&localhost, 0x0, SIZEOF(KvsIpAddress));
+    localhost.family = KVS_IP_FAMILY_TYPE_IPV4;
+    // 127.0.0.1
+    localhost.address[0] = 0x7f;
+    localhost.address[3] = 0x01;
+
+    EXPECT_EQ(STATUS_SUCCESS,
+              createSocketConnection((KVS_IP_FAMILY_TYPE) localhost.family, KVS_SOCKET_PROTOCOL_UDP, &localhost, NULL, 0, NULL, 0, &pReceiver));
+    localhost.port = 0;
+    EXPECT_EQ(STATUS_SUCCESS,
+              createSocketConnection((KVS_IP_FAMILY_TYPE) localhost.family, KVS_SOCKET_PROTOCOL_UDP, &localhost, NULL, 0, NULL, 0, &pSender));
+
+    // A full batch of MTU sized packets adds up to more than a single datagram can carry
+    packetData = (PBYTE) MEMALLOC(MAX_SOCKET_SEND_BATCH_SIZE * DEFAULT_MTU_SIZE_BYTES);
+    ASSERT_TRUE(packetData != NULL);
+    EXPECT_LT(MAX_UDP_PACKET_SIZE, MAX_SOCKET_SEND_BATCH_SIZE * DEFAULT_MTU_SIZE_BYTES);
+    for (i = 0; i < MAX_SOCKET_SEND_BATCH_SIZE; i++) {
+        buffers[i] = packetData + i * DEFAULT_MTU_SIZE_BYTES;
+        lengths[i] = i == MAX_SOCKET_SEND_BATCH_SIZE - 1 ? DEFAULT_MTU_SIZE_BYTES / 2 : DEFAULT_MTU_SIZE_BYTES;
+        MEMSET(buffers[i], (BYTE) i, lengths[i]);
+    }
+
+    EXPECT_EQ(STATUS_SUCCESS,
+              socketConnectionSendDataBatch(pSender, buffers, lengths, MAX_SOCKET_SEND_BATCH_SIZE, &pReceiver->hostIpAddr, &sentCount));
+    EXPECT_EQ(MAX_SOCKET_SEND_BATCH_SIZE, sentCount);
+
+    for (receivedCount = 0; receivedCount < MAX_SOCKET_SEND_BATCH_SIZE; receivedCount++) {
+        MEMSET(&rfds, 0x00, SIZEOF(rfds));
+        rfds.fd = pReceiver->localSocket;
+        rfds.events = POLLIN;
+        if (POLL(&rfds, 1, 1000) <= 0) {
+            break;
+        }
+
+        recvLen = (INT32) recv(pReceiver->localSocket, recvBuffer, SIZEOF(recvBuffer), 0);
+        EXPECT_EQ((INT32) lengths[receivedCount], recvLen);
+        EXPECT_EQ((BYTE) receivedCount, recvBuffer[0]);
+    }
+    EXPECT_EQ(MAX_SOCKET_SEND_BATCH_SIZE, receivedCount);
+
+    MEMFREE(packetData);
+    EXPECT_EQ(STATUS_SUCCESS, freeSocketConnection(&pSender));
+    EXPECT_EQ(STATUS_SUCCESS, freeSocketConnection(&pReceiver));
+}
+
+STATUS connectionListenerTestCountDatagrams(UINT64 customData, PSocketConnection pSocketConnection, PBYTE pBuffer, UINT32 bufferLen,
+                                            PKvsIpAddress pSrc, PKvsIpAddress pDest)
+{
+    UNUSED_PARAM(pSocketConnection);
+    UNUSED_PARAM(pSrc);
+    UNUSED_PARAM(pDest);
+
+    // Every datagram carries its index in the first byte, only count the ones that arrive in order
+    PSIZE_T pReceivedCount = (PSIZE_T) customData;
+    if (bufferLen > 0 && pBuffer[0] == (BYTE) ATOMIC_LOAD(pReceivedCount)) {
+        ATOMIC_INCREMENT(pReceivedCount);
+    }
+
+    return STATUS_SUCCESS;
+}
+
+TEST_F(IceFunctionalityTest, connectionListenerReceivesMoreDatagramsThanOneBatch)
+{
+    PConnectionListener pConnectionListener = NULL;
+    PSocketConnection pReceiver = NULL, pSender = NULL;
+    KvsIpAddress localhost;
+    BYTE packet[100];
+    volatile SIZE_T receivedCount = 0;
+    UINT32 i, datagramCount = 3 * CONNECTION_LISTENER_RECEIVE_BATCH_SIZE + 5;
+    UINT64 deadline;
+
+    MEMSET(&localhost, 0x0, SIZEOF(KvsIpAddress));
+    localhost.family = KVS_IP_FAMILY_TYPE_IPV4;
+    // 127.0.0.1
+    localhost.address[0] = 0x7f;
+    localhost.address[3] = 0x01;
+
+    EXPECT_EQ(STATUS_SUCCESS,
+              createSocketConnection((KVS_IP_FAMILY_TYPE) localhost.family, KVS_SOCKET_PROTOCOL_UDP, &localhost, NULL, (UINT64) &receivedCount,
+                                     connectionListenerTestCountDatagrams, 0, &pReceiver));
+    ATOMIC_STORE_BOOL(&pReceiver->receiveData, TRUE);
+    localhost.port = 0;
+    EXPECT_EQ(STATUS_SUCCESS,
+              createSocketConnection((KVS_IP_FAMILY_TYPE) localhost.family, KVS_SOCKET_PROTOCOL_UDP, &localhost, NULL, 0, NULL, 0, &pSender));
+
+    EXPECT_EQ(STATUS_SUCCESS, createConnectionListener(&pConnectionListener));
+    EXPECT_EQ(STATUS_SUCCESS, connectionListenerAddConnection(pConnectionListener, pReceiver));
+    EXPECT_EQ(STATUS_SUCCESS, connectionListenerStart(pConnectionListener));
+
+    for (i = 0; i < datagramCount; i++) {
+        MEMSET(packet, (BYTE) i, SIZEOF(packet));
+        EXPECT_EQ(STATUS_SUCCESS, socketConnectionSendData(pSender, packet, SIZEOF(packet), &pReceiver->hostIpAddr));
+    }
+
+    deadline = GETTIME() + 5 * HUNDREDS_OF_NANOS_IN_A_SECOND;
+    while (ATOMIC_LOAD(&receivedCount) < datagramCount && GETTIME() < deadline) {
+        THREAD_SLEEP(10 * HUNDREDS_OF_NANOS_IN_A_MILLISECOND);
+    }
+    EXPECT_EQ(datagramCount, ATOMIC_LOAD(&receivedCount));
+
+    EXPECT_EQ(STATUS_SUCCESS, freeConnectionListener(&pConnectionListener));
+    EXPECT_EQ(STATUS_SUCCESS, freeSocketConnection(&pSender));
+    EXPECT_EQ(STATUS_SUCCESS, freeSocketConnection(&pReceiver));
+}
+
+TEST_F(IceFunctionalityTest, connectionListenerReceivesLargeDatagrams)
+{
+    PConnectionListener pConnectionListener = NULL;
+    PSocketConnection pReceiver = NULL, pSender = NULL;
+    KvsIpAddress localhost;
+    PBYTE pPacket = NULL;
+    volatile SIZE_T receivedCount = 0;
+    UINT32 i, datagramCount = 3, packetLen = 20000;
+    UINT64 deadline;
+
+    MEMSET(&localhost, 0x0, SIZEOF(KvsIpAddress));
+    localhost.family = KVS_IP_FAMILY_TYPE_IPV4;
+    // 127.0.0.1
+    localhost.address[0] = 0x7f;
+    localhost.address[3] = 0x01;
+
+    EXPECT_EQ(STATUS_SUCCESS,
+              createSocketConnection((KVS_IP_FAMILY_TYPE) localhost.family, KVS_SOCKET_PROTOCOL_UDP, &localhost, NULL, (UINT64) &receivedCount,
+                                     connectionListenerTestCountDatagrams, 0, &pReceiver));
+    ATOMIC_STORE_BOOL(&pReceiver->receiveData, TRUE);
+    localhost.port = 0;
+    EXPECT_EQ(STATUS_SUCCESS,
+              createSocketConnection((KVS_IP_FAMILY_TYPE) localhost.family, KVS_SOCKET_PROTOCOL_UDP, &localhost, NULL, 0, NULL, 0, &pSender));
+
+    EXPECT_EQ(STATUS_SUCCESS, createConnectionListener(&pConnectionListener));
+    EXPECT_EQ(STATUS_SUCCESS, connectionListenerAddConnection(pConnectionListener, pReceiver));
+    EXPECT_EQ(STATUS_SUCCESS, connectionListenerStart(pConnectionListener));
+
+    // Well over a MTU, batched receives must not truncate them
+    pPacket = (PBYTE) MEMALLOC(packetLen);
+    ASSERT_TRUE(pPacket != NULL);
+    for (i = 0; i < datagramCount; i++) {
+        MEMSET(pPacket, (BYTE) i, packetLen);
+        EXPECT_EQ(STATUS_SUCCESS, socketConnectionSendData(pSender, pPacket, packetLen, &pReceiver->hostIpAddr));
+    }
+
+    deadline = GETTIME() + 5 * HUNDREDS_OF_NANOS_IN_A_SECOND;
+    while (ATOMIC_LOAD(&receivedCount) < datagramCount && GETTIME() < deadline) {
+        THREAD_SLEEP(10 * HUNDREDS_OF_NANOS_IN_A_MILLISECOND);
+    }
+    EXPECT_EQ(datagramCount, ATOMIC_LOAD(&receivedCount));
+
+    EXPECT_EQ(STATUS_SUCCESS, freeConnectionListener(&pConnectionListener));
+    EXPECT_EQ(STATUS_SUCCESS, freeSocketConnection(&pSender));
+    EXPECT_EQ(STATUS_SUCCESS, freeSocketConnection(&pReceiver));
+    MEMFREE(pPacket);
+}
+
+TEST_F(IceFunctionalityTest, connectionListenerWithWorkersServesEverySocket)
+{
+    PConnectionListener pConnectionListener = NULL;
+    PSocketConnection receivers[8], pSender = NULL;
+    volatile SIZE_T receivedCounts[ARRAY_SIZE(receivers)];
+    KvsIpAddress localhost;
+    BYTE packet[100];
+    UINT32 i, j, datagramCount = 10;
+    UINT64 deadline;
+    BOOL done = FALSE;
+
+    MEMSET(&localhost, 0x0, SIZEOF(KvsIpAddress));
+    localhost.family = KVS_IP_FAMILY_TYPE_IPV4;
+    // 127.0.0.1
+    localhost.address[0] = 0x7f;
+    localhost.address[3] = 0x01;
+
+    EXPECT_EQ(STATUS_INVALID_ARG, createConnectionListenerWithWorkers(0, CONNECTION_LISTENER_DEFAULT_MAX_LISTENING_CONNECTION, &pConnectionListener));
+    EXPECT_EQ(STATUS_INVALID_ARG,
+              createConnectionListenerWithWorkers(CONNECTION_LISTENER_MAX_WORKER_COUNT + 1, CONNECTION_LISTENER_DEFAULT_MAX_LISTENING_CONNECTION,
+                                                  &pConnectionListener));
+    EXPECT_EQ(STATUS_INVALID_ARG, createConnectionListenerWithWorkers(4, 0, &pConnectionListener));
+    EXPECT_EQ(STATUS_SUCCESS, createConnectionListenerWithWorkers(4, CONNECTION_LISTENER_DEFAULT_MAX_LISTENING_CONNECTION, &pConnectionListener));
+    EXPECT_EQ(STATUS_SUCCESS, connectionListenerStart(pConnectionListener));
+
+    for (i = 0; i < ARRAY_SIZE(receivers); i++) {
+        receivedCounts[i] = 0;
+        localhost.port = 0;
+        EXPECT_EQ(STATUS_SUCCESS,
+                  createSocketConnection((KVS_IP_FAMILY_TYPE) localhost.family, KVS_SOCKET_PROTOCOL_UDP, &localhost, NULL,
+                                         (UINT64) &receivedCounts[i], connectionListenerTestCountDatagrams, 0, &receivers[i]));
+        ATOMIC_STORE_BOOL(&receivers[i]->receiveData, TRUE);
+        EXPECT_EQ(STATUS_SUCCESS, connectionListenerAddConnection(pConnectionListener, receivers[i]));
+    }
+    EXPECT_EQ(ARRAY_SIZE(receivers), pConnectionListener->socketCount);
+
+    localhost.port = 0;
+    EXPECT_EQ(STATUS_SUCCESS,
+              createSocketConnection((KVS_IP_FAMILY_TYPE) localhost.family, KVS_SOCKET_PROTOCOL_UDP, &localhost, NULL, 0, NULL, 0, &pSender));
+
+    for (j = 0; j < datagramCount; j++) {
+        MEMSET(packet, (BYTE) j, SIZEOF(packet));
+        for (i = 0; i < ARRAY_SIZE(receivers); i++) {
+            EXPECT_EQ(STATUS_SUCCESS, socketConnectionSendData(pSender, packet, SIZEOF(packet), &receivers[i]->hostIpAddr));
+        }
+    }
+
+    deadline = GETTIME() + 5 * HUNDREDS_OF_NANOS_IN_A_SECOND;
+    while (!done && GETTIME() < deadline) {
+        THREAD_SLEEP(10 * HUNDREDS_OF_NANOS_IN_A_MILLISECOND);
+        for (i = 0, done = TRUE; i < ARRAY_SIZE(receivers); i++) {
+            done = done && ATOMIC_LOAD(&receivedCounts[i]) == datagramCount;
+        }
+    }
+
+    for (i = 0; i < ARRAY_SIZE(receivers); i++) {
+        EXPECT_EQ(datagramCount, ATOMIC_LOAD(&receivedCounts[i]));
+    }
+
+    EXPECT_EQ(STATUS_SUCCESS, connectionListenerRemoveConnection(pConnectionListener, receivers[0]));
+    EXPECT_EQ(ARRAY_SIZE(receivers) - 1, pConnectionListener->socketCount);
+
+    EXPECT_EQ(STATUS_SUCCESS, freeConnectionListener(&pConnectionListener));
+    EXPECT_EQ(STATUS_SUCCESS, freeSocketConnection(&pSender));
+    for (i = 0; i < ARRAY_SIZE(receivers); i++) {
+        EXPECT_EQ(STATUS_SUCCESS, freeSocketConnection(&receivers[i]));
+    }
+}
+
+TEST_F(IceFunctionalityTest, sharedConnectionListenerIsCreatedOnce)
+{
+    PConnectionListener pConnectionListener = NULL, pSameConnectionListener = NULL;
+    PSocketConnection sockets[CONNECTION_LISTENER_DEFAULT_MAX_LISTENING_CONNECTION + 1];
+    KvsIpAddress localhost;
+    UINT32 i;
+
+    MEMSET(&localhost, 0x0, SIZEOF(KvsIpAddress));
+    localhost.family = KVS_IP_FAMILY_TYPE_IPV4;
+    // 127.0.0.1
+    localhost.address[0] = 0x7f;
+    localhost.address[3] = 0x01;
+
+    // set up by initKvsWebRtc, the listener itself is created by the first caller
+    EXPECT_EQ(STATUS_NULL_ARG, sharedConnectionListenerAcquire(2, NULL));
+    EXPECT_EQ(STATUS_SUCCESS, sharedConnectionListenerAcquire(2, &pConnectionListener));
+    ASSERT_TRUE(pConnectionListener != NULL);
+    EXPECT_EQ(STATUS_SUCCESS, sharedConnectionListenerAcquire(4, &pSameConnectionListener));
+    EXPECT_EQ(pConnectionListener, pSameConnectionListener);
+
+#ifdef KVS_SOCKET_EPOLL_SUPPORTED
+    EXPECT_EQ(2, pConnectionListener->workerCount);
+
+    // Holds the sockets of more than a single peer connection
+    for (i = 0; i < ARRAY_SIZE(sockets); i++) {
+        localhost.port = 0;
+        EXPECT_EQ(STATUS_SUCCESS,
+                  createSocketConnection((KVS_IP_FAMILY_TYPE) localhost.family, KVS_SOCKET_PROTOCOL_UDP, &localhost, NULL, 0, NULL, 0, &sockets[i]));
+        EXPECT_EQ(STATUS_SUCCESS, connectionListenerAddConnection(pConnectionListener, sockets[i]));
+    }
+    EXPECT_EQ(ARRAY_SIZE(sockets), pConnectionListener->socketCount);
+
+    for (i = 0; i < ARRAY_SIZE(sockets); i++) {
+        EXPECT_EQ(STATUS_SUCCESS, connectionListenerRemoveConnection(pConnectionListener, sockets[i]));
+        EXPECT_EQ(STATUS_SUCCESS, freeSocketConnection(&sockets[i]));
+    }
+    EXPECT_EQ(0, pConnectionListener->socketCount);
+#else
+    UNUSED_PARAM(sockets);
+    UNUSED_PARAM(localhost);
+    UNUSED_PARAM(i);
+#endif
+
+    // freed by deinitKvsWebRtc
+    EXPECT_EQ(pConnectionListener, getSharedConnectionListenerInstance()->pConnectionListener);
+}
+
+TEST_F(IceFunctionalityTest, IceCandidateCacheUnitTest)
+{
+    PIceCandidateCache pCache = getIceCandidateCacheInstance();
+    KvsIpAddress cachedAddresses[MAX_LOCAL_NETWORK_INTERFACE_COUNT], localAddresses[MAX_LOCAL_NETWORK_INTERFACE_COUNT], ipAddress, bindAddress;
+    UINT32 cachedCount = ARRAY_SIZE(cachedAddresses), localCount = ARRAY_SIZE(localAddresses), i, pooledCount = 0;
+    PSocketConnection pooledSockets[ICE_CANDIDATE_CACHE_SOCKETS_PER_INTERFACE], pSocketConnection = NULL;
+    BOOL pooled = FALSE;
+
+    // already set up by initKvsWebRtc
+    EXPECT_EQ(STATUS_SUCCESS, createIceCandidateCache());
+
+    EXPECT_EQ(STATUS_SUCCESS, iceCandidateCacheGetLocalIpAddresses(cachedAddresses, &cachedCount, 0));
+    EXPECT_EQ(STATUS_SUCCESS, getLocalhostIpAddresses(localAddresses, &localCount, NULL, 0));
+    EXPECT_EQ(localCount, cachedCount);
+    for (i = 0; i < cachedCount && i < localCount; i++) {
+        EXPECT_TRUE(isSameIpAddress(&localAddresses[i], &cachedAddresses[i], TRUE));
+    }
+
+    // fill the pools without waiting for the timer
+    EXPECT_EQ(STATUS_SUCCESS, iceCandidateCacheRefreshCallback(0, GETTIME(), (UINT64) pCache));
+
+    if (cachedCount > 0) {
+        MUTEX_LOCK(pCache->lock);
+        if (!pCache->interfaces[0].bindFailed) {
+            EXPECT_EQ(ICE_CANDIDATE_CACHE_SOCKETS_PER_INTERFACE, pCache->interfaces[0].socketCount);
+            pooledCount = pCache->interfaces[0].socketCount;
+            MEMCPY(pooledSockets, pCache->interfaces[0].sockets, pooledCount * SIZEOF(PSocketConnection));
+        }
+        MUTEX_UNLOCK(pCache->lock);
+
+        bindAddress = cachedAddresses[0];
+        EXPECT_EQ(STATUS_SUCCESS, iceCandidateCacheTakeSocket(&bindAddress, 1234, connectionListenerTestCountDatagrams, 0, &pSocketConnection));
+        ASSERT_TRUE(pSocketConnection != NULL);
+        for (i = 0; i < pooledCount; i++) {
+            pooled = pooled || pooledSockets[i] == pSocketConnection;
+        }
+
+        EXPECT_EQ(pooledCount > 0, pooled);
+        EXPECT_NE(0, bindAddress.port);
+        EXPECT_TRUE(isSameIpAddress(&bindAddress, &pSocketConnection->hostIpAddr, TRUE));
+        EXPECT_EQ(1234, pSocketConnection->dataAvailableCallbackCustomData);
+        EXPECT_TRUE(pSocketConnection->dataAvailableCallbackFn == connectionListenerTestCountDatagrams);
+        EXPECT_EQ(STATUS_SUCCESS, freeSocketConnection(&pSocketConnection));
+
+        // sockets with a different send buffer size are bound on demand
+        bindAddress = cachedAddresses[0];
+        EXPECT_EQ(STATUS_SUCCESS, iceCandidateCacheTakeSocket(&bindAddress, 0, NULL, 64 * 1024, &pSocketConnection));
+        for (i = 0; i < pooledCount; i++) {
+            EXPECT_TRUE(pooledSockets[i] != pSocketConnection);
+        }
+        EXPECT_EQ(STATUS_SUCCESS, freeSocketConnection(&pSocketConnection));
+    }
+
+    EXPECT_EQ(STATUS_SUCCESS, iceCandidateCacheResolveHost(0, (PCHAR) "127.0.0.1", &ipAddress));
+    EXPECT_EQ(KVS_IP_FAMILY_TYPE_IPV4, ipAddress.family);
+    EXPECT_EQ(1, ipAddress.address[3]);
+
+    // the second lookup is answered from the cache
+    MUTEX_LOCK(pCache->lock);
+    for (i = 0; i < pCache->hostCount; i++) {
+        if (STRCMP(pCache->hosts[i].hostname, "127.0.0.1") == 0) {
+            pCache->hosts[i].ipAddress.address[3] = 2;
+        }
+    }
+    MUTEX_UNLOCK(pCache->lock);
+    EXPECT_EQ(STATUS_SUCCESS, iceCandidateCacheResolveHost(0, (PCHAR) "127.0.0.1", &ipAddress));
+    EXPECT_EQ(2, ipAddress.address[3]);
+
+    // and resolved again once expired
+    MUTEX_LOCK(pCache->lock);
+    for (i = 0; i < pCache->hostCount; i++) {
+        if (STRCMP(pCache->hosts[i].hostname, "127.0.0.1") == 0) {
+            pCache->hosts[i].expirationTime = 0;
+        }
+    }
+    MUTEX_UNLOCK(pCache->lock);
+    EXPECT_EQ(STATUS_SUCCESS, iceCandidateCacheResolveHost(0, (PCHAR) "127.0.0.1", &ipAddress));
+    EXPECT_EQ(1, ipAddress.address[3]);
+
+    // Without the cache there is no lock to take, the calls fail instead
+    EXPECT_EQ(STATUS_SUCCESS, freeIceCandidateCache());
+    cachedCount = ARRAY_SIZE(cachedAddresses);
+    EXPECT_EQ(STATUS_INVALID_OPERATION, iceCandidateCacheGetLocalIpAddresses(cachedAddresses, &cachedCount, 0));
+    EXPECT_EQ(STATUS_INVALID_OPERATION, iceCandidateCacheTakeSocket(&bindAddress, 0, NULL, 0, &pSocketConnection));
+    EXPECT_EQ(STATUS_INVALID_OPERATION, iceCandidateCacheResolveHost(0, (PCHAR) "127.0.0.1", &ipAddress));
+    EXPECT_EQ(STATUS_SUCCESS, createIceCandidateCache());
+}
+
 } // namespace webrtcclient
 } // namespace video
 } // namespace kinesis
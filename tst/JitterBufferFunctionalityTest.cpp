@@ -458,7 +458,7 @@ TEST_F(JitterBufferFunctionalityTest, fillDataReturnErrorWithImcompleteFrame)
         EXPECT_EQ(STATUS_SUCCESS, jitterBufferPush(mJitterBuffer, mPRtpPackets[i], nullptr));
     }
 
-    EXPECT_EQ(STATUS_HASH_KEY_NOT_PRESENT, jitterBufferFillFrameData(mJitterBuffer, buffer, 2, &filledSize, 0, 1));
+    EXPECT_EQ(STATUS_RTP_JITTER_BUFFER_MISSING_PACKET, jitterBufferFillFrameData(mJitterBuffer, buffer, 2, &filledSize, 0, 1));
 
     clearJitterBufferForTest();
     MEMFREE(buffer);
@@ -1729,6 +1729,189 @@ TEST_F(JitterBufferFunctionalityTest, DoubleOverflowTest)
     clearJitterBufferForTest();
 }
 
+TEST_F(JitterBufferFunctionalityTest, frameLargerThanPacketRingComesInReverse)
+{
+    UINT32 i = 0;
+    UINT32 framePktCount = 3 * JITTER_BUFFER_DEFAULT_PACKET_RING_CAPACITY;
+    UINT32 pktCount = framePktCount + 1;
+    initializeJitterBuffer(2, 0, pktCount);
+
+    // First frame at timestamp 100 spans more sequence numbers than the ring starts with, second frame at timestamp 300
+    // is a single packet that gets delivered when the buffer is closed
+    for (i = 0; i < pktCount; i++) {
+        mPRtpPackets[i]->payloadLength = 1;
+        mPRtpPackets[i]->payload = (PBYTE) MEMALLOC(mPRtpPackets[i]->payloadLength + 1);
+        mPRtpPackets[i]->payload[0] = (BYTE) i;
+        mPRtpPackets[i]->payload[1] = (i == 0 || i == framePktCount) ? 1 : 0;
+        mPRtpPackets[i]->header.timestamp = i == framePktCount ? 300 : 100;
+    }
+
+    mPExpectedFrameArr[0] = (PBYTE) MEMALLOC(framePktCount);
+    for (i = 0; i < framePktCount; i++) {
+        mPExpectedFrameArr[0][i] = (BYTE) i;
+    }
+    mExpectedFrameSizeArr[0] = framePktCount;
+    mPExpectedFrameArr[1] = (PBYTE) MEMALLOC(1);
+    mPExpectedFrameArr[1][0] = (BYTE) framePktCount;
+    mExpectedFrameSizeArr[1] = 1;
+
+    setPayloadToFree();
+
+    // Starting packet first, then the rest of the frame from the tail back so every push fills the gap the parser stopped at
+    EXPECT_EQ(STATUS_SUCCESS, jitterBufferPush(mJitterBuffer, mPRtpPackets[0], nullptr));
+    for (i = framePktCount - 1; i > 0; i--) {
+        EXPECT_EQ(STATUS_SUCCESS, jitterBufferPush(mJitterBuffer, mPRtpPackets[i], nullptr));
+        EXPECT_EQ(0, mReadyFrameIndex);
+    }
+    EXPECT_LE(framePktCount, mJitterBuffer->packetRingCapacity);
+
+    EXPECT_EQ(STATUS_SUCCESS, jitterBufferPush(mJitterBuffer, mPRtpPackets[framePktCount], nullptr));
+    EXPECT_EQ(1, mReadyFrameIndex);
+    EXPECT_EQ(0, mDroppedFrameIndex);
+
+    clearJitterBufferForTest();
+}
+
+TEST_F(JitterBufferFunctionalityTest, stalePacketBehindHeadIsDiscarded)
+{
+    UINT32 i = 0;
+    UINT32 pktCount = 3;
+    BOOL discarded = FALSE;
+    initializeJitterBuffer(2, 0, pktCount);
+
+    for (i = 0; i < pktCount; i++) {
+        mPRtpPackets[i]->payloadLength = 1;
+        mPRtpPackets[i]->payload = (PBYTE) MEMALLOC(mPRtpPackets[i]->payloadLength + 1);
+        mPRtpPackets[i]->payload[0] = (BYTE) i;
+    }
+
+    // Frame "0" at timestamp 100 is made ready by the start of frame "1" at timestamp 200
+    mPRtpPackets[0]->payload[1] = 1;
+    mPRtpPackets[0]->header.timestamp = 100;
+    mPRtpPackets[0]->header.sequenceNumber = JITTER_BUFFER_DEFAULT_PACKET_RING_CAPACITY;
+    mPRtpPackets[1]->payload[1] = 1;
+    mPRtpPackets[1]->header.timestamp = 200;
+    mPRtpPackets[1]->header.sequenceNumber = JITTER_BUFFER_DEFAULT_PACKET_RING_CAPACITY + 1;
+
+    // Far behind the head and mapping to the slot of the head packet
+    mPRtpPackets[2]->payload[1] = 0;
+    mPRtpPackets[2]->header.timestamp = 200;
+    mPRtpPackets[2]->header.sequenceNumber = 1;
+
+    mPExpectedFrameArr[0] = (PBYTE) MEMALLOC(1);
+    mPExpectedFrameArr[0][0] = 0;
+    mExpectedFrameSizeArr[0] = 1;
+    mPExpectedFrameArr[1] = (PBYTE) MEMALLOC(1);
+    mPExpectedFrameArr[1][0] = 1;
+    mExpectedFrameSizeArr[1] = 1;
+
+    setPayloadToFree();
+
+    for (i = 0; i < 2; i++) {
+        EXPECT_EQ(STATUS_SUCCESS, jitterBufferPush(mJitterBuffer, mPRtpPackets[i], &discarded));
+        EXPECT_FALSE(discarded);
+    }
+    EXPECT_EQ(1, mReadyFrameIndex);
+
+    EXPECT_EQ(STATUS_SUCCESS, jitterBufferPush(mJitterBuffer, mPRtpPackets[2], &discarded));
+    EXPECT_TRUE(discarded);
+    EXPECT_EQ(JITTER_BUFFER_DEFAULT_PACKET_RING_CAPACITY, mJitterBuffer->packetRingCapacity);
+    EXPECT_EQ(1, mReadyFrameIndex);
+
+    clearJitterBufferForTest();
+}
+
+TEST_F(JitterBufferFunctionalityTest, expiredPacketIsEvictedInsteadOfGrowingRing)
+{
+    UINT32 i = 0;
+    UINT32 pktCount = 2;
+    BOOL discarded = FALSE;
+    initializeJitterBuffer(1, 1, pktCount);
+
+    for (i = 0; i < pktCount; i++) {
+        mPRtpPackets[i]->payloadLength = 1;
+        mPRtpPackets[i]->payload = (PBYTE) MEMALLOC(mPRtpPackets[i]->payloadLength + 1);
+        mPRtpPackets[i]->payload[0] = (BYTE) i;
+        mPRtpPackets[i]->payload[1] = 1;
+    }
+
+    // Frame at timestamp 100 never completes before the first frame is processed
+    mPRtpPackets[0]->header.timestamp = 100;
+    mPRtpPackets[0]->header.sequenceNumber = 0;
+    // More than the max latency later and mapping to the same slot
+    mPRtpPackets[1]->header.timestamp = 100 + DEFAULT_JITTER_BUFFER_MAX_LATENCY / HUNDREDS_OF_NANOS_IN_A_MILLISECOND + 200;
+    mPRtpPackets[1]->header.sequenceNumber = JITTER_BUFFER_DEFAULT_PACKET_RING_CAPACITY;
+
+    mExpectedDroppedFrameTimestampArr[0] = 100;
+    mPExpectedFrameArr[0] = (PBYTE) MEMALLOC(1);
+    mPExpectedFrameArr[0][0] = 1;
+    mExpectedFrameSizeArr[0] = 1;
+
+    setPayloadToFree();
+
+    for (i = 0; i < pktCount; i++) {
+        EXPECT_EQ(STATUS_SUCCESS, jitterBufferPush(mJitterBuffer, mPRtpPackets[i], &discarded));
+        EXPECT_FALSE(discarded);
+    }
+    EXPECT_EQ(JITTER_BUFFER_DEFAULT_PACKET_RING_CAPACITY, mJitterBuffer->packetRingCapacity);
+    EXPECT_EQ(1, mDroppedFrameIndex);
+
+    // The later frame is delivered when the buffer is closed
+    clearJitterBufferForTest();
+    EXPECT_EQ(1, mReadyFrameIndex);
+}
+
+TEST_F(JitterBufferFunctionalityTest, packetRingGrowthIsBoundedByMaxLatency)
+{
+    UINT32 i = 0, maxPacketRingCapacity;
+    UINT32 pktCount = 6;
+    BOOL discarded = FALSE;
+    initializeJitterBuffer(0, 1, pktCount);
+
+    // The default 2 seconds at the test clock rate
+    maxPacketRingCapacity = mJitterBuffer->maxPacketRingCapacity;
+    EXPECT_LE(DEFAULT_JITTER_BUFFER_MAX_LATENCY / HUNDREDS_OF_NANOS_IN_A_SECOND * JITTER_BUFFER_MAX_PACKET_RATE, maxPacketRingCapacity);
+    EXPECT_GT(JITTER_BUFFER_MAX_PACKET_RING_CAPACITY, maxPacketRingCapacity);
+
+    // Packets of one frame, all within the latency window, that keep colliding in slot 0 until the ring is at its maximum
+    for (i = 0; i < pktCount; i++) {
+        mPRtpPackets[i]->payloadLength = 1;
+        mPRtpPackets[i]->payload = (PBYTE) MEMALLOC(mPRtpPackets[i]->payloadLength + 1);
+        mPRtpPackets[i]->payload[0] = (BYTE) i;
+        mPRtpPackets[i]->payload[1] = i == 0 ? 1 : 0;
+        mPRtpPackets[i]->header.timestamp = 100;
+    }
+    mPRtpPackets[0]->header.sequenceNumber = 0;
+    mPRtpPackets[1]->header.sequenceNumber = (UINT16) (maxPacketRingCapacity / 4);
+    mPRtpPackets[2]->header.sequenceNumber = (UINT16) (maxPacketRingCapacity / 2);
+    mPRtpPackets[3]->header.sequenceNumber = (UINT16) maxPacketRingCapacity;
+    mPRtpPackets[4]->header.sequenceNumber = (UINT16) (2 * maxPacketRingCapacity);
+    // Resent copy of the first packet, older than the one now in its slot
+    mPRtpPackets[5]->header.sequenceNumber = 0;
+
+    mExpectedDroppedFrameTimestampArr[0] = 100;
+
+    setPayloadToFree();
+
+    for (i = 0; i < 4; i++) {
+        EXPECT_EQ(STATUS_SUCCESS, jitterBufferPush(mJitterBuffer, mPRtpPackets[i], &discarded));
+        EXPECT_FALSE(discarded);
+    }
+    EXPECT_EQ(maxPacketRingCapacity, mJitterBuffer->packetRingCapacity);
+
+    // Full, the newer packet takes the slot of the first one
+    EXPECT_EQ(STATUS_SUCCESS, jitterBufferPush(mJitterBuffer, mPRtpPackets[4], &discarded));
+    EXPECT_FALSE(discarded);
+    EXPECT_EQ(maxPacketRingCapacity, mJitterBuffer->packetRingCapacity);
+    EXPECT_EQ(STATUS_SUCCESS, jitterBufferPush(mJitterBuffer, mPRtpPackets[5], &discarded));
+    EXPECT_TRUE(discarded);
+    EXPECT_EQ(maxPacketRingCapacity, mJitterBuffer->packetRingCapacity);
+
+    // The frame lost its first packet and is dropped when the buffer is closed
+    clearJitterBufferForTest();
+    EXPECT_EQ(1, mDroppedFrameIndex);
+}
+
 #if 0
 //TODO complete this test
 TEST_F(JitterBufferFunctionalityTest, LongRunningWithDroppedPacketsTest)
@@ -28,6 +28,77 @@ TEST_F(PeerConnectionFunctionalityTest, connectTwoPeers)
     freePeerConnection(&answerPc);
 }
 
+// Assert that two PeerConnections connect when DTLS starts on the first succeeded pair, before nomination
+TEST_F(PeerConnectionFunctionalityTest, connectTwoPeersWithIceFirstPairFastPath)
+{
+    RtcConfiguration configuration;
+    PRtcPeerConnection offerPc = NULL, answerPc = NULL;
+
+    MEMSET(&configuration, 0x00, SIZEOF(RtcConfiguration));
+    configuration.kvsRtcConfiguration.enableIceFirstPairFastPath = TRUE;
+
+    EXPECT_EQ(createPeerConnection(&configuration, &offerPc), STATUS_SUCCESS);
+    EXPECT_EQ(createPeerConnection(&configuration, &answerPc), STATUS_SUCCESS);
+
+    EXPECT_EQ(connectTwoPeers(offerPc, answerPc), TRUE);
+
+    // data was flowing before ice got ready, the DTLS session is only started once
+    EXPECT_TRUE(((PKvsPeerConnection) offerPc)->dtlsSessionStarted);
+    EXPECT_TRUE(((PKvsPeerConnection) answerPc)->dtlsSessionStarted);
+
+    closePeerConnection(offerPc);
+    closePeerConnection(answerPc);
+
+    freePeerConnection(&offerPc);
+    freePeerConnection(&answerPc);
+}
+
+// Assert that ice settling after DTLS finished on the first succeeded pair does not take the connection back to CONNECTING
+TEST_F(PeerConnectionFunctionalityTest, iceNominatingAfterFirstPairFastPathKeepsConnected)
+{
+    RtcConfiguration configuration;
+    PRtcPeerConnection offerPc = NULL, answerPc = NULL;
+    PKvsPeerConnection pKvsPeerConnection;
+    SIZE_T stateChanges[RTC_PEER_CONNECTION_TOTAL_STATE_COUNT] = {0};
+    UINT64 iceHolePunchingTime;
+
+    MEMSET(&configuration, 0x00, SIZEOF(RtcConfiguration));
+    configuration.kvsRtcConfiguration.enableIceFirstPairFastPath = TRUE;
+
+    EXPECT_EQ(createPeerConnection(&configuration, &offerPc), STATUS_SUCCESS);
+    EXPECT_EQ(createPeerConnection(&configuration, &answerPc), STATUS_SUCCESS);
+
+    EXPECT_EQ(connectTwoPeers(offerPc, answerPc), TRUE);
+
+    pKvsPeerConnection = (PKvsPeerConnection) offerPc;
+    EXPECT_EQ(RTC_PEER_CONNECTION_STATE_CONNECTED, pKvsPeerConnection->connectionState);
+    iceHolePunchingTime = pKvsPeerConnection->peerConnectionDiagnostics.iceHolePunchingTime;
+
+    EXPECT_EQ(STATUS_SUCCESS,
+              peerConnectionOnConnectionStateChange(offerPc, (UINT64) stateChanges, [](UINT64 customData, RTC_PEER_CONNECTION_STATE newState) {
+                  ((PSIZE_T) customData)[newState]++;
+              }));
+
+    // The states ice goes through when it nominates after dtls already finished, or restarts with the old dtls session
+    onIceConnectionStateChange((UINT64) offerPc, ICE_AGENT_STATE_NOMINATING);
+    onIceConnectionStateChange((UINT64) offerPc, ICE_AGENT_STATE_CHECK_CONNECTION);
+    onIceConnectionStateChange((UINT64) offerPc, ICE_AGENT_STATE_READY);
+
+    EXPECT_EQ(0, stateChanges[RTC_PEER_CONNECTION_STATE_CONNECTING]);
+    EXPECT_EQ(RTC_PEER_CONNECTION_STATE_CONNECTED, pKvsPeerConnection->connectionState);
+    EXPECT_EQ(0, pKvsPeerConnection->iceConnectingStartTime);
+    EXPECT_EQ(iceHolePunchingTime, pKvsPeerConnection->peerConnectionDiagnostics.iceHolePunchingTime);
+
+    closePeerConnection(offerPc);
+    closePeerConnection(answerPc);
+
+    // a restart or close lets the next ice session start dtls again
+    EXPECT_FALSE(pKvsPeerConnection->dtlsSessionStarted);
+
+    freePeerConnection(&offerPc);
+    freePeerConnection(&answerPc);
+}
+
 TEST_F(PeerConnectionFunctionalityTest, connectTwoPeersWithDelay)
 {
     RtcConfiguration configuration;
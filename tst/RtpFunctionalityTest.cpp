@@ -595,6 +595,47 @@ TEST_F(RtpFunctionalityTest, trailingZerosWouldBeReturned)
     EXPECT_EQ(7, naluLength);
 }
 
+TEST_F(RtpFunctionalityTest, annexBScannersAgreeWithByteByByteSearch)
+{
+    std::vector<AnnexBStartCodeScanFunc> scanFuncs = {findAnnexBStartCode, findAnnexBStartCodeScalar};
+    BYTE buffer[200];
+    UINT32 i, j, length, expected;
+
+#ifdef KVS_ANNEXB_SCAN_SSE2_SUPPORTED
+    scanFuncs.push_back(findAnnexBStartCodeSse2);
+#endif
+#ifdef KVS_ANNEXB_SCAN_AVX2_SUPPORTED
+    if (annexBScanAvx2Available()) {
+        scanFuncs.push_back(findAnnexBStartCodeAvx2);
+    }
+#endif
+#ifdef KVS_ANNEXB_SCAN_NEON_SUPPORTED
+    scanFuncs.push_back(findAnnexBStartCodeNeon);
+#endif
+
+    // Mostly zeros and ones so that start codes and near misses land on every block boundary
+    SRAND(12345);
+    for (i = 0; i < 20000; i++) {
+        length = RAND() % SIZEOF(buffer);
+        for (j = 0; j < length; j++) {
+            buffer[j] = (RAND() % 8 < 6) ? (BYTE) (RAND() % 2) : (BYTE) RAND();
+        }
+
+        for (expected = 0; expected + 2 < length; expected++) {
+            if (buffer[expected] == 0 && buffer[expected + 1] == 0 && buffer[expected + 2] == 1) {
+                break;
+            }
+        }
+        if (expected + 2 >= length) {
+            expected = length;
+        }
+
+        for (auto scanFunc : scanFuncs) {
+            EXPECT_EQ(expected, scanFunc(buffer, length));
+        }
+    }
+}
+
 // https://tools.ietf.org/html/rfc3550#section-5.3.1
 TEST_F(RtpFunctionalityTest, createPacketWithExtension)
 {
@@ -631,6 +672,208 @@ TEST_F(RtpFunctionalityTest, twccPayload)
     EXPECT_EQ(0, ptr[3]);
 }
 
+TEST_F(RtpFunctionalityTest, singlePassH264PayloadMatchesTwoPass)
+{
+    BYTE nalus[5000];
+    UINT32 naluStarts[] = {0, 20, 2500}, i, payloadLength = 0, payloadSubLenSize = 0;
+    PBYTE payloadBuffer = NULL;
+    PUINT32 payloadSubLength = NULL;
+    PayloadArray payloadArray;
+
+    // A small, a fragmented and a trailing fragmented NALU
+    MEMSET(nalus, 0x42, SIZEOF(nalus));
+    for (i = 0; i < ARRAY_SIZE(naluStarts); i++) {
+        MEMCPY(nalus + naluStarts[i], start4ByteCode, SIZEOF(start4ByteCode));
+        nalus[naluStarts[i] + SIZEOF(start4ByteCode)] = 0x65;
+    }
+
+    EXPECT_EQ(STATUS_SUCCESS, createPayloadForH264(DEFAULT_MTU_SIZE_BYTES, nalus, SIZEOF(nalus), NULL, &payloadLength, NULL, &payloadSubLenSize));
+    payloadBuffer = (PBYTE) MEMALLOC(payloadLength);
+    payloadSubLength = (PUINT32) MEMALLOC(payloadSubLenSize * SIZEOF(UINT32));
+    EXPECT_EQ(STATUS_SUCCESS,
+              createPayloadForH264(DEFAULT_MTU_SIZE_BYTES, nalus, SIZEOF(nalus), payloadBuffer, &payloadLength, payloadSubLength, &payloadSubLenSize));
+
+    // Start from an empty array so it has to grow while being filled
+    MEMSET(&payloadArray, 0x00, SIZEOF(PayloadArray));
+    EXPECT_EQ(STATUS_NULL_ARG, createPayloadArrayForH264(DEFAULT_MTU_SIZE_BYTES, nalus, SIZEOF(nalus), NULL));
+    EXPECT_EQ(STATUS_SUCCESS, createPayloadArrayForH264(DEFAULT_MTU_SIZE_BYTES, nalus, SIZEOF(nalus), &payloadArray));
+    EXPECT_EQ(payloadLength, payloadArray.payloadLength);
+    EXPECT_EQ(payloadSubLenSize, payloadArray.payloadSubLenSize);
+    EXPECT_EQ(0, MEMCMP(payloadBuffer, payloadArray.payloadBuffer, payloadLength));
+    EXPECT_EQ(0, MEMCMP(payloadSubLength, payloadArray.payloadSubLength, payloadSubLenSize * SIZEOF(UINT32)));
+
+    // Refilling keeps the grown arrays
+    EXPECT_EQ(STATUS_SUCCESS, createPayloadArrayForH264(DEFAULT_MTU_SIZE_BYTES, nalus, naluStarts[1], &payloadArray));
+    EXPECT_EQ(1, payloadArray.payloadSubLenSize);
+    EXPECT_EQ(naluStarts[1] - SIZEOF(start4ByteCode), payloadArray.payloadLength);
+    EXPECT_LE(payloadLength, payloadArray.maxPayloadLength);
+
+    SAFE_MEMFREE(payloadBuffer);
+    SAFE_MEMFREE(payloadSubLength);
+    SAFE_MEMFREE(payloadArray.payloadBuffer);
+    SAFE_MEMFREE(payloadArray.payloadSubLength);
+}
+
+TEST_F(RtpFunctionalityTest, singlePassPayloadForUnscannedCodecs)
+{
+    BYTE frame[3000];
+    UINT32 i;
+    PayloadArray payloadArray;
+
+    for (i = 0; i < SIZEOF(frame); i++) {
+        frame[i] = (BYTE) i;
+    }
+    MEMSET(&payloadArray, 0x00, SIZEOF(PayloadArray));
+
+    EXPECT_EQ(STATUS_SUCCESS, createPayloadArrayForVP8(DEFAULT_MTU_SIZE_BYTES, frame, SIZEOF(frame), &payloadArray));
+    EXPECT_EQ(3, payloadArray.payloadSubLenSize);
+    EXPECT_EQ(SIZEOF(frame) + 3 * VP8_PAYLOAD_DESCRIPTOR_SIZE, payloadArray.payloadLength);
+    EXPECT_EQ(VP8_PAYLOAD_DESCRIPTOR_START_OF_PARTITION_VALUE, payloadArray.payloadBuffer[0]);
+    EXPECT_EQ(0, MEMCMP(frame, payloadArray.payloadBuffer + VP8_PAYLOAD_DESCRIPTOR_SIZE, DEFAULT_MTU_SIZE_BYTES - VP8_PAYLOAD_DESCRIPTOR_SIZE));
+
+    EXPECT_EQ(STATUS_SUCCESS, createPayloadArrayForG711(DEFAULT_MTU_SIZE_BYTES, frame, SIZEOF(frame), &payloadArray));
+    EXPECT_EQ(3, payloadArray.payloadSubLenSize);
+    EXPECT_EQ(SIZEOF(frame), payloadArray.payloadLength);
+    EXPECT_EQ(SIZEOF(frame) - 2 * DEFAULT_MTU_SIZE_BYTES, payloadArray.payloadSubLength[2]);
+    EXPECT_EQ(0, MEMCMP(frame, payloadArray.payloadBuffer, SIZEOF(frame)));
+
+    EXPECT_EQ(STATUS_SUCCESS, createPayloadArrayForOpus(DEFAULT_MTU_SIZE_BYTES, frame, 100, &payloadArray));
+    EXPECT_EQ(1, payloadArray.payloadSubLenSize);
+    EXPECT_EQ(100, payloadArray.payloadSubLength[0]);
+    EXPECT_EQ(0, MEMCMP(frame, payloadArray.payloadBuffer, 100));
+
+    SAFE_MEMFREE(payloadArray.payloadBuffer);
+    SAFE_MEMFREE(payloadArray.payloadSubLength);
+}
+
+static VOID expectIovDepayMatchesCopy(PPayloadArray pPayloadArray, DepayRtpPayloadFunc depayFunc, DepayRtpPayloadIovFunc depayIovFunc)
+{
+    std::vector<BYTE> copied, gathered;
+    BYTE depayload[DEFAULT_MTU_SIZE_BYTES * 2];
+    UINT32 i, offset = 0, depayloadSize;
+    BOOL isStart = FALSE;
+    FrameIovArray frameIovArray;
+
+    MEMSET(&frameIovArray, 0x00, SIZEOF(FrameIovArray));
+    EXPECT_EQ(STATUS_SUCCESS, frameIovArrayReserve(&frameIovArray, 0, pPayloadArray->payloadSubLenSize * DEPAY_IOV_MAX_SCRATCH_PER_PACKET));
+
+    for (i = 0; i < pPayloadArray->payloadSubLenSize; i++) {
+        depayloadSize = SIZEOF(depayload);
+        EXPECT_EQ(STATUS_SUCCESS,
+                  depayFunc(pPayloadArray->payloadBuffer + offset, pPayloadArray->payloadSubLength[i], depayload, &depayloadSize, &isStart));
+        copied.insert(copied.end(), depayload, depayload + depayloadSize);
+        EXPECT_EQ(STATUS_SUCCESS, depayIovFunc(pPayloadArray->payloadBuffer + offset, pPayloadArray->payloadSubLength[i], &frameIovArray));
+        offset += pPayloadArray->payloadSubLength[i];
+    }
+
+    for (i = 0; i < frameIovArray.iovCount; i++) {
+        gathered.insert(gathered.end(), frameIovArray.pIovs[i].pData, frameIovArray.pIovs[i].pData + frameIovArray.pIovs[i].size);
+    }
+    EXPECT_EQ(copied, gathered);
+
+    SAFE_MEMFREE(frameIovArray.pIovs);
+    SAFE_MEMFREE(frameIovArray.pScratch);
+}
+
+TEST_F(RtpFunctionalityTest, iovDepayMatchesCopyDepay)
+{
+    BYTE frame[5000];
+    UINT32 naluStarts[] = {0, 20, 40, 2500}, i;
+    PayloadArray payloadArray;
+
+    MEMSET(&payloadArray, 0x00, SIZEOF(PayloadArray));
+
+    // Two NALUs small enough to be aggregated, a fragmented and a trailing fragmented NALU
+    MEMSET(frame, 0x42, SIZEOF(frame));
+    for (i = 0; i < ARRAY_SIZE(naluStarts); i++) {
+        MEMCPY(frame + naluStarts[i], start4ByteCode, SIZEOF(start4ByteCode));
+        frame[naluStarts[i] + SIZEOF(start4ByteCode)] = 0x65;
+    }
+    EXPECT_EQ(STATUS_SUCCESS, createPayloadArrayForH264(DEFAULT_MTU_SIZE_BYTES, frame, SIZEOF(frame), &payloadArray));
+    expectIovDepayMatchesCopy(&payloadArray, depayH264FromRtpPayload, depayH264IovFromRtpPayload);
+
+    for (i = 0; i < ARRAY_SIZE(naluStarts); i++) {
+        frame[naluStarts[i] + SIZEOF(start4ByteCode)] = 0x26;
+        frame[naluStarts[i] + SIZEOF(start4ByteCode) + 1] = 0x01;
+    }
+    EXPECT_EQ(STATUS_SUCCESS, createPayloadArrayForH265(DEFAULT_MTU_SIZE_BYTES, frame, SIZEOF(frame), &payloadArray));
+    expectIovDepayMatchesCopy(&payloadArray, depayH265FromRtpPayload, depayH265IovFromRtpPayload);
+
+    for (i = 0; i < SIZEOF(frame); i++) {
+        frame[i] = (BYTE) i;
+    }
+    EXPECT_EQ(STATUS_SUCCESS, createPayloadArrayForVP8(DEFAULT_MTU_SIZE_BYTES, frame, SIZEOF(frame), &payloadArray));
+    expectIovDepayMatchesCopy(&payloadArray, depayVP8FromRtpPayload, depayVP8IovFromRtpPayload);
+
+    EXPECT_EQ(STATUS_SUCCESS, createPayloadArrayForG711(DEFAULT_MTU_SIZE_BYTES, frame, SIZEOF(frame), &payloadArray));
+    expectIovDepayMatchesCopy(&payloadArray, depayG711FromRtpPayload, depayG711IovFromRtpPayload);
+
+    SAFE_MEMFREE(payloadArray.payloadBuffer);
+    SAFE_MEMFREE(payloadArray.payloadSubLength);
+}
+
+TEST_F(RtpFunctionalityTest, writeFrameToTransceiversPacketizesOncePerCodec)
+{
+    RtcConfiguration config{};
+    RtcMediaStreamTrack videoTrack{}, audioTrack{};
+    PRtcPeerConnection peerConnections[5] = {nullptr};
+    PRtcRtpTransceiver transceivers[5] = {nullptr};
+    STATUS statuses[5];
+    BYTE frameData[3000];
+    Frame frame{};
+    PRtpBroadcast pRtpBroadcast;
+    UINT32 i;
+
+    videoTrack.codec = RTC_CODEC_H264_PROFILE_42E01F_LEVEL_ASYMMETRY_ALLOWED_PACKETIZATION_MODE;
+    videoTrack.kind = MEDIA_STREAM_TRACK_KIND_VIDEO;
+    audioTrack.codec = RTC_CODEC_OPUS;
+    audioTrack.kind = MEDIA_STREAM_TRACK_KIND_AUDIO;
+
+    MEMSET(frameData, 0x11, SIZEOF(frameData));
+    MEMCPY(frameData, start4ByteCode, SIZEOF(start4ByteCode));
+    frame.frameData = frameData;
+    frame.size = SIZEOF(frameData);
+    frame.presentationTs = HUNDREDS_OF_NANOS_IN_A_SECOND;
+
+    // The last peer sends audio, everybody else the same video
+    for (i = 0; i < ARRAY_SIZE(peerConnections); i++) {
+        EXPECT_EQ(STATUS_SUCCESS, createPeerConnection(&config, &peerConnections[i]));
+        EXPECT_EQ(STATUS_SUCCESS,
+                  ::addTransceiver(peerConnections[i], i == ARRAY_SIZE(peerConnections) - 1 ? &audioTrack : &videoTrack, nullptr, &transceivers[i]));
+    }
+
+    EXPECT_EQ(STATUS_NULL_ARG, writeFrameToTransceivers(nullptr, ARRAY_SIZE(transceivers), &frame, nullptr));
+    EXPECT_EQ(STATUS_NULL_ARG, writeFrameToTransceivers(transceivers, ARRAY_SIZE(transceivers), nullptr, nullptr));
+    EXPECT_EQ(STATUS_SUCCESS, writeFrameToTransceivers(transceivers, 0, &frame, nullptr));
+
+    // None of the peers is connected, which is not reported as a failure of the whole call
+    EXPECT_EQ(STATUS_SUCCESS, writeFrameToTransceivers(transceivers, ARRAY_SIZE(transceivers), &frame, statuses));
+    for (i = 0; i < ARRAY_SIZE(transceivers); i++) {
+        EXPECT_EQ(STATUS_SRTP_NOT_READY_YET, statuses[i]);
+    }
+
+    // The frame got packetized once for video and once for audio into the pooled broadcast, the transceivers' own
+    // payload arrays are left to concurrent writeFrame calls
+    pRtpBroadcast = getRtpBroadcastPoolInstance()->pFreeList;
+    ASSERT_TRUE(pRtpBroadcast != NULL);
+    EXPECT_EQ(2, pRtpBroadcast->payloadArrayCount);
+    EXPECT_LT(0, pRtpBroadcast->payloadArrays[0].payloadSubLenSize);
+    EXPECT_LT(0, pRtpBroadcast->payloadArrays[1].payloadSubLenSize);
+    for (i = 0; i < ARRAY_SIZE(transceivers); i++) {
+        EXPECT_EQ(0, reinterpret_cast<PKvsRtpTransceiver>(transceivers[i])->sender.payloadArray.payloadSubLenSize);
+    }
+
+    // The next frame reuses the pooled broadcast instead of creating one
+    EXPECT_EQ(STATUS_SUCCESS, writeFrameToTransceivers(transceivers, ARRAY_SIZE(transceivers), &frame, statuses));
+    EXPECT_EQ(pRtpBroadcast, getRtpBroadcastPoolInstance()->pFreeList);
+    EXPECT_EQ(NULL, pRtpBroadcast->pNext);
+
+    for (i = 0; i < ARRAY_SIZE(peerConnections); i++) {
+        closePeerConnection(peerConnections[i]);
+        EXPECT_EQ(STATUS_SUCCESS, freePeerConnection(&peerConnections[i]));
+    }
+}
+
 } // namespace webrtcclient
 } // namespace video
 } // namespace kinesis
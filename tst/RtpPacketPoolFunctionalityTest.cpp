@@ -0,0 +1,150 @@
+#include "WebRTCClientTestFixture.h"
+
+namespace com {
+namespace amazonaws {
+namespace kinesis {
+namespace video {
+namespace webrtcclient {
+
+class RtpPacketPoolFunctionalityTest : public WebRtcClientTestBase {
+};
+
+TEST_F(RtpPacketPoolFunctionalityTest, createAndFreeInvalidArgs)
+{
+    PRtpPacketPool pRtpPacketPool = NULL;
+
+    EXPECT_EQ(STATUS_NULL_ARG, createRtpPacketPool(100, 4, NULL));
+    EXPECT_EQ(STATUS_INVALID_ARG, createRtpPacketPool(0, 4, &pRtpPacketPool));
+    EXPECT_EQ(STATUS_INVALID_ARG, createRtpPacketPool(100, 0, &pRtpPacketPool));
+    EXPECT_EQ(STATUS_NULL_ARG, freeRtpPacketPool(NULL));
+    EXPECT_EQ(STATUS_SUCCESS, freeRtpPacketPool(&pRtpPacketPool));
+    EXPECT_EQ(STATUS_NULL_ARG, rtpPacketPoolGetPacket(NULL, 10, NULL));
+    EXPECT_EQ(STATUS_NULL_ARG, rtpPacketPoolRetainPacket(NULL));
+    EXPECT_EQ(STATUS_NULL_ARG, rtpPacketPoolReleasePacket(NULL));
+}
+
+TEST_F(RtpPacketPoolFunctionalityTest, releasedPacketIsReused)
+{
+    PRtpPacketPool pRtpPacketPool = NULL;
+    PRtpPacket pRtpPacket = NULL, pFirstPacket = NULL;
+
+    EXPECT_EQ(STATUS_SUCCESS, createRtpPacketPool(100, 4, &pRtpPacketPool));
+    EXPECT_EQ(STATUS_SUCCESS, rtpPacketPoolGetPacket(pRtpPacketPool, 100, &pRtpPacket));
+    EXPECT_EQ(pRtpPacketPool, pRtpPacket->pPacketPool);
+    EXPECT_TRUE(pRtpPacket->pRawPacket != NULL);
+    EXPECT_EQ(4, pRtpPacketPool->slotCount);
+    EXPECT_EQ(1, pRtpPacketPool->slotsInUse);
+    pFirstPacket = pRtpPacket;
+
+    EXPECT_EQ(STATUS_SUCCESS, freeRtpPacket(&pRtpPacket));
+    EXPECT_TRUE(pRtpPacket == NULL);
+    EXPECT_EQ(0, pRtpPacketPool->slotsInUse);
+
+    EXPECT_EQ(STATUS_SUCCESS, rtpPacketPoolGetPacket(pRtpPacketPool, 50, &pRtpPacket));
+    EXPECT_EQ(pFirstPacket, pRtpPacket);
+    EXPECT_EQ(STATUS_SUCCESS, freeRtpPacket(&pRtpPacket));
+
+    EXPECT_EQ(STATUS_SUCCESS, freeRtpPacketPool(&pRtpPacketPool));
+    EXPECT_TRUE(pRtpPacketPool == NULL);
+}
+
+TEST_F(RtpPacketPoolFunctionalityTest, poolGrowsAndHandlesOversizedPackets)
+{
+    PRtpPacketPool pRtpPacketPool = NULL;
+    PRtpPacket packets[5], pOversizedPacket = NULL;
+    UINT32 i;
+
+    EXPECT_EQ(STATUS_SUCCESS, createRtpPacketPool(100, 4, &pRtpPacketPool));
+    for (i = 0; i < ARRAY_SIZE(packets); i++) {
+        EXPECT_EQ(STATUS_SUCCESS, rtpPacketPoolGetPacket(pRtpPacketPool, 100, &packets[i]));
+        MEMSET(packets[i]->pRawPacket, (BYTE) i, 100);
+    }
+    EXPECT_EQ(8, pRtpPacketPool->slotCount);
+    EXPECT_EQ(5, pRtpPacketPool->slotsInUse);
+
+    EXPECT_EQ(STATUS_SUCCESS, rtpPacketPoolGetPacket(pRtpPacketPool, 1000, &pOversizedPacket));
+    MEMSET(pOversizedPacket->pRawPacket, 0xFF, 1000);
+    EXPECT_EQ(8, pRtpPacketPool->slotCount);
+    EXPECT_EQ(5, pRtpPacketPool->slotsInUse);
+    EXPECT_EQ(STATUS_SUCCESS, freeRtpPacket(&pOversizedPacket));
+
+    for (i = 0; i < ARRAY_SIZE(packets); i++) {
+        EXPECT_EQ((BYTE) i, packets[i]->pRawPacket[99]);
+        EXPECT_EQ(STATUS_SUCCESS, freeRtpPacket(&packets[i]));
+    }
+    EXPECT_EQ(0, pRtpPacketPool->slotsInUse);
+
+    EXPECT_EQ(STATUS_SUCCESS, freeRtpPacketPool(&pRtpPacketPool));
+}
+
+TEST_F(RtpPacketPoolFunctionalityTest, rollingBufferSharesPooledPacket)
+{
+    PRtpPacketPool pRtpPacketPool = NULL;
+    PRtpRollingBuffer pRtpRollingBuffer = NULL;
+    PRtpPacket pRtpPacket = NULL, pBufferedPacket = NULL;
+    BYTE payload[10] = {0};
+    UINT32 packetLen = 100;
+
+    EXPECT_EQ(STATUS_SUCCESS, createRtpPacketPool(100, 4, &pRtpPacketPool));
+    EXPECT_EQ(STATUS_SUCCESS, createRtpRollingBuffer(2, &pRtpRollingBuffer));
+
+    EXPECT_EQ(STATUS_SUCCESS, rtpPacketPoolGetPacket(pRtpPacketPool, packetLen, &pRtpPacket));
+    EXPECT_EQ(STATUS_SUCCESS,
+              setRtpPacket(2, FALSE, FALSE, 0, FALSE, 96, 42, 100, 0x1234, NULL, 0, 0, NULL, payload, SIZEOF(payload), pRtpPacket));
+    EXPECT_EQ(STATUS_SUCCESS, createBytesFromRtpPacket(pRtpPacket, pRtpPacket->pRawPacket, &packetLen));
+    pRtpPacket->rawPacketLength = packetLen;
+    EXPECT_EQ(STATUS_SUCCESS, setRtpPacketFromBytes(pRtpPacket->pRawPacket, packetLen, pRtpPacket));
+    EXPECT_EQ(STATUS_SUCCESS, rtpRollingBufferAddRtpPacket(pRtpRollingBuffer, pRtpPacket));
+
+    // Sender drops its reference, the rolling buffer still holds the same packet
+    pBufferedPacket = pRtpPacket;
+    EXPECT_EQ(STATUS_SUCCESS, freeRtpPacket(&pRtpPacket));
+    EXPECT_EQ(1, pRtpPacketPool->slotsInUse);
+    EXPECT_EQ((UINT64) pBufferedPacket, pRtpRollingBuffer->pRollingBuffer->dataBuffer[0]);
+    EXPECT_EQ(42, pBufferedPacket->header.sequenceNumber);
+
+    EXPECT_EQ(STATUS_SUCCESS, freeRtpRollingBuffer(&pRtpRollingBuffer));
+    EXPECT_EQ(0, pRtpPacketPool->slotsInUse);
+    EXPECT_EQ(STATUS_SUCCESS, freeRtpPacketPool(&pRtpPacketPool));
+}
+
+TEST_F(RtpPacketPoolFunctionalityTest, jitterBufferHoldsReceivedPacketsInPool)
+{
+    RtcConfiguration config{};
+    RtcMediaStreamTrack videoTrack{};
+    PRtcPeerConnection pRtcPeerConnection = NULL;
+    PRtcRtpTransceiver pRtcRtpTransceiver = NULL;
+    PKvsRtpTransceiver pKvsRtpTransceiver = NULL;
+    PRtpPacket pRtpPacket = NULL;
+    BYTE payload[10] = {0x10};
+    UINT32 packetLen = 100;
+    BOOL discarded = FALSE;
+
+    videoTrack.codec = RTC_CODEC_VP8;
+    videoTrack.kind = MEDIA_STREAM_TRACK_KIND_VIDEO;
+    EXPECT_EQ(STATUS_SUCCESS, createPeerConnection(&config, &pRtcPeerConnection));
+    EXPECT_EQ(STATUS_SUCCESS, ::addTransceiver(pRtcPeerConnection, &videoTrack, NULL, &pRtcRtpTransceiver));
+    pKvsRtpTransceiver = reinterpret_cast<PKvsRtpTransceiver>(pRtcRtpTransceiver);
+    ASSERT_TRUE(pKvsRtpTransceiver->receivePacketPool != NULL);
+
+    EXPECT_EQ(STATUS_SUCCESS, rtpPacketPoolGetPacket(pKvsRtpTransceiver->receivePacketPool, packetLen, &pRtpPacket));
+    EXPECT_EQ(STATUS_SUCCESS,
+              setRtpPacket(2, FALSE, FALSE, 0, TRUE, 96, 1, 100, 0x1234, NULL, 0, 0, NULL, payload, SIZEOF(payload), pRtpPacket));
+    EXPECT_EQ(STATUS_SUCCESS, createBytesFromRtpPacket(pRtpPacket, pRtpPacket->pRawPacket, &packetLen));
+    pRtpPacket->rawPacketLength = packetLen;
+    EXPECT_EQ(STATUS_SUCCESS, setRtpPacketFromBytes(pRtpPacket->pRawPacket, packetLen, pRtpPacket));
+
+    // The jitter buffer takes the pooled packet as is, the slot stays in use until it is done with it
+    EXPECT_EQ(STATUS_SUCCESS, jitterBufferPush(pKvsRtpTransceiver->pJitterBuffer, pRtpPacket, &discarded));
+    EXPECT_FALSE(discarded);
+    EXPECT_EQ(1, pKvsRtpTransceiver->receivePacketPool->slotsInUse);
+
+    closePeerConnection(pRtcPeerConnection);
+    EXPECT_EQ(STATUS_SUCCESS, freePeerConnection(&pRtcPeerConnection));
+}
+
+} // namespace webrtcclient
+} // namespace video
+} // namespace kinesis
+} // namespace amazonaws
+} // namespace com
@@ -76,6 +76,65 @@ TEST_F(SrtpApiTest, noSrtpKeyReturnsFailure)
     EXPECT_EQ(STATUS_SUCCESS, freeSrtpSession(&pSrtpSession));
 }
 
+TEST_F(SrtpApiTest, isProfileSupported)
+{
+    BOOL supported = FALSE;
+
+    EXPECT_EQ(STATUS_NULL_ARG, srtpSessionIsProfileSupported(KVS_SRTP_PROFILE_AES128_CM_HMAC_SHA1_80, NULL));
+
+    // every libsrtp has the AES-CM profiles
+    EXPECT_EQ(STATUS_SUCCESS, srtpSessionIsProfileSupported(KVS_SRTP_PROFILE_AES128_CM_HMAC_SHA1_80, &supported));
+    EXPECT_TRUE(supported);
+    EXPECT_EQ(STATUS_SUCCESS, srtpSessionIsProfileSupported(KVS_SRTP_PROFILE_AES128_CM_HMAC_SHA1_32, &supported));
+    EXPECT_TRUE(supported);
+
+    EXPECT_EQ(STATUS_SUCCESS, srtpSessionIsProfileSupported((KVS_SRTP_PROFILE) 0, &supported));
+    EXPECT_FALSE(supported);
+}
+
+#ifdef KVS_USE_OPENSSL
+TEST_F(SrtpApiTest, encryptDecryptWithAeadProfiles)
+{
+    // master key followed by the 12 byte salt, sized for AES-256
+    BYTE key[32 + 12];
+    KVS_SRTP_PROFILE profiles[] = {KVS_SRTP_PROFILE_AEAD_AES_128_GCM, KVS_SRTP_PROFILE_AEAD_AES_256_GCM};
+    PSrtpSession pSrtpSession = NULL;
+    PBYTE rtpPacket = (PBYTE) MEMCALLOC(1, SIZEOF(SKEL_RTP_PACKET) + SRTP_MAX_TRAILER_LEN);
+    INT32 len;
+    UINT32 i;
+    BOOL supported;
+
+    for (i = 0; i < SIZEOF(key); i++) {
+        key[i] = (BYTE) i;
+    }
+
+    for (i = 0; i < ARRAY_SIZE(profiles); i++) {
+        // a system libsrtp may be built without AES-GCM, DTLS does not offer the profiles then
+        EXPECT_EQ(STATUS_SUCCESS, srtpSessionIsProfileSupported(profiles[i], &supported));
+        if (!supported) {
+            continue;
+        }
+
+        EXPECT_EQ(STATUS_SUCCESS, initSrtpSession(key, key, profiles[i], &pSrtpSession));
+
+        len = SIZEOF(SKEL_RTP_PACKET);
+        MEMCPY(rtpPacket, SKEL_RTP_PACKET, SIZEOF(SKEL_RTP_PACKET));
+        EXPECT_EQ(STATUS_SUCCESS, encryptRtpPacket(pSrtpSession, rtpPacket, &len));
+        // the GCM tag is 16 bytes, which the send path reserves
+        EXPECT_EQ(len, SIZEOF(SKEL_RTP_PACKET) + SRTP_AUTH_TAG_OVERHEAD);
+        EXPECT_NE(0, MEMCMP(rtpPacket + 12, SKEL_RTP_PACKET + 12, SIZEOF(SKEL_RTP_PACKET) - 12));
+
+        EXPECT_EQ(STATUS_SUCCESS, decryptSrtpPacket(pSrtpSession, rtpPacket, &len));
+        EXPECT_EQ(len, SIZEOF(SKEL_RTP_PACKET));
+        EXPECT_EQ(0, MEMCMP(rtpPacket, SKEL_RTP_PACKET, SIZEOF(SKEL_RTP_PACKET)));
+
+        EXPECT_EQ(STATUS_SUCCESS, freeSrtpSession(&pSrtpSession));
+    }
+
+    MEMFREE(rtpPacket);
+}
+#endif
+
 } // namespace webrtcclient
 } // namespace video
 } // namespace kinesis
@@ -693,6 +693,151 @@ TEST_F(StunFunctionalityTest, deserializeStunErrorCode)
     EXPECT_EQ(STATUS_SUCCESS, freeStunPacket(&pStunPacket));
 }
 
+static STATUS computeReferenceSha1Hmac(PBYTE key, UINT32 keyLen, PBYTE pMessage, UINT32 messageLen, PBYTE pHmac)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    UINT32 hmacLen;
+
+    KVS_SHA1_HMAC(key, keyLen, pMessage, messageLen, pHmac, &hmacLen);
+
+CleanUp:
+
+    return retStatus;
+}
+
+TEST_F(StunFunctionalityTest, hmacKeyMatchesHmac)
+{
+    KvsSha1HmacKey hmacKey;
+    BYTE key[2 * KVS_SHA1_BLOCK_LENGTH], message[512], expected[KVS_SHA1_DIGEST_LENGTH], actual[KVS_SHA1_DIGEST_LENGTH];
+    UINT32 keyLens[] = {1, 32, KVS_SHA1_BLOCK_LENGTH, KVS_SHA1_BLOCK_LENGTH + 1, SIZEOF(key)}, messageLens[] = {0, 20, 64, 65, SIZEOF(message)};
+    UINT32 i, j;
+
+    for (i = 0; i < SIZEOF(key); i++) {
+        key[i] = (BYTE) RAND();
+    }
+    for (i = 0; i < SIZEOF(message); i++) {
+        message[i] = (BYTE) RAND();
+    }
+
+    for (i = 0; i < ARRAY_SIZE(keyLens); i++) {
+        EXPECT_EQ(STATUS_SUCCESS, kvsSha1HmacKeyInit(&hmacKey, key, keyLens[i]));
+        for (j = 0; j < ARRAY_SIZE(messageLens); j++) {
+            EXPECT_EQ(STATUS_SUCCESS, computeReferenceSha1Hmac(key, keyLens[i], message, messageLens[j], expected));
+            EXPECT_EQ(STATUS_SUCCESS, kvsSha1HmacKeyCompute(&hmacKey, message, messageLens[j], actual));
+            EXPECT_EQ(0, MEMCMP(expected, actual, KVS_SHA1_DIGEST_LENGTH));
+        }
+    }
+
+    EXPECT_NE(STATUS_SUCCESS, kvsSha1HmacKeyInit(NULL, key, 1));
+    EXPECT_NE(STATUS_SUCCESS, kvsSha1HmacKeyInit(&hmacKey, NULL, 1));
+    EXPECT_NE(STATUS_SUCCESS, kvsSha1HmacKeyCompute(NULL, message, 1, actual));
+    EXPECT_NE(STATUS_SUCCESS, kvsSha1HmacKeyCompute(&hmacKey, message, 1, NULL));
+}
+
+TEST_F(StunFunctionalityTest, packageBindingResponseMatchesSerialize)
+{
+    PStunPacket pStunPacket = NULL, pDecodedPacket = NULL;
+    KvsSha1HmacKey hmacKey;
+    KvsIpAddress address;
+    BYTE transactionId[STUN_TRANSACTION_ID_LEN], expected[STUN_PACKET_ALLOCATION_SIZE], actual[STUN_BINDING_RESPONSE_MAX_LEN];
+    UINT64 storage[STUN_PACKET_ALLOCATION_SIZE / SIZEOF(UINT64)];
+    UINT32 i, expectedSize, actualSize;
+    PStunAttributeHeader pStunAttr = NULL;
+
+    EXPECT_EQ(STATUS_SUCCESS, kvsSha1HmacKeyInit(&hmacKey, (PBYTE) TEST_STUN_PASSWORD, STRLEN(TEST_STUN_PASSWORD)));
+    EXPECT_EQ(STATUS_SUCCESS, iceUtilsGenerateTransactionId(transactionId, ARRAY_SIZE(transactionId)));
+
+    for (i = 0; i < 2; i++) {
+        MEMSET(&address, 0x00, SIZEOF(KvsIpAddress));
+        address.family = i == 0 ? KVS_IP_FAMILY_TYPE_IPV4 : KVS_IP_FAMILY_TYPE_IPV6;
+        address.port = (UINT16) getInt16(12345);
+        MEMSET(address.address, 0x5a, SIZEOF(address.address));
+        address.address[0] = 10;
+
+        EXPECT_EQ(STATUS_SUCCESS, createStunPacket(STUN_PACKET_TYPE_BINDING_RESPONSE_SUCCESS, transactionId, &pStunPacket));
+        EXPECT_EQ(STATUS_SUCCESS, appendStunAddressAttribute(pStunPacket, STUN_ATTRIBUTE_TYPE_XOR_MAPPED_ADDRESS, &address));
+        EXPECT_EQ(STATUS_SUCCESS, appendStunIceControllAttribute(pStunPacket, STUN_ATTRIBUTE_TYPE_ICE_CONTROLLED, 0x0123456789abcdefULL));
+        expectedSize = SIZEOF(expected);
+        EXPECT_EQ(STATUS_SUCCESS,
+                  iceUtilsPackageStunPacket(pStunPacket, (PBYTE) TEST_STUN_PASSWORD, STRLEN(TEST_STUN_PASSWORD), expected, &expectedSize));
+        EXPECT_EQ(STATUS_SUCCESS, freeStunPacket(&pStunPacket));
+
+        actualSize = SIZEOF(actual);
+        EXPECT_EQ(STATUS_SUCCESS,
+                  stunPackageBindingResponse(transactionId, &address, STUN_ATTRIBUTE_TYPE_ICE_CONTROLLED, 0x0123456789abcdefULL, &hmacKey, actual,
+                                             &actualSize));
+        EXPECT_EQ(expectedSize, actualSize);
+        EXPECT_EQ(0, MEMCMP(expected, actual, actualSize));
+
+        // Decodes into the storage and validates with the same key
+        EXPECT_EQ(STATUS_SUCCESS,
+                  deserializeStunPacketWithHmacKey(actual, actualSize, &hmacKey, (PStunPacket) storage, SIZEOF(storage), &pDecodedPacket));
+        EXPECT_EQ((PStunPacket) storage, pDecodedPacket);
+        EXPECT_EQ(STATUS_SUCCESS, getStunAttribute(pDecodedPacket, STUN_ATTRIBUTE_TYPE_XOR_MAPPED_ADDRESS, &pStunAttr));
+        EXPECT_TRUE(pStunAttr != NULL);
+
+        // Too small a storage falls back to the heap
+        EXPECT_EQ(STATUS_SUCCESS, deserializeStunPacketWithHmacKey(actual, actualSize, &hmacKey, (PStunPacket) storage, SIZEOF(StunPacket),
+                                                                   &pDecodedPacket));
+        EXPECT_NE((PStunPacket) storage, pDecodedPacket);
+        EXPECT_EQ(STATUS_SUCCESS, freeStunPacket(&pDecodedPacket));
+
+        // A corrupted packet fails the integrity check and returns no packet
+        actual[STUN_HEADER_LEN + STUN_ATTRIBUTE_HEADER_LEN + STUN_ATTRIBUTE_ADDRESS_HEADER_LEN] ^= 0xff;
+        EXPECT_EQ(STATUS_STUN_MESSAGE_INTEGRITY_MISMATCH,
+                  deserializeStunPacketWithHmacKey(actual, actualSize, &hmacKey, (PStunPacket) storage, SIZEOF(storage), &pDecodedPacket));
+        EXPECT_TRUE(pDecodedPacket == NULL);
+    }
+
+    actualSize = STUN_BINDING_RESPONSE_MAX_LEN - 1;
+    EXPECT_NE(STATUS_SUCCESS,
+              stunPackageBindingResponse(transactionId, &address, STUN_ATTRIBUTE_TYPE_ICE_CONTROLLED, 0, &hmacKey, actual, &actualSize));
+    actualSize = SIZEOF(actual);
+    EXPECT_NE(STATUS_SUCCESS, stunPackageBindingResponse(transactionId, &address, STUN_ATTRIBUTE_TYPE_PRIORITY, 0, &hmacKey, actual, &actualSize));
+    EXPECT_NE(STATUS_SUCCESS, stunPackageBindingResponse(transactionId, &address, STUN_ATTRIBUTE_TYPE_ICE_CONTROLLED, 0, NULL, actual, &actualSize));
+}
+
+TEST_F(StunFunctionalityTest, crc32ImplementationsMatchComputeCrc32)
+{
+    std::vector<StunCrc32Func> crc32Funcs = {stunCrc32, stunCrc32SliceBy8};
+    BYTE buffer[1024 + 8];
+    UINT32 i, offset, length;
+
+#ifdef KVS_STUN_CRC32_PCLMUL_SUPPORTED
+    if (stunCrc32PclmulAvailable()) {
+        crc32Funcs.push_back(stunCrc32Pclmul);
+    }
+#endif
+#ifdef KVS_STUN_CRC32_ARMV8_SUPPORTED
+    if (stunCrc32Armv8Available()) {
+        crc32Funcs.push_back(stunCrc32Armv8);
+    }
+#endif
+
+    SRAND(12345);
+    for (i = 0; i < SIZEOF(buffer); i++) {
+        buffer[i] = (BYTE) RAND();
+    }
+
+    // Every length around the folding and slicing block sizes, from misaligned starts
+    for (offset = 0; offset < 8; offset++) {
+        for (length = 0; length <= 300; length++) {
+            for (auto crc32Func : crc32Funcs) {
+                EXPECT_EQ(COMPUTE_CRC32(buffer + offset, length), crc32Func(buffer + offset, length));
+            }
+        }
+
+        for (auto crc32Func : crc32Funcs) {
+            EXPECT_EQ(COMPUTE_CRC32(buffer + offset, 1024), crc32Func(buffer + offset, 1024));
+        }
+    }
+
+    // Check value of the crc32 used by the FINGERPRINT attribute
+    for (auto crc32Func : crc32Funcs) {
+        EXPECT_EQ(0xcbf43926, crc32Func((PBYTE) "123456789", 9));
+    }
+}
+
 } // namespace webrtcclient
 } // namespace video
 } // namespace kinesis
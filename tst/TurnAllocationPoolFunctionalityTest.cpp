@@ -0,0 +1,183 @@
+#include "WebRTCClientTestFixture.h"
+
+namespace com {
+namespace amazonaws {
+namespace kinesis {
+namespace video {
+namespace webrtcclient {
+
+class TurnAllocationPoolFunctionalityTest : public WebRtcClientTestBase {
+  public:
+    // Nothing answers on the turn server address, the allocations stay usable while they are trying to allocate
+    VOID initializeTestTurnServer(PIceServer pTurnServer, PCHAR username)
+    {
+        MEMSET(pTurnServer, 0x00, SIZEOF(IceServer));
+        pTurnServer->isTurn = TRUE;
+        STRCPY(pTurnServer->url, "turn:127.0.0.1:3478");
+        STRCPY(pTurnServer->username, username);
+        STRCPY(pTurnServer->credential, "credential");
+        pTurnServer->ipAddress.family = KVS_IP_FAMILY_TYPE_IPV4;
+        pTurnServer->ipAddress.port = (UINT16) getInt16(3478);
+        pTurnServer->ipAddress.address[0] = 0x7f;
+        pTurnServer->ipAddress.address[3] = 0x01;
+    }
+
+    UINT32 getPooledAllocationCount()
+    {
+        PTurnAllocationPool pPool = getTurnAllocationPoolInstance();
+        UINT32 allocationCount = 0;
+
+        MUTEX_LOCK(pPool->lock);
+        EXPECT_EQ(STATUS_SUCCESS, doubleListGetNodeCount(pPool->allocations, &allocationCount));
+        MUTEX_UNLOCK(pPool->lock);
+
+        return allocationCount;
+    }
+
+    static STATUS onChannelData(UINT64 customData, PSocketConnection pSocketConnection, PBYTE pBuffer, UINT32 bufferLen, PKvsIpAddress pSrc,
+                                PKvsIpAddress pDest)
+    {
+        UNUSED_PARAM(customData);
+        UNUSED_PARAM(pSocketConnection);
+        UNUSED_PARAM(pBuffer);
+        UNUSED_PARAM(bufferLen);
+        UNUSED_PARAM(pSrc);
+        UNUSED_PARAM(pDest);
+        return STATUS_SUCCESS;
+    }
+};
+
+TEST_F(TurnAllocationPoolFunctionalityTest, turnAllocationPoolAcquireInvalidArgs)
+{
+    IceServer turnServer;
+    PTurnAllocationSubscription pSubscription = NULL;
+
+    initializeTestTurnServer(&turnServer, (PCHAR) "username");
+
+    EXPECT_EQ(STATUS_NULL_ARG, turnAllocationPoolAcquire(NULL, KVS_SOCKET_PROTOCOL_UDP, 0, 0, 0, NULL, onChannelData, &pSubscription));
+    EXPECT_EQ(STATUS_NULL_ARG, turnAllocationPoolAcquire(&turnServer, KVS_SOCKET_PROTOCOL_UDP, 0, 0, 0, NULL, NULL, &pSubscription));
+    EXPECT_EQ(STATUS_NULL_ARG, turnAllocationPoolAcquire(&turnServer, KVS_SOCKET_PROTOCOL_UDP, 0, 0, 0, NULL, onChannelData, NULL));
+    turnServer.isTurn = FALSE;
+    EXPECT_EQ(STATUS_INVALID_ARG, turnAllocationPoolAcquire(&turnServer, KVS_SOCKET_PROTOCOL_UDP, 0, 0, 0, NULL, onChannelData, &pSubscription));
+    EXPECT_TRUE(pSubscription == NULL);
+
+    EXPECT_EQ(STATUS_NULL_ARG, turnAllocationPoolRelease(NULL));
+    // release is idempotent
+    EXPECT_EQ(STATUS_SUCCESS, turnAllocationPoolRelease(&pSubscription));
+    EXPECT_EQ(0, getPooledAllocationCount());
+}
+
+TEST_F(TurnAllocationPoolFunctionalityTest, turnAllocationPoolAcquireSharesMatchingAllocation)
+{
+    IceServer turnServer, otherTurnServer;
+    PTurnAllocationSubscription pSubscription = NULL, pSameServerSubscription = NULL, pOtherServerSubscription = NULL;
+
+    initializeTestTurnServer(&turnServer, (PCHAR) "username");
+    initializeTestTurnServer(&otherTurnServer, (PCHAR) "otherUsername");
+
+    EXPECT_EQ(STATUS_SUCCESS, turnAllocationPoolAcquire(&turnServer, KVS_SOCKET_PROTOCOL_UDP, 0, 0, 1, NULL, onChannelData, &pSubscription));
+    ASSERT_TRUE(pSubscription != NULL);
+    EXPECT_EQ(1, pSubscription->customData);
+    ASSERT_TRUE(pSubscription->pTurnAllocation != NULL);
+    EXPECT_TRUE(pSubscription->pTurnAllocation->pTurnConnection != NULL);
+    EXPECT_FALSE(IS_VALID_TIMESTAMP(pSubscription->pTurnAllocation->idleStartTime));
+
+    // Same server, transport and credentials share the allocation
+    EXPECT_EQ(STATUS_SUCCESS,
+              turnAllocationPoolAcquire(&turnServer, KVS_SOCKET_PROTOCOL_UDP, 0, 0, 2, NULL, onChannelData, &pSameServerSubscription));
+    ASSERT_TRUE(pSameServerSubscription != NULL);
+    EXPECT_NE(pSubscription, pSameServerSubscription);
+    EXPECT_EQ(pSubscription->pTurnAllocation, pSameServerSubscription->pTurnAllocation);
+    EXPECT_EQ(1, getPooledAllocationCount());
+
+    // Other credentials get an allocation of their own
+    EXPECT_EQ(STATUS_SUCCESS,
+              turnAllocationPoolAcquire(&otherTurnServer, KVS_SOCKET_PROTOCOL_UDP, 0, 0, 3, NULL, onChannelData, &pOtherServerSubscription));
+    ASSERT_TRUE(pOtherServerSubscription != NULL);
+    EXPECT_NE(pSubscription->pTurnAllocation, pOtherServerSubscription->pTurnAllocation);
+    EXPECT_EQ(2, getPooledAllocationCount());
+
+    EXPECT_EQ(STATUS_SUCCESS, turnAllocationPoolRelease(&pSubscription));
+    EXPECT_EQ(STATUS_SUCCESS, turnAllocationPoolRelease(&pSameServerSubscription));
+    EXPECT_EQ(STATUS_SUCCESS, turnAllocationPoolRelease(&pOtherServerSubscription));
+    EXPECT_TRUE(pSubscription == NULL && pSameServerSubscription == NULL && pOtherServerSubscription == NULL);
+}
+
+TEST_F(TurnAllocationPoolFunctionalityTest, turnAllocationPoolReleasedAllocationIsReused)
+{
+    IceServer turnServer;
+    PTurnAllocationSubscription pSubscription = NULL, pOtherSubscription = NULL;
+    PTurnAllocation pTurnAllocation = NULL;
+
+    initializeTestTurnServer(&turnServer, (PCHAR) "username");
+
+    EXPECT_EQ(STATUS_SUCCESS, turnAllocationPoolAcquire(&turnServer, KVS_SOCKET_PROTOCOL_UDP, 0, 0, 1, NULL, onChannelData, &pSubscription));
+    EXPECT_EQ(STATUS_SUCCESS, turnAllocationPoolAcquire(&turnServer, KVS_SOCKET_PROTOCOL_UDP, 0, 0, 2, NULL, onChannelData, &pOtherSubscription));
+    ASSERT_TRUE(pSubscription != NULL && pOtherSubscription != NULL);
+    pTurnAllocation = pSubscription->pTurnAllocation;
+
+    // The allocation only goes idle with its last subscription
+    EXPECT_EQ(STATUS_SUCCESS, turnAllocationPoolRelease(&pSubscription));
+    EXPECT_TRUE(pSubscription == NULL);
+    EXPECT_FALSE(IS_VALID_TIMESTAMP(pTurnAllocation->idleStartTime));
+
+    EXPECT_EQ(STATUS_SUCCESS, turnAllocationPoolRelease(&pOtherSubscription));
+    EXPECT_TRUE(IS_VALID_TIMESTAMP(pTurnAllocation->idleStartTime));
+    EXPECT_EQ(1, getPooledAllocationCount());
+
+    // The next ice agent picks the idle allocation up again
+    EXPECT_EQ(STATUS_SUCCESS, turnAllocationPoolAcquire(&turnServer, KVS_SOCKET_PROTOCOL_UDP, 0, 0, 3, NULL, onChannelData, &pSubscription));
+    ASSERT_TRUE(pSubscription != NULL);
+    EXPECT_EQ(pTurnAllocation, pSubscription->pTurnAllocation);
+    EXPECT_FALSE(IS_VALID_TIMESTAMP(pTurnAllocation->idleStartTime));
+    EXPECT_EQ(1, getPooledAllocationCount());
+
+    EXPECT_EQ(STATUS_SUCCESS, turnAllocationPoolRelease(&pSubscription));
+}
+
+TEST_F(TurnAllocationPoolFunctionalityTest, turnAllocationPoolFreesExpiredIdleAllocation)
+{
+    IceServer turnServer, otherTurnServer;
+    PTurnAllocationPool pPool = getTurnAllocationPoolInstance();
+    PTurnAllocationSubscription pSubscription = NULL;
+    PTurnAllocation pTurnAllocation = NULL;
+
+    initializeTestTurnServer(&turnServer, (PCHAR) "username");
+    initializeTestTurnServer(&otherTurnServer, (PCHAR) "otherUsername");
+
+    EXPECT_EQ(STATUS_SUCCESS, turnAllocationPoolAcquire(&turnServer, KVS_SOCKET_PROTOCOL_UDP, 0, 0, 1, NULL, onChannelData, &pSubscription));
+    ASSERT_TRUE(pSubscription != NULL);
+    pTurnAllocation = pSubscription->pTurnAllocation;
+    EXPECT_EQ(STATUS_SUCCESS, turnAllocationPoolRelease(&pSubscription));
+    EXPECT_EQ(1, getPooledAllocationCount());
+
+    // Idle for longer than the timeout, the next acquire frees it
+    MUTEX_LOCK(pPool->lock);
+    pTurnAllocation->idleStartTime = GETTIME() - TURN_ALLOCATION_POOL_IDLE_TIMEOUT - HUNDREDS_OF_NANOS_IN_A_SECOND;
+    MUTEX_UNLOCK(pPool->lock);
+
+    EXPECT_EQ(STATUS_SUCCESS, turnAllocationPoolAcquire(&otherTurnServer, KVS_SOCKET_PROTOCOL_UDP, 0, 0, 2, NULL, onChannelData, &pSubscription));
+    ASSERT_TRUE(pSubscription != NULL);
+    EXPECT_EQ(1, getPooledAllocationCount());
+    EXPECT_STREQ(otherTurnServer.username, pSubscription->pTurnAllocation->turnServer.username);
+
+    // Released and expired again, releasing another subscription collects it as well
+    pTurnAllocation = pSubscription->pTurnAllocation;
+    EXPECT_EQ(STATUS_SUCCESS, turnAllocationPoolRelease(&pSubscription));
+    EXPECT_EQ(STATUS_SUCCESS, turnAllocationPoolAcquire(&turnServer, KVS_SOCKET_PROTOCOL_UDP, 0, 0, 3, NULL, onChannelData, &pSubscription));
+    ASSERT_TRUE(pSubscription != NULL);
+    EXPECT_EQ(2, getPooledAllocationCount());
+
+    MUTEX_LOCK(pPool->lock);
+    pTurnAllocation->idleStartTime = GETTIME() - TURN_ALLOCATION_POOL_IDLE_TIMEOUT - HUNDREDS_OF_NANOS_IN_A_SECOND;
+    MUTEX_UNLOCK(pPool->lock);
+
+    EXPECT_EQ(STATUS_SUCCESS, turnAllocationPoolRelease(&pSubscription));
+    EXPECT_EQ(1, getPooledAllocationCount());
+}
+
+} // namespace webrtcclient
+} // namespace video
+} // namespace kinesis
+} // namespace amazonaws
+} // namespace com
@@ -593,6 +593,192 @@ TEST_F(TurnConnectionFunctionalityTest, turnConnectionReceivePartialChannelMessa
     freeTestTurnConnection();
 }
 
+TEST_F(TurnConnectionFunctionalityTest, turnConnectionParseChannelDataTcpModeParsesWholeRead)
+{
+    TurnConnection turnConnection;
+    TurnPeer turnPeers[1];
+    std::vector<BYTE> recvBuffer(DEFAULT_TURN_MESSAGE_RECV_CHANNEL_DATA_BUFFER_LEN), completeBuffer(DEFAULT_TURN_MESSAGE_RECV_CHANNEL_DATA_BUFFER_LEN);
+    std::vector<BYTE> stream, parsed;
+    TurnChannelData turnChannelData[8];
+    UINT32 payloadSizes[] = {5, 8, 13}, turnChannelDataCount, dataLenProcessed, splitPos, i, j;
+
+    MEMSET(&turnConnection, 0x00, SIZEOF(TurnConnection));
+    MEMSET(turnPeers, 0x00, SIZEOF(turnPeers));
+    turnConnection.turnPeerList = turnPeers;
+    turnConnection.maxTurnPeerCount = ARRAY_SIZE(turnPeers);
+    turnConnection.protocol = KVS_SOCKET_PROTOCOL_TCP;
+    turnConnection.recvDataBuffer = recvBuffer.data();
+    turnConnection.completeChannelDataBuffer = completeBuffer.data();
+    turnConnection.recvDataBufferSize = (UINT32) recvBuffer.size();
+    turnConnection.turnPeerCount = 1;
+    turnConnection.turnPeerList[0].channelNumber = TURN_CHANNEL_BIND_CHANNEL_NUMBER_BASE + 1;
+    turnConnection.turnPeerList[0].address.port = 1234;
+
+    // Padded channel data messages back to back, the way they come out of a TCP read
+    for (i = 0; i < ARRAY_SIZE(payloadSizes); i++) {
+        stream.insert(stream.end(), {TURN_DATA_CHANNEL_MSG_FIRST_BYTE, 0x01, 0x00, (BYTE) payloadSizes[i]});
+        for (j = 0; j < ROUND_UP(payloadSizes[i], 4); j++) {
+            stream.push_back(j < payloadSizes[i] ? (BYTE) (i + j) : 0x00);
+        }
+        for (j = 0; j < payloadSizes[i]; j++) {
+            parsed.push_back((BYTE) (i + j));
+        }
+    }
+
+    // Everything is parsed in one call and points into the read buffer
+    turnChannelDataCount = ARRAY_SIZE(turnChannelData);
+    EXPECT_EQ(STATUS_SUCCESS,
+              turnConnectionParseChannelDataTcpMode(&turnConnection, stream.data(), (UINT32) stream.size(), turnChannelData, &turnChannelDataCount,
+                                                    &dataLenProcessed));
+    EXPECT_EQ(ARRAY_SIZE(payloadSizes), turnChannelDataCount);
+    EXPECT_EQ(stream.size(), dataLenProcessed);
+    EXPECT_EQ(stream.data() + TURN_DATA_CHANNEL_SEND_OVERHEAD, turnChannelData[0].data);
+    EXPECT_EQ(1234, turnChannelData[2].senderAddr.port);
+    EXPECT_EQ(0, turnConnection.currRecvDataLen);
+
+    // The list size bounds the number of messages parsed
+    turnChannelDataCount = 1;
+    EXPECT_EQ(STATUS_SUCCESS,
+              turnConnectionParseChannelDataTcpMode(&turnConnection, stream.data(), (UINT32) stream.size(), turnChannelData, &turnChannelDataCount,
+                                                    &dataLenProcessed));
+    EXPECT_EQ(1, turnChannelDataCount);
+    EXPECT_EQ(ROUND_UP(payloadSizes[0], 4) + TURN_DATA_CHANNEL_SEND_OVERHEAD, dataLenProcessed);
+
+    // Split the stream across two reads at every position, only the message cut in two is carried over
+    for (splitPos = 1; splitPos < stream.size(); splitPos++) {
+        std::vector<BYTE> reassembled;
+
+        turnChannelDataCount = ARRAY_SIZE(turnChannelData);
+        EXPECT_EQ(STATUS_SUCCESS,
+                  turnConnectionParseChannelDataTcpMode(&turnConnection, stream.data(), splitPos, turnChannelData, &turnChannelDataCount,
+                                                        &dataLenProcessed));
+        EXPECT_EQ(splitPos, dataLenProcessed);
+        for (i = 0; i < turnChannelDataCount; i++) {
+            reassembled.insert(reassembled.end(), turnChannelData[i].data, turnChannelData[i].data + turnChannelData[i].size);
+        }
+
+        turnChannelDataCount = ARRAY_SIZE(turnChannelData);
+        EXPECT_EQ(STATUS_SUCCESS,
+                  turnConnectionParseChannelDataTcpMode(&turnConnection, stream.data() + splitPos, (UINT32) stream.size() - splitPos,
+                                                        turnChannelData, &turnChannelDataCount, &dataLenProcessed));
+        EXPECT_EQ(stream.size() - splitPos, dataLenProcessed);
+        for (i = 0; i < turnChannelDataCount; i++) {
+            reassembled.insert(reassembled.end(), turnChannelData[i].data, turnChannelData[i].data + turnChannelData[i].size);
+        }
+
+        EXPECT_EQ(parsed, reassembled);
+        EXPECT_EQ(0, turnConnection.currRecvDataLen);
+    }
+
+    // Parsing stops in front of whatever is not channel data, like an interleaved STUN packet
+    stream.insert(stream.begin() + ROUND_UP(payloadSizes[0], 4) + TURN_DATA_CHANNEL_SEND_OVERHEAD, {0x01, 0x01, 0x00, 0x00});
+    turnChannelDataCount = ARRAY_SIZE(turnChannelData);
+    EXPECT_EQ(STATUS_SUCCESS,
+              turnConnectionParseChannelDataTcpMode(&turnConnection, stream.data(), (UINT32) stream.size(), turnChannelData, &turnChannelDataCount,
+                                                    &dataLenProcessed));
+    EXPECT_EQ(1, turnChannelDataCount);
+    EXPECT_EQ(ROUND_UP(payloadSizes[0], 4) + TURN_DATA_CHANNEL_SEND_OVERHEAD, dataLenProcessed);
+    EXPECT_EQ(STATUS_TURN_MISSING_CHANNEL_DATA_HEADER,
+              turnConnectionParseChannelDataTcpMode(&turnConnection, stream.data() + dataLenProcessed, (UINT32) stream.size() - dataLenProcessed,
+                                                    turnChannelData, &turnChannelDataCount, &dataLenProcessed));
+}
+
+TEST_F(TurnConnectionFunctionalityTest, turnConnectionReleasedPeersKeepTheirChannel)
+{
+    IceServer turnServer;
+    TIMER_QUEUE_HANDLE testTimerQueueHandle = INVALID_TIMER_QUEUE_HANDLE_VALUE;
+    PConnectionListener pTestConnectionListener = NULL;
+    PSocketConnection pTurnSocket = NULL;
+    PTurnConnection pSharedTurnConnection = NULL;
+    PTurnPeer pTurnPeer = NULL, pOtherTurnPeer = NULL;
+    KvsIpAddress peerAddr, otherPeerAddr;
+    const UINT64 subscription = 1, otherSubscription = 2;
+
+    MEMSET(&turnServer, 0x00, SIZEOF(IceServer));
+    turnServer.isTurn = TRUE;
+    STRCPY(turnServer.url, "turn:127.0.0.1:3478");
+    STRCPY(turnServer.username, "username");
+    STRCPY(turnServer.credential, "credential");
+    turnServer.ipAddress.family = KVS_IP_FAMILY_TYPE_IPV4;
+    turnServer.ipAddress.port = (UINT16) getInt16(3478);
+    turnServer.ipAddress.address[0] = 0x7f;
+    turnServer.ipAddress.address[3] = 0x01;
+
+    MEMSET(&peerAddr, 0x00, SIZEOF(KvsIpAddress));
+    peerAddr.family = KVS_IP_FAMILY_TYPE_IPV4;
+    peerAddr.port = (UINT16) getInt16(8080);
+    peerAddr.address[0] = 0x4d;
+    peerAddr.address[1] = 0x01;
+    peerAddr.address[2] = 0x01;
+    peerAddr.address[3] = 0x01;
+    otherPeerAddr = peerAddr;
+    otherPeerAddr.address[3] = 0x02;
+
+    EXPECT_EQ(STATUS_SUCCESS, timerQueueCreate(&testTimerQueueHandle));
+    EXPECT_EQ(STATUS_SUCCESS, createConnectionListener(&pTestConnectionListener));
+    EXPECT_EQ(STATUS_SUCCESS,
+              createSocketConnection(KVS_IP_FAMILY_TYPE_IPV4, KVS_SOCKET_PROTOCOL_UDP, NULL, &turnServer.ipAddress, 0, NULL, 0, &pTurnSocket));
+    EXPECT_EQ(STATUS_SUCCESS, connectionListenerAddConnection(pTestConnectionListener, pTurnSocket));
+
+    EXPECT_NE(STATUS_SUCCESS,
+              createTurnConnectionWithMaxPeerCount(&turnServer, testTimerQueueHandle, TURN_CONNECTION_DATA_TRANSFER_MODE_DATA_CHANNEL,
+                                                   KVS_SOCKET_PROTOCOL_UDP, NULL, pTurnSocket, pTestConnectionListener, 0, &pSharedTurnConnection));
+    ASSERT_EQ(STATUS_SUCCESS,
+              createTurnConnectionWithMaxPeerCount(&turnServer, testTimerQueueHandle, TURN_CONNECTION_DATA_TRANSFER_MODE_DATA_CHANNEL,
+                                                   KVS_SOCKET_PROTOCOL_UDP, NULL, pTurnSocket, pTestConnectionListener, 2, &pSharedTurnConnection));
+
+    EXPECT_EQ(STATUS_SUCCESS, turnConnectionAddPeerWithCustomData(pSharedTurnConnection, &peerAddr, subscription));
+    EXPECT_EQ(STATUS_SUCCESS, turnConnectionAddPeerWithCustomData(pSharedTurnConnection, &otherPeerAddr, otherSubscription));
+    EXPECT_EQ(2, turnConnectionGetActivePeerCount(pSharedTurnConnection));
+    EXPECT_EQ(STATUS_SUCCESS, turnConnectionGetSendPeer(pSharedTurnConnection, &peerAddr, &pTurnPeer));
+    ASSERT_TRUE(pTurnPeer != NULL);
+    EXPECT_EQ(subscription, pTurnPeer->customData);
+    EXPECT_EQ(pTurnPeer, turnConnectionGetPeerWithChannelNumber(pSharedTurnConnection, pTurnPeer->channelNumber));
+
+    // The channel of a peer in use can't route its data to a second subscriber as well, adding it again is fine for its owner
+    EXPECT_EQ(STATUS_TURN_CONNECTION_PEER_IN_USE, turnConnectionAddPeerWithCustomData(pSharedTurnConnection, &peerAddr, otherSubscription));
+    EXPECT_EQ(subscription, pTurnPeer->customData);
+    EXPECT_EQ(STATUS_SUCCESS, turnConnectionAddPeerWithCustomData(pSharedTurnConnection, &peerAddr, subscription));
+    EXPECT_EQ(2, turnConnectionGetActivePeerCount(pSharedTurnConnection));
+
+    // Releasing only touches the peers of the subscription, the slot and its channel number stay
+    EXPECT_EQ(STATUS_SUCCESS, turnConnectionReleasePeers(pSharedTurnConnection, subscription));
+    EXPECT_EQ(1, turnConnectionGetActivePeerCount(pSharedTurnConnection));
+    EXPECT_EQ(TURN_PEER_CONN_STATE_RELEASED, pTurnPeer->connectionState);
+    EXPECT_EQ(0, pTurnPeer->customData);
+    EXPECT_EQ(STATUS_SUCCESS, turnConnectionGetSendPeer(pSharedTurnConnection, &otherPeerAddr, &pOtherTurnPeer));
+    ASSERT_TRUE(pOtherTurnPeer != NULL);
+    EXPECT_EQ(otherSubscription, pOtherTurnPeer->customData);
+
+    // The list is full and the released slot is still within its channel binding lifetime
+    otherPeerAddr.address[3] = 0x03;
+    EXPECT_NE(STATUS_SUCCESS, turnConnectionAddPeerWithCustomData(pSharedTurnConnection, &otherPeerAddr, otherSubscription));
+
+    // Adding the released address again revives it for the new subscriber on the same channel
+    EXPECT_EQ(STATUS_SUCCESS, turnConnectionAddPeerWithCustomData(pSharedTurnConnection, &peerAddr, otherSubscription));
+    EXPECT_EQ(2, turnConnectionGetActivePeerCount(pSharedTurnConnection));
+    EXPECT_EQ(otherSubscription, pTurnPeer->customData);
+    EXPECT_NE(TURN_PEER_CONN_STATE_RELEASED, pTurnPeer->connectionState);
+    EXPECT_EQ(pTurnPeer, turnConnectionGetPeerWithChannelNumber(pSharedTurnConnection, pTurnPeer->channelNumber));
+
+    // Once the binding expired the channel number still can't go to another address for the rebind guard period
+    EXPECT_EQ(STATUS_SUCCESS, turnConnectionReleasePeers(pSharedTurnConnection, otherSubscription));
+    EXPECT_EQ(0, turnConnectionGetActivePeerCount(pSharedTurnConnection));
+    pTurnPeer->releaseTime = GETTIME() - TURN_CHANNEL_BIND_LIFETIME - HUNDREDS_OF_NANOS_IN_A_SECOND;
+    pOtherTurnPeer->releaseTime = pTurnPeer->releaseTime;
+    EXPECT_NE(STATUS_SUCCESS, turnConnectionAddPeerWithCustomData(pSharedTurnConnection, &otherPeerAddr, subscription));
+
+    pTurnPeer->releaseTime = GETTIME() - TURN_CHANNEL_BIND_LIFETIME - TURN_CHANNEL_REBIND_GUARD_PERIOD - HUNDREDS_OF_NANOS_IN_A_SECOND;
+    EXPECT_EQ(STATUS_SUCCESS, turnConnectionAddPeerWithCustomData(pSharedTurnConnection, &otherPeerAddr, subscription));
+    EXPECT_EQ(1, turnConnectionGetActivePeerCount(pSharedTurnConnection));
+    EXPECT_EQ(subscription, pTurnPeer->customData);
+    EXPECT_EQ(pTurnPeer, turnConnectionGetPeerWithIp(pSharedTurnConnection, &otherPeerAddr));
+
+    EXPECT_EQ(STATUS_SUCCESS, freeTurnConnection(&pSharedTurnConnection));
+    EXPECT_EQ(STATUS_SUCCESS, freeConnectionListener(&pTestConnectionListener));
+    timerQueueFree(&testTimerQueueHandle);
+}
+
 TEST_F(TurnConnectionFunctionalityTest, turnConnectionReceiveChannelDataMixedWithStunMessage)
 {
     if (!mAccessKeyIdSet) {
@@ -994,6 +1180,109 @@ TEST_F(TurnConnectionFunctionalityTest, turnConnectionCallMultipleTurnSendDataIn
     freeTestTurnConnection();
 }
 
+TEST_F(TurnConnectionFunctionalityTest, turnConnectionSendChannelDataFramesInPlace)
+{
+    if (!mAccessKeyIdSet) {
+        return;
+    }
+
+    BOOL turnReady = FALSE;
+    KvsIpAddress turnPeerAddr;
+    const UINT32 bufLen = 5;
+    const UINT32 reqCount = 5;
+    BYTE buf[reqCount][TURN_DATA_CHANNEL_SEND_HEADROOM + bufLen + TURN_DATA_CHANNEL_SEND_TAILROOM];
+    PBYTE bufs[reqCount];
+    UINT32 bufLens[reqCount];
+    std::thread threads[reqCount];
+    PTurnPeer pTurnPeer = NULL;
+    UINT32 i, j, sentCount = 0;
+    UINT64 turnReadyTimeout = GETTIME() + 10 * HUNDREDS_OF_NANOS_IN_A_SECOND;
+
+    initializeTestTurnConnection();
+
+    turnPeerAddr.port = (UINT16) getInt16(8080);
+    turnPeerAddr.family = KVS_IP_FAMILY_TYPE_IPV4;
+    turnPeerAddr.isPointToPoint = FALSE;
+    /* random peer 77.1.1.1, we are not actually sending anything to it. */
+    turnPeerAddr.address[0] = 0x4d;
+    turnPeerAddr.address[1] = 0x01;
+    turnPeerAddr.address[2] = 0x01;
+    turnPeerAddr.address[3] = 0x01;
+
+    EXPECT_EQ(STATUS_SUCCESS, turnConnectionGetSendPeer(pTurnConnection, &turnPeerAddr, &pTurnPeer));
+    EXPECT_TRUE(pTurnPeer == NULL);
+
+    EXPECT_EQ(STATUS_SUCCESS, turnConnectionAddPeer(pTurnConnection, &turnPeerAddr));
+    EXPECT_EQ(STATUS_SUCCESS, turnConnectionGetSendPeer(pTurnConnection, &turnPeerAddr, &pTurnPeer));
+    ASSERT_TRUE(pTurnPeer != NULL);
+
+    for (i = 0; i < reqCount; i++) {
+        MEMSET(buf[i], i, SIZEOF(buf[i]));
+        bufs[i] = buf[i] + TURN_DATA_CHANNEL_SEND_HEADROOM;
+        bufLens[i] = bufLen;
+    }
+
+    // Buffers without room for the ChannelData header are refused rather than framed over whatever precedes them
+    EXPECT_EQ(STATUS_INVALID_ARG,
+              turnConnectionSendChannelData(pTurnConnection, pTurnPeer, bufs, bufLens, reqCount, TURN_DATA_CHANNEL_SEND_HEADROOM - 1,
+                                            TURN_DATA_CHANNEL_SEND_TAILROOM, &sentCount));
+    EXPECT_EQ(0, sentCount);
+
+    // Nothing goes out before the channel is bound
+    EXPECT_EQ(STATUS_SUCCESS, turnConnectionSendChannelData(pTurnConnection, pTurnPeer, bufs, bufLens, reqCount, TURN_DATA_CHANNEL_SEND_HEADROOM,
+                                                            TURN_DATA_CHANNEL_SEND_TAILROOM, &sentCount));
+    EXPECT_EQ(0, sentCount);
+
+    EXPECT_EQ(STATUS_SUCCESS, turnConnectionStart(pTurnConnection));
+
+    // wait until channel is created
+    while (!turnReady && GETTIME() < turnReadyTimeout) {
+        THREAD_SLEEP(100 * HUNDREDS_OF_NANOS_IN_A_MILLISECOND);
+        MUTEX_LOCK(pTurnConnection->lock);
+        if (pTurnConnection->state == TURN_STATE_READY) {
+            turnReady = TRUE;
+        }
+        MUTEX_UNLOCK(pTurnConnection->lock);
+    }
+
+    EXPECT_TRUE(turnReady == TRUE);
+
+    for (i = 0; i < reqCount; i++) {
+        threads[i] = std::thread(
+            [](PTurnConnection pTurnConnection, PTurnPeer pTurnPeer, PBYTE pBuf, UINT32 bufLen) -> void {
+                UINT32 sentCount = 0;
+                EXPECT_EQ(STATUS_SUCCESS,
+                          turnConnectionSendChannelData(pTurnConnection, pTurnPeer, &pBuf, &bufLen, 1, TURN_DATA_CHANNEL_SEND_HEADROOM,
+                                                        TURN_DATA_CHANNEL_SEND_TAILROOM, &sentCount));
+                EXPECT_EQ(1, sentCount);
+            },
+            pTurnConnection, pTurnPeer, bufs[i], bufLen);
+    }
+
+    for (i = 0; i < reqCount; i++) {
+        threads[i].join();
+
+        // The ChannelData header went into the headroom, the data itself is untouched
+        EXPECT_EQ(pTurnPeer->channelNumber, (UINT16) getInt16(*(PINT16) buf[i]));
+        EXPECT_EQ(bufLen, (UINT16) getInt16(*(PINT16) (buf[i] + 2)));
+        EXPECT_EQ(i, bufs[i][bufLen - 1]);
+
+        // Over TCP the frame is padded to 4 bytes with zeros rather than whatever was in the tailroom
+        if (pTurnConnection->protocol == KVS_SOCKET_PROTOCOL_TCP) {
+            for (j = TURN_DATA_CHANNEL_SEND_OVERHEAD + bufLen; j < ROUND_UP(TURN_DATA_CHANNEL_SEND_OVERHEAD + bufLen, 4); j++) {
+                EXPECT_EQ(0, buf[i][j]);
+            }
+        }
+    }
+
+    // A batch goes out in one call as well
+    EXPECT_EQ(STATUS_SUCCESS, turnConnectionSendChannelData(pTurnConnection, pTurnPeer, bufs, bufLens, reqCount, TURN_DATA_CHANNEL_SEND_HEADROOM,
+                                                            TURN_DATA_CHANNEL_SEND_TAILROOM, &sentCount));
+    EXPECT_EQ(reqCount, sentCount);
+
+    freeTestTurnConnection();
+}
+
 } // namespace webrtcclient
 } // namespace video
 } // namespace kinesis